@@ -0,0 +1,258 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark stresses the allocator stack in isolation, without any actors
+// or message passing. The message benchmarks (PingPong, ThreadRing) exercise
+// the allocators only incidentally, so allocator changes such as per-size-class
+// pool depths are hard to measure through them.
+//
+// Worker threads hammer a shared CachingAllocator layered over the
+// DefaultAllocator, allocating and freeing blocks drawn from the size
+// distribution of real message blocks: mostly one or two cache lines (small
+// value types wrapped in a message envelope), with a tail of larger payloads.
+// Each thread keeps a small ring of outstanding blocks, so frees trail
+// allocations the way queued messages do. The benchmark reports operations per
+// second at each thread count, along with the cache hit rate, measured by
+// counting the allocations that fall through the cache to the wrapped
+// allocator. A run against the raw DefaultAllocator provides the baseline.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Allocators/CachingAllocator.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Thread.h>
+
+#include "../Common/Timer.h"
+
+
+// An allocator adapter that counts the allocations passed through to the
+// wrapped allocator. Layered under a caching allocator, the count measures
+// the cache misses.
+class CountingAllocator : public Theron::IAllocator
+{
+public:
+
+    inline explicit CountingAllocator(Theron::IAllocator *const allocator) :
+      mAllocator(allocator),
+      mAllocations(0)
+    {
+    }
+
+    inline virtual void *Allocate(const SizeType size)
+    {
+        mAllocations.Increment();
+        return mAllocator->Allocate(size);
+    }
+
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment)
+    {
+        mAllocations.Increment();
+        return mAllocator->AllocateAligned(size, alignment);
+    }
+
+    inline virtual void Free(void *const memory)
+    {
+        mAllocator->Free(memory);
+    }
+
+    inline virtual void Free(void *const memory, const SizeType size)
+    {
+        mAllocator->Free(memory, size);
+    }
+
+    inline Theron::uint32_t GetAllocations() const
+    {
+        return mAllocations.Load();
+    }
+
+    inline void ResetAllocations()
+    {
+        mAllocations.Store(0);
+    }
+
+private:
+
+    Theron::IAllocator *mAllocator;
+    mutable Theron::Detail::Atomic::UInt32 mAllocations;
+};
+
+
+// The size distribution of allocated blocks, weighted like real message
+// blocks: the envelope makes even an int message a cache line, most payloads
+// fit in one or two lines, and a minority are bulk data.
+static const Theron::uint32_t blockSizes[] =
+{
+    64, 64, 64, 64, 64, 64, 64, 64,
+    128, 128, 128, 128,
+    256, 256,
+    512,
+    1024
+};
+
+static const Theron::uint32_t NUM_BLOCK_SIZES = sizeof(blockSizes) / sizeof(blockSizes[0]);
+
+// Number of outstanding blocks each thread holds, so frees trail allocations
+// the way messages queued in a mailbox do.
+static const Theron::uint32_t RING_SIZE = 32;
+
+
+struct ThreadContext
+{
+    Theron::IAllocator *mAllocator;     // The allocator under test, shared between the threads.
+    Theron::uint32_t mIterations;       // Number of allocate/free pairs to perform.
+    Theron::uint32_t mSeed;             // Per-thread seed decorrelating the size sequences.
+};
+
+
+static void ThreadEntryPoint(void *const context)
+{
+    ThreadContext *const threadContext(reinterpret_cast<ThreadContext *>(context));
+    Theron::IAllocator *const allocator(threadContext->mAllocator);
+
+    void *ring[RING_SIZE];
+    Theron::uint32_t ringSizes[RING_SIZE];
+    Theron::uint32_t ringIndex(0);
+
+    for (Theron::uint32_t index = 0; index < RING_SIZE; ++index)
+    {
+        ring[index] = 0;
+        ringSizes[index] = 0;
+    }
+
+    // A cheap linear congruential sequence picks the block sizes; real
+    // randomness isn't needed, just an uneven interleaving across threads.
+    Theron::uint32_t next(threadContext->mSeed);
+
+    for (Theron::uint32_t iteration = 0; iteration < threadContext->mIterations; ++iteration)
+    {
+        next = next * 1664525 + 1013904223;
+        const Theron::uint32_t blockSize(blockSizes[(next >> 16) % NUM_BLOCK_SIZES]);
+
+        // Free the oldest outstanding block and replace it with a new one.
+        if (ring[ringIndex])
+        {
+            allocator->Free(ring[ringIndex], ringSizes[ringIndex]);
+        }
+
+        void *const block(allocator->Allocate(blockSize));
+        if (block == 0)
+        {
+            printf("ERROR: Allocation failed\n");
+            return;
+        }
+
+        // Touch the block the way a message constructor would.
+        *reinterpret_cast<Theron::uint32_t *>(block) = iteration;
+
+        ring[ringIndex] = block;
+        ringSizes[ringIndex] = blockSize;
+        ringIndex = (ringIndex + 1) % RING_SIZE;
+    }
+
+    // Drain the ring.
+    for (Theron::uint32_t index = 0; index < RING_SIZE; ++index)
+    {
+        if (ring[index])
+        {
+            allocator->Free(ring[index], ringSizes[index]);
+        }
+    }
+}
+
+
+// Runs the given number of threads against the allocator and reports the
+// throughput, plus the cache hit rate when a miss counter is provided.
+static void RunStress(
+    const char *const name,
+    Theron::IAllocator *const allocator,
+    CountingAllocator *const missCounter,
+    const Theron::uint32_t numThreads,
+    const Theron::uint32_t iterationsPerThread)
+{
+    Theron::Detail::Thread *const threads(new Theron::Detail::Thread[numThreads]);
+    ThreadContext *const contexts(new ThreadContext[numThreads]);
+
+    if (missCounter)
+    {
+        missCounter->ResetAllocations();
+    }
+
+    for (Theron::uint32_t index = 0; index < numThreads; ++index)
+    {
+        contexts[index].mAllocator = allocator;
+        contexts[index].mIterations = iterationsPerThread;
+        contexts[index].mSeed = index + 1;
+    }
+
+    Timer timer;
+    timer.Start();
+
+    for (Theron::uint32_t index = 0; index < numThreads; ++index)
+    {
+        threads[index].Start(ThreadEntryPoint, &contexts[index]);
+    }
+
+    for (Theron::uint32_t index = 0; index < numThreads; ++index)
+    {
+        threads[index].Join();
+    }
+
+    timer.Stop();
+
+    // An allocate and a free count as two operations.
+    const double totalOps(2.0 * static_cast<double>(iterationsPerThread) * static_cast<double>(numThreads));
+    const double opsPerSecond(totalOps / timer.Seconds());
+
+    if (missCounter)
+    {
+        const double totalAllocations(static_cast<double>(iterationsPerThread) * static_cast<double>(numThreads));
+        const double misses(static_cast<double>(missCounter->GetAllocations()));
+        const double hitRate(100.0 * (1.0 - misses / totalAllocations));
+
+        printf("%-16s %2d threads  %12.0f ops/sec  %6.2f%% cache hits\n", name, numThreads, opsPerSecond, hitRate);
+    }
+    else
+    {
+        printf("%-16s %2d threads  %12.0f ops/sec\n", name, numThreads, opsPerSecond);
+    }
+
+    delete [] contexts;
+    delete [] threads;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numIterations = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 1000000;
+    const int maxThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+
+    printf("Using numIterations = %d (use first command line argument to change)\n", numIterations);
+    printf("Using maxThreads = %d (use second command line argument to change)\n", maxThreads);
+    printf("Stressing the allocator stack with the message block size distribution...\n");
+
+    Theron::IAllocator *const defaultAllocator(Theron::AllocatorManager::Instance().GetAllocator());
+
+    for (Theron::uint32_t numThreads = 1; numThreads <= static_cast<Theron::uint32_t>(maxThreads); numThreads *= 2)
+    {
+        RunStress("default", defaultAllocator, 0, numThreads, numIterations);
+    }
+
+    // The cache is the same type as the per-framework message cache, shared
+    // between the threads as the framework's shared cache is.
+    for (Theron::uint32_t numThreads = 1; numThreads <= static_cast<Theron::uint32_t>(maxThreads); numThreads *= 2)
+    {
+        CountingAllocator missCounter(defaultAllocator);
+        Theron::Detail::CachingAllocator<32, Theron::Detail::SpinLock> cache(&missCounter);
+
+        RunStress("cached", &cache, &missCounter, numThreads, numIterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_BENCHMARKS_COMMON_BENCHMARKHARNESS_H
+#define THERON_BENCHMARKS_COMMON_BENCHMARKHARNESS_H
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+
+#include "Timer.h"
+
+
+// Harness that runs a benchmark scenario across a sweep of worker thread
+// counts, captures the framework's per-thread event counters, writes the
+// results as machine-readable JSON, and optionally gates against a stored
+// baseline.
+//
+// The default invocation of each benchmark is unchanged; passing --sweep
+// enables harness mode:
+//
+//   threadring 1000000 --sweep [--threads n] [--json results.json]
+//       [--baseline baseline.json] [--threshold percent]
+//
+// In harness mode the scenario is run once per thread count, for thread
+// counts 1, 2, 4, ... up to a maximum (default 16, set with --threads).
+// With --json, the results of all the runs are written to the given file.
+// With --baseline, the timing of each run is compared against the timing
+// recorded for the same thread count in a baseline file written by an
+// earlier --json run, and the process exits with a non-zero status if any
+// run is slower than its baseline by more than the threshold percentage
+// (default 5, set with --threshold) -- so scripted perf checks fail on
+// regressions instead of relying on eyeballed numbers.
+class BenchmarkHarness
+{
+public:
+
+    // Scenario callback: runs the benchmark workload on the given framework
+    // and returns the measured time of the workload in seconds. The harness
+    // reads the framework's event counters after the callback returns.
+    typedef float (*ScenarioFunction)(Theron::Framework &framework, void *const context);
+
+    inline BenchmarkHarness(int argc, char *argv[]) :
+      mEnabled(false),
+      mMaxThreads(16),
+      mThresholdPercent(5.0f),
+      mJsonFileName(0),
+      mBaselineFileName(0),
+      mNumRuns(0)
+    {
+        for (int index = 1; index < argc; ++index)
+        {
+            if (strcmp(argv[index], "--sweep") == 0)
+            {
+                mEnabled = true;
+            }
+            else if (strcmp(argv[index], "--threads") == 0 && index + 1 < argc)
+            {
+                mMaxThreads = static_cast<Theron::uint32_t>(atoi(argv[++index]));
+            }
+            else if (strcmp(argv[index], "--threshold") == 0 && index + 1 < argc)
+            {
+                mThresholdPercent = static_cast<float>(atof(argv[++index]));
+            }
+            else if (strcmp(argv[index], "--json") == 0 && index + 1 < argc)
+            {
+                mJsonFileName = argv[++index];
+            }
+            else if (strcmp(argv[index], "--baseline") == 0 && index + 1 < argc)
+            {
+                mBaselineFileName = argv[++index];
+            }
+        }
+
+        if (mMaxThreads == 0)
+        {
+            mMaxThreads = 1;
+        }
+        else if (mMaxThreads > MAX_THREADS)
+        {
+            mMaxThreads = MAX_THREADS;
+        }
+    }
+
+    // Returns true if --sweep was passed on the command line.
+    inline bool Enabled() const
+    {
+        return mEnabled;
+    }
+
+    // Runs the scenario once per thread count of the sweep, then writes the
+    // JSON results and checks the baseline, if requested.
+    // Returns the process exit status: non-zero if any run regressed.
+    inline int Run(const char *const name, ScenarioFunction scenario, void *const context)
+    {
+        mNumRuns = 0;
+
+        // Sweep the thread counts in powers of two, always including the maximum.
+        Theron::uint32_t threadCount(1);
+        while (mNumRuns < MAX_RUNS)
+        {
+            RunOnce(threadCount, scenario, context);
+
+            if (threadCount >= mMaxThreads)
+            {
+                break;
+            }
+
+            threadCount += threadCount;
+            if (threadCount > mMaxThreads)
+            {
+                threadCount = mMaxThreads;
+            }
+        }
+
+        if (mJsonFileName)
+        {
+            WriteJson(name);
+        }
+
+        if (mBaselineFileName)
+        {
+            return CheckBaseline();
+        }
+
+        return 0;
+    }
+
+private:
+
+    static const Theron::uint32_t MAX_THREADS = 64;     // Per-thread counter values captured per run.
+    static const Theron::uint32_t MAX_RUNS = 16;        // Thread counts in the sweep.
+
+    // The captured results of one scenario run.
+    struct RunResult
+    {
+        Theron::uint32_t mThreads;                                          // Worker thread count of the run.
+        float mSeconds;                                                     // Measured workload time.
+        Theron::uint32_t mCounterTotals[Theron::MAX_COUNTERS];              // Framework counter totals.
+        Theron::uint32_t mPerThread[Theron::MAX_COUNTERS][MAX_THREADS];     // Per-thread counter values.
+        Theron::uint32_t mNumThreadValues[Theron::MAX_COUNTERS];            // Number of captured per-thread values.
+    };
+
+    // Returns the JSON key used for a framework counter.
+    inline static const char *CounterName(const Theron::uint32_t counter)
+    {
+        switch (counter)
+        {
+            case Theron::COUNTER_MESSAGES_PROCESSED:        return "messages_processed";
+            case Theron::COUNTER_LOCAL_PUSHES:              return "local_pushes";
+            case Theron::COUNTER_SHARED_PUSHES:             return "shared_pushes";
+            case Theron::COUNTER_LOCAL_QUEUE_SPILLS:        return "local_queue_spills";
+            case Theron::COUNTER_MAILBOX_STEALS:            return "mailbox_steals";
+            case Theron::COUNTER_YIELDS:                    return "yields";
+            case Theron::COUNTER_SLEEP_TRANSITIONS:         return "sleep_transitions";
+            case Theron::COUNTER_FAIRNESS_YIELDS:           return "fairness_yields";
+            case Theron::COUNTER_PEAK_LOCAL_QUEUE_DEPTH:    return "peak_local_queue_depth";
+            case Theron::COUNTER_PEAK_SHARED_QUEUE_DEPTH:   return "peak_shared_queue_depth";
+            default:                                        return "unknown";
+        }
+    }
+
+    // Runs the scenario once with the given thread count and captures the results.
+    inline void RunOnce(const Theron::uint32_t threadCount, ScenarioFunction scenario, void *const context)
+    {
+        RunResult &run(mRuns[mNumRuns++]);
+        run.mThreads = threadCount;
+
+        {
+            Theron::Framework framework(threadCount);
+            run.mSeconds = scenario(framework, context);
+
+            // Capture the counters before the framework is destructed.
+            for (Theron::uint32_t counter = 0; counter < Theron::MAX_COUNTERS; ++counter)
+            {
+                const Theron::Counter counterId(static_cast<Theron::Counter>(counter));
+                run.mCounterTotals[counter] = framework.GetCounterValue(counterId);
+                run.mNumThreadValues[counter] = framework.GetPerThreadCounterValues(
+                    counterId,
+                    run.mPerThread[counter],
+                    MAX_THREADS);
+            }
+        }
+
+        printf("threads %2d: %.3f seconds, %d messages processed\n",
+            run.mThreads,
+            run.mSeconds,
+            run.mCounterTotals[Theron::COUNTER_MESSAGES_PROCESSED]);
+    }
+
+    // Writes the results of all the runs to the JSON file.
+    inline void WriteJson(const char *const name) const
+    {
+        FILE *const file(fopen(mJsonFileName, "w"));
+        if (file == 0)
+        {
+            fprintf(stderr, "Failed to open '%s' for writing\n", mJsonFileName);
+            return;
+        }
+
+        fprintf(file, "{\n  \"benchmark\": \"%s\",\n  \"runs\": [\n", name);
+
+        for (Theron::uint32_t index = 0; index < mNumRuns; ++index)
+        {
+            const RunResult &run(mRuns[index]);
+
+            fprintf(file, "    {\n      \"threads\": %u,\n      \"seconds\": %.6f,\n      \"counters\": {\n",
+                run.mThreads,
+                run.mSeconds);
+
+            for (Theron::uint32_t counter = 0; counter < Theron::MAX_COUNTERS; ++counter)
+            {
+                fprintf(file, "        \"%s\": { \"total\": %u, \"per_thread\": [",
+                    CounterName(counter),
+                    run.mCounterTotals[counter]);
+
+                for (Theron::uint32_t thread = 0; thread < run.mNumThreadValues[counter]; ++thread)
+                {
+                    fprintf(file, "%s%u", thread ? ", " : "", run.mPerThread[counter][thread]);
+                }
+
+                fprintf(file, "] }%s\n", (counter + 1 < Theron::MAX_COUNTERS) ? "," : "");
+            }
+
+            fprintf(file, "      }\n    }%s\n", (index + 1 < mNumRuns) ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+
+        printf("Wrote results to '%s'\n", mJsonFileName);
+    }
+
+    // Compares the timing of each run against the baseline file.
+    // Returns non-zero if any run regressed by more than the threshold.
+    inline int CheckBaseline() const
+    {
+        char *const text(ReadFile(mBaselineFileName));
+        if (text == 0)
+        {
+            fprintf(stderr, "Failed to read baseline file '%s'\n", mBaselineFileName);
+            return 1;
+        }
+
+        int status(0);
+        for (Theron::uint32_t index = 0; index < mNumRuns; ++index)
+        {
+            const RunResult &run(mRuns[index]);
+
+            float baselineSeconds(0.0f);
+            if (!FindBaselineSeconds(text, run.mThreads, baselineSeconds))
+            {
+                printf("threads %2d: no baseline entry, skipped\n", run.mThreads);
+                continue;
+            }
+
+            const float limit(baselineSeconds * (1.0f + mThresholdPercent * 0.01f));
+            if (run.mSeconds > limit)
+            {
+                printf("threads %2d: REGRESSION: %.3f seconds against baseline %.3f (+%.1f%% threshold)\n",
+                    run.mThreads,
+                    run.mSeconds,
+                    baselineSeconds,
+                    mThresholdPercent);
+                status = 1;
+            }
+            else
+            {
+                printf("threads %2d: ok: %.3f seconds against baseline %.3f\n",
+                    run.mThreads,
+                    run.mSeconds,
+                    baselineSeconds);
+            }
+        }
+
+        free(text);
+        return status;
+    }
+
+    // Reads the entire contents of a file into a malloc'd null-terminated buffer.
+    inline static char *ReadFile(const char *const fileName)
+    {
+        FILE *const file(fopen(fileName, "rb"));
+        if (file == 0)
+        {
+            return 0;
+        }
+
+        fseek(file, 0, SEEK_END);
+        const long size(ftell(file));
+        fseek(file, 0, SEEK_SET);
+
+        char *const text(reinterpret_cast<char *>(malloc(size + 1)));
+        if (text)
+        {
+            const size_t numRead(fread(text, 1, size, file));
+            text[numRead] = '\0';
+        }
+
+        fclose(file);
+        return text;
+    }
+
+    // Finds the recorded seconds for the given thread count in baseline JSON text.
+    // The baseline is a file written by an earlier --json run, so rather than
+    // pulling in a JSON parser we just scan for the two keys in order.
+    inline static bool FindBaselineSeconds(const char *const text, const Theron::uint32_t threads, float &seconds)
+    {
+        char pattern[32];
+        sprintf(pattern, "\"threads\": %u,", threads);
+
+        const char *entry(strstr(text, pattern));
+        if (entry == 0)
+        {
+            return false;
+        }
+
+        entry = strstr(entry, "\"seconds\":");
+        if (entry == 0)
+        {
+            return false;
+        }
+
+        return (sscanf(entry + 10, "%f", &seconds) == 1);
+    }
+
+    bool mEnabled;                      // True if --sweep was passed.
+    Theron::uint32_t mMaxThreads;       // Largest thread count of the sweep.
+    float mThresholdPercent;            // Allowed slowdown against the baseline, in percent.
+    const char *mJsonFileName;          // Output JSON file name, or null.
+    const char *mBaselineFileName;      // Baseline JSON file name, or null.
+    RunResult mRuns[MAX_RUNS];                // Captured results of the runs so far.
+    Theron::uint32_t mNumRuns;          // Number of runs completed.
+};
+
+
+#endif // THERON_BENCHMARKS_COMMON_BENCHMARKHARNESS_H
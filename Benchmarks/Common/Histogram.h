@@ -0,0 +1,183 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_BENCHMARKS_COMMON_HISTOGRAM_H
+#define THERON_BENCHMARKS_COMMON_HISTOGRAM_H
+
+
+#include <stdio.h>
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+// HDR-style latency histogram with bounded relative error.
+// Values are bucketed by powers of two, with each power of two split into 32
+// linear sub-buckets, so the error of a reported percentile is bounded at
+// around 3% of the value while the footprint stays a few kilobytes. This is
+// the usual trick for capturing tail percentiles (p99, p99.9) over millions
+// of samples without storing them, since means and totals hide the tail.
+// Recording isn't thread-safe: each recording thread or actor owns its own
+// histogram and the results are combined afterwards with Merge.
+class Histogram
+{
+public:
+
+    inline Histogram() : mCount(0), mMin(0), mMax(0)
+    {
+        for (Theron::uint32_t index = 0; index < BUCKET_COUNT; ++index)
+        {
+            mBuckets[index] = 0;
+        }
+    }
+
+    // Records a single sample value (typically a latency in microseconds).
+    inline void Record(const Theron::uint64_t value)
+    {
+        mBuckets[BucketIndex(value)]++;
+
+        if (mCount == 0 || value < mMin)
+        {
+            mMin = value;
+        }
+
+        if (value > mMax)
+        {
+            mMax = value;
+        }
+
+        ++mCount;
+    }
+
+    // Merges the samples of another histogram into this one.
+    inline void Merge(const Histogram &other)
+    {
+        for (Theron::uint32_t index = 0; index < BUCKET_COUNT; ++index)
+        {
+            mBuckets[index] += other.mBuckets[index];
+        }
+
+        if (other.mCount)
+        {
+            if (mCount == 0 || other.mMin < mMin)
+            {
+                mMin = other.mMin;
+            }
+
+            if (other.mMax > mMax)
+            {
+                mMax = other.mMax;
+            }
+
+            mCount += other.mCount;
+        }
+    }
+
+    // Returns the number of recorded samples.
+    inline Theron::uint64_t Count() const
+    {
+        return mCount;
+    }
+
+    // Returns the largest recorded sample, tracked exactly.
+    inline Theron::uint64_t Max() const
+    {
+        return mMax;
+    }
+
+    // Returns the value at the given percentile (0 to 100).
+    // The returned value is the upper bound of the bucket holding the
+    // percentile, so it errs on the pessimistic side by at most one
+    // sub-bucket width (about 3% of the value).
+    inline Theron::uint64_t Percentile(const double percentile) const
+    {
+        if (mCount == 0)
+        {
+            return 0;
+        }
+
+        Theron::uint64_t target(static_cast<Theron::uint64_t>(percentile * 0.01 * static_cast<double>(mCount) + 0.5));
+        if (target > mCount)
+        {
+            target = mCount;
+        }
+
+        Theron::uint64_t cumulative(0);
+        for (Theron::uint32_t index = 0; index < BUCKET_COUNT; ++index)
+        {
+            cumulative += mBuckets[index];
+            if (cumulative >= target)
+            {
+                const Theron::uint64_t bound(BucketUpperBound(index));
+                return (bound < mMax) ? bound : mMax;
+            }
+        }
+
+        return mMax;
+    }
+
+    // Prints the standard percentile summary for a named scenario.
+    inline void Print(const char *const name) const
+    {
+        printf("%-16s %10llu samples  p50 %8llu us  p99 %8llu us  p99.9 %8llu us  max %8llu us\n",
+            name,
+            static_cast<unsigned long long>(mCount),
+            static_cast<unsigned long long>(Percentile(50.0)),
+            static_cast<unsigned long long>(Percentile(99.0)),
+            static_cast<unsigned long long>(Percentile(99.9)),
+            static_cast<unsigned long long>(mMax));
+    }
+
+private:
+
+    static const Theron::uint32_t SUB_BITS = 5;
+    static const Theron::uint32_t SUB_BUCKETS = 1 << SUB_BITS;          // Sub-buckets per power of two.
+    static const Theron::uint32_t MAX_SHIFT = 32;                       // Largest tracked scale; ~2^37us, beyond any sane latency.
+    static const Theron::uint32_t BUCKET_COUNT = (MAX_SHIFT + 1) * SUB_BUCKETS;
+
+    Histogram(const Histogram &other);
+    Histogram &operator=(const Histogram &other);
+
+    // Maps a value to its bucket: the index of its leading bit selects the
+    // scale and the next five bits select the linear sub-bucket within it.
+    inline static Theron::uint32_t BucketIndex(const Theron::uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return static_cast<Theron::uint32_t>(value);
+        }
+
+        Theron::uint32_t shift(0);
+        Theron::uint64_t remaining(value >> SUB_BITS);
+
+        while (remaining > 1 && shift < MAX_SHIFT - 1)
+        {
+            remaining >>= 1;
+            ++shift;
+        }
+
+        const Theron::uint32_t subBucket(static_cast<Theron::uint32_t>((value >> shift) & (SUB_BUCKETS - 1)));
+        return (shift + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    // Returns the largest value mapping to the given bucket.
+    inline static Theron::uint64_t BucketUpperBound(const Theron::uint32_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+
+        const Theron::uint32_t shift(index / SUB_BUCKETS - 1);
+        const Theron::uint64_t subBucket(index & (SUB_BUCKETS - 1));
+        const Theron::uint64_t base((SUB_BUCKETS + subBucket) << shift);
+
+        return base + ((static_cast<Theron::uint64_t>(1) << shift) - 1);
+    }
+
+    Theron::uint64_t mBuckets[BUCKET_COUNT];
+    Theron::uint64_t mCount;
+    Theron::uint64_t mMin;
+    Theron::uint64_t mMax;
+};
+
+
+#endif // THERON_BENCHMARKS_COMMON_HISTOGRAM_H
@@ -0,0 +1,220 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark measures the fan-in pattern in isolation: N producer actors
+// flooding a single aggregator actor through one contended mailbox. Neither
+// PingPong (two actors) nor ParallelThreadRing (one message per actor) models
+// this shape, yet it is the dominant contention pattern in aggregating
+// servers, where mailbox queue changes matter most.
+//
+// The producer count is swept in powers of two from 1 to 128 against the one
+// aggregator, holding the total message count constant, and each scenario
+// reports both the aggregate throughput and the distribution of per-message
+// send-to-handler latencies seen by the producers. Throughput shows how the
+// mailbox's producer side scales with contention; the latency percentiles
+// show what each producer pays for it.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Theron/Theron.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+
+#include "../Common/Histogram.h"
+#include "../Common/Timer.h"
+
+
+// A message stamped with the time at which it was sent, in microseconds.
+struct StampedMessage
+{
+    inline StampedMessage() : mSendTime(0)
+    {
+    }
+
+    inline explicit StampedMessage(const Theron::uint64_t sendTime) : mSendTime(sendTime)
+    {
+    }
+
+    Theron::uint64_t mSendTime;
+};
+
+
+inline static Theron::uint64_t Now()
+{
+    return Theron::Detail::ProfileClock::GetMicroseconds();
+}
+
+
+// The single consumer: records the send-to-handler latency of every stamped
+// message, signalling the given address once an expected number have been seen.
+class Aggregator : public Theron::Actor
+{
+public:
+
+    inline Aggregator(Theron::Framework &framework, const Theron::Address &caller, const Theron::uint32_t expectedCount) :
+      Theron::Actor(framework),
+      mCaller(caller),
+      mExpectedCount(expectedCount),
+      mReceivedCount(0)
+    {
+        RegisterHandler(this, &Aggregator::Receive);
+    }
+
+    // Read by the main thread only after the completion signal is received.
+    inline const Histogram &GetHistogram() const
+    {
+        return mHistogram;
+    }
+
+private:
+
+    inline void Receive(const StampedMessage &message, const Theron::Address /*from*/)
+    {
+        mHistogram.Record(Now() - message.mSendTime);
+
+        if (++mReceivedCount == mExpectedCount)
+        {
+            Send(0, mCaller);
+        }
+    }
+
+    Histogram mHistogram;
+    Theron::Address mCaller;
+    Theron::uint32_t mExpectedCount;
+    Theron::uint32_t mReceivedCount;
+};
+
+
+// Sends a burst of freshly-stamped messages to a target on command.
+class Producer : public Theron::Actor
+{
+public:
+
+    struct BurstMessage
+    {
+        inline BurstMessage() : mCount(0)
+        {
+        }
+
+        inline BurstMessage(const Theron::Address &target, const Theron::uint32_t count) :
+          mTarget(target),
+          mCount(count)
+        {
+        }
+
+        Theron::Address mTarget;
+        Theron::uint32_t mCount;
+    };
+
+    inline explicit Producer(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Producer::Burst);
+    }
+
+private:
+
+    inline void Burst(const BurstMessage &message, const Theron::Address /*from*/)
+    {
+        for (Theron::uint32_t index = 0; index < message.mCount; ++index)
+        {
+            Send(StampedMessage(Now()), message.mTarget);
+        }
+    }
+};
+
+
+// Register the message types so that registered names are used instead of dynamic_cast.
+THERON_DECLARE_REGISTERED_MESSAGE(int);
+THERON_DECLARE_REGISTERED_MESSAGE(StampedMessage);
+THERON_DECLARE_REGISTERED_MESSAGE(Producer::BurstMessage);
+
+THERON_DEFINE_REGISTERED_MESSAGE(int);
+THERON_DEFINE_REGISTERED_MESSAGE(StampedMessage);
+THERON_DEFINE_REGISTERED_MESSAGE(Producer::BurstMessage);
+
+
+// Runs one scenario: the given number of producers flooding one aggregator.
+static void RunScenario(
+    const Theron::uint32_t numMessages,
+    const Theron::uint32_t numThreads,
+    const Theron::uint32_t numProducers)
+{
+    Theron::Framework framework(numThreads);
+    Theron::Receiver receiver;
+
+    // Hold the total message count roughly constant across producer counts,
+    // so the scenarios differ only in how contended the mailbox is.
+    const Theron::uint32_t messagesPerProducer(numMessages / numProducers > 0 ? numMessages / numProducers : 1);
+    const Theron::uint32_t totalMessages(messagesPerProducer * numProducers);
+
+    Aggregator aggregator(framework, receiver.GetAddress(), totalMessages);
+
+    Producer **const producers(new Producer *[numProducers]);
+    for (Theron::uint32_t index = 0; index < numProducers; ++index)
+    {
+        producers[index] = new Producer(framework);
+    }
+
+    Timer timer;
+    timer.Start();
+
+    for (Theron::uint32_t index = 0; index < numProducers; ++index)
+    {
+        framework.Send(
+            Producer::BurstMessage(aggregator.GetAddress(), messagesPerProducer),
+            receiver.GetAddress(),
+            producers[index]->GetAddress());
+    }
+
+    receiver.Wait();
+    timer.Stop();
+
+    const Histogram &histogram(aggregator.GetHistogram());
+    const float seconds(timer.Seconds());
+    const float throughput(seconds > 0.0f ? static_cast<float>(totalMessages) / seconds : 0.0f);
+
+    printf("%9d %12d %14.0f %10llu %10llu %10llu %10llu\n",
+        static_cast<int>(numProducers),
+        static_cast<int>(totalMessages),
+        static_cast<double>(throughput),
+        static_cast<unsigned long long>(histogram.Percentile(50.0)),
+        static_cast<unsigned long long>(histogram.Percentile(99.0)),
+        static_cast<unsigned long long>(histogram.Percentile(99.9)),
+        static_cast<unsigned long long>(histogram.Max()));
+
+    for (Theron::uint32_t index = 0; index < numProducers; ++index)
+    {
+        delete producers[index];
+    }
+
+    delete [] producers;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 1000000;
+    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+    const int maxProducers = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 128;
+
+    printf("Using numMessages = %d (use first command line argument to change)\n", numMessages);
+    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
+    printf("Using maxProducers = %d (use third command line argument to change)\n", maxProducers);
+    printf("Sweeping producer counts against one aggregator actor...\n\n");
+
+    printf("%9s %12s %14s %10s %10s %10s %10s\n",
+        "producers", "messages", "msgs/sec", "p50 us", "p99 us", "p99.9 us", "max us");
+
+    for (int numProducers = 1; numProducers <= maxProducers; numProducers *= 2)
+    {
+        RunScenario(
+            static_cast<Theron::uint32_t>(numMessages),
+            static_cast<Theron::uint32_t>(numThreads),
+            static_cast<Theron::uint32_t>(numProducers));
+    }
+
+    return 0;
+}
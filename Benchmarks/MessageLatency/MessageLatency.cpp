@@ -0,0 +1,436 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark measures per-message send-to-handler latency distributions,
+// as opposed to the wall-clock totals measured by PingPong and ThreadRing.
+// Every message carries the time at which it was sent, the receiving handler
+// records the elapsed time in an HDR-style histogram, and the benchmark prints
+// the p50, p99, p99.9 and max latencies of each scenario. Totals and means
+// hide scheduling hiccups that only hit a fraction of messages, so scheduler
+// and queueing changes are evaluated against these tail percentiles instead.
+//
+// Four scenarios cover the common communication shapes:
+// * Fan-in: many producers send to a single actor, contending on its mailbox.
+// * Fan-out: a single actor distributes messages across many receivers.
+// * Pipeline: messages pass along a chain of actors, timed per hop.
+// * Priority: a high-priority actor is timed while bulk traffic floods others.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Theron/Theron.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+
+#include "../Common/Histogram.h"
+
+
+// A message stamped with the time at which it was sent, in microseconds.
+struct StampedMessage
+{
+    inline StampedMessage() : mSendTime(0)
+    {
+    }
+
+    inline explicit StampedMessage(const Theron::uint64_t sendTime) : mSendTime(sendTime)
+    {
+    }
+
+    Theron::uint64_t mSendTime;
+};
+
+
+inline static Theron::uint64_t Now()
+{
+    return Theron::Detail::ProfileClock::GetMicroseconds();
+}
+
+
+// Records the send-to-handler latency of every stamped message it receives,
+// signalling the given address once an expected number have been seen.
+class Recorder : public Theron::Actor
+{
+public:
+
+    inline Recorder(Theron::Framework &framework, const Theron::Address &caller, const Theron::uint32_t expectedCount) :
+      Theron::Actor(framework),
+      mCaller(caller),
+      mExpectedCount(expectedCount),
+      mReceivedCount(0)
+    {
+        RegisterHandler(this, &Recorder::Receive);
+    }
+
+    // Read by the main thread only after the completion signal is received.
+    inline const Histogram &GetHistogram() const
+    {
+        return mHistogram;
+    }
+
+private:
+
+    inline void Receive(const StampedMessage &message, const Theron::Address /*from*/)
+    {
+        mHistogram.Record(Now() - message.mSendTime);
+
+        if (++mReceivedCount == mExpectedCount)
+        {
+            Send(0, mCaller);
+        }
+    }
+
+    Histogram mHistogram;
+    Theron::Address mCaller;
+    Theron::uint32_t mExpectedCount;
+    Theron::uint32_t mReceivedCount;
+};
+
+
+// Sends a burst of freshly-stamped messages to a target on command.
+class Producer : public Theron::Actor
+{
+public:
+
+    struct BurstMessage
+    {
+        inline BurstMessage() : mCount(0)
+        {
+        }
+
+        inline BurstMessage(const Theron::Address &target, const Theron::uint32_t count) :
+          mTarget(target),
+          mCount(count)
+        {
+        }
+
+        Theron::Address mTarget;
+        Theron::uint32_t mCount;
+    };
+
+    inline explicit Producer(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Producer::Burst);
+    }
+
+private:
+
+    inline void Burst(const BurstMessage &message, const Theron::Address /*from*/)
+    {
+        for (Theron::uint32_t index = 0; index < message.mCount; ++index)
+        {
+            Send(StampedMessage(Now()), message.mTarget);
+        }
+    }
+};
+
+// Distributes a burst of freshly-stamped messages across a set of targets.
+class Distributor : public Theron::Actor
+{
+public:
+
+    struct ScatterMessage
+    {
+        inline ScatterMessage() : mTargets(0), mNumTargets(0), mCount(0)
+        {
+        }
+
+        inline ScatterMessage(const Theron::Address *const targets, const Theron::uint32_t numTargets, const Theron::uint32_t count) :
+          mTargets(targets),
+          mNumTargets(numTargets),
+          mCount(count)
+        {
+        }
+
+        const Theron::Address *mTargets;
+        Theron::uint32_t mNumTargets;
+        Theron::uint32_t mCount;
+    };
+
+    inline explicit Distributor(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Distributor::Scatter);
+    }
+
+private:
+
+    inline void Scatter(const ScatterMessage &message, const Theron::Address /*from*/)
+    {
+        for (Theron::uint32_t index = 0; index < message.mCount; ++index)
+        {
+            Send(StampedMessage(Now()), message.mTargets[index % message.mNumTargets]);
+        }
+    }
+};
+
+// A pipeline stage: records the latency of each hop, then re-stamps the
+// message and forwards it, so each stage measures its own receive latency.
+class Stage : public Theron::Actor
+{
+public:
+
+    inline Stage(Theron::Framework &framework, const Theron::Address &next) :
+      Theron::Actor(framework),
+      mNext(next)
+    {
+        RegisterHandler(this, &Stage::Receive);
+    }
+
+    inline const Histogram &GetHistogram() const
+    {
+        return mHistogram;
+    }
+
+private:
+
+    inline void Receive(const StampedMessage &message, const Theron::Address /*from*/)
+    {
+        mHistogram.Record(Now() - message.mSendTime);
+        TailSend(StampedMessage(Now()), mNext);
+    }
+
+    Histogram mHistogram;
+    Theron::Address mNext;
+};
+
+// Bounces integer messages back to the sender for as long as they're non-zero,
+// providing bulk background load without any timing.
+class Bouncer : public Theron::Actor
+{
+public:
+
+    inline Bouncer(Theron::Framework &framework, const Theron::Address &caller) :
+      Theron::Actor(framework),
+      mCaller(caller)
+    {
+        RegisterHandler(this, &Bouncer::Receive);
+    }
+
+private:
+
+    inline void Receive(const int &message, const Theron::Address from)
+    {
+        if (message > 0)
+        {
+            TailSend(message - 1, from);
+            return;
+        }
+
+        Send(0, mCaller);
+    }
+
+    Theron::Address mCaller;
+};
+
+
+// Register the message types so that registered names are used instead of dynamic_cast.
+THERON_DECLARE_REGISTERED_MESSAGE(int);
+THERON_DECLARE_REGISTERED_MESSAGE(StampedMessage);
+THERON_DECLARE_REGISTERED_MESSAGE(Producer::BurstMessage);
+THERON_DECLARE_REGISTERED_MESSAGE(Distributor::ScatterMessage);
+
+THERON_DEFINE_REGISTERED_MESSAGE(int);
+THERON_DEFINE_REGISTERED_MESSAGE(StampedMessage);
+THERON_DEFINE_REGISTERED_MESSAGE(Producer::BurstMessage);
+THERON_DEFINE_REGISTERED_MESSAGE(Distributor::ScatterMessage);
+
+
+// Many producers flooding a single actor through one contended mailbox.
+static void FanIn(const Theron::uint32_t numMessages, const Theron::uint32_t numThreads, const Theron::uint32_t numActors)
+{
+    Theron::Framework framework(numThreads);
+    Theron::Receiver receiver;
+
+    const Theron::uint32_t messagesPerProducer(numMessages / numActors);
+
+    Recorder recorder(framework, receiver.GetAddress(), messagesPerProducer * numActors);
+
+    Producer **const producers(new Producer *[numActors]);
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        producers[index] = new Producer(framework);
+    }
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        framework.Send(
+            Producer::BurstMessage(recorder.GetAddress(), messagesPerProducer),
+            receiver.GetAddress(),
+            producers[index]->GetAddress());
+    }
+
+    receiver.Wait();
+    recorder.GetHistogram().Print("fan-in");
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        delete producers[index];
+    }
+
+    delete [] producers;
+}
+
+
+// A single actor distributing messages round-robin across many receivers.
+static void FanOut(const Theron::uint32_t numMessages, const Theron::uint32_t numThreads, const Theron::uint32_t numActors)
+{
+    Theron::Framework framework(numThreads);
+    Theron::Receiver receiver;
+
+    const Theron::uint32_t messagesPerRecorder(numMessages / numActors);
+
+    Recorder **const recorders(new Recorder *[numActors]);
+    Theron::Address *const targets(new Theron::Address[numActors]);
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        recorders[index] = new Recorder(framework, receiver.GetAddress(), messagesPerRecorder);
+        targets[index] = recorders[index]->GetAddress();
+    }
+
+    Distributor distributor(framework);
+    framework.Send(
+        Distributor::ScatterMessage(targets, numActors, messagesPerRecorder * numActors),
+        receiver.GetAddress(),
+        distributor.GetAddress());
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        receiver.Wait();
+    }
+
+    Histogram merged;
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        merged.Merge(recorders[index]->GetHistogram());
+    }
+
+    merged.Print("fan-out");
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        delete recorders[index];
+    }
+
+    delete [] recorders;
+    delete [] targets;
+}
+
+
+// Messages passing along a chain of actors, with each hop timed separately.
+static void Pipeline(const Theron::uint32_t numMessages, const Theron::uint32_t numThreads, const Theron::uint32_t numStages)
+{
+    Theron::Framework framework(numThreads);
+    Theron::Receiver receiver;
+
+    const Theron::uint32_t messagesPerRun(numMessages / numStages);
+
+    // The final stage of the pipeline records latencies like any other and
+    // signals completion; the others forward to their successors.
+    Recorder recorder(framework, receiver.GetAddress(), messagesPerRun);
+
+    Stage **const stages(new Stage *[numStages]);
+    Theron::Address next(recorder.GetAddress());
+
+    for (Theron::uint32_t index = numStages; index > 0; --index)
+    {
+        stages[index - 1] = new Stage(framework, next);
+        next = stages[index - 1]->GetAddress();
+    }
+
+    for (Theron::uint32_t index = 0; index < messagesPerRun; ++index)
+    {
+        framework.Send(StampedMessage(Now()), receiver.GetAddress(), next);
+    }
+
+    receiver.Wait();
+
+    Histogram merged;
+    for (Theron::uint32_t index = 0; index < numStages; ++index)
+    {
+        merged.Merge(stages[index]->GetHistogram());
+    }
+
+    merged.Merge(recorder.GetHistogram());
+    merged.Print("pipeline");
+
+    for (Theron::uint32_t index = 0; index < numStages; ++index)
+    {
+        delete stages[index];
+    }
+
+    delete [] stages;
+}
+
+
+// A high-priority actor timed while bulk traffic floods ordinary actors,
+// showing how far priority scheduling protects its tail latency.
+static void Priority(const Theron::uint32_t numMessages, const Theron::uint32_t numThreads, const Theron::uint32_t numActors)
+{
+    Theron::Framework framework(numThreads);
+    Theron::Receiver receiver;
+
+    const Theron::uint32_t bouncesPerPair(numMessages / numActors);
+    const Theron::uint32_t timedMessages(numMessages / 100 > 0 ? numMessages / 100 : 1);
+
+    Recorder recorder(framework, receiver.GetAddress(), timedMessages);
+    framework.SetPriority(recorder.GetAddress(), true);
+
+    // Pairs of bouncers exchanging messages generate the background flood.
+    Bouncer **const bouncers(new Bouncer *[numActors]);
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        bouncers[index] = new Bouncer(framework, receiver.GetAddress());
+    }
+
+    for (Theron::uint32_t index = 0; index + 1 < numActors; index += 2)
+    {
+        framework.Send(
+            static_cast<int>(bouncesPerPair),
+            bouncers[index + 1]->GetAddress(),
+            bouncers[index]->GetAddress());
+    }
+
+    // Time stamped messages to the high-priority actor amid the flood.
+    Producer producer(framework);
+    framework.Send(
+        Producer::BurstMessage(recorder.GetAddress(), timedMessages),
+        receiver.GetAddress(),
+        producer.GetAddress());
+
+    // Wait for the timed messages and for each bouncer pair to finish.
+    for (Theron::uint32_t index = 0; index < numActors / 2 + 1; ++index)
+    {
+        receiver.Wait();
+    }
+
+    recorder.GetHistogram().Print("priority");
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        delete bouncers[index];
+    }
+
+    delete [] bouncers;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 1000000;
+    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+    const int numActors = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 16;
+
+    printf("Using numMessages = %d (use first command line argument to change)\n", numMessages);
+    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
+    printf("Using numActors = %d (use third command line argument to change)\n", numActors);
+    printf("Measuring send-to-handler latency distributions...\n");
+
+    FanIn(numMessages, numThreads, numActors);
+    FanOut(numMessages, numThreads, numActors);
+    Pipeline(numMessages, numThreads, numActors);
+    Priority(numMessages, numThreads, numActors);
+
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark measures the XS network transport path, which the network
+// test suite checks only for correctness. Two endpoints in the same process
+// are connected back-to-back and a replier actor on one endpoint bounces
+// messages sent from the other, measuring round-trip time and remote send
+// throughput across payload sizes from 16 bytes to 16 megabytes.
+//
+// Each payload size is measured over two transports: inproc, which runs the
+// full serialize/deserialize path without touching a real socket, and tcp
+// loopback, which adds the socket send and receive on top. The difference
+// between the two round-trip times therefore approximates the socket share of
+// the cost, with the inproc time approximating the serialization share.
+//
+// Requires Theron to be built with Crossroads IO support (THERON_XS).
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+
+#if THERON_XS
+
+
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#include "../Common/Histogram.h"
+#include "../Common/Timer.h"
+
+
+// A payload message of a given size in bytes.
+template <Theron::uint32_t SIZE>
+struct SizedMessage
+{
+    char mData[SIZE];
+};
+
+
+// Each payload size is a distinct registered message type, so that the sends
+// exercise the same name-based dispatch as real remote traffic.
+typedef SizedMessage<16> Message16B;
+typedef SizedMessage<256> Message256B;
+typedef SizedMessage<4 * 1024> Message4KB;
+typedef SizedMessage<64 * 1024> Message64KB;
+typedef SizedMessage<1024 * 1024> Message1MB;
+typedef SizedMessage<16 * 1024 * 1024> Message16MB;
+
+THERON_REGISTER_MESSAGE(Message16B);
+THERON_REGISTER_MESSAGE(Message256B);
+THERON_REGISTER_MESSAGE(Message4KB);
+THERON_REGISTER_MESSAGE(Message64KB);
+THERON_REGISTER_MESSAGE(Message1MB);
+THERON_REGISTER_MESSAGE(Message16MB);
+
+
+inline static Theron::uint64_t Now()
+{
+    return Theron::Detail::ProfileClock::GetMicroseconds();
+}
+
+
+// Bounces every received message straight back to its sender.
+template <class MessageType>
+class Replier : public Theron::Actor
+{
+public:
+
+    inline Replier(Theron::Framework &framework, const char *const name) : Theron::Actor(framework, name)
+    {
+        RegisterHandler(this, &Replier::Handler);
+    }
+
+private:
+
+    inline void Handler(const MessageType &message, const Theron::Address from)
+    {
+        Send(message, from);
+    }
+};
+
+
+// The results of measuring one payload size over one transport.
+struct ScenarioResult
+{
+    Theron::uint64_t mMedianMicroseconds;
+    Theron::uint64_t mMaxMicroseconds;
+    float mMegabytesPerSecond;
+};
+
+
+// Measures round trips of one payload size between two endpoints connected
+// over the given transport locations.
+template <class MessageType>
+static ScenarioResult RunScenario(
+    const char *const locationOne,
+    const char *const locationTwo,
+    const int numSamples)
+{
+    // Scale the sample counts down for the larger payloads so that every
+    // size finishes in comparable time.
+    const Theron::uint32_t payloadSize(sizeof(MessageType));
+    int rttSamples(numSamples);
+    while (rttSamples > 4 && static_cast<Theron::uint64_t>(rttSamples) * payloadSize > 256 * 1024 * 1024)
+    {
+        rttSamples /= 2;
+    }
+
+    // Create and cross-connect the two endpoints.
+    Theron::EndPoint endPointOne("round_trip_one", locationOne);
+    Theron::EndPoint endPointTwo("round_trip_two", locationTwo);
+
+    endPointOne.Connect(locationTwo);
+    endPointTwo.Connect(locationOne);
+
+    // The sender side lives at endpoint one, the replier at endpoint two.
+    Theron::Framework frameworkOne(endPointOne);
+    Theron::Receiver receiver(endPointOne, "round_trip_receiver");
+
+    Theron::Framework frameworkTwo(endPointTwo);
+    Replier<MessageType> replier(frameworkTwo, "round_trip_replier");
+
+    // The payload is heap-allocated since the largest size is 16MB.
+    MessageType *const message(new MessageType);
+    memset(message->mData, 0, sizeof(message->mData));
+
+    // We have to resend until the Connect actually connects.
+    while (receiver.Count() == 0)
+    {
+        frameworkOne.Send(
+            *message,
+            Theron::Address("round_trip_receiver"),
+            Theron::Address("round_trip_replier"));
+
+        Theron::Detail::Utils::SleepThread(100);
+    }
+
+    while (receiver.Count())
+    {
+        receiver.Wait();
+    }
+
+    // Serial round trips with one message in flight measure latency.
+    Histogram histogram;
+    for (int sample = 0; sample < rttSamples; ++sample)
+    {
+        const Theron::uint64_t startTime(Now());
+
+        frameworkOne.Send(
+            *message,
+            receiver.GetAddress(),
+            Theron::Address("round_trip_replier"));
+
+        receiver.Wait();
+        histogram.Record(Now() - startTime);
+    }
+
+    // A pipelined burst with all messages in flight measures throughput.
+    Timer timer;
+    timer.Start();
+
+    for (int sample = 0; sample < rttSamples; ++sample)
+    {
+        frameworkOne.Send(
+            *message,
+            receiver.GetAddress(),
+            Theron::Address("round_trip_replier"));
+    }
+
+    Theron::uint32_t outstanding(static_cast<Theron::uint32_t>(rttSamples));
+    while (outstanding)
+    {
+        outstanding -= receiver.Wait(outstanding);
+    }
+
+    timer.Stop();
+
+    delete message;
+
+    ScenarioResult result;
+    result.mMedianMicroseconds = histogram.Percentile(50.0);
+    result.mMaxMicroseconds = histogram.Max();
+
+    // Each round trip carries the payload across the wire twice.
+    const float wireBytes(2.0f * static_cast<float>(payloadSize) * static_cast<float>(rttSamples));
+    result.mMegabytesPerSecond = timer.Seconds() > 0.0f ? wireBytes / (timer.Seconds() * 1024.0f * 1024.0f) : 0.0f;
+
+    return result;
+}
+
+
+// Measures one payload size over both transports and prints the comparison.
+template <class MessageType>
+static void RunSize(const char *const sizeName, const int numSamples, const int tcpPort)
+{
+    const ScenarioResult inproc(RunScenario<MessageType>(
+        "inproc://round_trip_one",
+        "inproc://round_trip_two",
+        numSamples));
+
+    char locationOne[64];
+    char locationTwo[64];
+    sprintf(locationOne, "tcp://127.0.0.1:%d", tcpPort);
+    sprintf(locationTwo, "tcp://127.0.0.1:%d", tcpPort + 1);
+
+    const ScenarioResult tcp(RunScenario<MessageType>(
+        locationOne,
+        locationTwo,
+        numSamples));
+
+    // The inproc round trip approximates the serialization cost; the
+    // difference from the tcp round trip approximates the socket cost.
+    const Theron::uint64_t socketShare(
+        tcp.mMedianMicroseconds > inproc.mMedianMicroseconds ?
+        tcp.mMedianMicroseconds - inproc.mMedianMicroseconds : 0);
+
+    printf("%8s %14llu %14llu %12llu %12llu %10.1f %10.1f\n",
+        sizeName,
+        static_cast<unsigned long long>(inproc.mMedianMicroseconds),
+        static_cast<unsigned long long>(tcp.mMedianMicroseconds),
+        static_cast<unsigned long long>(socketShare),
+        static_cast<unsigned long long>(tcp.mMaxMicroseconds),
+        static_cast<double>(inproc.mMegabytesPerSecond),
+        static_cast<double>(tcp.mMegabytesPerSecond));
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int numSamples = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 1000;
+    const int tcpPort = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 5555;
+
+    printf("Using numSamples = %d (use first command line argument to change)\n", numSamples);
+    printf("Using tcpPort = %d (use second command line argument to change)\n", tcpPort);
+    printf("Measuring network round trips between two connected endpoints...\n\n");
+
+    printf("%8s %14s %14s %12s %12s %10s %10s\n",
+        "size", "inproc p50 us", "tcp p50 us", "socket us", "tcp max us", "inproc MB/s", "tcp MB/s");
+
+    RunSize<Message16B>("16B", numSamples, tcpPort);
+    RunSize<Message256B>("256B", numSamples, tcpPort + 2);
+    RunSize<Message4KB>("4KB", numSamples, tcpPort + 4);
+    RunSize<Message64KB>("64KB", numSamples, tcpPort + 6);
+    RunSize<Message1MB>("1MB", numSamples, tcpPort + 8);
+    RunSize<Message16MB>("16MB", numSamples, tcpPort + 10);
+
+    return 0;
+}
+
+
+#else // THERON_XS
+
+
+int main(int /*argc*/, char * /*argv*/[])
+{
+    printf("The NetRoundTrip benchmark requires Theron to be built with Crossroads IO support (THERON_XS).\n");
+    return 0;
+}
+
+
+#endif // THERON_XS
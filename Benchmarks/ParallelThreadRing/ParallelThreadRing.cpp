@@ -1,159 +1,561 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-//
-// This benchmark implements a variant on the "thread-ring" benchmark intended to
-// measure the raw speed of message passing. In the traditional benchmark, a single
-// "token" message is sent around a ring of connected actors. The token is an integer
-// counter, and the counter is decremented with every hop. When the token value reaches
-// zero the identity of the actor holding the token is printed out.
-//
-// Note that the processing within each actor is trivial and consists only of decrementing
-// the value of the token it received in a message, and forwarding it to the next actor
-// in the ring in another message. To form the ring, each actor is provided with the address
-// of the next actor in the ring on construction.
-//
-// Unlike the standard benchmark, this variant creates 503 tokens instead of just one.
-// Each of the actors in the ring is passed one token initially. As before, the tokens
-// are passed around the ring and decremented with each hop until they reach zero. The
-// waiting main program terminates when it has received all of the replies, indicating
-// all the tokens have reached zero. The total number of "hops" to be performed is split
-// equally between the 503 tokens, so that between them they perform the intended number
-// of hops, but in parallel.
-//
-// This benchmark is a more severe (and arguably more meaningful) measure of the raw
-// performance of an Actor Model implementation, since it involves parallel message
-// passing and so contention over the shared components of the message passing mechanism.
-// It's execution times show a lot of variability, presumably because the execution order
-// (the order in which the actors are processed) is non-deterministic and can vary from
-// one run to the next.
-//
-
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <vector>
-
-#include <Theron/Theron.h>
-
-#include "../Common/Timer.h"
-
-
-class Member : public Theron::Actor
-{
-public:
-
-    inline Member(Theron::Framework &framework) : Theron::Actor(framework)
-    {
-        RegisterHandler(this, &Member::InitHandler);
-    }
-
-private:
-
-    inline void InitHandler(const Theron::Address &next, const Theron::Address from)
-    {
-        mNext = next;
-        mCaller = from;
-
-        RegisterHandler(this, &Member::TokenHandler);
-        DeregisterHandler(this, &Member::InitHandler);
-    }
-
-    inline void TokenHandler(const int &token, const Theron::Address /*from*/)
-    {
-        int mssg(token);
-        Theron::Address to(mCaller);
-
-        if (token > 0)
-        {
-            mssg = token - 1;
-            to = mNext;
-        }
-
-        TailSend(mssg, to);
-    }
-
-    Theron::Address mNext;
-    Theron::Address mCaller;
-};
-
-
-// Register the message types so that registered names are used instead of dynamic_cast.
-THERON_DECLARE_REGISTERED_MESSAGE(int);
-THERON_DEFINE_REGISTERED_MESSAGE(int);
-
-THERON_DECLARE_REGISTERED_MESSAGE(Theron::Address);
-THERON_DEFINE_REGISTERED_MESSAGE(Theron::Address);
-
-
-int main(int argc, char *argv[])
-{
-    int numMessagesProcessed(0);
-
-    const int numHops = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
-    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
-    const int numActors = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 503;
-    const int tokenValue((numHops + numActors - 1) / numActors);
-
-    printf("Using numHops = %d (use first command line argument to change)\n", numHops);
-    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
-    printf("Using numActors = %d (use third command line argument to change)\n", numActors);
-    printf("Starting %d tokens with initial value %d in a ring of %d actors...\n", numActors, tokenValue, numActors);
-
-    // The reported time includes the startup and cleanup cost.
-    Timer timer;
-    timer.Start();
-
-    {
-        Theron::Framework framework(numThreads);
-        std::vector<Member *> members(numActors);
-        Theron::Receiver receiver;
-
-        // Create the member actors.
-        for (int index = 0; index < numActors; ++index)
-        {
-            members[index] = new Member(framework);
-        }
-
-        // Initialize the actors by passing each one the address of the next actor in the ring.
-        for (int index(numActors - 1), nextIndex(0); index >= 0; nextIndex = index--)
-        {
-            framework.Send(members[nextIndex]->GetAddress(), receiver.GetAddress(), members[index]->GetAddress());
-        }
-
-        // Send exactly one token to each actor, all with the same initial value, rounding up if required.
-        for (int index = 0; index < numActors; ++index)
-        {
-            framework.Send(tokenValue, receiver.GetAddress(), members[index]->GetAddress());
-        }
-
-        // Wait for all signal messages, indicating the tokens have all reached zero.
-        int outstandingCount(numActors);
-        while (outstandingCount)
-        {
-            outstandingCount -= receiver.Wait(outstandingCount);
-        }
-
-        // Destroy the member actors.
-        for (int index = 0; index < numActors; ++index)
-        {
-            delete members[index];
-        }
-
-        numMessagesProcessed = framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED);
-    }
-
-    timer.Stop();
-
-    printf("Processed %d messages in %.1f seconds\n", numMessagesProcessed, timer.Seconds());
-
-#if THERON_ENABLE_DEFAULTALLOCATOR_CHECKS
-    Theron::IAllocator *const allocator(Theron::AllocatorManager::Instance().GetAllocator());
-    const int allocationCount(static_cast<Theron::DefaultAllocator *>(allocator)->GetAllocationCount());
-    const int peakBytesAllocated(static_cast<Theron::DefaultAllocator *>(allocator)->GetPeakBytesAllocated());
-    printf("Total number of allocations: %d calls\n", allocationCount);
-    printf("Peak memory usage in bytes: %d bytes\n", peakBytesAllocated);
-#endif // THERON_ENABLE_DEFAULTALLOCATOR_CHECKS
-
-}
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark implements a variant on the "thread-ring" benchmark intended to
+// measure the raw speed of message passing. In the traditional benchmark, a single
+// "token" message is sent around a ring of connected actors. The token is an integer
+// counter, and the counter is decremented with every hop. When the token value reaches
+// zero the identity of the actor holding the token is printed out.
+//
+// Note that the processing within each actor is trivial and consists only of decrementing
+// the value of the token it received in a message, and forwarding it to the next actor
+// in the ring in another message. To form the ring, each actor is provided with the address
+// of the next actor in the ring on construction.
+//
+// Unlike the standard benchmark, this variant creates 503 tokens instead of just one.
+// Each of the actors in the ring is passed one token initially. As before, the tokens
+// are passed around the ring and decremented with each hop until they reach zero. The
+// waiting main program terminates when it has received all of the replies, indicating
+// all the tokens have reached zero. The total number of "hops" to be performed is split
+// equally between the 503 tokens, so that between them they perform the intended number
+// of hops, but in parallel.
+//
+// This benchmark is a more severe (and arguably more meaningful) measure of the raw
+// performance of an Actor Model implementation, since it involves parallel message
+// passing and so contention over the shared components of the message passing mechanism.
+// It's execution times show a lot of variability, presumably because the execution order
+// (the order in which the actors are processed) is non-deterministic and can vary from
+// one run to the next.
+//
+// Beyond the classic single-configuration run, passing --matrix runs a parameterized
+// contention matrix: the numbers of tokens per ring, rings per framework and actors
+// per ring, the worker yield strategy and the mailbox message batch size are each
+// swept over comma-separated lists of values, and every combination is run as one
+// scenario over the same total hop count. The results are printed as CSV, and
+// optionally written to a file, so the regimes in which the shared work queue breaks
+// down -- few busy mailboxes, many contended mailboxes, oversubscribed tokens -- can
+// be charted directly from one invocation:
+//
+//   parallelthreadring --matrix [--hops n] [--threads n] [--csv file]
+//       [--tokens list] [--rings list] [--actors list] [--yield list] [--batch list]
+//
+// where each list is comma-separated, e.g. --tokens 1,16,503 --yield polite,strong.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <Theron/Theron.h>
+
+#include "../Common/Timer.h"
+
+
+class Member : public Theron::Actor
+{
+public:
+
+    inline Member(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Member::InitHandler);
+    }
+
+private:
+
+    inline void InitHandler(const Theron::Address &next, const Theron::Address from)
+    {
+        mNext = next;
+        mCaller = from;
+
+        RegisterHandler(this, &Member::TokenHandler);
+        DeregisterHandler(this, &Member::InitHandler);
+    }
+
+    inline void TokenHandler(const int &token, const Theron::Address /*from*/)
+    {
+        int mssg(token);
+        Theron::Address to(mCaller);
+
+        if (token > 0)
+        {
+            mssg = token - 1;
+            to = mNext;
+        }
+
+        TailSend(mssg, to);
+    }
+
+    Theron::Address mNext;
+    Theron::Address mCaller;
+};
+
+
+// Register the message types so that registered names are used instead of dynamic_cast.
+THERON_DECLARE_REGISTERED_MESSAGE(int);
+THERON_DEFINE_REGISTERED_MESSAGE(int);
+
+THERON_DECLARE_REGISTERED_MESSAGE(Theron::Address);
+THERON_DEFINE_REGISTERED_MESSAGE(Theron::Address);
+
+
+// One axis of the contention matrix: a short list of values parsed from a
+// comma-separated command line argument.
+struct SweepAxis
+{
+    static const int MAX_VALUES = 16;
+
+    inline SweepAxis()
+    {
+        mValues[0] = 0;
+        mCount = 1;
+    }
+
+    inline void Set(const int value)
+    {
+        mValues[0] = value;
+        mCount = 1;
+    }
+
+    inline bool Parse(const char *const text)
+    {
+        mCount = 0;
+
+        const char *ch(text);
+        while (*ch != '\0' && mCount < MAX_VALUES)
+        {
+            const int value(atoi(ch));
+            if (value <= 0)
+            {
+                return false;
+            }
+
+            mValues[mCount++] = value;
+
+            while (*ch != '\0' && *ch != ',')
+            {
+                ++ch;
+            }
+
+            if (*ch == ',')
+            {
+                ++ch;
+            }
+        }
+
+        return (mCount > 0);
+    }
+
+    int mValues[MAX_VALUES];
+    int mCount;
+};
+
+
+// Returns the yield strategy named by a command line argument value.
+static bool ParseYieldStrategy(const char *const name, Theron::YieldStrategy &strategy)
+{
+    if (strcmp(name, "polite") == 0)
+    {
+        strategy = Theron::YIELD_STRATEGY_POLITE;
+    }
+    else if (strcmp(name, "strong") == 0)
+    {
+        strategy = Theron::YIELD_STRATEGY_STRONG;
+    }
+    else if (strcmp(name, "aggressive") == 0)
+    {
+        strategy = Theron::YIELD_STRATEGY_AGGRESSIVE;
+    }
+    else if (strcmp(name, "blocking") == 0)
+    {
+        strategy = Theron::YIELD_STRATEGY_BLOCKING;
+    }
+    else if (strcmp(name, "adaptive") == 0)
+    {
+        strategy = Theron::YIELD_STRATEGY_ADAPTIVE;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+static const char *YieldStrategyName(const Theron::YieldStrategy strategy)
+{
+    switch (strategy)
+    {
+        case Theron::YIELD_STRATEGY_POLITE:     return "polite";
+        case Theron::YIELD_STRATEGY_STRONG:     return "strong";
+        case Theron::YIELD_STRATEGY_AGGRESSIVE: return "aggressive";
+        case Theron::YIELD_STRATEGY_BLOCKING:   return "blocking";
+        case Theron::YIELD_STRATEGY_ADAPTIVE:   return "adaptive";
+        default:                                return "unknown";
+    }
+}
+
+
+// The measured results of one scenario of the matrix.
+struct ScenarioResult
+{
+    float mSeconds;
+    Theron::uint32_t mMessagesProcessed;
+    Theron::uint32_t mSharedPushes;
+    Theron::uint32_t mMailboxSteals;
+    Theron::uint32_t mYields;
+};
+
+
+// Runs one scenario: the given number of independent rings in one framework,
+// each of the given size, with the given number of tokens circling each ring.
+// The total hop count is split equally between all the tokens of all the rings,
+// so scenarios of one matrix differ only in how the same volume of message
+// passing is distributed and contended.
+static void RunScenario(
+    const int numHops,
+    const int numThreads,
+    const Theron::YieldStrategy yieldStrategy,
+    const int batchSize,
+    const int numRings,
+    const int actorsPerRing,
+    const int tokensPerRing,
+    ScenarioResult &result)
+{
+    const int numTokens(numRings * tokensPerRing);
+    const int tokenValue((numHops + numTokens - 1) / numTokens);
+
+    Timer timer;
+    timer.Start();
+
+    {
+        const Theron::Framework::Parameters parameters(
+            static_cast<Theron::uint32_t>(numThreads),
+            0x1,
+            0xFFFFFFFF,
+            yieldStrategy);
+
+        Theron::Framework::Parameters batchedParameters(parameters);
+        batchedParameters.mMessageBatchSize = static_cast<Theron::uint32_t>(batchSize);
+
+        Theron::Framework framework(batchedParameters);
+        std::vector<Member *> members(numRings * actorsPerRing);
+        Theron::Receiver receiver;
+
+        // Create the member actors of all the rings.
+        for (int index = 0; index < numRings * actorsPerRing; ++index)
+        {
+            members[index] = new Member(framework);
+        }
+
+        // Connect the members of each ring, leaving the rings disjoint.
+        for (int ring = 0; ring < numRings; ++ring)
+        {
+            Member *const *const ringMembers(&members[ring * actorsPerRing]);
+
+            for (int index(actorsPerRing - 1), nextIndex(0); index >= 0; nextIndex = index--)
+            {
+                framework.Send(ringMembers[nextIndex]->GetAddress(), receiver.GetAddress(), ringMembers[index]->GetAddress());
+            }
+        }
+
+        // Start the tokens of each ring, spread over the members of the ring.
+        for (int ring = 0; ring < numRings; ++ring)
+        {
+            Member *const *const ringMembers(&members[ring * actorsPerRing]);
+
+            for (int token = 0; token < tokensPerRing; ++token)
+            {
+                framework.Send(tokenValue, receiver.GetAddress(), ringMembers[token % actorsPerRing]->GetAddress());
+            }
+        }
+
+        // Wait for all signal messages, indicating the tokens have all reached zero.
+        int outstandingCount(numTokens);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // Destroy the member actors.
+        for (int index = 0; index < numRings * actorsPerRing; ++index)
+        {
+            delete members[index];
+        }
+
+        result.mMessagesProcessed = framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED);
+        result.mSharedPushes = framework.GetCounterValue(Theron::COUNTER_SHARED_PUSHES);
+        result.mMailboxSteals = framework.GetCounterValue(Theron::COUNTER_MAILBOX_STEALS);
+        result.mYields = framework.GetCounterValue(Theron::COUNTER_YIELDS);
+    }
+
+    timer.Stop();
+    result.mSeconds = timer.Seconds();
+}
+
+
+// Runs the full contention matrix and prints one CSV row per scenario.
+static int RunMatrix(int argc, char *argv[])
+{
+    int numHops(10000000);
+    int numThreads(16);
+    const char *csvFileName(0);
+
+    SweepAxis tokensAxis;
+    SweepAxis ringsAxis;
+    SweepAxis actorsAxis;
+    SweepAxis batchAxis;
+
+    tokensAxis.Parse("1,16,503");
+    ringsAxis.Set(1);
+    actorsAxis.Set(503);
+    batchAxis.Set(1);
+
+    Theron::YieldStrategy yieldValues[8];
+    int numYieldValues(1);
+    yieldValues[0] = Theron::YIELD_STRATEGY_POLITE;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        const char *const flag(argv[index]);
+        const char *const value(index + 1 < argc ? argv[index + 1] : 0);
+
+        if (strcmp(flag, "--matrix") == 0)
+        {
+            continue;
+        }
+
+        bool parsed(false);
+        if (value != 0)
+        {
+            if (strcmp(flag, "--hops") == 0)
+            {
+                parsed = ((numHops = atoi(value)) > 0);
+            }
+            else if (strcmp(flag, "--threads") == 0)
+            {
+                parsed = ((numThreads = atoi(value)) > 0);
+            }
+            else if (strcmp(flag, "--csv") == 0)
+            {
+                csvFileName = value;
+                parsed = true;
+            }
+            else if (strcmp(flag, "--tokens") == 0)
+            {
+                parsed = tokensAxis.Parse(value);
+            }
+            else if (strcmp(flag, "--rings") == 0)
+            {
+                parsed = ringsAxis.Parse(value);
+            }
+            else if (strcmp(flag, "--actors") == 0)
+            {
+                parsed = actorsAxis.Parse(value);
+            }
+            else if (strcmp(flag, "--batch") == 0)
+            {
+                parsed = batchAxis.Parse(value);
+            }
+            else if (strcmp(flag, "--yield") == 0)
+            {
+                numYieldValues = 0;
+
+                char names[256];
+                strncpy(names, value, sizeof(names) - 1);
+                names[sizeof(names) - 1] = '\0';
+
+                for (char *name = strtok(names, ","); name != 0; name = strtok(0, ","))
+                {
+                    if (numYieldValues == 8 || !ParseYieldStrategy(name, yieldValues[numYieldValues]))
+                    {
+                        numYieldValues = 0;
+                        break;
+                    }
+
+                    ++numYieldValues;
+                }
+
+                parsed = (numYieldValues > 0);
+            }
+        }
+
+        if (!parsed)
+        {
+            printf("ERROR: Unrecognized or malformed argument '%s'\n", flag);
+            return 1;
+        }
+
+        ++index;
+    }
+
+    FILE *const csvFile(csvFileName ? fopen(csvFileName, "w") : 0);
+    if (csvFileName && csvFile == 0)
+    {
+        printf("ERROR: Failed to open '%s' for writing\n", csvFileName);
+        return 1;
+    }
+
+    const char *const header(
+        "yield,batch,rings,actors_per_ring,tokens_per_ring,threads,hops,"
+        "seconds,msgs_per_sec,messages_processed,shared_pushes,mailbox_steals,yields\n");
+
+    printf("%s", header);
+    if (csvFile)
+    {
+        fprintf(csvFile, "%s", header);
+    }
+
+    for (int yieldIndex = 0; yieldIndex < numYieldValues; ++yieldIndex)
+    {
+        for (int batchIndex = 0; batchIndex < batchAxis.mCount; ++batchIndex)
+        {
+            for (int ringIndex = 0; ringIndex < ringsAxis.mCount; ++ringIndex)
+            {
+                for (int actorIndex = 0; actorIndex < actorsAxis.mCount; ++actorIndex)
+                {
+                    for (int tokenIndex = 0; tokenIndex < tokensAxis.mCount; ++tokenIndex)
+                    {
+                        const Theron::YieldStrategy yieldStrategy(yieldValues[yieldIndex]);
+                        const int batchSize(batchAxis.mValues[batchIndex]);
+                        const int numRings(ringsAxis.mValues[ringIndex]);
+                        const int actorsPerRing(actorsAxis.mValues[actorIndex]);
+                        const int tokensPerRing(tokensAxis.mValues[tokenIndex]);
+
+                        ScenarioResult result;
+                        RunScenario(
+                            numHops,
+                            numThreads,
+                            yieldStrategy,
+                            batchSize,
+                            numRings,
+                            actorsPerRing,
+                            tokensPerRing,
+                            result);
+
+                        const double throughput(
+                            result.mSeconds > 0.0f ? result.mMessagesProcessed / static_cast<double>(result.mSeconds) : 0.0);
+
+                        char row[256];
+                        snprintf(row, sizeof(row), "%s,%d,%d,%d,%d,%d,%d,%.3f,%.0f,%u,%u,%u,%u\n",
+                            YieldStrategyName(yieldStrategy),
+                            batchSize,
+                            numRings,
+                            actorsPerRing,
+                            tokensPerRing,
+                            numThreads,
+                            numHops,
+                            result.mSeconds,
+                            throughput,
+                            result.mMessagesProcessed,
+                            result.mSharedPushes,
+                            result.mMailboxSteals,
+                            result.mYields);
+
+                        printf("%s", row);
+                        fflush(stdout);
+
+                        if (csvFile)
+                        {
+                            fprintf(csvFile, "%s", row);
+                            fflush(csvFile);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (csvFile)
+    {
+        fclose(csvFile);
+        printf("Wrote results to '%s'\n", csvFileName);
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    // The matrix mode sweeps the contention parameters and reports CSV.
+    for (int index = 1; index < argc; ++index)
+    {
+        if (strcmp(argv[index], "--matrix") == 0)
+        {
+            return RunMatrix(argc, argv);
+        }
+    }
+
+    int numMessagesProcessed(0);
+
+    const int numHops = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
+    const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+    const int numActors = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 503;
+    const int tokenValue((numHops + numActors - 1) / numActors);
+
+    printf("Using numHops = %d (use first command line argument to change)\n", numHops);
+    printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
+    printf("Using numActors = %d (use third command line argument to change)\n", numActors);
+    printf("Starting %d tokens with initial value %d in a ring of %d actors...\n", numActors, tokenValue, numActors);
+
+    // The reported time includes the startup and cleanup cost.
+    Timer timer;
+    timer.Start();
+
+    {
+        Theron::Framework framework(numThreads);
+        std::vector<Member *> members(numActors);
+        Theron::Receiver receiver;
+
+        // Create the member actors.
+        for (int index = 0; index < numActors; ++index)
+        {
+            members[index] = new Member(framework);
+        }
+
+        // Initialize the actors by passing each one the address of the next actor in the ring.
+        for (int index(numActors - 1), nextIndex(0); index >= 0; nextIndex = index--)
+        {
+            framework.Send(members[nextIndex]->GetAddress(), receiver.GetAddress(), members[index]->GetAddress());
+        }
+
+        // Send exactly one token to each actor, all with the same initial value, rounding up if required.
+        for (int index = 0; index < numActors; ++index)
+        {
+            framework.Send(tokenValue, receiver.GetAddress(), members[index]->GetAddress());
+        }
+
+        // Wait for all signal messages, indicating the tokens have all reached zero.
+        int outstandingCount(numActors);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // Destroy the member actors.
+        for (int index = 0; index < numActors; ++index)
+        {
+            delete members[index];
+        }
+
+        numMessagesProcessed = framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED);
+    }
+
+    timer.Stop();
+
+    printf("Processed %d messages in %.1f seconds\n", numMessagesProcessed, timer.Seconds());
+
+#if THERON_ENABLE_DEFAULTALLOCATOR_CHECKS
+    Theron::IAllocator *const allocator(Theron::AllocatorManager::Instance().GetAllocator());
+    const int allocationCount(static_cast<Theron::DefaultAllocator *>(allocator)->GetAllocationCount());
+    const int peakBytesAllocated(static_cast<Theron::DefaultAllocator *>(allocator)->GetPeakBytesAllocated());
+    printf("Total number of allocations: %d calls\n", allocationCount);
+    printf("Peak memory usage in bytes: %d bytes\n", peakBytesAllocated);
+#endif // THERON_ENABLE_DEFAULTALLOCATOR_CHECKS
+
+}
+
@@ -28,6 +28,7 @@
 
 #include <Theron/Theron.h>
 
+#include "../Common/BenchmarkHarness.h"
 #include "../Common/Timer.h"
 
 
@@ -87,13 +88,53 @@ THERON_DEFINE_REGISTERED_MESSAGE(int);
 THERON_DEFINE_REGISTERED_MESSAGE(PingPong::StartMessage);
 
 
+// Runs the ping-pong scenario on the given framework, for harness sweep mode.
+// Times just the message exchange, as in the default invocation.
+static float RunScenario(Theron::Framework &framework, void *const context)
+{
+    const int numMessages(*reinterpret_cast<const int *>(context));
+
+    Theron::Receiver receiver;
+
+    PingPong ping(framework);
+    PingPong pong(framework);
+
+    // Start Ping and Pong, sending each the address of the other and the address of the receiver.
+    const PingPong::StartMessage pingStart(receiver.GetAddress(), pong.GetAddress());
+    framework.Send(pingStart, receiver.GetAddress(), ping.GetAddress());
+    const PingPong::StartMessage pongStart(receiver.GetAddress(), ping.GetAddress());
+    framework.Send(pongStart, receiver.GetAddress(), pong.GetAddress());
+
+    Timer timer;
+    timer.Start();
+
+    // Send the initial integer count to Ping.
+    framework.Send(numMessages, receiver.GetAddress(), ping.GetAddress());
+
+    // Wait to hear back from either Ping or Pong when the count reaches zero.
+    receiver.Wait();
+    timer.Stop();
+
+    return timer.Seconds();
+}
+
+
 int main(int argc, char *argv[])
 {
     int numMessagesProcessed(0);
 
-    const int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
+    int numMessages = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
     const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
 
+    // In sweep mode the harness runs the scenario across a thread-count sweep,
+    // captures the framework counters, and gates against a stored baseline.
+    BenchmarkHarness harness(argc, argv);
+    if (harness.Enabled())
+    {
+        printf("Using numMessages = %d per run\n", numMessages);
+        return harness.Run("PingPong", RunScenario, &numMessages);
+    }
+
     printf("Using numMessages = %d (use first command line argument to change)\n", numMessages);
     printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
     printf("Starting %d message sends between ping and pong...\n", numMessages);
@@ -0,0 +1,676 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark replays a recorded workload trace against the framework, so
+// scheduler and allocator changes can be evaluated against the message size,
+// destination and fan-out mix of a real deployment rather than the uniform
+// shapes of the synthetic benchmarks (PingPong, ThreadRing, FanIn).
+//
+// A trace is a compact binary schedule of (time, sender, dest, size) tuples,
+// with senders and destinations as dense actor indices. Traces are produced
+// either by distilling a message journal written via
+// EndPoint::Parameters::mJournalPath (--distill), which maps the recorded
+// endpoint names to actor indices and takes each message's serialized size,
+// or synthetically (--generate) for smoke-testing the harness itself.
+//
+// Replay constructs one worker actor per trace index and sends each record to
+// its destination actor as a payload of the smallest built-in size class that
+// holds the recorded size, stamped with its send time. By default records are
+// sent as fast as possible, measuring peak throughput; with --paced the replay
+// reproduces the recorded inter-send gaps, measuring the queueing latencies
+// the scheduler achieves at the recorded arrival rate. The framework
+// parameters under test -- thread count and yield strategy -- are set on the
+// command line. Sends are issued by the main thread with the recorded sender's
+// address as the from address, so the per-destination arrival mix is
+// reproduced exactly; what is not reproduced is sends originating inside
+// message handlers.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Network/FlatMessage.h>
+#include <Theron/Detail/Network/MessageJournal.h>
+#include <Theron/Detail/Network/NetworkMessage.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#include "../Common/Histogram.h"
+#include "../Common/Timer.h"
+
+
+// The trace file format: a fixed header followed by one record per message.
+// Times are in microseconds relative to the first record of the trace.
+struct TraceHeader
+{
+    static const Theron::uint32_t MAGIC = 0x54485254;   // 'THRT'
+    static const Theron::uint32_t VERSION = 1;
+
+    Theron::uint32_t mMagic;
+    Theron::uint32_t mVersion;
+    Theron::uint32_t mNumActors;
+    Theron::uint32_t mNumRecords;
+};
+
+struct TraceRecord
+{
+    Theron::uint64_t mTimeMicroseconds;     // Send time, relative to the start of the trace.
+    Theron::uint32_t mSender;               // Dense index of the sending actor.
+    Theron::uint32_t mDest;                 // Dense index of the destination actor.
+    Theron::uint32_t mSize;                 // Serialized size of the message, in bytes.
+    Theron::uint32_t mPadding;              // Pads the record to a multiple of eight bytes.
+};
+
+
+// Payload size classes; each record is replayed as the smallest class that
+// holds its recorded size, so the allocator sees the recorded size mix
+// bucketed the way message blocks are.
+template <Theron::uint32_t SizeBytes>
+struct Payload
+{
+    Theron::uint64_t mSendTime;
+    Theron::uint8_t mBytes[SizeBytes > sizeof(Theron::uint64_t) ? SizeBytes - sizeof(Theron::uint64_t) : 1];
+};
+
+typedef Payload<64> Payload64;
+typedef Payload<256> Payload256;
+typedef Payload<1024> Payload1K;
+typedef Payload<4096> Payload4K;
+typedef Payload<16384> Payload16K;
+
+
+inline static Theron::uint64_t Now()
+{
+    return Theron::Detail::ProfileClock::GetMicroseconds();
+}
+
+
+// A replay worker: counts the payload messages it receives and records the
+// send-to-handler latency of each, replying with its tally when drained.
+class Worker : public Theron::Actor
+{
+public:
+
+    inline explicit Worker(Theron::Framework &framework) :
+      Theron::Actor(framework),
+      mReceivedCount(0)
+    {
+        RegisterHandler(this, &Worker::Receive64);
+        RegisterHandler(this, &Worker::Receive256);
+        RegisterHandler(this, &Worker::Receive1K);
+        RegisterHandler(this, &Worker::Receive4K);
+        RegisterHandler(this, &Worker::Receive16K);
+        RegisterHandler(this, &Worker::Drain);
+    }
+
+    // Read by the main thread only after the drain reply is received.
+    inline const Histogram &GetHistogram() const
+    {
+        return mHistogram;
+    }
+
+private:
+
+    inline void Record(const Theron::uint64_t sendTime)
+    {
+        mHistogram.Record(Now() - sendTime);
+        ++mReceivedCount;
+    }
+
+    inline void Receive64(const Payload64 &message, const Theron::Address /*from*/)
+    {
+        Record(message.mSendTime);
+    }
+
+    inline void Receive256(const Payload256 &message, const Theron::Address /*from*/)
+    {
+        Record(message.mSendTime);
+    }
+
+    inline void Receive1K(const Payload1K &message, const Theron::Address /*from*/)
+    {
+        Record(message.mSendTime);
+    }
+
+    inline void Receive4K(const Payload4K &message, const Theron::Address /*from*/)
+    {
+        Record(message.mSendTime);
+    }
+
+    inline void Receive16K(const Payload16K &message, const Theron::Address /*from*/)
+    {
+        Record(message.mSendTime);
+    }
+
+    inline void Drain(const int &/*message*/, const Theron::Address from)
+    {
+        // Handlers execute one at a time, so on receipt of the drain marker
+        // every payload sent before it has been counted.
+        Send(mReceivedCount, from);
+    }
+
+    Histogram mHistogram;
+    Theron::uint32_t mReceivedCount;
+};
+
+
+// Register the message types so that registered names are used instead of dynamic_cast.
+THERON_DECLARE_REGISTERED_MESSAGE(int);
+THERON_DECLARE_REGISTERED_MESSAGE(Theron::uint32_t);
+THERON_DECLARE_REGISTERED_MESSAGE(Payload64);
+THERON_DECLARE_REGISTERED_MESSAGE(Payload256);
+THERON_DECLARE_REGISTERED_MESSAGE(Payload1K);
+THERON_DECLARE_REGISTERED_MESSAGE(Payload4K);
+THERON_DECLARE_REGISTERED_MESSAGE(Payload16K);
+
+THERON_DEFINE_REGISTERED_MESSAGE(int);
+THERON_DEFINE_REGISTERED_MESSAGE(Theron::uint32_t);
+THERON_DEFINE_REGISTERED_MESSAGE(Payload64);
+THERON_DEFINE_REGISTERED_MESSAGE(Payload256);
+THERON_DEFINE_REGISTERED_MESSAGE(Payload1K);
+THERON_DEFINE_REGISTERED_MESSAGE(Payload4K);
+THERON_DEFINE_REGISTERED_MESSAGE(Payload16K);
+
+
+// Maps endpoint names seen in a journal to dense actor indices, in order of
+// first appearance. Linear search is fine at distillation time.
+class NameTable
+{
+public:
+
+    inline NameTable() : mCount(0)
+    {
+    }
+
+    inline ~NameTable()
+    {
+        for (Theron::uint32_t index = 0; index < mCount; ++index)
+        {
+            free(mNames[index]);
+        }
+    }
+
+    inline Theron::uint32_t IndexOf(const char *const name)
+    {
+        for (Theron::uint32_t index = 0; index < mCount; ++index)
+        {
+            if (strcmp(mNames[index], name) == 0)
+            {
+                return index;
+            }
+        }
+
+        if (mCount == MAX_NAMES)
+        {
+            printf("ERROR: Trace is limited to %u distinct endpoint names\n", MAX_NAMES);
+            exit(1);
+        }
+
+        mNames[mCount] = strdup(name);
+        return mCount++;
+    }
+
+    inline Theron::uint32_t Count() const
+    {
+        return mCount;
+    }
+
+private:
+
+    static const Theron::uint32_t MAX_NAMES = 65536;
+
+    char *mNames[MAX_NAMES];
+    Theron::uint32_t mCount;
+};
+
+
+// Reads a whole trace file into memory, returning the records and filling in
+// the actor count; returns zero on failure.
+static TraceRecord *LoadTrace(const char *const path, Theron::uint32_t &numActors, Theron::uint32_t &numRecords)
+{
+    FILE *const file(fopen(path, "rb"));
+    if (file == 0)
+    {
+        printf("ERROR: Failed to open trace file '%s'\n", path);
+        return 0;
+    }
+
+    TraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.mMagic != TraceHeader::MAGIC ||
+        header.mVersion != TraceHeader::VERSION)
+    {
+        printf("ERROR: File '%s' is not a version %u trace\n", path, TraceHeader::VERSION);
+        fclose(file);
+        return 0;
+    }
+
+    TraceRecord *const records(new TraceRecord[header.mNumRecords]);
+    if (fread(records, sizeof(TraceRecord), header.mNumRecords, file) != header.mNumRecords)
+    {
+        printf("ERROR: Trace file '%s' is truncated\n", path);
+        fclose(file);
+        delete [] records;
+        return 0;
+    }
+
+    fclose(file);
+
+    numActors = header.mNumActors;
+    numRecords = header.mNumRecords;
+    return records;
+}
+
+
+// Writes a trace file from in-memory records; returns true on success.
+static bool SaveTrace(
+    const char *const path,
+    const TraceRecord *const records,
+    const Theron::uint32_t numActors,
+    const Theron::uint32_t numRecords)
+{
+    FILE *const file(fopen(path, "wb"));
+    if (file == 0)
+    {
+        printf("ERROR: Failed to create trace file '%s'\n", path);
+        return false;
+    }
+
+    TraceHeader header;
+    header.mMagic = TraceHeader::MAGIC;
+    header.mVersion = TraceHeader::VERSION;
+    header.mNumActors = numActors;
+    header.mNumRecords = numRecords;
+
+    const bool written(
+        fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(records, sizeof(TraceRecord), numRecords, file) == numRecords);
+
+    fclose(file);
+
+    if (!written)
+    {
+        printf("ERROR: Failed to write trace file '%s'\n", path);
+    }
+
+    return written;
+}
+
+
+// Distills a message journal written via EndPoint::Parameters::mJournalPath
+// into a trace: endpoint names become dense actor indices in order of first
+// appearance, sizes are the serialized frame plus payload sizes, and times
+// are rebased to the first record.
+static int Distill(const char *const journalPath, const char *const tracePath)
+{
+    Theron::Detail::MessageJournal journal;
+    if (!journal.OpenForReading(journalPath))
+    {
+        printf("ERROR: Failed to open journal file '%s'\n", journalPath);
+        return 1;
+    }
+
+    // No record can be larger than the whole ring.
+    const Theron::uint32_t capacity(journal.GetRingSize());
+    unsigned char *const buffer = static_cast<unsigned char *>(malloc(capacity));
+
+    NameTable names;
+    Theron::uint32_t numRecords(0);
+    Theron::uint32_t maxRecords(65536);
+    TraceRecord *records(new TraceRecord[maxRecords]);
+
+    Theron::uint64_t firstTimestamp(0);
+    Theron::Detail::MessageJournal::RecordHeader header;
+
+    while (journal.ReadNext(header, buffer, capacity))
+    {
+        // Journals written with EndPoint::Parameters::mFlatWireFormat enabled
+        // contain flat frames, identified by their leading marker word.
+        Theron::uint32_t marker(0);
+        memcpy(&marker, buffer, sizeof(Theron::uint32_t));
+
+        const char *fromName(0);
+        const char *toName(0);
+
+        if (marker == Theron::Detail::FlatMessage::MARKER)
+        {
+            const Theron::Detail::FlatMessage *const flatMessage(
+                reinterpret_cast<const Theron::Detail::FlatMessage *>(buffer));
+
+            fromName = flatMessage->GetFromName();
+            toName = flatMessage->GetToName();
+        }
+        else
+        {
+            const Theron::Detail::NetworkMessage *const networkMessage(
+                reinterpret_cast<const Theron::Detail::NetworkMessage *>(buffer));
+
+            fromName = networkMessage->GetFromName();
+            toName = networkMessage->GetToName();
+        }
+
+        if (numRecords == maxRecords)
+        {
+            TraceRecord *const grown(new TraceRecord[maxRecords * 2]);
+            memcpy(grown, records, numRecords * sizeof(TraceRecord));
+            delete [] records;
+            records = grown;
+            maxRecords *= 2;
+        }
+
+        if (numRecords == 0)
+        {
+            firstTimestamp = header.mTimestamp;
+        }
+
+        TraceRecord &record(records[numRecords++]);
+        record.mTimeMicroseconds = header.mTimestamp - firstTimestamp;
+        record.mSender = names.IndexOf(fromName);
+        record.mDest = names.IndexOf(toName);
+        record.mSize = header.mFrameSize + header.mPayloadSize;
+        record.mPadding = 0;
+    }
+
+    free(buffer);
+    journal.Close();
+
+    const bool saved(SaveTrace(tracePath, records, names.Count(), numRecords));
+    if (saved)
+    {
+        printf("Distilled %u journaled messages between %u endpoints into '%s'\n",
+            numRecords, names.Count(), tracePath);
+    }
+
+    delete [] records;
+    return saved ? 0 : 1;
+}
+
+
+// Generates a synthetic trace for smoke-testing the harness: a skewed
+// destination distribution (a few hot actors and a long cool tail), the
+// message block size mix of the allocator benchmark, and a steady 100k
+// messages-per-second arrival rate.
+static int Generate(const char *const tracePath, const Theron::uint32_t numActors, const Theron::uint32_t numRecords)
+{
+    static const Theron::uint32_t sizes[] = { 16, 16, 16, 16, 64, 64, 256, 1024 };
+    static const Theron::uint32_t NUM_SIZES = sizeof(sizes) / sizeof(sizes[0]);
+
+    TraceRecord *const records(new TraceRecord[numRecords]);
+
+    // A cheap linear congruential sequence; real randomness isn't needed.
+    Theron::uint32_t next(12345);
+
+    for (Theron::uint32_t index = 0; index < numRecords; ++index)
+    {
+        TraceRecord &record(records[index]);
+
+        next = next * 1664525 + 1013904223;
+        const Theron::uint32_t senderDraw((next >> 16) % numActors);
+
+        next = next * 1664525 + 1013904223;
+        const Theron::uint32_t destDraw((next >> 16) % numActors);
+
+        next = next * 1664525 + 1013904223;
+        const Theron::uint32_t sizeDraw((next >> 16) % NUM_SIZES);
+
+        // Square the destination draw to skew traffic towards low indices.
+        record.mTimeMicroseconds = index * 10;
+        record.mSender = senderDraw;
+        record.mDest = (destDraw * destDraw) / (numActors > 1 ? numActors - 1 : 1) % numActors;
+        record.mSize = sizes[sizeDraw];
+        record.mPadding = 0;
+    }
+
+    const bool saved(SaveTrace(tracePath, records, numActors, numRecords));
+    if (saved)
+    {
+        printf("Generated %u synthetic records between %u actors into '%s'\n",
+            numRecords, numActors, tracePath);
+    }
+
+    delete [] records;
+    return saved ? 0 : 1;
+}
+
+
+// Sends one record's message to its destination worker, stamped with the
+// current time, as the smallest payload class holding the recorded size.
+inline static void SendRecord(
+    Theron::Framework &framework,
+    const TraceRecord &record,
+    const Theron::Address &from,
+    const Theron::Address &to)
+{
+    if (record.mSize <= sizeof(Payload64))
+    {
+        Payload64 payload;
+        payload.mSendTime = Now();
+        framework.Send(payload, from, to);
+    }
+    else if (record.mSize <= sizeof(Payload256))
+    {
+        Payload256 payload;
+        payload.mSendTime = Now();
+        framework.Send(payload, from, to);
+    }
+    else if (record.mSize <= sizeof(Payload1K))
+    {
+        Payload1K payload;
+        payload.mSendTime = Now();
+        framework.Send(payload, from, to);
+    }
+    else if (record.mSize <= sizeof(Payload4K))
+    {
+        Payload4K payload;
+        payload.mSendTime = Now();
+        framework.Send(payload, from, to);
+    }
+    else
+    {
+        Payload16K payload;
+        payload.mSendTime = Now();
+        framework.Send(payload, from, to);
+    }
+}
+
+
+// Replays a loaded trace against a framework with the given parameters and
+// reports the throughput and latency distribution observed by the workers.
+static int Replay(
+    const char *const tracePath,
+    const Theron::uint32_t numThreads,
+    const Theron::YieldStrategy yieldStrategy,
+    const bool paced)
+{
+    Theron::uint32_t numActors(0);
+    Theron::uint32_t numRecords(0);
+    TraceRecord *const records(LoadTrace(tracePath, numActors, numRecords));
+
+    if (records == 0)
+    {
+        return 1;
+    }
+
+    if (numActors == 0 || numRecords == 0)
+    {
+        printf("ERROR: Trace '%s' is empty\n", tracePath);
+        delete [] records;
+        return 1;
+    }
+
+    printf("Replaying %u records between %u actors, %s...\n",
+        numRecords, numActors, paced ? "paced at the recorded arrival times" : "at full speed");
+
+    Theron::Framework::Parameters params;
+    params.mThreadCount = numThreads;
+    params.mYieldStrategy = yieldStrategy;
+
+    Theron::Framework framework(params);
+    Theron::Receiver receiver;
+    Theron::Catcher<Theron::uint32_t> catcher;
+    receiver.RegisterHandler(&catcher, &Theron::Catcher<Theron::uint32_t>::Push);
+
+    Worker **const workers(new Worker *[numActors]);
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        workers[index] = new Worker(framework);
+    }
+
+    Timer timer;
+    timer.Start();
+
+    const Theron::uint64_t startTime(Now());
+
+    for (Theron::uint32_t index = 0; index < numRecords; ++index)
+    {
+        const TraceRecord &record(records[index]);
+
+        if (paced)
+        {
+            // Sleep off most of any lead over the schedule, then spin out the
+            // remainder, since sleeps only have millisecond granularity.
+            const Theron::uint64_t dueTime(startTime + record.mTimeMicroseconds);
+            Theron::uint64_t now(Now());
+            while (now < dueTime)
+            {
+                if (dueTime - now > 2000)
+                {
+                    Theron::Detail::Utils::SleepThread(1);
+                }
+
+                now = Now();
+            }
+        }
+
+        SendRecord(
+            framework,
+            record,
+            workers[record.mSender % numActors]->GetAddress(),
+            workers[record.mDest % numActors]->GetAddress());
+    }
+
+    // Drain the workers: each replies with its receive count once its queue
+    // has emptied, confirming every replayed message was processed.
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        framework.Send(0, receiver.GetAddress(), workers[index]->GetAddress());
+    }
+
+    Theron::uint32_t totalReceived(0);
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        receiver.Wait();
+
+        Theron::uint32_t count(0);
+        Theron::Address from;
+        while (catcher.Pop(count, from))
+        {
+            totalReceived += count;
+        }
+    }
+
+    timer.Stop();
+
+    if (totalReceived != numRecords)
+    {
+        printf("ERROR: Replayed %u messages but the workers received %u\n", numRecords, totalReceived);
+    }
+
+    Histogram histogram;
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        histogram.Merge(workers[index]->GetHistogram());
+    }
+
+    const float seconds(timer.Seconds());
+    const float throughput(seconds > 0.0f ? static_cast<float>(numRecords) / seconds : 0.0f);
+
+    printf("%12s %14s %10s %10s %10s %10s\n",
+        "messages", "msgs/sec", "p50 us", "p99 us", "p99.9 us", "max us");
+    printf("%12u %14.0f %10llu %10llu %10llu %10llu\n",
+        numRecords,
+        static_cast<double>(throughput),
+        static_cast<unsigned long long>(histogram.Percentile(50.0)),
+        static_cast<unsigned long long>(histogram.Percentile(99.0)),
+        static_cast<unsigned long long>(histogram.Percentile(99.9)),
+        static_cast<unsigned long long>(histogram.Max()));
+
+    for (Theron::uint32_t index = 0; index < numActors; ++index)
+    {
+        delete workers[index];
+    }
+
+    delete [] workers;
+    delete [] records;
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *tracePath(0);
+    Theron::uint32_t numThreads(16);
+    Theron::YieldStrategy yieldStrategy(Theron::YIELD_STRATEGY_POLITE);
+    bool paced(false);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--distill") == 0 && i + 2 < argc)
+        {
+            return Distill(argv[i + 1], argv[i + 2]);
+        }
+        else if (strcmp(argv[i], "--generate") == 0 && i + 3 < argc)
+        {
+            return Generate(
+                argv[i + 1],
+                static_cast<Theron::uint32_t>(atoi(argv[i + 2])),
+                static_cast<Theron::uint32_t>(atoi(argv[i + 3])));
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            numThreads = static_cast<Theron::uint32_t>(atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--yield") == 0 && i + 1 < argc)
+        {
+            const char *const name(argv[++i]);
+            if (strcmp(name, "polite") == 0) yieldStrategy = Theron::YIELD_STRATEGY_POLITE;
+            else if (strcmp(name, "strong") == 0) yieldStrategy = Theron::YIELD_STRATEGY_STRONG;
+            else if (strcmp(name, "aggressive") == 0) yieldStrategy = Theron::YIELD_STRATEGY_AGGRESSIVE;
+            else if (strcmp(name, "blocking") == 0) yieldStrategy = Theron::YIELD_STRATEGY_BLOCKING;
+            else if (strcmp(name, "adaptive") == 0) yieldStrategy = Theron::YIELD_STRATEGY_ADAPTIVE;
+            else
+            {
+                printf("ERROR: Unknown yield strategy '%s'\n", name);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--paced") == 0)
+        {
+            paced = true;
+        }
+        else
+        {
+            tracePath = argv[i];
+        }
+    }
+
+    if (tracePath == 0)
+    {
+        printf("Usage: Replay <tracefile> [--threads <n>] [--yield <strategy>] [--paced]\n");
+        printf("       Replay --distill <journalfile> <tracefile>\n");
+        printf("       Replay --generate <tracefile> <numactors> <numrecords>\n");
+        printf("Replays a recorded (time, sender, dest, size) message schedule against the\n");
+        printf("framework. Traces are distilled from message journals written via\n");
+        printf("EndPoint::Parameters::mJournalPath, or generated synthetically for smoke tests.\n");
+        return 1;
+    }
+
+    printf("Using numThreads = %u (use --threads to change)\n", numThreads);
+
+    return Replay(tracePath, numThreads, yieldStrategy, paced);
+}
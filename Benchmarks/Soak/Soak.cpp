@@ -0,0 +1,425 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This benchmark soaks the framework under a mixed workload for a long period
+// and watches memory rather than throughput. Throughput numbers hide slow
+// leaks: a few bytes lost per actor creation or per message survives every
+// short benchmark unnoticed, then shows up as resident set creep over a week
+// of production uptime. This target is the gate for accepting allocator and
+// lifetime changes: it fails, with a non-zero exit code, if memory use still
+// trends upwards once the caches have warmed.
+//
+// The workload mixes the main allocation sources: continuous actor churn
+// (actors constructed, messaged and destroyed in batches, paced so the run
+// stays within the mailbox directory's index capacity), message traffic
+// across a spread of payload sizes, and, when Theron is built with Crossroads
+// IO support (THERON_XS), remote sends bounced between two endpoints connected
+// in-process. Between work cycles the benchmark samples the DefaultAllocator's
+// allocated and peak byte counts, falling back to the process resident set
+// size in builds where allocation tracking is disabled, along with the
+// occupancy, hit rate and fallback statistics of the message block caches.
+//
+// The pass criterion is a trend, not a threshold: samples from the warmup
+// period are discarded, a least-squares line is fitted to the rest, and the
+// run fails if the fitted growth over the measured period exceeds a small
+// tolerance. Bounded warm-state growth -- caches filling to their configured
+// depths -- lands in the warmup period and passes; unbounded growth, however
+// slow, accumulates slope and fails, given a long enough run.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#if THERON_POSIX
+#include <unistd.h>
+#endif // THERON_POSIX
+
+
+// A payload message of a given size in bytes.
+template <Theron::uint32_t SIZE>
+struct SizedMessage
+{
+    char mData[SIZE];
+};
+
+
+// The payload sizes are distinct registered message types, so the traffic
+// exercises the same pooled allocation and dispatch paths as real workloads.
+typedef SizedMessage<256> Message256B;
+typedef SizedMessage<4 * 1024> Message4KB;
+
+THERON_REGISTER_MESSAGE(Message256B);
+THERON_REGISTER_MESSAGE(Message4KB);
+
+
+// Bounces every received message straight back to its sender.
+template <class MessageType>
+class Replier : public Theron::Actor
+{
+public:
+
+    inline explicit Replier(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Replier::Handler);
+    }
+
+    inline Replier(Theron::Framework &framework, const char *const name) : Theron::Actor(framework, name)
+    {
+        RegisterHandler(this, &Replier::Handler);
+    }
+
+private:
+
+    inline void Handler(const MessageType &message, const Theron::Address from)
+    {
+        Send(message, from);
+    }
+};
+
+
+// One memory sample, taken between work cycles.
+struct MemorySample
+{
+    double mSeconds;                // Time of the sample, relative to the start of the run.
+    double mBytes;                  // Allocated bytes, or resident set bytes when tracking is disabled.
+};
+
+
+inline static Theron::uint64_t Now()
+{
+    return Theron::Detail::ProfileClock::GetMicroseconds();
+}
+
+
+// Returns the resident set size of the process in bytes, or zero where it
+// can't be read. Used as the memory signal in builds where the
+// DefaultAllocator's byte tracking is compiled out.
+static Theron::uint64_t GetResidentBytes()
+{
+#if THERON_POSIX
+
+    // The statm interface is Linux-specific; on other POSIX systems the open
+    // fails and the sample falls back to zero.
+    FILE *const file(fopen("/proc/self/statm", "r"));
+    if (file)
+    {
+        unsigned long totalPages(0);
+        unsigned long residentPages(0);
+        const int fields(fscanf(file, "%lu %lu", &totalPages, &residentPages));
+        fclose(file);
+
+        if (fields == 2)
+        {
+            return static_cast<Theron::uint64_t>(residentPages) *
+                static_cast<Theron::uint64_t>(sysconf(_SC_PAGESIZE));
+        }
+    }
+
+#endif // THERON_POSIX
+
+    return 0;
+}
+
+
+// Fits a least-squares line to the samples and returns its slope in bytes per
+// second. The sample counts are small, so the simple two-pass form is fine.
+static double FitSlope(const MemorySample *const samples, const Theron::uint32_t count)
+{
+    if (count < 2)
+    {
+        return 0.0;
+    }
+
+    double meanSeconds(0.0);
+    double meanBytes(0.0);
+    for (Theron::uint32_t index = 0; index < count; ++index)
+    {
+        meanSeconds += samples[index].mSeconds;
+        meanBytes += samples[index].mBytes;
+    }
+
+    meanSeconds /= count;
+    meanBytes /= count;
+
+    double numerator(0.0);
+    double denominator(0.0);
+    for (Theron::uint32_t index = 0; index < count; ++index)
+    {
+        const double dx(samples[index].mSeconds - meanSeconds);
+        numerator += dx * (samples[index].mBytes - meanBytes);
+        denominator += dx * dx;
+    }
+
+    return denominator > 0.0 ? numerator / denominator : 0.0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const int durationSeconds = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 3600;
+    const int samplePeriodSeconds = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 10;
+
+    printf("Using durationSeconds = %d (use first command line argument to change)\n", durationSeconds);
+    printf("Using samplePeriodSeconds = %d (use second command line argument to change)\n", samplePeriodSeconds);
+    printf("Soaking a mixed workload and watching for memory growth...\n\n");
+
+    Theron::IAllocator *const allocator(Theron::AllocatorManager::Instance().GetAllocator());
+    Theron::DefaultAllocator *const defaultAllocator(dynamic_cast<Theron::DefaultAllocator *>(allocator));
+
+    const Theron::uint32_t maxSamples(static_cast<Theron::uint32_t>(durationSeconds / samplePeriodSeconds) + 2);
+    MemorySample *const samples(new MemorySample[maxSamples]);
+    Theron::uint32_t sampleCount(0);
+
+    // The mailbox directory hands out a fresh index per actor and never
+    // recycles freed ones, so the total number of actors churned over the
+    // run has to stay well below the directory's capacity of around a
+    // million; past that the index counter wraps into the live mailboxes.
+    // The budget is spread uniformly over the run, and the covering
+    // directory pages are reserved upfront so that page allocation lands
+    // at startup rather than bleeding into the memory trend.
+    static const Theron::uint32_t CHURN_BUDGET = 256 * 1024;
+
+    {
+        // The persistent framework hosts the long-lived repliers; the churned
+        // actors come and go within it as well, exercising mailbox
+        // registration and actor allocation continuously.
+        Theron::Framework::Parameters frameworkParams;
+        frameworkParams.mExpectedActorCount = CHURN_BUDGET + 1024;
+
+        Theron::Framework framework(frameworkParams);
+        Theron::Receiver receiver;
+
+        Replier<int> intReplier(framework);
+        Replier<Message256B> mediumReplier(framework);
+        Replier<Message4KB> largeReplier(framework);
+
+        Message256B mediumMessage;
+        Message4KB largeMessage;
+        memset(mediumMessage.mData, 0, sizeof(mediumMessage.mData));
+        memset(largeMessage.mData, 0, sizeof(largeMessage.mData));
+
+#if THERON_XS
+
+        // Two endpoints connected in-process carry the network share of the
+        // workload, running the full serialize/deserialize path per message.
+        Theron::EndPoint endPointOne("soak_one", "inproc://soak_one");
+        Theron::EndPoint endPointTwo("soak_two", "inproc://soak_two");
+
+        endPointOne.Connect("inproc://soak_two");
+        endPointTwo.Connect("inproc://soak_one");
+
+        Theron::Framework networkFrameworkOne(endPointOne);
+        Theron::Framework networkFrameworkTwo(endPointTwo);
+
+        Theron::Receiver networkReceiver(endPointOne, "soak_receiver");
+        Replier<Message256B> networkReplier(networkFrameworkTwo, "soak_replier");
+
+        // We have to resend until the Connect actually connects.
+        while (networkReceiver.Count() == 0)
+        {
+            networkFrameworkOne.Send(
+                mediumMessage,
+                Theron::Address("soak_receiver"),
+                Theron::Address("soak_replier"));
+
+            Theron::Detail::Utils::SleepThread(100);
+        }
+
+        while (networkReceiver.Count())
+        {
+            networkReceiver.Wait();
+        }
+
+#endif // THERON_XS
+
+        // Allocation tracking is compiled out of release builds, in which case
+        // the process resident set size stands in as the memory signal. The
+        // framework just constructed holds live allocations, so a zero count
+        // here means the tracking is disabled rather than nothing allocated.
+        const bool tracked(defaultAllocator && defaultAllocator->GetBytesAllocated() != 0);
+        if (!tracked)
+        {
+            printf("Allocator byte tracking is disabled in this build; sampling the resident set size instead.\n\n");
+        }
+
+        const Theron::uint64_t startTime(Now());
+        const Theron::uint64_t endTime(startTime + static_cast<Theron::uint64_t>(durationSeconds) * 1000000);
+        Theron::uint64_t nextSampleTime(startTime);
+        Theron::uint32_t churnedTotal(0);
+
+        printf("%10s %14s %14s %12s %10s %12s\n",
+            "seconds", "bytes", "peak bytes", "cached", "hit rate", "fallbacks");
+
+        while (Now() < endTime)
+        {
+            // Churn a batch of actors: construct, message, destroy. Leaks of
+            // actor or mailbox memory accumulate here a batch at a time. The
+            // churn is paced so its cumulative total tracks the share of the
+            // budget earned so far; message traffic runs unpaced regardless.
+            static const Theron::uint32_t CHURN_ACTORS = 64;
+            const double elapsedSeconds(static_cast<double>(Now() - startTime) / 1000000.0);
+            const double earnedChurn(elapsedSeconds / durationSeconds * CHURN_BUDGET);
+
+            if (static_cast<double>(churnedTotal) < earnedChurn)
+            {
+                Replier<int> *churned[CHURN_ACTORS];
+
+                for (Theron::uint32_t index = 0; index < CHURN_ACTORS; ++index)
+                {
+                    churned[index] = new Replier<int>(framework);
+                    framework.Send(static_cast<int>(index), receiver.GetAddress(), churned[index]->GetAddress());
+                }
+
+                for (Theron::uint32_t index = 0; index < CHURN_ACTORS; ++index)
+                {
+                    receiver.Wait();
+                }
+
+                for (Theron::uint32_t index = 0; index < CHURN_ACTORS; ++index)
+                {
+                    delete churned[index];
+                }
+
+                churnedTotal += CHURN_ACTORS;
+            }
+
+            // A burst of traffic across the payload size spread, pipelined
+            // against the long-lived repliers.
+            static const Theron::uint32_t BURST_MESSAGES = 64;
+
+            for (Theron::uint32_t index = 0; index < BURST_MESSAGES; ++index)
+            {
+                framework.Send(static_cast<int>(index), receiver.GetAddress(), intReplier.GetAddress());
+                framework.Send(mediumMessage, receiver.GetAddress(), mediumReplier.GetAddress());
+                framework.Send(largeMessage, receiver.GetAddress(), largeReplier.GetAddress());
+            }
+
+            Theron::uint32_t outstanding(3 * BURST_MESSAGES);
+            while (outstanding)
+            {
+                outstanding -= receiver.Wait(outstanding);
+            }
+
+#if THERON_XS
+
+            // The network share: a handful of remote round trips per cycle.
+            static const Theron::uint32_t NETWORK_MESSAGES = 8;
+
+            for (Theron::uint32_t index = 0; index < NETWORK_MESSAGES; ++index)
+            {
+                networkFrameworkOne.Send(
+                    mediumMessage,
+                    networkReceiver.GetAddress(),
+                    Theron::Address("soak_replier"));
+            }
+
+            Theron::uint32_t networkOutstanding(NETWORK_MESSAGES);
+            while (networkOutstanding)
+            {
+                networkOutstanding -= networkReceiver.Wait(networkOutstanding);
+            }
+
+#endif // THERON_XS
+
+            // Sample between cycles, so the counts describe the settled state
+            // rather than the messages in flight.
+            const Theron::uint64_t now(Now());
+            if (now >= nextSampleTime && sampleCount < maxSamples)
+            {
+                nextSampleTime = now + static_cast<Theron::uint64_t>(samplePeriodSeconds) * 1000000;
+
+                const Theron::uint64_t bytes(
+                    tracked ? defaultAllocator->GetBytesAllocated() : GetResidentBytes());
+                const Theron::uint64_t peakBytes(
+                    tracked ? defaultAllocator->GetPeakBytesAllocated() : 0);
+
+                Theron::AllocatorCacheStats stats;
+                framework.GetAllocatorCacheStats(stats);
+
+                // Total cache occupancy and hit rate across the slot stacks
+                // and all size bins.
+                Theron::uint64_t cachedBlocks(stats.mCachedSlots);
+                Theron::uint64_t hits(stats.mSlotHits);
+                Theron::uint64_t misses(stats.mSlotMisses);
+
+                for (Theron::uint32_t bin = 0; bin < Theron::AllocatorCacheStats::MAX_POOLS; ++bin)
+                {
+                    cachedBlocks += stats.mPools[bin].mCachedBlocks;
+                    hits += stats.mPools[bin].mHits;
+                    misses += stats.mPools[bin].mMisses;
+                }
+
+                const double hitRate(hits + misses > 0 ?
+                    100.0 * static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0);
+
+                samples[sampleCount].mSeconds = static_cast<double>(now - startTime) / 1000000.0;
+                samples[sampleCount].mBytes = static_cast<double>(bytes);
+                ++sampleCount;
+
+                printf("%10.0f %14llu %14llu %12llu %9.2f%% %12llu\n",
+                    samples[sampleCount - 1].mSeconds,
+                    static_cast<unsigned long long>(bytes),
+                    static_cast<unsigned long long>(peakBytes),
+                    static_cast<unsigned long long>(cachedBlocks),
+                    hitRate,
+                    static_cast<unsigned long long>(stats.mFallbackAllocations));
+            }
+        }
+    }
+
+    // The first quarter of the run is warmup: caches and pools filling to
+    // their configured depths is bounded growth, and mustn't count against
+    // the trend.
+    const Theron::uint32_t warmupSamples(sampleCount / 4);
+    const Theron::uint32_t settledSamples(sampleCount - warmupSamples);
+
+    int result(0);
+    if (settledSamples < 4)
+    {
+        printf("\nSOAK INCONCLUSIVE: too few samples after warmup; run longer or sample more often.\n");
+        result = 1;
+    }
+    else
+    {
+        const double slope(FitSlope(samples + warmupSamples, settledSamples));
+        const double measuredSeconds(
+            samples[sampleCount - 1].mSeconds - samples[warmupSamples].mSeconds);
+        const double fittedGrowth(slope * measuredSeconds);
+
+        double meanBytes(0.0);
+        for (Theron::uint32_t index = warmupSamples; index < sampleCount; ++index)
+        {
+            meanBytes += samples[index].mBytes;
+        }
+        meanBytes /= settledSamples;
+
+        // The tolerance absorbs sampling noise: a megabyte of absolute slack,
+        // or five percent of the settled level, whichever is larger. Unbounded
+        // growth accumulates past any fixed slack, given a long enough run.
+        const double tolerance(meanBytes * 0.05 > 1024.0 * 1024.0 ? meanBytes * 0.05 : 1024.0 * 1024.0);
+
+        printf("\nFitted growth over the measured period: %.0f bytes (%.1f bytes/sec, tolerance %.0f bytes)\n",
+            fittedGrowth, slope, tolerance);
+
+        if (fittedGrowth > tolerance)
+        {
+            printf("SOAK FAILED: memory use is still trending upwards after warmup.\n");
+            result = 1;
+        }
+        else
+        {
+            printf("SOAK PASSED: no unbounded memory growth detected.\n");
+        }
+    }
+
+    delete [] samples;
+    return result;
+}
@@ -32,6 +32,7 @@
 
 #include <Theron/Theron.h>
 
+#include "../Common/BenchmarkHarness.h"
 #include "../Common/Timer.h"
 
 
@@ -92,14 +93,67 @@ struct AddressCatcher
 };
 
 
+// Runs the ring scenario on the given framework, for harness sweep mode.
+// Unlike the default invocation, which times the whole program including
+// framework startup and cleanup, this times just the token passing.
+static float RunScenario(Theron::Framework &framework, void *const context)
+{
+    const int numHops(*reinterpret_cast<const int *>(context));
+
+    AddressCatcher catcher;
+    Theron::Receiver receiver;
+    receiver.RegisterHandler(&catcher, &AddressCatcher::Catch);
+
+    // Create NUM_ACTORS member actors for the ring.
+    Member *members[NUM_ACTORS];
+    for (int index = 0; index < NUM_ACTORS; ++index)
+    {
+        members[index] = new Member(framework);
+    }
+
+    // Initialize the actors by passing each one the address of the next actor in the ring.
+    for (int index(NUM_ACTORS - 1), nextIndex(0); index >= 0; nextIndex = index--)
+    {
+        framework.Send(members[nextIndex]->GetAddress(), receiver.GetAddress(), members[index]->GetAddress());
+    }
+
+    Timer timer;
+    timer.Start();
+
+    // Start the processing by sending the token to the first actor.
+    framework.Send(numHops, receiver.GetAddress(), members[0]->GetAddress());
+
+    // Wait for the signal message indicating the token has reached zero.
+    receiver.Wait();
+    timer.Stop();
+
+    // Destroy the member actors.
+    for (int index = 0; index < NUM_ACTORS; ++index)
+    {
+        delete members[index];
+    }
+
+    return timer.Seconds();
+}
+
+
 int main(int argc, char *argv[])
 {
     int numMessagesProcessed(0);
     AddressCatcher catcher;
 
-    const int numHops = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
+    int numHops = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 50000000;
     const int numThreads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
 
+    // In sweep mode the harness runs the scenario across a thread-count sweep,
+    // captures the framework counters, and gates against a stored baseline.
+    BenchmarkHarness harness(argc, argv);
+    if (harness.Enabled())
+    {
+        printf("Using numHops = %d per run\n", numHops);
+        return harness.Run("ThreadRing", RunScenario, &numHops);
+    }
+
     printf("Using numHops = %d (use first command line argument to change)\n", numHops);
     printf("Using numThreads = %d (use second command line argument to change)\n", numThreads);
     printf("Starting one token in a ring of %d actors...\n", NUM_ACTORS);
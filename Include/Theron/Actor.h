@@ -1,1148 +1,2605 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_ACTOR_H
-#define THERON_ACTOR_H
-
-
-/**
-\file Actor.h
-Actor baseclass.
-*/
-
-
-#include <Theron/Defines.h>
-
-// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
-#if THERON_XS
-#include <xs/xs.h>
-#endif // THERON_XS
-
-#include <Theron/Address.h>
-#include <Theron/Align.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/EndPoint.h>
-#include <Theron/Framework.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Directory/Directory.h>
-#include <Theron/Detail/Handlers/DefaultHandlerCollection.h>
-#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
-#include <Theron/Detail/Handlers/HandlerCollection.h>
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Messages/MessageCreator.h>
-#include <Theron/Detail/Messages/MessageSender.h>
-#include <Theron/Detail/Mailboxes/Mailbox.h>
-#include <Theron/Detail/MailboxProcessor/Processor.h>
-#include <Theron/Detail/Threading/Atomic.h>
-#include <Theron/Detail/Threading/Utils.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#endif //_MSC_VER
-
-
-/**
-Main namespace containing all public API components.
-*/
-namespace Theron
-{
-
-
-class ActorRef;
-class Framework;
-
-
-namespace Detail
-{
-class Processor;
-}
-
-
-/**
-\brief The actor baseclass.
-
-All actors in Theron must derive from this class.
-It provides the core functionality of an actor, such as the ability
-to \ref RegisterHandler "register message handlers" and \ref Send "send messages",
-including responding to messages received from other actors. When implementing
-actors derived from this baseclass, users can call the various protected methods
-of the baseclass to perform actions like registering message handlers and sending
-messages.
-
-Although derived actors classes can be constructed directly in user code, they are
-always associated with an owning \ref Framework that hosts and executes them.
-The owning Framework is provided to the Actor baseclass on construction.
-
-\code
-class MyActor : public Theron::Actor
-{
-public:
-
-    MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-    {
-    }
-};
-\endcode
-
-\note A fundamental principle of the Actor Model is that actors should communicate
-only by means of messages, both \ref Send "sent by themselves" and \ref RegisterHandler
-"handled by their message handlers". Since Actors in Theron are just vanilla C++
-classes that derive from the Actor baseclass, it's possible in practice to add
-conventional member functions to derived actor classes, breaking the Actor Model
-abstraction. However this should be avoided, since it results in ugly code and
-shared memory issues, reintroducing the need for traditional thread synchronization.
-Resist the temptation to add a method to an actor class and add a message instead.
-*/
-class Actor
-{
-public:
-
-    friend class ActorRef;
-    friend class Framework;
-    friend class Detail::Processor;
-
-    /**
-    \brief Default constructor.
-
-    \note Direct default-construction of Actor baseclasses is forbidden. This
-    public default constructor is provided for backwards compatibility with the
-    legacy actor creation pattern used by versions of Theron prior to version 4.0.
-    
-    Always use one of the two supported actor creation patterns: the version 4 syntax or
-    (if necessary) the deprecated version 3.x syntax, which is still supported for backwards
-    compatibility. When writing new code, always use the new, simpler, version 4 syntax.
-
-    In versions of Theron prior to 4.0, actors couldn't be constructed directly
-    in user code. Instead you had to ask a Framework to create one for you, using
-    the CreateActor method template. Instead of returning the actor itself,
-    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
-    object.
-
-    \code
-    // LEGACY CODE!
-    class MyActor : public Theron::Actor
-    {
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        Theron::ActorRef actorRef(framework.CreateActor<MyActor>());
-    }
-    \endcode
-
-    In versions of Theron starting with 4.0, Actors are first-class citizens and
-    behave like vanilla C++ objects. They can be constructed directly with no
-    call to Framework::CreateActor. Once constructed they are referenced directly
-    by user code with no need for ActorRef proxy objects.
-
-    When writing new code, follow the new, simpler construction pattern where actors
-    are constructed directly and not referenced by ActorRefs:
-
-    \code
-    // New code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        MyActor actor(framework);
-    }
-    \endcode
-    */
-    Actor();
-
-    /**
-    \brief Explicit constructor.
-
-    Constructs an actor within the given \ref Framework, with the given unique name.
-    If the name parameter is null then the actor is given an automatically generated name.
-
-    The Actor baseclass constructor expects an instance of the Framework class,
-    which becomes the owning Framework for the actor, hosting it and executing its
-    message handlers.
-
-    When defining their own derived actor classes, users must arrange to pass a
-    Framework object to the baseclass constructor. The typical way to arrange this
-    is to just expose the same parameter on the constructor of the derived actor,
-    and pass it through to the baseclass constructor in the initializer list:
-
-    The optional name parameter allows constructed actor objects to be given unique,
-    user-defined names. These names can then be used to send messages to the actors in
-    situations where the sending code has no direct reference to the destination actor, so
-    can't query it for its address. This is especially important when sending messages
-    to remote actors, where the actor is also required to be constructed in a Framework
-    tied to an \ref EndPoint.
-
-    If no name parameter is provided, or the name parameter is null, then the constructed
-    actor is given an automatically generated name. The generated name can still be used
-    to send messages, but since it is automatically generated it can't be known to the
-    user except by calling \ref GetAddress. Note that the generated name is only guaranteed
-    to be unique across all processes if each \ref EndPoint in the system is given a unique,
-    user-defined name on construction.
-
-    \note Sending a message to an actor using only its name requires an \ref EndPoint.
-    It involves a hashed lookup, so is slower than using an address retrieved directly
-    from the target actor using \ref GetAddress.
-
-    \code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        MyActor(Theron::Framework &framework, const char *const name) :
-          Theron::Actor(framework, name)
-        {
-        }
-    };
-
-    Theron::EndPoint::Parameters params("local", "tcp://192.168.10.104:5555");
-    Theron::EndPoint endPoint(params);
-    Theron::Framework framework(endPoint);
-    Theron::Receiver receiver(endPoint, "receiver");
-
-    MyActor actorOne(framework, "actor_one");
-    MyActor actorTwo(framework, "actor_two");
-
-    framework.Send(
-        std::string("hello"),
-        Theron::Address("receiver"),
-        Theron::Address("actor_one"));
-    \endcode
-
-    A powerful feature of actors is that they can create other actors, allowing
-    the building of complex subsystems of actors using object-like abstraction.
-    See the documentation of the \ref GetFramework method for more information.
-
-    \param framework Reference to a framework within which the actor will be hosted.
-    \param name An optional string defining the unique name of the actor object.
-
-    \note The string name parameter is copied so can be destroyed after the call.
-    */
-    explicit Actor(Framework &framework, const char *const name = 0);
-
-    /**
-    \brief Baseclass virtual destructor.
-    */
-    virtual ~Actor();
-
-    /**
-    \brief Returns the unique address of the actor.
-
-    This enables an actor to determine its own address and, for example,
-    to send that address to another actor in a message. In this example
-    we print out the address ("identity") of the actor in response to a query:
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        struct IdentifyMessage
-        {
-        };
-
-        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Actor::Identify);
-        }
-
-    private:
-
-        inline void Identify(const IdentifyMessage &message, const Theron::Address from)
-        {
-            printf("Actor address is: %d\n", GetAddress().AsInteger());
-        }
-    };
-    \endcode
-
-    \note This method can safely be called inside an actor message handler,
-    constructor, or destructor. As a public method, it can also be accessed from
-    outside the actor to query the actor's address.
-    */
-    inline Address GetAddress() const;
-
-    /**
-    \brief Returns a reference to the framework that owns the actor.
-
-    This enables an actor to access the framework that owns it. One reason
-    this may be useful is to allow the actor to create other actors, which
-    effectively become nested inside it as its children. By nesting actors
-    it's possible to build complex subsystems, abstracted away behind the
-    message interface of a single actor.
-
-    To create actors that are 'children' of another actor, the parent actor
-    passes its owning Framework as a parameter to the child actor constructor.
-
-    A typical pattern is the allocate the children dynamically on the heap
-    using \em "operator new" in the parent constructor, hold pointers to the
-    created children in a container, and then destroy them using \em "operator
-    delete" in the parent destructor.
-
-    \code
-    class Wheel : public Theron::Actor
-    {
-        explicit Wheel(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    class Car : public Theron::Actor
-    {
-    public:
-
-        explicit Car(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            mWheels[0] = new Wheel(GetFramework());
-            mWheels[1] = new Wheel(GetFramework());
-            mWheels[2] = new Wheel(GetFramework());
-            mWheels[3] = new Wheel(GetFramework());
-        }
-
-        Car()
-        {
-            delete mWheels[0];
-            delete mWheels[1];
-            delete mWheels[2];
-            delete mWheels[3];
-        }
-
-    private:
-
-        Wheel *mWheels[4];
-    };
-    \endcode
-
-    \note This method can safely be called inside an actor message handler,
-    constructor, or destructor.
-    */
-    inline Framework &GetFramework() const;
-
-    /**
-    \brief Pushes a message into the actor.
-
-    This method is an alternative to \ref Framework::Send, which is the more
-    conventional and general way to send messages to actors. It can be
-    called in situations where the caller happens to have a direct reference
-    to the target actor (for example by means of a local variable or pointer).
-    
-    \note In general \ref Send should be preferred over Push. When sending messages
-    from inside an actor (for example in a message handler), use Actor::Send.
-    When sending messages to an actor from non-actor code, prefer Framework::Send
-    over Actor::Push, even in situations where you have a direct reference to the
-    receiving actor. Although Push looks like an optimization, it uses the same general
-    message sending mechanism as Send, and in fact is potentially slower in some cases
-    due to there being no thread-specific caches available.
-
-    As with \ref Framework::Send, it's necessary to provide a \em from address
-    when calling this method, because the address of the sender isn't implicit
-    from the context. It's legal to pass Theron::Address() or Theron::Address::Null(),
-    both of which evaluate to the \ref Theron::Address::Null "null address".
-
-    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
-    \param value The message value, which is copied.
-    \param from The address of the sender.
-    \return True, if the actor accepted the message.
-
-    \note The return value of this method should be understood to mean
-    just that the message was delivered to the mailbox associated with the actor.
-    This doesn't mean necessarily that the actor took any action in response
-    to the message. If the actor has no handlers registered for messages of that
-    type, then the message will simply be consumed without any effect. In such cases
-    this method will still return true. This surprising behavior is a result
-    of the asynchronous nature of message passing: the sender doesn't wait
-    for the recipient to process the message. It is the sender's responsibility
-    to ensure that messages are handled by the actors to which they are sent.
-    Actor implementations can also register a default message handler (see
-    \ref Actor::SetDefaultHandler). If no default handler is registered then the
-    unhandled message will be caught by the Framework's
-    \ref Framework::SetFallbackHandler "fallback handler", which, by default,
-    asserts.
-    */
-    template <class ValueType>
-    inline bool Push(const ValueType &value, const Address &from);
-
-    /**
-    \brief Gets the number of messages queued at this actor, awaiting processing.
-
-    Returns the number of messages currently in the message queue of the actor.
-    The messages in the queue are those that have been received by the actor but
-    for which registered message handlers have not yet been executed, and so are
-    still awaiting processing.
-    
-    \note If called from a message handler function, the returned count includes
-    the message whose receipt triggered the execution of the handler. This behavior
-    changed in Theron 4 -- in previous versions, the count didn't include the
-    current message.
-    */
-    inline uint32_t GetNumQueuedMessages() const;
-
-protected:
-
-    /**
-    \brief Registers a handler for a specific message type.
-
-    Derived actor classes should call this method to register message handlers.
-    Once registered, a message handler is automatically executed whenever the
-    owning actor receives a message of the type that the message handler function
-    accepts.
-
-    For example this simple HelloWorld actor has a single handler which is executed
-    in response to \em hello messages. It's important to note that message handlers
-    must currently always take their message parameters by \em reference:
-
-    \code
-    class HelloWorld : public Theron::Actor
-    {
-    public:
-
-        struct HelloMessage { };
-
-        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &HelloWorld::Hello);
-        }
-
-    private:
-
-        inline void Hello(const HelloMessage &message, const Theron::Address from)
-        {
-            printf("Hello world!\n");
-        }
-    };
-    \endcode
-
-    Message handlers can be registered at basically any point in the lifetime of the actor.
-    In particular they can safely be registered in the derived actor constructor,
-    as well as from within other message handlers of the actor (themselves previously
-    registered and then executed in response to received messages).
-
-    If a message handler is registered multiple times, it will be executed multiple times
-    in response to received messages of its expected type. Each subsequent de-registration
-    then removes just one of the multiple registrations.
-
-    One subtlety to be aware of is that message handlers aren't executed on receipt of
-    messages of types \em derived from the message types expected by the handler. In order to
-    handle derived message types, register separate handlers for those types - and call the handler
-    registered for the base message type explicitly from the derived handler, if required.
-
-    \code
-    class HelloWorld : public Theron::Actor
-    {
-    public:
-
-        struct HelloMessage { };
-        struct HowdyMessage : public HelloMessage { };
-
-        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &HelloWorld::Hello);
-            RegisterHandler(this, &HelloWorld::Howdy);
-        }
-
-    private:
-
-        void Hello(const HelloMessage &message, const Theron::Address from)
-        {
-            printf("Hello world!\n");
-        }
-
-        void Howdy(const HowdyMessage &message, const Theron::Address from)
-        {
-            Hello(message, from);
-            printf("How y'all doin?\n");
-        }
-    };
-    \endcode
-
-    Another tricky subtlety is that the compiler may treat handlers that are exactly
-    identical as the same function, in optimized builds. The following example shows
-    this confusing effect:
-
-    \code
-    class HelloWorld : public Theron::Actor
-    {
-    public:
-
-        struct HelloMessage { };
-
-        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &HelloWorld::HelloOne);
-            IsHandlerRegistered(this, &HelloWorld::HelloTwo);   // May returns true, in some optimized builds.
-        }
-
-    private:
-
-        void HelloOne(const HelloMessage &message, const Theron::Address from)
-        {
-            printf("Hello world!\n");
-        }
-
-        void HelloTwo(const HelloMessage &message, const Theron::Address from)
-        {
-            printf("Hello world!\n");
-        }
-    };
-    \endcode
-
-    \tparam ActorType The derived actor class.
-    \tparam ValueType The message type accepted by the handler.
-    \param actor Pointer to the derived actor instance.
-    \param handler Member function pointer identifying the message handler function.
-    \return True, if the registration was successful. Failure may indicate out-of-memory.
-    */
-    template <class ActorType, class ValueType>
-    inline bool RegisterHandler(
-        ActorType *const actor,
-        void (ActorType::*handler)(const ValueType &message, const Address from));
-
-    /**
-    \brief Deregisters a previously registered message handler.
-
-    Call this method to deregister message handlers registered earlier with \ref RegisterHandler.
-
-    Message handlers can be deregistered at any point in the actor's lifetime.
-    They can be safely deregistered from within the constructor and destructor of the actor.
-    They can also be deregistered from within message handlers, including from within the
-    deregistered message handler itself: Message handlers can deregister themselves!
-    
-    The ability to register and deregister message handlers from \em within message handlers means
-    we can dynamically alter the message interface of an actor at runtime, in response to the
-    messages we receive. In this example, a HelloWorld actor can be woken and put to sleep
-    using messages. It only responds to \em HelloMessage messages when awake:
-
-    \code
-    class HelloWorld : public Theron::Actor
-    {
-    public:
-
-        struct WakeMessage { };
-        struct SleepMessage { };
-        struct HelloMessage { };
-
-        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &HelloWorld::Wake);
-        }
-
-    private:
-
-        void Wake(const WakeMessage &message, const Theron::Address from)
-        {
-            RegisterHandler(this, &HelloWorld::Hello);
-
-            DeregisterHandler(this, &HelloWorld::Wake);
-            RegisterHandler(this, &HelloWorld::Sleep);
-        }
-
-        void Sleep(const SleepMessage &message, const Theron::Address from)
-        {
-            DeregisterHandler(this, &HelloWorld::Hello);
-
-            DeregisterHandler(this, &HelloWorld::Sleep);
-            RegisterHandler(this, &HelloWorld::Wake);
-        }
-
-        void Hello(const HelloMessage &message, const Theron::Address from)
-        {
-            printf("Hello world!\n");
-        }
-    };
-    \endcode
-
-    If a message handler was previously registered multiple times, it must be deregistered multiple
-    times in order to completely deregister it. Each deregistration removes one of the multiple
-    registrations, decreasing by one the number of times the handler will be executed in response
-    to a received message of the type it expects.
-
-    \tparam ActorType The derived actor class.
-    \tparam ValueType The message type accepted by the handler function.
-    \param actor Pointer to the derived actor instance.
-    \param handler Member function pointer identifying the message handler function.
-    \return True, if the message handler was deregistered.
-
-    \note It's not necessary to deregister handlers that an actor registers before the
-    actor is destructed. Doing so is optional, though of course completely safe. Any handlers
-    left registered prior to destruction of the actor will simply be automatically deregistered
-    on destruction.
-    */
-    template <class ActorType, class ValueType>
-    inline bool DeregisterHandler(
-        ActorType *const actor,
-        void (ActorType::*handler)(const ValueType &message, const Address from));
-
-    /**
-    \brief Checks whether the given message handler is registered with the actor.
-
-    Although handlers are typically only registered once, in general they can be registered
-    any number of times. For that reason, a handler is counted as registered if the number
-    of times it has been \ref RegisterHandler "registered" thus far is greater than the number
-    of times it has been \ref DeregisterHandler "deregistered".
-    */
-    template <class ActorType, class ValueType>
-    inline bool IsHandlerRegistered(
-        ActorType *const actor,
-        void (ActorType::*handler)(const ValueType &message, const Address from));
-
-    /**
-    \brief Sets the default message handler executed for unhandled messages.
-
-    This handler, if set, is run when a message arrives at the actor of a type for
-    which no regular message handlers are registered.
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            SetDefaultHandler(this, &Actor::DefaultHandler);
-        }
-
-    private:
-
-        void DefaultHandler(const Theron::Address from)
-        {
-            printf("Actor received unknown message from address '%d'\n", from.AsInteger());
-        }
-    };
-    \endcode
-
-    Passing 0 to this method clears any previously set default handler.
-    
-    If no default handler is set, then unhandled messages are passed to the
-    \ref Framework::SetFallbackHandler "fallback handler" registered with the owning
-    \ref Framework. The default fallback handler reports unhandled messages by means
-    of asserts, which can be enabled or disabled using the
-    \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define.
-
-    \tparam ActorType The derived actor class.
-    \param actor Pointer to the derived actor instance.
-    \param handler Member function pointer identifying the message handler function.
-    */
-    template <class ActorType>
-    inline bool SetDefaultHandler(
-        ActorType *const actor,
-        void (ActorType::*handler)(const Address from));
-
-    /**
-    \brief Sets the default message handler executed for unhandled messages.
-
-    This method sets a 'blind' default handler which, when executed, is passed the
-    unknown message as blind data. The blind data consists of the memory block containing
-    the message, identified by a void pointer and a size.
-
-    The blind handler, if set, is run when a message arrives of a type for which no
-    regular message handlers are registered. The handler, being user-defined, may be able
-    to inspect the contents of the message and take appropriate action, such as reporting
-    the contents of an unexpected message to help with debugging.
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            SetDefaultHandler(this, &Actor::DefaultHandler);
-        }
-
-    private:
-
-        void DefaultHandler(const void *const data, const Theron::uint32_t size, const Theron::Address from)
-        {
-            printf("Actor received unknown message of size %d from address '%d'\n", size, from.AsInteger());
-        }
-    };
-    \endcode
-
-    Passing 0 to this method clears any previously set default handler.
-
-    If no default handler is set, then unhandled messages are passed to the
-    \ref Framework::SetFallbackHandler "fallback handler" registered with the owning
-    \ref Framework. The default fallback handler reports unhandled messages by means
-    of asserts, which can be enabled or disabled using the
-    \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define.
-
-    \tparam ActorType The derived actor class.
-    \param actor Pointer to the derived actor instance.
-    \param handler Member function pointer identifying the message handler function.
-    */
-    template <class ActorType>
-    inline bool SetDefaultHandler(
-        ActorType *const actor,
-        void (ActorType::*handler)(const void *const data, const uint32_t size, const Address from));
-
-    /**
-    \brief Sends a message to the entity (actor or Receiver) at the given address.
-
-    \code
-    class Responder : public Theron::Actor
-    {
-    public:
-
-        struct Message
-        {
-        };
-
-        explicit Responder(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Responder::Respond);
-        }
-
-    private:
-
-        void Respond(const Message &message, const Theron::Address from)
-        {
-            // Send the message back to the sender.
-            Send(message, from);
-        }
-    };
-    \endcode
-
-    Any copyable class or Plain-Old-Data type can be sent in a message. Messages
-    are copied when they are sent, so that the recipient sees a different piece of
-    memory with the same value. The copying is performed with the copy-constructor
-    of the message class.
-    
-    \note The requirements for messages sent to remote actors over a network are
-    different, and significantly stricter. Currently, message types sent to remote
-    actors must be bitwise-copyable via memcpy, so can't contain pointers.
-
-    Typically non-POD message classes should be provided with
-    a meaningful default constructor, copy constructor, assignment operator and
-    destructor. If the message type is derived from a base type (in an inheritance
-    hierarchy of message types) then the base class should typically have a virtual
-    destructor.
-
-    In general it is unsafe to pass pointers in messages, since doing so re-introduces
-    shared memory, where multiple actors can access the same memory at the same time.
-    The exception is where steps are taken to ensure that the sender is prevented from
-    accessing the referenced memory after the send (for example using an auto-pointer).
-    In such cases ownership is effectively transferred to the recipient by the message.
-
-    Note that immediate C arrays can't be sent as messages, since they aren't copyable.
-    For example the first call to Send in the following code won't compile, because the
-    literal string message is an array. The second, where the array is sent as a pointer
-    instead, works fine. Arrays can safely be sent as members of message classes.
-    Of course, a safer approach is to send a std::string, as shown as the final call:
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        struct Message
-        {
-            char mBuffer[32];
-        }
-
-        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            Send("hello", someAddress);                 // Immediate C array; won't compile!
-
-            char *const message("hello");
-            Send(message, someAddress);                 // Fastest, but use with care!
-
-            Message message2;
-            strcpy(message2.mBuffer, "hello");
-            Send(message2, someAddress);                // Safe but involves a shallow copy.
-
-            Send(std::string("hello"), someAddress);    // Safest but involves a deep copy.
-        }
-    }
-    \endcode
-
-    The boolean return value returned by Send indicates whether the message was delivered.
-    Note however that messages sent to actors are in reality addressed to mailboxes, not
-    actors themselves. So a return value of true indicates only that the message was
-    delivered to a mailbox, which may well be unattended.
-
-    A return value of false indicates that an error occurred and the message was not
-    sent. In the case of messages addressed to a Receiver, this may indicate that
-    no such receiver is registered (it may have existed once and been destructed).
-    In the case of messages addressed to an actor, a false return value more likely
-    indicates that the message could not be allocated, due to out-of-memory.
-
-    An important subtlety is that a return value of true indicates only that the message
-    was delivered to a mailbox, not that it was delivered to an associated actor, or
-    moreover that the receiving actor had message handlers registered for it. On the
-    contrary a true return value indicates only that the message was delivered to a mailbox.
-
-    The processing of the mailbox is scheduled asynchronously and typically happens
-    some time later, on a different thread. If no actor is registered at the mailbox
-    when it is eventually processed, then the message will simply be discarded, even
-    though it was delivered successfully to the mailbox. And even if an actor is
-    registered at the mailbox, it may have no handlers registered for the message
-    type, in which case the message may be silently discarded.
-
-    Such undelivered or unhandled messages will be caught and reported as asserts by the
-    default fallback handler, unless it is replaced by a custom user implementation using
-    \ref Framework::SetFallbackHandler.
-
-    Messages sent to mailboxes within the local process by the same sender are
-    guaranteed to be delivered to those mailboxes in the order they are sent. Once
-    delivered, they are guaranteed to processed in the order they were received.
-    When messages by different senders or to mailboxes in other processes (potentially
-    on other hosts) the arrival order is not guaranteed.
-
-    This method can safely be called within the constructor or destructor of a derived
-    actor object, as well as (more typically) within its message handler functions.
-
-    \note When sending messages from message handlers, use \ref TailSend instead, in the
-    common case where the sending of the message is the last action of the message
-    handler. In such cases, using TailSend can result in significantly higher performance.
-
-    \tparam ValueType The message type (any copyable class or Plain-Old-Data type).
-    \param value The message value to be sent.
-    \param address The address of the destination Receiver or Actor mailbox.
-    \return True, if the message was delivered, otherwise false.
-
-    \see TailSend
-    */
-    template <class ValueType>
-    inline bool Send(const ValueType &value, const Address &address) const;
-
-    /**
-    \brief Sends a message to the entity at the given address, without waking a worker thread.
-
-    This method sends a message to the entity at a given address, and is functionally
-    identical to the similar \ref Send method.
-    
-    TailSend differs from Send in that it is potentially more efficient when
-    called as the last operation of a message handler. TailSend hints to Theron that
-    the message handler sending the message is about to terminate, freeing the worker
-    thread that is currently executing it. As a result Theron may choose to schedule
-    the actor receiving the message on the same thread, rather than dispatching it
-    to an arbitrary, and potentially different, worker thread.
-
-    \note TailSend is only useful when called from the 'tail' of a message handler
-    (rather than an actor constructor or destructor) and only when the sent message
-    is addressed to an actor within the same \ref Framework. Since the actor receiving
-    the message is typically processed by the worker thread that is executing the
-    current message handler, the two are effectively serialized with no potential
-    for parallelism. For that reason TailSend should not be used to send messages
-    to actors that are intended to handle the message in parallel with the executing
-    handler.
-
-    \code
-    class Processor : public Theron::Actor
-    {
-    public:
-
-        explicit Processor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Processor::Process);
-        }
-
-    private:
-
-        void Process(const int &message, const Theron::Address from)
-        {
-            // Use Send when sending messages from non-tail positions.
-            Send(someRequest, someOtherActor);
-
-            // Do some compute-intensive processing using the message value.
-            // ...
-
-            // Send the result as the last action using TailSend.
-            TailSend(result, from);
-        }
-    };
-    \endcode
-   
-    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
-    \param value The message value to be sent.
-    \param address The address of the destination Actor.
-    \return True, if the message was delivered to a mailbox, otherwise false.
-
-    \see Send
-    */
-    template <class ValueType>
-    inline bool TailSend(const ValueType &value, const Address &address) const;
-
-private:
-
-    // Actors are non-copyable.
-    Actor(const Actor &other);
-    Actor &operator=(const Actor &other);
-
-    /**
-    Legacy ActorRef reference counting support.
-    */
-    inline void Reference() const;
-    inline bool Dereference() const;
-
-    /**
-    Processes the given message, passing it to handlers registered for its type.
-    */
-    inline void ProcessMessage(
-        Detail::FallbackHandlerCollection *const fallbackHandlers,
-        Detail::IMessage *const message);
-
-    /**
-    Handle an unhandled message.
-    */
-    void Fallback(
-        Detail::FallbackHandlerCollection *const fallbackHandlers,
-        const Detail::IMessage *const message);
-
-    Address mAddress;                                   ///< Unique address of this actor.
-    Framework *mFramework;                              ///< Pointer to the framework within which the actor runs.
-    Detail::HandlerCollection mMessageHandlers;         ///< The message handlers registered by this actor.
-    Detail::DefaultHandlerCollection mDefaultHandlers;  ///< Default message handlers registered by this actor.
-    Detail::Processor::Context *mProcessorContext;      ///< Remembers the context of the worker thread processing the actor.
-
-    mutable Detail::Atomic::UInt32 mRefCount;           ///< Reference count to support legacy ActorRef API.
-    void *mMemory;                                      ///< Pointer to memory block containing final actor type.
-};
-
-
-// TODO: Force-inline
-inline Address Actor::GetAddress() const
-{
-    return mAddress;
-}
-
-
-THERON_FORCEINLINE Framework &Actor::GetFramework() const
-{
-    return *mFramework;
-}
-
-
-THERON_FORCEINLINE uint32_t Actor::GetNumQueuedMessages() const
-{
-    // Get a reference to the mailbox at which this actor is registered.
-    const Address address(GetAddress());
-    Framework &framework(GetFramework());
-    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
-
-    return mailbox.Count();
-}
-
-
-template <class ActorType, class ValueType>
-inline bool Actor::RegisterHandler(
-    ActorType *const /*actor*/,
-    void (ActorType::*handler)(const ValueType &message, const Address from))
-{
-    // When an actor registers a handler for a message type, we get told about
-    // the type. So we take the opportunity to also register the type against
-    // its name with the network endpoint (if the framework is tied to one). This
-    // enables us to recognize the type when it arrives in a network message as a block
-    // blind of data tagged with a type name.
-    if (mFramework->mEndPoint)
-    {
-        mFramework->mEndPoint->RegisterMessageType<ValueType>();
-    }
-
-    return mMessageHandlers.Add(handler);
-}
-
-
-template <class ActorType, class ValueType>
-inline bool Actor::DeregisterHandler(
-    ActorType *const /*actor*/,
-    void (ActorType::*handler)(const ValueType &message, const Address from))
-{
-    return mMessageHandlers.Remove(handler);
-}
-
-
-template <class ActorType, class ValueType>
-inline bool Actor::IsHandlerRegistered(
-    ActorType *const /*actor*/,
-    void (ActorType::*handler)(const ValueType &message, const Address from))
-{
-    return mMessageHandlers.Contains(handler);
-}
-
-
-template <class ActorType>
-inline bool Actor::SetDefaultHandler(
-    ActorType *const /*actor*/,
-    void (ActorType::*handler)(const Address from))
-{
-    return mDefaultHandlers.Set(handler);
-}
-
-
-template <class ActorType>
-inline bool Actor::SetDefaultHandler(
-    ActorType *const /*actor*/,
-    void (ActorType::*handler)(const void *const data, const uint32_t size, const Address from))
-{
-    return mDefaultHandlers.Set(handler);
-}
-
-
-template <class ValueType>
-THERON_FORCEINLINE bool Actor::Send(const ValueType &value, const Address &address) const
-{
-    // Try to use the processor context owned by a worker thread.
-    // The current thread will be a worker thread if this method has been called from a message
-    // handler. If it was called from an actor constructor or destructor then the current thread
-    // may be an application thread, in which case the stored context pointer will be null.
-    // If it is null we fall back to the per-framework context, which is shared between threads.
-    // The advantage of using a thread-specific context is that it is only accessed by that
-    // single thread so doesn't need to be thread-safe and isn't written by other threads
-    // so doesn't cause expensive cache coherency updates between cores.
-    Detail::Processor::Context *processorContext(mProcessorContext);
-    if (mProcessorContext == 0)
-    {
-        processorContext = &mFramework->mProcessorContext;
-    }
-
-    // Allocate a message. It'll be deleted by the worker thread that handles it.
-    Detail::IMessage *const message(Detail::MessageCreator::Create(
-        &processorContext->mMessageCache,
-        value,
-        mAddress));
-
-    if (message)
-    {
-        // Call the message sending implementation using the acquired processor context.
-        return Detail::MessageSender::Send(
-            mFramework->mEndPoint,
-            processorContext,
-            mFramework->GetIndex(),
-            message,
-            address);
-    }
-
-    return false;
-}
-
-
-template <class ValueType>
-THERON_FORCEINLINE bool Actor::TailSend(const ValueType &value, const Address &address) const
-{
-    // Try to use the processor context owned by a worker thread.
-    // The current thread will be a worker thread if this method has been called from a message
-    // handler. If it was called from an actor constructor or destructor then the current thread
-    // may be an application thread, in which case the stored context pointer will be null.
-    // If it is null we fall back to the per-framework context, which is shared between threads.
-    // The advantage of using a thread-specific context is that it is only accessed by that
-    // single thread so doesn't need to be thread-safe and isn't written by other threads
-    // so doesn't cause expensive cache coherency updates between cores.
-    Detail::Processor::Context *processorContext(mProcessorContext);
-    if (mProcessorContext == 0)
-    {
-        processorContext = &mFramework->mProcessorContext;
-    }
-
-    // Allocate a message. It'll be deleted by the worker thread that handles it.
-    Detail::IMessage *const message(Detail::MessageCreator::Create(
-        &processorContext->mMessageCache,
-        value,
-        mAddress));
-
-    if (message)
-    {
-        // Call the message sending implementation using the acquired processor context.
-        // We schedule the receiving actor, if any, on the local queue of the processing worker thread, if any.
-        return Detail::MessageSender::Send(
-            mFramework->mEndPoint,
-            processorContext,
-            mFramework->GetIndex(),
-            message,
-            address,
-            true);
-    }
-
-    return false;
-}
-
-
-template <class ValueType>
-THERON_FORCEINLINE bool Actor::Push(const ValueType &value, const Address &from)
-{
-    // This method isn't typically called a message handler of this actor, so
-    // we need to use the processor context associated with the owning framework.
-    Detail::Processor::Context *const processorContext(&mFramework->mProcessorContext);
-
-    // Allocate a message. It'll be deleted by the worker thread that handles it.
-    Detail::IMessage *const message(Detail::MessageCreator::Create(
-        &processorContext->mMessageCache,
-        value,
-        from));
-
-    if (message)
-    {
-        // Send the message to the actor's own address.
-        return Detail::MessageSender::Send(
-            mFramework->mEndPoint,
-            processorContext,
-            mFramework->GetIndex(),
-            message,
-            GetAddress());
-    }
-
-    return false;
-}
-
-
-THERON_FORCEINLINE void Actor::Reference() const
-{
-    mRefCount.Increment();
-}
-
-
-THERON_FORCEINLINE bool Actor::Dereference() const
-{
-    uint32_t currentValue(mRefCount.Load());
-    uint32_t newValue(currentValue - 1);
-    uint32_t backoff(0);
-
-    THERON_ASSERT(currentValue > 0);
-
-    // Repeatedly try to atomically decrement the reference count.
-    // We do this by hand so we can atomically find out the new value.
-    while (!mRefCount.CompareExchangeAcquire(currentValue, newValue))
-    {
-        currentValue = mRefCount.Load();
-        newValue = currentValue - 1;
-        Detail::Utils::Backoff(backoff);
-    }
-
-    // Return true if the new reference count is zero.
-    return (newValue == 0);
-}
-
-
-THERON_FORCEINLINE void Actor::ProcessMessage(
-    Detail::FallbackHandlerCollection *const fallbackHandlers,
-    Detail::IMessage *const message)
-{
-    if (mMessageHandlers.Handle(this, message))
-    {
-        return;
-    }
-
-    // If no registered handler handled the message, execute the default handlers instead.
-    // This call is intentionally not inlined to avoid polluting the generated code with the uncommon case.
-    Fallback(fallbackHandlers, message);
-}
-
-
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_ACTOR_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ACTOR_H
+#define THERON_ACTOR_H
+
+
+/**
+\file Actor.h
+Actor baseclass.
+*/
+
+
+#include <Theron/Defines.h>
+
+// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
+#if THERON_XS
+#include <xs/xs.h>
+#endif // THERON_XS
+
+#if THERON_CPP11
+#include <type_traits>
+#include <utility>
+#endif // THERON_CPP11
+
+#if THERON_ENABLE_PROFILING
+#include <string.h>
+#endif // THERON_ENABLE_PROFILING
+
+#include <Theron/ActorProfile.h>
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/EndPoint.h>
+#include <Theron/Framework.h>
+#include <Theron/HandlerTable.h>
+#include <Theron/IAllocator.h>
+#include <Theron/MailboxHandle.h>
+#include <Theron/QueueWatermarkEvent.h>
+
+#include <Theron/Detail/Directory/Directory.h>
+#include <Theron/Detail/Handlers/DefaultHandlerCollection.h>
+#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
+#include <Theron/Detail/Handlers/HandlerCollection.h>
+#include <Theron/Detail/Handlers/MessageContinuation.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Messages/MessageSender.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/MailboxProcessor/Processor.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#if THERON_ENABLE_PROFILING
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#endif // THERON_ENABLE_PROFILING
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+/**
+Main namespace containing all public API components.
+*/
+namespace Theron
+{
+
+
+class ActorRef;
+class Framework;
+
+
+namespace Detail
+{
+class Processor;
+}
+
+
+/**
+\brief The actor baseclass.
+
+All actors in Theron must derive from this class.
+It provides the core functionality of an actor, such as the ability
+to \ref RegisterHandler "register message handlers" and \ref Send "send messages",
+including responding to messages received from other actors. When implementing
+actors derived from this baseclass, users can call the various protected methods
+of the baseclass to perform actions like registering message handlers and sending
+messages.
+
+Although derived actors classes can be constructed directly in user code, they are
+always associated with an owning \ref Framework that hosts and executes them.
+The owning Framework is provided to the Actor baseclass on construction.
+
+\code
+class MyActor : public Theron::Actor
+{
+public:
+
+    MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+    }
+};
+\endcode
+
+\note A fundamental principle of the Actor Model is that actors should communicate
+only by means of messages, both \ref Send "sent by themselves" and \ref RegisterHandler
+"handled by their message handlers". Since Actors in Theron are just vanilla C++
+classes that derive from the Actor baseclass, it's possible in practice to add
+conventional member functions to derived actor classes, breaking the Actor Model
+abstraction. However this should be avoided, since it results in ugly code and
+shared memory issues, reintroducing the need for traditional thread synchronization.
+Resist the temptation to add a method to an actor class and add a message instead.
+*/
+class Actor
+{
+public:
+
+    friend class ActorRef;
+    friend class Framework;
+    friend class Detail::Processor;
+
+#if !THERON_NO_LEGACY
+
+    /**
+    \brief Default constructor.
+
+    \note Direct default-construction of Actor baseclasses is forbidden. This
+    public default constructor is provided for backwards compatibility with the
+    legacy actor creation pattern used by versions of Theron prior to version 4.0.
+    
+    Always use one of the two supported actor creation patterns: the version 4 syntax or
+    (if necessary) the deprecated version 3.x syntax, which is still supported for backwards
+    compatibility. When writing new code, always use the new, simpler, version 4 syntax.
+
+    In versions of Theron prior to 4.0, actors couldn't be constructed directly
+    in user code. Instead you had to ask a Framework to create one for you, using
+    the CreateActor method template. Instead of returning the actor itself,
+    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
+    object.
+
+    \code
+    // LEGACY CODE!
+    class MyActor : public Theron::Actor
+    {
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        Theron::ActorRef actorRef(framework.CreateActor<MyActor>());
+    }
+    \endcode
+
+    In versions of Theron starting with 4.0, Actors are first-class citizens and
+    behave like vanilla C++ objects. They can be constructed directly with no
+    call to Framework::CreateActor. Once constructed they are referenced directly
+    by user code with no need for ActorRef proxy objects.
+
+    When writing new code, follow the new, simpler construction pattern where actors
+    are constructed directly and not referenced by ActorRefs:
+
+    \code
+    // New code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        MyActor actor(framework);
+    }
+    \endcode
+    */
+    Actor();
+
+#endif // !THERON_NO_LEGACY
+
+    /**
+    \brief Explicit constructor.
+
+    Constructs an actor within the given \ref Framework, with the given unique name.
+    If the name parameter is null then the actor is given an automatically generated name.
+
+    The Actor baseclass constructor expects an instance of the Framework class,
+    which becomes the owning Framework for the actor, hosting it and executing its
+    message handlers.
+
+    When defining their own derived actor classes, users must arrange to pass a
+    Framework object to the baseclass constructor. The typical way to arrange this
+    is to just expose the same parameter on the constructor of the derived actor,
+    and pass it through to the baseclass constructor in the initializer list:
+
+    The optional name parameter allows constructed actor objects to be given unique,
+    user-defined names. These names can then be used to send messages to the actors in
+    situations where the sending code has no direct reference to the destination actor, so
+    can't query it for its address. This is especially important when sending messages
+    to remote actors, where the actor is also required to be constructed in a Framework
+    tied to an \ref EndPoint.
+
+    If no name parameter is provided, or the name parameter is null, then the constructed
+    actor is given an automatically generated name. The generated name can still be used
+    to send messages, but since it is automatically generated it can't be known to the
+    user except by calling \ref GetAddress. Note that the generated name is only guaranteed
+    to be unique across all processes if each \ref EndPoint in the system is given a unique,
+    user-defined name on construction.
+
+    \note Sending a message to an actor using only its name requires an \ref EndPoint.
+    It involves a hashed lookup, so is slower than using an address retrieved directly
+    from the target actor using \ref GetAddress.
+
+    \code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        MyActor(Theron::Framework &framework, const char *const name) :
+          Theron::Actor(framework, name)
+        {
+        }
+    };
+
+    Theron::EndPoint::Parameters params("local", "tcp://192.168.10.104:5555");
+    Theron::EndPoint endPoint(params);
+    Theron::Framework framework(endPoint);
+    Theron::Receiver receiver(endPoint, "receiver");
+
+    MyActor actorOne(framework, "actor_one");
+    MyActor actorTwo(framework, "actor_two");
+
+    framework.Send(
+        std::string("hello"),
+        Theron::Address("receiver"),
+        Theron::Address("actor_one"));
+    \endcode
+
+    A powerful feature of actors is that they can create other actors, allowing
+    the building of complex subsystems of actors using object-like abstraction.
+    See the documentation of the \ref GetFramework method for more information.
+
+    \param framework Reference to a framework within which the actor will be hosted.
+    \param name An optional string defining the unique name of the actor object.
+
+    \note The string name parameter is copied so can be destroyed after the call.
+    */
+    explicit Actor(Framework &framework, const char *const name = 0);
+
+    /**
+    \brief Baseclass virtual destructor.
+    */
+    virtual ~Actor();
+
+    /**
+    \brief Returns the unique address of the actor.
+
+    This enables an actor to determine its own address and, for example,
+    to send that address to another actor in a message. In this example
+    we print out the address ("identity") of the actor in response to a query:
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        struct IdentifyMessage
+        {
+        };
+
+        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Actor::Identify);
+        }
+
+    private:
+
+        inline void Identify(const IdentifyMessage &message, const Theron::Address from)
+        {
+            printf("Actor address is: %d\n", GetAddress().AsInteger());
+        }
+    };
+    \endcode
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor. As a public method, it can also be accessed from
+    outside the actor to query the actor's address.
+    */
+    inline Address GetAddress() const;
+
+    /**
+    \brief Returns a reference to the framework that owns the actor.
+
+    This enables an actor to access the framework that owns it. One reason
+    this may be useful is to allow the actor to create other actors, which
+    effectively become nested inside it as its children. By nesting actors
+    it's possible to build complex subsystems, abstracted away behind the
+    message interface of a single actor.
+
+    To create actors that are 'children' of another actor, the parent actor
+    passes its owning Framework as a parameter to the child actor constructor.
+
+    A typical pattern is the allocate the children dynamically on the heap
+    using \em "operator new" in the parent constructor, hold pointers to the
+    created children in a container, and then destroy them using \em "operator
+    delete" in the parent destructor.
+
+    \code
+    class Wheel : public Theron::Actor
+    {
+        explicit Wheel(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    class Car : public Theron::Actor
+    {
+    public:
+
+        explicit Car(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            mWheels[0] = new Wheel(GetFramework());
+            mWheels[1] = new Wheel(GetFramework());
+            mWheels[2] = new Wheel(GetFramework());
+            mWheels[3] = new Wheel(GetFramework());
+        }
+
+        Car()
+        {
+            delete mWheels[0];
+            delete mWheels[1];
+            delete mWheels[2];
+            delete mWheels[3];
+        }
+
+    private:
+
+        Wheel *mWheels[4];
+    };
+    \endcode
+
+    \note This method can safely be called inside an actor message handler,
+    constructor, or destructor.
+    */
+    inline Framework &GetFramework() const;
+
+    /**
+    \brief Pushes a message into the actor.
+
+    This method is an alternative to \ref Framework::Send, which is the more
+    conventional and general way to send messages to actors. It can be
+    called in situations where the caller happens to have a direct reference
+    to the target actor (for example by means of a local variable or pointer).
+    
+    \note In general \ref Send should be preferred over Push. When sending messages
+    from inside an actor (for example in a message handler), use Actor::Send.
+    When sending messages to an actor from non-actor code, prefer Framework::Send
+    over Actor::Push, even in situations where you have a direct reference to the
+    receiving actor. Although Push looks like an optimization, it uses the same general
+    message sending mechanism as Send, and in fact is potentially slower in some cases
+    due to there being no thread-specific caches available.
+
+    As with \ref Framework::Send, it's necessary to provide a \em from address
+    when calling this method, because the address of the sender isn't implicit
+    from the context. It's legal to pass Theron::Address() or Theron::Address::Null(),
+    both of which evaluate to the \ref Theron::Address::Null "null address".
+
+    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
+    \param value The message value, which is copied.
+    \param from The address of the sender.
+    \return True, if the actor accepted the message.
+
+    \note The return value of this method should be understood to mean
+    just that the message was delivered to the mailbox associated with the actor.
+    This doesn't mean necessarily that the actor took any action in response
+    to the message. If the actor has no handlers registered for messages of that
+    type, then the message will simply be consumed without any effect. In such cases
+    this method will still return true. This surprising behavior is a result
+    of the asynchronous nature of message passing: the sender doesn't wait
+    for the recipient to process the message. It is the sender's responsibility
+    to ensure that messages are handled by the actors to which they are sent.
+    Actor implementations can also register a default message handler (see
+    \ref Actor::SetDefaultHandler). If no default handler is registered then the
+    unhandled message will be caught by the Framework's
+    \ref Framework::SetFallbackHandler "fallback handler", which, by default,
+    asserts.
+    */
+    template <class ValueType>
+    inline bool Push(const ValueType &value, const Address &from);
+
+    /**
+    \brief Pushes an array of message values into the actor in one burst.
+
+    Behaves like the single-value \ref Push called once per value, but pushes
+    the whole burst in one pass over the actor's message queue, with one
+    scheduling event for the lot instead of one per message. Use it to
+    reinject recorded bursts of messages -- from replay or batching tooling --
+    into a single actor:
+
+    \code
+    Event recordedEvents[1024];
+    const Theron::uint32_t numEvents(LoadRecordedEvents(recordedEvents));
+
+    actor.Push(recordedEvents, numEvents, Theron::Address::Null());
+    \endcode
+
+    The burst stops early if the actor's mailbox has a bounded capacity (see
+    \ref Framework::SetMailboxCapacity) and fills up, or if message allocation
+    fails; the returned count tells the caller how many values were accepted.
+
+    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
+    \param values Array of message values, each of which is copied.
+    \param count Number of values in the array.
+    \param from The address of the sender.
+    \return The number of values actually pushed, which is \em count unless
+    the burst stopped early.
+    */
+    template <class ValueType>
+    inline uint32_t Push(const ValueType *const values, const uint32_t count, const Address &from);
+
+    /**
+    \brief Pushes a range of message values into the actor in one burst.
+
+    Iterator-pair equivalent of the \ref Push(const ValueType *const,const uint32_t,const Address &)
+    "array burst push", accepting any forward iterator range over the message
+    values, so bursts can be reinjected directly from containers:
+
+    \code
+    std::vector<Event> recordedEvents(LoadRecordedEvents());
+
+    actor.Push(recordedEvents.begin(), recordedEvents.end(), Theron::Address::Null());
+    \endcode
+
+    \tparam IteratorType Forward iterator over the message values; the message
+    type is deduced from the iterator.
+    \param begin Iterator at the start of the range.
+    \param end Iterator at the end of the range.
+    \param from The address of the sender.
+    \return The number of values actually pushed, which is the size of the
+    range unless the burst stopped early.
+    */
+    template <class IteratorType>
+    inline uint32_t Push(const IteratorType &begin, const IteratorType &end, const Address &from);
+
+    /**
+    \brief Gets the number of messages queued at this actor, awaiting processing.
+
+    Returns the number of messages currently in the message queue of the actor.
+    The messages in the queue are those that have been received by the actor but
+    for which registered message handlers have not yet been executed, and so are
+    still awaiting processing.
+    
+    \note If called from a message handler function, the returned count includes
+    the message whose receipt triggered the execution of the handler. This behavior
+    changed in Theron 4 -- in previous versions, the count didn't include the
+    current message.
+    */
+    inline uint32_t GetNumQueuedMessages() const;
+
+    /**
+    \brief Sets high and low watermarks on the message queue of this actor.
+
+    When the number of queued messages rises through the high watermark, a
+    \ref QueueWatermarkEvent message with \ref QueueWatermarkEvent::mHigh
+    "mHigh" set is delivered to the actor through its own mailbox; when the
+    queue subsequently drains back to the low watermark, a second event with
+    mHigh clear is delivered, rearming the high watermark. Handle the events
+    by registering a message handler for the \ref QueueWatermarkEvent type:
+
+    \code
+    class Throttled : public Theron::Actor
+    {
+    public:
+
+        explicit Throttled(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Throttled::OnWatermark);
+            SetQueueWatermarks(256, 64);
+        }
+
+    private:
+
+        void OnWatermark(const Theron::QueueWatermarkEvent &event, const Theron::Address from)
+        {
+            // Ask producers to back off, or resume, as the queue fills and drains.
+        }
+    };
+    \endcode
+
+    The events make backpressure decisions event-driven, replacing periodic
+    polling of \ref GetNumQueuedMessages. A high watermark of zero, the
+    default, disables the events.
+
+    \param high Queue depth whose upward crossing triggers a high event.
+    \param low Queue depth at which the drained queue triggers a low event; must be less than \em high.
+
+    \see QueueWatermarkEvent
+    \see GetNumQueuedMessages
+    */
+    inline void SetQueueWatermarks(const uint32_t high, const uint32_t low);
+
+protected:
+
+    /**
+    \brief Registers a handler for a specific message type.
+
+    Derived actor classes should call this method to register message handlers.
+    Once registered, a message handler is automatically executed whenever the
+    owning actor receives a message of the type that the message handler function
+    accepts.
+
+    For example this simple HelloWorld actor has a single handler which is executed
+    in response to \em hello messages. It's important to note that message handlers
+    must currently always take their message parameters by \em reference:
+
+    \code
+    class HelloWorld : public Theron::Actor
+    {
+    public:
+
+        struct HelloMessage { };
+
+        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &HelloWorld::Hello);
+        }
+
+    private:
+
+        inline void Hello(const HelloMessage &message, const Theron::Address from)
+        {
+            printf("Hello world!\n");
+        }
+    };
+    \endcode
+
+    Message handlers can be registered at basically any point in the lifetime of the actor.
+    In particular they can safely be registered in the derived actor constructor,
+    as well as from within other message handlers of the actor (themselves previously
+    registered and then executed in response to received messages).
+
+    If a message handler is registered multiple times, it will be executed multiple times
+    in response to received messages of its expected type. Each subsequent de-registration
+    then removes just one of the multiple registrations.
+
+    One subtlety to be aware of is that message handlers aren't executed on receipt of
+    messages of types \em derived from the message types expected by the handler. In order to
+    handle derived message types, register separate handlers for those types - and call the handler
+    registered for the base message type explicitly from the derived handler, if required.
+
+    \code
+    class HelloWorld : public Theron::Actor
+    {
+    public:
+
+        struct HelloMessage { };
+        struct HowdyMessage : public HelloMessage { };
+
+        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &HelloWorld::Hello);
+            RegisterHandler(this, &HelloWorld::Howdy);
+        }
+
+    private:
+
+        void Hello(const HelloMessage &message, const Theron::Address from)
+        {
+            printf("Hello world!\n");
+        }
+
+        void Howdy(const HowdyMessage &message, const Theron::Address from)
+        {
+            Hello(message, from);
+            printf("How y'all doin?\n");
+        }
+    };
+    \endcode
+
+    Another tricky subtlety is that the compiler may treat handlers that are exactly
+    identical as the same function, in optimized builds. The following example shows
+    this confusing effect:
+
+    \code
+    class HelloWorld : public Theron::Actor
+    {
+    public:
+
+        struct HelloMessage { };
+
+        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &HelloWorld::HelloOne);
+            IsHandlerRegistered(this, &HelloWorld::HelloTwo);   // May returns true, in some optimized builds.
+        }
+
+    private:
+
+        void HelloOne(const HelloMessage &message, const Theron::Address from)
+        {
+            printf("Hello world!\n");
+        }
+
+        void HelloTwo(const HelloMessage &message, const Theron::Address from)
+        {
+            printf("Hello world!\n");
+        }
+    };
+    \endcode
+
+    \tparam ActorType The derived actor class.
+    \tparam ValueType The message type accepted by the handler.
+    \param actor Pointer to the derived actor instance.
+    \param handler Member function pointer identifying the message handler function.
+    \return True, if the registration was successful. Failure may indicate out-of-memory.
+    */
+    template <class ActorType, class ValueType>
+    inline bool RegisterHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(const ValueType &message, const Address from));
+
+    /**
+    \brief Registers a handler taking the message value by non-const reference.
+
+    Handlers registered with this overload are passed a mutable reference to the
+    received message value, rather than a const reference. Because each message
+    is only ever processed by one thread at a time, the handler has exclusive
+    access to the value, so can safely modify it in place or move its contents
+    out to take ownership of them -- avoiding a copy of any resources held by
+    the value, such as heap-allocated buffers.
+
+    \tparam ActorType The derived actor class.
+    \tparam ValueType The message type accepted by the handler.
+    \param actor Pointer to the derived actor instance.
+    \param handler Member function pointer identifying the message handler function.
+    \return True, if the registration was successful. Failure may indicate out-of-memory.
+    */
+    template <class ActorType, class ValueType>
+    inline bool RegisterHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(ValueType &message, const Address from));
+
+    /**
+    \brief Registers a callable object as a message handler.
+
+    Instead of a member function on the actor class, the handler can be any
+    callable invocable with the message value and from address: a C++11 lambda,
+    a function object, or a free function pointer. The message type can't be
+    deduced from the callable, so is given explicitly:
+
+    \code
+    class Counter : public Theron::Actor
+    {
+    public:
+
+        explicit Counter(Theron::Framework &framework, const int limit) : Theron::Actor(framework)
+        {
+            int count(0);
+            RegisterHandler<int>([this, count, limit](const int &message, const Theron::Address from) mutable
+            {
+                if ((count += message) >= limit)
+                {
+                    Send(count, from);
+                }
+            });
+        }
+    };
+    \endcode
+
+    The callable is copied into the allocated handler object itself, so
+    registration costs one handler allocation just like a member function
+    handler, with no separate type-erased function wrapper; dispatch invokes
+    the callable directly through the handler's single virtual call. Captured
+    state is per handler object, so each instance can register its own
+    specialized handler, as in the example, without trampoline methods on the
+    actor class. Messages are dispatched to an actor by one thread at a time,
+    so mutable lambdas and stateful function objects are safe.
+
+    \note Callable handlers have no comparable identity, so unlike member
+    function handlers they can't be deregistered with \ref DeregisterHandler;
+    they remain registered until the actor is destructed.
+
+    \tparam ValueType The message type accepted by the handler; given explicitly.
+    \tparam CallableType The type of the callable; deduced from the argument.
+    \param callable The callable to be invoked for received messages of the type.
+    \return True, if the registration was successful. Failure may indicate out-of-memory.
+    */
+    template <class ValueType, class CallableType>
+    inline bool RegisterHandler(const CallableType &callable);
+
+    /**
+    \brief Registers the handlers of a shared \ref HandlerTable with this actor.
+
+    Instead of registering its handlers one by one, each registration
+    allocating a handler object owned by the instance, an actor can reference
+    a handler table built once for its class. The table's handlers become the
+    actor's registered handlers without being copied, so registration costs
+    large actor populations no per-instance allocations.
+
+    Handlers can still be registered and deregistered individually afterwards;
+    the first such change gives the instance a private copy of the handler
+    set, leaving the shared table untouched.
+
+    \note Call this before any \ref RegisterHandler calls, typically first in
+    the constructor. The table must be fully populated before instances
+    reference it, and must outlive them.
+
+    \param table The shared handler table describing this actor class's handlers.
+
+    \see HandlerTable
+    */
+    inline void RegisterHandlerTable(const HandlerTable &table);
+
+    /**
+    \brief Deregisters a previously registered message handler.
+
+    Call this method to deregister message handlers registered earlier with \ref RegisterHandler.
+
+    Message handlers can be deregistered at any point in the actor's lifetime.
+    They can be safely deregistered from within the constructor and destructor of the actor.
+    They can also be deregistered from within message handlers, including from within the
+    deregistered message handler itself: Message handlers can deregister themselves!
+    
+    The ability to register and deregister message handlers from \em within message handlers means
+    we can dynamically alter the message interface of an actor at runtime, in response to the
+    messages we receive. In this example, a HelloWorld actor can be woken and put to sleep
+    using messages. It only responds to \em HelloMessage messages when awake:
+
+    \code
+    class HelloWorld : public Theron::Actor
+    {
+    public:
+
+        struct WakeMessage { };
+        struct SleepMessage { };
+        struct HelloMessage { };
+
+        explicit HelloWorld(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &HelloWorld::Wake);
+        }
+
+    private:
+
+        void Wake(const WakeMessage &message, const Theron::Address from)
+        {
+            RegisterHandler(this, &HelloWorld::Hello);
+
+            DeregisterHandler(this, &HelloWorld::Wake);
+            RegisterHandler(this, &HelloWorld::Sleep);
+        }
+
+        void Sleep(const SleepMessage &message, const Theron::Address from)
+        {
+            DeregisterHandler(this, &HelloWorld::Hello);
+
+            DeregisterHandler(this, &HelloWorld::Sleep);
+            RegisterHandler(this, &HelloWorld::Wake);
+        }
+
+        void Hello(const HelloMessage &message, const Theron::Address from)
+        {
+            printf("Hello world!\n");
+        }
+    };
+    \endcode
+
+    If a message handler was previously registered multiple times, it must be deregistered multiple
+    times in order to completely deregister it. Each deregistration removes one of the multiple
+    registrations, decreasing by one the number of times the handler will be executed in response
+    to a received message of the type it expects.
+
+    \tparam ActorType The derived actor class.
+    \tparam ValueType The message type accepted by the handler function.
+    \param actor Pointer to the derived actor instance.
+    \param handler Member function pointer identifying the message handler function.
+    \return True, if the message handler was deregistered.
+
+    \note It's not necessary to deregister handlers that an actor registers before the
+    actor is destructed. Doing so is optional, though of course completely safe. Any handlers
+    left registered prior to destruction of the actor will simply be automatically deregistered
+    on destruction.
+    */
+    template <class ActorType, class ValueType>
+    inline bool DeregisterHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(const ValueType &message, const Address from));
+
+    /**
+    \brief Deregisters a previously registered mutable message handler.
+    */
+    template <class ActorType, class ValueType>
+    inline bool DeregisterHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(ValueType &message, const Address from));
+
+    /**
+    \brief Checks whether the given message handler is registered with the actor.
+
+    Although handlers are typically only registered once, in general they can be registered
+    any number of times. For that reason, a handler is counted as registered if the number
+    of times it has been \ref RegisterHandler "registered" thus far is greater than the number
+    of times it has been \ref DeregisterHandler "deregistered".
+    */
+    template <class ActorType, class ValueType>
+    inline bool IsHandlerRegistered(
+        ActorType *const actor,
+        void (ActorType::*handler)(const ValueType &message, const Address from));
+
+    /**
+    \brief Checks whether the given mutable message handler is registered with the actor.
+    */
+    template <class ActorType, class ValueType>
+    inline bool IsHandlerRegistered(
+        ActorType *const actor,
+        void (ActorType::*handler)(ValueType &message, const Address from));
+
+    /**
+    \brief Checks whether the processing budget of this scheduling event is exhausted.
+
+    Handlers are never preempted while running, so one handler that loops for
+    a long time stalls every mailbox queued behind it on its worker thread.
+    Long-running handlers can bound that stall cooperatively: with a
+    \ref Framework::Parameters::mHandlerBudgetMicroseconds "processing budget"
+    configured on the framework, this method reports whether the budget of
+    the scheduling event in progress has been exceeded, allowing the handler
+    to checkpoint its progress and return early. Remaining messages in the
+    mailbox's batch are then re-queued and the worker returns to the pool:
+
+    \code
+    void Crunch(const WorkMessage &message, const Theron::Address from)
+    {
+        WorkMessage remaining(message);
+        while (remaining.mItemCount)
+        {
+            ProcessOneItem(remaining);
+
+            if (YieldIfOverBudget())
+            {
+                // Continue from the checkpoint in a later scheduling event.
+                Send(remaining, GetAddress());
+                return;
+            }
+        }
+    }
+    \endcode
+
+    \return True, if a budget is configured and the current scheduling event has exceeded it.
+
+    \note Returns false when no budget is configured, or when the actor isn't
+    being processed by a worker thread.
+    */
+    inline bool YieldIfOverBudget() const;
+
+    /**
+    \brief Sets the default message handler executed for unhandled messages.
+
+    This handler, if set, is run when a message arrives at the actor of a type for
+    which no regular message handlers are registered.
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            SetDefaultHandler(this, &Actor::DefaultHandler);
+        }
+
+    private:
+
+        void DefaultHandler(const Theron::Address from)
+        {
+            printf("Actor received unknown message from address '%d'\n", from.AsInteger());
+        }
+    };
+    \endcode
+
+    Passing 0 to this method clears any previously set default handler.
+    
+    If no default handler is set, then unhandled messages are passed to the
+    \ref Framework::SetFallbackHandler "fallback handler" registered with the owning
+    \ref Framework. The default fallback handler reports unhandled messages by means
+    of asserts, which can be enabled or disabled using the
+    \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define.
+
+    \tparam ActorType The derived actor class.
+    \param actor Pointer to the derived actor instance.
+    \param handler Member function pointer identifying the message handler function.
+    */
+    template <class ActorType>
+    inline bool SetDefaultHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(const Address from));
+
+    /**
+    \brief Sets the default message handler executed for unhandled messages.
+
+    This method sets a 'blind' default handler which, when executed, is passed the
+    unknown message as blind data. The blind data consists of the memory block containing
+    the message, identified by a void pointer and a size.
+
+    The blind handler, if set, is run when a message arrives of a type for which no
+    regular message handlers are registered. The handler, being user-defined, may be able
+    to inspect the contents of the message and take appropriate action, such as reporting
+    the contents of an unexpected message to help with debugging.
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            SetDefaultHandler(this, &Actor::DefaultHandler);
+        }
+
+    private:
+
+        void DefaultHandler(const void *const data, const Theron::uint32_t size, const Theron::Address from)
+        {
+            printf("Actor received unknown message of size %d from address '%d'\n", size, from.AsInteger());
+        }
+    };
+    \endcode
+
+    Passing 0 to this method clears any previously set default handler.
+
+    If no default handler is set, then unhandled messages are passed to the
+    \ref Framework::SetFallbackHandler "fallback handler" registered with the owning
+    \ref Framework. The default fallback handler reports unhandled messages by means
+    of asserts, which can be enabled or disabled using the
+    \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define.
+
+    \tparam ActorType The derived actor class.
+    \param actor Pointer to the derived actor instance.
+    \param handler Member function pointer identifying the message handler function.
+    */
+    template <class ActorType>
+    inline bool SetDefaultHandler(
+        ActorType *const actor,
+        void (ActorType::*handler)(const void *const data, const uint32_t size, const Address from));
+
+    /**
+    \brief Sends a message to the entity (actor or Receiver) at the given address.
+
+    \code
+    class Responder : public Theron::Actor
+    {
+    public:
+
+        struct Message
+        {
+        };
+
+        explicit Responder(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Responder::Respond);
+        }
+
+    private:
+
+        void Respond(const Message &message, const Theron::Address from)
+        {
+            // Send the message back to the sender.
+            Send(message, from);
+        }
+    };
+    \endcode
+
+    Any copyable class or Plain-Old-Data type can be sent in a message. Messages
+    are copied when they are sent, so that the recipient sees a different piece of
+    memory with the same value. The copying is performed with the copy-constructor
+    of the message class.
+    
+    \note The requirements for messages sent to remote actors over a network are
+    different, and significantly stricter. Currently, message types sent to remote
+    actors must be bitwise-copyable via memcpy, so can't contain pointers.
+
+    Typically non-POD message classes should be provided with
+    a meaningful default constructor, copy constructor, assignment operator and
+    destructor. If the message type is derived from a base type (in an inheritance
+    hierarchy of message types) then the base class should typically have a virtual
+    destructor.
+
+    In general it is unsafe to pass pointers in messages, since doing so re-introduces
+    shared memory, where multiple actors can access the same memory at the same time.
+    The exception is where steps are taken to ensure that the sender is prevented from
+    accessing the referenced memory after the send (for example using an auto-pointer).
+    In such cases ownership is effectively transferred to the recipient by the message.
+
+    Note that immediate C arrays can't be sent as messages, since they aren't copyable.
+    For example the first call to Send in the following code won't compile, because the
+    literal string message is an array. The second, where the array is sent as a pointer
+    instead, works fine. Arrays can safely be sent as members of message classes.
+    Of course, a safer approach is to send a std::string, as shown as the final call:
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        struct Message
+        {
+            char mBuffer[32];
+        }
+
+        explicit Actor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            Send("hello", someAddress);                 // Immediate C array; won't compile!
+
+            char *const message("hello");
+            Send(message, someAddress);                 // Fastest, but use with care!
+
+            Message message2;
+            strcpy(message2.mBuffer, "hello");
+            Send(message2, someAddress);                // Safe but involves a shallow copy.
+
+            Send(std::string("hello"), someAddress);    // Safest but involves a deep copy.
+        }
+    }
+    \endcode
+
+    The boolean return value returned by Send indicates whether the message was delivered.
+    Note however that messages sent to actors are in reality addressed to mailboxes, not
+    actors themselves. So a return value of true indicates only that the message was
+    delivered to a mailbox, which may well be unattended.
+
+    A return value of false indicates that an error occurred and the message was not
+    sent. In the case of messages addressed to a Receiver, this may indicate that
+    no such receiver is registered (it may have existed once and been destructed).
+    In the case of messages addressed to an actor, a false return value more likely
+    indicates that the message could not be allocated, due to out-of-memory.
+
+    An important subtlety is that a return value of true indicates only that the message
+    was delivered to a mailbox, not that it was delivered to an associated actor, or
+    moreover that the receiving actor had message handlers registered for it. On the
+    contrary a true return value indicates only that the message was delivered to a mailbox.
+
+    The processing of the mailbox is scheduled asynchronously and typically happens
+    some time later, on a different thread. If no actor is registered at the mailbox
+    when it is eventually processed, then the message will simply be discarded, even
+    though it was delivered successfully to the mailbox. And even if an actor is
+    registered at the mailbox, it may have no handlers registered for the message
+    type, in which case the message may be silently discarded.
+
+    Such undelivered or unhandled messages will be caught and reported as asserts by the
+    default fallback handler, unless it is replaced by a custom user implementation using
+    \ref Framework::SetFallbackHandler.
+
+    Messages sent to mailboxes within the local process by the same sender are
+    guaranteed to be delivered to those mailboxes in the order they are sent. Once
+    delivered, they are guaranteed to processed in the order they were received.
+    When messages by different senders or to mailboxes in other processes (potentially
+    on other hosts) the arrival order is not guaranteed.
+
+    This method can safely be called within the constructor or destructor of a derived
+    actor object, as well as (more typically) within its message handler functions.
+
+    \note When sending messages from message handlers, use \ref TailSend instead, in the
+    common case where the sending of the message is the last action of the message
+    handler. In such cases, using TailSend can result in significantly higher performance.
+
+    \tparam ValueType The message type (any copyable class or Plain-Old-Data type).
+    \param value The message value to be sent.
+    \param address The address of the destination Receiver or Actor mailbox.
+    \return True, if the message was delivered, otherwise false.
+
+    \note When compiled with C++11 support enabled, message values passed as
+    rvalues are moved into the sent message rather than copied, avoiding a
+    potentially expensive deep copy of any resources held by the value.
+
+    \see TailSend
+    */
+#if THERON_CPP11
+    template <class ValueType>
+    inline bool Send(ValueType &&value, const Address &address) const;
+#else
+    template <class ValueType>
+    inline bool Send(const ValueType &value, const Address &address) const;
+#endif // THERON_CPP11
+
+    /**
+    \brief Sends a message to the mailbox pinned by the given handle.
+
+    Works like \ref Send, but the destination is a \ref MailboxHandle obtained
+    earlier from \ref Framework::GetMailboxHandle, so no per-send resolution
+    of the destination address is performed. Useful in the tightest sending
+    loops, where the destination is fixed and the per-send directory lookup
+    is measurable; an actor that repeatedly sends to the same destination can
+    resolve the handle once and keep it as a member:
+
+    \code
+    void Streamer::Start(const StartMessage &message, const Theron::Address from)
+    {
+        mOutput = GetFramework().GetMailboxHandle(message.mConsumer);
+    }
+
+    void Streamer::Produce(const Sample &message, const Theron::Address from)
+    {
+        Send(Transform(message), mOutput);
+    }
+    \endcode
+
+    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
+    \param value The message value to be sent.
+    \param handle Handle to the pinned destination mailbox.
+    \return True, if the message was delivered to the mailbox, otherwise false.
+
+    \see Framework::GetMailboxHandle
+    */
+#if THERON_CPP11
+    template <class ValueType>
+    inline bool Send(ValueType &&value, const MailboxHandle &handle) const;
+#else
+    template <class ValueType>
+    inline bool Send(const ValueType &value, const MailboxHandle &handle) const;
+#endif // THERON_CPP11
+
+    /**
+    \brief Sends a message to the entity at the given address, without waking a worker thread.
+
+    This method sends a message to the entity at a given address, and is functionally
+    identical to the similar \ref Send method.
+    
+    TailSend differs from Send in that it is potentially more efficient when
+    called as the last operation of a message handler. TailSend hints to Theron that
+    the message handler sending the message is about to terminate, freeing the worker
+    thread that is currently executing it. When the receiving actor's mailbox is idle,
+    the message is processed immediately on the current worker thread, with no queueing
+    at all, collapsing the per-hop latency of pipelined actors from a work queue
+    round-trip to little more than a function call. Otherwise the receiving actor is
+    scheduled on the same thread, rather than dispatched to an arbitrary, and
+    potentially different, worker thread.
+
+    \note TailSend is only useful when called from the 'tail' of a message handler
+    (rather than an actor constructor or destructor) and only when the sent message
+    is addressed to an actor within the same \ref Framework. Since the actor receiving
+    the message is typically processed by the worker thread that is executing the
+    current message handler, the two are effectively serialized with no potential
+    for parallelism. For that reason TailSend should not be used to send messages
+    to actors that are intended to handle the message in parallel with the executing
+    handler. Inline processing is bounded in depth, so long chains of actors linked
+    by tail sends execute as a bounded number of nested calls before reverting to
+    queued scheduling.
+
+    \code
+    class Processor : public Theron::Actor
+    {
+    public:
+
+        explicit Processor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Processor::Process);
+        }
+
+    private:
+
+        void Process(const int &message, const Theron::Address from)
+        {
+            // Use Send when sending messages from non-tail positions.
+            Send(someRequest, someOtherActor);
+
+            // Do some compute-intensive processing using the message value.
+            // ...
+
+            // Send the result as the last action using TailSend.
+            TailSend(result, from);
+        }
+    };
+    \endcode
+   
+    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
+    \param value The message value to be sent.
+    \param address The address of the destination Actor.
+    \return True, if the message was delivered to a mailbox, otherwise false.
+
+    \note When compiled with C++11 support enabled, message values passed as
+    rvalues are moved into the sent message rather than copied.
+
+    \see Send
+    */
+#if THERON_CPP11
+    template <class ValueType>
+    inline bool TailSend(ValueType &&value, const Address &address) const;
+#else
+    template <class ValueType>
+    inline bool TailSend(const ValueType &value, const Address &address) const;
+#endif // THERON_CPP11
+
+    /**
+    \brief Sends a message and registers a continuation for the reply.
+
+    Sends the given value to the actor at the given address, like \ref Send,
+    and additionally registers a one-shot continuation: a member function of
+    this actor that is executed with the reply, when the addressed actor
+    replies. The continuation fires instead of any \ref RegisterHandler
+    "registered handler" for the reply type, and is then unregistered.
+
+    Replies are matched to pending continuations by the address the reply
+    arrives from and by its message type, so a pending continuation doesn't
+    intercept unrelated messages, and multiple requests can be in flight at
+    once. Replies to identical outstanding requests consume their
+    continuations in the order the requests were sent.
+
+    When the addressed actor produces its reply with \ref TailSend, the reply
+    is processed inline on the worker thread that handled the request,
+    executing the continuation directly without a second scheduling
+    round-trip, so the request's data stays in the caches of a single core.
+
+    \code
+    class QueryActor : public Theron::Actor
+    {
+    public:
+
+        explicit QueryActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &QueryActor::Query);
+        }
+
+    private:
+
+        void Query(const Request &request, const Theron::Address from)
+        {
+            // The store's reply executes OnResult, not a registered handler.
+            SendWithContinuation(Lookup(request.mKey), mStore, &QueryActor::OnResult);
+        }
+
+        void OnResult(const Record &record, const Theron::Address from)
+        {
+            // ...
+        }
+    };
+    \endcode
+
+    \note Like handler registration, this method is intended to be called
+    from message handlers of this actor, or from its constructor; pending
+    continuations are examined and executed by the single worker thread
+    processing the actor's mailbox. A continuation whose reply never arrives
+    remains pending until the actor is destructed.
+
+    \tparam ValueType The message type of the request (any copyable class or Plain Old Datatype).
+    \tparam ActorType The derived actor class owning the continuation member function.
+    \tparam ReplyType The message type of the expected reply.
+    \param value The request message value to be sent.
+    \param address The address of the destination Actor.
+    \param continuation Member function executed with the reply when it arrives.
+    \return True, if the request was delivered to a mailbox, otherwise false.
+    In case of failure the continuation is unregistered, since no reply can arrive.
+
+    \see Send
+    \see TailSend
+    */
+    template <typename ValueType, class ActorType, typename ReplyType>
+    inline bool SendWithContinuation(
+        const ValueType &value,
+        const Address &address,
+        void (ActorType::*continuation)(const ReplyType &message, const Address from));
+
+    /**
+    \brief Defers the message currently being handled, to be re-delivered later.
+
+    Actors implementing multi-step protocols receive messages they can't act
+    on yet -- requests arriving mid-transaction, for example -- and otherwise
+    have to copy them into actor state by hand. Stashing instead moves the
+    message being handled onto a side list inside the actor's own mailbox, an
+    intrusive-list operation with no copying or allocation. Stashed messages
+    are not re-delivered until \ref UnstashAll releases them, at which point
+    they are processed ahead of the ordinary queued messages, in the order
+    they were stashed.
+
+    \code
+    class Transactional : public Theron::Actor
+    {
+    public:
+
+        explicit Transactional(Theron::Framework &framework) : Theron::Actor(framework), mBusy(false)
+        {
+            RegisterHandler(this, &Transactional::OnRequest);
+            RegisterHandler(this, &Transactional::OnCommit);
+        }
+
+    private:
+
+        void OnRequest(const Request &request, const Theron::Address from)
+        {
+            if (mBusy)
+            {
+                // Mid-transaction; defer the request until the commit.
+                Stash();
+                return;
+            }
+
+            mBusy = true;
+            // ... start the transaction ...
+        }
+
+        void OnCommit(const Commit &commit, const Theron::Address from)
+        {
+            mBusy = false;
+
+            // Re-deliver the requests deferred during the transaction.
+            UnstashAll();
+        }
+
+        bool mBusy;
+    };
+    \endcode
+
+    \note May only be called from within a message handler of this actor;
+    calls from elsewhere have no effect and return false. A message stashed
+    by one of the handlers registered for its type is still offered to the
+    remaining handlers before being set aside.
+
+    \return True, if the current message was stashed (or already had been).
+
+    \see UnstashAll
+    */
+    inline bool Stash();
+
+    /**
+    \brief Releases all previously stashed messages for re-delivery.
+
+    Splices the messages deferred by earlier calls to \ref Stash back into
+    the delivery order of the actor's mailbox in a single O(1) list
+    operation. The released messages are re-delivered ahead of the ordinary
+    queued messages, in the order they were originally stashed, starting
+    after the handlers for the current message return. A re-delivered
+    message can be stashed again.
+
+    \note May only be called from within a message handler of this actor,
+    since the stash belongs to the mailbox being processed; calls from
+    elsewhere have no effect.
+
+    \see Stash
+    */
+    inline void UnstashAll();
+
+    /**
+    \brief Returns an allocator for temporary allocations within message handlers.
+
+    The returned allocator is a per-worker-thread bump arena: allocation is a
+    pointer increment and \ref IAllocator::Free "Free" is a no-op, so scratch
+    buffers built up and discarded within a handler cost almost nothing to
+    allocate. All memory allocated from the arena is released automatically
+    when the currently executing message handler returns, so pointers into it
+    must never be retained across messages -- in particular they must not be
+    stored in actor members or sent in messages.
+
+    \code
+    class Sorter : public Theron::Actor
+    {
+    public:
+
+        explicit Sorter(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Sorter::Sort);
+        }
+
+    private:
+
+        void Sort(const Request &message, const Theron::Address from)
+        {
+            // Scratch space valid until this handler returns; no free needed.
+            Theron::IAllocator *const scratch(GetScratchAllocator());
+            int *const workspace(static_cast<int *>(scratch->Allocate(message.mCount * sizeof(int))));
+
+            // ... sort using the workspace and send the result ...
+        }
+    };
+    \endcode
+
+    \note May only be called while the actor is executing a message handler
+    (including handlers executing nested within a \ref TailSend). Calls from
+    actor constructors or destructors return zero.
+
+    \return Pointer to the scratch allocator, or zero if no message handler is executing.
+    */
+    inline IAllocator *GetScratchAllocator() const;
+
+    /**
+    \brief Executes a functor over an integer range, in parallel on idle framework workers.
+
+    A message handler doing heavy array computation otherwise runs it
+    single-threaded on one worker, while other workers may sit idle.
+    ParallelFor splits the range [0, count) into chunks and publishes them to
+    the framework: worker threads with no mailbox work claim and execute
+    chunks alongside the calling thread, and the call returns when the whole
+    range has been executed. The functor is invoked once per index, as if by
+    \code
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        functor(index);
+    }
+    \endcode
+    except that invocations are unordered and run concurrently, so the functor
+    must not mutate shared state without synchronization -- writing only to
+    per-index locations of an output array is the intended pattern:
+
+    \code
+    struct Scale
+    {
+        inline void operator()(const Theron::uint32_t index)
+        {
+            mOutput[index] = mInput[index] * mFactor;
+        }
+
+        const float *mInput;
+        float *mOutput;
+        float mFactor;
+    };
+
+    void Worker::Process(const Request &message, const Theron::Address from)
+    {
+        Scale scale = { message.mInput, message.mOutput, 2.0f };
+        ParallelFor(message.mCount, scale);
+
+        // The whole range has been executed when the call returns.
+        Send(Done(), from);
+    }
+    \endcode
+
+    The computation borrows only workers that would otherwise idle, so it
+    never starves message processing, and completes on the calling thread
+    alone if every worker is busy. Calls from outside message handlers, and
+    within frameworks with a single worker thread, execute the range inline.
+
+    \note At most one parallel range is active per framework at a time; a
+    handler calling ParallelFor while another actor's call is in progress
+    executes its range inline rather than waiting.
+
+    \param count The number of indices in the range; the functor is invoked for each of [0, count).
+    \param functor The functor invoked per index; shared by threads, so its operator() should be const-safe.
+    */
+    template <class FunctorType>
+    inline void ParallelFor(const uint32_t count, FunctorType &functor) const;
+
+    /**
+    \brief Marks the start of a blocking operation within a message handler.
+
+    A message handler that makes a blocking call -- waiting on a disk read, a
+    database query, or a blocking third-party API -- occupies its worker thread
+    for the duration of the call without processing any messages, reducing the
+    effective parallelism of the framework. Bracketing the blocking call with
+    EnterBlockingSection and \ref LeaveBlockingSection tells the framework
+    that the worker is parked, and the framework starts a replacement worker
+    for the duration, so message processing continues at full parallelism
+    without permanently overprovisioning the thread pool:
+
+    \code
+    void Loader::Load(const Request &message, const Theron::Address from)
+    {
+        EnterBlockingSection();
+        const Result result(ReadFromDisk(message.mFileName));
+        LeaveBlockingSection();
+
+        Send(result, from);
+    }
+    \endcode
+
+    Replacement workers are created only while the worker count is below the
+    bound set by \ref Framework::SetMaxThreads, so the bound caps the total
+    thread count as usual; set it above the steady-state worker count to leave
+    headroom for replacements. When the blocking section ends the thread count
+    falls back to its previous level.
+
+    \note Replacement workers are started and retired by the framework's
+    manager thread, which services requests every few milliseconds, so very
+    short blocking sections may come and go without a replacement being
+    created. The cost of the call itself is a single atomic increment.
+
+    \note Every call must be paired with a matching call to
+    \ref LeaveBlockingSection on the same thread, before the handler returns.
+
+    \see LeaveBlockingSection
+    */
+    inline void EnterBlockingSection() const;
+
+    /**
+    \brief Marks the end of a blocking operation within a message handler.
+
+    Ends a blocking section opened by \ref EnterBlockingSection, allowing the
+    framework to retire the replacement worker created for it, if any.
+
+    \see EnterBlockingSection
+    */
+    inline void LeaveBlockingSection() const;
+
+    /**
+    \brief Dispatches a received message to the handlers registered for its type.
+
+    The default implementation offers the message to the dynamically registered
+    message handlers. \ref StaticActor overrides this to dispatch messages of
+    statically listed types directly to handler member functions resolved at
+    compile time, consulting the dynamic handlers only for unlisted types.
+
+    \return True if at least one handler handled the message.
+    */
+    inline virtual bool DispatchMessage(const Detail::IMessage *const message);
+
+    /**
+    \brief Registers a message type with the network endpoint tied to the owning framework, if any.
+
+    Registering the type against its name enables it to be recognized when it
+    arrives in a network message as a blind block of data tagged with a type name.
+    Handler registration does this automatically; it's exposed for derived classes
+    such as \ref StaticActor that dispatch messages without registering handlers.
+    */
+    template <class ValueType>
+    inline void RegisterMessageType() const;
+
+private:
+
+    // Actors are non-copyable.
+    Actor(const Actor &other);
+    Actor &operator=(const Actor &other);
+
+    /**
+    Legacy ActorRef reference counting support.
+    */
+    inline void Reference() const;
+    inline bool Dereference() const;
+
+    /**
+    Processes the given message, passing it to handlers registered for its type.
+    */
+    inline void ProcessMessage(
+        Detail::FallbackHandlerCollection *const fallbackHandlers,
+        Detail::IMessage *const message);
+
+    /**
+    Handle an unhandled message.
+    */
+    void Fallback(
+        Detail::FallbackHandlerCollection *const fallbackHandlers,
+        const Detail::IMessage *const message);
+
+    /**
+    Executes and unregisters the oldest pending continuation matching the
+    given message, if any.
+    \return True, if a continuation consumed the message.
+    */
+    bool HandleContinuation(const Detail::IMessage *const message);
+
+#if THERON_ENABLE_PROFILING
+
+    /**
+    Records a timed handler execution sample against the message's type, and
+    the delay the message spent queued before processing against its sender.
+    \note Only called by the single worker thread currently processing the actor's
+    mailbox, so updates of the profile don't race each other.
+    */
+    inline void RecordProfileSample(
+        const Detail::IMessage *const message,
+        const uint64_t ticks,
+        const uint64_t queueTicks);
+
+    /**
+    Copies the accumulated profile into the given snapshot.
+    */
+    inline bool GetProfile(ActorProfile &profile) const;
+
+#endif // THERON_ENABLE_PROFILING
+
+    Address mAddress;                                   ///< Unique address of this actor.
+    Framework *mFramework;                              ///< Pointer to the framework within which the actor runs.
+    Detail::HandlerCollection mMessageHandlers;         ///< The message handlers registered by this actor.
+    Detail::DefaultHandlerCollection mDefaultHandlers;  ///< Default message handlers registered by this actor.
+    Detail::IContinuation *mContinuations;              ///< List of continuations pending replies, oldest first.
+    Detail::Processor::Context *mProcessorContext;      ///< Remembers the context of the worker thread processing the actor.
+    uint64_t mCurrentFlowId;                            ///< Causality flow ID of the message currently being handled; zero if untraced.
+    bool mCurrentHighPriority;                          ///< Effective priority of the message currently being handled.
+    Detail::IMessage *mCurrentMessage;                  ///< The message currently being handled; zero outside of handlers.
+    bool mCurrentMessageStashed;                        ///< Whether the message currently being handled has been stashed.
+
+#if THERON_ENABLE_PROFILING
+    ActorProfile mProfile;                              ///< Accumulated per-message-type handler timing profile.
+#endif // THERON_ENABLE_PROFILING
+
+    mutable Detail::Atomic::UInt32 mRefCount;           ///< Reference count to support legacy ActorRef API.
+    void *mMemory;                                      ///< Pointer to memory block containing final actor type; null when co-located with the mailbox.
+};
+
+
+// TODO: Force-inline
+inline Address Actor::GetAddress() const
+{
+    return mAddress;
+}
+
+
+THERON_FORCEINLINE Framework &Actor::GetFramework() const
+{
+    return *mFramework;
+}
+
+
+THERON_FORCEINLINE void Actor::EnterBlockingSection() const
+{
+    // The manager thread compensates for parked workers when scaling the pool.
+    mFramework->mBlockedThreadCount.Increment();
+}
+
+
+THERON_FORCEINLINE void Actor::LeaveBlockingSection() const
+{
+    THERON_ASSERT(mFramework->mBlockedThreadCount.Load() > 0);
+    mFramework->mBlockedThreadCount.Decrement();
+}
+
+
+THERON_FORCEINLINE uint32_t Actor::GetNumQueuedMessages() const
+{
+    // Get a reference to the mailbox at which this actor is registered.
+    const Address address(GetAddress());
+    Framework &framework(GetFramework());
+    const Detail::Mailbox &mailbox(framework.mMailboxes.GetEntry(address.AsInteger()));
+
+    return mailbox.Count();
+}
+
+
+THERON_FORCEINLINE void Actor::SetQueueWatermarks(const uint32_t high, const uint32_t low)
+{
+    // Get a reference to the mailbox at which this actor is registered.
+    Detail::Mailbox &mailbox(mFramework->mMailboxes.GetEntry(mAddress.AsInteger()));
+    mailbox.SetWatermarks(high, low);
+}
+
+
+THERON_FORCEINLINE bool Actor::Stash()
+{
+    // Only meaningful from within a handler, while a message is being handled.
+    // The stash lists of the mailbox are only touched by the single worker
+    // thread currently processing the actor, so need no synchronization.
+    if (mProcessorContext == 0 || mCurrentMessage == 0)
+    {
+        return false;
+    }
+
+    // Repeated calls during the handling of one message stash it only once.
+    if (!mCurrentMessageStashed)
+    {
+        Detail::Mailbox &mailbox(mFramework->mMailboxes.GetEntry(mAddress.AsInteger()));
+        mailbox.Stash(mCurrentMessage);
+        mCurrentMessageStashed = true;
+    }
+
+    return true;
+}
+
+
+THERON_FORCEINLINE void Actor::UnstashAll()
+{
+    // Only meaningful from within a handler, for the same ownership reasons as Stash.
+    if (mProcessorContext == 0)
+    {
+        return;
+    }
+
+    Detail::Mailbox &mailbox(mFramework->mMailboxes.GetEntry(mAddress.AsInteger()));
+    mailbox.UnstashAll();
+}
+
+
+THERON_FORCEINLINE IAllocator *Actor::GetScratchAllocator() const
+{
+    // The processor context is only set while the actor is being processed by
+    // a worker thread, so outside of message handlers there is no arena to offer.
+    Detail::Processor::Context *const processorContext(mProcessorContext);
+    if (processorContext == 0)
+    {
+        return 0;
+    }
+
+    return &processorContext->mScratchAllocator;
+}
+
+
+template <class FunctorType>
+inline void Actor::ParallelFor(const uint32_t count, FunctorType &functor) const
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Calls from outside message handlers, and within frameworks with no
+    // other workers to borrow, execute the range inline on the calling thread.
+    Detail::Processor::Context *const processorContext(mProcessorContext);
+    const uint32_t workerCount(processorContext ? processorContext->mWorkerContextCount->Load() : 0);
+
+    if (processorContext == 0 || workerCount <= 1)
+    {
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            functor(index);
+        }
+
+        return;
+    }
+
+    // Split the range into a handful of chunks per worker, so faster workers
+    // claim more chunks and the tail of the range load-balances.
+    const uint32_t targetChunks(workerCount * 4);
+    const uint32_t chunkSize(count > targetChunks ? count / targetChunks : 1);
+
+    Detail::ParallelForTask<FunctorType> task(count, chunkSize, functor);
+
+    // Publish the task to the framework's shared slot, where worker threads
+    // with no mailbox work look for compute chunks before yielding. At most
+    // one task is active per framework at a time; contenders run inline.
+    void *expected(0);
+    Detail::Atomic::Pointer *const slot(processorContext->mSharedParallelTask);
+    if (!slot->CompareExchangeAcquire(expected, &task))
+    {
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            functor(index);
+        }
+
+        return;
+    }
+
+    // Claim and execute chunks alongside the workers, so the computation
+    // completes on this thread alone if every worker is busy.
+    task.ExecuteChunks();
+
+    // Wait for the chunks claimed by workers to finish executing.
+    uint32_t backoff(0);
+    while (!task.Complete())
+    {
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // Retire the task, then wait until no worker is still examining the slot,
+    // so the stack-owned task can safely go out of scope.
+    slot->Store(0);
+
+    Detail::Processor::Context **const workerContexts(processorContext->mWorkerContexts);
+    const uint32_t contextCount(processorContext->mWorkerContextCount->Load());
+
+    for (uint32_t index = 0; index < contextCount; ++index)
+    {
+        backoff = 0;
+        while (workerContexts[index]->mParallelBusy.Load() != 0)
+        {
+            Detail::Utils::Backoff(backoff);
+        }
+    }
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::RegisterHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(const ValueType &message, const Address from))
+{
+    // When an actor registers a handler for a message type, we get told about
+    // the type. So we take the opportunity to also register the type against
+    // its name with the network endpoint (if the framework is tied to one). This
+    // enables us to recognize the type when it arrives in a network message as a block
+    // blind of data tagged with a type name.
+    if (mFramework->mEndPoint)
+    {
+        mFramework->mEndPoint->RegisterMessageType<ValueType>();
+    }
+
+    return mMessageHandlers.Add(handler);
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::RegisterHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(ValueType &message, const Address from))
+{
+    // Register the message type against its name with the network endpoint
+    // (if the framework is tied to one), just as for const handlers.
+    if (mFramework->mEndPoint)
+    {
+        mFramework->mEndPoint->RegisterMessageType<ValueType>();
+    }
+
+    return mMessageHandlers.Add(handler);
+}
+
+
+template <class ValueType, class CallableType>
+inline bool Actor::RegisterHandler(const CallableType &callable)
+{
+    // Register the message type against its name with the network endpoint
+    // (if the framework is tied to one), just as for member function handlers.
+    if (mFramework->mEndPoint)
+    {
+        mFramework->mEndPoint->RegisterMessageType<ValueType>();
+    }
+
+    return mMessageHandlers.AddCallable<ValueType>(callable);
+}
+
+
+THERON_FORCEINLINE bool Actor::YieldIfOverBudget() const
+{
+    // The context pointer is only set while a worker thread is processing the
+    // actor; the deadline is only set while a budget is configured.
+    const Detail::Processor::Context *const processorContext(mProcessorContext);
+    if (processorContext == 0 || processorContext->mBudgetDeadline == 0)
+    {
+        return false;
+    }
+
+    return (Detail::ProfileClock::GetMicroseconds() > processorContext->mBudgetDeadline);
+}
+
+
+THERON_FORCEINLINE void Actor::RegisterHandlerTable(const HandlerTable &table)
+{
+    // Reference the shared snapshot table instead of building a private
+    // handler set. Message types handled through shared tables aren't
+    // registered with the network endpoint here; actors of networked
+    // frameworks register any remotely received types individually.
+    mMessageHandlers.Share(table.mCollection.GetTable());
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::DeregisterHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(const ValueType &message, const Address from))
+{
+    return mMessageHandlers.Remove(handler);
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::DeregisterHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(ValueType &message, const Address from))
+{
+    return mMessageHandlers.Remove(handler);
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::IsHandlerRegistered(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(const ValueType &message, const Address from))
+{
+    return mMessageHandlers.Contains(handler);
+}
+
+
+template <class ActorType, class ValueType>
+inline bool Actor::IsHandlerRegistered(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(ValueType &message, const Address from))
+{
+    return mMessageHandlers.Contains(handler);
+}
+
+
+template <class ActorType>
+inline bool Actor::SetDefaultHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(const Address from))
+{
+    return mDefaultHandlers.Set(handler);
+}
+
+
+template <class ActorType>
+inline bool Actor::SetDefaultHandler(
+    ActorType *const /*actor*/,
+    void (ActorType::*handler)(const void *const data, const uint32_t size, const Address from))
+{
+    return mDefaultHandlers.Set(handler);
+}
+
+
+#if THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::Send(ValueType &&value, const Address &address) const
+{
+    // The deduced type may be a reference or const-qualified; the message holds the plain value type.
+    // Arrays can't be sent as messages, and would otherwise silently decay to pointers here.
+    static_assert(!std::is_array<typename std::remove_reference<ValueType>::type>::value, "Arrays can't be sent as messages");
+    typedef typename std::decay<ValueType>::type MessageType;
+
+    // Try to use the processor context owned by a worker thread.
+    // The current thread will be a worker thread if this method has been called from a message
+    // handler. If it was called from an actor constructor or destructor then the current thread
+    // may be an application thread, in which case the stored context pointer will be null.
+    // If it is null we fall back to the per-framework context, which is shared between threads.
+    // The advantage of using a thread-specific context is that it is only accessed by that
+    // single thread so doesn't need to be thread-safe and isn't written by other threads
+    // so doesn't cause expensive cache coherency updates between cores.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    Detail::IMessage *message(0);
+
+#if THERON_MAILBOX_POOL_SLOTS
+    // Sends to actors flagged high-rate claim their blocks from the micro-pool
+    // embedded in the destination mailbox, when the message fits a slot.
+    void *const pooledBlock(mFramework->ClaimPooledBlock(
+        address,
+        Detail::Message<MessageType>::GetSize(),
+        Detail::Message<MessageType>::GetAlignment()));
+
+    if (pooledBlock)
+    {
+        message = Detail::Message<MessageType>::InitializePooled(pooledBlock, std::forward<ValueType>(value), mAddress);
+    }
+    else
+#endif // THERON_MAILBOX_POOL_SLOTS
+    {
+        // Allocate a message. It'll be deleted by the worker thread that handles it.
+        // The value is forwarded into the message, so is moved rather than copied if it's an rvalue.
+        message = Detail::MessageCreator::Create<MessageType, ValueType>(
+            &processorContext->mMessageCache,
+            std::forward<ValueType>(value),
+            mAddress);
+    }
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Call the message sending implementation using the acquired processor context.
+        // When the sending thread is a worker the receiving mailbox is scheduled on
+        // the worker's own stealable local queue, keeping producer-consumer chains
+        // core-resident; in the shared per-framework context, which has no local
+        // queue, the hint has no effect.
+        return Detail::MessageSender::Send(
+            mFramework->mEndPoint,
+            processorContext,
+            mFramework->GetIndex(),
+            message,
+            address,
+            true);
+    }
+
+    return false;
+}
+
+#else // THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::Send(const ValueType &value, const Address &address) const
+{
+    // Try to use the processor context owned by a worker thread.
+    // The current thread will be a worker thread if this method has been called from a message
+    // handler. If it was called from an actor constructor or destructor then the current thread
+    // may be an application thread, in which case the stored context pointer will be null.
+    // If it is null we fall back to the per-framework context, which is shared between threads.
+    // The advantage of using a thread-specific context is that it is only accessed by that
+    // single thread so doesn't need to be thread-safe and isn't written by other threads
+    // so doesn't cause expensive cache coherency updates between cores.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    Detail::IMessage *message(0);
+
+#if THERON_MAILBOX_POOL_SLOTS
+    // Sends to actors flagged high-rate claim their blocks from the micro-pool
+    // embedded in the destination mailbox, when the message fits a slot.
+    void *const pooledBlock(mFramework->ClaimPooledBlock(
+        address,
+        Detail::Message<ValueType>::GetSize(),
+        Detail::Message<ValueType>::GetAlignment()));
+
+    if (pooledBlock)
+    {
+        message = Detail::Message<ValueType>::InitializePooled(pooledBlock, value, mAddress);
+    }
+    else
+#endif // THERON_MAILBOX_POOL_SLOTS
+    {
+        // Allocate a message. It'll be deleted by the worker thread that handles it.
+        message = Detail::MessageCreator::Create(
+            &processorContext->mMessageCache,
+            value,
+            mAddress);
+    }
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Call the message sending implementation using the acquired processor context.
+        // When the sending thread is a worker the receiving mailbox is scheduled on
+        // the worker's own stealable local queue, keeping producer-consumer chains
+        // core-resident; in the shared per-framework context, which has no local
+        // queue, the hint has no effect.
+        return Detail::MessageSender::Send(
+            mFramework->mEndPoint,
+            processorContext,
+            mFramework->GetIndex(),
+            message,
+            address,
+            true);
+    }
+
+    return false;
+}
+
+#endif // THERON_CPP11
+
+
+#if THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::Send(ValueType &&value, const MailboxHandle &handle) const
+{
+    // The deduced type may be a reference or const-qualified; the message holds the plain value type.
+    // Arrays can't be sent as messages, and would otherwise silently decay to pointers here.
+    static_assert(!std::is_array<typename std::remove_reference<ValueType>::type>::value, "Arrays can't be sent as messages");
+    typedef typename std::decay<ValueType>::type MessageType;
+
+    if (!handle.IsValid())
+    {
+        return false;
+    }
+
+    // Try to use the processor context owned by a worker thread, as in Send.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    // The value is forwarded into the message, so is moved rather than copied if it's an rvalue.
+    Detail::IMessage *const message(Detail::MessageCreator::Create<MessageType, ValueType>(
+        &processorContext->mMessageCache,
+        std::forward<ValueType>(value),
+        mAddress));
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Push directly into the pinned mailbox, with no per-send resolution
+        // of the destination address through the directory.
+        return Detail::MessageSender::SendToMailbox(
+            processorContext,
+            handle.mMailbox,
+            handle.mAddress,
+            message,
+            true);
+    }
+
+    return false;
+}
+
+#else // THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::Send(const ValueType &value, const MailboxHandle &handle) const
+{
+    if (!handle.IsValid())
+    {
+        return false;
+    }
+
+    // Try to use the processor context owned by a worker thread, as in Send.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(
+        &processorContext->mMessageCache,
+        value,
+        mAddress));
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Push directly into the pinned mailbox, with no per-send resolution
+        // of the destination address through the directory.
+        return Detail::MessageSender::SendToMailbox(
+            processorContext,
+            handle.mMailbox,
+            handle.mAddress,
+            message,
+            true);
+    }
+
+    return false;
+}
+
+#endif // THERON_CPP11
+
+
+#if THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::TailSend(ValueType &&value, const Address &address) const
+{
+    // The deduced type may be a reference or const-qualified; the message holds the plain value type.
+    // Arrays can't be sent as messages, and would otherwise silently decay to pointers here.
+    static_assert(!std::is_array<typename std::remove_reference<ValueType>::type>::value, "Arrays can't be sent as messages");
+    typedef typename std::decay<ValueType>::type MessageType;
+
+    // Try to use the processor context owned by a worker thread.
+    // The current thread will be a worker thread if this method has been called from a message
+    // handler. If it was called from an actor constructor or destructor then the current thread
+    // may be an application thread, in which case the stored context pointer will be null.
+    // If it is null we fall back to the per-framework context, which is shared between threads.
+    // The advantage of using a thread-specific context is that it is only accessed by that
+    // single thread so doesn't need to be thread-safe and isn't written by other threads
+    // so doesn't cause expensive cache coherency updates between cores.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    // The value is forwarded into the message, so is moved rather than copied if it's an rvalue.
+    Detail::IMessage *const message(Detail::MessageCreator::Create<MessageType, ValueType>(
+        &processorContext->mMessageCache,
+        std::forward<ValueType>(value),
+        mAddress));
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Call the message sending implementation using the acquired processor context.
+        // The tail call hint allows the receiving actor, if any, to be processed inline
+        // on the current worker thread, or else scheduled on its local queue.
+        return Detail::MessageSender::Send(
+            mFramework->mEndPoint,
+            processorContext,
+            mFramework->GetIndex(),
+            message,
+            address,
+            true,
+            true);
+    }
+
+    return false;
+}
+
+#else // THERON_CPP11
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::TailSend(const ValueType &value, const Address &address) const
+{
+    // Try to use the processor context owned by a worker thread.
+    // The current thread will be a worker thread if this method has been called from a message
+    // handler. If it was called from an actor constructor or destructor then the current thread
+    // may be an application thread, in which case the stored context pointer will be null.
+    // If it is null we fall back to the per-framework context, which is shared between threads.
+    // The advantage of using a thread-specific context is that it is only accessed by that
+    // single thread so doesn't need to be thread-safe and isn't written by other threads
+    // so doesn't cause expensive cache coherency updates between cores.
+    Detail::Processor::Context *processorContext(mProcessorContext);
+    if (mProcessorContext == 0)
+    {
+        processorContext = &mFramework->mProcessorContext;
+    }
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(
+        &processorContext->mMessageCache,
+        value,
+        mAddress));
+
+    if (message)
+    {
+        // Sends from within message handlers inherit the causality flow of the
+        // message being handled, and its effective priority; sends from
+        // constructors, destructors and other non-handler code start new
+        // flows, subject to sampling, at normal priority.
+        message->SetFlowId(mProcessorContext ? mCurrentFlowId : mFramework->SampleFlowId());
+        message->SetHighPriority(mProcessorContext ? mCurrentHighPriority : false);
+
+        // Call the message sending implementation using the acquired processor context.
+        // The tail call hint allows the receiving actor, if any, to be processed inline
+        // on the current worker thread, or else scheduled on its local queue.
+        return Detail::MessageSender::Send(
+            mFramework->mEndPoint,
+            processorContext,
+            mFramework->GetIndex(),
+            message,
+            address,
+            true,
+            true);
+    }
+
+    return false;
+}
+
+#endif // THERON_CPP11
+
+
+template <typename ValueType, class ActorType, typename ReplyType>
+THERON_FORCEINLINE bool Actor::SendWithContinuation(
+    const ValueType &value,
+    const Address &address,
+    void (ActorType::*continuation)(const ReplyType &message, const Address from))
+{
+    typedef Detail::MessageContinuation<ActorType, ReplyType> ContinuationType;
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    void *const memory(allocator->Allocate(sizeof(ContinuationType)));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    ContinuationType *const pending(new (memory) ContinuationType(continuation, address));
+
+    // Append to the tail of the pending list, which is kept in registration
+    // order so that replies to identical requests consume their continuations
+    // oldest-first. The list is only accessed by the single thread currently
+    // executing the actor, so needs no synchronization.
+    Detail::IContinuation *tail(mContinuations);
+    if (tail == 0)
+    {
+        mContinuations = pending;
+    }
+    else
+    {
+        while (tail->GetNext())
+        {
+            tail = tail->GetNext();
+        }
+
+        tail->SetNext(pending);
+    }
+
+    // Send the request only once the continuation is registered, so a reply
+    // processed inline on another worker before we return can't miss it.
+    if (!Send(value, address))
+    {
+        // The request wasn't delivered, so no reply will ever arrive.
+        if (mContinuations == pending)
+        {
+            mContinuations = 0;
+        }
+        else
+        {
+            tail->SetNext(0);
+        }
+
+        pending->~ContinuationType();
+        allocator->Free(memory, sizeof(ContinuationType));
+
+        return false;
+    }
+
+    return true;
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE bool Actor::Push(const ValueType &value, const Address &from)
+{
+    // This method isn't typically called a message handler of this actor, so
+    // we need to use the processor context associated with the owning framework.
+    Detail::Processor::Context *const processorContext(&mFramework->mProcessorContext);
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(
+        &processorContext->mMessageCache,
+        value,
+        from));
+
+    if (message)
+    {
+        // Send the message to the actor's own address.
+        return Detail::MessageSender::Send(
+            mFramework->mEndPoint,
+            processorContext,
+            mFramework->GetIndex(),
+            message,
+            GetAddress());
+    }
+
+    return false;
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE uint32_t Actor::Push(const ValueType *const values, const uint32_t count, const Address &from)
+{
+    // Pointers are valid iterators, so the array burst is just a range burst.
+    return Push(values, values + count, from);
+}
+
+
+template <class IteratorType>
+inline uint32_t Actor::Push(const IteratorType &begin, const IteratorType &end, const Address &from)
+{
+    // This method isn't typically called from a message handler of this actor, so
+    // we need to use the processor context associated with the owning framework.
+    Detail::Processor::Context *const processorContext(&mFramework->mProcessorContext);
+
+    // Push directly into our own mailbox, bypassing the per-message addressing
+    // of the general send path; the whole burst needs at most one scheduling
+    // event, since the mailbox stays scheduled while it holds messages.
+    Detail::Mailbox &mailbox(mFramework->mMailboxes.GetEntry(mAddress.AsInteger()));
+
+    uint32_t numPushed(0);
+
+    for (IteratorType current(begin); current != end; ++current)
+    {
+        // Respect the bounded capacity of the mailbox, if one is configured.
+        if (mailbox.Full())
+        {
+            break;
+        }
+
+        // Allocate a message. It'll be deleted by the worker thread that handles it.
+        Detail::IMessage *const message(Detail::MessageCreator::Create(
+            &processorContext->mMessageCache,
+            *current,
+            from));
+
+        if (message == 0)
+        {
+            break;
+        }
+
+        // The push is lock-free, and only a push into an empty mailbox makes
+        // us responsible for scheduling it, so a burst into a busy mailbox
+        // doesn't schedule it at all and a burst into an idle one schedules
+        // it once, for the first message.
+        if (mailbox.Push(message))
+        {
+            Detail::Processor::Schedule(processorContext, &mailbox, false);
+        }
+
+        ++numPushed;
+    }
+
+    // If the burst took the queue depth up through the high watermark then
+    // deliver a single watermark event, as the general send path would.
+    if (mailbox.RoseAboveWatermark())
+    {
+        QueueWatermarkEvent event;
+        event.mDepth = mailbox.Count();
+        event.mHigh = true;
+
+        Detail::IMessage *const eventMessage(Detail::MessageCreator::Create(
+            &processorContext->mMessageCache,
+            event,
+            mAddress));
+
+        if (eventMessage && mailbox.Push(eventMessage))
+        {
+            Detail::Processor::Schedule(processorContext, &mailbox, false);
+        }
+    }
+
+    return numPushed;
+}
+
+
+THERON_FORCEINLINE void Actor::Reference() const
+{
+    mRefCount.Increment();
+}
+
+
+THERON_FORCEINLINE bool Actor::Dereference() const
+{
+    uint32_t currentValue(mRefCount.Load());
+    uint32_t newValue(currentValue - 1);
+    uint32_t backoff(0);
+
+    THERON_ASSERT(currentValue > 0);
+
+    // Repeatedly try to atomically decrement the reference count.
+    // We do this by hand so we can atomically find out the new value.
+    while (!mRefCount.CompareExchangeAcquire(currentValue, newValue))
+    {
+        currentValue = mRefCount.Load();
+        newValue = currentValue - 1;
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // Return true if the new reference count is zero.
+    return (newValue == 0);
+}
+
+
+THERON_FORCEINLINE void Actor::ProcessMessage(
+    Detail::FallbackHandlerCollection *const fallbackHandlers,
+    Detail::IMessage *const message)
+{
+#if THERON_ENABLE_PROFILING
+    const uint64_t startTicks(Detail::ProfileClock::GetTicks());
+#endif // THERON_ENABLE_PROFILING
+
+    // Remember the causality flow of the message for the duration of its
+    // handlers, so that messages they send inherit it automatically, and the
+    // message itself so that its handlers can stash it.
+    mCurrentFlowId = message->GetFlowId();
+    mCurrentMessage = message;
+    mCurrentMessageStashed = false;
+
+    // The effective priority of the message is its own inherited priority, or
+    // the static priority of this actor's mailbox; sends made by the handlers
+    // inherit it, so prioritized chains stay expedited as they fan out.
+    mCurrentHighPriority = message->HasHighPriority() ||
+        mFramework->mMailboxes.GetEntry(mAddress.AsInteger()).HasHighPriority();
+
+    // Pending continuations intercept their matching replies ahead of the
+    // registered handlers; with none pending the check is a single pointer test.
+    if (mContinuations != 0 && HandleContinuation(message))
+    {
+    }
+    else if (!DispatchMessage(message))
+    {
+        // If no registered handler handled the message, execute the default handlers instead.
+        // This call is intentionally not inlined to avoid polluting the generated code with the uncommon case.
+        Fallback(fallbackHandlers, message);
+    }
+
+#if THERON_ENABLE_PROFILING
+    // The delay the message spent queued is the time from its enqueue stamp
+    // to the start of its handling, attributed to the sender that queued it.
+    const uint64_t enqueueTicks(message->GetEnqueueTicks());
+    const uint64_t queueTicks(startTicks > enqueueTicks ? startTicks - enqueueTicks : 0);
+    RecordProfileSample(message, Detail::ProfileClock::GetTicks() - startTicks, queueTicks);
+#endif // THERON_ENABLE_PROFILING
+
+    // The message is owned by the processing loop again once its handlers return.
+    mCurrentMessage = 0;
+}
+
+
+THERON_FORCEINLINE bool Actor::DispatchMessage(const Detail::IMessage *const message)
+{
+    return mMessageHandlers.Handle(this, message);
+}
+
+
+#if THERON_ENABLE_PROFILING
+
+inline void Actor::RecordProfileSample(
+    const Detail::IMessage *const message,
+    const uint64_t ticks,
+    const uint64_t queueTicks)
+{
+    // Attribute the message's arrival, and the delay it spent queued, to its
+    // sender, so a producer overwhelming this actor's mailbox can be
+    // identified by query. Senders are matched by address.
+    const uint32_t senderAddress(message->From().AsInteger());
+
+    ActorProfile::SenderProfile *sender(0);
+    for (uint32_t index = 0; index < mProfile.mSenderCount; ++index)
+    {
+        if (mProfile.mSenders[index].mSenderAddress == senderAddress)
+        {
+            sender = &mProfile.mSenders[index];
+            break;
+        }
+    }
+
+    if (sender == 0 && mProfile.mSenderCount < ActorProfile::MAX_SENDERS)
+    {
+        // The sender table is bounded; samples from further senders are dropped.
+        sender = &mProfile.mSenders[mProfile.mSenderCount++];
+        sender->mSenderAddress = senderAddress;
+    }
+
+    if (sender)
+    {
+        ++sender->mMessageCount;
+        sender->mTotalQueueTicks += queueTicks;
+        sender->mMaxQueueTicks = (queueTicks > sender->mMaxQueueTicks) ? queueTicks : sender->mMaxQueueTicks;
+    }
+
+    const char *const typeName(message->TypeName());
+    const uint32_t messageSize(message->GetMessageSize());
+
+    // Find the profile entry for this message type. Types are matched by
+    // registered name where one is available, and by message size otherwise.
+    ActorProfile::MessageTypeProfile *entry(0);
+    for (uint32_t index = 0; index < mProfile.mTypeCount; ++index)
+    {
+        ActorProfile::MessageTypeProfile &candidate(mProfile.mTypes[index]);
+
+        if (typeName && candidate.mTypeName)
+        {
+            // Compare the string contents, since the same type can be registered
+            // with differing name addresses in different translation units.
+            if (typeName == candidate.mTypeName || strcmp(typeName, candidate.mTypeName) == 0)
+            {
+                entry = &candidate;
+                break;
+            }
+        }
+        else if (typeName == 0 && candidate.mTypeName == 0 && candidate.mMessageSize == messageSize)
+        {
+            entry = &candidate;
+            break;
+        }
+    }
+
+    if (entry == 0)
+    {
+        // The entry table is bounded; samples of further message types are dropped.
+        if (mProfile.mTypeCount == ActorProfile::MAX_MESSAGE_TYPES)
+        {
+            return;
+        }
+
+        entry = &mProfile.mTypes[mProfile.mTypeCount++];
+        entry->mTypeName = typeName;
+        entry->mMessageSize = messageSize;
+    }
+
+    // The bucket index is the binary logarithm of the tick count, clamped to the last bucket.
+    uint32_t bucket(0);
+    uint64_t value(ticks);
+    while (value > 1 && bucket + 1 < ActorProfile::BUCKET_COUNT)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+
+    ++entry->mMessageCount;
+    entry->mTotalTicks += ticks;
+    entry->mMaxTicks = (ticks > entry->mMaxTicks) ? ticks : entry->mMaxTicks;
+    ++entry->mBuckets[bucket];
+}
+
+
+THERON_FORCEINLINE bool Actor::GetProfile(ActorProfile &profile) const
+{
+    profile = mProfile;
+    return true;
+}
+
+#endif // THERON_ENABLE_PROFILING
+
+
+template <class ValueType>
+THERON_FORCEINLINE void Actor::RegisterMessageType() const
+{
+    if (mFramework->mEndPoint)
+    {
+        mFramework->mEndPoint->RegisterMessageType<ValueType>();
+    }
+}
+
+
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_ACTOR_H
@@ -0,0 +1,47 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ACTORCREATEDEVENT_H
+#define THERON_ACTORCREATEDEVENT_H
+
+
+/**
+\file ActorCreatedEvent.h
+Completion message delivered for asynchronous actor construction.
+*/
+
+
+#include <Theron/Address.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+/**
+\brief Completion message for \ref Framework::CreateActorAsync.
+
+Sent to the client address passed to
+\ref Framework::CreateActorAsync "CreateActorAsync" once the requested actor
+has been constructed on a worker thread. Handle it by registering a message
+handler for the type, like any other message. The receiver owns the
+constructed actor and is responsible for eventually destroying it.
+
+\note If the construction failed, the actor pointer is zero and the address
+is null.
+
+\see Framework::CreateActorAsync
+*/
+struct ActorCreatedEvent
+{
+    Actor *mActor;          ///< Pointer to the constructed actor, owned by the receiver; zero on failure.
+    Address mAddress;       ///< Address of the constructed actor; null on failure.
+    void *mContext;         ///< User context pointer passed to CreateActorAsync, for correlating requests.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_ACTORCREATEDEVENT_H
@@ -0,0 +1,115 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ACTORPROFILE_H
+#define THERON_ACTORPROFILE_H
+
+
+/**
+\file ActorProfile.h
+Per-actor profile of message handler execution times.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Per-actor profile of message handler execution times.
+
+When profiling is enabled with \ref THERON_ENABLE_PROFILING, every message
+processed by an actor is timed, and the measured handler execution time is
+accumulated into a per-message-type entry of the actor's profile. A snapshot
+of the accumulated profile can be queried with \ref Framework::GetActorProfile
+"Framework::GetActorProfile", allowing hot actors, and the hot message types
+within them, to be located without external tooling.
+
+Execution times are measured in platform-dependent clock ticks, so are
+meaningful only relative to other measurements from the same run. Each entry
+holds the sample count, the total and maximum measured times, and a histogram
+of the samples in power-of-two tick buckets: a sample of \em n ticks is
+counted in the bucket whose index is the binary logarithm of \em n, with the
+final bucket collecting all larger samples.
+
+\note Message types are distinguished by registered type name where one is
+available, and by message value size otherwise, so unnamed message types of
+equal size share an entry.
+
+Alongside the per-message-type entries, the profile accumulates a per-sender
+table attributing arrivals to the addresses that sent them. Each entry counts
+the messages received from one sender, and the total and maximum delay its
+messages spent queued in the mailbox before being processed, so the producer
+responsible for a consumer's queueing delay can be identified by query rather
+than by bisection.
+
+\see Framework::GetActorProfile
+*/
+struct ActorProfile
+{
+    static const uint32_t MAX_MESSAGE_TYPES = 16;   ///< Maximum number of per-message-type entries profiled per actor.
+    static const uint32_t MAX_SENDERS = 16;         ///< Maximum number of per-sender entries profiled per actor.
+    static const uint32_t BUCKET_COUNT = 32;        ///< Number of power-of-two histogram buckets per entry.
+
+    /**
+    \brief Profile of the handler executions for a single message type.
+    */
+    struct MessageTypeProfile
+    {
+        inline MessageTypeProfile() :
+          mTypeName(0),
+          mMessageSize(0),
+          mMessageCount(0),
+          mTotalTicks(0),
+          mMaxTicks(0)
+        {
+            for (uint32_t bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+            {
+                mBuckets[bucket] = 0;
+            }
+        }
+
+        const char *mTypeName;              ///< Registered name of the message type; zero for unnamed types.
+        uint32_t mMessageSize;              ///< Size in bytes of the message value; distinguishes unnamed types.
+        uint32_t mMessageCount;             ///< Number of messages of this type processed.
+        uint64_t mTotalTicks;               ///< Total ticks spent executing handlers for messages of this type.
+        uint64_t mMaxTicks;                 ///< Highest tick count measured for a single message of this type.
+        uint32_t mBuckets[BUCKET_COUNT];    ///< Histogram of the samples in power-of-two tick buckets.
+    };
+
+    /**
+    \brief Profile of the message arrivals from a single sender.
+    */
+    struct SenderProfile
+    {
+        inline SenderProfile() :
+          mSenderAddress(0),
+          mMessageCount(0),
+          mTotalQueueTicks(0),
+          mMaxQueueTicks(0)
+        {
+        }
+
+        uint32_t mSenderAddress;            ///< Integer value of the sender's address; see \ref Address::AsInteger.
+        uint32_t mMessageCount;             ///< Number of messages received from this sender.
+        uint64_t mTotalQueueTicks;          ///< Total ticks messages from this sender spent queued before processing.
+        uint64_t mMaxQueueTicks;            ///< Highest queued tick count measured for a single message from this sender.
+    };
+
+    inline ActorProfile() : mTypeCount(0), mSenderCount(0)
+    {
+    }
+
+    uint32_t mTypeCount;                            ///< Number of valid entries in the type array.
+    uint32_t mSenderCount;                          ///< Number of valid entries in the sender array.
+    MessageTypeProfile mTypes[MAX_MESSAGE_TYPES];   ///< Per-message-type profile entries.
+    SenderProfile mSenders[MAX_SENDERS];            ///< Per-sender profile entries.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_ACTORPROFILE_H
@@ -19,11 +19,15 @@ Legacy support for actor references, which were deprecated in version 4.0.
 #include <Theron/Detail/MailboxProcessor/Processor.h>
 
 
+#if !THERON_NO_LEGACY
+
+
 namespace Theron
 {
 
 
 class Actor;
+class ActorRefView;
 class Framework;
 
 
@@ -100,6 +104,7 @@ class ActorRef
 
 public:
 
+    friend class ActorRefView;
     friend class Framework;
 
     /**
@@ -138,6 +143,30 @@ public:
     */
     inline ActorRef &operator=(const ActorRef &other);
 
+#if THERON_CPP11
+
+    /**
+    \brief Move constructor.
+
+    Transfers the reference held by the other ActorRef to the constructed one,
+    leaving the other null. Because the reference is transferred rather than
+    shared, the actor's reference count is not touched, so returning and
+    passing ActorRef values doesn't drive interlocked operations.
+    */
+    inline ActorRef(ActorRef &&other);
+
+    /**
+    \brief Move assignment operator.
+
+    Transfers the reference held by the other ActorRef to this one, leaving
+    the other null. The actor previously referenced by this ActorRef, if any,
+    is no longer referenced, and will be garbage collected if it has become
+    completely unreferenced.
+    */
+    inline ActorRef &operator=(ActorRef &&other);
+
+#endif // THERON_CPP11
+
     /**
     \brief Destructor.
 
@@ -230,6 +259,130 @@ private:
 };
 
 
+/**
+\brief A borrowed, non-owning view of an actor referenced by an \ref ActorRef.
+
+Copying an ActorRef drives an interlocked increment and decrement of the
+referenced actor's reference count, so passing references by value down a
+deep call chain pays a pair of atomic operations per level. An ActorRefView
+borrows the reference held by an existing ActorRef without sharing ownership:
+copying a view copies a plain pointer and never touches the reference count.
+
+A view is valid only as long as some ActorRef keeps the actor referenced, in
+the same way that a raw pointer into a container is valid only as long as the
+container owns the element. Use views for the pass-through layers of a call
+chain, and \ref Ref to take shared ownership at the point where the reference
+needs to outlive the borrow:
+
+\code
+// LEGACY CODE!
+void LogActor(const Theron::ActorRefView view);      // Borrows; no refcounting.
+
+Theron::ActorRef actorRef(framework.CreateActor<MyActor>());
+LogActor(actorRef);                                  // Implicit borrow.
+\endcode
+*/
+class ActorRefView
+{
+
+public:
+
+    friend class Framework;
+
+    /**
+    \brief Static method that returns a null actor view.
+    */
+    inline static ActorRefView Null()
+    {
+        return ActorRefView();
+    }
+
+    /**
+    \brief Default constructor. Constructs a null view, referencing no actor.
+    */
+    inline ActorRefView() : mActor(0)
+    {
+    }
+
+    /**
+    \brief Constructor. Borrows the reference held by the given ActorRef.
+
+    The conversion is implicit, so an ActorRef can be passed directly to
+    functions taking a view. The view doesn't own a reference of its own: the
+    borrowed ActorRef, or another referencing the same actor, must outlive it.
+    */
+    inline ActorRefView(const ActorRef &ref) : mActor(ref.mActor)
+    {
+    }
+
+    /**
+    \brief Equality operator.
+
+    Returns true if the given view references the same actor as this one
+    does, or if both are null.
+    */
+    inline bool operator==(const ActorRefView &other) const
+    {
+        return (mActor == other.mActor);
+    }
+
+    /**
+    \brief Inequality operator.
+
+    Returns true if the given view references a different actor from the one
+    referenced by this view, or if one is null and the other is not.
+    */
+    inline bool operator!=(const ActorRefView &other) const
+    {
+        return (mActor != other.mActor);
+    }
+
+    /**
+    \brief Takes shared ownership of the viewed actor.
+
+    \return An \ref ActorRef referencing the viewed actor.
+
+    Constructing the owning reference increments the actor's reference count;
+    this is the one point in a borrowed call chain that pays for ownership.
+    */
+    inline ActorRef Ref() const
+    {
+        return ActorRef(mActor);
+    }
+
+    /**
+    \brief Returns the unique address of the viewed actor.
+
+    \return The unique address of the actor.
+    */
+    Address GetAddress() const;
+
+    /**
+    \brief Pushes a message into the viewed actor.
+
+    Identical to \ref ActorRef::Push, without the cost of owning a reference
+    at the call site.
+
+    \tparam ValueType The message type (any copyable class or Plain Old Datatype).
+    \return True, if the actor accepted the message.
+    */
+    template <class ValueType>
+    inline bool Push(const ValueType &value, const Address &from);
+
+    /**
+    \brief Gets the number of messages queued at the viewed actor.
+    */
+    uint32_t GetNumQueuedMessages() const;
+
+private:
+
+    Detail::Processor::Context &GetProcessorContext();
+    uint32_t GetFrameworkIndex() const;
+
+    Actor *mActor;      ///< Pointer to the viewed actor.
+};
+
+
 THERON_FORCEINLINE ActorRef::ActorRef() : mActor(0)
 {
 }
@@ -252,11 +405,34 @@ THERON_FORCEINLINE ActorRef &ActorRef::operator=(const ActorRef &other)
     Dereference();
     mActor = other.mActor;
     Reference();
-    
+
     return *this;
 }
 
 
+#if THERON_CPP11
+
+THERON_FORCEINLINE ActorRef::ActorRef(ActorRef &&other) : mActor(other.mActor)
+{
+    other.mActor = 0;
+}
+
+
+THERON_FORCEINLINE ActorRef &ActorRef::operator=(ActorRef &&other)
+{
+    if (this != &other)
+    {
+        Dereference();
+        mActor = other.mActor;
+        other.mActor = 0;
+    }
+
+    return *this;
+}
+
+#endif // THERON_CPP11
+
+
 THERON_FORCEINLINE ActorRef::~ActorRef()
 {
     Dereference();
@@ -303,7 +479,38 @@ THERON_FORCEINLINE bool ActorRef::Push(const ValueType &value, const Address &fr
 }
 
 
+template <class ValueType>
+THERON_FORCEINLINE bool ActorRefView::Push(const ValueType &value, const Address &from)
+{
+    // Use the per-framework context, which is shared between threads.
+    Detail::Processor::Context &processorContext(GetProcessorContext());
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(
+        &processorContext.mMessageCache,
+        value,
+        from));
+
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Call the message sending implementation using the acquired processor context.
+    // Send the message to the actor via the usual path instead of trying to be sneaky.
+    return Detail::MessageSender::Send(
+        0,
+        &processorContext,
+        GetFrameworkIndex(),
+        message,
+        GetAddress());
+}
+
+
 } // namespace Theron
 
 
+#endif // !THERON_NO_LEGACY
+
+
 #endif // THERON_ACTORREF_H
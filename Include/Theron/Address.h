@@ -22,6 +22,7 @@ namespace Theron
 
 namespace Detail
 {
+class IMessage;
 class MessageSender;
 }
 
@@ -62,6 +63,7 @@ class Address
 {
 public:
 
+    friend class Detail::IMessage;
     friend class Detail::MessageSender;
     friend class EndPoint;
     friend class Framework;
@@ -198,10 +200,18 @@ public:
     /**
     \brief Gets the value of the address as a string.
 
-    Actor and receiver mailboxes have string names, which by default are randomly
-    generated. The name of each mailbox should be globally unique across all connected
-    processes, and allows the mailbox to be sent messages by actors which don't
-    know its physical location.
+    Actor and receiver mailboxes can have string names. The name of each mailbox
+    should be globally unique across all connected processes, and allows the mailbox
+    to be sent messages by actors which don't know its physical location. Names are
+    generated automatically for unnamed actors in frameworks tied to a network
+    \ref EndPoint. Unnamed actors in purely local frameworks are anonymous, and for
+    them this method returns a null pointer: they are identified by index alone
+    and can't be addressed by name, which makes their construction cheaper.
+
+    Addresses of local entities are carried and copied as plain indices on the
+    local fast path, without their names, so copying them costs nothing. The
+    name is looked up lazily from the addressed entity when it is actually
+    queried -- here, or when a message crosses a network \ref EndPoint.
 
     \code
     class Actor : public Theron::Actor
@@ -216,10 +226,24 @@ public:
 
     printf("Actor has address %s\n", actor.GetAddress().AsString());
     \endcode
+
+    \note The returned pointer remains valid while the addressed entity
+    remains registered.
     */
     THERON_FORCEINLINE const char *AsString() const
     {
-        return mName.GetValue();
+        // Most addresses either carry their name or have none to resolve.
+        if (!mName.IsNull())
+        {
+            return mName.GetValue();
+        }
+
+        if (mIndex.mUInt32 == 0)
+        {
+            return 0;
+        }
+
+        return ResolveName();
     }
 
     /**
@@ -292,6 +316,21 @@ public:
     */
     THERON_FORCEINLINE bool operator==(const Address &other) const
     {
+        // Local entities are identified by their framework and mailbox
+        // indices, which uniquely identify them within the process whether or
+        // not a name is carried. Index zero is reserved for the null address,
+        // so no local entity ever equals Address::Null. Names only decide
+        // when one of the addresses is known by name alone.
+        if (mIndex.mUInt32 != 0 && other.mIndex.mUInt32 != 0)
+        {
+            return (mIndex.mUInt32 == other.mIndex.mUInt32);
+        }
+
+        if (mName.IsNull() && other.mName.IsNull())
+        {
+            return (mIndex.mUInt32 == other.mIndex.mUInt32);
+        }
+
         return (mName == other.mName);
     }
 
@@ -332,6 +371,19 @@ public:
     */
     THERON_FORCEINLINE bool operator<(const Address &other) const
     {
+        // Addresses of local entities order by index, and null-name addresses
+        // by index too, mirroring the equality comparison; only addresses
+        // known by name alone order by name.
+        if (mIndex.mUInt32 != 0 && other.mIndex.mUInt32 != 0)
+        {
+            return (mIndex.mUInt32 < other.mIndex.mUInt32);
+        }
+
+        if (mName.IsNull() && other.mName.IsNull())
+        {
+            return (mIndex.mUInt32 < other.mIndex.mUInt32);
+        }
+
         return (mName < other.mName);
     }
 
@@ -351,6 +403,14 @@ private:
         return mName;
     }
 
+    /**
+    Looks up the name of the addressed entity from its registration, for
+    addresses carried as plain indices on the local fast path.
+    Non-inlined; the lookup is only paid when a name is actually queried.
+    \return The name of the addressed entity, or zero if it is anonymous.
+    */
+    const char *ResolveName() const;
+
     Detail::String mName;               ///< The string name of the addressed entity.
     Detail::Index mIndex;               ///< Cached local framework and index.
 };
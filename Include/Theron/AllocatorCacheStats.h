@@ -0,0 +1,95 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ALLOCATORCACHESTATS_H
+#define THERON_ALLOCATORCACHESTATS_H
+
+
+/**
+\file AllocatorCacheStats.h
+Occupancy, hit rate and fallback statistics of the internal allocator caches.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Occupancy, hit rate and fallback statistics of the message block caches.
+
+Filled in by \ref Framework::GetAllocatorCacheStats "Framework::GetAllocatorCacheStats",
+which aggregates the shared per-framework message cache and the per-thread caches
+of the worker threads into one report. The caches are size-binned: small
+allocations share a stack of uniform slots, reported in the slot fields, while
+larger allocations are cached in per-size bins, reported in the per-bin entries.
+
+Counts are cumulative since the framework was constructed, so hit rates and
+fallback rates can be derived by querying periodically and differencing.
+Memory held by the caches rather than returned to the lower-level allocator --
+the fragmentation cost of the caching -- can be derived as the cached slot
+count times the slot size, plus the sum over bins of the cached block count
+times the bin's block size.
+
+\see Framework::GetAllocatorCacheStats
+*/
+struct AllocatorCacheStats
+{
+    /**
+    Number of size bins reported. Bins cache blocks at four-byte size
+    granularity upwards from the cache line size, so the bound covers the
+    cacheable size range; each aggregated cache contributes to the same bins.
+    */
+    static const uint32_t MAX_POOLS = 32;
+
+    /**
+    Statistics of the cache bins serving a single block size.
+    */
+    struct PoolStats
+    {
+        uint32_t mBlockSize;        ///< Size in bytes of the blocks cached by the bin.
+        uint32_t mCachedBlocks;     ///< Number of free blocks currently cached in the bin.
+        uint32_t mMaxBlocks;        ///< Configured depth of the bin, above which freed blocks are rejected.
+        uint64_t mHits;             ///< Number of allocations of the size served from the bin.
+        uint64_t mMisses;           ///< Number of allocations of the size that found the bin empty.
+    };
+
+    /**
+    Default constructor. Zeroes all entries.
+    */
+    inline AllocatorCacheStats() :
+      mSlotSize(0),
+      mCachedSlots(0),
+      mMaxSlots(0),
+      mSlotHits(0),
+      mSlotMisses(0),
+      mFallbackAllocations(0),
+      mFallbackFrees(0)
+    {
+        for (uint32_t index = 0; index < MAX_POOLS; ++index)
+        {
+            mPools[index].mBlockSize = 0;
+            mPools[index].mCachedBlocks = 0;
+            mPools[index].mMaxBlocks = 0;
+            mPools[index].mHits = 0;
+            mPools[index].mMisses = 0;
+        }
+    }
+
+    uint32_t mSlotSize;             ///< Size in bytes of the uniform slots serving small allocations.
+    uint32_t mCachedSlots;          ///< Number of free slots currently cached in the slot stacks.
+    uint32_t mMaxSlots;             ///< Configured depth of the slot stacks, above which freed slots are rejected.
+    uint64_t mSlotHits;             ///< Number of small allocations served from the slot stacks.
+    uint64_t mSlotMisses;           ///< Number of small allocations that found the slot stacks empty.
+    uint64_t mFallbackAllocations;  ///< Number of allocations that fell through to the wrapped lower-level allocator.
+    uint64_t mFallbackFrees;        ///< Number of freed blocks returned to the wrapped lower-level allocator rather than cached.
+    PoolStats mPools[MAX_POOLS];    ///< Per-size-bin entries, ordered by increasing block size.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_ALLOCATORCACHESTATS_H
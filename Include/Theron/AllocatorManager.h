@@ -14,6 +14,8 @@ Manager for allocators used within Theron.
 #include <Theron/Defines.h>
 #include <Theron/IAllocator.h>
 
+#include <Theron/Detail/Allocators/HugePageAllocator.h>
+
 
 namespace Theron
 {
@@ -97,6 +99,37 @@ public:
         mAllocator = allocator;
     }
 
+    /**
+    \brief Enables backing of large internal allocations with 2MB huge pages.
+
+    When enabled, large long-lived internal allocations, such as the page tables
+    of mailbox directories and the slabs backing message pools, are backed by
+    2MB huge pages where the system supports them, so that each such structure
+    is covered by a single TLB entry instead of many. Smaller allocations, and
+    all allocations on systems without huge page support, are served as before
+    by the general allocator, so enabling this option is always safe.
+
+    \code
+    Theron::AllocatorManager::Instance().EnableHugePages();
+    \endcode
+
+    \note This method should be called once at most, and before any other Theron
+    activity. If a custom allocator is also provided with \ref SetAllocator, it
+    must be set before huge pages are enabled, so that the huge page backing
+    wraps the custom allocator.
+
+    \see SetAllocator
+    */
+    inline void EnableHugePages()
+    {
+        // This method should only be called once, at start of day.
+        THERON_ASSERT_MSG(mAllocator != &mHugePageAllocator, "EnableHugePages can only be called once!");
+        THERON_ASSERT_MSG(mDefaultAllocator.GetBytesAllocated() == 0, "EnableHugePages can only be called before Framework construction");
+
+        mHugePageAllocator.SetFallbackAllocator(mAllocator);
+        mAllocator = &mHugePageAllocator;
+    }
+
     /**
     \brief Gets a pointer to the general allocator currently in use by Theron.
 
@@ -124,6 +157,7 @@ private:
     */
     inline AllocatorManager() :
       mDefaultAllocator(),
+      mHugePageAllocator(),
       mAllocator(&mDefaultAllocator)
     {
     }
@@ -134,6 +168,7 @@ private:
     static AllocatorManager smInstance;         ///< The single, static instance.
 
     DefaultAllocator mDefaultAllocator;         ///< Default allocator used if no user allocator is set.
+    Detail::HugePageAllocator mHugePageAllocator;   ///< Huge page backing wrapped around the general allocator, when enabled.
     IAllocator *mAllocator;                     ///< Pointer to a general allocator for use in internal allocations.
 };
 
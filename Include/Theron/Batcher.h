@@ -0,0 +1,381 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_BATCHER_H
+#define THERON_BATCHER_H
+
+
+/**
+\file Batcher.h
+Actor that aggregates individual values into batch messages.
+*/
+
+
+#include <new>
+
+#include <Theron/Actor.h>
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/Framework.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Timers/TimerJob.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief An actor that aggregates individual values into batch messages.
+
+Write-behind aggregation pipelines -- log batching, database write-behind,
+metrics roll-up -- typically need to flush accumulated values either when a
+batch fills or when a time limit expires, whichever comes first. Hand-rolling
+this requires a dedicated ticker actor per aggregator to generate the timeouts,
+adding a message hop per event. A Batcher implements the pattern once: values
+sent to it are copied into a preallocated buffer, and a single \ref Batch
+message is sent to the configured target when either the batch reaches its
+maximum size or the flush period elapses with values pending. The periodic
+flush is driven by the framework's timing wheel directly, so no ticker actor
+and no per-event forwarding hop are involved.
+
+The batch buffer is handed to the Batch message wholesale rather than copied,
+and is reference-counted by the Batch and its copies, so handlers read the
+values in place:
+
+\code
+class Writer : public Theron::Actor
+{
+public:
+
+    explicit Writer(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Writer::Handler);
+    }
+
+private:
+
+    void Handler(const Theron::Batcher<Record>::Batch &batch, const Theron::Address from)
+    {
+        // One write for the whole batch.
+        WriteRecords(batch.GetValues(), batch.GetCount());
+    }
+};
+
+Theron::Framework framework;
+Writer writer(framework);
+
+// Flush to the writer every 64 records or every 10 milliseconds.
+Theron::Batcher<Record> batcher(framework, writer.GetAddress(), 64, 10 * 1000);
+
+// Producers send individual records to the batcher.
+framework.Send(Record(), from, batcher.GetAddress());
+\endcode
+
+Timer-driven flushes preserve arrival order with respect to size-driven ones:
+a flush always emits the values accumulated so far, in the order they arrived.
+An elapsed period with no values pending sends nothing.
+
+\note The periodic flush timer is cancelled when the Batcher is destructed,
+but cancellation is asynchronous: a flush already in progress on the timer
+thread may still deliver one final tick. Destruct a Batcher only once its
+producers have stopped sending to it.
+*/
+template <typename ValueType>
+class Batcher : public Actor
+{
+private:
+
+    struct Storage;
+
+public:
+
+    /**
+    \brief Message carrying a flushed batch of accumulated values.
+
+    The values are owned by a reference-counted buffer shared by all copies
+    of the Batch, so copying a Batch -- including the copy made when it is
+    sent as a message -- doesn't copy the values. The buffer is freed when
+    the last referencing Batch is destructed.
+    */
+    class Batch
+    {
+    public:
+
+        friend class Batcher;
+
+        /**
+        \brief Default constructor. Constructs an empty batch.
+        */
+        THERON_FORCEINLINE Batch() : mStorage(0)
+        {
+        }
+
+        /**
+        \brief Copy constructor; shares the referenced buffer.
+        */
+        THERON_FORCEINLINE Batch(const Batch &other) : mStorage(other.mStorage)
+        {
+            if (mStorage)
+            {
+                mStorage->mRefCount.Increment();
+            }
+        }
+
+        /**
+        \brief Assignment operator; shares the buffer referenced by the other batch.
+        */
+        THERON_FORCEINLINE Batch &operator=(const Batch &other)
+        {
+            if (other.mStorage)
+            {
+                other.mStorage->mRefCount.Increment();
+            }
+
+            Release();
+            mStorage = other.mStorage;
+
+            return *this;
+        }
+
+        /**
+        \brief Destructor; releases the reference to the buffer.
+        */
+        THERON_FORCEINLINE ~Batch()
+        {
+            Release();
+        }
+
+        /**
+        \brief Gets a pointer to the first of the batched values.
+        \return A pointer to the values, or zero if the batch is empty.
+        */
+        THERON_FORCEINLINE const ValueType *GetValues() const
+        {
+            return mStorage ? mStorage->GetValues() : 0;
+        }
+
+        /**
+        \brief Gets the number of values in the batch.
+        */
+        THERON_FORCEINLINE uint32_t GetCount() const
+        {
+            return mStorage ? mStorage->mCount : 0;
+        }
+
+    private:
+
+        /**
+        Internal constructor adopting ownership of a storage buffer.
+        */
+        THERON_FORCEINLINE explicit Batch(Storage *const storage) : mStorage(storage)
+        {
+        }
+
+        /**
+        Releases the reference to the buffer, freeing it if this was the last.
+        */
+        THERON_FORCEINLINE void Release()
+        {
+            if (mStorage && mStorage->mRefCount.FetchDecrement() == 1)
+            {
+                Batcher::FreeStorage(mStorage);
+            }
+
+            mStorage = 0;
+        }
+
+        Storage *mStorage;                  ///< Reference-counted buffer holding the values.
+    };
+
+    /**
+    \brief Constructs a Batcher within the given framework.
+
+    \param framework The framework in which the batcher actor executes.
+    \param target Address to which flushed \ref Batch messages are sent.
+    \param maxBatchSize Number of accumulated values that triggers a flush.
+    \param flushPeriodMicroseconds Period after which pending values are
+    flushed regardless of count, or zero to flush on size alone.
+    \param name Optional unique name; a name is generated if none is given.
+    */
+    inline Batcher(
+        Framework &framework,
+        const Address &target,
+        const uint32_t maxBatchSize,
+        const uint64_t flushPeriodMicroseconds,
+        const char *const name = 0) :
+      Actor(framework, name),
+      mTarget(target),
+      mMaxBatchSize(maxBatchSize),
+      mStorage(0),
+      mTimerJob(0)
+    {
+        THERON_ASSERT(maxBatchSize > 0);
+
+        mStorage = AllocateStorage(mMaxBatchSize);
+
+        RegisterHandler(this, &Batcher::ValueHandler);
+        RegisterHandler(this, &Batcher::TickHandler);
+
+        // Arm the periodic flush on the framework's timing wheel, keeping the
+        // job handle so it can be cancelled on destruction.
+        if (flushPeriodMicroseconds)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+            void *const memory(allocator->Allocate(sizeof(Detail::TimerJob<FlushTick>)));
+
+            if (memory)
+            {
+                Detail::TimerJob<FlushTick> *const job = new (memory) Detail::TimerJob<FlushTick>(
+                    framework,
+                    FlushTick(),
+                    GetAddress(),
+                    GetAddress());
+
+                framework.mTimerWheel.Add(job, flushPeriodMicroseconds, true);
+                mTimerJob = job;
+            }
+        }
+    }
+
+    /**
+    \brief Destructor. Cancels the periodic flush; any pending values are discarded.
+    */
+    inline virtual ~Batcher()
+    {
+        if (mTimerJob)
+        {
+            mTimerJob->Cancel();
+        }
+
+        if (mStorage && mStorage->mRefCount.FetchDecrement() == 1)
+        {
+            FreeStorage(mStorage);
+        }
+    }
+
+private:
+
+    friend class Batch;
+
+    /**
+    Internal message sent to the batcher by its periodic flush timer.
+    */
+    struct FlushTick
+    {
+    };
+
+    /**
+    Reference-counted buffer in which values are accumulated, with the value
+    array allocated in the same block as the header.
+    */
+    struct Storage
+    {
+        THERON_FORCEINLINE ValueType *GetValues()
+        {
+            return reinterpret_cast<ValueType *>(this + 1);
+        }
+
+        Detail::Atomic::UInt32 mRefCount;   ///< Number of referencing owners.
+        uint32_t mCount;                    ///< Number of values accumulated so far.
+    };
+
+    Batcher(const Batcher &other);
+    Batcher &operator=(const Batcher &other);
+
+    /**
+    Allocates a storage buffer with capacity for the given number of values,
+    holding a single reference. The values themselves are copy-constructed
+    into the buffer as they arrive.
+    */
+    inline static Storage *AllocateStorage(const uint32_t capacity)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->Allocate(
+            static_cast<uint32_t>(sizeof(Storage) + capacity * sizeof(ValueType))));
+
+        if (memory == 0)
+        {
+            return 0;
+        }
+
+        Storage *const storage = new (memory) Storage();
+        storage->mRefCount.Store(1);
+        storage->mCount = 0;
+
+        return storage;
+    }
+
+    /**
+    Destructs the accumulated values and frees the storage buffer.
+    */
+    inline static void FreeStorage(Storage *const storage)
+    {
+        ValueType *const values(storage->GetValues());
+        for (uint32_t index = 0; index < storage->mCount; ++index)
+        {
+            values[index].~ValueType();
+        }
+
+        AllocatorManager::Instance().GetAllocator()->Free(storage);
+    }
+
+    /**
+    Accumulates a received value, flushing if the batch is full.
+    */
+    inline void ValueHandler(const ValueType &value, const Address /*from*/)
+    {
+        if (mStorage == 0)
+        {
+            // An earlier storage allocation failed; drop the value.
+            return;
+        }
+
+        new (mStorage->GetValues() + mStorage->mCount) ValueType(value);
+        ++mStorage->mCount;
+
+        if (mStorage->mCount == mMaxBatchSize)
+        {
+            Flush();
+        }
+    }
+
+    /**
+    Flushes any pending values when the flush period elapses.
+    */
+    inline void TickHandler(const FlushTick &/*tick*/, const Address /*from*/)
+    {
+        if (mStorage && mStorage->mCount)
+        {
+            Flush();
+        }
+    }
+
+    /**
+    Sends the accumulated values to the target as a single Batch message,
+    handing it the buffer wholesale, and starts a fresh buffer.
+    */
+    inline void Flush()
+    {
+        // The batch adopts this actor's reference to the buffer; the copy
+        // made when the message is sent takes a reference of its own.
+        const Batch batch(mStorage);
+        mStorage = AllocateStorage(mMaxBatchSize);
+
+        Send(batch, mTarget);
+    }
+
+    const Address mTarget;              ///< Address to which flushed batches are sent.
+    const uint32_t mMaxBatchSize;       ///< Number of accumulated values that triggers a flush.
+    Storage *mStorage;                  ///< Buffer in which values are currently accumulated.
+    Detail::ITimerJob *mTimerJob;       ///< Periodic flush timer, cancelled on destruction.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_BATCHER_H
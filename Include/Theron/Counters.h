@@ -17,16 +17,33 @@ namespace Theron
 \brief Enumerated type that lists event counters available for querying.
 
 The counters measure threadpool activity levels, so are useful for
-managing the size of the internal thread-pools within \ref Framework "frameworks".
-    
+managing the size of the internal thread-pools within \ref Framework "frameworks"
+and for capacity planning. The queue depth peaks and the scheduling counters
+together characterize how much work is queued and where: sustained spills and
+high queue depth peaks indicate the workers can't keep up, while high yield
+and sleep counts indicate idle capacity.
+
 \note All counters are local to each Framework instance, and count events in
-the queried Framework only.
+the queried Framework only. Most counters accumulate event counts, which
+\ref Framework::GetCounterValue "GetCounterValue" sums over all threads; the
+peak counters record high water marks, which it aggregates by maximum instead.
 
 \see Framework::GetCounterValue
 */
 enum Counter
 {
     COUNTER_MESSAGES_PROCESSED = 0,     ///< Number of messages processed by the framework.
+    COUNTER_LOCAL_PUSHES,               ///< Number of mailboxes scheduled onto the local queues of worker threads.
+    COUNTER_SHARED_PUSHES,              ///< Number of mailboxes scheduled onto the shared work queues.
+    COUNTER_LOCAL_QUEUE_SPILLS,         ///< Number of mailboxes that spilled to the shared queue because a local queue was full.
+    COUNTER_MAILBOX_STEALS,             ///< Number of mailboxes stolen by workers from the local queues of other workers.
+    COUNTER_CROSS_NODE_STEALS,          ///< Number of stolen mailboxes whose victim worker ran on a different NUMA node than the thief.
+    COUNTER_YIELDS,                     ///< Number of times a worker thread found no work and yielded.
+    COUNTER_SLEEP_TRANSITIONS,          ///< Number of times a worker thread blocked under \ref YIELD_STRATEGY_BLOCKING.
+    COUNTER_FAIRNESS_YIELDS,            ///< Number of times a mailbox with messages still queued was requeued behind other waiting work.
+    COUNTER_DEADLINE_MISSES,            ///< Number of messages sent with a deadline that were processed after the deadline had passed.
+    COUNTER_PEAK_LOCAL_QUEUE_DEPTH,     ///< Peak number of mailboxes queued in a single worker's local queue.
+    COUNTER_PEAK_SHARED_QUEUE_DEPTH,    ///< Peak number of mailboxes queued in the shared work queue.
     MAX_COUNTERS                        ///< Number of counters available for querying.
 };
 
@@ -219,6 +219,247 @@ preprocessor settings in Visual Studio.
 #endif
 
 
+/**
+\def THERON_ENABLE_PROFILING
+
+\brief Enables generation of code for per-actor handler execution profiling.
+
+If defined as 1, every message processed by an actor is timed, and the measured
+handler execution time is accumulated into a per-actor, per-message-type profile
+queryable with \ref Theron::Framework::GetActorProfile "Framework::GetActorProfile".
+Messages are also stamped with their enqueue time as they are queued, and the
+delay each spends queued before processing is attributed to its sender in a
+per-sender table of the same profile.
+
+Defaults to 0, disabling profiling, since the timing adds a small cost to every
+message processed.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ENABLE_PROFILING)
+#define THERON_ENABLE_PROFILING 0
+#endif
+
+
+/**
+\def THERON_ENABLE_MEMORY_ACCOUNTING
+
+\brief Enables per-mailbox accounting of queued message memory.
+
+If defined as 1, the memory occupied by messages queued in each mailbox is
+tallied as messages are sent and processed, attributing message envelopes and
+payloads to the destination mailbox. The tallies can be queried as a report of
+the largest consumers with \ref Theron::Framework::GetTopMemoryUsers
+"Framework::GetTopMemoryUsers", identifying which actor's mailbox is growing
+when a deployment leaks or backs up.
+
+Defaults to 0, disabling the accounting, since the tallying adds a small cost
+to every message sent and processed.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ENABLE_MEMORY_ACCOUNTING)
+#define THERON_ENABLE_MEMORY_ACCOUNTING 0
+#endif
+
+
+/**
+\def THERON_ENABLE_TRACING
+
+\brief Enables recording of framework scheduling events into per-thread trace buffers.
+
+If defined as 1, each worker thread records message pushes, mailbox scheduling
+events, handler execution begin/end pairs, and sleep/wake transitions into a
+per-thread ring buffer, with timestamps taken from a monotonic high-resolution
+clock. The accumulated traces can be written as a Chrome about:tracing JSON
+file with \ref Theron::Framework::DumpTrace "Framework::DumpTrace", visualizing
+the scheduling of an entire framework on a shared timeline.
+
+Defaults to 0, disabling tracing, since the recording adds a small cost to
+every scheduling event and the trace buffers occupy memory per thread.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ENABLE_TRACING)
+#define THERON_ENABLE_TRACING 0
+#endif
+
+
+/**
+\def THERON_ENABLE_MESSAGE_STATS
+
+\brief Enables per-message-type statistics collection.
+
+If defined as 1, every message submitted for delivery and every message
+processed by an actor is counted against its registered message type ID, with
+byte totals, in per-thread tables that are merged on demand by
+\ref Theron::Framework::GetMessageTypeStats "Framework::GetMessageTypeStats".
+This provides production counts and rates of message traffic by type without
+wrapping actors in instrumentation.
+
+Defaults to 0, disabling the collection, in which case the hooks compile away
+entirely and the generated code is identical to a build without the feature.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ENABLE_MESSAGE_STATS)
+#define THERON_ENABLE_MESSAGE_STATS 0
+#endif
+
+
+/**
+\def THERON_ENABLE_HASH_STATS
+
+\brief Enables collection of name hash bucket distribution statistics.
+
+If defined as 1, the string intern pool counts the number of distinct string
+values hashed into each of its buckets, and exposes the per-bucket counts via
+\ref Theron::Detail::StringPool::GetBucketCount "StringPool::GetBucketCount".
+The counts can be used to verify that the name hash spreads a workload's
+actual names evenly over the buckets used for name lookups.
+
+Defaults to 0, disabling the counting, which adds an atomic increment to
+every intern of a new string value.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ENABLE_HASH_STATS)
+#define THERON_ENABLE_HASH_STATS 0
+#endif
+
+
+/**
+\def THERON_SMALL_MESSAGE_LIMIT
+
+\brief Size limit in bytes below which messages take the small-message fast path.
+
+Message values that are trivially copyable and no larger than this limit are
+recognized at compile time as plain slabs of data: their envelopes are flagged
+so that message destruction skips the virtual release dispatch used to destruct
+the values of general message types, and simply returns the block to its pool
+or cache. Small trivially-copyable messages are the bulk of the traffic in
+most actor workloads, so the saving applies to most messages sent.
+
+Defaults to 64 bytes, covering a cache line's worth of value data. Larger
+trivially-copyable messages still avoid value destruction work; they merely
+take the general destroy path to do so.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_SMALL_MESSAGE_LIMIT)
+#define THERON_SMALL_MESSAGE_LIMIT 64
+#endif
+
+
+/**
+\def THERON_ACTOR_STORE_SIZE
+
+\brief Size in bytes of the in-place actor store embedded in each mailbox.
+
+If defined as a non-zero size, every mailbox embeds a raw storage region of that
+many bytes, and actors created with \ref Theron::Framework::CreateActor
+"Framework::CreateActor" that fit within it are constructed directly into the
+store of their own mailbox instead of in a separately allocated heap block.
+Processing a message then reads the mailbox queue and the actor's state from
+one contiguous memory region, where a separately allocated actor drags a
+second, unrelated region into cache on every processed message.
+
+Actors larger than the store, actors with alignment requirements stricter than
+eight bytes (see \ref Theron::Detail::ActorAlignment "ActorAlignment"), and
+actors constructed directly by application code are heap-allocated as usual.
+
+Defaults to 0, disabling the store, since a non-zero size grows every mailbox
+by that amount whether or not a co-located actor occupies it.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_ACTOR_STORE_SIZE)
+#define THERON_ACTOR_STORE_SIZE 0
+#endif
+
+
+/**
+\def THERON_MAILBOX_POOL_SLOTS
+
+\brief Number of message block slots in the micro-pool embedded in each mailbox.
+
+If defined as a non-zero count, every mailbox embeds that many preallocated
+message block slots, each of \ref THERON_MAILBOX_POOL_SLOT_SIZE bytes. Sends to
+actors flagged high-rate with \ref Theron::Framework::SetHighRate
+"Framework::SetHighRate" allocate their message blocks from the destination
+mailbox's own slots when they fit, and processed messages return their blocks
+to the slots, so the steady-state traffic of a high-rate actor circulates
+through a handful of memory lines resident near its mailbox instead of blocks
+that migrate between the caches of whichever workers process it.
+
+Messages too large for a slot, and all messages to unflagged actors, are
+allocated from the ordinary message caches.
+
+Defaults to 4 slots. Defining the count as 0 disables the pools and removes
+the embedded storage from every mailbox.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_MAILBOX_POOL_SLOTS)
+#define THERON_MAILBOX_POOL_SLOTS 4
+#endif
+
+
+/**
+\def THERON_MAILBOX_POOL_SLOT_SIZE
+
+\brief Size in bytes of each slot of the micro-pool embedded in each mailbox.
+
+Sets the size of the \ref THERON_MAILBOX_POOL_SLOTS "mailbox micro-pool" slots,
+and so the largest message block the pools can serve. Message blocks hold the
+message value plus the internal envelope object, so the largest poolable value
+is somewhat smaller than the slot.
+
+Defaults to 128 bytes, covering typical small control and update messages.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_MAILBOX_POOL_SLOT_SIZE)
+#define THERON_MAILBOX_POOL_SLOT_SIZE 128
+#endif
+
+
 /**
 \def THERON_BOOST
 
@@ -637,5 +878,116 @@ preprocessor settings in Visual Studio.
 #endif
 
 
+/**
+\def THERON_SHM
+
+\brief Enables the shared memory transport for endpoints on the same host.
+
+This define controls the availability of a shared memory transport backend within
+the network transport layer. When enabled, endpoint locations using the shm://
+scheme are carried over a message ring in a mapped shared memory segment, with
+futex-based signaling, rather than over the network stack. Locations using the
+tcp:// scheme with a loopback host are served over both transports, and
+connecting endpoints on the same host select the shared memory ring
+automatically, since a loopback binding is only reachable from the local host
+in any case.
+
+It is defined automatically if not predefined by the user. When automatically
+defined, it currently defaults to 0 in all builds, disabling the shared memory
+transport. The supplied CMake build enables it on 64-bit Linux GCC builds, the
+only configuration on which it is currently supported.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_SHM)
+#define THERON_SHM 0
+#endif
+
+
+/**
+\def THERON_SHM_RING_SIZE
+
+\brief Size in bytes of the message ring used by the shared memory transport.
+
+Must be a power of two. The ring bounds the largest sendable message: a message,
+together with any earlier parts of the same multipart message, must fit in the
+ring in its entirety. Larger payloads should be split using the endpoint's
+chunked streaming support. All communicating processes must agree on the ring
+size; a process attaching to a segment created with a different ring size fails
+to connect.
+*/
+
+
+#if !defined(THERON_SHM_RING_SIZE)
+#define THERON_SHM_RING_SIZE (4194304)
+#endif
+
+
+/**
+\def THERON_NO_LEGACY
+
+\brief Build profile that compiles out the deprecated 3.x actor creation path.
+
+Actors created the legacy way -- \ref Theron::Framework::CreateActor
+"Framework::CreateActor" returning an \ref Theron::ActorRef "ActorRef", with
+the actor using the default \ref Theron::Actor "Actor" baseclass constructor --
+are matched to their owning framework through a lock-protected static registry.
+Applications that never use the legacy path still pay for its hooks: every
+actor construction probes the registry, taking its lock.
+
+If THERON_NO_LEGACY is defined as 1, the legacy creation path and its registry
+probes are compiled out entirely. The legacy CreateActor methods and the
+default Actor constructor are unavailable, and code using them fails to
+compile.
+
+It is defined automatically if not predefined by the user. When automatically
+defined, it is defined as 0, retaining the legacy path.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_NO_LEGACY)
+#define THERON_NO_LEGACY 0
+#endif
+
+
+/**
+\def THERON_NO_NETWORK
+
+\brief Build profile that compiles out remote delivery from the send paths.
+
+Message sends check for name-only addresses, which may identify remote actors
+reachable through an \ref Theron::EndPoint "EndPoint", before resolving their
+destination locally. Deployments that do no networking at all -- beyond simply
+building without a network library, which \ref THERON_XS already controls --
+still pay for that check and carry the name resolution code in their send
+paths.
+
+If THERON_NO_NETWORK is defined as 1, the name resolution branch of the send
+paths is compiled out entirely. All messages must be sent to concrete local
+addresses; sends to name-only addresses assert in debug builds and are
+dropped in release builds.
+
+It is defined automatically if not predefined by the user. When automatically
+defined, it is defined as 0, retaining remote delivery support.
+
+The default definition can be overridden by defining it globally in the build - either
+via the makefile command line options, on the GCC command line using -D, or in the project
+preprocessor settings in Visual Studio.
+*/
+
+
+#if !defined(THERON_NO_NETWORK)
+#define THERON_NO_NETWORK 0
+#endif
+
+
 #endif // THERON_DEFINES_H
 
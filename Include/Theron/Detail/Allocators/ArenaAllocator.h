@@ -0,0 +1,299 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_ARENAALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_ARENAALLOCATOR_H
+
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief A bump allocator for temporaries whose lifetimes end at a known point.
+
+Allocation advances a pointer through a chunk of memory, and \ref Free is a
+no-op: all allocations are released together when the arena is \ref Reset
+"reset". The arena is intended for scratch buffers allocated within a message
+handler and discarded before it returns; the worker thread resets the arena
+after each processed message.
+
+Chunks are allocated from the general allocator as needed and retained across
+resets, so a warmed-up arena allocates without ever touching the underlying
+allocator. The arena is not thread-safe; each worker thread owns its own.
+*/
+class ArenaAllocator : public IAllocator
+{
+public:
+
+    /**
+    \brief Default constructor.
+    Memory is only allocated when the arena is first used.
+    */
+    inline ArenaAllocator();
+
+    /**
+    \brief Virtual destructor.
+    */
+    inline virtual ~ArenaAllocator();
+
+    /**
+    \brief Allocates a block of contiguous memory from the arena.
+    \param size The size of the memory block to allocate, in bytes.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *Allocate(const SizeType size);
+
+    /**
+    \brief Allocates a block of contiguous memory aligned to a given byte-multiple boundary.
+    \param size The size of the memory block to allocate, in bytes.
+    \param alignment The alignment of the memory to allocate, in bytes, which must be a power of two.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment);
+
+    /**
+    \brief Frees a previously allocated block of contiguous memory.
+    \note A no-op: the memory is released when the arena is reset.
+    */
+    inline virtual void Free(void *const memory);
+
+    /**
+    \brief Frees a previously allocated block of contiguous memory of a known size.
+    \note A no-op: the memory is released when the arena is reset.
+    */
+    inline virtual void Free(void *const memory, const SizeType size);
+
+    /**
+    \brief Releases all allocations made from the arena, retaining its chunks for reuse.
+    */
+    inline void Reset();
+
+private:
+
+    /**
+    Usable bytes in each arena chunk. Larger single allocations are deferred
+    to the general allocator and freed when the arena is reset.
+    */
+    static const SizeType CHUNK_SIZE = 16 * 1024;
+
+    /**
+    Header at the front of each allocated chunk, chaining the chunks together.
+    The usable chunk memory follows the header.
+    */
+    struct Chunk
+    {
+        Chunk *mNext;               ///< Pointer to the next chunk in the chain.
+    };
+
+    /**
+    Header at the front of each oversized allocation, chaining them for freeing on reset.
+    */
+    struct OversizedBlock
+    {
+        OversizedBlock *mNext;      ///< Pointer to the next oversized block in the chain.
+    };
+
+    ArenaAllocator(const ArenaAllocator &other);
+    ArenaAllocator &operator=(const ArenaAllocator &other);
+
+    /**
+    Makes the next chunk in the chain current, allocating it if it doesn't exist yet.
+    This function is intentionally not force-inlined since chunk turnover is rare.
+    \return False if a needed chunk couldn't be allocated.
+    */
+    inline bool NextChunk();
+
+    /**
+    Allocates an oversized block directly from the general allocator.
+    */
+    inline void *AllocateOversized(const SizeType size, const SizeType alignment);
+
+    Chunk *mChunks;                 ///< Chain of chunks owned by the arena.
+    Chunk *mCurrentChunk;           ///< Chunk from which allocations are currently served.
+    uint8_t *mCursor;               ///< Bump pointer within the current chunk.
+    uint8_t *mEnd;                  ///< End of the usable memory of the current chunk.
+    OversizedBlock *mOversized;     ///< Chain of oversized blocks freed on reset.
+};
+
+
+inline ArenaAllocator::ArenaAllocator() :
+  mChunks(0),
+  mCurrentChunk(0),
+  mCursor(0),
+  mEnd(0),
+  mOversized(0)
+{
+}
+
+
+inline ArenaAllocator::~ArenaAllocator()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Free any outstanding oversized allocations.
+    Reset();
+
+    // Free the chunk chain.
+    Chunk *chunk(mChunks);
+    while (chunk)
+    {
+        Chunk *const next(chunk->mNext);
+        allocator->Free(chunk, sizeof(Chunk) + CHUNK_SIZE);
+        chunk = next;
+    }
+}
+
+
+THERON_FORCEINLINE void *ArenaAllocator::Allocate(const SizeType size)
+{
+    // Default to pointer-sized alignment, adequate for typical scratch buffers.
+    return AllocateAligned(size, sizeof(void *));
+}
+
+
+THERON_FORCEINLINE void *ArenaAllocator::AllocateAligned(const SizeType size, const SizeType alignment)
+{
+    THERON_ASSERT(size);
+    THERON_ASSERT((alignment & (alignment - 1)) == 0);
+
+    // Allocations that can't be served from a chunk go straight to the general allocator.
+    if (size + alignment > CHUNK_SIZE)
+    {
+        return AllocateOversized(size, alignment);
+    }
+
+    do
+    {
+        // Bump the cursor up to the requested alignment and check for space.
+        uint8_t *cursor(mCursor);
+        THERON_ALIGN(cursor, alignment);
+
+        if (cursor + size <= mEnd)
+        {
+            mCursor = cursor + size;
+            return cursor;
+        }
+
+        // The current chunk is exhausted (or doesn't exist yet); move to the next.
+    } while (NextChunk());
+
+    return 0;
+}
+
+
+inline void ArenaAllocator::Free(void *const /*memory*/)
+{
+    // Individual frees are no-ops; the memory is released when the arena is reset.
+}
+
+
+inline void ArenaAllocator::Free(void *const /*memory*/, const SizeType /*size*/)
+{
+    // Individual frees are no-ops; the memory is released when the arena is reset.
+}
+
+
+THERON_FORCEINLINE void ArenaAllocator::Reset()
+{
+    // Rewind the bump pointer to the start of the first chunk, retaining the
+    // chunk chain so a warmed-up arena doesn't touch the underlying allocator.
+    mCurrentChunk = mChunks;
+    if (mCurrentChunk)
+    {
+        mCursor = reinterpret_cast<uint8_t *>(mCurrentChunk + 1);
+        mEnd = mCursor + CHUNK_SIZE;
+    }
+
+    // Oversized blocks aren't retained and are returned to the general allocator.
+    if (mOversized)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        OversizedBlock *block(mOversized);
+        while (block)
+        {
+            OversizedBlock *const next(block->mNext);
+            allocator->Free(block);
+            block = next;
+        }
+
+        mOversized = 0;
+    }
+}
+
+
+inline bool ArenaAllocator::NextChunk()
+{
+    // Reuse the next chunk in the chain if one was allocated previously.
+    Chunk *next(mCurrentChunk ? mCurrentChunk->mNext : mChunks);
+
+    if (next == 0)
+    {
+        // Allocate and link a new chunk.
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        void *const memory(allocator->Allocate(sizeof(Chunk) + CHUNK_SIZE));
+        if (memory == 0)
+        {
+            return false;
+        }
+
+        next = reinterpret_cast<Chunk *>(memory);
+        next->mNext = 0;
+
+        if (mCurrentChunk)
+        {
+            mCurrentChunk->mNext = next;
+        }
+        else
+        {
+            mChunks = next;
+        }
+    }
+
+    mCurrentChunk = next;
+    mCursor = reinterpret_cast<uint8_t *>(next + 1);
+    mEnd = mCursor + CHUNK_SIZE;
+
+    return true;
+}
+
+
+inline void *ArenaAllocator::AllocateOversized(const SizeType size, const SizeType alignment)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate room for the chaining header plus worst-case alignment padding.
+    void *const memory(allocator->Allocate(sizeof(OversizedBlock) + size + alignment));
+    if (memory == 0)
+    {
+        return 0;
+    }
+
+    // Chain the block for freeing when the arena is reset.
+    OversizedBlock *const block(reinterpret_cast<OversizedBlock *>(memory));
+    block->mNext = mOversized;
+    mOversized = block;
+
+    // Align the caller's portion of the block.
+    uint8_t *callerBlock(reinterpret_cast<uint8_t *>(block + 1));
+    THERON_ALIGN(callerBlock, alignment);
+
+    return callerBlock;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_ARENAALLOCATOR_H
@@ -0,0 +1,209 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_BUDGETALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_BUDGETALLOCATOR_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+An allocator adapter that enforces a byte budget on the allocator it wraps.
+
+The budget bounds the total memory a framework's allocator chain can hold at
+once, so a framework that backs up under overload degrades alone instead of
+consuming the whole host. Admission is a single atomic add against the bytes
+currently in use: an allocation that would take the total over the budget is
+refused, returning zero like an allocation failure of the wrapped allocator,
+and optionally reported through a pressure callback. The adapter sits below
+the framework's caching and arena allocators, which absorb the hot allocation
+paths, so the atomic is touched only when the chain grows or shrinks.
+
+\note Freed blocks are refunded only when freed with an explicit size, which
+internal callers always do; the rare unsized free forwards without a refund,
+leaving the budget conservatively charged.
+*/
+class BudgetAllocator : public IAllocator
+{
+public:
+
+    /**
+    Callback invoked when an allocation is refused because it would exceed the budget.
+    \note Called on the allocating thread, which may be a worker thread or an
+    application thread sending a message; the callback must be thread-safe and
+    must not allocate through the budgeted chain.
+    */
+    typedef void (PressureCallback)(void *context, uint32_t attemptedBytes);
+
+    /**
+    Constructor.
+    \param wrappedAllocator Pointer to a general allocator wrapped by this allocator.
+    \param budgetBytes Maximum number of bytes the wrapped allocator may hold at once; zero for no budget.
+    */
+    inline BudgetAllocator(IAllocator *const wrappedAllocator, const uint64_t budgetBytes) :
+      mWrapped(wrappedAllocator),
+      mBudgetBytes(budgetBytes),
+      mBytesInUse(0),
+      mRefusedCount(0),
+      mCallback(0),
+      mCallbackContext(0)
+    {
+        THERON_ASSERT(wrappedAllocator);
+    }
+
+    /**
+    Registers a callback invoked whenever an allocation is refused.
+    \note Expected to be called once, before the budget comes under pressure;
+    the pointers are read unsynchronized by allocating threads.
+    */
+    inline void SetPressureCallback(PressureCallback *const callback, void *const context)
+    {
+        mCallback = callback;
+        mCallbackContext = context;
+    }
+
+    /**
+    Allocates a block of contiguous memory, if the budget admits it.
+    \return A pointer to the allocated block, or zero if the budget or the wrapped allocator refused it.
+    */
+    inline virtual void *Allocate(const SizeType size)
+    {
+        if (!Charge(size))
+        {
+            return 0;
+        }
+
+        void *const block(mWrapped->Allocate(size));
+        if (block == 0)
+        {
+            Refund(size);
+        }
+
+        return block;
+    }
+
+    /**
+    Allocates an aligned block of contiguous memory, if the budget admits it.
+    \return A pointer to the allocated block, or zero if the budget or the wrapped allocator refused it.
+    */
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment)
+    {
+        if (!Charge(size))
+        {
+            return 0;
+        }
+
+        void *const block(mWrapped->AllocateAligned(size, alignment));
+        if (block == 0)
+        {
+            Refund(size);
+        }
+
+        return block;
+    }
+
+    /**
+    Frees a previously allocated block of unknown size.
+    The block isn't refunded against the budget, since its size isn't known;
+    internal callers always free with an explicit size, so in practice the
+    budget tracks the bytes in use exactly.
+    */
+    inline virtual void Free(void *const memory)
+    {
+        mWrapped->Free(memory);
+    }
+
+    /**
+    Frees a previously allocated block of known size, refunding it against the budget.
+    */
+    inline virtual void Free(void *const memory, const SizeType size)
+    {
+        mWrapped->Free(memory, size);
+        Refund(size);
+    }
+
+    /**
+    Returns the number of bytes currently held against the budget.
+    */
+    THERON_FORCEINLINE uint64_t GetBytesInUse() const
+    {
+        return mBytesInUse.Load();
+    }
+
+    /**
+    Returns the number of allocations refused because they would have exceeded the budget.
+    */
+    THERON_FORCEINLINE uint32_t GetRefusedCount() const
+    {
+        return mRefusedCount.Load();
+    }
+
+private:
+
+    BudgetAllocator(const BudgetAllocator &other);
+    BudgetAllocator &operator=(const BudgetAllocator &other);
+
+    /**
+    Charges an allocation against the budget, refusing it if the budget would be exceeded.
+    */
+    inline bool Charge(const SizeType size)
+    {
+        if (mBudgetBytes == 0)
+        {
+            return true;
+        }
+
+        // Charge optimistically and back the charge out on refusal, so
+        // admission is one atomic add with no compare-exchange loop.
+        const uint64_t inUse(mBytesInUse.FetchAdd(size) + size);
+        if (inUse > mBudgetBytes)
+        {
+            mBytesInUse.Subtract(size);
+            mRefusedCount.Increment();
+
+            if (mCallback)
+            {
+                mCallback(mCallbackContext, size);
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+    Refunds a charged allocation against the budget.
+    */
+    THERON_FORCEINLINE void Refund(const SizeType size)
+    {
+        if (mBudgetBytes != 0)
+        {
+            mBytesInUse.Subtract(size);
+        }
+    }
+
+    IAllocator *const mWrapped;         ///< Pointer to the wrapped general allocator.
+    const uint64_t mBudgetBytes;        ///< Maximum bytes the wrapped allocator may hold at once; zero for no budget.
+    Atomic::UInt64 mBytesInUse;         ///< Bytes currently allocated and not yet refunded.
+    Atomic::UInt32 mRefusedCount;       ///< Count of allocations refused by the budget.
+    PressureCallback *mCallback;        ///< Callback invoked on refused allocations, or zero.
+    void *mCallbackContext;             ///< User-defined context passed to the pressure callback.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_BUDGETALLOCATOR_H
@@ -1,297 +1,701 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
-#define THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
-
-
-#include <Theron/Align.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Allocators/Pool.h>
-#include <Theron/Detail/Allocators/TrivialAllocator.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-class NullCachingAllocatorLock
-{
-public:
-
-    THERON_FORCEINLINE void Lock()
-    {
-    }
-
-    THERON_FORCEINLINE void Unlock()
-    {
-    }
-};
-
-
-/**
-A caching allocator that caches free memory blocks of various small sizes.
-*/
-template <uint32_t POOL_COUNT, class LockType = NullCachingAllocatorLock>
-class CachingAllocator : public Theron::IAllocator
-{
-public:
-
-    /**
-    Default constructor.
-    Constructs a CachingAllocator around an internally owned Detail::TrivialAllocator.
-    The TrivialAllocator acts as a trivial wrapper around global new and delete. The
-    CachingAllocator adds caching of small allocations.
-    */
-    inline CachingAllocator();
-
-    /**
-    Explicit constructor.
-    Constructs a CachingAllocator around an externally owned lower-level allocator.
-    The CachingAllocator adds caching of small allocations.
-    \param allocator Pointer to a lower-level allocator which the cache will wrap.
-    */
-    inline explicit CachingAllocator(IAllocator *const allocator);
-
-    /**
-    Destructor.
-    */
-    inline virtual ~CachingAllocator();
-
-    /**
-    Allocates a memory block of the given size.
-    */
-    inline virtual void *Allocate(const uint32_t size);
-
-    /**
-    Allocates a memory block of the given size and alignment.
-    */
-    inline virtual void *AllocateAligned(const uint32_t size, const uint32_t alignment);
-
-    /**
-    Frees a previously allocated memory block.
-    */
-    inline virtual void Free(void *const block);
-
-    /**
-    Frees a previously allocated memory block of a known size.
-    */
-    inline virtual void Free(void *const block, const uint32_t size);
-
-    /**
-    Frees all currently cached memory blocks.
-    */
-    inline void Clear();
-
-private:
-
-    /**
-    Hashes a block size to a pool index.
-    */
-    inline static uint32_t MapBlockSizeToPool(const uint32_t size);
-
-    CachingAllocator(const CachingAllocator &other);
-    CachingAllocator &operator=(const CachingAllocator &other);
-
-    inline void *AllocateInline(const uint32_t size, const uint32_t alignment);
-    inline void FreeInline(void *const block, const uint32_t size);
-
-    TrivialAllocator mTrivialAllocator;     ///< Default low-level allocator implementation.
-    IAllocator *const mAllocator;           ///< Pointer to a wrapped low-level allocator.
-    Pool<LockType> mPools[POOL_COUNT];      ///< Pools of memory blocks of different sizes.
-};
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::CachingAllocator() :
-  mTrivialAllocator(),
-  mAllocator(&mTrivialAllocator)
-{
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::CachingAllocator(IAllocator *const allocator) :
-  mTrivialAllocator(),
-  mAllocator(allocator)
-{
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::~CachingAllocator()
-{
-    Clear();
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-inline void *CachingAllocator<POOL_COUNT, LockType>::Allocate(const uint32_t size)
-{
-    // Promote small allocations to cache-line size and alignment to improve cache hit rate.
-    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
-    const uint32_t effectiveAlignment(THERON_CACHELINE_ALIGNMENT);
-
-    // Force-inlined call.
-    return AllocateInline(effectiveSize, effectiveAlignment);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-inline void *CachingAllocator<POOL_COUNT, LockType>::AllocateAligned(const uint32_t size, const uint32_t alignment)
-{
-    // Promote small alignments to cache-line size and alignment to improve cache hit rate.
-    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
-    const uint32_t effectiveAlignment(alignment > THERON_CACHELINE_ALIGNMENT ? alignment : THERON_CACHELINE_ALIGNMENT);
-
-    // Force-inlined call.
-    return AllocateInline(effectiveSize, effectiveAlignment);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE void *CachingAllocator<POOL_COUNT, LockType>::AllocateInline(const uint32_t size, const uint32_t alignment)
-{
-    // Sizes are expected to be at least a cache-line.
-    // Alignment values are expected to be powers of two and at least cache-line boundaries.
-    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
-    THERON_ASSERT(alignment >= THERON_CACHELINE_ALIGNMENT);
-    THERON_ASSERT((alignment & (alignment - 1)) == 0);
-
-    // Find the index of the pool containing blocks of this size.
-    const uint32_t poolIndex(MapBlockSizeToPool(size));
-
-    // We can't cache blocks bigger than a certain maximum size.
-    if (poolIndex < POOL_COUNT)
-    {
-        // Search the pool for a block of the right alignment.
-        Pool<LockType> &pool(mPools[poolIndex]);
-
-        pool.Lock();
-        void *const block(pool.FetchAligned(alignment));
-        pool.Unlock();
-
-        if (block)
-        {
-            return block;
-        }
-    }
-
-    // We didn't find a cached block so allocate one with the wrapped allocator.
-    return mAllocator->AllocateAligned(size, alignment);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-inline void CachingAllocator<POOL_COUNT, LockType>::Free(void *const block)
-{
-    // This caching allocator relies on knowing the sizes of freed blocks.
-    // We know the allocated size is at least a cache-line because we promote smaller alignments.
-    // This does assume the memory was allocated using this cache, or another instance of it.
-    // In the case where the actual memory block was larger than a cache line we waste the extra.
-    const uint32_t effectiveSize(THERON_CACHELINE_ALIGNMENT);
-
-    FreeInline(block, effectiveSize);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-inline void CachingAllocator<POOL_COUNT, LockType>::Free(void *const block, const uint32_t size)
-{
-    // We know the allocated size is at least a cache-line because we promote smaller alignments.
-    // This does assume the memory was allocated using this cache, or another instance of it.
-    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
-
-    FreeInline(block, effectiveSize);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE void CachingAllocator<POOL_COUNT, LockType>::FreeInline(void *const block, const uint32_t size)
-{
-    // Sizes are expected to be at least a cache-line.
-    // Alignment values are expected to be powers of two and at least cache-line boundaries.
-    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
-    THERON_ASSERT(block);
-
-    // Find the index of the pool containing blocks of this size.
-    const uint32_t poolIndex(MapBlockSizeToPool(size));
-
-    // We can't cache blocks bigger than a certain maximum size.
-    if (poolIndex < POOL_COUNT)
-    {
-        // Add the block to the pool, if there is space left in the pool.
-        Pool<LockType> &pool(mPools[poolIndex]);
-
-        pool.Lock();
-        const bool freed(pool.Add(block));
-        pool.Unlock();
-
-        if (freed)
-        {
-            return;
-        }
-    }
-
-    // Can't cache this block; return it to the wrapped low-level allocator.
-    mAllocator->Free(block);
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE void CachingAllocator<POOL_COUNT, LockType>::Clear()
-{
-    // Free any remaining blocks in the pools.
-    for (uint32_t index = 0; index < POOL_COUNT; ++index)
-    {
-        Pool<LockType> &pool(mPools[index]);
-
-        while (!pool.Empty())
-        {
-            void *const block = pool.Fetch();
-
-            THERON_ASSERT(block);
-            mAllocator->Free(block);
-        }
-    }
-}
-
-
-template <uint32_t POOL_COUNT, class LockType>
-THERON_FORCEINLINE uint32_t CachingAllocator<POOL_COUNT, LockType>::MapBlockSizeToPool(const uint32_t size)
-{
-    // We assume that all allocations are multiples of four bytes.
-    // Because we promote small allocations, the minimum size is a cache-line.
-    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
-    THERON_ASSERT((size & 3) == 0);
-
-    // Because all allocation sizes are multiples of four, we divide by four.
-    const uint32_t index(size >> 2);
-
-    // Because the minimum size is a cache-line, we subtract the number of four-byte words in a cache-line.
-    const uint32_t wordsPerCacheLine(THERON_CACHELINE_ALIGNMENT >> 2);
-    THERON_ASSERT(index >= wordsPerCacheLine);
-    return index - wordsPerCacheLine;
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
+
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorCacheStats.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Allocators/Pool.h>
+#include <Theron/Detail/Allocators/TrivialAllocator.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+class NullCachingAllocatorLock
+{
+public:
+
+    THERON_FORCEINLINE void Lock()
+    {
+    }
+
+    THERON_FORCEINLINE void Unlock()
+    {
+    }
+};
+
+
+/**
+A caching allocator that caches free memory blocks of various small sizes.
+
+Allocations small enough to fit a typical message envelope and an in-place
+copy of a small value are promoted to a uniform cache-line-sized slot and
+served from a dedicated slot stack, so the hot send path recycles fixed
+slots without searching the size-binned pools. Larger allocations fall back
+to the size-binned pools and ultimately to the wrapped low-level allocator.
+
+The size-binned pools are further segregated by the alignment of the cached
+block addresses, so every block in a pool satisfies the pool's alignment by
+construction and retrieval is an unconditional head pop, with no per-node
+alignment checks or list scanning.
+*/
+template <uint32_t POOL_COUNT, class LockType = NullCachingAllocatorLock>
+class CachingAllocator : public Theron::IAllocator
+{
+public:
+
+    /**
+    Default constructor.
+    Constructs a CachingAllocator around an internally owned Detail::TrivialAllocator.
+    The TrivialAllocator acts as a trivial wrapper around global new and delete. The
+    CachingAllocator adds caching of small allocations.
+    */
+    inline CachingAllocator();
+
+    /**
+    Explicit constructor.
+    Constructs a CachingAllocator around an externally owned lower-level allocator.
+    The CachingAllocator adds caching of small allocations.
+    \param allocator Pointer to a lower-level allocator which the cache will wrap.
+    */
+    inline explicit CachingAllocator(IAllocator *const allocator);
+
+    /**
+    Destructor.
+    */
+    inline virtual ~CachingAllocator();
+
+    /**
+    Allocates a memory block of the given size.
+    */
+    inline virtual void *Allocate(const uint32_t size);
+
+    /**
+    Allocates a memory block of the given size and alignment.
+    */
+    inline virtual void *AllocateAligned(const uint32_t size, const uint32_t alignment);
+
+    /**
+    Frees a previously allocated memory block.
+    */
+    inline virtual void Free(void *const block);
+
+    /**
+    Frees a previously allocated memory block of a known size.
+    */
+    inline virtual void Free(void *const block, const uint32_t size);
+
+    /**
+    Sets the maximum number of free blocks cached for a given block size.
+
+    Block sizes small enough to be served by the uniform slot stack share a
+    single depth, clamped to the capacity of the slot stack; larger sizes
+    each map to their own size-binned pool. Shrinking a depth below the
+    number of blocks currently cached releases the surplus blocks to the
+    wrapped low-level allocator.
+    */
+    inline void SetPoolDepth(const uint32_t blockSize, const uint32_t maxBlocks);
+
+    /**
+    Warms the cache with free blocks of the given size.
+
+    Allocates \ref count blocks of size \ref blockSize from the wrapped
+    low-level allocator and adds them to the cache, so that subsequent
+    allocations of that size are cache hits from the start. Blocks in excess
+    of the configured cache depth are returned to the wrapped allocator, so
+    preheating beyond the depth set with \ref SetPoolDepth has no effect.
+    */
+    inline void Preallocate(const uint32_t blockSize, const uint32_t count);
+
+    /**
+    Frees all currently cached memory blocks.
+    */
+    inline void Clear();
+
+    /**
+    \brief Releases cached blocks of unused sizes back to the wrapped allocator.
+
+    Over a long uptime the cache accumulates the high-water mark of every
+    block size the workload ever allocated, so memory claimed by a one-off
+    burst is held indefinitely. This method releases blocks from \em cold
+    parts of the cache: pools (and the small-allocation slot stack) that have
+    neither served nor accepted a block since a previous call examined them.
+    Sizes in active use are marked hot as they are recycled and are left alone.
+
+    At most \ref maxBlocks blocks are released per call, and successive calls
+    resume the scan where the previous one left off, so repeated passes drain
+    a cold cache gradually. The per-call bound rate-limits the work, letting
+    the method be called periodically from a maintenance thread without
+    competing with traffic; the per-pool locks are the same ones the
+    allocation paths take, held only briefly.
+
+    \param maxBlocks Maximum number of cached blocks to release in this call.
+    \return The number of blocks released.
+    */
+    inline uint32_t Trim(const uint32_t maxBlocks);
+
+    /**
+    \brief Accumulates the cache's occupancy and hit statistics into the given report.
+
+    Entries are accumulated into the report rather than overwriting it, so the
+    statistics of several caches can be aggregated into one report by querying
+    them in turn. The counts are read under the same locks the allocation paths
+    take, held only briefly, so the method is cheap enough to call periodically
+    from a monitoring thread.
+    */
+    inline void GetStats(AllocatorCacheStats &stats) const;
+
+private:
+
+    /**
+    Hashes a block size to a pool index.
+    */
+    inline static uint32_t MapBlockSizeToPool(const uint32_t size);
+
+    /**
+    Maps a block address to the alignment class of the pools that may cache it.
+    */
+    inline static uint32_t MapBlockAddressToClass(const void *const block);
+
+    CachingAllocator(const CachingAllocator &other);
+    CachingAllocator &operator=(const CachingAllocator &other);
+
+    inline void *AllocateInline(const uint32_t size, const uint32_t alignment);
+    inline void FreeInline(void *const block, const uint32_t size);
+
+    /**
+    Size in bytes of the uniform slots used for small allocations.
+    Big enough for a message envelope plus an in-place copy of a small message value.
+    */
+    static const uint32_t SLOT_SIZE = 2 * THERON_CACHELINE_ALIGNMENT;
+
+    /**
+    Capacity of the slot stack, an upper bound on the configurable slot depth.
+    */
+    static const uint32_t MAX_SLOTS = 256;
+
+    /**
+    Number of alignment classes into which each size bin is segregated.
+    Class zero holds blocks aligned to a cache line; class one holds blocks
+    additionally aligned to twice a cache line. Allocations requesting larger
+    alignments are rare enough at pool-cacheable sizes not to be cached.
+    */
+    static const uint32_t ALIGNMENT_CLASSES = 2;
+
+    /**
+    Largest alignment request served from the pools.
+    */
+    static const uint32_t MAX_CACHED_ALIGNMENT = 2 * THERON_CACHELINE_ALIGNMENT;
+
+    TrivialAllocator mTrivialAllocator;     ///< Default low-level allocator implementation.
+    IAllocator *const mAllocator;           ///< Pointer to a wrapped low-level allocator.
+    Pool<LockType> mPools[ALIGNMENT_CLASSES][POOL_COUNT];   ///< Pools of memory blocks segregated by size and address alignment.
+    mutable LockType mSlotLock;             ///< Synchronization primitive protecting the slot stack.
+    uint32_t mSlotCount;                    ///< Number of free slots currently in the slot stack.
+    uint32_t mMaxSlots;                     ///< Maximum number of free slots cached in the slot stack.
+    bool mSlotsHot;                         ///< Whether the slot stack has been used since the last maintenance pass.
+    uint32_t mTrimIndex;                    ///< Index at which the next maintenance pass resumes its scan.
+    uint64_t mSlotHits;                     ///< Number of small allocations served from the slot stack; written under the slot lock.
+    uint64_t mSlotMisses;                   ///< Number of small allocations that found the slot stack empty; written under the slot lock.
+    Atomic::UInt64 mFallbackAllocations;    ///< Number of allocations that fell through to the wrapped low-level allocator.
+    Atomic::UInt64 mFallbackFrees;          ///< Number of freed blocks returned to the wrapped low-level allocator rather than cached.
+    void *mSlots[MAX_SLOTS];                ///< LIFO stack of free uniform small-allocation slots.
+};
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::CachingAllocator() :
+  mTrivialAllocator(),
+  mAllocator(&mTrivialAllocator),
+  mSlotLock(),
+  mSlotCount(0),
+  mMaxSlots(MAX_SLOTS),
+  mSlotsHot(false),
+  mTrimIndex(0),
+  mSlotHits(0),
+  mSlotMisses(0),
+  mFallbackAllocations(0),
+  mFallbackFrees(0)
+{
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::CachingAllocator(IAllocator *const allocator) :
+  mTrivialAllocator(),
+  mAllocator(allocator),
+  mSlotLock(),
+  mSlotCount(0),
+  mMaxSlots(MAX_SLOTS),
+  mSlotsHot(false),
+  mTrimIndex(0),
+  mSlotHits(0),
+  mSlotMisses(0),
+  mFallbackAllocations(0),
+  mFallbackFrees(0)
+{
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE CachingAllocator<POOL_COUNT, LockType>::~CachingAllocator()
+{
+    Clear();
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void *CachingAllocator<POOL_COUNT, LockType>::Allocate(const uint32_t size)
+{
+    // Promote small allocations to cache-line size and alignment to improve cache hit rate.
+    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
+    const uint32_t effectiveAlignment(THERON_CACHELINE_ALIGNMENT);
+
+    // Force-inlined call.
+    return AllocateInline(effectiveSize, effectiveAlignment);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void *CachingAllocator<POOL_COUNT, LockType>::AllocateAligned(const uint32_t size, const uint32_t alignment)
+{
+    // Promote small alignments to cache-line size and alignment to improve cache hit rate.
+    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
+    const uint32_t effectiveAlignment(alignment > THERON_CACHELINE_ALIGNMENT ? alignment : THERON_CACHELINE_ALIGNMENT);
+
+    // Force-inlined call.
+    return AllocateInline(effectiveSize, effectiveAlignment);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE void *CachingAllocator<POOL_COUNT, LockType>::AllocateInline(const uint32_t size, const uint32_t alignment)
+{
+    // Sizes are expected to be at least a cache-line.
+    // Alignment values are expected to be powers of two and at least cache-line boundaries.
+    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
+    THERON_ASSERT(alignment >= THERON_CACHELINE_ALIGNMENT);
+    THERON_ASSERT((alignment & (alignment - 1)) == 0);
+
+    // Small allocations are promoted to uniform slots served from a dedicated
+    // stack, avoiding the size-binned pool search on the hot message send path.
+    // Because every slot is allocated at the full slot size, freed slots can be
+    // reused for any small allocation regardless of its exact requested size.
+    if (size <= SLOT_SIZE && alignment <= THERON_CACHELINE_ALIGNMENT)
+    {
+        void *slot(0);
+
+        mSlotLock.Lock();
+        if (mSlotCount > 0)
+        {
+            slot = mSlots[--mSlotCount];
+            mSlotsHot = true;
+            ++mSlotHits;
+        }
+        else
+        {
+            ++mSlotMisses;
+        }
+        mSlotLock.Unlock();
+
+        if (slot)
+        {
+            return slot;
+        }
+
+        mFallbackAllocations.Increment();
+        return mAllocator->AllocateAligned(SLOT_SIZE, THERON_CACHELINE_ALIGNMENT);
+    }
+
+    // Find the index of the pool containing blocks of this size.
+    const uint32_t poolIndex(MapBlockSizeToPool(size));
+
+    // We can't cache blocks bigger than a certain maximum size or alignment.
+    if (poolIndex < POOL_COUNT && alignment <= MAX_CACHED_ALIGNMENT)
+    {
+        // Pools are segregated by the alignment of their block addresses, so
+        // fetching is an unconditional head pop with no per-node alignment
+        // checks. Pools of a higher alignment class than requested also
+        // satisfy the request, so are tried in turn.
+        const uint32_t firstClass(alignment > THERON_CACHELINE_ALIGNMENT ? 1 : 0);
+        for (uint32_t alignmentClass = firstClass; alignmentClass < ALIGNMENT_CLASSES; ++alignmentClass)
+        {
+            Pool<LockType> &pool(mPools[alignmentClass][poolIndex]);
+
+            pool.Lock();
+            void *const block(pool.Fetch());
+            if (block)
+            {
+                pool.Touch();
+                pool.CountHit();
+            }
+            else if (alignmentClass + 1 == ALIGNMENT_CLASSES)
+            {
+                // The last class tried counts the miss for the whole size bin.
+                pool.CountMiss();
+            }
+            pool.Unlock();
+
+            if (block)
+            {
+                return block;
+            }
+        }
+    }
+
+    // We didn't find a cached block so allocate one with the wrapped allocator.
+    mFallbackAllocations.Increment();
+    return mAllocator->AllocateAligned(size, alignment);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void CachingAllocator<POOL_COUNT, LockType>::Free(void *const block)
+{
+    // This caching allocator relies on knowing the sizes of freed blocks.
+    // We know the allocated size is at least a cache-line because we promote smaller alignments.
+    // This does assume the memory was allocated using this cache, or another instance of it.
+    // In the case where the actual memory block was larger than a cache line we waste the extra.
+    const uint32_t effectiveSize(THERON_CACHELINE_ALIGNMENT);
+
+    FreeInline(block, effectiveSize);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void CachingAllocator<POOL_COUNT, LockType>::Free(void *const block, const uint32_t size)
+{
+    // We know the allocated size is at least a cache-line because we promote smaller alignments.
+    // This does assume the memory was allocated using this cache, or another instance of it.
+    const uint32_t effectiveSize(size > THERON_CACHELINE_ALIGNMENT ? size : THERON_CACHELINE_ALIGNMENT);
+
+    FreeInline(block, effectiveSize);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE void CachingAllocator<POOL_COUNT, LockType>::FreeInline(void *const block, const uint32_t size)
+{
+    // Sizes are expected to be at least a cache-line.
+    // Alignment values are expected to be powers of two and at least cache-line boundaries.
+    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
+    THERON_ASSERT(block);
+
+    // Small blocks were allocated at the uniform slot size, so they can be
+    // pushed onto the slot stack for reuse by any subsequent small allocation.
+    if (size <= SLOT_SIZE)
+    {
+        bool freed(false);
+
+        mSlotLock.Lock();
+        if (mSlotCount < mMaxSlots)
+        {
+            mSlots[mSlotCount++] = block;
+            mSlotsHot = true;
+            freed = true;
+        }
+        mSlotLock.Unlock();
+
+        if (freed)
+        {
+            return;
+        }
+
+        // The slot stack is full; return the slot to the wrapped low-level allocator.
+        mFallbackFrees.Increment();
+        mAllocator->Free(block);
+        return;
+    }
+
+    // Find the index of the pool containing blocks of this size.
+    const uint32_t poolIndex(MapBlockSizeToPool(size));
+
+    // We can't cache blocks bigger than a certain maximum size.
+    if (poolIndex < POOL_COUNT)
+    {
+        // Add the block to the pool matching the alignment of its address,
+        // if there is space left in the pool. Classifying freed blocks by
+        // their addresses keeps every pool's blocks interchangeable.
+        Pool<LockType> &pool(mPools[MapBlockAddressToClass(block)][poolIndex]);
+
+        pool.Lock();
+        const bool freed(pool.Add(block));
+        if (freed)
+        {
+            pool.Touch();
+        }
+        pool.Unlock();
+
+        if (freed)
+        {
+            return;
+        }
+    }
+
+    // Can't cache this block; return it to the wrapped low-level allocator.
+    mFallbackFrees.Increment();
+    mAllocator->Free(block);
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void CachingAllocator<POOL_COUNT, LockType>::SetPoolDepth(const uint32_t blockSize, const uint32_t maxBlocks)
+{
+    // Round up to a multiple of four bytes and promote small sizes to a cache-line,
+    // mirroring the promotion applied to allocation requests.
+    const uint32_t roundedSize((blockSize + 3) & ~static_cast<uint32_t>(3));
+    const uint32_t effectiveSize(roundedSize > THERON_CACHELINE_ALIGNMENT ? roundedSize : THERON_CACHELINE_ALIGNMENT);
+
+    // Small sizes are all served by the uniform slot stack, so they share a depth.
+    if (effectiveSize <= SLOT_SIZE)
+    {
+        mSlotLock.Lock();
+
+        mMaxSlots = (maxBlocks < MAX_SLOTS ? maxBlocks : MAX_SLOTS);
+
+        // Release surplus cached slots if the depth was reduced.
+        while (mSlotCount > mMaxSlots)
+        {
+            mAllocator->Free(mSlots[--mSlotCount]);
+        }
+
+        mSlotLock.Unlock();
+        return;
+    }
+
+    // Find the index of the pool containing blocks of this size.
+    const uint32_t poolIndex(MapBlockSizeToPool(effectiveSize));
+
+    // We can't cache blocks bigger than a certain maximum size.
+    // The alignment classes of a size bin share the configured depth, since
+    // callers configuring depths know block sizes rather than addresses.
+    if (poolIndex < POOL_COUNT)
+    {
+        for (uint32_t alignmentClass = 0; alignmentClass < ALIGNMENT_CLASSES; ++alignmentClass)
+        {
+            Pool<LockType> &pool(mPools[alignmentClass][poolIndex]);
+
+            pool.Lock();
+            pool.SetMaxBlocks(maxBlocks);
+
+            // Release surplus cached blocks if the depth was reduced.
+            while (pool.BlockCount() > maxBlocks)
+            {
+                mAllocator->Free(pool.Fetch());
+            }
+
+            pool.Unlock();
+        }
+    }
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void CachingAllocator<POOL_COUNT, LockType>::Preallocate(const uint32_t blockSize, const uint32_t count)
+{
+    // Round up to a multiple of four bytes and promote small sizes to a cache-line,
+    // mirroring the promotion applied to allocation requests.
+    const uint32_t roundedSize((blockSize + 3) & ~static_cast<uint32_t>(3));
+    const uint32_t effectiveSize(roundedSize > THERON_CACHELINE_ALIGNMENT ? roundedSize : THERON_CACHELINE_ALIGNMENT);
+
+    // Small blocks are cached at the uniform slot size, so allocate them at it.
+    const uint32_t allocationSize(effectiveSize <= SLOT_SIZE ? SLOT_SIZE : effectiveSize);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        void *const block(mAllocator->AllocateAligned(allocationSize, THERON_CACHELINE_ALIGNMENT));
+        if (block == 0)
+        {
+            break;
+        }
+
+        // Freeing the fresh block adds it to the cache, or returns it to the
+        // wrapped allocator if the cache for this size is already full.
+        FreeInline(block, effectiveSize);
+    }
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE void CachingAllocator<POOL_COUNT, LockType>::Clear()
+{
+    // Free any remaining slots in the slot stack.
+    mSlotLock.Lock();
+    while (mSlotCount > 0)
+    {
+        mAllocator->Free(mSlots[--mSlotCount]);
+    }
+    mSlotLock.Unlock();
+
+    // Free any remaining blocks in the pools.
+    for (uint32_t alignmentClass = 0; alignmentClass < ALIGNMENT_CLASSES; ++alignmentClass)
+    {
+        for (uint32_t index = 0; index < POOL_COUNT; ++index)
+        {
+            Pool<LockType> &pool(mPools[alignmentClass][index]);
+
+            while (!pool.Empty())
+            {
+                void *const block = pool.Fetch();
+
+                THERON_ASSERT(block);
+                mAllocator->Free(block);
+            }
+        }
+    }
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline uint32_t CachingAllocator<POOL_COUNT, LockType>::Trim(const uint32_t maxBlocks)
+{
+    uint32_t numFreed(0);
+
+    // Visit each part of the cache at most once per call, resuming where the
+    // previous call stopped. The last station is the uniform slot stack; the
+    // others are the size-and-alignment-binned pools.
+    const uint32_t numPools(ALIGNMENT_CLASSES * POOL_COUNT);
+    for (uint32_t visited = 0; visited <= numPools && numFreed < maxBlocks; ++visited)
+    {
+        const uint32_t station(mTrimIndex);
+        mTrimIndex = (station + 1 <= numPools) ? station + 1 : 0;
+
+        if (station == numPools)
+        {
+            mSlotLock.Lock();
+
+            // A hot slot stack is left alone; clearing the flag arms it for
+            // trimming on the next visit unless it gets used again first.
+            if (mSlotsHot)
+            {
+                mSlotsHot = false;
+            }
+            else
+            {
+                while (mSlotCount > 0 && numFreed < maxBlocks)
+                {
+                    mAllocator->Free(mSlots[--mSlotCount]);
+                    ++numFreed;
+                }
+            }
+
+            mSlotLock.Unlock();
+            continue;
+        }
+
+        Pool<LockType> &pool(mPools[station / POOL_COUNT][station % POOL_COUNT]);
+
+        pool.Lock();
+
+        // As for the slot stack: hot pools are skipped and re-armed.
+        if (!pool.CheckAndClearHot())
+        {
+            while (!pool.Empty() && numFreed < maxBlocks)
+            {
+                mAllocator->Free(pool.Fetch());
+                ++numFreed;
+            }
+        }
+
+        pool.Unlock();
+    }
+
+    return numFreed;
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+inline void CachingAllocator<POOL_COUNT, LockType>::GetStats(AllocatorCacheStats &stats) const
+{
+    stats.mSlotSize = SLOT_SIZE;
+
+    mSlotLock.Lock();
+    stats.mCachedSlots += mSlotCount;
+    stats.mMaxSlots += mMaxSlots;
+    stats.mSlotHits += mSlotHits;
+    stats.mSlotMisses += mSlotMisses;
+    mSlotLock.Unlock();
+
+    // The alignment classes of a size bin serve the same block size, so their
+    // counts are aggregated into the bin's single report entry.
+    const uint32_t poolCount(POOL_COUNT < AllocatorCacheStats::MAX_POOLS ? POOL_COUNT : AllocatorCacheStats::MAX_POOLS);
+    for (uint32_t index = 0; index < poolCount; ++index)
+    {
+        AllocatorCacheStats::PoolStats &entry(stats.mPools[index]);
+
+        // The inverse of MapBlockSizeToPool: bins are at four-byte granularity
+        // upwards from the cache line size, which is the minimum block size.
+        entry.mBlockSize = THERON_CACHELINE_ALIGNMENT + (index << 2);
+
+        for (uint32_t alignmentClass = 0; alignmentClass < ALIGNMENT_CLASSES; ++alignmentClass)
+        {
+            const Pool<LockType> &pool(mPools[alignmentClass][index]);
+
+            pool.Lock();
+            entry.mCachedBlocks += pool.BlockCount();
+            entry.mMaxBlocks += pool.MaxBlocks();
+            entry.mHits += pool.Hits();
+            entry.mMisses += pool.Misses();
+            pool.Unlock();
+        }
+    }
+
+    stats.mFallbackAllocations += mFallbackAllocations.Load();
+    stats.mFallbackFrees += mFallbackFrees.Load();
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE uint32_t CachingAllocator<POOL_COUNT, LockType>::MapBlockSizeToPool(const uint32_t size)
+{
+    // We assume that all allocations are multiples of four bytes.
+    // Because we promote small allocations, the minimum size is a cache-line.
+    THERON_ASSERT(size >= THERON_CACHELINE_ALIGNMENT);
+    THERON_ASSERT((size & 3) == 0);
+
+    // Because all allocation sizes are multiples of four, we divide by four.
+    const uint32_t index(size >> 2);
+
+    // Because the minimum size is a cache-line, we subtract the number of four-byte words in a cache-line.
+    const uint32_t wordsPerCacheLine(THERON_CACHELINE_ALIGNMENT >> 2);
+    THERON_ASSERT(index >= wordsPerCacheLine);
+    return index - wordsPerCacheLine;
+}
+
+
+template <uint32_t POOL_COUNT, class LockType>
+THERON_FORCEINLINE uint32_t CachingAllocator<POOL_COUNT, LockType>::MapBlockAddressToClass(const void *const block)
+{
+    // Blocks whose addresses happen to be aligned to twice a cache line go in
+    // the higher class, where they can serve requests for either alignment.
+    const uintptr_t address(reinterpret_cast<uintptr_t>(block));
+    return (address & (MAX_CACHED_ALIGNMENT - 1)) == 0 ? 1 : 0;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_ALLOCATORS_CACHINGALLOCATOR_H
@@ -0,0 +1,176 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_DEFERREDFREELIST_H
+#define THERON_DETAIL_ALLOCATORS_DEFERREDFREELIST_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief An allocator adapter that batches frees to an underlying allocator.
+
+Freed blocks are accumulated in a small fixed-size list and returned to the
+underlying allocator together once the list fills up, amortizing the
+allocator's bookkeeping over the batch and keeping the return loop tight.
+Allocations pass straight through to the underlying allocator.
+
+Deferral applies only to sized frees, where the block size is known and the
+deferred return can be serviced without inspecting the block. Unsized frees
+are forwarded immediately.
+
+The list is not thread-safe; each worker thread owns its own, wrapped around
+its per-thread message cache.
+*/
+class DeferredFreeList : public IAllocator
+{
+public:
+
+    /**
+    \brief Explicit constructor.
+    \param allocator Pointer to the underlying allocator to which blocks are returned.
+    */
+    inline explicit DeferredFreeList(IAllocator *const allocator);
+
+    /**
+    \brief Virtual destructor.
+    Returns any still-deferred blocks to the underlying allocator.
+    */
+    inline virtual ~DeferredFreeList();
+
+    /**
+    \brief Allocates a block of contiguous memory from the underlying allocator.
+    \param size The size of the memory block to allocate, in bytes.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *Allocate(const SizeType size);
+
+    /**
+    \brief Allocates a block of contiguous memory aligned to a given byte-multiple boundary.
+    \param size The size of the memory block to allocate, in bytes.
+    \param alignment The alignment of the memory to allocate, in bytes, which must be a power of two.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment);
+
+    /**
+    \brief Frees a previously allocated block of contiguous memory.
+    The size of the block is unknown so the free is forwarded immediately.
+    \param memory Pointer to the memory to be freed.
+    */
+    inline virtual void Free(void *const memory);
+
+    /**
+    \brief Frees a previously allocated block of contiguous memory of a known size.
+    The return of the block to the underlying allocator is deferred until a
+    batch of frees has accumulated.
+    \param memory Pointer to the memory to be freed.
+    \param size The size of the freed block, in bytes.
+    */
+    inline virtual void Free(void *const memory, const SizeType size);
+
+    /**
+    \brief Returns all currently deferred blocks to the underlying allocator.
+    */
+    inline void Flush();
+
+private:
+
+    /**
+    A deferred free, remembering the block and its size.
+    */
+    struct Entry
+    {
+        void *mBlock;                       ///< Pointer to the freed block of memory.
+        SizeType mSize;                     ///< Size of the freed block, in bytes.
+    };
+
+    /**
+    Number of frees accumulated before the batch is returned to the underlying allocator.
+    */
+    static const uint32_t MAX_DEFERRED = 32;
+
+    DeferredFreeList(const DeferredFreeList &other);
+    DeferredFreeList &operator=(const DeferredFreeList &other);
+
+    IAllocator *const mAllocator;           ///< Pointer to the underlying allocator.
+    uint32_t mCount;                        ///< Number of currently deferred frees.
+    Entry mEntries[MAX_DEFERRED];           ///< Deferred frees not yet returned to the underlying allocator.
+};
+
+
+THERON_FORCEINLINE DeferredFreeList::DeferredFreeList(IAllocator *const allocator) :
+  mAllocator(allocator),
+  mCount(0)
+{
+    THERON_ASSERT(allocator);
+}
+
+
+inline DeferredFreeList::~DeferredFreeList()
+{
+    Flush();
+}
+
+
+THERON_FORCEINLINE void *DeferredFreeList::Allocate(const SizeType size)
+{
+    return mAllocator->Allocate(size);
+}
+
+
+THERON_FORCEINLINE void *DeferredFreeList::AllocateAligned(const SizeType size, const SizeType alignment)
+{
+    return mAllocator->AllocateAligned(size, alignment);
+}
+
+
+THERON_FORCEINLINE void DeferredFreeList::Free(void *const memory)
+{
+    mAllocator->Free(memory);
+}
+
+
+THERON_FORCEINLINE void DeferredFreeList::Free(void *const memory, const SizeType size)
+{
+    THERON_ASSERT(mCount < MAX_DEFERRED);
+
+    // Remember the block rather than returning it straight away.
+    Entry &entry(mEntries[mCount++]);
+    entry.mBlock = memory;
+    entry.mSize = size;
+
+    // Return the whole batch once it's full.
+    if (mCount == MAX_DEFERRED)
+    {
+        Flush();
+    }
+}
+
+
+THERON_FORCEINLINE void DeferredFreeList::Flush()
+{
+    // Return the deferred blocks to the underlying allocator in one tight loop.
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        const Entry &entry(mEntries[index]);
+        mAllocator->Free(entry.mBlock, entry.mSize);
+    }
+
+    mCount = 0;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_DEFERREDFREELIST_H
@@ -0,0 +1,344 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_HUGEPAGEALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_HUGEPAGEALLOCATOR_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+
+#if defined(THERON_POSIX)
+#include <sys/mman.h>
+#endif // defined(THERON_POSIX)
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief An allocator that backs large allocations with 2MB huge pages.
+
+Large long-lived internal allocations, such as the page tables of mailbox
+directories and the slabs backing message pools, span many standard 4KB pages
+and so occupy many TLB (Translation Lookaside Buffer) entries. Backing them
+with 2MB huge pages lets a single TLB entry cover the whole structure,
+reducing TLB misses on the hot paths that walk them.
+
+Allocations of at least the huge page threshold are served from anonymous
+memory mappings, requested first with explicit huge page backing and then,
+if the system has no huge pages configured, as ordinary mappings advised
+for transparent huge page promotion. All smaller requests, and all requests
+when mappings can't be created, are passed through to the wrapped fallback
+allocator, so the allocator degrades silently on systems without huge page
+support.
+
+\note On Windows, large page allocations require the SeLockMemoryPrivilege
+privilege, which applications typically don't hold, so this allocator acts
+as a simple pass-through and all requests are served by the fallback allocator.
+*/
+class HugePageAllocator : public IAllocator
+{
+public:
+
+    /**
+    Size in bytes of a huge page. Allocations served from mappings are rounded
+    up to a multiple of this size, which is also their guaranteed alignment.
+    */
+    static const SizeType HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /**
+    Default constructor.
+    Constructs a pass-through allocator with no fallback allocator set.
+    */
+    inline HugePageAllocator();
+
+    /**
+    Virtual destructor.
+    Unmaps any mappings not yet freed at destruction.
+    */
+    inline virtual ~HugePageAllocator();
+
+    /**
+    Sets the fallback allocator wrapped by this allocator.
+    Must be called before the allocator is used.
+    \param fallbackAllocator Pointer to a general allocator wrapped by this allocator.
+    */
+    inline void SetFallbackAllocator(IAllocator *const fallbackAllocator);
+
+    /**
+    Allocates a block of contiguous memory, backing large blocks with huge pages.
+    \param size The size of the memory block to allocate, in bytes.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *Allocate(const SizeType size);
+
+    /**
+    Allocates a block of contiguous memory aligned to a given byte-multiple boundary,
+    backing large blocks with huge pages.
+    \param size The size of the memory block to allocate, in bytes.
+    \param alignment The alignment of the memory to allocate, in bytes, which must be a power of two.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment);
+
+    /**
+    Frees a previously allocated block of contiguous memory.
+    \param memory Pointer to the memory to be deallocated.
+    */
+    inline virtual void Free(void *const memory);
+
+    /**
+    Frees a previously allocated block of contiguous memory of a known size.
+    \param memory Pointer to the memory to be deallocated.
+    \param size The size of the freed memory block.
+    */
+    inline virtual void Free(void *const memory, const SizeType size);
+
+private:
+
+    /**
+    Maximum number of live mappings tracked at once.
+    Large requests beyond this limit fall back to the wrapped allocator.
+    */
+    static const uint32_t MAX_MAPPINGS = 64;
+
+    /**
+    A live memory mapping serving one large allocation.
+    */
+    struct Mapping
+    {
+        void *mMemory;              ///< Base address of the mapping.
+        SizeType mSize;             ///< Mapped size in bytes, a multiple of the huge page size.
+    };
+
+    /**
+    Tries to serve a large allocation from a huge-page-backed memory mapping.
+    \return A pointer to the mapped memory, or zero if no mapping could be created.
+    */
+    inline void *AllocateMapped(const SizeType size);
+
+    HugePageAllocator(const HugePageAllocator &other);
+    HugePageAllocator &operator=(const HugePageAllocator &other);
+
+    SpinLock mSpinLock;                         ///< Protects the mapping table.
+    IAllocator *mFallbackAllocator;             ///< Wrapped fallback allocator serving small and unmappable requests.
+    Mapping mMappings[MAX_MAPPINGS];            ///< Table of live mappings, searched on free.
+    uint32_t mMappingCount;                     ///< Number of live mappings in the table.
+};
+
+
+THERON_FORCEINLINE HugePageAllocator::HugePageAllocator() :
+  mSpinLock(),
+  mFallbackAllocator(0),
+  mMappingCount(0)
+{
+}
+
+
+inline HugePageAllocator::~HugePageAllocator()
+{
+#if defined(THERON_POSIX)
+
+    for (uint32_t index = 0; index < mMappingCount; ++index)
+    {
+        munmap(mMappings[index].mMemory, mMappings[index].mSize);
+    }
+
+#endif // defined(THERON_POSIX)
+}
+
+
+THERON_FORCEINLINE void HugePageAllocator::SetFallbackAllocator(IAllocator *const fallbackAllocator)
+{
+    THERON_ASSERT(fallbackAllocator);
+    mFallbackAllocator = fallbackAllocator;
+}
+
+
+inline void *HugePageAllocator::Allocate(const SizeType size)
+{
+    THERON_ASSERT(mFallbackAllocator);
+
+    if (size >= HUGE_PAGE_SIZE)
+    {
+        void *const mapped(AllocateMapped(size));
+        if (mapped)
+        {
+            return mapped;
+        }
+    }
+
+    return mFallbackAllocator->Allocate(size);
+}
+
+
+inline void *HugePageAllocator::AllocateAligned(const SizeType size, const SizeType alignment)
+{
+    THERON_ASSERT(mFallbackAllocator);
+
+    // Mappings are naturally aligned to the huge page size, which satisfies
+    // any smaller power-of-two alignment.
+    if (size >= HUGE_PAGE_SIZE && alignment <= HUGE_PAGE_SIZE)
+    {
+        void *const mapped(AllocateMapped(size));
+        if (mapped)
+        {
+            return mapped;
+        }
+    }
+
+    return mFallbackAllocator->AllocateAligned(size, alignment);
+}
+
+
+inline void HugePageAllocator::Free(void *const memory)
+{
+#if defined(THERON_POSIX)
+
+    mSpinLock.Lock();
+
+    for (uint32_t index = 0; index < mMappingCount; ++index)
+    {
+        if (mMappings[index].mMemory == memory)
+        {
+            const SizeType mappedSize(mMappings[index].mSize);
+
+            // Remove the mapping from the table by overwriting it with the last entry.
+            mMappings[index] = mMappings[--mMappingCount];
+            mSpinLock.Unlock();
+
+            munmap(memory, mappedSize);
+            return;
+        }
+    }
+
+    mSpinLock.Unlock();
+
+#endif // defined(THERON_POSIX)
+
+    mFallbackAllocator->Free(memory);
+}
+
+
+inline void HugePageAllocator::Free(void *const memory, const SizeType size)
+{
+#if defined(THERON_POSIX)
+
+    if (size >= HUGE_PAGE_SIZE)
+    {
+        mSpinLock.Lock();
+
+        for (uint32_t index = 0; index < mMappingCount; ++index)
+        {
+            if (mMappings[index].mMemory == memory)
+            {
+                const SizeType mappedSize(mMappings[index].mSize);
+
+                // Remove the mapping from the table by overwriting it with the last entry.
+                mMappings[index] = mMappings[--mMappingCount];
+                mSpinLock.Unlock();
+
+                munmap(memory, mappedSize);
+                return;
+            }
+        }
+
+        mSpinLock.Unlock();
+    }
+
+#endif // defined(THERON_POSIX)
+
+    mFallbackAllocator->Free(memory, size);
+}
+
+
+inline void *HugePageAllocator::AllocateMapped(const SizeType size)
+{
+#if defined(THERON_POSIX)
+
+    // Round the request up to a whole number of huge pages.
+    const SizeType mappedSize((size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+
+    void *mapped(MAP_FAILED);
+
+#if defined(MAP_HUGETLB)
+
+    // Try an explicitly huge-page-backed mapping first, which requires huge
+    // pages to have been pre-configured on the system.
+    mapped = mmap(
+        0,
+        mappedSize,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+        -1,
+        0);
+
+#endif // defined(MAP_HUGETLB)
+
+    if (mapped == MAP_FAILED)
+    {
+        // Fall back to an ordinary anonymous mapping, advised for transparent
+        // huge page promotion by the kernel where supported.
+        mapped = mmap(
+            0,
+            mappedSize,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0);
+
+#if defined(MADV_HUGEPAGE)
+
+        if (mapped != MAP_FAILED)
+        {
+            madvise(mapped, mappedSize, MADV_HUGEPAGE);
+        }
+
+#endif // defined(MADV_HUGEPAGE)
+    }
+
+    if (mapped == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    // Record the mapping so it can be recognized and unmapped on free. If the
+    // table is full the mapping is released and the request falls back to the
+    // wrapped allocator.
+    mSpinLock.Lock();
+
+    if (mMappingCount == MAX_MAPPINGS)
+    {
+        mSpinLock.Unlock();
+
+        munmap(mapped, mappedSize);
+        return 0;
+    }
+
+    mMappings[mMappingCount].mMemory = mapped;
+    mMappings[mMappingCount].mSize = mappedSize;
+    ++mMappingCount;
+
+    mSpinLock.Unlock();
+    return mapped;
+
+#else
+
+    (void) size;
+    return 0;
+
+#endif // defined(THERON_POSIX)
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_HUGEPAGEALLOCATOR_H
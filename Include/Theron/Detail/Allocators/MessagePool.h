@@ -0,0 +1,224 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_MESSAGEPOOL_H
+#define THERON_DETAIL_ALLOCATORS_MESSAGEPOOL_H
+
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Traits template indicating whether a message type has a dedicated block pool.
+
+The default implementation declares no pool, so unpooled message types pay
+nothing. Specializations generated by \ref THERON_DECLARE_POOLED_MESSAGE
+declare a pool, causing message allocation for the type to bypass the general
+message caches in favour of a per-type freelist.
+
+\tparam ValueType The message type for which the traits are defined.
+\see THERON_DECLARE_POOLED_MESSAGE
+*/
+template <class ValueType>
+struct MessagePoolTraits
+{
+    /**
+    \brief Indicates whether the message type has a dedicated block pool.
+    */
+    static const bool HAS_POOL = false;
+};
+
+
+/**
+\brief Global registry of dedicated block pools for registered message types.
+
+Each pooled message type owns a freelist of message blocks of its exact size,
+indexed directly by the type's dense integer ID, so allocating a message of a
+pooled type is a freelist pop under a per-type lock rather than a size lookup
+in the general message caches. All blocks originate from the general
+allocator, so a pool is purely a cache: blocks freed into a full pool, and
+allocations from an empty one, fall through to the general allocator.
+*/
+class MessagePool
+{
+public:
+
+    /**
+    Number of message type IDs that can have dedicated pools.
+    Type IDs are assigned densely from one, so this bounds the number of
+    registered message types in the application, pooled or not; pools
+    requested for types with IDs beyond the bound are silently ignored.
+    */
+    static const uint32_t MAX_POOLED_TYPES = 256;
+
+    /**
+    Number of blocks retained per pool until overridden with \ref SetDepth.
+    */
+    static const uint32_t DEFAULT_MAX_BLOCKS = 64;
+
+    /**
+    Registers a pool for the message type with the given ID and block geometry.
+    \note Called during static initialization by \ref THERON_DEFINE_POOLED_MESSAGE.
+    */
+    static void Register(const uint32_t typeId, const uint32_t blockSize, const uint32_t blockAlignment);
+
+    /**
+    Sets the number of blocks retained by the pool of the given message type,
+    and preallocates the pool to that depth.
+    */
+    static void SetDepth(const uint32_t typeId, const uint32_t maxBlocks);
+
+    /**
+    Saves the configuration and fill levels of the registered pools to a
+    compact binary file, from which \ref Load can preheat the pools of a
+    restarted process.
+    \return True, if the file was written successfully.
+    */
+    static bool Save(const char *const path);
+
+    /**
+    Loads pool configuration and fill levels previously written by \ref Save,
+    restoring the configured depth of each matching pool and preallocating it
+    to its saved fill level.
+
+    Pools are matched by type ID and block size. Type IDs are assigned in
+    static initialization order, so they are stable across restarts of the
+    same binary; records whose ID or block size don't match any registered
+    pool -- because the binary changed -- are silently skipped.
+
+    \return True, if the file was read successfully.
+    */
+    static bool Load(const char *const path);
+
+    /**
+    Allocates a message block for the pooled message type with the given ID.
+    \return A block of the registered size and alignment, or zero on failure.
+    */
+    THERON_FORCEINLINE static void *Allocate(const uint32_t typeId)
+    {
+        if (typeId >= MAX_POOLED_TYPES)
+        {
+            return 0;
+        }
+
+        Entry &entry(smEntries[typeId]);
+        if (entry.mBlockSize == 0)
+        {
+            return 0;
+        }
+
+        entry.mLock.Lock();
+
+        void *const block(entry.mHead);
+        if (block)
+        {
+            entry.mHead = *reinterpret_cast<void **>(block);
+            --entry.mBlockCount;
+
+            entry.mLock.Unlock();
+            return block;
+        }
+
+        entry.mLock.Unlock();
+
+        // The pool is empty, so fall through to the general allocator.
+        return AllocatorManager::Instance().GetAllocator()->AllocateAligned(
+            entry.mBlockSize,
+            entry.mBlockAlignment);
+    }
+
+    /**
+    Returns a message block to the pool of the message type with the given ID.
+    \return True, if the type has a pool and the block was consumed by it.
+    \note Blocks of sizes other than the pooled block size are rejected. Shared
+    broadcast messages carry the type ID of their value type but are allocated
+    in combined blocks of a different geometry, so can't be recycled by the pool.
+    */
+    THERON_FORCEINLINE static bool Free(const uint32_t typeId, void *const block, const uint32_t blockSize)
+    {
+        if (typeId >= MAX_POOLED_TYPES)
+        {
+            return false;
+        }
+
+        Entry &entry(smEntries[typeId]);
+        if (entry.mBlockSize != blockSize)
+        {
+            return false;
+        }
+
+        entry.mLock.Lock();
+
+        if (entry.mBlockCount < entry.mMaxBlocks)
+        {
+            *reinterpret_cast<void **>(block) = entry.mHead;
+            entry.mHead = block;
+            ++entry.mBlockCount;
+
+            entry.mLock.Unlock();
+            return true;
+        }
+
+        entry.mLock.Unlock();
+
+        // The pool is full, so return the surplus block to the general allocator.
+        AllocatorManager::Instance().GetAllocator()->Free(block, entry.mBlockSize);
+        return true;
+    }
+
+private:
+
+    /**
+    A per-type pool: a freelist of identically-sized message blocks.
+    */
+    struct Entry
+    {
+        SpinLock mLock;                 ///< Protects the freelist of this pool.
+        void *mHead;                    ///< Head of the freelist of available blocks.
+        uint32_t mBlockSize;            ///< Size of the pooled blocks; zero if the type has no pool.
+        uint32_t mBlockAlignment;       ///< Alignment of the pooled blocks.
+        uint32_t mBlockCount;           ///< Number of blocks currently in the freelist.
+        uint32_t mMaxBlocks;            ///< Maximum number of blocks retained in the freelist.
+    };
+
+    MessagePool();
+    MessagePool(const MessagePool &other);
+    MessagePool &operator=(const MessagePool &other);
+
+    static Entry smEntries[MAX_POOLED_TYPES];   ///< Pools indexed by dense message type ID.
+};
+
+
+/**
+\brief Helper whose construction registers a message type pool during static initialization.
+\see THERON_DEFINE_POOLED_MESSAGE
+*/
+class MessagePoolRegistrar
+{
+public:
+
+    inline MessagePoolRegistrar(const uint32_t typeId, const uint32_t blockSize, const uint32_t blockAlignment)
+    {
+        // A zero ID means the type wasn't registered before the pool was defined;
+        // THERON_DEFINE_POOLED_MESSAGE must follow THERON_DEFINE_REGISTERED_MESSAGE.
+        THERON_ASSERT(typeId);
+        MessagePool::Register(typeId, blockSize, blockAlignment);
+    }
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_MESSAGEPOOL_H
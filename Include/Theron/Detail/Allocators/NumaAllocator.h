@@ -0,0 +1,401 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_ALLOCATORS_NUMAALLOCATOR_H
+#define THERON_DETAIL_ALLOCATORS_NUMAALLOCATOR_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief An allocator that allocates memory local to a preferred NUMA node.
+
+On NUMA (Non-Uniform Memory Architecture) systems, memory serviced by the
+memory controller of a distant processor node is slower to access than memory
+serviced by the local node. This allocator serves allocations from arenas of
+node-local memory, so that the mailboxes and message blocks touched by the
+worker threads of a framework are local to the node those threads run on.
+
+Small allocations are carved from node-local chunks and recycled via internal
+free lists binned by size. Larger allocations, such as mailbox pages, are
+allocated node-locally with page granularity. On systems without NUMA support,
+or when the node mask doesn't identify a valid node, all requests are simply
+passed through to the wrapped fallback allocator.
+
+\note The preferred node is the lowest node enabled in the node mask, which is
+expected to match the node affinity of the owning framework's worker threads.
+*/
+class NumaAllocator : public IAllocator
+{
+public:
+
+    /**
+    Constructor.
+    \param fallbackAllocator Pointer to a general allocator wrapped by this allocator.
+    \param nodeMask Bitfield mask identifying the NUMA nodes used by the owning framework.
+    */
+    inline NumaAllocator(IAllocator *const fallbackAllocator, const uint32_t nodeMask);
+
+    /**
+    Virtual destructor.
+    Frees the node-local chunks backing the arena. Any small blocks still cached
+    in the free list bins are carved from the chunks, so aren't freed individually.
+    */
+    inline virtual ~NumaAllocator();
+
+    /**
+    Allocates a block of contiguous memory, preferring node-local memory.
+    \param size The size of the memory block to allocate, in bytes.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *Allocate(const SizeType size);
+
+    /**
+    Allocates a block of contiguous memory aligned to a given byte-multiple boundary,
+    preferring node-local memory.
+    \param size The size of the memory block to allocate, in bytes.
+    \param alignment The alignment of the memory to allocate, in bytes, which must be a power of two.
+    \return A pointer to the allocated memory.
+    */
+    inline virtual void *AllocateAligned(const SizeType size, const SizeType alignment);
+
+    /**
+    Frees a previously allocated block of contiguous memory.
+    \note Blocks allocated by this allocator must be freed with an explicit size,
+    using the other overload. This overload is only legal when NUMA support is
+    unavailable and the allocator is acting as a simple pass-through.
+    \param memory Pointer to the memory to be deallocated.
+    */
+    inline virtual void Free(void *const memory);
+
+    /**
+    Frees a previously allocated block of contiguous memory of a known size.
+    \param memory Pointer to the memory to be deallocated.
+    \param size The size of the freed memory block.
+    */
+    inline virtual void Free(void *const memory, const SizeType size);
+
+private:
+
+    /**
+    Size in bytes of the node-local chunks from which small allocations are carved.
+    */
+    static const uint32_t CHUNK_SIZE = 64 * 1024;
+
+    /**
+    Largest allocation size served from the arena chunks.
+    Larger allocations are allocated node-locally with page granularity.
+    */
+    static const uint32_t MAX_ARENA_BLOCK_SIZE = 1024;
+
+    /**
+    Number of free list bins; one per multiple of the cache line size.
+    */
+    static const uint32_t BIN_COUNT = MAX_ARENA_BLOCK_SIZE / THERON_CACHELINE_ALIGNMENT;
+
+    /**
+    A free memory block in one of the size-binned free lists.
+    */
+    struct FreeBlock
+    {
+        FreeBlock *mNext;           ///< Pointer to the next free block in the same bin.
+    };
+
+    /**
+    Header linking the node-local chunks backing the arena, stored at the start of each chunk.
+    */
+    struct Chunk
+    {
+        Chunk *mNext;               ///< Pointer to the next chunk in the list.
+    };
+
+    /**
+    Header describing a large allocation, stored immediately before the caller block.
+    */
+    struct BlockHeader
+    {
+        void *mBase;                ///< Address of the underlying allocation.
+        uint32_t mSize;             ///< Total size in bytes of the underlying allocation.
+        uint32_t mNodeLocal;        ///< Non-zero if the block was allocated node-locally.
+    };
+
+    NumaAllocator(const NumaAllocator &other);
+    NumaAllocator &operator=(const NumaAllocator &other);
+
+    /**
+    Allocates a small block from the free list bins or the current arena chunk.
+    */
+    inline void *AllocateArenaBlock(const uint32_t size, const uint32_t alignment);
+
+    /**
+    Allocates a large block node-locally with page granularity.
+    */
+    inline void *AllocateLargeBlock(const uint32_t size, const uint32_t alignment);
+
+    mutable SpinLock mSpinLock;     ///< Synchronization object protecting the arena and free lists.
+    IAllocator *const mFallback;    ///< Pointer to a wrapped general allocator.
+    uint32_t mNode;                 ///< The preferred NUMA node.
+    bool mEnabled;                  ///< Whether node-local allocation is available and enabled.
+    Chunk *mChunks;                 ///< List of node-local chunks backing the arena.
+    uint8_t *mBump;                 ///< Position of the next unallocated byte in the current chunk.
+    uint8_t *mBumpEnd;              ///< End of the current chunk.
+    FreeBlock *mBins[BIN_COUNT];    ///< Free lists of recycled small blocks, binned by size.
+};
+
+
+inline NumaAllocator::NumaAllocator(IAllocator *const fallbackAllocator, const uint32_t nodeMask) :
+  mSpinLock(),
+  mFallback(fallbackAllocator),
+  mNode(0),
+  mEnabled(false),
+  mChunks(0),
+  mBump(0),
+  mBumpEnd(0)
+{
+    THERON_ASSERT(fallbackAllocator);
+
+    for (uint32_t bin = 0; bin < BIN_COUNT; ++bin)
+    {
+        mBins[bin] = 0;
+    }
+
+    // Node-local allocation only pays off on systems with more than one node.
+    // The preferred node is the lowest node enabled in the mask, matching the
+    // node to which the framework's worker threads are affinitized first.
+    uint32_t nodeCount(0);
+    if (nodeMask != 0 && Utils::GetNodeCount(nodeCount) && nodeCount > 1)
+    {
+        uint32_t node(0);
+        while ((nodeMask & (1UL << node)) == 0)
+        {
+            ++node;
+        }
+
+        if (node < nodeCount)
+        {
+            mNode = node;
+            mEnabled = true;
+        }
+    }
+}
+
+
+inline NumaAllocator::~NumaAllocator()
+{
+    // Free the node-local chunks backing the arena.
+    Chunk *chunk(mChunks);
+    while (chunk)
+    {
+        Chunk *const next(chunk->mNext);
+        Utils::FreeOnNode(chunk, CHUNK_SIZE);
+        chunk = next;
+    }
+}
+
+
+inline void *NumaAllocator::Allocate(const SizeType size)
+{
+    if (!mEnabled)
+    {
+        return mFallback->Allocate(size);
+    }
+
+    if (size <= MAX_ARENA_BLOCK_SIZE)
+    {
+        return AllocateArenaBlock(size, THERON_CACHELINE_ALIGNMENT);
+    }
+
+    return AllocateLargeBlock(size, THERON_CACHELINE_ALIGNMENT);
+}
+
+
+inline void *NumaAllocator::AllocateAligned(const SizeType size, const SizeType alignment)
+{
+    // Alignment values are expected to be powers of two.
+    THERON_ASSERT(alignment);
+    THERON_ASSERT((alignment & (alignment - 1)) == 0);
+
+    if (!mEnabled)
+    {
+        return mFallback->AllocateAligned(size, alignment);
+    }
+
+    if (size <= MAX_ARENA_BLOCK_SIZE)
+    {
+        return AllocateArenaBlock(size, alignment);
+    }
+
+    return AllocateLargeBlock(size, alignment);
+}
+
+
+inline void NumaAllocator::Free(void *const memory)
+{
+    if (!mEnabled)
+    {
+        mFallback->Free(memory);
+        return;
+    }
+
+    // The size of the block isn't known, so we can't tell whether it was carved
+    // from the arena. Internal callers always free message and mailbox memory
+    // with an explicit size, so this is never reached in practice. The block is
+    // deliberately leaked rather than corrupting the arena or the fallback heap.
+    THERON_FAIL_MSG("NumaAllocator requires sized frees");
+}
+
+
+inline void NumaAllocator::Free(void *const memory, const SizeType size)
+{
+    THERON_ASSERT(memory);
+
+    if (!mEnabled)
+    {
+        mFallback->Free(memory, size);
+        return;
+    }
+
+    if (size <= MAX_ARENA_BLOCK_SIZE)
+    {
+        // Push the block onto the free list bin for its size, for reuse.
+        // All small blocks are allocated at sizes rounded up to the bin size,
+        // so it's safe to reuse them for any allocation that maps to the same bin.
+        const uint32_t roundedSize((size + THERON_CACHELINE_ALIGNMENT - 1) & ~(THERON_CACHELINE_ALIGNMENT - 1));
+        const uint32_t bin(roundedSize / THERON_CACHELINE_ALIGNMENT - 1);
+
+        FreeBlock *const freeBlock(reinterpret_cast<FreeBlock *>(memory));
+
+        mSpinLock.Lock();
+        freeBlock->mNext = mBins[bin];
+        mBins[bin] = freeBlock;
+        mSpinLock.Unlock();
+
+        return;
+    }
+
+    // Large blocks carry a header recording the underlying allocation.
+    const BlockHeader *const header(reinterpret_cast<const BlockHeader *>(
+        reinterpret_cast<uint8_t *>(memory) - sizeof(BlockHeader)));
+
+    if (header->mNodeLocal)
+    {
+        Utils::FreeOnNode(header->mBase, header->mSize);
+    }
+    else
+    {
+        mFallback->Free(header->mBase, header->mSize);
+    }
+}
+
+
+THERON_FORCEINLINE void *NumaAllocator::AllocateArenaBlock(const uint32_t size, const uint32_t alignment)
+{
+    // Round the size up to a whole number of cache lines and find the matching bin.
+    // All blocks in a bin are interchangeable because they were allocated at the bin size.
+    const uint32_t roundedSize((size + THERON_CACHELINE_ALIGNMENT - 1) & ~(THERON_CACHELINE_ALIGNMENT - 1));
+    const uint32_t bin(roundedSize / THERON_CACHELINE_ALIGNMENT - 1);
+
+    // Arena blocks are naturally aligned to cache line boundaries; requests for
+    // larger alignments bypass the bins and are carved at an aligned position.
+    const uint32_t effectiveAlignment(alignment > THERON_CACHELINE_ALIGNMENT ? alignment : THERON_CACHELINE_ALIGNMENT);
+
+    mSpinLock.Lock();
+
+    if (effectiveAlignment == THERON_CACHELINE_ALIGNMENT && mBins[bin])
+    {
+        FreeBlock *const freeBlock(mBins[bin]);
+        mBins[bin] = freeBlock->mNext;
+
+        mSpinLock.Unlock();
+        return freeBlock;
+    }
+
+    // Carve the block from the current chunk, aligning the bump position first.
+    uint8_t *alignedBump(reinterpret_cast<uint8_t *>(
+        (reinterpret_cast<uintptr_t>(mBump) + effectiveAlignment - 1) & ~static_cast<uintptr_t>(effectiveAlignment - 1)));
+
+    if (alignedBump + roundedSize > mBumpEnd)
+    {
+        // The current chunk is exhausted; allocate a new node-local chunk.
+        void *const chunkMemory(Utils::AllocateOnNode(mNode, CHUNK_SIZE));
+        if (chunkMemory == 0)
+        {
+            mSpinLock.Unlock();
+
+            // Node-local allocation failed, so fall back to the general allocator.
+            // Blocks allocated this way are recycled through the bins like arena
+            // blocks, at the cost of not being returned to the fallback allocator
+            // until the process terminates.
+            return mFallback->AllocateAligned(roundedSize, effectiveAlignment);
+        }
+
+        Chunk *const chunk(reinterpret_cast<Chunk *>(chunkMemory));
+        chunk->mNext = mChunks;
+        mChunks = chunk;
+
+        // The bump position starts a cache line into the chunk, after the chunk header.
+        mBump = reinterpret_cast<uint8_t *>(chunkMemory) + THERON_CACHELINE_ALIGNMENT;
+        mBumpEnd = reinterpret_cast<uint8_t *>(chunkMemory) + CHUNK_SIZE;
+
+        alignedBump = reinterpret_cast<uint8_t *>(
+            (reinterpret_cast<uintptr_t>(mBump) + effectiveAlignment - 1) & ~static_cast<uintptr_t>(effectiveAlignment - 1));
+    }
+
+    mBump = alignedBump + roundedSize;
+
+    mSpinLock.Unlock();
+    return alignedBump;
+}
+
+
+THERON_FORCEINLINE void *NumaAllocator::AllocateLargeBlock(const uint32_t size, const uint32_t alignment)
+{
+    // The caller block is offset from the underlying allocation to make room for
+    // the header while preserving the requested alignment. Node-local allocations
+    // are page-aligned, so the offset caller block is aligned too.
+    const uint32_t offset(alignment > THERON_CACHELINE_ALIGNMENT ? alignment : THERON_CACHELINE_ALIGNMENT);
+    const uint32_t totalSize(offset + size);
+
+    uint32_t nodeLocal(1);
+    uint8_t *base(reinterpret_cast<uint8_t *>(Utils::AllocateOnNode(mNode, totalSize)));
+
+    if (base == 0)
+    {
+        // Node-local allocation failed, so fall back to the general allocator.
+        base = reinterpret_cast<uint8_t *>(mFallback->AllocateAligned(totalSize, offset));
+        nodeLocal = 0;
+    }
+
+    if (base == 0)
+    {
+        return 0;
+    }
+
+    uint8_t *const memory(base + offset);
+
+    // Record the underlying allocation in a header before the caller block.
+    BlockHeader *const header(reinterpret_cast<BlockHeader *>(memory - sizeof(BlockHeader)));
+    header->mBase = base;
+    header->mSize = totalSize;
+    header->mNodeLocal = nodeLocal;
+
+    return memory;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_ALLOCATORS_NUMAALLOCATOR_H
@@ -50,22 +50,65 @@ public:
     inline bool Empty() const;
 
     /**
-    Adds a memory block to the pool.
+    Returns the number of memory blocks currently cached in the pool.
     */
-    inline bool Add(void *memory);
+    inline uint32_t BlockCount() const;
+
+    /**
+    Returns the maximum number of memory blocks cached in the pool.
+    */
+    inline uint32_t MaxBlocks() const;
 
     /**
-    Retrieves a memory block from the pool with the given alignment.
-    \return Zero if no suitable blocks in pool.
+    Sets the maximum number of memory blocks cached in the pool.
+    Blocks added once the pool holds this many are rejected by \ref Add.
+    \note Doesn't release surplus blocks already cached; the caller trims those.
     */
-    inline void *FetchAligned(const uint32_t alignment);
+    inline void SetMaxBlocks(const uint32_t maxBlocks);
 
     /**
-    Retrieves a memory block from the pool with any alignment.
+    Adds a memory block to the pool.
+    */
+    inline bool Add(void *memory);
+
+    /**
+    Retrieves a memory block from the pool.
+    Callers segregate blocks into pools by size and alignment, so every block
+    in a pool is interchangeable and retrieval is an unconditional head pop.
     \return Zero if no blocks in pool.
     */
     inline void *Fetch();
 
+    /**
+    Marks the pool as recently used, deferring maintenance trimming.
+    */
+    inline void Touch();
+
+    /**
+    Returns whether the pool has been touched since the flag was last cleared, clearing it.
+    */
+    inline bool CheckAndClearHot();
+
+    /**
+    Counts an allocation served from the pool, for statistics reports.
+    */
+    inline void CountHit();
+
+    /**
+    Counts an allocation of the pool's block size that found the pool empty.
+    */
+    inline void CountMiss();
+
+    /**
+    Returns the number of allocations served from the pool.
+    */
+    inline uint64_t Hits() const;
+
+    /**
+    Returns the number of allocations of the pool's block size that found the pool empty.
+    */
+    inline uint64_t Misses() const;
+
 private:
 
     /**
@@ -81,11 +124,15 @@ private:
         Node *mNext;                        ///< Pointer to next node in a list.
     };
 
-    static const uint32_t MAX_BLOCKS = 16;  ///< Maximum number of memory blocks stored per pool.
+    static const uint32_t DEFAULT_MAX_BLOCKS = 16;  ///< Default maximum number of memory blocks stored per pool.
 
     mutable LockType mLock;                 ///< Synchronization primitive for thread-safe access to state.
     Node mHead;                             ///< Dummy node at head of a linked list of nodes in the pool.
     uint32_t mBlockCount;                   ///< Number of blocks currently cached in the pool.
+    uint32_t mMaxBlocks;                    ///< Maximum number of blocks cached before blocks are rejected.
+    bool mHot;                              ///< Whether the pool has been used since the last maintenance pass.
+    uint64_t mHits;                         ///< Number of allocations served from the pool.
+    uint64_t mMisses;                       ///< Number of allocations of the pool's block size that found it empty.
 
 } THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
 
@@ -94,7 +141,11 @@ template <class LockType>
 THERON_FORCEINLINE Pool<LockType>::Pool() :
   mLock(),
   mHead(),
-  mBlockCount(0)
+  mBlockCount(0),
+  mMaxBlocks(DEFAULT_MAX_BLOCKS),
+  mHot(false),
+  mHits(0),
+  mMisses(0)
 {
 }
 
@@ -121,6 +172,27 @@ THERON_FORCEINLINE bool Pool<LockType>::Empty() const
 }
 
 
+template <class LockType>
+THERON_FORCEINLINE uint32_t Pool<LockType>::BlockCount() const
+{
+    return mBlockCount;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE uint32_t Pool<LockType>::MaxBlocks() const
+{
+    return mMaxBlocks;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE void Pool<LockType>::SetMaxBlocks(const uint32_t maxBlocks)
+{
+    mMaxBlocks = maxBlocks;
+}
+
+
 template <class LockType>
 THERON_FORCEINLINE bool Pool<LockType>::Add(void *const memory)
 {
@@ -130,7 +202,7 @@ THERON_FORCEINLINE bool Pool<LockType>::Add(void *const memory)
     Node *const node(reinterpret_cast<Node *>(memory));
 
     // Below maximum block count limit?
-    if (mBlockCount < MAX_BLOCKS)
+    if (mBlockCount < mMaxBlocks)
     {
         node->mNext = mHead.mNext;
         mHead.mNext = node;
@@ -142,37 +214,6 @@ THERON_FORCEINLINE bool Pool<LockType>::Add(void *const memory)
 }
 
 
-template <class LockType>
-THERON_FORCEINLINE void *Pool<LockType>::FetchAligned(const uint32_t alignment)
-{
-    Node *previous(&mHead);
-    const uint32_t alignmentMask(alignment - 1);
-
-    // Search the block list.
-    Node *node(mHead.mNext);
-    while (node)
-    {
-        // Prefetch.
-        Node *const next(node->mNext);
-
-        // This is THERON_ALIGNED with the alignment mask calculated outside the loop.
-        if ((reinterpret_cast<uintptr_t>(node) & alignmentMask) == 0)
-        {
-            // Remove from list and return as block.
-            previous->mNext = next;
-            --mBlockCount;
-            return reinterpret_cast<void *>(node);
-        }
-
-        previous = node;
-        node = next;
-    }
-
-    // Zero result indicates no correctly aligned block available.
-    return 0;
-}
-
-
 template <class LockType>
 THERON_FORCEINLINE void *Pool<LockType>::Fetch()
 {
@@ -185,11 +226,55 @@ THERON_FORCEINLINE void *Pool<LockType>::Fetch()
         return reinterpret_cast<void *>(node);
     }
 
-    // Zero result indicates no correctly aligned block available.
+    // Zero result indicates no block available.
     return 0;
 }
 
 
+template <class LockType>
+THERON_FORCEINLINE void Pool<LockType>::Touch()
+{
+    mHot = true;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE bool Pool<LockType>::CheckAndClearHot()
+{
+    const bool hot(mHot);
+    mHot = false;
+    return hot;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE void Pool<LockType>::CountHit()
+{
+    ++mHits;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE void Pool<LockType>::CountMiss()
+{
+    ++mMisses;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE uint64_t Pool<LockType>::Hits() const
+{
+    return mHits;
+}
+
+
+template <class LockType>
+THERON_FORCEINLINE uint64_t Pool<LockType>::Misses() const
+{
+    return mMisses;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -0,0 +1,259 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_CONTAINERS_INLINEVECTOR_H
+#define THERON_DETAIL_CONTAINERS_INLINEVECTOR_H
+
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Class template implementing a growable array with inline storage for small sizes.
+
+Unlike \ref List, the items are stored contiguously by value, so traversals walk
+sequential memory rather than chasing per-node heap pointers. Collections that
+stay at or below the inline capacity (the common case for handler sets) never
+touch the heap at all. The item type is expected to be a simple value such as a
+pointer, copyable by plain assignment.
+*/
+template <class ItemType, uint32_t INLINE_CAPACITY = 8>
+class InlineVector
+{
+public:
+
+    /**
+    Constructor
+    */
+    inline InlineVector();
+
+    /**
+    Destructor
+    */
+    inline ~InlineVector();
+
+    /**
+    Returns the number of items currently in the vector.
+    */
+    inline uint32_t Size() const;
+
+    /**
+    Returns true if there are no items currently in the vector.
+    */
+    inline bool Empty() const;
+
+    /**
+    Empties the vector, removing all previously inserted items.
+    \note The items themselves are owned by the caller and aren't freed.
+    */
+    inline void Clear();
+
+    /**
+    Adds an item at the end of the vector. The item is copied by assignment.
+    No checking for duplicates is performed.
+    \return False if memory for expanded storage couldn't be allocated.
+    */
+    inline bool Insert(const ItemType &item);
+
+    /**
+    Removes the first occurrence of the given item from the vector, if present.
+    The items after it are shuffled down, preserving their order.
+    \return True if the item was present and successfully removed, otherwise false.
+    \note This method searches the vector!
+    */
+    inline bool Remove(const ItemType &item);
+
+    /**
+    Discards items from the end of the vector, reducing its size to the given count.
+    \note The discarded items are owned by the caller and aren't freed.
+    */
+    inline void Truncate(const uint32_t size);
+
+    /**
+    Returns a reference to the item at the given index.
+    */
+    inline ItemType &operator[](const uint32_t index);
+
+    /**
+    Returns a const-reference to the item at the given index.
+    */
+    inline const ItemType &operator[](const uint32_t index) const;
+
+    /**
+    Returns a reference to the first item in the vector.
+    */
+    inline ItemType &Front() const;
+
+private:
+
+    InlineVector(const InlineVector &other);
+    InlineVector &operator=(const InlineVector &other);
+
+    /**
+    Grows the heap-allocated storage to at least the given capacity.
+    This function is intentionally not force-inlined since growth is rare.
+    \return False if the expanded storage couldn't be allocated.
+    */
+    bool Grow(const uint32_t capacity);
+
+    ItemType mInlineItems[INLINE_CAPACITY];     ///< Inline storage used while the vector is small.
+    ItemType *mItems;                           ///< Pointer to the active storage, inline or heap-allocated.
+    uint32_t mCapacity;                         ///< Number of items the active storage can hold.
+    uint32_t mSize;                             ///< Number of items currently in the vector.
+};
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE InlineVector<ItemType, INLINE_CAPACITY>::InlineVector() :
+  mItems(mInlineItems),
+  mCapacity(INLINE_CAPACITY),
+  mSize(0)
+{
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE InlineVector<ItemType, INLINE_CAPACITY>::~InlineVector()
+{
+    // The vector doesn't own the items so only the storage is freed.
+    if (mItems != mInlineItems)
+    {
+        AllocatorManager::Instance().GetAllocator()->Free(mItems);
+    }
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE uint32_t InlineVector<ItemType, INLINE_CAPACITY>::Size() const
+{
+    return mSize;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE bool InlineVector<ItemType, INLINE_CAPACITY>::Empty() const
+{
+    return (mSize == 0);
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE void InlineVector<ItemType, INLINE_CAPACITY>::Clear()
+{
+    // Since the items are owned by the caller, we just forget about them.
+    mSize = 0;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE bool InlineVector<ItemType, INLINE_CAPACITY>::Insert(const ItemType &item)
+{
+    if (mSize == mCapacity)
+    {
+        if (!Grow(mCapacity + mCapacity))
+        {
+            return false;
+        }
+    }
+
+    mItems[mSize++] = item;
+    return true;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+inline bool InlineVector<ItemType, INLINE_CAPACITY>::Remove(const ItemType &item)
+{
+    for (uint32_t index = 0; index < mSize; ++index)
+    {
+        if (mItems[index] == item)
+        {
+            // Shuffle the items after it down over it, preserving their order.
+            --mSize;
+            for (uint32_t next = index; next < mSize; ++next)
+            {
+                mItems[next] = mItems[next + 1];
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE void InlineVector<ItemType, INLINE_CAPACITY>::Truncate(const uint32_t size)
+{
+    THERON_ASSERT(size <= mSize);
+    mSize = size;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE ItemType &InlineVector<ItemType, INLINE_CAPACITY>::operator[](const uint32_t index)
+{
+    THERON_ASSERT(index < mSize);
+    return mItems[index];
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE const ItemType &InlineVector<ItemType, INLINE_CAPACITY>::operator[](const uint32_t index) const
+{
+    THERON_ASSERT(index < mSize);
+    return mItems[index];
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE ItemType &InlineVector<ItemType, INLINE_CAPACITY>::Front() const
+{
+    THERON_ASSERT(mSize > 0);
+    return mItems[0];
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+inline bool InlineVector<ItemType, INLINE_CAPACITY>::Grow(const uint32_t capacity)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    ItemType *const items(reinterpret_cast<ItemType *>(allocator->Allocate(capacity * sizeof(ItemType))));
+    if (items == 0)
+    {
+        return false;
+    }
+
+    // Copy the existing items into the expanded storage.
+    for (uint32_t index = 0; index < mSize; ++index)
+    {
+        items[index] = mItems[index];
+    }
+
+    if (mItems != mInlineItems)
+    {
+        allocator->Free(mItems);
+    }
+
+    mItems = items;
+    mCapacity = capacity;
+
+    return true;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_CONTAINERS_INLINEVECTOR_H
@@ -0,0 +1,234 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_CONTAINERS_RINGQUEUE_H
+#define THERON_DETAIL_CONTAINERS_RINGQUEUE_H
+
+
+#include <new>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Class template implementing a FIFO queue backed by a contiguous ring buffer.
+
+Unlike \ref Queue, which is an intrusive linked list requiring every element
+to be a separately allocated node, the items are stored contiguously by value
+between a head index and a tail index. Queues that stay at or below the inline
+capacity (the common case for bounded consumers) never touch the heap at all;
+deeper queues grow their storage by doubling, so the per-item allocation of
+the linked queue is avoided entirely on push and pop.
+
+The items are owned by the queue: pushing copy-constructs the item into its
+slot and popping destructs it, so any items left in the queue when it is
+destructed are cleaned up.
+
+\note The inline storage is eight-byte aligned; item types with stricter
+alignment requirements should use \ref Queue instead.
+*/
+template <class ItemType, uint32_t INLINE_CAPACITY = 16>
+class RingQueue
+{
+public:
+
+    /**
+    Constructor
+    */
+    inline RingQueue();
+
+    /**
+    Destructor
+    */
+    inline ~RingQueue();
+
+    /**
+    Returns true if the queue contains no items.
+    */
+    inline bool Empty() const;
+
+    /**
+    Returns the number of items currently in the queue.
+    */
+    inline uint32_t Size() const;
+
+    /**
+    Pushes a copy of the given item onto the back of the queue.
+    \return False if memory for expanded storage couldn't be allocated.
+    */
+    inline bool Push(const ItemType &item);
+
+    /**
+    Returns a pointer to the item at the front of the queue without removing it.
+    \note Returns a null pointer if the queue is empty. The pointed-to item is
+    only valid until the queue is next modified.
+    */
+    inline ItemType *Front();
+
+    /**
+    Removes and destructs the item at the front of the queue.
+    \note The queue must not be empty.
+    */
+    inline void Pop();
+
+private:
+
+    RingQueue(const RingQueue &other);
+    RingQueue &operator=(const RingQueue &other);
+
+    /**
+    Grows the heap-allocated storage to the given capacity.
+    This function is intentionally not force-inlined since growth is rare.
+    \return False if the expanded storage couldn't be allocated.
+    */
+    bool Grow(const uint32_t capacity);
+
+    /**
+    Returns a pointer to the item slot with the given index.
+    */
+    THERON_FORCEINLINE ItemType *Slot(const uint32_t index)
+    {
+        return mItems + (index % mCapacity);
+    }
+
+    uint64_t mInlineStorage[(INLINE_CAPACITY * sizeof(ItemType) + 7) / 8];  ///< Inline storage used while the queue is shallow.
+    ItemType *mItems;                       ///< Pointer to the active storage, inline or heap-allocated.
+    uint32_t mCapacity;                     ///< Number of item slots in the active storage.
+    uint32_t mHead;                         ///< Index of the slot holding the item at the front of the queue.
+    uint32_t mCount;                        ///< Number of items currently in the queue.
+};
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE RingQueue<ItemType, INLINE_CAPACITY>::RingQueue() :
+  mItems(reinterpret_cast<ItemType *>(mInlineStorage)),
+  mCapacity(INLINE_CAPACITY),
+  mHead(0),
+  mCount(0)
+{
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE RingQueue<ItemType, INLINE_CAPACITY>::~RingQueue()
+{
+    // Destruct any items left in the queue, since the queue owns them.
+    while (mCount)
+    {
+        Pop();
+    }
+
+    if (mItems != reinterpret_cast<ItemType *>(mInlineStorage))
+    {
+        AllocatorManager::Instance().GetAllocator()->Free(mItems);
+    }
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE bool RingQueue<ItemType, INLINE_CAPACITY>::Empty() const
+{
+    return (mCount == 0);
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE uint32_t RingQueue<ItemType, INLINE_CAPACITY>::Size() const
+{
+    return mCount;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE bool RingQueue<ItemType, INLINE_CAPACITY>::Push(const ItemType &item)
+{
+    if (mCount == mCapacity)
+    {
+        if (!Grow(mCapacity + mCapacity))
+        {
+            return false;
+        }
+    }
+
+    // Copy-construct the item into the slot after the last occupied one.
+    new (Slot(mHead + mCount)) ItemType(item);
+    ++mCount;
+
+    return true;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE ItemType *RingQueue<ItemType, INLINE_CAPACITY>::Front()
+{
+    // It's legal to call Front when the queue is empty.
+    if (mCount)
+    {
+        return Slot(mHead);
+    }
+
+    return 0;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+THERON_FORCEINLINE void RingQueue<ItemType, INLINE_CAPACITY>::Pop()
+{
+    THERON_ASSERT(mCount);
+
+    Slot(mHead)->~ItemType();
+    mHead = (mHead + 1) % mCapacity;
+    --mCount;
+}
+
+
+template <class ItemType, uint32_t INLINE_CAPACITY>
+inline bool RingQueue<ItemType, INLINE_CAPACITY>::Grow(const uint32_t capacity)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    ItemType *const items(reinterpret_cast<ItemType *>(allocator->AllocateAligned(
+        capacity * sizeof(ItemType),
+        THERON_ALIGNOF(ItemType))));
+
+    if (items == 0)
+    {
+        return false;
+    }
+
+    // Move the queued items into the expanded storage, in queue order starting
+    // at slot zero, destructing the copies left behind in the old storage.
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        ItemType *const slot(Slot(mHead + index));
+        new (items + index) ItemType(*slot);
+        slot->~ItemType();
+    }
+
+    if (mItems != reinterpret_cast<ItemType *>(mInlineStorage))
+    {
+        allocator->Free(mItems);
+    }
+
+    mItems = items;
+    mCapacity = capacity;
+    mHead = 0;
+
+    return true;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_CONTAINERS_RINGQUEUE_H
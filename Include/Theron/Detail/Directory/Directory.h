@@ -1,164 +1,471 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_DIRECTORY_DIRECTORY_H
-#define THERON_DETAIL_DIRECTORY_DIRECTORY_H
-
-
-#include <new>
-
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Threading/SpinLock.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-A registry that maps unique indices to addressable entities.
-*/
-template <class EntryType>
-class Directory
-{
-public:
-
-    /**
-    Default constructor.
-    */
-    Directory();
-
-    /**
-    Destructor.
-    */
-    ~Directory();
-
-    /**
-    Finds and claims a free index for an entity.
-    */
-    uint32_t Allocate(uint32_t index = 0);
-
-    /**
-    Gets a reference to the entry with the given index.
-    The entry contains data about the entity (if any) registered at the index.
-    */
-    inline EntryType &GetEntry(const uint32_t index);
-
-private:
-
-    static const uint32_t ENTRIES_PER_PAGE = 1024;  ///< Number of entries in each allocated page (power of two!).
-    static const uint32_t MAX_PAGES = 1024;         ///< Maximum number of allocated pages.
-
-    struct Page
-    {
-        EntryType mEntries[ENTRIES_PER_PAGE];       ///< Array of entries making up this page.
-    };
-
-    Directory(const Directory &other);
-    Directory &operator=(const Directory &other);
-
-    mutable SpinLock mSpinLock;                     ///< Ensures thread-safe access to the instance data.
-    uint32_t mNextIndex;                            ///< Auto-incremented index to use for next registered entity.
-    Page *mPages[MAX_PAGES];                        ///< Pointers to allocated pages.
-};
-
-
-template <class EntryType>
-inline Directory<EntryType>::Directory() :
-  mSpinLock(),
-  mNextIndex(0)
-{
-    // Clear the page table.
-    for (uint32_t page = 0; page < MAX_PAGES; ++page)
-    {
-        mPages[page] = 0;
-    }
-}
-
-
-template <class EntryType>
-inline Directory<EntryType>::~Directory()
-{
-    IAllocator *const pageAllocator(AllocatorManager::Instance().GetAllocator());
-
-    // Free all pages that were allocated.
-    for (uint32_t page = 0; page < MAX_PAGES; ++page)
-    {
-        if (mPages[page])
-        {
-            // Destruct and free.
-            mPages[page]->~Page();
-            pageAllocator->Free(mPages[page], sizeof(Page));            
-        }
-    }
-}
-
-
-template <class EntryType>
-inline uint32_t Directory<EntryType>::Allocate(uint32_t index)
-{
-    mSpinLock.Lock();
-
-    // Auto-allocate an index if none was specified.
-    if (index == 0)
-    {
-        // TODO: Avoid in-use indices and re-use freed ones.
-        // Skip index zero as it's reserved for use as the null address.
-        if (++mNextIndex == MAX_PAGES * ENTRIES_PER_PAGE)
-        {
-            mNextIndex = 1;
-        }
-
-        index = mNextIndex;
-    }
-
-    // Allocate the page if it hasn't been allocated already.
-    const uint32_t page(index / ENTRIES_PER_PAGE);
-    if (mPages[page] == 0)
-    {
-        IAllocator *const pageAllocator(AllocatorManager::Instance().GetAllocator());
-        void *const pageMemory(pageAllocator->AllocateAligned(sizeof(Page), THERON_CACHELINE_ALIGNMENT));
-
-        if (pageMemory)
-        {
-            mPages[page] = new (pageMemory) Page();
-        }
-        else
-        {
-            THERON_FAIL_MSG("Out of memory");
-        }
-    }
-
-    mSpinLock.Unlock();
-
-    return index;
-}
-
-
-template <class EntryType>
-THERON_FORCEINLINE EntryType &Directory<EntryType>::GetEntry(const uint32_t index)
-{
-    // Compute the page and offset.
-    // TODO: Use a mask?
-    const uint32_t page(index / ENTRIES_PER_PAGE);
-    const uint32_t offset(index % ENTRIES_PER_PAGE);
-
-    THERON_ASSERT(page < MAX_PAGES);
-    THERON_ASSERT(offset < ENTRIES_PER_PAGE);
-    THERON_ASSERT(mPages[page]);
-
-    return mPages[page]->mEntries[offset];
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_DIRECTORY_DIRECTORY_H
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_DIRECTORY_DIRECTORY_H
+#define THERON_DETAIL_DIRECTORY_DIRECTORY_H
+
+
+#include <new>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Thread.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A registry that maps unique indices to addressable entities.
+
+Lookups of registered entries are wait-free: the page table holds atomically
+published page pointers, so readers never take a lock and never spin. Page
+pointers are only ever written once (pages are never freed until destruction),
+so a non-zero pointer read by \ref GetEntry is always valid. Index allocation
+is lock-free, and the lock guarding lazy page allocation is sharded by page so
+that concurrent registrations in different pages don't contend.
+*/
+template <class EntryType>
+class Directory
+{
+public:
+
+    /**
+    Default constructor.
+    */
+    Directory();
+
+    /**
+    Destructor.
+    */
+    ~Directory();
+
+    /**
+    Sets the allocator used to allocate the directory's pages.
+    By default pages are allocated with the general allocator; frameworks on
+    NUMA systems use this to make their mailbox pages node-local.
+    \note Must be called before any entries are allocated.
+    */
+    inline void SetAllocator(IAllocator *const pageAllocator);
+
+    /**
+    Preallocates the pages covering the given number of entries.
+    Pages are normally allocated lazily, by the registration that first claims
+    an index within them, so registering entities in a fresh directory pays a
+    page allocation every \ref ENTRIES_PER_PAGE registrations. Reserving the
+    expected entry count up front moves those allocations out of the
+    registration path entirely.
+    \param count Number of entries to preallocate pages for.
+    */
+    void Reserve(const uint32_t count);
+
+    /**
+    Finds and claims a free index for an entity.
+    */
+    uint32_t Allocate(uint32_t index = 0);
+
+    /**
+    Claims a contiguous range of indices in one operation.
+    The range is claimed with a single atomic update of the index counter, and
+    the pages covering it are allocated with one lock acquisition per page,
+    rather than one claim and one lock check per entry, so bulk registrations
+    scale with the number of pages touched instead of the number of entries.
+    \param count Number of contiguous indices to claim.
+    \return The first index of the claimed range.
+    */
+    uint32_t AllocateRange(const uint32_t count);
+
+    /**
+    Gets a reference to the entry with the given index.
+    The entry contains data about the entity (if any) registered at the index.
+    */
+    inline EntryType &GetEntry(const uint32_t index);
+
+    /**
+    Gets a pointer to the entry with the given index, or zero if the page
+    holding it hasn't been allocated. Safe to call for unallocated indices,
+    so usable to scan the directory.
+    */
+    inline EntryType *TryGetEntry(const uint32_t index);
+
+    /**
+    Returns an upper bound on the indices allocated so far.
+    \note A snapshot; concurrent allocations may raise the bound immediately.
+    */
+    THERON_FORCEINLINE uint32_t GetIndexLimit() const
+    {
+        return mNextIndex.Load();
+    }
+
+    /**
+    Destructs and frees all allocated pages, leaving the directory empty.
+    Destructing a page runs the destructors of all its entries, so tearing
+    down a directory of hundreds of thousands of entries page by page takes
+    seconds. When the directory is large enough to pay for them, the page
+    range is split across short-lived helper threads, each destructing and
+    freeing a contiguous range of pages; small directories are torn down
+    serially on the calling thread.
+    \param threadCount Hint for the number of helper threads to use.
+    \note Not thread-safe; callable only when no other thread accesses the
+    directory, as during teardown of the owning object.
+    */
+    void Teardown(const uint32_t threadCount);
+
+    /**
+    Abandons all allocated pages without destructing or freeing them.
+    The pages, and anything their entries reference, are leaked. Intended
+    for process-exit paths where the operating system reclaims the memory
+    anyway and running per-entry destructors would just delay the exit.
+    */
+    void Leak();
+
+private:
+
+    static const uint32_t ENTRIES_PER_PAGE = 1024;  ///< Number of entries in each allocated page (power of two!).
+    static const uint32_t MAX_PAGES = 1024;         ///< Maximum number of allocated pages.
+    static const uint32_t LOCK_SHARDS = 16;         ///< Number of sharded page allocation locks (power of two!).
+
+    static const uint32_t MAX_TEARDOWN_THREADS = 8; ///< Maximum number of helper threads used by parallel teardown.
+    static const uint32_t PAGES_PER_TEARDOWN_THREAD = 8;    ///< Minimum allocated pages per helper thread for parallel teardown to pay.
+
+    struct Page
+    {
+        EntryType mEntries[ENTRIES_PER_PAGE];       ///< Array of entries making up this page.
+    };
+
+    /**
+    A contiguous range of the page table assigned to one teardown helper thread.
+    */
+    struct TeardownRange
+    {
+        Directory *mDirectory;                      ///< The directory being torn down.
+        uint32_t mBeginPage;                        ///< First page of the range.
+        uint32_t mEndPage;                          ///< One past the last page of the range.
+        Thread mThread;                             ///< Helper thread destructing the range.
+    };
+
+    Directory(const Directory &other);
+    Directory &operator=(const Directory &other);
+
+    /**
+    Allocates and publishes the page with the given index, if it hasn't been
+    allocated already, under the shard lock covering it.
+    */
+    void AllocatePage(const uint32_t page);
+
+    /**
+    Destructs and frees the allocated pages in the given range, zeroing their
+    published pointers.
+    */
+    void TeardownPages(const uint32_t beginPage, const uint32_t endPage);
+
+    /**
+    Entry point function executed by the teardown helper threads.
+    */
+    static void TeardownThreadEntryPoint(void *const context);
+
+    mutable SpinLock mShardLocks[LOCK_SHARDS];      ///< Sharded locks serializing lazy page allocation, indexed by page.
+    IAllocator *mPageAllocator;                     ///< Allocator used to allocate and free the pages.
+    Atomic::UInt32 mNextIndex;                      ///< Auto-incremented index to use for next registered entity.
+    Atomic::Pointer mPages[MAX_PAGES];              ///< Atomically published pointers to allocated pages.
+};
+
+
+template <class EntryType>
+inline Directory<EntryType>::Directory() :
+  mPageAllocator(AllocatorManager::Instance().GetAllocator()),
+  mNextIndex(0)
+{
+    // The page table pointers are zero-initialized by their constructors.
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::SetAllocator(IAllocator *const pageAllocator)
+{
+    THERON_ASSERT(pageAllocator);
+    mPageAllocator = pageAllocator;
+}
+
+
+template <class EntryType>
+inline Directory<EntryType>::~Directory()
+{
+    // Free any pages not already torn down by an explicit Teardown or Leak.
+    TeardownPages(0, MAX_PAGES);
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::Teardown(const uint32_t threadCount)
+{
+    // Count the allocated pages to decide whether parallel teardown pays.
+    uint32_t pageCount(0);
+    for (uint32_t page = 0; page < MAX_PAGES; ++page)
+    {
+        if (mPages[page].Load())
+        {
+            ++pageCount;
+        }
+    }
+
+    // Tear down small directories serially; starting and joining the helper
+    // threads would cost more than the page destructors they'd run.
+    uint32_t numThreads(pageCount / PAGES_PER_TEARDOWN_THREAD);
+    numThreads = (numThreads < threadCount) ? numThreads : threadCount;
+    numThreads = (numThreads < MAX_TEARDOWN_THREADS) ? numThreads : MAX_TEARDOWN_THREADS;
+
+    if (numThreads < 2)
+    {
+        TeardownPages(0, MAX_PAGES);
+        return;
+    }
+
+    // Partition the page table into contiguous ranges, one per helper thread.
+    // Unallocated pages are skipped cheaply, so an even split of the table is
+    // an even enough split of the work.
+    TeardownRange ranges[MAX_TEARDOWN_THREADS];
+    const uint32_t pagesPerThread(MAX_PAGES / numThreads);
+
+    for (uint32_t thread = 0; thread < numThreads; ++thread)
+    {
+        TeardownRange &range(ranges[thread]);
+
+        range.mDirectory = this;
+        range.mBeginPage = thread * pagesPerThread;
+        range.mEndPage = (thread + 1 == numThreads) ? MAX_PAGES : range.mBeginPage + pagesPerThread;
+
+        // If a helper thread can't be started, tear its range down inline.
+        if (!range.mThread.Start(TeardownThreadEntryPoint, &range))
+        {
+            TeardownPages(range.mBeginPage, range.mEndPage);
+            range.mBeginPage = range.mEndPage;
+        }
+    }
+
+    for (uint32_t thread = 0; thread < numThreads; ++thread)
+    {
+        if (ranges[thread].mBeginPage < ranges[thread].mEndPage)
+        {
+            ranges[thread].mThread.Join();
+        }
+    }
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::Leak()
+{
+    // Abandon the pages; the published pointers are zeroed so the destructor
+    // doesn't free them later.
+    for (uint32_t page = 0; page < MAX_PAGES; ++page)
+    {
+        mPages[page].Store(0);
+    }
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::TeardownPages(const uint32_t beginPage, const uint32_t endPage)
+{
+    // The page allocator is thread-safe, so concurrent ranges can free to it.
+    IAllocator *const pageAllocator(mPageAllocator);
+
+    for (uint32_t page = beginPage; page < endPage; ++page)
+    {
+        Page *const pageMemory(reinterpret_cast<Page *>(mPages[page].Load()));
+        if (pageMemory)
+        {
+            // Destruct and free.
+            pageMemory->~Page();
+            pageAllocator->Free(pageMemory, sizeof(Page));
+
+            mPages[page].Store(0);
+        }
+    }
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::TeardownThreadEntryPoint(void *const context)
+{
+    // The static entry point function is passed its page range as context.
+    TeardownRange *const range(reinterpret_cast<TeardownRange *>(context));
+    range->mDirectory->TeardownPages(range->mBeginPage, range->mEndPage);
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::Reserve(const uint32_t count)
+{
+    THERON_ASSERT(count < MAX_PAGES * ENTRIES_PER_PAGE);
+
+    // Allocate the pages covering indices up to the count. Index zero is
+    // reserved, so count entries occupy indices [1, count].
+    const uint32_t lastPage(count / ENTRIES_PER_PAGE);
+    for (uint32_t page = 0; page <= lastPage; ++page)
+    {
+        if (mPages[page].Load() == 0)
+        {
+            AllocatePage(page);
+        }
+    }
+}
+
+
+template <class EntryType>
+inline uint32_t Directory<EntryType>::Allocate(uint32_t index)
+{
+    // Auto-allocate an index if none was specified.
+    if (index == 0)
+    {
+        // TODO: Avoid in-use indices and re-use freed ones.
+        // Claim the next index with a lock-free compare-and-swap loop.
+        // Skip index zero as it's reserved for use as the null address.
+        uint32_t currentValue(mNextIndex.Load());
+        uint32_t nextValue(0);
+
+        do
+        {
+            nextValue = currentValue + 1;
+            if (nextValue == MAX_PAGES * ENTRIES_PER_PAGE)
+            {
+                nextValue = 1;
+            }
+        }
+        while (!mNextIndex.CompareExchangeAcquire(currentValue, nextValue));
+
+        index = nextValue;
+    }
+
+    // Allocate the page if it hasn't been allocated already.
+    // Page pointers are written at most once, so a non-zero read needs no lock.
+    const uint32_t page(index / ENTRIES_PER_PAGE);
+    if (mPages[page].Load() == 0)
+    {
+        AllocatePage(page);
+    }
+
+    return index;
+}
+
+
+template <class EntryType>
+inline uint32_t Directory<EntryType>::AllocateRange(const uint32_t count)
+{
+    THERON_ASSERT(count > 0 && count < MAX_PAGES * ENTRIES_PER_PAGE);
+
+    // Claim the whole range with a single compare-and-swap of the index
+    // counter. Skip index zero as it's reserved for use as the null address,
+    // and restart from the bottom if the range would run off the end.
+    uint32_t currentValue(mNextIndex.Load());
+    uint32_t firstIndex(0);
+    uint32_t nextValue(0);
+
+    do
+    {
+        firstIndex = currentValue + 1;
+        if (firstIndex + count > MAX_PAGES * ENTRIES_PER_PAGE)
+        {
+            firstIndex = 1;
+        }
+
+        nextValue = firstIndex + count - 1;
+    }
+    while (!mNextIndex.CompareExchangeAcquire(currentValue, nextValue));
+
+    // Allocate the pages covering the range, checking each page once.
+    const uint32_t firstPage(firstIndex / ENTRIES_PER_PAGE);
+    const uint32_t lastPage((firstIndex + count - 1) / ENTRIES_PER_PAGE);
+
+    for (uint32_t page = firstPage; page <= lastPage; ++page)
+    {
+        if (mPages[page].Load() == 0)
+        {
+            AllocatePage(page);
+        }
+    }
+
+    return firstIndex;
+}
+
+
+template <class EntryType>
+inline void Directory<EntryType>::AllocatePage(const uint32_t page)
+{
+    // Lock the shard covering this page and re-check, in case another
+    // thread allocated the page while we were acquiring the lock.
+    SpinLock &shardLock(mShardLocks[page & (LOCK_SHARDS - 1)]);
+    shardLock.Lock();
+
+    if (mPages[page].Load() == 0)
+    {
+        IAllocator *const pageAllocator(mPageAllocator);
+        void *const pageMemory(pageAllocator->AllocateAligned(sizeof(Page), THERON_CACHELINE_ALIGNMENT));
+
+        if (pageMemory)
+        {
+            // The atomic store publishes the constructed page to lock-free readers.
+            mPages[page].Store(new (pageMemory) Page());
+        }
+        else
+        {
+            THERON_FAIL_MSG("Out of memory");
+        }
+    }
+
+    shardLock.Unlock();
+}
+
+
+template <class EntryType>
+THERON_FORCEINLINE EntryType &Directory<EntryType>::GetEntry(const uint32_t index)
+{
+    // Compute the page and offset.
+    // TODO: Use a mask?
+    const uint32_t page(index / ENTRIES_PER_PAGE);
+    const uint32_t offset(index % ENTRIES_PER_PAGE);
+
+    THERON_ASSERT(page < MAX_PAGES);
+    THERON_ASSERT(offset < ENTRIES_PER_PAGE);
+
+    Page *const pageMemory(reinterpret_cast<Page *>(mPages[page].Load()));
+    THERON_ASSERT(pageMemory);
+
+    return pageMemory->mEntries[offset];
+}
+
+
+template <class EntryType>
+THERON_FORCEINLINE EntryType *Directory<EntryType>::TryGetEntry(const uint32_t index)
+{
+    const uint32_t page(index / ENTRIES_PER_PAGE);
+    const uint32_t offset(index % ENTRIES_PER_PAGE);
+
+    THERON_ASSERT(page < MAX_PAGES);
+    THERON_ASSERT(offset < ENTRIES_PER_PAGE);
+
+    // The page may not have been allocated yet, for example when an index was
+    // claimed by a concurrent registration that hasn't published the page.
+    Page *const pageMemory(reinterpret_cast<Page *>(mPages[page].Load()));
+    if (pageMemory == 0)
+    {
+        return 0;
+    }
+
+    return &pageMemory->mEntries[offset];
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_DIRECTORY_DIRECTORY_H
@@ -0,0 +1,114 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_DIRECTORY_FRAMEWORKCACHE_H
+#define THERON_DETAIL_DIRECTORY_FRAMEWORKCACHE_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+class Framework;
+
+
+namespace Detail
+{
+
+
+/**
+A small direct-mapped cache of resolved framework directory lookups.
+
+Messages addressed to actors in other frameworks of the local process resolve
+the destination framework through its \ref StaticDirectory entry on every
+message, locking the entry twice to pin it across the delivery. Each processor
+context owns one of these caches, so steady-state cross-framework sends from
+worker threads reuse the resolved pointer, validated against the directory
+generation inside a lock-free read guard instead of pinning the entry.
+Deregistration changes the generation, so a cached pointer can never outlive
+the destruction of its framework.
+
+\note Accessed only by the thread that owns the enclosing context, so the
+cache needs no synchronization.
+
+\see StaticDirectory::GetGeneration
+*/
+class FrameworkCache
+{
+public:
+
+    /**
+    Number of cached entries; indices hashing to the same slot evict one another.
+    */
+    static const uint32_t SIZE = 8;
+
+    /**
+    Default constructor.
+    */
+    inline FrameworkCache() : mEntries()
+    {
+    }
+
+    /**
+    Tries to resolve the given framework index from the cache.
+    \param frameworkIndex The directory index of the framework to be resolved.
+    \param generation The current generation of the directory being shadowed.
+    \return The cached framework pointer, or zero on a miss.
+    */
+    THERON_FORCEINLINE Framework *Get(const uint32_t frameworkIndex, const uint32_t generation) const
+    {
+        const Entry &entry(mEntries[frameworkIndex & (SIZE - 1)]);
+
+        if (entry.mGeneration == generation && entry.mIndex == frameworkIndex)
+        {
+            return entry.mFramework;
+        }
+
+        return 0;
+    }
+
+    /**
+    Caches a resolved framework pointer for the given framework index.
+    \param frameworkIndex The directory index the framework is registered at.
+    \param generation The generation of the directory when the pointer was resolved.
+    \param framework The framework registered at the index.
+    */
+    THERON_FORCEINLINE void Store(const uint32_t frameworkIndex, const uint32_t generation, Framework *const framework)
+    {
+        Entry &entry(mEntries[frameworkIndex & (SIZE - 1)]);
+
+        entry.mIndex = frameworkIndex;
+        entry.mGeneration = generation;
+        entry.mFramework = framework;
+    }
+
+private:
+
+    /**
+    A cached resolution of one framework index.
+    */
+    struct Entry
+    {
+        THERON_FORCEINLINE Entry() : mIndex(0), mGeneration(0), mFramework(0)
+        {
+        }
+
+        uint32_t mIndex;        ///< The directory index the framework is registered at.
+        uint32_t mGeneration;   ///< Generation of the directory when the pointer was resolved.
+        Framework *mFramework;  ///< The framework registered at the index.
+    };
+
+    FrameworkCache(const FrameworkCache &other);
+    FrameworkCache &operator=(const FrameworkCache &other);
+
+    Entry mEntries[SIZE];       ///< Direct-mapped cache slots.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_DIRECTORY_FRAMEWORKCACHE_H
@@ -1,160 +1,288 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
-#define THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
-
-
-#include <new>
-
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Directory/Directory.h>
-#include <Theron/Detail/Directory/Entry.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-Static class template that manages a reference-counted directory singleton.
-*/
-template <class Entity>
-class StaticDirectory
-{
-public:
-
-    /**
-    Registers an entity and returns its allocated index.
-    */
-    static uint32_t Register(Entry::Entity *const entity);
-
-    /**
-    Deregisters a previously registered entity.
-    */
-    static void Deregister(const uint32_t index);
-
-    /**
-    Gets a reference to the entry with the given index.
-    The entry contains data about the entity (if any) registered at the index.
-    */
-    inline static Entry &GetEntry(const uint32_t index);
-
-private:
-
-    typedef Directory<Entry> DirectoryType;
-
-    static DirectoryType *smDirectory;          ///< Pointer to the allocated instance.
-    static SpinLock smSpinLock;                 ///< SpinLock object protecting access.
-    static uint32_t smReferenceCount;           ///< Counts the number of entities registered.
-};
-
-
-template <class Entity>
-typename StaticDirectory<Entity>::DirectoryType *StaticDirectory<Entity>::smDirectory = 0;
-
-template <class Entity>
-SpinLock StaticDirectory<Entity>::smSpinLock;
-
-template <class Entity>
-uint32_t StaticDirectory<Entity>::smReferenceCount = 0;
-
-
-template <class Entity>
-uint32_t StaticDirectory<Entity>::Register(Entry::Entity *const entity)
-{
-    smSpinLock.Lock();
-
-    // Create the singleton instance if this is the first reference.
-    if (smReferenceCount++ == 0)
-    {
-        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-        void *const memory(allocator->AllocateAligned(sizeof(DirectoryType), THERON_CACHELINE_ALIGNMENT));
-
-        if (memory == 0)
-        {
-            return 0;
-        }
-
-        smDirectory = new (memory) DirectoryType();
-    }
-
-    THERON_ASSERT(smDirectory);
-
-    const uint32_t index(smDirectory->Allocate());
-
-    // Set up the entry.
-    if (index)
-    {
-        Entry &entry(smDirectory->GetEntry(index));
-        entry.Lock();
-        entry.SetEntity(entity);
-        entry.Unlock();
-    }
-
-    smSpinLock.Unlock();
-
-    return index;
-}
-
-
-template <class Entity>
-void StaticDirectory<Entity>::Deregister(const uint32_t index)
-{
-    smSpinLock.Lock();
-
-    THERON_ASSERT(smDirectory);
-    THERON_ASSERT(index);
-
-    // Clear the entry.
-    // If the entry is pinned then we have to wait for it to be unpinned.
-    Entry &entry(smDirectory->GetEntry(index));
-
-    bool deregistered(false);
-    while (!deregistered)
-    {
-        entry.Lock();
-
-        if (!entry.IsPinned())
-        {
-            entry.Free();
-            deregistered = true;
-        }
-
-        entry.Unlock();
-    }
-
-    // Destroy the singleton instance if this was the last reference.
-    if (--smReferenceCount == 0)
-    {
-        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-        smDirectory->~DirectoryType();
-        allocator->Free(smDirectory, sizeof(DirectoryType));
-    }
-
-    smSpinLock.Unlock();
-}
-
-
-template <class Entity>
-THERON_FORCEINLINE Entry &StaticDirectory<Entity>::GetEntry(const uint32_t index)
-{
-    THERON_ASSERT(smDirectory);
-    THERON_ASSERT(index);
-
-    return smDirectory->GetEntry(index);
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
+#define THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
+
+
+#include <new>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Directory/Directory.h>
+#include <Theron/Detail/Directory/Entry.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Static class template that manages a reference-counted directory singleton.
+
+Registration and deregistration are mostly lock-free: index allocation and
+entry lookup are handled by the lock-free \ref Directory, and the reference
+count pinning the singleton alive is maintained with atomic operations. The
+static spinlock is only taken on the transitions that create and destroy the
+singleton instance, so concurrent registration of entities (for example
+short-lived Receiver objects constructed on many threads) scales instead of
+serializing on a single lock.
+*/
+template <class Entity>
+class StaticDirectory
+{
+public:
+
+    /**
+    Registers an entity and returns its allocated index.
+    */
+    static uint32_t Register(Entry::Entity *const entity);
+
+    /**
+    Deregisters a previously registered entity.
+    */
+    static void Deregister(const uint32_t index);
+
+    /**
+    Gets a reference to the entry with the given index.
+    The entry contains data about the entity (if any) registered at the index.
+    */
+    inline static Entry &GetEntry(const uint32_t index);
+
+    /**
+    Returns the generation of the directory, incremented on every deregistration.
+
+    The generation supports caching of resolved entity pointers outside the
+    directory: an entity pointer resolved while the generation held some value
+    is still registered for as long as the generation still holds that value,
+    since any deregistration would have changed it.
+    */
+    inline static uint32_t GetGeneration();
+
+    /**
+    Takes a read guard against the directory, without locking any entry.
+
+    While any read guard is held, deregistrations block before invalidating
+    their entries, so an entity pointer whose registration is proven by a
+    \ref GetGeneration check made inside the guard can safely be used until
+    the guard is released with \ref EndRead. Guards are expected to be held
+    only briefly, since deregistering threads busy-wait on them.
+    */
+    inline static void BeginRead();
+
+    /**
+    Releases a read guard taken with \ref BeginRead.
+    */
+    inline static void EndRead();
+
+private:
+
+    typedef Directory<Entry> DirectoryType;
+
+    /**
+    Takes a reference to the singleton, creating it if no references exist.
+    \return Pointer to the referenced instance, or zero on out-of-memory.
+    */
+    inline static DirectoryType *Reference();
+
+    static Atomic::Pointer smDirectory;         ///< Atomically published pointer to the allocated instance.
+    static SpinLock smSpinLock;                 ///< SpinLock serializing creation and destruction of the instance.
+    static Atomic::UInt32 smReferenceCount;     ///< Counts the number of entities registered.
+    static Atomic::UInt32 smGeneration;         ///< Incremented on every deregistration; validates cached resolutions.
+    static Atomic::UInt32 smReadCount;          ///< Counts read guards currently held against the directory.
+};
+
+
+template <class Entity>
+Atomic::Pointer StaticDirectory<Entity>::smDirectory;
+
+template <class Entity>
+SpinLock StaticDirectory<Entity>::smSpinLock;
+
+template <class Entity>
+Atomic::UInt32 StaticDirectory<Entity>::smReferenceCount;
+
+template <class Entity>
+Atomic::UInt32 StaticDirectory<Entity>::smGeneration;
+
+template <class Entity>
+Atomic::UInt32 StaticDirectory<Entity>::smReadCount;
+
+
+template <class Entity>
+typename StaticDirectory<Entity>::DirectoryType *StaticDirectory<Entity>::Reference()
+{
+    // Fast path: while references exist the singleton can't be destroyed, so
+    // raising a non-zero count with a compare-and-swap safely pins it alive
+    // without taking the lock.
+    uint32_t currentCount(smReferenceCount.Load());
+    while (currentCount != 0)
+    {
+        if (smReferenceCount.CompareExchangeAcquire(currentCount, currentCount + 1))
+        {
+            return reinterpret_cast<DirectoryType *>(smDirectory.Load());
+        }
+    }
+
+    // Slow path: no references existed, so the singleton may need to be
+    // created -- or may be being destroyed by the releaser of the last
+    // reference. The lock serializes us against both.
+    smSpinLock.Lock();
+
+    if (smDirectory.Load() == 0)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->AllocateAligned(sizeof(DirectoryType), THERON_CACHELINE_ALIGNMENT));
+
+        if (memory == 0)
+        {
+            smSpinLock.Unlock();
+            return 0;
+        }
+
+        smDirectory.Store(new (memory) DirectoryType());
+    }
+
+    // The increment is made under the lock so a concurrent releaser of the
+    // last reference can't see a zero count once we've committed to this
+    // instance.
+    smReferenceCount.Increment();
+
+    DirectoryType *const directory(reinterpret_cast<DirectoryType *>(smDirectory.Load()));
+    smSpinLock.Unlock();
+
+    return directory;
+}
+
+
+template <class Entity>
+uint32_t StaticDirectory<Entity>::Register(Entry::Entity *const entity)
+{
+    DirectoryType *const directory(Reference());
+    if (directory == 0)
+    {
+        return 0;
+    }
+
+    // Index allocation within the directory is lock-free.
+    const uint32_t index(directory->Allocate());
+
+    // Set up the entry. The per-entry lock only serializes us against
+    // concurrent users of this one entry.
+    if (index)
+    {
+        Entry &entry(directory->GetEntry(index));
+        entry.Lock();
+        entry.SetEntity(entity);
+        entry.Unlock();
+    }
+
+    return index;
+}
+
+
+template <class Entity>
+void StaticDirectory<Entity>::Deregister(const uint32_t index)
+{
+    DirectoryType *const directory(reinterpret_cast<DirectoryType *>(smDirectory.Load()));
+
+    THERON_ASSERT(directory);
+    THERON_ASSERT(index);
+
+    // Invalidate cached resolutions of directory entries, then wait for read
+    // guards taken before the invalidation to drain. Guards taken after it
+    // can no longer validate a cached pointer against the old generation, so
+    // once existing guards drain no reader can be using the entity through a
+    // cache. Guards are held only across individual message deliveries, so
+    // the wait is short.
+    smGeneration.Increment();
+
+    while (smReadCount.Load() != 0)
+    {
+    }
+
+    // Clear the entry, holding only its own lock.
+    // If the entry is pinned then we have to wait for it to be unpinned.
+    Entry &entry(directory->GetEntry(index));
+
+    bool deregistered(false);
+    while (!deregistered)
+    {
+        entry.Lock();
+
+        if (!entry.IsPinned())
+        {
+            entry.Free();
+            deregistered = true;
+        }
+
+        entry.Unlock();
+    }
+
+    // Destroy the singleton instance if this was the last reference. The
+    // re-check under the lock closes the race with a registering thread that
+    // took the slow path and re-referenced the instance after our decrement.
+    if (smReferenceCount.FetchDecrement() == 1)
+    {
+        smSpinLock.Lock();
+
+        if (smReferenceCount.Load() == 0 && smDirectory.Load() != 0)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+            DirectoryType *const instance(reinterpret_cast<DirectoryType *>(smDirectory.Load()));
+            smDirectory.Store(0);
+
+            instance->~DirectoryType();
+            allocator->Free(instance, sizeof(DirectoryType));
+        }
+
+        smSpinLock.Unlock();
+    }
+}
+
+
+template <class Entity>
+THERON_FORCEINLINE Entry &StaticDirectory<Entity>::GetEntry(const uint32_t index)
+{
+    DirectoryType *const directory(reinterpret_cast<DirectoryType *>(smDirectory.Load()));
+
+    THERON_ASSERT(directory);
+    THERON_ASSERT(index);
+
+    return directory->GetEntry(index);
+}
+
+
+template <class Entity>
+THERON_FORCEINLINE uint32_t StaticDirectory<Entity>::GetGeneration()
+{
+    return smGeneration.Load();
+}
+
+
+template <class Entity>
+THERON_FORCEINLINE void StaticDirectory<Entity>::BeginRead()
+{
+    smReadCount.Increment();
+}
+
+
+template <class Entity>
+THERON_FORCEINLINE void StaticDirectory<Entity>::EndRead()
+{
+    smReadCount.Decrement();
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_DIRECTORY_STATICDIRECTORY_H
@@ -0,0 +1,131 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_HANDLERS_CALLABLEMESSAGEHANDLER_H
+#define THERON_DETAIL_HANDLERS_CALLABLEMESSAGEHANDLER_H
+
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Handlers/IMessageHandler.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageCast.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+namespace Detail
+{
+
+
+/**
+Instantiable class template that remembers a callable message handler -- a
+lambda, function object or free function pointer -- and the type of message
+it accepts. The callable is stored by value inline in the handler object, so
+registration costs one handler allocation like a member function handler,
+with no separate type-erased function wrapper on the dispatch path; dispatch
+is a single virtual call that invokes the callable directly.
+
+Because the callable is specific to the handler object rather than shared
+across a class, captured state makes per-instance specialized handlers
+possible without trampoline methods on the actor class.
+
+\tparam ValueType The type of message handled by this message handler.
+\tparam CallableType The type of the stored callable, invocable with
+(const ValueType &message, const Address from).
+*/
+template <class ValueType, class CallableType>
+class CallableMessageHandler : public IMessageHandler
+{
+public:
+
+    /**
+    Constructor. Copies the given callable into the handler object.
+    */
+    inline explicit CallableMessageHandler(const CallableType &callable) :
+      mNullFunction(0),
+      mCallable(callable)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~CallableMessageHandler()
+    {
+    }
+
+    /**
+    Returns the unique name of the message type handled by this handler.
+    */
+    inline virtual const char *GetMessageTypeName() const
+    {
+        return MessageTraits<ValueType>::TYPE_NAME;
+    }
+
+    /**
+    Returns the dense integer ID of the message type handled by this handler.
+    */
+    inline virtual uint32_t GetMessageTypeId() const
+    {
+        return MessageTraits<ValueType>::TYPE_ID;
+    }
+
+    /**
+    Handles the given message, if it's of the type accepted by the handler.
+    \return True, if the handler handled the message.
+    \note The message is not consumed by the handler; just acted on or ignored.
+    The message will be automatically destroyed when all handlers have seen it.
+    */
+    inline virtual bool Handle(Actor *const actor, const IMessage *const message) const
+    {
+        typedef MessageCast<MessageTraits<ValueType>::HAS_TYPE_NAME> MessageCaster;
+
+        THERON_ASSERT(actor);
+        THERON_ASSERT(message);
+
+        // Try to convert the message, of unknown type, to message of the assumed type.
+        const Message<ValueType> *const typedMessage = MessageCaster:: template CastMessage<ValueType>(message);
+        if (typedMessage)
+        {
+            // Invoke the callable, passing it the message value and from address.
+            // Messages are dispatched to an actor by one thread at a time, so
+            // stateful callables (such as mutable lambdas) are safe to mutate.
+            mCallable(typedMessage->Value(), typedMessage->From());
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+
+    CallableMessageHandler(const CallableMessageHandler &other);
+    CallableMessageHandler &operator=(const CallableMessageHandler &other);
+
+    /**
+    Never-matching placeholder occupying the slot where member function
+    handlers store their function pointer. Removal and lookup of member
+    function handlers compare that slot through a name-based handler cast
+    that can't distinguish handler kinds; keeping a null pointer at the
+    compared offset makes those comparisons fail deterministically for
+    callable handlers, rather than reinterpreting the callable's bytes.
+    */
+    void (CallableMessageHandler::*mNullFunction)(const ValueType &message, const Address from);
+
+    mutable CallableType mCallable;     ///< The stored callable, owned by the handler object.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_HANDLERS_CALLABLEMESSAGEHANDLER_H
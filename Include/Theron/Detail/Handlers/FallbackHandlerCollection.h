@@ -14,6 +14,7 @@
 #include <Theron/Detail/Handlers/BlindFallbackHandler.h>
 #include <Theron/Detail/Handlers/FallbackHandler.h>
 #include <Theron/Detail/Handlers/IFallbackHandler.h>
+#include <Theron/Detail/Handlers/ViewFallbackHandler.h>
 #include <Theron/Detail/Messages/IMessage.h>
 
 
@@ -56,6 +57,14 @@ public:
         ObjectType *const handlerObject,
         void (ObjectType::*handler)(const void *const data, const uint32_t size, const Address from));
 
+    /**
+    Sets the handler in the collection.
+    */
+    template <class ObjectType>
+    inline bool Set(
+        ObjectType *const handlerObject,
+        void (ObjectType::*handler)(const MessageView &view, const Address from));
+
     /**
     Removes any registered handler from the collection.
     */
@@ -156,6 +165,42 @@ inline bool FallbackHandlerCollection::Set(
 }
 
 
+template <class ObjectType>
+inline bool FallbackHandlerCollection::Set(
+    ObjectType *const handlerObject,
+    void (ObjectType::*handler)(const MessageView &view, const Address from))
+{
+    typedef ViewFallbackHandler<ObjectType> MessageHandlerType;
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    mHandlersDirty = true;
+
+    // Destroy any previously set new handler.
+    if (mNewHandler)
+    {
+        mNewHandler->~IFallbackHandler();
+        allocator->Free(mNewHandler);
+        mNewHandler = 0;
+    }
+
+    if (handlerObject && handler)
+    {
+        // Allocate memory for a message handler object.
+        void *const memory = allocator->Allocate(sizeof(MessageHandlerType));
+        if (memory == 0)
+        {
+            return false;
+        }
+
+        // Construct a handler object to remember the function pointer and message value type.
+        mNewHandler = new (memory) MessageHandlerType(handlerObject, handler);
+    }
+
+    return true;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
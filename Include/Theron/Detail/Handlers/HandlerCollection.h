@@ -1,284 +1,614 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
-#define THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
-
-
-#include <new>
-
-#include <Theron/Address.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Containers/List.h>
-#include <Theron/Detail/Handlers/IMessageHandler.h>
-#include <Theron/Detail/Handlers/MessageHandler.h>
-#include <Theron/Detail/Handlers/MessageHandlerCast.h>
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Messages/MessageTraits.h>
-
-
-namespace Theron
-{
-
-
-class Actor;
-
-
-namespace Detail
-{
-
-
-/**
-A collection of handlers for messages of different types.
-*/
-class HandlerCollection
-{
-public:
-
-    /**
-    Default constructor.
-    */
-    HandlerCollection();
-
-    /**
-    Destructor.
-    */
-    ~HandlerCollection();
-
-    /**
-    Adds a handler to the collection.
-    */
-    template <class ActorType, class ValueType>
-    bool Add(void (ActorType::*handler)(const ValueType &message, const Address from));
-
-    /**
-    Removes a handler from the collection, if it is present.
-    */
-    template <class ActorType, class ValueType>
-    bool Remove(void (ActorType::*handler)(const ValueType &message, const Address from));
-
-    /**
-    Returns true if the given handler is registered.
-    */
-    template <class ActorType, class ValueType>
-    bool Contains(void (ActorType::*handler)(const ValueType &message, const Address from)) const;
-
-    /**
-    Unregisters all registered handlers.
-    */
-    bool Clear();
-
-    /**
-    Handles the given message, passing it to each of the handlers in the collection.
-    \return True, if one or more of the handlers in the collection handled the message.
-    */
-    bool Handle(Actor *const actor, const IMessage *const message);
-
-private:
-
-    typedef List<IMessageHandler> MessageHandlerList;
-
-    HandlerCollection(const HandlerCollection &other);
-    HandlerCollection &operator=(const HandlerCollection &other);
-
-    /**
-    Updates the registered handlers with any changes made since the last message was processed.
-    \note This function is intentionally not force-inlined since the handlers don't usually change often.
-    */
-    void UpdateHandlers();
-
-    MessageHandlerList mHandlers;       ///< List of handlers in the collection.
-    MessageHandlerList mNewHandlers;    ///< List of handlers added since last update.
-    bool mHandlersDirty;                ///< Flag indicating that the handlers are out of date.
-};
-
-
-template <class ActorType, class ValueType>
-THERON_FORCEINLINE bool HandlerCollection::Add(void (ActorType::*handler)(const ValueType &message, const Address from))
-{
-    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
-
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    // Allocate memory for a message handler object.
-    void *const memory = allocator->Allocate(sizeof(MessageHandlerType));
-    if (memory == 0)
-    {
-        return false;
-    }
-
-    // Construct a handler object to remember the function pointer and message value type.
-    MessageHandlerType *const messageHandler = new (memory) MessageHandlerType(handler);
-
-    // We don't check for duplicates because multiple registrations of the same function are allowed.
-    mNewHandlers.Insert(messageHandler);
-    mHandlersDirty = true;
-
-    return true;
-}
-
-
-template <class ActorType, class ValueType>
-THERON_FORCEINLINE bool HandlerCollection::Remove(void (ActorType::*handler)(const ValueType &message, const Address from))
-{
-    // If the message value type has a valid (non-zero) type name defined for it,
-    // then we use explicit type names to match messages to handlers.
-    // The default value of zero indicates that no type name has been defined,
-    // in which case we rely on compiler-generated RTTI to identify message types.
-    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
-    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
-
-    // We don't need to lock this because only one thread can access it at a time.
-    // Find the handler in the registered handler list.
-    typename MessageHandlerList::Iterator handlers(mHandlers.GetIterator());
-    while (handlers.Next())
-    {
-        IMessageHandler *const messageHandler(handlers.Get());
-
-        // Try to convert this handler, of unknown type, to the target type.
-        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
-        {
-            // Don't count the handler if it's already marked for deregistration.
-            if (typedHandler->GetHandlerFunction() == handler && !typedHandler->IsMarked())
-            {
-                // Mark the handler for deregistration.
-                // We defer the actual deregistration and deletion until
-                // after all active message handlers have been executed, because
-                // message handlers themselves can deregister handlers.
-                messageHandler->Mark();
-                mHandlersDirty = true;
-
-                return true;
-            }
-        }
-    }
-
-    // The handler wasn't in the registered list, but maybe it's in the new handlers list.
-    // That can happen if the handler was only just registered prior to this in the same function.
-    // It's a bit weird to register a handler and then immediately deregister it, but legal.
-    handlers = mNewHandlers.GetIterator();
-    while (handlers.Next())
-    {
-        IMessageHandler *const messageHandler(handlers.Get());
-
-        // Try to convert this handler, of unknown type, to the target type.
-        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
-        {
-            // Don't count the handler if it's already marked for deregistration.
-            if (typedHandler->GetHandlerFunction() == handler && !typedHandler->IsMarked())
-            {
-                // Mark the handler for deregistration.
-                messageHandler->Mark();
-                mHandlersDirty = true;
-
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-
-template <class ActorType, class ValueType>
-THERON_FORCEINLINE bool HandlerCollection::Contains(void (ActorType::*handler)(const ValueType &message, const Address from)) const
-{
-    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
-    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
-
-    // Search for the handler in the registered handler list.
-    typename MessageHandlerList::Iterator handlers(mHandlers.GetIterator());
-    while (handlers.Next())
-    {
-        IMessageHandler *const messageHandler(handlers.Get());
-
-        // Try to convert this handler, of unknown type, to the target type.
-        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
-        {
-            // Count as not registered if it's marked for deregistration.
-            // But it may be registered more than once, so keep looking.
-            if (typedHandler->GetHandlerFunction() == handler && !typedHandler->IsMarked())
-            {
-                return true;
-            }
-        }
-    }
-
-    // The handler wasn't in the registered list, but maybe it's in the new handlers list.
-    handlers = mNewHandlers.GetIterator();
-    while (handlers.Next())
-    {
-        IMessageHandler *const messageHandler(handlers.Get());
-
-        // Try to convert this handler, of unknown type, to the target type.
-        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
-        {
-            // Count as not registered if it's marked for deregistration.
-            // But it may be registered more than once, so keep looking.
-            if (typedHandler->GetHandlerFunction() == handler && !typedHandler->IsMarked())
-            {
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-
-THERON_FORCEINLINE bool HandlerCollection::Clear()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    // Free all currently allocated handler objects.
-    while (IMessageHandler *const handler = mHandlers.Front())
-    {
-        mHandlers.Remove(handler);
-        handler->~IMessageHandler();
-        allocator->Free(handler);
-    }
-
-    while (IMessageHandler *const handler = mNewHandlers.Front())
-    {
-        mNewHandlers.Remove(handler);
-        handler->~IMessageHandler();
-        allocator->Free(handler);
-    }
-
-    mHandlersDirty = false;
-    return true;
-}
-
-
-THERON_FORCEINLINE bool HandlerCollection::Handle(Actor *const actor, const IMessage *const message)
-{
-    bool handled(false);
-
-    THERON_ASSERT(actor);
-    THERON_ASSERT(message);
-
-    // Update the handler list if there have been changes.
-    if (mHandlersDirty)
-    {
-        UpdateHandlers();
-    }
-
-    // Give each registered handler a chance to handle this message.
-    MessageHandlerList::Iterator handlers(mHandlers.GetIterator());
-    while (handlers.Next())
-    {
-        IMessageHandler *const messageHandler(handlers.Get());
-        handled |= messageHandler->Handle(actor, message);
-    }
-    
-    return handled;
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
+#define THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
+
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Containers/InlineVector.h>
+#include <Theron/Detail/Handlers/CallableMessageHandler.h>
+#include <Theron/Detail/Handlers/IMessageHandler.h>
+#include <Theron/Detail/Handlers/MessageHandler.h>
+#include <Theron/Detail/Handlers/MessageHandlerCast.h>
+#include <Theron/Detail/Handlers/MutableMessageHandler.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+namespace Detail
+{
+
+
+/**
+A collection of handlers for messages of different types.
+
+Dispatch reads an immutable snapshot table of the registered handlers, found
+through an atomically published pointer. Registration and deregistration build
+a new table from the current one and swap the pointer, so handler changes --
+including actors swapping whole handler sets as they move between states --
+never mutate any structure the dispatch path reads. Replaced tables, and the
+handler objects removed from them, are retired and reclaimed on a later
+dispatch, once the dispatch that might have been reading them has completed.
+
+A collection can alternatively reference a snapshot table owned by a shared
+\ref HandlerTable, built once per actor type, in which case registration
+costs the instance no allocations at all. The shared table and its handlers
+are never retired by the collections referencing them: the first handler
+change made by an instance publishes a private copy-on-write snapshot and
+the instance diverges from the shared table from then on.
+*/
+class HandlerCollection
+{
+public:
+
+    static const uint32_t DISPATCH_BUCKETS = 32;    ///< Number of buckets in the dispatch table (power of two!).
+
+    typedef InlineVector<IMessageHandler *> MessageHandlerVector;
+
+    /**
+    Immutable snapshot of the registered handlers.
+    The handlers are stored contiguously, grouped by dispatch bucket, with the
+    handlers for unregistered types (matched by RTTI rather than type ID) in a
+    final group of their own. Each group is described by its end offset, so
+    dispatch walks just the slice of handlers keyed by the message type.
+    */
+    struct Table
+    {
+        MessageHandlerVector mHandlers;             ///< The handlers, grouped by dispatch bucket.
+        uint32_t mGroupEnds[DISPATCH_BUCKETS + 1];  ///< End offset of each bucket group; the RTTI-matched group is last.
+        Table *mNextRetired;                        ///< Next table in the retirement list.
+    };
+
+    /**
+    Default constructor.
+    */
+    HandlerCollection();
+
+    /**
+    Destructor.
+    */
+    ~HandlerCollection();
+
+    /**
+    Adds a handler to the collection.
+    */
+    template <class ActorType, class ValueType>
+    bool Add(void (ActorType::*handler)(const ValueType &message, const Address from));
+
+    /**
+    Adds a mutable handler, taking the message value by non-const reference, to the collection.
+    */
+    template <class ActorType, class ValueType>
+    bool Add(void (ActorType::*handler)(ValueType &message, const Address from));
+
+    /**
+    Adds a callable handler -- a lambda, function object or free function
+    pointer -- to the collection. The callable is copied into the handler
+    object, so outlives the caller's copy.
+    \note Callable handlers have no comparable identity, so can't be found
+    again by \ref Remove or \ref Contains; they remain registered until the
+    collection is cleared or destructed.
+    */
+    template <class ValueType, class CallableType>
+    bool AddCallable(const CallableType &callable);
+
+    /**
+    Removes a handler from the collection, if it is present.
+    */
+    template <class ActorType, class ValueType>
+    bool Remove(void (ActorType::*handler)(const ValueType &message, const Address from));
+
+    /**
+    Removes a mutable handler from the collection, if it is present.
+    */
+    template <class ActorType, class ValueType>
+    bool Remove(void (ActorType::*handler)(ValueType &message, const Address from));
+
+    /**
+    Returns true if the given handler is registered.
+    */
+    template <class ActorType, class ValueType>
+    bool Contains(void (ActorType::*handler)(const ValueType &message, const Address from)) const;
+
+    /**
+    Returns true if the given mutable handler is registered.
+    */
+    template <class ActorType, class ValueType>
+    bool Contains(void (ActorType::*handler)(ValueType &message, const Address from)) const;
+
+    /**
+    Unregisters all registered handlers.
+    */
+    bool Clear();
+
+    /**
+    References a snapshot table owned by a shared handler table, making its
+    handlers the registered handlers of this collection without copying them.
+    \note Only legal while the collection is empty.
+    */
+    inline void Share(Table *const table);
+
+    /**
+    Returns the current snapshot table, or zero if the collection is empty.
+    */
+    THERON_FORCEINLINE Table *GetTable() const
+    {
+        return reinterpret_cast<Table *>(mTable.Load());
+    }
+
+    /**
+    Handles the given message, passing it to each of the handlers in the collection.
+    \return True, if one or more of the handlers in the collection handled the message.
+    */
+    bool Handle(Actor *const actor, const IMessage *const message);
+
+private:
+
+    HandlerCollection(const HandlerCollection &other);
+    HandlerCollection &operator=(const HandlerCollection &other);
+
+    /**
+    Builds a new snapshot table from the current one, appending an optional
+    added handler and omitting an optional removed handler, and publishes it
+    with a single atomic pointer store, retiring the replaced table.
+    \note Intentionally not force-inlined since handler changes are rare compared to dispatches.
+    \return False if memory for the new table couldn't be allocated, in which case nothing changed.
+    */
+    bool PublishTable(IMessageHandler *const added, IMessageHandler *const removed);
+
+    /**
+    Frees retired tables and removed handler objects.
+    \note Only safe to call when no dispatch can still be reading them.
+    */
+    void ReclaimRetired();
+
+    /**
+    Maps a message type ID to a dispatch table bucket.
+    Registered type IDs are dense small integers, so simple masking spreads
+    them evenly over the buckets.
+    */
+    inline static uint32_t HashTypeId(const uint32_t typeId);
+
+    /**
+    Returns the index of the table group the given handler is dispatched from.
+    */
+    inline static uint32_t GroupOf(const IMessageHandler *const handler);
+
+    Atomic::Pointer mTable;                 ///< Atomically published pointer to the current snapshot table; zero when empty.
+    bool mTableShared;                      ///< Whether the current table is owned by a shared handler table.
+    Table *mRetiredTables;                  ///< Replaced tables awaiting reclamation.
+    MessageHandlerVector mRetiredHandlers;  ///< Removed handler objects awaiting reclamation.
+    IMessageHandler *mLastHandler;          ///< Inline cache of the handler that matched the last message.
+    uint32_t mLastTypeId;                   ///< Type ID of the last matched message; zero when the cache is empty.
+};
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Add(void (ActorType::*handler)(const ValueType &message, const Address from))
+{
+    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate memory for a message handler object.
+    void *const memory = allocator->Allocate(sizeof(MessageHandlerType));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    // Construct a handler object to remember the function pointer and message value type.
+    MessageHandlerType *const messageHandler = new (memory) MessageHandlerType(handler);
+
+    // We don't check for duplicates because multiple registrations of the same function are allowed.
+    if (!PublishTable(messageHandler, 0))
+    {
+        messageHandler->~MessageHandlerType();
+        allocator->Free(memory);
+        return false;
+    }
+
+    return true;
+}
+
+
+template <class ValueType, class CallableType>
+THERON_FORCEINLINE bool HandlerCollection::AddCallable(const CallableType &callable)
+{
+    typedef CallableMessageHandler<ValueType, CallableType> MessageHandlerType;
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate memory for a message handler object.
+    void *const memory = allocator->Allocate(sizeof(MessageHandlerType));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    // Construct a handler object holding a copy of the callable and remembering the message value type.
+    MessageHandlerType *const messageHandler = new (memory) MessageHandlerType(callable);
+
+    // We don't check for duplicates because multiple registrations of equivalent callables are allowed.
+    if (!PublishTable(messageHandler, 0))
+    {
+        messageHandler->~MessageHandlerType();
+        allocator->Free(memory);
+        return false;
+    }
+
+    return true;
+}
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Remove(void (ActorType::*handler)(const ValueType &message, const Address from))
+{
+    // If the message value type has a valid (non-zero) type name defined for it,
+    // then we use explicit type names to match messages to handlers.
+    // The default value of zero indicates that no type name has been defined,
+    // in which case we rely on compiler-generated RTTI to identify message types.
+    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
+    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
+
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table == 0)
+    {
+        return false;
+    }
+
+    // Find the first matching handler in the current snapshot.
+    for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+    {
+        IMessageHandler *const messageHandler(table->mHandlers[index]);
+
+        // Try to convert this handler, of unknown type, to the target type.
+        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
+        {
+            if (typedHandler->GetHandlerFunction() == handler)
+            {
+                // Publish a new snapshot without the handler. The handler
+                // object can't be freed yet: the dispatch this may have been
+                // called from is still reading the replaced table. It's
+                // retired instead, and reclaimed on a later dispatch.
+                if (!PublishTable(0, messageHandler))
+                {
+                    return false;
+                }
+
+                // Handlers owned by a shared handler table outlive the
+                // collections referencing them, so are never retired.
+                if (!messageHandler->IsShared())
+                {
+                    mRetiredHandlers.Insert(messageHandler);
+                }
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Contains(void (ActorType::*handler)(const ValueType &message, const Address from)) const
+{
+    typedef MessageHandler<ActorType, ValueType> MessageHandlerType;
+    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
+
+    // Search for the handler in the current snapshot, which reflects all
+    // registrations and deregistrations made so far.
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table == 0)
+    {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+    {
+        IMessageHandler *const messageHandler(table->mHandlers[index]);
+
+        // Try to convert this handler, of unknown type, to the target type.
+        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler))
+        {
+            if (typedHandler->GetHandlerFunction() == handler)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Add(void (ActorType::*handler)(ValueType &message, const Address from))
+{
+    typedef MutableMessageHandler<ActorType, ValueType> MessageHandlerType;
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate memory for a message handler object.
+    void *const memory = allocator->Allocate(sizeof(MessageHandlerType));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    // Construct a handler object to remember the function pointer and message value type.
+    MessageHandlerType *const messageHandler = new (memory) MessageHandlerType(handler);
+
+    // We don't check for duplicates because multiple registrations of the same function are allowed.
+    if (!PublishTable(messageHandler, 0))
+    {
+        messageHandler->~MessageHandlerType();
+        allocator->Free(memory);
+        return false;
+    }
+
+    return true;
+}
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Remove(void (ActorType::*handler)(ValueType &message, const Address from))
+{
+    // If the message value type has a valid (non-zero) type name defined for it,
+    // then we use explicit type names to match messages to handlers.
+    // The default value of zero indicates that no type name has been defined,
+    // in which case we rely on compiler-generated RTTI to identify message types.
+    typedef MutableMessageHandler<ActorType, ValueType> MessageHandlerType;
+    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
+
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table == 0)
+    {
+        return false;
+    }
+
+    // Find the first matching handler in the current snapshot.
+    for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+    {
+        IMessageHandler *const messageHandler(table->mHandlers[index]);
+
+        // Try to convert this handler, of unknown type, to the target type.
+        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastMutableHandler<ValueType>(messageHandler))
+        {
+            if (typedHandler->GetHandlerFunction() == handler)
+            {
+                // Publish a new snapshot without the handler. The handler
+                // object can't be freed yet: the dispatch this may have been
+                // called from is still reading the replaced table. It's
+                // retired instead, and reclaimed on a later dispatch.
+                if (!PublishTable(0, messageHandler))
+                {
+                    return false;
+                }
+
+                // Handlers owned by a shared handler table outlive the
+                // collections referencing them, so are never retired.
+                if (!messageHandler->IsShared())
+                {
+                    mRetiredHandlers.Insert(messageHandler);
+                }
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+template <class ActorType, class ValueType>
+THERON_FORCEINLINE bool HandlerCollection::Contains(void (ActorType::*handler)(ValueType &message, const Address from)) const
+{
+    typedef MutableMessageHandler<ActorType, ValueType> MessageHandlerType;
+    typedef MessageHandlerCast<ActorType, MessageTraits<ValueType>::HAS_TYPE_NAME> HandlerCaster;
+
+    // Search for the handler in the current snapshot, which reflects all
+    // registrations and deregistrations made so far.
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table == 0)
+    {
+        return false;
+    }
+
+    for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+    {
+        IMessageHandler *const messageHandler(table->mHandlers[index]);
+
+        // Try to convert this handler, of unknown type, to the target type.
+        if (const MessageHandlerType *const typedHandler = HandlerCaster:: template CastMutableHandler<ValueType>(messageHandler))
+        {
+            if (typedHandler->GetHandlerFunction() == handler)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE bool HandlerCollection::Clear()
+{
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table)
+    {
+        // Retire the handlers and the table itself rather than freeing them;
+        // the dispatch this may have been called from is still reading them.
+        // Handlers and tables owned by a shared handler table outlive the
+        // collections referencing them, so are simply dropped.
+        for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+        {
+            if (!table->mHandlers[index]->IsShared())
+            {
+                mRetiredHandlers.Insert(table->mHandlers[index]);
+            }
+        }
+
+        mTable.Store(0);
+
+        if (mTableShared)
+        {
+            mTableShared = false;
+        }
+        else
+        {
+            table->mNextRetired = mRetiredTables;
+            mRetiredTables = table;
+        }
+    }
+
+    // The cached last-matched handler has been retired, so empty the inline cache.
+    mLastHandler = 0;
+    mLastTypeId = 0;
+
+    return true;
+}
+
+
+THERON_FORCEINLINE void HandlerCollection::Share(Table *const table)
+{
+    // Sharing is only legal while the collection is empty, so there's
+    // nothing to retire; registration order is preserved by registering any
+    // per-instance handlers after referencing the shared table.
+    THERON_ASSERT(mTable.Load() == 0);
+
+    if (table)
+    {
+        mTable.Store(table);
+        mTableShared = true;
+    }
+}
+
+
+THERON_FORCEINLINE bool HandlerCollection::Handle(Actor *const actor, const IMessage *const message)
+{
+    bool handled(false);
+
+    THERON_ASSERT(actor);
+    THERON_ASSERT(message);
+
+    // Reclaim tables and handlers retired by handler changes during earlier
+    // dispatches, which have completed. Changes made during this dispatch
+    // retire their tables after this load, so are reclaimed a dispatch later.
+    if (mRetiredTables)
+    {
+        ReclaimRetired();
+    }
+
+    // Load the current snapshot. Handler changes made by the handlers this
+    // dispatch executes publish new snapshots, leaving this one untouched,
+    // so they take effect from the next message.
+    Table *const table(reinterpret_cast<Table *>(mTable.Load()));
+    if (table == 0)
+    {
+        return false;
+    }
+
+    // If the message carries an explicit type ID we can limit the search to
+    // the group of handlers keyed by that ID, rather than offering the message
+    // to every registered handler in turn. Bucket collisions just mean a
+    // handler is offered a message it then rejects, so are benign.
+    const uint32_t typeId(message->GetTypeId());
+    if (typeId)
+    {
+        // Monomorphic fast path: most actors receive long runs of the same message
+        // type, so try the handler that matched the last message before walking
+        // the bucket groups. The cache is only primed when the previous message
+        // matched exactly one handler, so taking it can't skip other interested
+        // handlers.
+        if (typeId == mLastTypeId)
+        {
+            if (mLastHandler->Handle(actor, message))
+            {
+                return true;
+            }
+        }
+
+        const uint32_t bucket(HashTypeId(typeId));
+        const uint32_t bucketStart(bucket ? table->mGroupEnds[bucket - 1] : 0);
+        const uint32_t bucketEnd(table->mGroupEnds[bucket]);
+
+        for (uint32_t index = bucketStart; index < bucketEnd; ++index)
+        {
+            handled |= table->mHandlers[index]->Handle(actor, message);
+        }
+
+        // Handlers for unregistered types match messages by RTTI, so can't be
+        // keyed on the type ID and are offered every message.
+        const uint32_t unnamedStart(table->mGroupEnds[DISPATCH_BUCKETS - 1]);
+        const uint32_t unnamedEnd(table->mGroupEnds[DISPATCH_BUCKETS]);
+
+        for (uint32_t index = unnamedStart; index < unnamedEnd; ++index)
+        {
+            handled |= table->mHandlers[index]->Handle(actor, message);
+        }
+
+        // Prime the inline cache if the message was consumed by a lone handler:
+        // the only one in its bucket group, with no RTTI-matched handlers
+        // registered that would also need to see messages of this type.
+        if (handled && unnamedStart == unnamedEnd && bucketEnd - bucketStart == 1)
+        {
+            mLastHandler = table->mHandlers[bucketStart];
+            mLastTypeId = typeId;
+        }
+
+        return handled;
+    }
+
+    // The message has no type ID, so give every registered handler a chance to handle it.
+    // The handlers are stored contiguously so this walk is cache-friendly.
+    const uint32_t numHandlers(table->mHandlers.Size());
+    for (uint32_t index = 0; index < numHandlers; ++index)
+    {
+        handled |= table->mHandlers[index]->Handle(actor, message);
+    }
+
+    return handled;
+}
+
+
+THERON_FORCEINLINE uint32_t HandlerCollection::HashTypeId(const uint32_t typeId)
+{
+    // Type IDs are allocated densely from a process-wide counter, so masking
+    // off the low bits spreads them evenly over the buckets.
+    return (typeId & (DISPATCH_BUCKETS - 1));
+}
+
+
+THERON_FORCEINLINE uint32_t HandlerCollection::GroupOf(const IMessageHandler *const handler)
+{
+    // Handlers for unregistered types are matched by RTTI rather than keyed
+    // on a type ID, so are grouped separately after the bucket groups.
+    const uint32_t typeId(handler->GetMessageTypeId());
+    return typeId ? HashTypeId(typeId) : DISPATCH_BUCKETS;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_HANDLERS_HANDLERCOLLECTION_H
@@ -6,7 +6,6 @@
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 
-#include <Theron/Detail/Containers/List.h>
 #include <Theron/Detail/Messages/IMessage.h>
 
 
@@ -17,9 +16,9 @@ namespace Detail
 
 
 /**
-Baseclass that allows fallback handlers to be stored in lists.
+Baseclass that allows fallback handlers to be stored in collections.
 */
-class IFallbackHandler : public List<IFallbackHandler>::Node
+class IFallbackHandler
 {
 public:
 
@@ -6,7 +6,6 @@
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 
-#include <Theron/Detail/Containers/List.h>
 #include <Theron/Detail/Messages/IMessage.h>
 
 
@@ -17,9 +16,9 @@ namespace Detail
 
 
 /**
-Baseclass that allows message handlers of various types to be stored in lists.
+Baseclass that allows message handlers of various types to be stored in collections.
 */
-class IReceiverHandler : public List<IReceiverHandler>::Node
+class IReceiverHandler
 {
 public:
 
@@ -0,0 +1,165 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_HANDLERS_MESSAGECONTINUATION_H
+#define THERON_DETAIL_HANDLERS_MESSAGECONTINUATION_H
+
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageCast.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+namespace Detail
+{
+
+
+/**
+Baseclass that allows message continuations of different types to be stored
+in a single list on an actor.
+
+A continuation is a one-shot handler registered when a request message is
+sent, pending until the reply to that request arrives. Replies are matched
+by the address the reply is expected from and by the message value type, so
+a pending continuation doesn't intercept unrelated messages.
+*/
+class IContinuation
+{
+public:
+
+    /**
+    Constructs a continuation pending a reply from the given address.
+    */
+    THERON_FORCEINLINE explicit IContinuation(const Address &from) :
+      mFrom(from),
+      mNext(0)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~IContinuation()
+    {
+    }
+
+    /**
+    Sets the next continuation in the actor's list of pending continuations.
+    */
+    THERON_FORCEINLINE void SetNext(IContinuation *const next)
+    {
+        mNext = next;
+    }
+
+    /**
+    Gets the next continuation in the actor's list of pending continuations.
+    */
+    THERON_FORCEINLINE IContinuation *GetNext() const
+    {
+        return mNext;
+    }
+
+    /**
+    Returns the address the pending reply is expected from.
+    */
+    THERON_FORCEINLINE const Address &GetFrom() const
+    {
+        return mFrom;
+    }
+
+    /**
+    Handles the given message, if it's a reply of the expected type.
+    \return True, if the continuation consumed the message.
+    */
+    virtual bool Handle(Actor *const actor, const IMessage *const message) const = 0;
+
+protected:
+
+    Address mFrom;              ///< The address the pending reply is expected from.
+    IContinuation *mNext;       ///< Next in the actor's list of pending continuations.
+
+private:
+
+    IContinuation(const IContinuation &other);
+    IContinuation &operator=(const IContinuation &other);
+};
+
+
+/**
+Instantiable continuation that remembers a member function of the actor to be
+executed when the pending reply arrives, mirroring \ref MessageHandler.
+
+\tparam ActorType The type of actor whose member function is executed.
+\tparam ValueType The type of reply message the continuation accepts.
+*/
+template <class ActorType, class ValueType>
+class MessageContinuation : public IContinuation
+{
+public:
+
+    /**
+    Pointer to a member function of the actor type that handles the reply.
+    */
+    typedef void (ActorType::*ContinuationFunction)(const ValueType &message, const Address from);
+
+    /**
+    Constructor.
+    */
+    THERON_FORCEINLINE MessageContinuation(ContinuationFunction function, const Address &from) :
+      IContinuation(from),
+      mContinuationFunction(function)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~MessageContinuation()
+    {
+    }
+
+    /**
+    Handles the given message, if it's a reply of the expected type.
+    */
+    inline virtual bool Handle(Actor *const actor, const IMessage *const message) const
+    {
+        typedef MessageCast<MessageTraits<ValueType>::HAS_TYPE_NAME> MessageCaster;
+
+        THERON_ASSERT(actor);
+        THERON_ASSERT(mContinuationFunction);
+        THERON_ASSERT(message);
+
+        // Try to convert the message, of unknown type, to a message of the expected type.
+        const Message<ValueType> *const typedMessage = MessageCaster:: template CastMessage<ValueType>(message);
+        if (typedMessage)
+        {
+            // Call the continuation, passing it the message value and from address.
+            ActorType *const typedActor = static_cast<ActorType *>(actor);
+            (typedActor->*mContinuationFunction)(typedMessage->Value(), typedMessage->From());
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+
+    ContinuationFunction mContinuationFunction;     ///< Member function executed on arrival of the reply.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_HANDLERS_MESSAGECONTINUATION_H
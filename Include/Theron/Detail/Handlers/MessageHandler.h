@@ -81,6 +81,14 @@ public:
         return MessageTraits<ValueType>::TYPE_NAME;
     }
 
+    /**
+    Returns the dense integer ID of the message type handled by this handler.
+    */
+    inline virtual uint32_t GetMessageTypeId() const
+    {
+        return MessageTraits<ValueType>::TYPE_ID;
+    }
+
     /**
     Handles the given message, if it's of the type accepted by the handler.
     \return True, if the handler handled the message.
@@ -0,0 +1,137 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_HANDLERS_MUTABLEMESSAGEHANDLER_H
+#define THERON_DETAIL_HANDLERS_MUTABLEMESSAGEHANDLER_H
+
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Handlers/IMessageHandler.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageCast.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+namespace Detail
+{
+
+
+/**
+Instantiable class template that remembers a message handler function taking
+a non-const reference to the message value, and the type of message it accepts.
+
+Unlike the handlers remembered by \ref MessageHandler, the handlers remembered
+by this class are passed a mutable reference to the message value, allowing them
+to modify the value in place or move its contents out, taking ownership of any
+resources held by the value without copying them. This is safe because each
+message is only ever processed by one thread at a time, so the executing handler
+has exclusive access to the value.
+
+\tparam ActorType The type of actor whose message handlers are considered.
+\tparam ValueType The type of message handled by this message handler.
+*/
+template <class ActorType, class ValueType>
+class MutableMessageHandler : public IMessageHandler
+{
+public:
+
+    /**
+    Pointer to a member function of the actor type that can handle messages
+    with the given value type, taking the value by non-const reference.
+    */
+    typedef void (ActorType::*HandlerFunction)(ValueType &message, const Address from);
+
+    /**
+    Constructor.
+    */
+    inline explicit MutableMessageHandler(HandlerFunction function) : mHandlerFunction(function)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~MutableMessageHandler()
+    {
+    }
+
+    /**
+    Returns a pointer to the handler function registered by this instance.
+    */
+    THERON_FORCEINLINE HandlerFunction GetHandlerFunction() const
+    {
+        return mHandlerFunction;
+    }
+
+    /**
+    Returns the unique name of the message type handled by this handler.
+    */
+    inline virtual const char *GetMessageTypeName() const
+    {
+        return MessageTraits<ValueType>::TYPE_NAME;
+    }
+
+    /**
+    Returns the dense integer ID of the message type handled by this handler.
+    */
+    inline virtual uint32_t GetMessageTypeId() const
+    {
+        return MessageTraits<ValueType>::TYPE_ID;
+    }
+
+    /**
+    Handles the given message, if it's of the type accepted by the handler.
+    \return True, if the handler handled the message.
+    \note The message is not consumed by the handler, but its value may be
+    modified or moved from. The message will be automatically destroyed when
+    all handlers have seen it, destructing whatever remains of the value.
+    */
+    inline virtual bool Handle(Actor *const actor, const IMessage *const message) const
+    {
+        typedef MessageCast<MessageTraits<ValueType>::HAS_TYPE_NAME> MessageCaster;
+
+        THERON_ASSERT(actor);
+        THERON_ASSERT(mHandlerFunction);
+        THERON_ASSERT(message);
+
+        // Messages are only processed by one thread at a time, so even though
+        // the dispatch path passes messages around by const pointer, the message
+        // is exclusively owned by this thread and can safely be mutated.
+        IMessage *const mutableMessage(const_cast<IMessage *>(message));
+
+        // Try to convert the message, of unknown type, to message of the assumed type.
+        Message<ValueType> *const typedMessage = MessageCaster:: template CastMessage<ValueType>(mutableMessage);
+        if (typedMessage)
+        {
+            // Call the handler, passing it a mutable reference to the message value and the from address.
+            ActorType *const typedActor = static_cast<ActorType *>(actor);
+            (typedActor->*mHandlerFunction)(typedMessage->Value(), typedMessage->From());
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+
+    MutableMessageHandler(const MutableMessageHandler &other);
+    MutableMessageHandler &operator=(const MutableMessageHandler &other);
+
+    const HandlerFunction mHandlerFunction;     ///< Pointer to a handler member function on an actor.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_HANDLERS_MUTABLEMESSAGEHANDLER_H
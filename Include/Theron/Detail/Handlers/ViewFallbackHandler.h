@@ -0,0 +1,87 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_HANDLERS_VIEWFALLBACKHANDLER_H
+#define THERON_DETAIL_HANDLERS_VIEWFALLBACKHANDLER_H
+
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/MessageView.h>
+
+#include <Theron/Detail/Handlers/IFallbackHandler.h>
+#include <Theron/Detail/Messages/IMessage.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Instantiable class template that remembers a 'view' fallback message handler function
+registered with a framework and called for messages that are undelivered or unhandled.
+A view handler is one that takes the message as a refcounted \ref MessageView, which
+it can retain beyond its own return to extend the lifetime of the message payload.
+\tparam ObjectType The class on which the handler function is a method.
+*/
+template <class ObjectType>
+class ViewFallbackHandler : public IFallbackHandler
+{
+public:
+
+    /**
+    Pointer to a member function of a handler object.
+    */
+    typedef void (ObjectType::*HandlerFunction)(const MessageView &view, const Address from);
+
+    /**
+    Constructor.
+    */
+    THERON_FORCEINLINE ViewFallbackHandler(ObjectType *const object, HandlerFunction function) :
+      mObject(object),
+      mHandlerFunction(function)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~ViewFallbackHandler()
+    {
+    }
+
+    /**
+    Handles the given message.
+    */
+    inline virtual void Handle(const IMessage *const message) const
+    {
+        THERON_ASSERT(mObject);
+        THERON_ASSERT(mHandlerFunction);
+        THERON_ASSERT(message);
+
+        // Call the handler, passing it the from address and a refcounted view
+        // of the message, which it can retain beyond its return. The caller
+        // releases its own reference after the call, as for any message, and
+        // the message survives until the last retained view is released.
+        const MessageView view(message);
+
+        (mObject->*mHandlerFunction)(view, message->From());
+    }
+
+private:
+
+    ViewFallbackHandler(const ViewFallbackHandler &other);
+    ViewFallbackHandler &operator=(const ViewFallbackHandler &other);
+
+    ObjectType *mObject;                        ///< Pointer to the object owning the handler function.
+    const HandlerFunction mHandlerFunction;     ///< Pointer to the handler member function on the owning object.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_HANDLERS_VIEWFALLBACKHANDLER_H
@@ -10,6 +10,9 @@
 #include <Theron/Detail/Threading/SpinLock.h>
 
 
+#if !THERON_NO_LEGACY
+
+
 namespace Theron
 {
 
@@ -68,4 +71,7 @@ private:
 } // namespace Theron
 
 
+#endif // !THERON_NO_LEGACY
+
+
 #endif // THERON_DETAIL_LEGACY_ACTORREGISTRY_H
@@ -0,0 +1,99 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXPROCESSOR_COUNTERSLOTS_H
+#define THERON_DETAIL_MAILBOXPROCESSOR_COUNTERSLOTS_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Counters.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A single event counter slot, written with plain stores.
+
+Each Processor::Context owns its own set of slots and only the owning thread
+writes them, so increments are plain load-add-store sequences with no atomic
+read-modify-write on the hot path. The value is volatile so that writes are
+actually emitted and query methods running on other threads see recent values;
+exact counts are only guaranteed once the writing thread has quiesced.
+
+In the shared per-framework context, which is used by many application
+threads, concurrent increments can collide and lose counts; like the trace
+buffer and message statistics in that context, its counters are best-effort.
+*/
+class CounterSlot
+{
+public:
+
+    inline CounterSlot() : mValue(0)
+    {
+    }
+
+    THERON_FORCEINLINE void Increment()
+    {
+        mValue = mValue + 1;
+    }
+
+    THERON_FORCEINLINE uint32_t Load() const
+    {
+        return mValue;
+    }
+
+    THERON_FORCEINLINE void Store(const uint32_t value)
+    {
+        mValue = value;
+    }
+
+private:
+
+    volatile uint32_t mValue;
+};
+
+
+/**
+Per-context array of event counter slots, indexed by \ref Counter.
+
+Padded to cache-line alignment so the counters, which the owning thread writes
+on every scheduling event, don't share a cache line with neighbouring context
+members that other threads read.
+*/
+class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) CounterSlots
+{
+public:
+
+    inline CounterSlots()
+    {
+    }
+
+    THERON_FORCEINLINE CounterSlot &operator[](const uint32_t counter)
+    {
+        THERON_ASSERT(counter < (uint32_t) MAX_COUNTERS);
+        return mSlots[counter];
+    }
+
+    THERON_FORCEINLINE const CounterSlot &operator[](const uint32_t counter) const
+    {
+        THERON_ASSERT(counter < (uint32_t) MAX_COUNTERS);
+        return mSlots[counter];
+    }
+
+private:
+
+    CounterSlot mSlots[MAX_COUNTERS];
+
+} THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MAILBOXPROCESSOR_COUNTERSLOTS_H
@@ -0,0 +1,142 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXPROCESSOR_PARALLELTASK_H
+#define THERON_DETAIL_MAILBOXPROCESSOR_PARALLELTASK_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Shared state of one parallel-for computation, published to the worker threads.
+
+The iteration range is divided into fixed-size chunks, which participating
+threads claim with an atomic increment of the next-chunk counter: each claimed
+index below the chunk count is owned exclusively by the claiming thread, so
+chunks are executed exactly once without locking. The publishing thread claims
+chunks alongside the workers and waits for the completed count to reach the
+chunk count, so the computation finishes even if no worker ever participates.
+
+\note Tasks live on the stack of the publishing thread, which retires the task
+from the shared slot and waits out any straggling examiners before returning.
+*/
+class ParallelTask
+{
+public:
+
+    inline ParallelTask(const uint32_t count, const uint32_t chunkSize) :
+      mCount(count),
+      mChunkSize(chunkSize),
+      mChunkCount((count + chunkSize - 1) / chunkSize),
+      mNextChunk(0),
+      mCompletedChunks(0)
+    {
+        THERON_ASSERT(chunkSize > 0);
+    }
+
+    /**
+    Claims and executes chunks until none remain unclaimed.
+    \return The number of chunks executed by the calling thread.
+    */
+    inline uint32_t ExecuteChunks()
+    {
+        uint32_t executed(0);
+
+        uint32_t chunk(mNextChunk.FetchIncrement());
+        while (chunk < mChunkCount)
+        {
+            const uint32_t begin(chunk * mChunkSize);
+            const uint32_t end(begin + mChunkSize < mCount ? begin + mChunkSize : mCount);
+
+            Execute(begin, end);
+            mCompletedChunks.Increment();
+
+            ++executed;
+            chunk = mNextChunk.FetchIncrement();
+        }
+
+        return executed;
+    }
+
+    /**
+    Returns true once every chunk has been claimed and executed.
+    */
+    THERON_FORCEINLINE bool Complete() const
+    {
+        return (mCompletedChunks.Load() == mChunkCount);
+    }
+
+    /**
+    Executes the iterations of one claimed chunk of the range.
+    */
+    virtual void Execute(const uint32_t begin, const uint32_t end) = 0;
+
+protected:
+
+    /**
+    Non-virtual destructor; tasks are stack-owned by their publishers and
+    never destroyed through a base pointer.
+    */
+    ~ParallelTask()
+    {
+    }
+
+private:
+
+    ParallelTask(const ParallelTask &other);
+    ParallelTask &operator=(const ParallelTask &other);
+
+    const uint32_t mCount;              ///< Number of iterations in the range.
+    const uint32_t mChunkSize;          ///< Number of iterations per chunk.
+    const uint32_t mChunkCount;         ///< Number of chunks the range divides into.
+    Atomic::UInt32 mNextChunk;          ///< Index of the next unclaimed chunk; claimed by atomic increment.
+    Atomic::UInt32 mCompletedChunks;    ///< Count of chunks whose execution has finished.
+};
+
+
+/**
+Task class template that remembers the type of the user's functor so the
+claimed chunks can invoke it, once per index in the chunk.
+*/
+template <class FunctorType>
+class ParallelForTask : public ParallelTask
+{
+public:
+
+    inline ParallelForTask(const uint32_t count, const uint32_t chunkSize, FunctorType &functor) :
+      ParallelTask(count, chunkSize),
+      mFunctor(functor)
+    {
+    }
+
+    virtual void Execute(const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; ++index)
+        {
+            mFunctor(index);
+        }
+    }
+
+private:
+
+    ParallelForTask(const ParallelForTask &other);
+    ParallelForTask &operator=(const ParallelForTask &other);
+
+    FunctorType &mFunctor;              ///< Reference to the caller-owned functor executed per index.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MAILBOXPROCESSOR_PARALLELTASK_H
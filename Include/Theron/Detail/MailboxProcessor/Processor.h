@@ -1,182 +1,441 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
-#define THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
-
-
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Counters.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Allocators/CachingAllocator.h>
-#include <Theron/Detail/Directory/Directory.h>
-#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
-#include <Theron/Detail/Mailboxes/Mailbox.h>
-#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
-#include <Theron/Detail/Threading/Atomic.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-Mailbox processor.
-*/
-class Processor
-{
-public:
-
-    typedef void (* YieldFunction)(uint32_t &backoff);
-
-    class YieldImplementation
-    {
-    public:
-
-        inline explicit YieldImplementation() :
-          mCounter(0),
-          mYieldFunction(0)
-        {
-        }
-
-        THERON_FORCEINLINE void SetYieldFunction(YieldFunction yieldFunction)
-        {
-            mYieldFunction = yieldFunction;
-        }
-
-        THERON_FORCEINLINE void Reset()
-        {
-            mCounter = 0;
-        }
-
-        THERON_FORCEINLINE void Execute()
-        {
-            THERON_ASSERT(mYieldFunction);
-            (*mYieldFunction)(mCounter);
-        }
-
-    private:
-
-        uint32_t mCounter;
-        YieldFunction mYieldFunction;
-    };
-
-    /**
-    Context structure holding data used in processing mailboxes.
-
-    \note The members of a single context are all accessed only by one worker thread
-    so we don't need to worry about shared writes, including false sharing.
-    */
-    struct Context
-    {
-        /**
-        Constructor.
-        */
-        inline Context(
-            Directory<Mailbox> *const mailboxes,
-            SpinLock *const sharedWorkQueueSpinLock,
-            FallbackHandlerCollection *const fallbackHandlers,
-            IAllocator *const messageAllocator) :
-          mMailboxes(mailboxes),
-          mSharedWorkQueueSpinLock(sharedWorkQueueSpinLock),
-          mWorkQueue(),
-          mSharedWorkQueue(0),
-          mLocalWorkQueue(0),
-          mFallbackHandlers(fallbackHandlers),
-          mMessageCache(messageAllocator)
-        {
-        }
-
-        Directory<Mailbox> *const mMailboxes;                   ///< Pointer to the array of mailboxes serviced by this context.
-        SpinLock *const mSharedWorkQueueSpinLock;               ///< Pointer to the spinlock protecting the shared work queue.
-        WorkQueue mWorkQueue;                                   ///< Work queue owned by this context.
-        WorkQueue *mSharedWorkQueue;                            ///< Pointer to the shared work queue.
-        WorkQueue *mLocalWorkQueue;                             ///< Pointer to the local work queue.
-        FallbackHandlerCollection *const mFallbackHandlers;     ///< Pointer to fallback handlers for undelivered messages.
-        CachingAllocator<32> mMessageCache;                     ///< Per-thread cache of free message memory blocks.
-        YieldImplementation mYield;                             ///< Thread yield strategy implementation.
-        Atomic::UInt32 mCounters[MAX_COUNTERS];                 ///< Event counters.
-
-    private:
-
-        Context(const Context &other);
-        Context &operator=(const Context &other);
-    };
-
-    /**
-    Processes the work queue.
-    */
-    THERON_FORCEINLINE static void Process(Context *const context)
-    {
-        WorkQueue *const sharedWorkQueue(context->mSharedWorkQueue);
-        Mailbox *mailbox(0);
-
-        // Peek at the shared queue without locking it to check for work.
-        if (!sharedWorkQueue->Empty())
-        {
-            SpinLock *const spinLock(context->mSharedWorkQueueSpinLock);
-
-            // Lock the shared queue and try to pop the item we saw when we peeked.
-            spinLock->Lock();
-            mailbox = static_cast<Mailbox *>(sharedWorkQueue->Pop());
-            spinLock->Unlock();
-
-            if (mailbox)
-            {
-                // Non-inlined call.
-                ProcessMailbox(context, mailbox);
-
-                context->mYield.Reset();
-                return;
-            }
-        }
-
-        // Try to grab a mailbox from the local queue.
-        mailbox = static_cast<Mailbox *>(context->mWorkQueue.Pop());
-        if (mailbox)
-        {
-            // Non-inlined call.
-            ProcessMailbox(context, mailbox);
-
-            context->mYield.Reset();
-            return;
-        }
-
-        // Yield to prevent busy-waiting on the work queue forever.
-        context->mYield.Execute();
-    }
-
-    static void YieldPolite(uint32_t &counter);
-    static void YieldStrong(uint32_t &counter);
-    static void YieldAggressive(uint32_t &counter);
-
-private:
-
-    Processor();
-    Processor(const Processor &other);
-    Processor &operator=(const Processor &other);
-
-    static void ProcessMailbox(Context *const context, Mailbox *const mailbox);
-};
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
+#define THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Counters.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Allocators/ArenaAllocator.h>
+#include <Theron/Detail/Allocators/CachingAllocator.h>
+#include <Theron/Detail/Allocators/DeferredFreeList.h>
+#include <Theron/Detail/Directory/Directory.h>
+#include <Theron/Detail/Directory/FrameworkCache.h>
+#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/MailboxProcessor/CounterSlots.h>
+#include <Theron/Detail/MailboxProcessor/ParallelTask.h>
+#include <Theron/Detail/MailboxProcessor/Scheduler.h>
+#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
+#include <Theron/Detail/MailboxProcessor/WorkStealingQueue.h>
+#include <Theron/Detail/Network/NameCache.h>
+
+#if THERON_ENABLE_TRACING
+#include <Theron/Detail/Profiling/TraceBuffer.h>
+#endif // THERON_ENABLE_TRACING
+
+#if THERON_ENABLE_MESSAGE_STATS
+#include <Theron/MessageTypeStats.h>
+#endif // THERON_ENABLE_MESSAGE_STATS
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Mailbox processor.
+*/
+class Processor
+{
+public:
+
+    struct Context;
+
+    typedef void (* YieldFunction)(Context *const context, uint32_t &backoff);
+
+    class YieldImplementation
+    {
+    public:
+
+        inline explicit YieldImplementation() :
+          mCounter(0),
+          mYieldFunction(0)
+        {
+        }
+
+        THERON_FORCEINLINE void SetYieldFunction(YieldFunction yieldFunction)
+        {
+            mYieldFunction = yieldFunction;
+        }
+
+        THERON_FORCEINLINE void Reset()
+        {
+            mCounter = 0;
+        }
+
+        THERON_FORCEINLINE void Execute(Context *const context)
+        {
+            THERON_ASSERT(mYieldFunction);
+            (*mYieldFunction)(context, mCounter);
+        }
+
+    private:
+
+        uint32_t mCounter;
+        YieldFunction mYieldFunction;
+    };
+
+    /**
+    Context structure holding data used in processing mailboxes.
+
+    \note The members of a single context are all accessed only by one worker thread
+    so we don't need to worry about shared writes, including false sharing.
+    */
+    struct Context
+    {
+        /**
+        Constructor.
+        */
+        inline Context(
+            Directory<Mailbox> *const mailboxes,
+            SpinLock *const sharedWorkQueueSpinLock,
+            FallbackHandlerCollection *const fallbackHandlers,
+            IAllocator *const messageAllocator) :
+          mMailboxes(mailboxes),
+          mSharedWorkQueueSpinLock(sharedWorkQueueSpinLock),
+          mWorkQueue(),
+          mHighPriorityQueue(),
+          mDeadlineQueue(),
+          mLocalQueue(),
+          mSharedWorkQueue(0),
+          mSharedHighPriorityWorkQueue(0),
+          mSharedDeadlineWorkQueue(0),
+          mLocalWorkQueue(0),
+          mWorkerContexts(0),
+          mWorkerContextCount(0),
+          mStealSeed(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)) | 1),
+          mNumaNode(0),
+          mSchedulerId(SCHEDULER_ID_DEFAULT),
+          mMessageBatchSize(1),
+          mHandlerBudgetMicroseconds(0),
+          mBudgetDeadline(0),
+          mTailCallDepth(0),
+          mYieldSpinLimit(ADAPTIVE_SPIN_LIMIT_MIN),
+          mYieldLastProcessedCount(0),
+          mWorkerCondition(0),
+          mNumSleepingWorkers(0),
+          mSharedParallelTask(0),
+          mParallelBusy(0),
+          mFallbackHandlers(fallbackHandlers),
+          mMessageCache(messageAllocator),
+          mDeferredFrees(&mMessageCache),
+          mScratchAllocator()
+        {
+        }
+
+        Directory<Mailbox> *const mMailboxes;                   ///< Pointer to the array of mailboxes serviced by this context.
+        SpinLock *const mSharedWorkQueueSpinLock;               ///< Pointer to the spinlock protecting the shared work queue.
+        WorkQueue mWorkQueue;                                   ///< Work queue owned by this context; serves as the shared queue of the per-framework context.
+        WorkQueue mHighPriorityQueue;                           ///< Queue of high-priority mailboxes; only used in the per-framework context.
+        WorkQueue mDeadlineQueue;                               ///< Queue of mailboxes holding deadline-carrying messages; only used in the per-framework context.
+        WorkStealingQueue mLocalQueue;                          ///< Stealable local work queue owned by this context.
+        WorkQueue *mSharedWorkQueue;                            ///< Pointer to the shared work queue, used as the spill path when local queues fill up.
+        WorkQueue *mSharedHighPriorityWorkQueue;                ///< Pointer to the shared queue of high-priority mailboxes.
+        WorkQueue *mSharedDeadlineWorkQueue;                    ///< Pointer to the shared queue of mailboxes holding deadline-carrying messages.
+        WorkStealingQueue *mLocalWorkQueue;                     ///< Pointer to the local work queue; zero in non-worker contexts.
+        Context **mWorkerContexts;                              ///< Shared array of pointers to the contexts of all worker threads in the framework.
+        Atomic::UInt32 *mWorkerContextCount;                    ///< Pointer to the count of valid entries in the worker context array.
+        uint32_t mStealSeed;                                    ///< Pseudo-random state used to select steal victims.
+        uint32_t mNumaNode;                                     ///< Index of the NUMA node the owning worker thread is bound to; zero in non-worker contexts.
+        uint32_t mSchedulerId;                                  ///< Identifier of the scheduler policy driving this context's queue selection.
+        uint32_t mMessageBatchSize;                             ///< Maximum number of messages processed from a mailbox per scheduling event.
+        uint32_t mHandlerBudgetMicroseconds;                    ///< Processing time budget of one scheduling event; zero for no budget.
+        uint64_t mBudgetDeadline;                               ///< Absolute deadline of the scheduling event in progress; zero when no budget is set.
+        uint32_t mTailCallDepth;                                ///< Current nesting depth of inlined tail send processing on this thread.
+        uint32_t mYieldSpinLimit;                               ///< Spin budget of the adaptive yield strategy, tuned to the work arrival rate observed by this thread.
+        uint32_t mYieldLastProcessedCount;                      ///< Processed message count sampled at the start of the last idle episode, by the adaptive yield strategy.
+        Condition *mWorkerCondition;                            ///< Pointer to the shared condition workers sleep on; zero unless the blocking yield strategy is used.
+        Atomic::UInt32 *mNumSleepingWorkers;                    ///< Pointer to the count of workers currently sleeping on the condition.
+        Atomic::Pointer *mSharedParallelTask;                   ///< Pointer to the shared slot holding the active parallel compute task, if any.
+        Atomic::UInt32 mParallelBusy;                           ///< Set while the owning thread examines the shared task; lets publishers wait out stragglers.
+        FallbackHandlerCollection *const mFallbackHandlers;     ///< Pointer to fallback handlers for undelivered messages.
+        CachingAllocator<32> mMessageCache;                     ///< Per-thread cache of free message memory blocks.
+        DeferredFreeList mDeferredFrees;                        ///< Per-thread list of processed message blocks awaiting batched return to the cache.
+        ArenaAllocator mScratchAllocator;                       ///< Per-thread bump arena for handler-side temporaries, reset after each processed message.
+        NameCache mNameCache;                                   ///< Per-thread cache of resolved name-to-index lookups.
+        FrameworkCache mFrameworkCache;                         ///< Per-thread cache of resolved framework directory lookups.
+
+#if THERON_ENABLE_TRACING
+        TraceBuffer mTraceBuffer;                               ///< Ring buffer of timestamped scheduling events; best-effort in the shared per-framework context, which is used by many threads.
+#endif // THERON_ENABLE_TRACING
+
+#if THERON_ENABLE_MESSAGE_STATS
+        MessageTypeStats mMessageStats;                         ///< Per-thread counts of messages by registered type; best-effort in the shared per-framework context, which is used by many threads.
+#endif // THERON_ENABLE_MESSAGE_STATS
+
+        YieldImplementation mYield;                             ///< Thread yield strategy implementation.
+        mutable CounterSlots mCounters;                         ///< Event counters, written with plain stores by the owning thread; mutable so const query methods can reset them.
+
+    private:
+
+        Context(const Context &other);
+        Context &operator=(const Context &other);
+    };
+
+    /**
+    Processes the work queue.
+
+    Queue selection and steal victim ordering are owned by the scheduler
+    policy selected in the context, dispatched here with a switch so the
+    queue operations of each policy inline into the loop; see Scheduler.h.
+    */
+    THERON_FORCEINLINE static void Process(Context *const context)
+    {
+        Mailbox *mailbox(0);
+
+        switch (context->mSchedulerId)
+        {
+            case SCHEDULER_ID_FIFO:     mailbox = FifoScheduler<Context>::Select(context);      break;
+            case SCHEDULER_ID_LOCALITY: mailbox = LocalityScheduler<Context>::Select(context);  break;
+            case SCHEDULER_ID_DEFAULT:
+            default:                    mailbox = DefaultScheduler<Context>::Select(context);   break;
+        }
+
+        if (mailbox)
+        {
+            // Non-inlined call.
+            ProcessMailbox(context, mailbox);
+
+            context->mYield.Reset();
+            return;
+        }
+
+        // With no mailbox work available, lend this thread to any parallel
+        // compute task published by an actor, before yielding. The busy flag
+        // brackets the examination so the publisher, which owns the task's
+        // storage, can wait out stragglers before retiring it.
+        if (context->mSharedParallelTask)
+        {
+            context->mParallelBusy.Store(1);
+
+            ParallelTask *const task(reinterpret_cast<ParallelTask *>(context->mSharedParallelTask->Load()));
+            uint32_t executed(0);
+            if (task)
+            {
+                executed = task->ExecuteChunks();
+            }
+
+            context->mParallelBusy.Store(0);
+
+            if (executed)
+            {
+                context->mYield.Reset();
+                return;
+            }
+        }
+
+        // Yield to prevent busy-waiting on the work queue forever.
+        context->mCounters[Theron::COUNTER_YIELDS].Increment();
+        context->mYield.Execute(context);
+    }
+
+    /**
+    Schedules a mailbox for processing.
+
+    Mailboxes scheduled by worker threads are pushed onto the worker's own
+    stealable local queue, falling back to the shared queue when the local
+    queue is full. Mailboxes scheduled by non-worker threads, which have no
+    local queue, always go to the shared queue.
+    */
+    THERON_FORCEINLINE static void Schedule(
+        Context *const context,
+        Mailbox *const mailbox,
+        const bool localQueue)
+    {
+#if THERON_ENABLE_TRACING
+        // Mailboxes are identified in traces by the hash of their name, which both
+        // the sending and processing sides can compute without a directory lookup.
+        context->mTraceBuffer.Record(TraceBuffer::EVENT_MAILBOX_SCHEDULE, mailbox->GetName().GetHash());
+#endif // THERON_ENABLE_TRACING
+
+        // High-priority mailboxes bypass the local queues and go to a dedicated
+        // shared queue, which all workers drain ahead of any other work.
+        // A mailbox holding a message with inherited priority counts as
+        // high-priority too, so prioritized chains stay expedited at every hop.
+        if (mailbox->HasHighPriority() || mailbox->HasInheritedPriority())
+        {
+            context->mSharedWorkQueueSpinLock->Lock();
+            context->mSharedHighPriorityWorkQueue->Push(mailbox);
+            context->mSharedWorkQueueSpinLock->Unlock();
+
+            context->mCounters[Theron::COUNTER_SHARED_PUSHES].Increment();
+        }
+        else if (mailbox->GetEarliestDeadline() != 0)
+        {
+            // Mailboxes holding deadline-carrying messages go to a dedicated
+            // shared queue, which workers drain earliest-deadline-first ahead
+            // of normal work. The deadline is snapshotted into the ordering
+            // key of the queued item, which the queue orders by.
+            mailbox->mOrderingKey = mailbox->GetEarliestDeadline();
+
+            context->mSharedWorkQueueSpinLock->Lock();
+            context->mSharedDeadlineWorkQueue->Push(mailbox);
+            context->mSharedWorkQueueSpinLock->Unlock();
+
+            context->mCounters[Theron::COUNTER_SHARED_PUSHES].Increment();
+        }
+        else
+        {
+            // The local queue in a per-thread context is only accessed by the owning
+            // thread and thieves, so doesn't need the shared queue lock.
+            // Under the arrival-order scheduler policy, normal-priority work is
+            // kept off the local queues so the shared queue carries it in a
+            // single global order.
+            bool pushed(false);
+            if (localQueue && context->mLocalWorkQueue && context->mSchedulerId != SCHEDULER_ID_FIFO)
+            {
+                pushed = context->mLocalWorkQueue->Push(mailbox);
+
+                if (pushed)
+                {
+                    context->mCounters[Theron::COUNTER_LOCAL_PUSHES].Increment();
+
+                    // The peak counter of a per-thread context is only written by the
+                    // owning thread, so the read-modify-write doesn't race.
+                    UpdatePeakCounter(context, Theron::COUNTER_PEAK_LOCAL_QUEUE_DEPTH, context->mLocalWorkQueue->Size());
+                }
+                else
+                {
+                    context->mCounters[Theron::COUNTER_LOCAL_QUEUE_SPILLS].Increment();
+                }
+            }
+
+            if (!pushed)
+            {
+                // Because the shared work queue is accessed by multiple threads we have to protect it.
+                context->mSharedWorkQueueSpinLock->Lock();
+                context->mSharedWorkQueue->Push(mailbox);
+
+                // Sampled under the lock, so concurrent peak updates are serialized;
+                // the true peak is the maximum recorded over all contexts.
+                UpdatePeakCounter(context, Theron::COUNTER_PEAK_SHARED_QUEUE_DEPTH, context->mSharedWorkQueue->Count());
+
+                context->mSharedWorkQueueSpinLock->Unlock();
+
+                context->mCounters[Theron::COUNTER_SHARED_PUSHES].Increment();
+            }
+        }
+
+        // Wake a sleeping worker, if any, so the mailbox is processed promptly.
+        // The sleeper count is only non-zero under the blocking yield strategy.
+        Atomic::UInt32 *const numSleepingWorkers(context->mNumSleepingWorkers);
+        if (numSleepingWorkers && numSleepingWorkers->Load() > 0)
+        {
+            // Taking the lock closes the race with a worker that has re-checked
+            // the queues and is about to sleep, but hasn't started waiting yet.
+            Condition *const condition(context->mWorkerCondition);
+            condition->Lock();
+            condition->Pulse();
+            condition->Unlock();
+        }
+    }
+
+    /**
+    Schedules a mailbox for processing after a tail send.
+
+    A tail send is the sending handler's last action, so the calling worker
+    thread is about to become free; when the caller is a worker thread and the
+    nesting depth is within bounds, the mailbox is processed immediately on
+    the calling thread instead of being queued, collapsing the queue
+    round-trip that pipelined actors otherwise pay per hop.
+
+    \note May only be called by the thread that just became responsible for
+    scheduling the mailbox, by pushing a message into it while it was idle.
+    */
+    THERON_FORCEINLINE static void TailSchedule(
+        Context *const context,
+        Mailbox *const mailbox,
+        const bool localQueue)
+    {
+        // Inline processing is bounded in depth, since each nested level executes
+        // on the stack of the last; deeper chains fall back to being queued.
+        if (context->mLocalWorkQueue && context->mTailCallDepth < MAX_TAIL_CALL_DEPTH)
+        {
+            ++context->mTailCallDepth;
+
+            // Non-inlined call.
+            ProcessMailbox(context, mailbox);
+
+            --context->mTailCallDepth;
+            return;
+        }
+
+        Schedule(context, mailbox, localQueue);
+    }
+
+    static void YieldPolite(Context *const context, uint32_t &counter);
+    static void YieldStrong(Context *const context, uint32_t &counter);
+    static void YieldAggressive(Context *const context, uint32_t &counter);
+    static void YieldBlocking(Context *const context, uint32_t &counter);
+    static void YieldAdaptive(Context *const context, uint32_t &counter);
+
+private:
+
+    /**
+    Upper bound on the time a blocked worker sleeps before re-checking for work.
+    */
+    static const uint32_t WAIT_TIMEOUT_MILLISECONDS = 50;
+
+    /**
+    Bounds on the per-thread spin budget of the adaptive yield strategy.
+    The budget doubles and halves between these bounds as work arrives and dries up.
+    */
+    static const uint32_t ADAPTIVE_SPIN_LIMIT_MIN = 10;
+    static const uint32_t ADAPTIVE_SPIN_LIMIT_MAX = 160;
+
+    /**
+    Upper bound on the nesting depth of inlined tail send processing, limiting stack growth.
+    */
+    static const uint32_t MAX_TAIL_CALL_DEPTH = 32;
+
+    Processor();
+    Processor(const Processor &other);
+    Processor &operator=(const Processor &other);
+
+    static void ProcessMailbox(Context *const context, Mailbox *const mailbox);
+
+    /**
+    Raises a high water mark counter to the given depth, if it is higher.
+    \note The caller guarantees that concurrent updates of the counter are serialized.
+    */
+    THERON_FORCEINLINE static void UpdatePeakCounter(
+        Context *const context,
+        const Counter counter,
+        const uint32_t depth)
+    {
+        CounterSlot &peak(context->mCounters[counter]);
+        if (depth > peak.Load())
+        {
+            peak.Store(depth);
+        }
+    }
+
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_MAILBOXPROCESSOR_PROCESSOR_H
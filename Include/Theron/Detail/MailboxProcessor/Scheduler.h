@@ -0,0 +1,388 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXPROCESSOR_SCHEDULER_H
+#define THERON_DETAIL_MAILBOXPROCESSOR_SCHEDULER_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Counters.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/MailboxProcessor/CounterSlots.h>
+#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
+#include <Theron/Detail/MailboxProcessor/WorkStealingQueue.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Identifiers of the built-in scheduler policies.
+
+These are the internal values of the public \ref Theron::SchedulerPolicy enum,
+mapped by the framework when it sets up the processor contexts of its workers.
+*/
+enum SchedulerId
+{
+    SCHEDULER_ID_DEFAULT = 0,       ///< Locality-preferring policy; the historical behavior.
+    SCHEDULER_ID_FIFO,              ///< Arrival-order policy; shared work ahead of local work.
+    SCHEDULER_ID_LOCALITY           ///< Strict locality policy; shared work as a late resort.
+};
+
+
+/**
+Shared building blocks of the scheduler policy classes.
+
+A scheduler policy owns the queue selection order and the steal victim ordering
+of the worker threads: each policy class provides a static Select method that
+returns the next mailbox the calling worker should process, or null when no
+work could be found. Policies compose the individual queue operations defined
+here, which makes the ordering differences between policies explicit in their
+Select methods.
+
+The policies are class templates parameterized on the processor context type
+rather than implementations of a virtual interface, so that the processing loop
+dispatches to the selected policy with a switch on a plain integer and the
+queue operations of the chosen policy inline into the loop; in particular the
+default policy pays no indirect calls.
+*/
+template <class ContextType>
+class SchedulerCore
+{
+public:
+
+    /**
+    Victim subsets a steal scan can be restricted to, relative to the thief's NUMA node.
+    */
+    enum StealPass
+    {
+        STEAL_SAME_NODE,            ///< Consider only victims bound to the thief's own node.
+        STEAL_REMOTE_NODE,          ///< Consider only victims bound to other nodes.
+        STEAL_ANY_NODE              ///< Consider all victims regardless of node.
+    };
+
+    /**
+    Pops a mailbox from the shared high-priority queue, which all policies
+    drain ahead of other work so latency-critical actors aren't queued behind
+    bulk processing.
+    */
+    THERON_FORCEINLINE static Mailbox *PopHighPriority(ContextType *const context)
+    {
+        WorkQueue *const highPriorityQueue(context->mSharedHighPriorityWorkQueue);
+        Mailbox *mailbox(0);
+
+        // Peek without locking to check for work.
+        if (!highPriorityQueue->Empty())
+        {
+            SpinLock *const spinLock(context->mSharedWorkQueueSpinLock);
+
+            spinLock->Lock();
+            mailbox = static_cast<Mailbox *>(highPriorityQueue->Pop());
+            spinLock->Unlock();
+        }
+
+        return mailbox;
+    }
+
+    /**
+    Pops the mailbox with the earliest deadline from the shared deadline queue,
+    so the message with the tightest deadline waits the least.
+    */
+    THERON_FORCEINLINE static Mailbox *PopDeadline(ContextType *const context)
+    {
+        WorkQueue *const deadlineQueue(context->mSharedDeadlineWorkQueue);
+        Mailbox *mailbox(0);
+
+        if (!deadlineQueue->Empty())
+        {
+            SpinLock *const spinLock(context->mSharedWorkQueueSpinLock);
+
+            spinLock->Lock();
+            mailbox = static_cast<Mailbox *>(deadlineQueue->PopEarliest());
+            spinLock->Unlock();
+        }
+
+        return mailbox;
+    }
+
+    /**
+    Pops a mailbox from the calling worker's own stealable local queue.
+    */
+    THERON_FORCEINLINE static Mailbox *PopLocal(ContextType *const context)
+    {
+        return static_cast<Mailbox *>(context->mLocalQueue.Pop());
+    }
+
+    /**
+    Pops a batch of mailboxes from the shared queue, returning the first and
+    queueing the rest on the calling worker's local queue.
+
+    The batch is proportional to the queue depth, so a worker draining a burst
+    makes one round-trip through the lock per batch rather than per mailbox.
+    Half the depth is left behind for the other workers, and the local-queued
+    remainder can be stolen back if this worker is slow.
+    */
+    THERON_FORCEINLINE static Mailbox *PopSharedBatch(ContextType *const context)
+    {
+        WorkQueue *const sharedWorkQueue(context->mSharedWorkQueue);
+
+        // Peek at the shared queue without locking it to check for work.
+        // The shared queue holds work submitted by non-worker threads, plus spilled work.
+        if (sharedWorkQueue->Empty())
+        {
+            return 0;
+        }
+
+        SpinLock *const spinLock(context->mSharedWorkQueueSpinLock);
+        WorkItem *batch[SHARED_POP_BATCH_MAX];
+
+        spinLock->Lock();
+
+        uint32_t batchSize((sharedWorkQueue->Count() + 1) / 2);
+        if (batchSize > SHARED_POP_BATCH_MAX)
+        {
+            batchSize = SHARED_POP_BATCH_MAX;
+        }
+
+        const uint32_t numPopped(sharedWorkQueue->PopMany(batch, batchSize));
+        spinLock->Unlock();
+
+        if (numPopped == 0)
+        {
+            return 0;
+        }
+
+        // Queue the rest of the batch on the local queue before processing,
+        // so other workers can steal it back if this one is slow. The local
+        // queue is near-empty on this path, so the batch always fits, but
+        // any overflow is returned to the shared queue rather than lost.
+        uint32_t numSpilled(0);
+        for (uint32_t index = 1; index < numPopped; ++index)
+        {
+            if (!context->mLocalQueue.Push(batch[index]))
+            {
+                batch[numSpilled++] = batch[index];
+            }
+        }
+
+        if (numSpilled)
+        {
+            spinLock->Lock();
+            for (uint32_t index = 0; index < numSpilled; ++index)
+            {
+                sharedWorkQueue->Push(batch[index]);
+            }
+            spinLock->Unlock();
+        }
+
+        if (numPopped > 1)
+        {
+            // The peak counter of a per-thread context is only written by the
+            // owning thread, so the read-modify-write doesn't race.
+            CounterSlot &peak(context->mCounters[Theron::COUNTER_PEAK_LOCAL_QUEUE_DEPTH]);
+            const uint32_t depth(context->mLocalQueue.Size());
+            if (depth > peak.Load())
+            {
+                peak.Store(depth);
+            }
+        }
+
+        return static_cast<Mailbox *>(batch[0]);
+    }
+
+    /**
+    Pops a single mailbox from the shared queue, preserving arrival order.
+
+    Unlike \ref PopSharedBatch this leaves the remaining work on the shared
+    queue, so the workers collectively consume it in the order it arrived
+    rather than redistributing it across their local queues.
+    */
+    THERON_FORCEINLINE static Mailbox *PopSharedSingle(ContextType *const context)
+    {
+        WorkQueue *const sharedWorkQueue(context->mSharedWorkQueue);
+        Mailbox *mailbox(0);
+
+        if (!sharedWorkQueue->Empty())
+        {
+            SpinLock *const spinLock(context->mSharedWorkQueueSpinLock);
+
+            spinLock->Lock();
+            mailbox = static_cast<Mailbox *>(sharedWorkQueue->Pop());
+            spinLock->Unlock();
+        }
+
+        return mailbox;
+    }
+
+    /**
+    Tries to steal a mailbox from the local queue of another worker thread,
+    scanning the victims of the given pass in pseudo-random order to spread
+    thieves across victims.
+    */
+    THERON_FORCEINLINE static Mailbox *Steal(ContextType *const context, const StealPass stealPass)
+    {
+        ContextType **const workerContexts(context->mWorkerContexts);
+        if (workerContexts == 0)
+        {
+            return 0;
+        }
+
+        const uint32_t workerCount(context->mWorkerContextCount->Load());
+        if (workerCount < 2)
+        {
+            return 0;
+        }
+
+        // Use a cheap xorshift generator to randomize the scan start,
+        // spreading thieves across victims to reduce contention.
+        uint32_t seed(context->mStealSeed);
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        context->mStealSeed = seed;
+
+        const uint32_t node(context->mNumaNode);
+        for (uint32_t offset = 0; offset < workerCount; ++offset)
+        {
+            ContextType *const victim(workerContexts[(seed + offset) % workerCount]);
+            if (victim == context)
+            {
+                continue;
+            }
+
+            // Restrict the scan to the victims of the requested pass.
+            const bool sameNode(victim->mNumaNode == node);
+            if ((stealPass == STEAL_SAME_NODE && !sameNode) ||
+                (stealPass == STEAL_REMOTE_NODE && sameNode))
+            {
+                continue;
+            }
+
+            Mailbox *const mailbox(static_cast<Mailbox *>(victim->mLocalQueue.Steal()));
+            if (mailbox)
+            {
+                context->mCounters[Theron::COUNTER_MAILBOX_STEALS].Increment();
+                if (!sameNode)
+                {
+                    context->mCounters[Theron::COUNTER_CROSS_NODE_STEALS].Increment();
+                }
+
+                return mailbox;
+            }
+        }
+
+        return 0;
+    }
+
+private:
+
+    /**
+    Upper bound on the number of mailboxes popped from the shared work queue in
+    one lock acquisition. Caps the time the queue is held locked against pushers
+    and the share of a burst any one worker can claim.
+    */
+    static const uint32_t SHARED_POP_BATCH_MAX = 16;
+};
+
+
+/**
+Default scheduler policy, implementing the historical queue selection order.
+
+Priority lanes are drained first, then the worker's own local queue for cache
+locality, then a batch from the shared queue; stealing from other workers is
+the last resort, trying victims bound to the same NUMA node before remote
+ones, since stealing a mailbox across nodes drags its cache lines over the
+interconnect. On single-node systems all victims fall into the same-node pass.
+*/
+template <class ContextType>
+class DefaultScheduler
+{
+public:
+
+    THERON_FORCEINLINE static Mailbox *Select(ContextType *const context)
+    {
+        typedef SchedulerCore<ContextType> Core;
+
+        Mailbox *mailbox(0);
+        if ((mailbox = Core::PopHighPriority(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopDeadline(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopLocal(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopSharedBatch(context)) != 0) return mailbox;
+        if ((mailbox = Core::Steal(context, Core::STEAL_SAME_NODE)) != 0) return mailbox;
+        return Core::Steal(context, Core::STEAL_REMOTE_NODE);
+    }
+};
+
+
+/**
+Arrival-order scheduler policy.
+
+The shared queue is drained ahead of local work and one mailbox at a time, so
+mailboxes are processed in an order close to the order they became ready in,
+at the cost of more lock traffic and colder caches. The scheduling side keeps
+normal-priority work off the local queues under this policy, funnelling it
+through the shared queue so the order is global rather than per-worker.
+Priority lanes are still drained first; they reorder work by design.
+*/
+template <class ContextType>
+class FifoScheduler
+{
+public:
+
+    THERON_FORCEINLINE static Mailbox *Select(ContextType *const context)
+    {
+        typedef SchedulerCore<ContextType> Core;
+
+        Mailbox *mailbox(0);
+        if ((mailbox = Core::PopHighPriority(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopDeadline(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopSharedSingle(context)) != 0) return mailbox;
+
+        // Local queues only hold work that predates a policy change at runtime,
+        // but it must still be drained, and stolen from, so none is stranded.
+        if ((mailbox = Core::PopLocal(context)) != 0) return mailbox;
+        return Core::Steal(context, Core::STEAL_ANY_NODE);
+    }
+};
+
+
+/**
+Strict locality scheduler policy.
+
+The worker's own local queue and the local queues of same-node workers are
+exhausted before the shared queue is touched, keeping each worker on work
+whose cache lines are already warm nearby; remote-node steals remain the
+absolute last resort so no work is ever stranded. Compared to the default
+policy this favors throughput on partitioned workloads over the latency of
+work arriving through the shared queue.
+*/
+template <class ContextType>
+class LocalityScheduler
+{
+public:
+
+    THERON_FORCEINLINE static Mailbox *Select(ContextType *const context)
+    {
+        typedef SchedulerCore<ContextType> Core;
+
+        Mailbox *mailbox(0);
+        if ((mailbox = Core::PopHighPriority(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopDeadline(context)) != 0) return mailbox;
+        if ((mailbox = Core::PopLocal(context)) != 0) return mailbox;
+        if ((mailbox = Core::Steal(context, Core::STEAL_SAME_NODE)) != 0) return mailbox;
+        if ((mailbox = Core::PopSharedBatch(context)) != 0) return mailbox;
+        return Core::Steal(context, Core::STEAL_REMOTE_NODE);
+    }
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MAILBOXPROCESSOR_SCHEDULER_H
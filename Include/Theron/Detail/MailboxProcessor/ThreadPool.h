@@ -29,6 +29,12 @@ class ThreadPool
 {
 public:
 
+    /**
+    Worker processor value indicating that a thread isn't pinned to a single processor.
+    Unpinned threads get the mask-based node and processor affinity instead.
+    */
+    static const uint32_t NO_PROCESSOR = 0xFFFFFFFF;
+
     /**
     User-allocated per-thread context structure.
     The client must allocate one of these for each thread it creates.
@@ -45,6 +51,7 @@ public:
           mWorkerContext(workerContext),
           mNodeMask(0),
           mProcessorMask(0),
+          mWorkerProcessor(NO_PROCESSOR),
           mRunning(false),
           mStarted(false),
           mThread(0)
@@ -57,6 +64,7 @@ public:
         // Internal
         uint32_t mNodeMask;                     ///< Bit-field NUMA node affinity mask for the created thread.
         uint32_t mProcessorMask;                ///< Bit-field processor affinity mask within specified nodes.
+        uint32_t mWorkerProcessor;              ///< Index of the single processor the thread is pinned to, or NO_PROCESSOR.
         bool mRunning;                          ///< Indicates whether the thread is running; used to stop running threads.
         bool mStarted;                          ///< Indicates whether the thread has started.
         Thread *mThread;                        ///< Pointer to the thread object.
@@ -74,11 +82,14 @@ public:
     \param workQueue Pointer to the shared work queue that the thread will service.
     \param nodeMask Bit-mask specifying on which NUMA processor nodes the thread may execute.
     \param processorMask Bit-mask specifying a subset of the processors in each indicated NUMA processor node.
+    \param workerProcessor Index of a single processor to pin the thread to, or NO_PROCESSOR
+    to give the thread the mask-based affinity shared by all the threads of the pool.
     */
     inline static bool StartThread(
         ThreadContext *const threadContext,
         const uint32_t nodeMask,
-        const uint32_t processorMask);
+        const uint32_t processorMask,
+        const uint32_t workerProcessor = NO_PROCESSOR);
 
     /**
     Stops the given thread, which must have been started with StartThread.
@@ -140,7 +151,8 @@ template <class WorkProcessor, class WorkerContext>
 inline bool ThreadPool<WorkProcessor, WorkerContext>::StartThread(
     ThreadContext *const threadContext,
     const uint32_t nodeMask,
-    const uint32_t processorMask)
+    const uint32_t processorMask,
+    const uint32_t workerProcessor)
 {
     THERON_ASSERT(threadContext->mRunning == false);
     THERON_ASSERT(threadContext->mThread);
@@ -148,6 +160,7 @@ inline bool ThreadPool<WorkProcessor, WorkerContext>::StartThread(
 
     threadContext->mNodeMask = nodeMask;
     threadContext->mProcessorMask = processorMask;
+    threadContext->mWorkerProcessor = workerProcessor;
     threadContext->mRunning = true;
 
     // Start the thread, running it via a static (non-member function) entry point that wraps the real member function.
@@ -213,8 +226,16 @@ inline void ThreadPool<WorkProcessor, WorkerContext>::ThreadEntryPoint(void *con
     // The context structure is specific to this worker thread.
     ThreadContext *const threadContext(reinterpret_cast<ThreadContext *>(context));
 
-    // Set the NUMA node and processor affinity for the running thread.
-    Utils::SetThreadAffinity(threadContext->mNodeMask, threadContext->mProcessorMask);
+    // Pin the thread to its dedicated processor, if one was assigned; otherwise
+    // set the NUMA node and processor affinity shared by the threads of the pool.
+    if (threadContext->mWorkerProcessor != NO_PROCESSOR)
+    {
+        Utils::PinThreadToProcessor(threadContext->mWorkerProcessor);
+    }
+    else
+    {
+        Utils::SetThreadAffinity(threadContext->mNodeMask, threadContext->mProcessorMask);
+    }
 
     // Mark the thread as started so the caller knows they can start issuing work.
     threadContext->mStarted = true;
@@ -4,6 +4,7 @@
 
 
 #include <Theron/Align.h>
+#include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 
 
@@ -26,12 +27,13 @@ class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) WorkItem
 {
 public:
 
-    inline WorkItem() : mNext(0), mPrev(0)
+    inline WorkItem() : mNext(0), mPrev(0), mOrderingKey(0)
     {
     }
 
     WorkItem *mNext;                ///< Pointer to the next item in the list.
     WorkItem *mPrev;                ///< Pointer to the previous item in the list.
+    uint64_t mOrderingKey;          ///< Key used by queues that order their items, eg. by deadline; written by the scheduler as the item is queued.
 
 private:
 
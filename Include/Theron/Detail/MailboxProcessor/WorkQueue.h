@@ -51,6 +51,11 @@ public:
     */
     inline bool Empty() const;
 
+    /**
+    Returns the number of items currently in the queue.
+    */
+    inline uint32_t Count() const;
+
     /**
     Pushes an item onto the queue.
     */
@@ -62,6 +67,21 @@ public:
     */
     inline WorkItem *Pop();
 
+    /**
+    Removes up to the given maximum number of items from the front of the queue,
+    writing them to the provided array in queue order.
+    \return The number of items actually removed, which is zero if the queue is empty.
+    */
+    inline uint32_t PopMany(WorkItem **const items, const uint32_t max);
+
+    /**
+    Removes and returns the queued item with the smallest ordering key.
+    Scans the whole queue, so is intended for queues holding few items at a
+    time, such as the queue of deadline-carrying mailboxes.
+    \note Returns a null pointer if the queue is empty.
+    */
+    inline WorkItem *PopEarliest();
+
 private:
 
     WorkQueue(const WorkQueue &other);
@@ -69,12 +89,14 @@ private:
 
     WorkItem mHead;                     ///< Dummy node that is always the head of the list.
     WorkItem mTail;                     ///< Dummy node that is always the tail of the list.
+    uint32_t mCount;                    ///< Number of items currently in the queue.
 };
 
 
 inline WorkQueue::WorkQueue() :
   mHead(),
-  mTail()
+  mTail(),
+  mCount(0)
 {
     mHead.mNext = 0;
     mHead.mPrev = &mTail;
@@ -101,6 +123,12 @@ THERON_FORCEINLINE bool WorkQueue::Empty() const
 }
 
 
+THERON_FORCEINLINE uint32_t WorkQueue::Count() const
+{
+    return mCount;
+}
+
+
 THERON_FORCEINLINE void WorkQueue::Push(WorkItem *const item)
 {
     // Doubly-linked list insert at back, ie. in front of the dummy tail.
@@ -109,6 +137,8 @@ THERON_FORCEINLINE void WorkQueue::Push(WorkItem *const item)
 
     mTail.mNext->mPrev = item;
     mTail.mNext = item;
+
+    ++mCount;
 }
 
 
@@ -123,6 +153,7 @@ THERON_FORCEINLINE WorkItem *WorkQueue::Pop()
         item->mPrev->mNext = &mHead;
         mHead.mPrev = item->mPrev;
 
+        --mCount;
         return item;
     }
 
@@ -130,6 +161,58 @@ THERON_FORCEINLINE WorkItem *WorkQueue::Pop()
 }
 
 
+THERON_FORCEINLINE uint32_t WorkQueue::PopMany(WorkItem **const items, const uint32_t max)
+{
+    uint32_t count(0);
+
+    while (count < max)
+    {
+        WorkItem *const item(mHead.mPrev);
+
+        if (item == &mTail)
+        {
+            break;
+        }
+
+        // Doubly-linked list remove from front, ie. behind the dummy head.
+        item->mPrev->mNext = &mHead;
+        mHead.mPrev = item->mPrev;
+
+        --mCount;
+        items[count++] = item;
+    }
+
+    return count;
+}
+
+
+THERON_FORCEINLINE WorkItem *WorkQueue::PopEarliest()
+{
+    WorkItem *earliest(0);
+
+    // Scan from the front so that, among items with equal keys, the one
+    // queued first is taken, preserving FIFO order between them.
+    for (WorkItem *item(mHead.mPrev); item != &mTail; item = item->mPrev)
+    {
+        if (earliest == 0 || item->mOrderingKey < earliest->mOrderingKey)
+        {
+            earliest = item;
+        }
+    }
+
+    if (earliest)
+    {
+        // Doubly-linked list remove from an arbitrary position.
+        earliest->mPrev->mNext = earliest->mNext;
+        earliest->mNext->mPrev = earliest->mPrev;
+
+        --mCount;
+    }
+
+    return earliest;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -0,0 +1,234 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXPROCESSOR_WORKSTEALINGQUEUE_H
+#define THERON_DETAIL_MAILBOXPROCESSOR_WORKSTEALINGQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/MailboxProcessor/WorkItem.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A bounded work-stealing deque owned by a single worker thread.
+
+The owning thread pushes and pops work items at the private (bottom) end of the
+deque without locking in the common case, in LIFO order for cache locality.
+Other worker threads steal items from the public (top) end, in FIFO order, using
+a compare-and-swap to resolve races between concurrent thieves and the owner.
+
+The implementation follows the classic Chase-Lev design, simplified to a fixed
+capacity ring buffer: when the deque is full the caller is expected to spill
+the item to the shared work queue instead, so the capacity bounds memory use
+without losing work.
+
+\note Push and Pop may only be called by the owning thread. Steal and Empty
+may be called by any thread.
+*/
+class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) WorkStealingQueue
+{
+public:
+
+    /**
+    Constructor
+    */
+    inline WorkStealingQueue();
+
+    /**
+    Destructor
+    */
+    inline ~WorkStealingQueue();
+
+    /**
+    Returns true if the deque contains no items.
+    \note The result is a snapshot and may be stale by the time it is examined.
+    */
+    inline bool Empty() const;
+
+    /**
+    Returns the number of items currently in the deque.
+    \note The result is a snapshot and may be stale by the time it is examined.
+    */
+    inline uint32_t Size() const;
+
+    /**
+    Pushes an item onto the private end of the deque.
+    \return False if the deque is full, in which case the caller should spill the item elsewhere.
+    \note May only be called by the owning thread.
+    */
+    inline bool Push(WorkItem *const item);
+
+    /**
+    Removes and returns the item most recently pushed onto the private end of the deque.
+    \return A null pointer if the deque is empty.
+    \note May only be called by the owning thread.
+    */
+    inline WorkItem *Pop();
+
+    /**
+    Steals the oldest item from the public end of the deque.
+    \return A null pointer if the deque is empty or the steal was beaten by another thread.
+    \note Safe to call from any thread.
+    */
+    inline WorkItem *Steal();
+
+private:
+
+    /**
+    Number of item slots in the ring buffer, which must be a power of two.
+    */
+    static const uint32_t CAPACITY = 1024;
+
+    WorkStealingQueue(const WorkStealingQueue &other);
+    WorkStealingQueue &operator=(const WorkStealingQueue &other);
+
+    Atomic::UInt32 mTop;                    ///< Index of the public end of the deque, from which items are stolen.
+    Atomic::UInt32 mBottom;                 ///< Index of the private end of the deque, owned by the worker thread.
+    WorkItem *mBuffer[CAPACITY];            ///< Ring buffer of pointers to queued work items.
+
+} THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+
+inline WorkStealingQueue::WorkStealingQueue() :
+  mTop(0),
+  mBottom(0)
+{
+}
+
+
+inline WorkStealingQueue::~WorkStealingQueue()
+{
+    // If the deque hasn't been emptied by the caller we'll leak the items.
+    THERON_ASSERT(mBottom.Load() == mTop.Load());
+}
+
+
+THERON_FORCEINLINE bool WorkStealingQueue::Empty() const
+{
+    return (mBottom.Load() == mTop.Load());
+}
+
+
+THERON_FORCEINLINE uint32_t WorkStealingQueue::Size() const
+{
+    // The indices increase monotonically and wrap, so the size is their difference.
+    return (mBottom.Load() - mTop.Load());
+}
+
+
+THERON_FORCEINLINE bool WorkStealingQueue::Push(WorkItem *const item)
+{
+    THERON_ASSERT(item);
+
+    const uint32_t bottom(mBottom.Load());
+    const uint32_t top(mTop.Load());
+
+    // The indices increase monotonically and wrap, so the size is their difference.
+    if (bottom - top >= CAPACITY)
+    {
+        return false;
+    }
+
+    mBuffer[bottom & (CAPACITY - 1)] = item;
+
+    // Publish the item to thieves only once the buffer slot is written.
+    mBottom.Store(bottom + 1);
+
+    return true;
+}
+
+
+THERON_FORCEINLINE WorkItem *WorkStealingQueue::Pop()
+{
+    uint32_t bottom(mBottom.Load());
+    uint32_t top(mTop.Load());
+
+    // Early-out without touching the bottom index if the deque looks empty.
+    if (bottom == top)
+    {
+        return 0;
+    }
+
+    // Reserve the bottom item before re-examining the top index, so that
+    // concurrent thieves see the reduced size and back off the reserved item.
+    --bottom;
+    mBottom.Store(bottom);
+
+    top = mTop.Load();
+
+    // The deque was emptied by thieves after the initial check.
+    if (static_cast<int32_t>(bottom - top) < 0)
+    {
+        mBottom.Store(top);
+        return 0;
+    }
+
+    WorkItem *item(mBuffer[bottom & (CAPACITY - 1)]);
+
+    // If more than one item remained the reserved item can't be contended.
+    if (bottom != top)
+    {
+        return item;
+    }
+
+    // The reserved item was the last one, so race any concurrent thieves for it.
+    uint32_t expected(top);
+    if (!mTop.CompareExchangeAcquire(expected, top + 1))
+    {
+        item = 0;
+    }
+
+    mBottom.Store(top + 1);
+    return item;
+}
+
+
+THERON_FORCEINLINE WorkItem *WorkStealingQueue::Steal()
+{
+    uint32_t top(mTop.Load());
+    const uint32_t bottom(mBottom.Load());
+
+    if (static_cast<int32_t>(bottom - top) <= 0)
+    {
+        return 0;
+    }
+
+    // Speculatively read the item before claiming it, since the claim publishes the slot for reuse.
+    WorkItem *const item(mBuffer[top & (CAPACITY - 1)]);
+
+    // Claim the item with a compare-and-swap, which fails if another
+    // thief or the owner got there first.
+    if (mTop.CompareExchangeAcquire(top, top + 1))
+    {
+        return item;
+    }
+
+    return 0;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_MAILBOXPROCESSOR_WORKSTEALINGQUEUE_H
@@ -1,266 +1,1288 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
-#define THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
-
-
-#include <Theron/Address.h>
-#include <Theron/Align.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
-#include <Theron/Detail/Network/String.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-
-
-class Actor;
-
-
-namespace Detail
-{
-
-
-/**
-An individual mailbox with a specific address.
-*/
-class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Mailbox : public WorkItem
-{
-public:
-
-    /**
-    Default constructor.
-    */
-    inline Mailbox();
-
-    /**
-    \brief Gets the string name of the mailbox.
-    The name is arbitrary and identifies the actor within the context of the whole system,
-    potentially across multiple connected hosts.
-    */
-    inline String GetName() const;
-
-    /**
-    Sets the name of the mailbox.
-    */
-    inline void SetName(const String &name);
-
-    /**
-    Lock the mailbox, acquiring exclusive access.
-    */
-    inline void Lock() const;
-
-    /**
-    Unlock the mailbox, relinquishing exclusive access.
-    */
-    inline void Unlock() const;
-
-    /**
-    Returns true if the mailbox contains no messages.
-    */
-    inline bool Empty() const;
-
-    /**
-    Pushes a message into the mailbox.
-    */
-    inline void Push(IMessage *const message);
-
-    /**
-    Peeks at the first message in the mailbox.
-    The message is inspected without actually being removed from the mailbox.
-    \return Pointer to a message, if the mailbox is non-empty, otherwise zero.
-    */
-    inline IMessage *Front() const;
-
-    /**
-    Pops the first message from the mailbox.
-    \return Pointer to a message, if the mailbox is non-empty, otherwise zero.
-    */
-    inline IMessage *Pop();
-
-    /**
-    Returns the number of messages currently queued in the mailbox.
-    */
-    inline uint32_t Count() const;
-
-    /**
-    Registers an actor with this mailbox.
-    */
-    inline void RegisterActor(Actor *const actor);
-
-    /**
-    Deregisters the actor registered with this mailbox.
-    */
-    inline void DeregisterActor();
-
-    /**
-    Gets a pointer to the actor registered at this entry, if any.
-    \return A pointer to the registered entity, or zero if no entity is registered.
-    */
-    inline Actor *GetActor() const;
-
-    /**
-    Pins the mailbox, preventing the registered actor from being changed.
-    */
-    inline void Pin();
-
-    /**
-    Unpins the mailbox, allowed the registered actor to be changed.
-    */
-    inline void Unpin();
-
-    /**
-    Returns true if the mailbox has been pinned more times than unpinned.
-    */
-    inline bool IsPinned() const;
-
-private:
-
-    typedef Queue<IMessage> MessageQueue;
-
-    String mName;                               ///< Name of this mailbox.
-    mutable SpinLock mSpinLock;                 ///< Thread synchronization object protecting the mailbox.
-    MessageQueue mQueue;                        ///< Queue of messages in this mailbox.
-    uint32_t mMessageCount;                     ///< Size of the message queue.
-    Actor *mActor;                              ///< Pointer to the actor registered with this mailbox, if any.
-    uint32_t mPinCount;                         ///< Pinning a mailboxes prevents the actor from being deregistered.
-
-} THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
-
-
-inline Mailbox::Mailbox() :
-  mName(),
-  mSpinLock(),
-  mQueue(),
-  mMessageCount(0),
-  mActor(0),
-  mPinCount(0)
-{
-}
-
-
-THERON_FORCEINLINE String Mailbox::GetName() const
-{
-    return mName;
-}
-
-
-THERON_FORCEINLINE void Mailbox::SetName(const String &name)
-{
-    mName = name;
-}
-
-
-THERON_FORCEINLINE void Mailbox::Lock() const
-{
-    mSpinLock.Lock();
-}
-
-
-THERON_FORCEINLINE void Mailbox::Unlock() const
-{
-    mSpinLock.Unlock();
-}
-
-
-THERON_FORCEINLINE bool Mailbox::Empty() const
-{
-    return mQueue.Empty();
-}
-
-
-THERON_FORCEINLINE void Mailbox::Push(IMessage *const message)
-{
-    mQueue.Push(message);
-    ++mMessageCount;
-}
-
-
-THERON_FORCEINLINE IMessage *Mailbox::Front() const
-{
-    return mQueue.Front();
-}
-
-
-THERON_FORCEINLINE IMessage *Mailbox::Pop()
-{
-    --mMessageCount;
-    return mQueue.Pop();
-}
-
-
-THERON_FORCEINLINE uint32_t Mailbox::Count() const
-{
-    return mMessageCount;
-}
-
-
-
-THERON_FORCEINLINE void Mailbox::RegisterActor(Actor *const actor)
-{
-    // Can't register actors while the mailbox is pinned.
-    THERON_ASSERT(mPinCount == 0);
-    THERON_ASSERT(mActor == 0);
-    THERON_ASSERT(actor);
-
-    mActor = actor;
-}
-
-
-THERON_FORCEINLINE void Mailbox::DeregisterActor()
-{
-    // Can't deregister actors while the mailbox is pinned.
-    THERON_ASSERT(mPinCount == 0);
-    THERON_ASSERT(mActor != 0);
-
-    mActor = 0;
-}
-
-
-THERON_FORCEINLINE Actor *Mailbox::GetActor() const
-{
-    return mActor;
-}
-
-
-THERON_FORCEINLINE void Mailbox::Pin()
-{
-    ++mPinCount;
-}
-
-
-THERON_FORCEINLINE void Mailbox::Unpin()
-{
-    THERON_ASSERT(mPinCount > 0);
-    --mPinCount;
-}
-
-
-THERON_FORCEINLINE bool Mailbox::IsPinned() const
-{
-    return (mPinCount > 0);
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
+#define THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
+
+
+#include <new>
+#include <stddef.h>
+
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
+#include <Theron/Detail/Mailboxes/MailboxMessagePool.h>
+#include <Theron/Detail/Mailboxes/MessageQueue.h>
+#include <Theron/Detail/Mailboxes/SpscQueue.h>
+#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+namespace Detail
+{
+
+
+/**
+An individual mailbox with a specific address.
+*/
+class THERON_PREALIGN(THERON_CACHELINE_ALIGNMENT) Mailbox : public WorkItem
+{
+public:
+
+    /**
+    Default constructor.
+    */
+    inline Mailbox();
+
+    /**
+    Destructor.
+    */
+    inline ~Mailbox();
+
+    /**
+    \brief Gets the string name of the mailbox.
+    The name is arbitrary and identifies the actor within the context of the whole system,
+    potentially across multiple connected hosts.
+    */
+    inline String GetName() const;
+
+    /**
+    Sets the name of the mailbox.
+    */
+    inline void SetName(const String &name);
+
+    /**
+    Lock the mailbox, acquiring exclusive access to the registered actor.
+    \note The lock doesn't protect the message queue, which is internally thread-safe.
+    */
+    inline void Lock() const;
+
+    /**
+    Unlock the mailbox, relinquishing exclusive access to the registered actor.
+    */
+    inline void Unlock() const;
+
+    /**
+    Returns true if the mailbox contains no messages.
+    */
+    inline bool Empty() const;
+
+    /**
+    Pushes a message into the mailbox.
+    The push is lock-free, so concurrent producers never spin against each other.
+
+    The message count doubles as the scheduling state of the mailbox, so no
+    separate scheduled flag is maintained: the producer whose push transitions
+    the count from zero is solely responsible for scheduling, and every other
+    push pays only the count increment, with no work-queue interaction. The
+    mailbox is therefore on a work queue at most once at any time, however
+    many producers fan in to it.
+
+    \return True if the mailbox was previously empty, in which case the caller
+    must schedule the mailbox for processing.
+    */
+    inline bool Push(IMessage *const message);
+
+    /**
+    Pushes a message into the mailbox on behalf of an identified producer thread.
+
+    Producers that repeatedly send to the same mailbox are detected and given a
+    dedicated single-producer single-consumer channel ring, bypassing the atomic
+    exchange of the general multi-producer queue. On conflict -- the ring
+    filling up because the consumer has fallen behind -- the channel is revoked
+    and the producer reverts permanently to the general queue.
+
+    \param producer Opaque identity of the producing thread, unique to it for
+    the lifetime of the process, or zero if the calling thread has no stable
+    identity (in which case the push uses the general queue).
+    \return True if the mailbox was previously empty, in which case the caller
+    must schedule the mailbox for processing; as for the plain overload, all
+    other pushes skip the work-queue interaction entirely.
+    */
+    inline bool Push(IMessage *const message, void *const producer);
+
+    /**
+    Moves a message previously popped with \ref Pop onto the stash list,
+    deferring its re-delivery until the stash is released with \ref UnstashAll.
+    The move is an intrusive-list push with no copying or allocation. The
+    message no longer counts as unprocessed, so a mailbox holding only
+    stashed messages isn't scheduled; the caller still releases the message
+    with \ref ReleaseMessage as usual, but must not destroy it.
+    \note May only be called by the worker thread processing the mailbox.
+    */
+    inline void Stash(IMessage *const message);
+
+    /**
+    Splices the whole stash list onto the tail of the replay list in O(1),
+    releasing the stashed messages for re-delivery. Replayed messages are
+    delivered by \ref Pop ahead of the ordinary queues, in the order they
+    were stashed. The released messages count as unprocessed again.
+    \note May only be called by the worker thread processing the mailbox,
+    which guarantees the message count can't transition from zero, so the
+    mailbox never needs scheduling here.
+    */
+    inline void UnstashAll();
+
+    /**
+    Pops the first message from the mailbox.
+    The count of unprocessed messages isn't decremented until the processed
+    message is later released with \ref ReleaseMessage.
+    \return Pointer to a message, or zero if the mailbox is empty or a
+    concurrent push is still in progress.
+    \note May only be called by the worker thread processing the mailbox.
+    */
+    inline IMessage *Pop();
+
+    /**
+    Destroys any queued messages of conflatable types that were displaced in
+    place by newer versions from the same sender, returning their memory to
+    the given allocator.
+    \note May only be called by the worker thread processing the mailbox.
+    */
+    inline void DestroyStaleMessages(IAllocator *const messageAllocator);
+
+    /**
+    Releases a message previously popped with \ref Pop, decrementing the count
+    of unprocessed messages.
+    \return True if the mailbox still contains unprocessed messages, in which
+    case the caller must reschedule the mailbox for processing.
+    */
+    inline bool ReleaseMessage();
+
+    /**
+    Returns the number of messages currently queued in the mailbox.
+    */
+    inline uint32_t Count() const;
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+
+    /**
+    Returns the total size in bytes of the message blocks currently queued.
+    */
+    inline uint32_t GetQueuedBytes() const;
+
+    /**
+    Subtracts the block size of a processed message from the queued-byte tally.
+    \note Called by the worker thread once the message has been processed.
+    */
+    inline void SubtractQueuedBytes(const uint32_t size);
+
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+    /**
+    Registers an actor with this mailbox.
+    */
+    inline void RegisterActor(Actor *const actor);
+
+    /**
+    Deregisters the actor registered with this mailbox.
+    */
+    inline void DeregisterActor();
+
+    /**
+    Gets a pointer to the actor registered at this entry, if any.
+    \return A pointer to the registered entity, or zero if no entity is registered.
+    */
+    inline Actor *GetActor() const;
+
+    /**
+    Pins the mailbox, preventing the registered actor from being changed.
+    */
+    inline void Pin();
+
+    /**
+    Unpins the mailbox, allowed the registered actor to be changed.
+    */
+    inline void Unpin();
+
+    /**
+    Returns true if the mailbox has been pinned more times than unpinned.
+    */
+    inline bool IsPinned() const;
+
+    /**
+    Sets whether the mailbox is scheduled with high priority.
+    High-priority mailboxes are drained by worker threads ahead of all others.
+    */
+    inline void SetHighPriority(const bool highPriority);
+
+    /**
+    Returns true if the mailbox is scheduled with high priority.
+    */
+    inline bool HasHighPriority() const;
+
+    /**
+    Sets the maximum number of unprocessed messages held in the mailbox.
+    A capacity of zero, the default, leaves the mailbox unbounded.
+    */
+    inline void SetCapacity(const uint32_t capacity);
+
+    /**
+    Returns true if the mailbox has a bounded capacity and is currently full.
+    \note The check is made without locking the lock-free message queue, so
+    concurrent producers can each pass it and overshoot the capacity by a
+    message or two; the bound limits queue growth rather than enforcing an
+    exact limit.
+    */
+    inline bool Full() const;
+
+    /**
+    Sets the high and low queue watermarks of the mailbox.
+    A high watermark of zero, the default, disables watermark events.
+    */
+    inline void SetWatermarks(const uint32_t high, const uint32_t low);
+
+    /**
+    Returns true if the queue depth has risen through the high watermark.
+    Each rising edge is reported exactly once, to exactly one of the producers
+    that observe it; further crossings aren't reported until the queue has
+    fallen back to the low watermark.
+    */
+    inline bool RoseAboveWatermark();
+
+    /**
+    Returns true if the queue depth has fallen back to the low watermark after
+    previously rising through the high watermark.
+    \note May only be called by the worker thread processing the mailbox.
+    */
+    inline bool FellBelowWatermark();
+
+    /**
+    Returns the earliest deadline among the messages queued in the mailbox,
+    or zero if none of them carries one.
+    \note Maintained as a heuristic: the value is lowered as deadline-carrying
+    messages are pushed and reset when the mailbox empties, so between those
+    events it can name a deadline that has already been processed. Misses are
+    detected exactly, per message, at processing time.
+    */
+    inline uint64_t GetEarliestDeadline() const;
+
+    /**
+    Returns true if a message carrying inherited high priority has been queued
+    since the mailbox last emptied.
+    \note Maintained as a heuristic like the earliest deadline: set as
+    prioritized messages are pushed and reset when the mailbox empties, so the
+    mailbox rides the high-priority queue until it has drained.
+    */
+    inline bool HasInheritedPriority() const;
+
+    /**
+    Sets the address that messages arriving at this mailbox are forwarded to.
+    Set when the registered actor migrates to a mailbox in another framework,
+    so that messages sent to the old address still reach it.
+    */
+    inline void SetForward(const uint32_t index);
+
+    /**
+    Gets the address index that this mailbox forwards to, or zero if none.
+    */
+    inline uint32_t GetForward() const;
+
+#if THERON_ACTOR_STORE_SIZE
+
+    /**
+    Returns the in-place store embedded in this mailbox, into which a small
+    actor can be constructed so it is co-located with its own mailbox.
+    */
+    THERON_FORCEINLINE void *GetActorStore()
+    {
+        return mActorStore;
+    }
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+    /**
+    Flags the mailbox as belonging to a high-rate actor, enabling (or
+    disabling) the embedded message block micro-pool. While enabled, sends to
+    this mailbox claim message blocks from the pool when they fit, so the
+    actor's steady-state traffic reuses a few resident lines instead of
+    blocks migrating between per-thread allocator caches.
+    */
+    THERON_FORCEINLINE void SetHighRate(const bool highRate)
+    {
+        mMessagePool.SetEnabled(highRate);
+    }
+
+    /**
+    Tries to claim a message block of the given size and alignment from the
+    embedded micro-pool.
+    \return Pointer to a block, or zero if the pool is disabled, exhausted,
+    or the block doesn't fit a slot.
+    */
+    THERON_FORCEINLINE void *ClaimPooledBlock(const uint32_t size, const uint32_t alignment)
+    {
+        return mMessagePool.Claim(size, alignment);
+    }
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+private:
+
+    /**
+    Number of consecutive pushes by the same producer that triggers channel installation.
+    */
+    static const uint32_t CHANNEL_STREAK_THRESHOLD = 16;
+
+    /**
+    Slot holding the queued message of one conflatable type from one sender.
+    The slots of a mailbox are kept in a linked list that grows to the number
+    of distinct (type, sender) pairs seen, keeping the queue depth of bursty
+    conflatable traffic bounded by the number of senders.
+    */
+    struct ConflationSlot
+    {
+        uint32_t mTypeId;                       ///< Type ID of the conflatable message type keyed by this slot.
+        Address mFrom;                          ///< Address of the sender keyed by this slot.
+        IMessage *mMessage;                     ///< The queued message, or zero while the slot is empty.
+        ConflationSlot *mNext;                  ///< Next slot in the mailbox's list of slots.
+    };
+
+    /**
+    Queues a message of a conflatable type, replacing any older message of the
+    same type from the same sender still queued, which is stashed for
+    destruction by the consumer.
+    \param schedule Set to whether the caller must schedule the mailbox.
+    \return False if a slot couldn't be allocated, in which case the caller
+    should push the message to the general queue instead.
+    */
+    inline bool Conflate(IMessage *const message, bool &schedule);
+
+    /**
+    Takes the queued message of one of the occupied conflation slots, if any.
+    \note May only be called by the worker thread processing the mailbox.
+    */
+    inline IMessage *TakeConflated();
+
+    /**
+    Tracks consecutive pushes by the same producer, installing a channel on a long streak.
+    */
+    inline void UpdateChannelStreak(void *const producer);
+
+    /**
+    Tries to install a channel ring owned by the given producer.
+    */
+    inline void TryInstallChannel(void *const producer);
+
+    /**
+    Permanently revokes the channel, reverting its owner to the general queue.
+    */
+    inline void RevokeChannel();
+
+    /**
+    Lowers the earliest-deadline mark of the mailbox to the given deadline, if it is earlier.
+    */
+    inline void UpdateDeadline(const uint64_t deadline);
+
+#if THERON_CPP11
+
+    /**
+    Compile-time audit of the cache line layout of the mailbox.
+    The members are arranged in groups, each padded onto its own cache lines,
+    so that producers pushing messages don't invalidate the lines read by the
+    consumer draining the mailbox. The audit static-asserts that the groups
+    occupy disjoint lines, so a future field can't silently reintroduce false
+    sharing by growing one group into the lines of the next.
+    */
+    inline static void CheckLayout();
+
+#endif // THERON_CPP11
+
+    // Producer-written group. These fields are written by producer threads on
+    // every push: the producer end of the message queue, the scheduling count,
+    // and the racy heuristic state that detects streaks of pushes by a single
+    // producer. The message count is also decremented by the consumer as
+    // messages are released, but is inherently shared with producers.
+    MessageQueue mQueue;                        ///< Lock-free multi-producer single-consumer queue of messages.
+    MessageQueue mUrgentQueue;                  ///< Dedicated lane for messages of urgent types, drained ahead of all others.
+    Atomic::UInt32 mMessageCount;               ///< Count of messages in the mailbox that haven't been fully processed.
+    Atomic::Pointer mLastProducer;              ///< Identity of the last detected producer; updated racily as a heuristic.
+    Atomic::UInt32 mProducerStreak;             ///< Count of consecutive pushes by the last producer; updated racily.
+    Atomic::Pointer mChannelOwner;              ///< Identity of the producer owning the channel; zero if none.
+    Atomic::UInt32 mChannelRevoked;             ///< Set once the channel has been revoked, permanently.
+    Atomic::UInt32 mAboveWatermark;             ///< Set while the queue depth is between the watermarks, having risen through the high one.
+    Atomic::UInt64 mEarliestDeadline;           ///< Earliest deadline among the queued messages; zero if none carries one.
+    Atomic::UInt32 mInheritedPriority;          ///< Set while a queued message carries inherited high priority.
+    mutable SpinLock mConflationLock;           ///< Protects the conflation slots, which are shared by producers and the consumer.
+    ConflationSlot *mConflationSlots;           ///< List of slots holding queued conflatable messages; zero if none were ever pushed.
+    Atomic::UInt32 mConflatedCount;             ///< Count of conflation slots currently holding a queued message.
+    MessageQueue mStaleQueue;                   ///< Displaced older conflatable messages, awaiting destruction by the consumer.
+    Atomic::UInt32 mStaleCount;                 ///< Count of displaced messages awaiting destruction.
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+    Atomic::UInt32 mQueuedBytes;                ///< Total size in bytes of the message blocks currently queued.
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+    uint8_t mProducerPadding[THERON_CACHELINE_ALIGNMENT];   ///< Keeps the producer-written lines away from the consumer-read group.
+
+    // Consumer-read group. These fields are read by the consumer on every pop
+    // or processing event but written only rarely, at registration or
+    // configuration time, so their lines stay clean in the consumer's cache.
+    String mName;                               ///< Name of this mailbox.
+    Actor *mActor;                              ///< Pointer to the actor registered with this mailbox, if any.
+    uint32_t mPinCount;                         ///< Pinning a mailboxes prevents the actor from being deregistered.
+    bool mHighPriority;                         ///< Whether the mailbox is scheduled ahead of normal-priority mailboxes.
+    uint32_t mCapacity;                         ///< Maximum number of unprocessed messages held; zero if unbounded.
+    uint32_t mHighWatermark;                    ///< Queue depth whose crossing triggers a high watermark event; zero if disabled.
+    uint32_t mLowWatermark;                     ///< Queue depth at which a low watermark event rearms the high one.
+    Atomic::UInt32 mForwardIndex;               ///< Address index that arriving messages are forwarded to; zero if none.
+    Atomic::Pointer mChannel;                   ///< Lazily allocated channel ring, atomically published to the consumer.
+
+    // The stash and replay lists are singly-linked through the forward link
+    // that messages inherit from Queue<IMessage>::Node, like the message
+    // queues, and are only ever touched by the consumer, so they live with
+    // the other consumer-only state and need no synchronization.
+    IMessage *mStashHead;                       ///< Oldest message deferred by the registered actor; zero if none.
+    IMessage *mStashTail;                       ///< Newest message deferred by the registered actor; zero if none.
+    uint32_t mStashCount;                       ///< Number of messages currently on the stash list.
+    IMessage *mReplayHead;                      ///< Oldest released message awaiting re-delivery; zero if none.
+    IMessage *mReplayTail;                      ///< Newest released message awaiting re-delivery; zero if none.
+
+    uint8_t mConsumerPadding[THERON_CACHELINE_ALIGNMENT];   ///< Keeps the consumer-read lines away from the lock.
+
+    // Lock group. The lock protecting the registered actor is spun on during
+    // actor registration and taken by the consumer around pinning, so it gets
+    // cache lines of its own: a thread spinning on it invalidates neither the
+    // producer-written nor the consumer-read lines.
+    mutable SpinLock mSpinLock;                 ///< Thread synchronization object protecting the registered actor.
+
+#if THERON_ACTOR_STORE_SIZE
+
+    uint8_t mLockPadding[THERON_CACHELINE_ALIGNMENT];       ///< Keeps the lock's lines away from the co-located actor state.
+
+    // Actor store group. Optional in-place storage for a small actor
+    // co-located with its mailbox, so a processed message reads the mailbox
+    // queue and the actor's state from one contiguous region instead of two
+    // unrelated ones. Eight-byte aligned; actors with stricter alignment
+    // requirements are heap-allocated as usual.
+    uint64_t mActorStore[(THERON_ACTOR_STORE_SIZE + 7) / 8];    ///< In-place storage for a co-located actor.
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+    // Message pool group. Optional micro-pool of preallocated message block
+    // slots, enabled for mailboxes flagged high-rate. The slots are message
+    // payload, written by producers and read by the consumer like queued
+    // blocks anywhere, so the group sits last, after all the mailbox's own
+    // state, where its traffic perturbs none of the groups above.
+    MailboxMessagePool mMessagePool;            ///< Embedded micro-pool of message block slots.
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+} THERON_POSTALIGN(THERON_CACHELINE_ALIGNMENT);
+
+
+inline Mailbox::Mailbox() :
+  mQueue(),
+  mUrgentQueue(),
+  mMessageCount(0),
+  mLastProducer(),
+  mProducerStreak(0),
+  mChannelOwner(),
+  mChannelRevoked(0),
+  mAboveWatermark(0),
+  mEarliestDeadline(0),
+  mInheritedPriority(0),
+  mConflationLock(),
+  mConflationSlots(0),
+  mConflatedCount(0),
+  mStaleQueue(),
+  mStaleCount(0),
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+  mQueuedBytes(0),
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+  mName(),
+  mActor(0),
+  mPinCount(0),
+  mHighPriority(false),
+  mCapacity(0),
+  mHighWatermark(0),
+  mLowWatermark(0),
+  mForwardIndex(0),
+  mChannel(),
+  mStashHead(0),
+  mStashTail(0),
+  mStashCount(0),
+  mReplayHead(0),
+  mReplayTail(0),
+#if THERON_MAILBOX_POOL_SLOTS
+  mSpinLock(),
+  mMessagePool()
+#else
+  mSpinLock()
+#endif // THERON_MAILBOX_POOL_SLOTS
+{
+}
+
+
+#if THERON_CPP11
+
+inline void Mailbox::CheckLayout()
+{
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif // __GNUC__
+
+    // The cache line index of the first and last member of each group.
+    const size_t firstProducerLine(offsetof(Mailbox, mQueue) / THERON_CACHELINE_ALIGNMENT);
+    const size_t lastProducerLine(offsetof(Mailbox, mProducerPadding) / THERON_CACHELINE_ALIGNMENT);
+    const size_t firstConsumerLine(offsetof(Mailbox, mName) / THERON_CACHELINE_ALIGNMENT);
+    const size_t lastConsumerLine(offsetof(Mailbox, mConsumerPadding) / THERON_CACHELINE_ALIGNMENT);
+    const size_t lockLine(offsetof(Mailbox, mSpinLock) / THERON_CACHELINE_ALIGNMENT);
+
+    // The padding members are a full cache line, so a group that grows can
+    // never reach the lines of the next; these checks guard against the
+    // padding being shrunk or the groups being reordered.
+    static_assert(sizeof(mProducerPadding) >= THERON_CACHELINE_ALIGNMENT, "Producer padding must cover a full cache line");
+    static_assert(sizeof(mConsumerPadding) >= THERON_CACHELINE_ALIGNMENT, "Consumer padding must cover a full cache line");
+
+    static_assert(lastProducerLine >= firstProducerLine, "Producer group layout is inconsistent");
+    static_assert(firstConsumerLine > lastProducerLine, "Consumer-read fields share a cache line with producer-written fields");
+    static_assert(lastConsumerLine >= firstConsumerLine, "Consumer group layout is inconsistent");
+    static_assert(lockLine > lastConsumerLine, "The mailbox lock shares a cache line with consumer-read fields");
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+}
+
+#endif // THERON_CPP11
+
+
+inline Mailbox::~Mailbox()
+{
+    // Free the channel ring, if one was ever installed.
+    SpscQueue *const channel(reinterpret_cast<SpscQueue *>(mChannel.Load()));
+    if (channel)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        channel->~SpscQueue();
+        allocator->Free(channel, sizeof(SpscQueue));
+    }
+
+    // Free the conflation slots, if any were ever created. Like messages left
+    // in the queues, any messages still held in the slots are leaked.
+    ConflationSlot *slot(mConflationSlots);
+    while (slot)
+    {
+        ConflationSlot *const next(slot->mNext);
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        allocator->Free(slot, sizeof(ConflationSlot));
+
+        slot = next;
+    }
+}
+
+
+THERON_FORCEINLINE String Mailbox::GetName() const
+{
+    return mName;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetName(const String &name)
+{
+    mName = name;
+}
+
+
+THERON_FORCEINLINE void Mailbox::Lock() const
+{
+    mSpinLock.Lock();
+}
+
+
+THERON_FORCEINLINE void Mailbox::Unlock() const
+{
+    mSpinLock.Unlock();
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Empty() const
+{
+    return (mMessageCount.Load() == 0);
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Push(IMessage *const message)
+{
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+    mQueuedBytes.Add(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+#if THERON_ENABLE_PROFILING
+    // Stamp the enqueue time, so that the delay the message spends queued can
+    // be measured, and attributed to its sender, when it is processed.
+    message->SetEnqueueTicks(ProfileClock::GetTicks());
+#endif // THERON_ENABLE_PROFILING
+
+    // Track the earliest deadline among the queued messages, so the scheduler
+    // can order mailboxes holding deadline-carrying messages by it.
+    const uint64_t deadline(message->GetDeadline());
+    if (deadline)
+    {
+        UpdateDeadline(deadline);
+    }
+
+    // Messages carrying inherited high priority mark the mailbox, so the
+    // scheduler treats it as high-priority until it next empties.
+    if (message->HasHighPriority() && mInheritedPriority.Load() == 0)
+    {
+        mInheritedPriority.Store(1);
+    }
+
+    // Messages of types registered urgent take a dedicated lane, which the
+    // consumer drains ahead of all other queued work, so cancellations and
+    // other control messages aren't delayed behind queued bulk data.
+    const uint32_t typeId(message->GetTypeId());
+    if (MessageTypeRegistry::IsUrgent(typeId))
+    {
+        mUrgentQueue.Push(message);
+    }
+    else if (MessageTypeRegistry::IsConflatable(typeId))
+    {
+        // Messages of conflatable types replace any older queued message of
+        // the same type from the same sender in place, rather than queuing
+        // behind it, keeping the queue depth bounded by the number of senders
+        // during bursts. Replacement doesn't change the message count, so the
+        // mailbox's scheduling state is unaffected.
+        bool schedule(false);
+        if (Conflate(message, schedule))
+        {
+            return schedule;
+        }
+
+        // A slot couldn't be allocated, so the message queues normally.
+        mQueue.Push(message);
+    }
+    else
+    {
+        mQueue.Push(message);
+    }
+
+    // The message count also serves as the scheduling state of the mailbox:
+    // the producer that transitions the count from zero is responsible for
+    // scheduling the mailbox, so it is enqueued at most once at any time.
+    return (mMessageCount.FetchIncrement() == 0);
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Push(IMessage *const message, void *const producer)
+{
+    // Urgent messages always take the urgent lane, and conflatable ones the
+    // conflation slots; pushing either through the channel ring would defeat
+    // their special in-mailbox treatment.
+    const uint32_t typeId(message->GetTypeId());
+    if (producer && !MessageTypeRegistry::IsUrgent(typeId) && !MessageTypeRegistry::IsConflatable(typeId))
+    {
+        if (mChannelOwner.Load() != producer)
+        {
+            UpdateChannelStreak(producer);
+        }
+
+        // Re-checked after the streak update, so that the message whose push
+        // triggered installation is itself routed through the ring. If it went
+        // to the general queue instead, the producer's next message, entering
+        // the ring, would overtake it, since the consumer drains the ring first.
+        if (mChannelOwner.Load() == producer)
+        {
+            // This producer owns the channel, so has exclusive use of the ring.
+            // The message must not be touched once pushed: publishing it to
+            // the ring passes ownership to the consumer, which can process
+            // and destroy it before the producer returns.
+            SpscQueue *const channel(reinterpret_cast<SpscQueue *>(mChannel.Load()));
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+            mQueuedBytes.Add(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+            // Track the earliest deadline among the queued messages, as the
+            // general-queue path does. A deadline recorded for a message the
+            // full ring then refuses is merely conservative: the message
+            // still queues below, and the tracked value is a lower bound.
+            const uint64_t deadline(message->GetDeadline());
+            if (deadline)
+            {
+                UpdateDeadline(deadline);
+            }
+
+            // Inherit the priority of a high-priority message, as the
+            // general-queue path does. Like the deadline above this is
+            // conservative if the full ring refuses the message: the flag
+            // is sticky anyway, and is cleared when the mailbox empties.
+            if (message->HasHighPriority() && mInheritedPriority.Load() == 0)
+            {
+                mInheritedPriority.Store(1);
+            }
+
+#if THERON_ENABLE_PROFILING
+            // Stamped before the push: writing to the message after it has
+            // been published to the ring would race the consumer. If the
+            // full ring refuses it, the general-queue fallback re-stamps.
+            message->SetEnqueueTicks(ProfileClock::GetTicks());
+#endif // THERON_ENABLE_PROFILING
+
+            if (channel->Push(message))
+            {
+                return (mMessageCount.FetchIncrement() == 0);
+            }
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+            // The message wasn't queued, so refund the tally charged above;
+            // the general-queue fallback below charges it again.
+            mQueuedBytes.Subtract(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+            // The ring is full because the consumer has fallen behind; revoke the
+            // channel and fall back to the general queue. The revocation is
+            // permanent so messages pushed to the general queue from here on can
+            // never be overtaken by later ones entering the ring.
+            RevokeChannel();
+        }
+    }
+
+    return Push(message);
+}
+
+
+THERON_FORCEINLINE IMessage *Mailbox::Pop()
+{
+    // The urgent lane jumps the whole queue: messages of urgent types are
+    // delivered before anything else the mailbox holds, however long the
+    // other lanes have been backed up. Within the lane delivery is FIFO.
+    IMessage *const urgent(mUrgentQueue.Pop());
+    if (urgent)
+    {
+        return urgent;
+    }
+
+    // Stashed messages released for re-delivery come back ahead of the
+    // queues, in the order they were originally stashed.
+    if (mReplayHead)
+    {
+        IMessage *const replayed(mReplayHead);
+        mReplayHead = static_cast<IMessage *>(replayed->mFrwd);
+        if (mReplayHead == 0)
+        {
+            mReplayTail = 0;
+        }
+
+        return replayed;
+    }
+
+    // Conflated updates are delivered next: by declaration only their newest
+    // version matters, so delivering them promptly loses nothing, and taking
+    // them out of the slots ahead of the queues frees the slots for reuse.
+    if (mConflatedCount.Load() != 0)
+    {
+        IMessage *const conflated(TakeConflated());
+        if (conflated)
+        {
+            return conflated;
+        }
+    }
+
+    // Drain the channel ring ahead of the general queue. The ring only ever
+    // holds messages that predate its owner's messages in the general queue,
+    // so the preference preserves per-sender ordering; interleaving with other
+    // senders' messages is unordered in any case.
+    SpscQueue *const channel(reinterpret_cast<SpscQueue *>(mChannel.Load()));
+    if (channel)
+    {
+        IMessage *const message(channel->Pop());
+        if (message)
+        {
+            return message;
+        }
+    }
+
+    return mQueue.Pop();
+}
+
+
+THERON_FORCEINLINE void Mailbox::Stash(IMessage *const message)
+{
+    THERON_ASSERT(message);
+
+    // Append to the tail of the stash list, so re-delivery preserves order.
+    message->mFrwd = 0;
+    if (mStashTail)
+    {
+        mStashTail->mFrwd = message;
+    }
+    else
+    {
+        mStashHead = message;
+    }
+
+    mStashTail = message;
+    ++mStashCount;
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+    // The message is still held by the mailbox, so its block counts as queued
+    // again; the consumer subtracted it when it popped the message.
+    mQueuedBytes.Add(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+}
+
+
+THERON_FORCEINLINE void Mailbox::UnstashAll()
+{
+    if (mStashCount == 0)
+    {
+        return;
+    }
+
+    // Splice the whole stash onto the tail of the replay list in one step.
+    if (mReplayTail)
+    {
+        mReplayTail->mFrwd = mStashHead;
+    }
+    else
+    {
+        mReplayHead = mStashHead;
+    }
+
+    mReplayTail = mStashTail;
+
+    // The released messages count as unprocessed again. The consumer calling
+    // this holds at least the message it is currently processing, so the
+    // count can't be transitioning from zero and no scheduling is needed.
+    mMessageCount.Add(mStashCount);
+
+    mStashHead = 0;
+    mStashTail = 0;
+    mStashCount = 0;
+}
+
+
+inline bool Mailbox::Conflate(IMessage *const message, bool &schedule)
+{
+    const uint32_t typeId(message->GetTypeId());
+    const Address from(message->From());
+
+    mConflationLock.Lock();
+
+    // Look for the slot keyed by this type and sender, remembering the first
+    // empty slot seen in case a new key needs one. Empty slots are re-keyed
+    // freely, since only the lock holder examines their keys.
+    ConflationSlot *slot(mConflationSlots);
+    ConflationSlot *empty(0);
+
+    while (slot)
+    {
+        if (slot->mMessage)
+        {
+            if (slot->mTypeId == typeId && slot->mFrom == from)
+            {
+                // Replace the queued older message in place. The message count
+                // is unchanged, so the scheduling state of the mailbox is too.
+                IMessage *const displaced(slot->mMessage);
+                slot->mMessage = message;
+
+                mConflationLock.Unlock();
+
+                // Stash the displaced message for destruction by the consumer,
+                // which has the allocator context that producers lack.
+                mStaleQueue.Push(displaced);
+                mStaleCount.Increment();
+
+                schedule = false;
+                return true;
+            }
+        }
+        else if (empty == 0)
+        {
+            empty = slot;
+        }
+
+        slot = slot->mNext;
+    }
+
+    if (empty == 0)
+    {
+        // Grow the slot list. Each distinct (type, sender) pair pays for its
+        // slot once; thereafter its updates conflate without allocating.
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->Allocate(sizeof(ConflationSlot)));
+
+        if (memory == 0)
+        {
+            mConflationLock.Unlock();
+            return false;
+        }
+
+        empty = new (memory) ConflationSlot();
+        empty->mNext = mConflationSlots;
+        mConflationSlots = empty;
+    }
+
+    empty->mTypeId = typeId;
+    empty->mFrom = from;
+    empty->mMessage = message;
+    mConflatedCount.Increment();
+
+    mConflationLock.Unlock();
+
+    schedule = (mMessageCount.FetchIncrement() == 0);
+    return true;
+}
+
+
+THERON_FORCEINLINE IMessage *Mailbox::TakeConflated()
+{
+    IMessage *message(0);
+
+    mConflationLock.Lock();
+
+    for (ConflationSlot *slot(mConflationSlots); slot; slot = slot->mNext)
+    {
+        if (slot->mMessage)
+        {
+            message = slot->mMessage;
+            slot->mMessage = 0;
+            mConflatedCount.Decrement();
+            break;
+        }
+    }
+
+    mConflationLock.Unlock();
+
+    return message;
+}
+
+
+THERON_FORCEINLINE void Mailbox::DestroyStaleMessages(IAllocator *const messageAllocator)
+{
+    // The count check keeps mailboxes that never conflate to a single load.
+    while (mStaleCount.Load() != 0)
+    {
+        IMessage *const message(mStaleQueue.Pop());
+        if (message == 0)
+        {
+            // A concurrent stash hasn't finished linking; retry next event.
+            break;
+        }
+
+        mStaleCount.Decrement();
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+        SubtractQueuedBytes(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+        MessageCreator::Destroy(messageAllocator, message);
+    }
+}
+
+
+THERON_FORCEINLINE void Mailbox::UpdateChannelStreak(void *const producer)
+{
+    // The streak tracking is racy when multiple producers interleave, but
+    // lost or misattributed updates merely delay or suppress installation;
+    // the channel is only ever actually installed under the lock.
+    if (mChannelOwner.Load() == 0 && mChannelRevoked.Load() == 0)
+    {
+        if (mLastProducer.Load() == producer)
+        {
+            const uint32_t streak(mProducerStreak.Load() + 1);
+            mProducerStreak.Store(streak);
+
+            if (streak >= CHANNEL_STREAK_THRESHOLD)
+            {
+                TryInstallChannel(producer);
+            }
+        }
+        else
+        {
+            mLastProducer.Store(producer);
+            mProducerStreak.Store(1);
+        }
+    }
+}
+
+
+inline void Mailbox::TryInstallChannel(void *const producer)
+{
+    // Only install while the mailbox is empty: any earlier messages from this
+    // producer still queued would be overtaken by later ones entering the
+    // ring, since the consumer drains the ring first. The producer sends to
+    // this mailbox repeatedly, so another attempt follows shortly.
+    if (mMessageCount.Load() != 0)
+    {
+        return;
+    }
+
+    mSpinLock.Lock();
+
+    if (mChannelOwner.Load() == 0 && mChannelRevoked.Load() == 0 && mMessageCount.Load() == 0)
+    {
+        SpscQueue *channel(reinterpret_cast<SpscQueue *>(mChannel.Load()));
+        if (channel == 0)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+            void *const memory(allocator->AllocateAligned(sizeof(SpscQueue), THERON_CACHELINE_ALIGNMENT));
+
+            if (memory)
+            {
+                // The atomic store publishes the constructed ring to the consumer.
+                channel = new (memory) SpscQueue();
+                mChannel.Store(channel);
+            }
+        }
+
+        if (channel)
+        {
+            mChannelOwner.Store(producer);
+        }
+    }
+
+    mSpinLock.Unlock();
+}
+
+
+inline void Mailbox::RevokeChannel()
+{
+    // Mark the channel revoked before releasing ownership, so an installer
+    // that sees ownership free is guaranteed to also see the revocation.
+    mChannelRevoked.Store(1);
+    mChannelOwner.Store(0);
+}
+
+
+THERON_FORCEINLINE void Mailbox::UpdateDeadline(const uint64_t deadline)
+{
+    THERON_ASSERT(deadline != 0);
+
+    // Lower the mark with a compare-and-swap loop, so concurrent producers
+    // never raise it above the earliest deadline any of them has pushed.
+    uint64_t currentValue(mEarliestDeadline.Load());
+    while (currentValue == 0 || deadline < currentValue)
+    {
+        if (mEarliestDeadline.CompareExchangeAcquire(currentValue, deadline))
+        {
+            break;
+        }
+    }
+}
+
+
+THERON_FORCEINLINE bool Mailbox::ReleaseMessage()
+{
+    if (mMessageCount.FetchDecrement() > 1)
+    {
+        return true;
+    }
+
+    // The mailbox has emptied, so no queued message carries a deadline.
+    // A producer racing the reset can have its deadline cleared, in which case
+    // its message is scheduled normally; misses are still counted exactly.
+    if (mEarliestDeadline.Load() != 0)
+    {
+        mEarliestDeadline.Store(0);
+    }
+
+    // Likewise no queued message carries inherited priority any longer; a
+    // racing producer's message is delivered either way, just not expedited.
+    if (mInheritedPriority.Load() != 0)
+    {
+        mInheritedPriority.Store(0);
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::Count() const
+{
+    return mMessageCount.Load();
+}
+
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+
+THERON_FORCEINLINE uint32_t Mailbox::GetQueuedBytes() const
+{
+    return mQueuedBytes.Load();
+}
+
+
+THERON_FORCEINLINE void Mailbox::SubtractQueuedBytes(const uint32_t size)
+{
+    mQueuedBytes.Subtract(size);
+}
+
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+
+
+THERON_FORCEINLINE void Mailbox::RegisterActor(Actor *const actor)
+{
+    // Can't register actors while the mailbox is pinned.
+    THERON_ASSERT(mPinCount == 0);
+    THERON_ASSERT(mActor == 0);
+    THERON_ASSERT(actor);
+
+    mActor = actor;
+}
+
+
+THERON_FORCEINLINE void Mailbox::DeregisterActor()
+{
+    // Can't deregister actors while the mailbox is pinned.
+    THERON_ASSERT(mPinCount == 0);
+    THERON_ASSERT(mActor != 0);
+
+    mActor = 0;
+}
+
+
+THERON_FORCEINLINE Actor *Mailbox::GetActor() const
+{
+    return mActor;
+}
+
+
+THERON_FORCEINLINE void Mailbox::Pin()
+{
+    ++mPinCount;
+}
+
+
+THERON_FORCEINLINE void Mailbox::Unpin()
+{
+    THERON_ASSERT(mPinCount > 0);
+    --mPinCount;
+}
+
+
+THERON_FORCEINLINE bool Mailbox::IsPinned() const
+{
+    return (mPinCount > 0);
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetHighPriority(const bool highPriority)
+{
+    mHighPriority = highPriority;
+}
+
+
+THERON_FORCEINLINE bool Mailbox::HasHighPriority() const
+{
+    return mHighPriority;
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetCapacity(const uint32_t capacity)
+{
+    mCapacity = capacity;
+}
+
+
+THERON_FORCEINLINE bool Mailbox::Full() const
+{
+    const uint32_t capacity(mCapacity);
+    return (capacity != 0 && mMessageCount.Load() >= capacity);
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetWatermarks(const uint32_t high, const uint32_t low)
+{
+    THERON_ASSERT(high == 0 || low < high);
+
+    mHighWatermark = high;
+    mLowWatermark = low;
+}
+
+
+THERON_FORCEINLINE bool Mailbox::RoseAboveWatermark()
+{
+    const uint32_t high(mHighWatermark);
+    if (high == 0 || mMessageCount.Load() < high)
+    {
+        return false;
+    }
+
+    // The compare-exchange arbitrates between producers that concurrently
+    // observe the depth above the mark, so each rising edge is reported once.
+    uint32_t expected(0);
+    return mAboveWatermark.CompareExchangeAcquire(expected, 1);
+}
+
+
+THERON_FORCEINLINE bool Mailbox::FellBelowWatermark()
+{
+    if (mAboveWatermark.Load() == 0 || mMessageCount.Load() > mLowWatermark)
+    {
+        return false;
+    }
+
+    // Clearing the flag rearms the high watermark for the next rising edge.
+    // The compare-exchange guards against a racing producer that has already
+    // taken the queue back up through the high mark and reported it.
+    uint32_t expected(1);
+    return mAboveWatermark.CompareExchangeRelease(expected, 0);
+}
+
+
+THERON_FORCEINLINE uint64_t Mailbox::GetEarliestDeadline() const
+{
+    return mEarliestDeadline.Load();
+}
+
+
+THERON_FORCEINLINE bool Mailbox::HasInheritedPriority() const
+{
+    return (mInheritedPriority.Load() != 0);
+}
+
+
+THERON_FORCEINLINE void Mailbox::SetForward(const uint32_t index)
+{
+    mForwardIndex.Store(index);
+}
+
+
+THERON_FORCEINLINE uint32_t Mailbox::GetForward() const
+{
+    return mForwardIndex.Load();
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_DIRECTORY_MAILBOXES_MAILBOX_H
+
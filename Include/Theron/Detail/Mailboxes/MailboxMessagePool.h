@@ -0,0 +1,206 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXES_MAILBOXMESSAGEPOOL_H
+#define THERON_DETAIL_MAILBOXES_MAILBOXMESSAGEPOOL_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+#if THERON_MAILBOX_POOL_SLOTS > 32
+#error THERON_MAILBOX_POOL_SLOTS must be 32 or fewer; the free slots are tracked in a 32-bit mask.
+#endif
+
+#if (THERON_MAILBOX_POOL_SLOT_SIZE & 7) != 0
+#error THERON_MAILBOX_POOL_SLOT_SIZE must be a multiple of eight bytes.
+#endif
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Micro-pool of preallocated message block slots embedded in a mailbox.
+
+Message blocks are ordinarily allocated from the sending thread's cache and
+freed to the processing thread's cache, so the blocks of a mailbox processed
+by varying workers migrate between per-thread caches. For mailboxes flagged
+high-rate, sends claim blocks from this pool instead when they fit, and the
+destroy path returns them, so steady-state traffic circulates through a few
+memory lines resident alongside the mailbox itself.
+
+Slots are claimed and released lock-free through a bitmask of free slots;
+claims come from concurrent producers, releases from whichever thread
+destroys the message. Each slot carries a header identifying its pool, so
+blocks find their way home however the message travelled.
+*/
+class MailboxMessagePool
+{
+public:
+
+    /**
+    Number of slots in the pool.
+    */
+    static const uint32_t SLOT_COUNT = THERON_MAILBOX_POOL_SLOTS;
+
+    /**
+    Usable size in bytes of each slot.
+    */
+    static const uint32_t SLOT_SIZE = THERON_MAILBOX_POOL_SLOT_SIZE;
+
+    /**
+    Default constructor; all slots free, pool disabled until enabled.
+    */
+    inline MailboxMessagePool() :
+      mFreeMask(FULL_MASK),
+      mEnabled(0)
+    {
+    }
+
+    /**
+    Enables or disables the pool; claims only succeed while enabled.
+    */
+    THERON_FORCEINLINE void SetEnabled(const bool enabled)
+    {
+        mEnabled.Store(enabled ? 1 : 0);
+    }
+
+    /**
+    Returns true if the pool is enabled.
+    */
+    THERON_FORCEINLINE bool IsEnabled() const
+    {
+        return (mEnabled.Load() != 0);
+    }
+
+    /**
+    Tries to claim a free slot for a message block of the given size and alignment.
+    \return Pointer to the block within the claimed slot, or zero if the pool
+    is disabled, the block doesn't fit a slot, or no slot is free.
+    */
+    THERON_FORCEINLINE void *Claim(const uint32_t size, const uint32_t alignment)
+    {
+        // The enabled check keeps unflagged mailboxes to a single load.
+        // Slot payloads are eight-byte aligned; stricter values go to the allocator.
+        if (mEnabled.Load() == 0 || size > SLOT_SIZE || alignment > 8)
+        {
+            return 0;
+        }
+
+        // Claim the lowest free slot with a compare-and-swap on the free mask.
+        uint32_t mask(mFreeMask.Load());
+        while (mask != 0)
+        {
+            const uint32_t slot(LowestSetBit(mask));
+            if (mFreeMask.CompareExchangeAcquire(mask, mask & ~(1u << slot)))
+            {
+                // Stamp the header so the destroy path can find the pool.
+                SlotHeader *const header(Header(slot));
+                header->mPool = this;
+                header->mSlot = slot;
+
+                return header + 1;
+            }
+
+            // The compare-exchange reloaded the mask; retry with the new value.
+        }
+
+        return 0;
+    }
+
+    /**
+    Returns a previously claimed block to its pool, wherever it was destroyed.
+    */
+    THERON_FORCEINLINE static void Free(void *const block)
+    {
+        THERON_ASSERT(block);
+
+        // The header immediately precedes the block within the slot.
+        const SlotHeader *const header(reinterpret_cast<SlotHeader *>(block) - 1);
+        MailboxMessagePool *const pool(header->mPool);
+        const uint32_t slotBit(1u << header->mSlot);
+
+        THERON_ASSERT(pool);
+        THERON_ASSERT(header->mSlot < SLOT_COUNT);
+
+        // Release the slot with a compare-and-swap on the free mask.
+        uint32_t mask(pool->mFreeMask.Load());
+        while (!pool->mFreeMask.CompareExchangeRelease(mask, mask | slotBit))
+        {
+        }
+    }
+
+private:
+
+    /**
+    Mask with a set bit for each slot of the pool.
+    */
+    static const uint32_t FULL_MASK =
+        (SLOT_COUNT < 32) ? ((1u << SLOT_COUNT) - 1) : 0xFFFFFFFFu;
+
+    /**
+    Header preceding the block within each slot, identifying the slot's pool.
+    Sixteen bytes, preserving the eight-byte alignment of the block after it.
+    */
+    struct SlotHeader
+    {
+        MailboxMessagePool *mPool;              ///< The pool the slot belongs to.
+        uint32_t mSlot;                         ///< Index of the slot within its pool.
+        uint32_t mPadding;                      ///< Pads the header to sixteen bytes.
+    };
+
+    /**
+    Stride in bytes of each slot: the header plus the usable block.
+    */
+    static const uint32_t SLOT_STRIDE = sizeof(SlotHeader) + SLOT_SIZE;
+
+    MailboxMessagePool(const MailboxMessagePool &other);
+    MailboxMessagePool &operator=(const MailboxMessagePool &other);
+
+    /**
+    Returns the header of the slot with the given index.
+    */
+    THERON_FORCEINLINE SlotHeader *Header(const uint32_t slot)
+    {
+        uint8_t *const bytes(reinterpret_cast<uint8_t *>(mStorage));
+        return reinterpret_cast<SlotHeader *>(bytes + slot * SLOT_STRIDE);
+    }
+
+    /**
+    Returns the index of the lowest set bit of a non-zero mask.
+    */
+    THERON_FORCEINLINE static uint32_t LowestSetBit(const uint32_t mask)
+    {
+        THERON_ASSERT(mask != 0);
+
+        uint32_t bit(0);
+        while ((mask & (1u << bit)) == 0)
+        {
+            ++bit;
+        }
+
+        return bit;
+    }
+
+    Atomic::UInt32 mFreeMask;                   ///< Mask of free slots; claimed and released with compare-and-swap.
+    Atomic::UInt32 mEnabled;                    ///< Whether claims are currently served; set for high-rate actors.
+    uint64_t mStorage[SLOT_COUNT * SLOT_STRIDE / 8];    ///< The slots: a header and a block each, eight-byte aligned.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+
+#endif // THERON_DETAIL_MAILBOXES_MAILBOXMESSAGEPOOL_H
@@ -0,0 +1,192 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXES_MESSAGEQUEUE_H
+#define THERON_DETAIL_MAILBOXES_MESSAGEQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+An intrusive lock-free multi-producer single-consumer message queue.
+
+The queue is based on the classic Vyukov MPSC design: producers atomically
+exchange the head pointer and then link the previous head to the pushed node,
+so concurrent producers never contend on a lock or spin against each other.
+The single consumer pops nodes from the tail end without any atomic
+read-modify-write in the common case.
+
+The queue is intrusive and reuses the forward link member that messages
+inherit from Queue<IMessage>::Node, so pushed messages must not be held in
+any other queue at the same time.
+
+\note A producer that has exchanged the head but not yet linked its node
+leaves the queue in a transiently 'blocked' state, during which Pop returns
+zero even though the queue is non-empty. Callers that know the queue is
+non-empty should retry with backoff.
+*/
+class MessageQueue
+{
+public:
+
+    /**
+    Constructor
+    */
+    inline MessageQueue();
+
+    /**
+    Destructor
+    */
+    inline ~MessageQueue();
+
+    /**
+    Pushes a message onto the queue.
+    \note Safe to call concurrently from any number of producer threads.
+    */
+    inline void Push(IMessage *const message);
+
+    /**
+    Removes and returns the message at the front of the queue.
+    \return A null pointer if the queue is empty or transiently blocked by an incomplete push.
+    \note May only be called by the single consumer thread.
+    */
+    inline IMessage *Pop();
+
+private:
+
+    typedef Queue<IMessage>::Node Node;
+
+    MessageQueue(const MessageQueue &other);
+    MessageQueue &operator=(const MessageQueue &other);
+
+    /**
+    Reads the forward link of a node, defeating compiler caching of the read.
+    */
+    THERON_FORCEINLINE static Node *LoadNext(const Node *const node)
+    {
+        return *const_cast<Node *volatile *>(&const_cast<Node *>(node)->mFrwd);
+    }
+
+    /**
+    Writes the forward link of a node, defeating compiler reordering of the write.
+    */
+    THERON_FORCEINLINE static void StoreNext(Node *const node, Node *const next)
+    {
+        *const_cast<Node *volatile *>(&node->mFrwd) = next;
+    }
+
+    Atomic::Pointer mHead;          ///< Producer end of the queue, exchanged atomically by pushers.
+
+    /**
+    Padding that keeps the producer and consumer ends of the queue on separate
+    cache lines, so the atomic exchanges by pushers don't invalidate the line
+    holding the consumer's tail pointer.
+    */
+    uint8_t mPadding[THERON_CACHELINE_ALIGNMENT];
+
+    Node *mTail;                    ///< Consumer end of the queue, accessed only by the consumer.
+    Node mStub;                     ///< Dummy node that allows push and pop to proceed without locking.
+};
+
+
+inline MessageQueue::MessageQueue() :
+  mHead(&mStub),
+  mTail(&mStub)
+{
+    mStub.mFrwd = 0;
+    mStub.mBack = 0;
+}
+
+
+inline MessageQueue::~MessageQueue()
+{
+    // If the queue hasn't been emptied by the caller we'll leak the messages.
+    THERON_ASSERT(mHead.Load() == &mStub);
+    THERON_ASSERT(mTail == &mStub);
+}
+
+
+THERON_FORCEINLINE void MessageQueue::Push(IMessage *const message)
+{
+    THERON_ASSERT(message);
+
+    Node *const node(message);
+    StoreNext(node, 0);
+
+    // Claim our position in the queue by exchanging the head, then link the
+    // previous head to us. Until the link is written the consumer can't reach
+    // past the previous head, so the queue is transiently 'blocked'.
+    Node *const prev(reinterpret_cast<Node *>(mHead.Exchange(node)));
+    StoreNext(prev, node);
+}
+
+
+THERON_FORCEINLINE IMessage *MessageQueue::Pop()
+{
+    Node *tail(mTail);
+    Node *next(LoadNext(tail));
+
+    // Skip past the stub node if it's at the consumer end.
+    if (tail == &mStub)
+    {
+        if (next == 0)
+        {
+            // The queue is empty, or blocked by an incomplete push.
+            return 0;
+        }
+
+        mTail = next;
+        tail = next;
+        next = LoadNext(tail);
+    }
+
+    // The common case: the tail node is linked to a successor, so pop it.
+    if (next)
+    {
+        mTail = next;
+        return static_cast<IMessage *>(tail);
+    }
+
+    // The tail is the last node in the queue, unless a push is in progress.
+    Node *const head(reinterpret_cast<Node *>(mHead.Load()));
+    if (tail != head)
+    {
+        // A producer has exchanged the head but not yet linked its node.
+        return 0;
+    }
+
+    // Re-insert the stub node behind the tail so the queue is never empty,
+    // then pop the tail once the link to the stub becomes visible.
+    StoreNext(&mStub, 0);
+    Node *const prev(reinterpret_cast<Node *>(mHead.Exchange(&mStub)));
+    StoreNext(prev, &mStub);
+
+    next = LoadNext(tail);
+    if (next)
+    {
+        mTail = next;
+        return static_cast<IMessage *>(tail);
+    }
+
+    // A concurrent push slipped in between the tail and the stub.
+    return 0;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MAILBOXES_MESSAGEQUEUE_H
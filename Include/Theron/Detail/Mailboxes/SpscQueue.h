@@ -0,0 +1,125 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MAILBOXES_SPSCQUEUE_H
+#define THERON_DETAIL_MAILBOXES_SPSCQUEUE_H
+
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A bounded single-producer single-consumer message ring buffer.
+
+The ring serves as a dedicated 'channel' between a stable sender/receiver
+actor pair, bypassing the general multi-producer mailbox queue. Because
+exactly one thread pushes and exactly one thread pops, both operations are
+wait-free and involve no atomic read-modify-write: the producer publishes a
+slot by advancing the write index, and the consumer retires it by advancing
+the read index.
+
+The indices increase monotonically and are wrapped onto the slot array only
+when indexing, so a full ring is distinguished from an empty one without
+sacrificing a slot.
+*/
+class SpscQueue
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline SpscQueue() :
+      mWriteIndex(0),
+      mReadIndex(0)
+    {
+    }
+
+    /**
+    Destructor.
+    */
+    inline ~SpscQueue()
+    {
+        // If the ring hasn't been emptied by the caller we'll leak the messages.
+        THERON_ASSERT(Empty());
+    }
+
+    /**
+    Returns true if the ring contains no messages.
+    */
+    THERON_FORCEINLINE bool Empty() const
+    {
+        return (mWriteIndex.Load() == mReadIndex.Load());
+    }
+
+    /**
+    Pushes a message into the ring.
+    \return False if the ring is full, in which case the caller must fall back
+    to the general mailbox queue.
+    \note May only be called by the single producer thread.
+    */
+    THERON_FORCEINLINE bool Push(IMessage *const message)
+    {
+        THERON_ASSERT(message);
+
+        const uint32_t writeIndex(mWriteIndex.Load());
+        if (writeIndex - mReadIndex.Load() == SIZE)
+        {
+            return false;
+        }
+
+        // The slot is written before the index store publishes it to the consumer.
+        mSlots[writeIndex & MASK] = message;
+        mWriteIndex.Store(writeIndex + 1);
+
+        return true;
+    }
+
+    /**
+    Removes and returns the message at the front of the ring.
+    \return A null pointer if the ring is empty.
+    \note May only be called by the single consumer thread.
+    */
+    THERON_FORCEINLINE IMessage *Pop()
+    {
+        const uint32_t readIndex(mReadIndex.Load());
+        if (mWriteIndex.Load() == readIndex)
+        {
+            return 0;
+        }
+
+        IMessage *const message(mSlots[readIndex & MASK]);
+        mReadIndex.Store(readIndex + 1);
+
+        return message;
+    }
+
+private:
+
+    static const uint32_t SIZE = 64;            ///< Number of slots in the ring (power of two!).
+    static const uint32_t MASK = (SIZE - 1);    ///< Mask that wraps an index onto the slot array.
+
+    SpscQueue(const SpscQueue &other);
+    SpscQueue &operator=(const SpscQueue &other);
+
+    Atomic::UInt32 mWriteIndex;                 ///< Monotonic count of messages pushed; written only by the producer.
+    Atomic::UInt32 mReadIndex;                  ///< Monotonic count of messages popped; written only by the consumer.
+    IMessage *mSlots[SIZE];                     ///< Message slots, published by the index stores.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MAILBOXES_SPSCQUEUE_H
@@ -9,6 +9,7 @@
 #include <Theron/Defines.h>
 
 #include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Threading/Atomic.h>
 
 
 namespace Theron
@@ -24,8 +25,27 @@ class IMessage : public Queue<IMessage>::Node
 {
 public:
 
+    /**
+    Flag folded into the top bit of the stored block size, marking messages
+    whose values are trivially copyable and within the small-message limit.
+    The blocks of such messages hold nothing needing destruction, so the
+    destroy path can skip the virtual release dispatch. Block sizes are far
+    below the bit in practice, so the fold loses nothing.
+    */
+    static const uint32_t SMALL_MESSAGE_FLAG = 0x80000000;
+
+    /**
+    Flag folded into the next bit of the stored block size, marking messages
+    whose blocks were claimed from the micro-pool embedded in the destination
+    mailbox rather than allocated. The destroy path returns such blocks to
+    their pool, wherever the message ends up being destroyed.
+    */
+    static const uint32_t MAILBOX_POOL_FLAG = 0x40000000;
+
     /**
     Gets the address from which the message was sent.
+    For messages sent by local entities the returned address carries only the
+    sender's index; the name, if one exists, is resolved lazily if queried.
     // TODO: Force-inline
     */
     inline Address From() const
@@ -48,7 +68,25 @@ public:
     THERON_FORCEINLINE uint32_t GetBlockSize() const
     {
         THERON_ASSERT(mBlockSize);
-        return mBlockSize;
+        return (mBlockSize & ~(SMALL_MESSAGE_FLAG | MAILBOX_POOL_FLAG));
+    }
+
+    /**
+    Returns true if the message value is a plain slab needing no destruction,
+    in which case the destroy path can skip the virtual release dispatch.
+    */
+    THERON_FORCEINLINE bool IsSmall() const
+    {
+        return ((mBlockSize & SMALL_MESSAGE_FLAG) != 0);
+    }
+
+    /**
+    Returns true if the message block was claimed from a mailbox micro-pool,
+    in which case the destroy path returns it there rather than to an allocator.
+    */
+    THERON_FORCEINLINE bool IsPooledBlock() const
+    {
+        return ((mBlockSize & MAILBOX_POOL_FLAG) != 0);
     }
 
     /**
@@ -60,6 +98,126 @@ public:
         return mBlock;
     }
 
+    /**
+    Returns the dense integer ID of the message type, assigned on registration.
+    This uniquely identifies the type of the message value, and is cheaper to
+    compare than the type name.
+    \note Unless explicitly registered to avoid C++ RTTI, message type IDs are zero.
+    */
+    THERON_FORCEINLINE uint32_t GetTypeId() const
+    {
+        return mTypeId;
+    }
+
+    /**
+    Sets the deadline of the message, as an absolute time in microseconds on
+    the \ref ProfileClock "profiling clock". Set at send time for messages
+    sent with a deadline; zero, the default, means the message has none.
+    */
+    THERON_FORCEINLINE void SetDeadline(const uint64_t deadline)
+    {
+        mDeadline = deadline;
+    }
+
+    /**
+    Returns the deadline of the message, or zero if it has none.
+    */
+    THERON_FORCEINLINE uint64_t GetDeadline() const
+    {
+        return mDeadline;
+    }
+
+    /**
+    Sets the causality flow ID of the message. Set at send time: messages sent
+    from within a message handler inherit the flow ID of the message being
+    handled, while messages sent from outside handlers start new flows,
+    subject to sampling. Zero, the default, marks the message as untraced.
+    */
+    THERON_FORCEINLINE void SetFlowId(const uint64_t flowId)
+    {
+        mFlowId = flowId;
+    }
+
+    /**
+    Returns the causality flow ID of the message, or zero if it is untraced.
+    */
+    THERON_FORCEINLINE uint64_t GetFlowId() const
+    {
+        return mFlowId;
+    }
+
+    /**
+    Marks the message as high-priority. Set at send time: messages sent from
+    within a message handler inherit the effective priority of the message
+    being handled, so prioritized request chains stay prioritized as they fan
+    out across helper actors. False, the default, leaves the destination
+    mailbox's own priority in charge.
+    */
+    THERON_FORCEINLINE void SetHighPriority(const bool highPriority)
+    {
+        mHighPriority = highPriority;
+    }
+
+    /**
+    Returns true if the message carries inherited high priority.
+    */
+    THERON_FORCEINLINE bool HasHighPriority() const
+    {
+        return mHighPriority;
+    }
+
+#if THERON_ENABLE_PROFILING
+
+    /**
+    Sets the enqueue timestamp of the message, in profiling clock ticks.
+    Stamped as the message is pushed into the destination mailbox, so that the
+    delay it then spends queued can be measured, and attributed to its sender,
+    when it is eventually processed.
+    */
+    THERON_FORCEINLINE void SetEnqueueTicks(const uint64_t ticks)
+    {
+        mEnqueueTicks = ticks;
+    }
+
+    /**
+    Returns the enqueue timestamp of the message, in profiling clock ticks.
+    */
+    THERON_FORCEINLINE uint64_t GetEnqueueTicks() const
+    {
+        return mEnqueueTicks;
+    }
+
+#endif // THERON_ENABLE_PROFILING
+
+    /**
+    Adds a view reference to the message, on behalf of a \ref MessageView.
+    While view references are outstanding the message outlives its handling.
+    */
+    THERON_FORCEINLINE void AddViewReference() const
+    {
+        mViewCount.Increment();
+    }
+
+    /**
+    Releases a view reference, or the framework's own reference when called
+    from the destroy path after the message has been handled.
+    \return True, if the released reference was the last one, in which case
+    the caller destroys the message.
+    */
+    THERON_FORCEINLINE bool ReleaseViewReference() const
+    {
+        // Views are only ever created by the thread handling the message,
+        // while it handles it, so a count of one read here means no views
+        // exist and none can appear: the common view-less case pays a single
+        // read of an already-owned cache line rather than an atomic update.
+        if (mViewCount.Load() == 1)
+        {
+            return true;
+        }
+
+        return (mViewCount.FetchDecrement() == 1);
+    }
+
     /**
     Returns the size in bytes of the message data.
     */
@@ -74,13 +232,21 @@ public:
 
     /**
     Allows the message instance to destruct its constructed value object before being freed.
+    \return True, if the message's memory block is no longer referenced and can be freed.
+    Messages sharing a refcounted value block with other messages return false
+    until the last of them is released.
     */
-    virtual void Release() = 0;
+    virtual bool Release() = 0;
 
     /**
-    Virtual destructor.
+    Non-virtual destructor; releases the base's references, notably the name
+    carried by the from address. Envelope classes perform all their cleanup in
+    \ref Release and add nothing needing destruction of their own, so the
+    type-erased destroy path destructs envelopes with a direct call rather
+    than a virtual dispatch. Envelopes are never deleted through a pointer,
+    only destructed in place in their caller-managed blocks.
     */
-    virtual ~IMessage()
+    ~IMessage()
     {
     }
 
@@ -91,15 +257,29 @@ protected:
     \param from The address from which the message was sent.
     \param block The memory block containing the message.
     \param blockSize The size of the memory block containing the message.
-    \param typeName String identifier uniquely identifying the type of the message value.
+    \param typeId Dense integer ID uniquely identifying the type of the message value.
+    \note Envelopes of messages from local senders store the from address as a
+    plain index, stripping the name handle, so constructing and destroying
+    them never touches the reference count of an interned name. The name is
+    resolved lazily from the index if it is ever actually needed -- only
+    addresses known by name alone keep their names.
     */
     THERON_FORCEINLINE IMessage(
         const Address &from,
         void *const block,
-        const uint32_t blockSize) :
-      mFrom(from),
+        const uint32_t blockSize,
+        const uint32_t typeId) :
+      mFrom(from.mIndex.mUInt32 != 0 ? Address(String(), from.mIndex) : from),
       mBlock(block),
-      mBlockSize(blockSize)
+      mBlockSize(blockSize),
+      mTypeId(typeId),
+      mDeadline(0),
+      mFlowId(0),
+      mHighPriority(false),
+#if THERON_ENABLE_PROFILING
+      mEnqueueTicks(0),
+#endif // THERON_ENABLE_PROFILING
+      mViewCount(1)
     {
     }
 
@@ -111,6 +291,15 @@ private:
     const Address mFrom;            ///< The address from which the message was sent.
     void *const mBlock;             ///< Pointer to the memory block containing the message.
     const uint32_t mBlockSize;      ///< Total size of the message memory block in bytes.
+    const uint32_t mTypeId;         ///< Dense integer ID of the message value type; zero if unregistered.
+    uint64_t mDeadline;             ///< Absolute deadline in clock microseconds; zero if the message has none.
+    uint64_t mFlowId;               ///< Causality flow ID inherited across sends; zero if the message is untraced.
+    bool mHighPriority;             ///< Whether the message carries high priority inherited across sends.
+
+#if THERON_ENABLE_PROFILING
+    uint64_t mEnqueueTicks;         ///< Time at which the message was queued, in profiling clock ticks.
+#endif // THERON_ENABLE_PROFILING
+    mutable Atomic::UInt32 mViewCount;  ///< One framework reference plus one per outstanding MessageView.
 };
 
 
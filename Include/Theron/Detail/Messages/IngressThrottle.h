@@ -0,0 +1,133 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_INGRESSTHROTTLE_H
+#define THERON_DETAIL_MESSAGES_INGRESSTHROTTLE_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A token bucket rate limiter for sends entering a framework from non-actor code.
+
+External producer threads can push messages into a framework faster than its
+workers drain them, growing the shared queues and crowding out actor-to-actor
+traffic. The throttle paces the external send path to a configured steady rate
+with a bounded burst allowance, so bursts of external ingestion smooth out
+instead of monopolizing the workers.
+
+The implementation is the virtual-scheduling form of the token bucket: a
+single atomic holds the theoretical time of the next conforming send, advanced
+by one send interval per admitted message. Sends arriving while the bucket has
+burst credit are admitted immediately; beyond that, callers wait out their
+schedule slot, which spaces them at the steady rate. Multiple producer threads
+contend only on the one atomic.
+*/
+class IngressThrottle
+{
+public:
+
+    /**
+    Default constructor. The throttle is disabled until initialized with a rate.
+    */
+    inline IngressThrottle() :
+      mIntervalMicroseconds(0),
+      mBurstMicroseconds(0)
+    {
+        mNextSendTime.Store(0);
+    }
+
+    /**
+    Configures the throttle from a steady rate and a burst allowance.
+    A rate of zero disables the throttle; a burst limit of zero allows a
+    burst of one second's worth of tokens.
+    */
+    inline void Initialize(const uint32_t tokensPerSecond, const uint32_t burstLimit)
+    {
+        if (tokensPerSecond == 0)
+        {
+            mIntervalMicroseconds = 0;
+            mBurstMicroseconds = 0;
+            return;
+        }
+
+        const uint32_t burst(burstLimit ? burstLimit : tokensPerSecond);
+
+        mIntervalMicroseconds = 1000000 / tokensPerSecond;
+        if (mIntervalMicroseconds == 0)
+        {
+            mIntervalMicroseconds = 1;
+        }
+
+        mBurstMicroseconds = static_cast<uint64_t>(burst) * mIntervalMicroseconds;
+        mNextSendTime.Store(ProfileClock::GetMicroseconds());
+    }
+
+    /**
+    Returns true if a rate has been configured, so sends need to acquire tokens.
+    */
+    THERON_FORCEINLINE bool Enabled() const
+    {
+        return mIntervalMicroseconds != 0;
+    }
+
+    /**
+    Acquires a token, waiting if the burst allowance is exhausted.
+    \note The calling thread busy-waits with growing backoff, so external
+    producers are slowed rather than failed when they outrun the rate.
+    */
+    inline void Acquire()
+    {
+        uint32_t backoff(0);
+
+        while (true)
+        {
+            const uint64_t now(ProfileClock::GetMicroseconds());
+            uint64_t nextSendTime(mNextSendTime.Load());
+
+            // The send conforms if the schedule is within the burst allowance
+            // of the current time; otherwise the burst credit is exhausted,
+            // so wait out the schedule slot.
+            if (nextSendTime > now + mBurstMicroseconds)
+            {
+                Utils::Backoff(backoff);
+                continue;
+            }
+
+            // Claim this send's slot by advancing the schedule one interval.
+            // Advancing from no earlier than the current time means an idle
+            // bucket never accumulates more credit than the burst allowance.
+            const uint64_t base(nextSendTime > now ? nextSendTime : now);
+            if (mNextSendTime.CompareExchangeAcquire(nextSendTime, base + mIntervalMicroseconds))
+            {
+                return;
+            }
+        }
+    }
+
+private:
+
+    IngressThrottle(const IngressThrottle &other);
+    IngressThrottle &operator=(const IngressThrottle &other);
+
+    uint64_t mIntervalMicroseconds;     ///< Time credit consumed per admitted send.
+    uint64_t mBurstMicroseconds;        ///< Time credit the bucket can hold, bounding bursts.
+    Atomic::UInt64 mNextSendTime;       ///< Theoretical time of the next conforming send.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_INGRESSTHROTTLE_H
@@ -1,156 +1,283 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_MESSAGES_MESSAGE_H
-#define THERON_DETAIL_MESSAGES_MESSAGE_H
-
-
-#include <new>
-
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-
-#include <Theron/Detail/Alignment/MessageAlignment.h>
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Messages/MessageTraits.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-Message class, used for sending data between actors.
-*/
-template <class ValueType>
-class Message : public IMessage
-{
-public:
-
-    typedef Message<ValueType> ThisType;
-
-    /**
-    Virtual destructor.
-    */
-    THERON_FORCEINLINE virtual ~Message()
-    {
-    }
-
-    /**
-    Returns the memory block size required to initialize a message of this type.
-    */
-    THERON_FORCEINLINE static uint32_t GetSize()
-    {
-        // We allocate an aligned buffer to hold the message and its copy of the value.
-        // We lay the message and its value side by side in memory.
-        // The value is first, since it's the value that needs the alignment.
-        // The message object itself doesn't need special alignment.
-        return GetValueSize() + sizeof(ThisType);
-    }
-
-    /**
-    Returns the memory block alignment required to initialize a message of this type.
-    */
-    THERON_FORCEINLINE static uint32_t GetAlignment()
-    {
-        return MessageAlignment<ValueType>::ALIGNMENT;
-    }
-
-    /**
-    Initializes a message of this type in the provided memory block.
-    The block is allocated and freed by the caller.
-    */
-    THERON_FORCEINLINE static ThisType *Initialize(void *const block, const ValueType &value, const Address &from)
-    {
-        THERON_ASSERT(block);
-
-        // Instantiate a new instance of the value type in aligned position at the start of the buffer.
-        // We assume that the message value type can be copy-constructed.
-        // Messages are explicitly copied to avoid shared memory.
-        ValueType *const pValue = new (block) ValueType(value);
-
-        // Allocate the message object immediately after the value, passing it the value's address.
-        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
-        return new (pObject) ThisType(pValue, from);
-    }
-
-    /**
-    Returns the name of the message type.
-    This uniquely identifies the type of the message value.
-    \note Unless explicitly specified to avoid C++ RTTI, message names are null.
-    */
-    virtual const char *TypeName() const
-    {
-        return MessageTraits<ValueType>::TYPE_NAME;
-    }
-
-    /**
-    Allows the message instance to destruct its constructed value object before being freed.
-    */
-    virtual void Release()
-    {
-        // The referenced block owned by this message is blind data, but we know it holds
-        // an instance of the value type, that needs to be explicitly destructed.
-        // We have to call the destructor manually because we constructed the object in-place.
-        Value().~ValueType();
-    }
-
-    /**
-    Returns the size in bytes of the message value.
-    */
-    virtual uint32_t GetMessageSize() const
-    {
-        // Calculate the size of the message value itself. There's no padding between the
-        // message value block and the Message object that follows it.
-        return GetBlockSize() - static_cast<uint32_t>(sizeof(ThisType));
-    }
-
-    /**
-    Gets the value carried by the message.
-    */
-    THERON_FORCEINLINE const ValueType &Value() const
-    {
-        // The value is stored at the start of the memory block.
-        return *reinterpret_cast<const ValueType *>(GetBlock());
-    }
-
-private:
-
-    /**
-    Private constructor.
-    */
-    THERON_FORCEINLINE Message(void *const block, const Address &from) :
-      IMessage(from, block, ThisType::GetSize())
-    {
-        THERON_ASSERT(block);
-    }
-
-    THERON_FORCEINLINE static uint32_t GetValueSize()
-    {
-        uint32_t valueSize(sizeof(ValueType));
-        const uint32_t minimumAllocationSize(4);
-
-        // Empty structs passed as values have a size of one byte, which we don't like.
-        // To be on the safe side we round every allocation up to four bytes.
-        // If we don't then the following data won't be 4-byte aligned.
-        if (valueSize < minimumAllocationSize)
-        {
-            valueSize = minimumAllocationSize;
-        }
-
-        return valueSize;
-    }
-
-    Message(const Message &other);
-    Message &operator=(const Message &other);
-};
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_MESSAGES_MESSAGE_H
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_MESSAGE_H
+#define THERON_DETAIL_MESSAGES_MESSAGE_H
+
+
+#include <new>
+
+#if THERON_CPP11
+#include <type_traits>
+#include <utility>
+#endif // THERON_CPP11
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Alignment/MessageAlignment.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/SIMD/MemoryCopy.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Message class, used for sending data between actors.
+*/
+template <class ValueType>
+class Message : public IMessage
+{
+public:
+
+    typedef Message<ValueType> ThisType;
+
+    /**
+    Returns the memory block size required to initialize a message of this type.
+    */
+    THERON_FORCEINLINE static uint32_t GetSize()
+    {
+        // We allocate an aligned buffer to hold the message and its copy of the value.
+        // We lay the message and its value side by side in memory.
+        // The value is first, since it's the value that needs the alignment.
+        // The message object itself doesn't need special alignment.
+        return GetValueSize() + sizeof(ThisType);
+    }
+
+    /**
+    Returns the memory block alignment required to initialize a message of this type.
+    */
+    THERON_FORCEINLINE static uint32_t GetAlignment()
+    {
+        return MessageAlignment<ValueType>::ALIGNMENT;
+    }
+
+    /**
+    Initializes a message of this type in the provided memory block.
+    The block is allocated and freed by the caller.
+    */
+    THERON_FORCEINLINE static ThisType *Initialize(void *const block, const ValueType &value, const Address &from)
+    {
+        THERON_ASSERT(block);
+
+        // Instantiate a new instance of the value type in aligned position at the start of the buffer.
+        // We assume that the message value type can be copy-constructed.
+        // Messages are explicitly copied to avoid shared memory.
+        ValueType *pValue(0);
+
+#if THERON_CPP11
+
+        // Large blittable values -- bulk POD telemetry and suchlike -- are copied
+        // with the vectorized copy routine, which streams copies that would
+        // otherwise trample the sender's cache past it with non-temporal stores.
+        if (std::is_trivially_copyable<ValueType>::value && sizeof(ValueType) >= STREAM_COPY_THRESHOLD)
+        {
+            MemoryCopy(block, &value, sizeof(ValueType));
+            pValue = reinterpret_cast<ValueType *>(block);
+        }
+        else
+#endif // THERON_CPP11
+        {
+            pValue = new (block) ValueType(value);
+        }
+
+        // Allocate the message object immediately after the value, passing it the value's address.
+        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
+        return new (pObject) ThisType(pValue, from);
+    }
+
+    /**
+    Initializes a message of this type in a memory block whose value the caller
+    has already constructed in place at the start of the block, avoiding the
+    construct-plus-copy of \ref Initialize. Used by two-phase builder sends.
+    The block is allocated and freed by the caller.
+    */
+    THERON_FORCEINLINE static ThisType *InitializeWithConstructedValue(void *const block, const Address &from)
+    {
+        THERON_ASSERT(block);
+
+        // The value was placement-constructed by the caller at the start of
+        // the block, which is aligned for the value type.
+        ValueType *const pValue(reinterpret_cast<ValueType *>(block));
+
+        // Allocate the message object immediately after the value, passing it the value's address.
+        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
+        return new (pObject) ThisType(pValue, from);
+    }
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+    /**
+    Initializes a message of this type in a block claimed from the micro-pool
+    of the destination mailbox, flagging the message so the destroy path
+    returns the block to its pool rather than to an allocator.
+    */
+    THERON_FORCEINLINE static ThisType *InitializePooled(void *const block, const ValueType &value, const Address &from)
+    {
+        THERON_ASSERT(block);
+
+        // Pool slots are small, so the value is plainly copy-constructed;
+        // values big enough for the streaming copy never fit a slot.
+        ValueType *const pValue(new (block) ValueType(value));
+
+        // Allocate the message object immediately after the value, passing it the value's address.
+        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
+        return new (pObject) ThisType(pValue, from, true);
+    }
+
+#if THERON_CPP11
+
+    /**
+    Initializes a message of this type in a block claimed from the micro-pool
+    of the destination mailbox, forwarding the given value into the message.
+    */
+    template <class ArgumentType>
+    THERON_FORCEINLINE static ThisType *InitializePooled(void *const block, ArgumentType &&value, const Address &from)
+    {
+        THERON_ASSERT(block);
+
+        ValueType *const pValue = new (block) ValueType(std::forward<ArgumentType>(value));
+
+        // Allocate the message object immediately after the value, passing it the value's address.
+        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
+        return new (pObject) ThisType(pValue, from, true);
+    }
+
+#endif // THERON_CPP11
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+#if THERON_CPP11
+
+    /**
+    Initializes a message of this type in the provided memory block, forwarding
+    the given value into the message. Values passed as rvalues are move-constructed
+    into the message rather than copied, transferring ownership of any resources
+    they hold without copying them.
+    The block is allocated and freed by the caller.
+    */
+    template <class ArgumentType>
+    THERON_FORCEINLINE static ThisType *Initialize(void *const block, ArgumentType &&value, const Address &from)
+    {
+        THERON_ASSERT(block);
+
+        // Instantiate a new instance of the value type in aligned position at the start of the buffer.
+        // The value is forwarded, so is move-constructed when the caller passed an rvalue.
+        ValueType *const pValue = new (block) ValueType(std::forward<ArgumentType>(value));
+
+        // Allocate the message object immediately after the value, passing it the value's address.
+        char *const pObject(reinterpret_cast<char *>(pValue) + GetValueSize());
+        return new (pObject) ThisType(pValue, from);
+    }
+
+#endif // THERON_CPP11
+
+    /**
+    Returns the name of the message type.
+    This uniquely identifies the type of the message value.
+    \note Unless explicitly specified to avoid C++ RTTI, message names are null.
+    */
+    virtual const char *TypeName() const
+    {
+        return MessageTraits<ValueType>::TYPE_NAME;
+    }
+
+    /**
+    Allows the message instance to destruct its constructed value object before being freed.
+    \return True, always, since the message owns its block exclusively.
+    */
+    virtual bool Release()
+    {
+        // The referenced block owned by this message is blind data, but we know it holds
+        // an instance of the value type, that needs to be explicitly destructed.
+        // We have to call the destructor manually because we constructed the object in-place.
+        Value().~ValueType();
+        return true;
+    }
+
+    /**
+    Returns the size in bytes of the message value.
+    */
+    virtual uint32_t GetMessageSize() const
+    {
+        // Calculate the size of the message value itself. There's no padding between the
+        // message value block and the Message object that follows it.
+        return GetBlockSize() - static_cast<uint32_t>(sizeof(ThisType));
+    }
+
+    /**
+    Gets the value carried by the message.
+    */
+    THERON_FORCEINLINE const ValueType &Value() const
+    {
+        // The value is stored at the start of the memory block.
+        return *reinterpret_cast<const ValueType *>(GetBlock());
+    }
+
+    /**
+    Gets a mutable reference to the value carried by the message.
+    A message is only ever processed by one thread at a time, so the handler
+    processing it has exclusive access to the value and can safely modify it
+    in place -- in particular, move its contents out to take ownership of them.
+    */
+    THERON_FORCEINLINE ValueType &Value()
+    {
+        // The value is stored at the start of the memory block.
+        return *reinterpret_cast<ValueType *>(GetBlock());
+    }
+
+private:
+
+    /**
+    Private constructor.
+    */
+    THERON_FORCEINLINE Message(void *const block, const Address &from, const bool pooled = false) :
+      IMessage(
+          from,
+          block,
+          // Values that are plain slabs within the small-message limit flag
+          // the envelope, so the destroy path can skip the release dispatch;
+          // blocks claimed from a mailbox micro-pool flag it so the destroy
+          // path returns them there. The small selection is a compile-time
+          // constant, and the pooled flag is a constant at every call site.
+          (MessageSmallTraits<ValueType>::IS_SMALL ?
+              (ThisType::GetSize() | SMALL_MESSAGE_FLAG) :
+              ThisType::GetSize()) |
+              (pooled ? MAILBOX_POOL_FLAG : 0),
+          MessageTraits<ValueType>::TYPE_ID)
+    {
+        THERON_ASSERT(block);
+    }
+
+    THERON_FORCEINLINE static uint32_t GetValueSize()
+    {
+        uint32_t valueSize(sizeof(ValueType));
+        const uint32_t minimumAllocationSize(4);
+
+        // Empty structs passed as values have a size of one byte, which we don't like.
+        // To be on the safe side we round every allocation up to four bytes.
+        // If we don't then the following data won't be 4-byte aligned.
+        if (valueSize < minimumAllocationSize)
+        {
+            valueSize = minimumAllocationSize;
+        }
+
+        return valueSize;
+    }
+
+    Message(const Message &other);
+    Message &operator=(const Message &other);
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_MESSAGE_H
+
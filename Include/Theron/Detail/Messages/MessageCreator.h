@@ -1,91 +1,298 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
-#define THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
-
-
-#include <Theron/Address.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Messages/Message.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-Helper class that constructs and destroys Theron's internal message objects.
-*/
-class MessageCreator
-{
-public:
-
-    /**
-    Allocates and constructs a message with the given value and from address.
-    */
-    template <class ValueType>
-    inline static Message<ValueType> *Create(
-        IAllocator *const messageAllocator,
-        const ValueType &value,
-        const Address &from);
-
-    /**
-    Destructs and frees a message of unknown type referenced by an interface pointer.
-    */
-    inline static void Destroy(
-        IAllocator *const messageAllocator,
-        IMessage *const message);
-};
-
-
-
-template <class ValueType>
-THERON_FORCEINLINE Message<ValueType> *MessageCreator::Create(
-    IAllocator *const messageAllocator,
-    const ValueType &value,
-    const Address &from)
-{
-    typedef Message<ValueType> MessageType;
-
-    const uint32_t blockSize(MessageType::GetSize());
-    const uint32_t blockAlignment(MessageType::GetAlignment());
-
-    // Allocate a message. It'll be deleted by the actor after it's been handled.
-    // We allocate a block from the global free list for caching of common allocations.
-    // The free list is thread-safe so we don't need to lock it ourselves.
-    void *const block = messageAllocator->AllocateAligned(blockSize, blockAlignment);
-    if (block)
-    {
-        return MessageType::Initialize(block, value, from);
-    }
-
-    return 0;
-}
-
-
-THERON_FORCEINLINE void MessageCreator::Destroy(
-    IAllocator *const messageAllocator,
-    IMessage *const message)
-{
-    // Call release on the message to give it chance to destruct its value type.
-    message->Release();
-
-    // Destruct the message object itself.
-    // This calls the derived Message class destructor by virtual function magic.
-    message->~IMessage();
-
-    // Return the block to the global free list.
-    messageAllocator->Free(message->GetBlock(), message->GetBlockSize());
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
+#define THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
+
+
+#include <Theron/Address.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Allocators/MessagePool.h>
+#include <Theron/Detail/Mailboxes/MailboxMessagePool.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Helper class that constructs and destroys Theron's internal message objects.
+*/
+class MessageCreator
+{
+public:
+
+    /**
+    Allocates and constructs a message with the given value and from address.
+    */
+    template <class ValueType>
+    inline static Message<ValueType> *Create(
+        IAllocator *const messageAllocator,
+        const ValueType &value,
+        const Address &from);
+
+#if THERON_CPP11
+
+    /**
+    Allocates and constructs a message, forwarding the given value into it.
+    Values passed as rvalues are move-constructed into the message rather than copied.
+    */
+    template <class MessageValueType, class ArgumentType>
+    inline static Message<MessageValueType> *Create(
+        IAllocator *const messageAllocator,
+        ArgumentType &&value,
+        const Address &from);
+
+#endif // THERON_CPP11
+
+    /**
+    Allocates an uninitialized message block for a message of the given value
+    type, for two-phase builder sends: the value is placement-constructed by
+    the caller at the start of the returned block, then the envelope is
+    constructed around it with \ref CreateWithConstructedValue.
+    \return Pointer to the allocated block, or zero on failure.
+    */
+    template <class ValueType>
+    inline static void *AllocateBlock(IAllocator *const messageAllocator);
+
+    /**
+    Constructs the message envelope in a block allocated with \ref AllocateBlock,
+    whose value the caller has constructed in place at the start of the block.
+    */
+    template <class ValueType>
+    inline static Message<ValueType> *CreateWithConstructedValue(
+        void *const block,
+        const Address &from);
+
+    /**
+    Frees a block allocated with \ref AllocateBlock around which no envelope
+    was constructed. Any value constructed in the block is not destructed.
+    */
+    template <class ValueType>
+    inline static void FreeBlock(IAllocator *const messageAllocator, void *const block);
+
+    /**
+    Destructs and frees a message of unknown type referenced by an interface pointer.
+    Releases the framework's reference on the message; messages referenced by
+    retained \ref MessageView "views" survive until the last view is released.
+    */
+    inline static void Destroy(
+        IAllocator *const messageAllocator,
+        IMessage *const message);
+
+    /**
+    Destructs and frees a message whose last reference has been released.
+    Called directly by the release of the last view on a retained message;
+    everything else goes through \ref Destroy.
+    */
+    inline static void DestroyUnreferenced(
+        IAllocator *const messageAllocator,
+        IMessage *const message);
+};
+
+
+
+template <class ValueType>
+THERON_FORCEINLINE Message<ValueType> *MessageCreator::Create(
+    IAllocator *const messageAllocator,
+    const ValueType &value,
+    const Address &from)
+{
+    typedef Message<ValueType> MessageType;
+
+    const uint32_t blockSize(MessageType::GetSize());
+    const uint32_t blockAlignment(MessageType::GetAlignment());
+
+    // Message types with dedicated pools allocate with a per-type freelist pop,
+    // bypassing the general message caches. The check is a compile-time constant.
+    if (MessagePoolTraits<ValueType>::HAS_POOL)
+    {
+        void *const pooledBlock(MessagePool::Allocate(MessageTraits<ValueType>::TYPE_ID));
+        if (pooledBlock)
+        {
+            return MessageType::Initialize(pooledBlock, value, from);
+        }
+
+        return 0;
+    }
+
+    // Allocate a message. It'll be deleted by the actor after it's been handled.
+    // We allocate a block from the global free list for caching of common allocations.
+    // The free list is thread-safe so we don't need to lock it ourselves.
+    void *const block = messageAllocator->AllocateAligned(blockSize, blockAlignment);
+    if (block)
+    {
+        return MessageType::Initialize(block, value, from);
+    }
+
+    return 0;
+}
+
+
+#if THERON_CPP11
+
+template <class MessageValueType, class ArgumentType>
+THERON_FORCEINLINE Message<MessageValueType> *MessageCreator::Create(
+    IAllocator *const messageAllocator,
+    ArgumentType &&value,
+    const Address &from)
+{
+    typedef Message<MessageValueType> MessageType;
+
+    const uint32_t blockSize(MessageType::GetSize());
+    const uint32_t blockAlignment(MessageType::GetAlignment());
+
+    // Message types with dedicated pools allocate with a per-type freelist pop,
+    // bypassing the general message caches. The check is a compile-time constant.
+    if (MessagePoolTraits<MessageValueType>::HAS_POOL)
+    {
+        void *const pooledBlock(MessagePool::Allocate(MessageTraits<MessageValueType>::TYPE_ID));
+        if (pooledBlock)
+        {
+            return MessageType::Initialize(pooledBlock, std::forward<ArgumentType>(value), from);
+        }
+
+        return 0;
+    }
+
+    // Allocate a message. It'll be deleted by the actor after it's been handled.
+    // We allocate a block from the global free list for caching of common allocations.
+    // The free list is thread-safe so we don't need to lock it ourselves.
+    void *const block = messageAllocator->AllocateAligned(blockSize, blockAlignment);
+    if (block)
+    {
+        return MessageType::Initialize(block, std::forward<ArgumentType>(value), from);
+    }
+
+    return 0;
+}
+
+#endif // THERON_CPP11
+
+
+template <class ValueType>
+THERON_FORCEINLINE void *MessageCreator::AllocateBlock(IAllocator *const messageAllocator)
+{
+    typedef Message<ValueType> MessageType;
+
+    // Message types with dedicated pools allocate with a per-type freelist pop,
+    // bypassing the general message caches. The check is a compile-time constant.
+    if (MessagePoolTraits<ValueType>::HAS_POOL)
+    {
+        return MessagePool::Allocate(MessageTraits<ValueType>::TYPE_ID);
+    }
+
+    return messageAllocator->AllocateAligned(MessageType::GetSize(), MessageType::GetAlignment());
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE Message<ValueType> *MessageCreator::CreateWithConstructedValue(
+    void *const block,
+    const Address &from)
+{
+    return Message<ValueType>::InitializeWithConstructedValue(block, from);
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE void MessageCreator::FreeBlock(IAllocator *const messageAllocator, void *const block)
+{
+    typedef Message<ValueType> MessageType;
+
+    const uint32_t blockSize(MessageType::GetSize());
+
+    // Blocks of message types with dedicated pools are returned to the pool.
+    if (MessagePoolTraits<ValueType>::HAS_POOL &&
+        MessagePool::Free(MessageTraits<ValueType>::TYPE_ID, block, blockSize))
+    {
+        return;
+    }
+
+    // Return the block to the global free list.
+    messageAllocator->Free(block, blockSize);
+}
+
+
+THERON_FORCEINLINE void MessageCreator::Destroy(
+    IAllocator *const messageAllocator,
+    IMessage *const message)
+{
+    // Handlers can retain refcounted views of the message; releasing the
+    // framework's reference only destroys it if no views are outstanding.
+    // The release is a single read in the common view-less case.
+    if (message->ReleaseViewReference())
+    {
+        DestroyUnreferenced(messageAllocator, message);
+    }
+}
+
+
+THERON_FORCEINLINE void MessageCreator::DestroyUnreferenced(
+    IAllocator *const messageAllocator,
+    IMessage *const message)
+{
+    // Read the block and type before destruction; the destroy path is
+    // type-erased, so the type ID identifies any dedicated pool.
+    void *const block(message->GetBlock());
+    const uint32_t blockSize(message->GetBlockSize());
+    const uint32_t typeId(message->GetTypeId());
+
+#if THERON_MAILBOX_POOL_SLOTS
+    const bool pooledBlock(message->IsPooledBlock());
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+    // Call release on the message to give it chance to destruct its value type.
+    // Messages broadcast to multiple recipients share a refcounted value block,
+    // and the block remains referenced until the last of them is released.
+    // Small messages -- trivially-copyable values within the small-message
+    // limit -- are flagged at construction as needing no value destruction,
+    // and never share their blocks, so skip the virtual dispatch entirely.
+    bool blockUnreferenced(true);
+    if (!message->IsSmall())
+    {
+        blockUnreferenced = message->Release();
+    }
+
+    // Destruct the message envelope. The destructor is non-virtual, since
+    // envelope classes do all their cleanup in Release(), so this is a direct
+    // call that releases the references held by the base.
+    message->~IMessage();
+
+    if (!blockUnreferenced)
+    {
+        return;
+    }
+
+#if THERON_MAILBOX_POOL_SLOTS
+    // Blocks claimed from a mailbox micro-pool go back to their pool, checked
+    // first since they were never the property of any allocator or type pool.
+    if (pooledBlock)
+    {
+        MailboxMessagePool::Free(block);
+        return;
+    }
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+    // Blocks of message types with dedicated pools are returned to the pool.
+    if (typeId && MessagePool::Free(typeId, block, blockSize))
+    {
+        return;
+    }
+
+    // Return the block to the global free list.
+    messageAllocator->Free(block, blockSize);
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_MESSAGECREATOR_H
@@ -38,6 +38,13 @@ public:
 
     /**
     Sends an allocated message to the given address.
+    \param localQueue Hints that the destination mailbox should be scheduled on
+    the calling worker thread's stealable local queue rather than the shared
+    queue, keeping producer-consumer pairs core-resident; ignored in contexts
+    with no local queue.
+    \param tailCall Hints that the send is the sending handler's last action,
+    allowing the destination mailbox to be processed inline on the calling
+    worker thread if it's idle.
     */
     static bool Send(
         EndPoint *const endPoint,
@@ -45,15 +52,70 @@ public:
         const uint32_t localFrameworkIndex,
         IMessage *const message,
         const Address &address,
-        const bool localQueue = false);
+        const bool localQueue = false,
+        const bool tailCall = false);
+
+    /**
+    Pushes an allocated message directly into an already-resolved mailbox of
+    the sending framework, scheduling the mailbox as \ref Send would. Used by
+    sends via a pinned \ref MailboxHandle, which skip the per-send resolution
+    of the destination address through the directory.
+    \param address The address of the destination mailbox.
+    */
+    static bool SendToMailbox(
+        Processor::Context *const processorContext,
+        Mailbox *const mailboxPointer,
+        const Address &address,
+        IMessage *const message,
+        const bool localQueue = false,
+        const bool tailCall = false);
+
+    /**
+    Sends a batch of allocated messages to per-message destination addresses,
+    grouping the messages by destination mailbox before delivery.
+
+    A fan-out loop of individual sends resolves its destination and schedules
+    the destination mailbox once per message, interleaving the mailboxes in
+    whatever order the messages arrive. This method stably sorts the batch by
+    destination mailbox index first, so each distinct mailbox in the sending
+    framework is resolved once and typically scheduled once for its whole
+    group of messages. The sort is stable, so messages that share a
+    destination are delivered in their order within the batch; no ordering
+    holds between messages to different destinations.
+
+    Messages addressed by name, or to receivers or mailboxes in other local
+    frameworks, are delivered with ordinary per-message sends.
+
+    \return The number of messages successfully delivered.
+    */
+    static uint32_t SendBatch(
+        EndPoint *const endPoint,
+        Processor::Context *const processorContext,
+        const uint32_t localFrameworkIndex,
+        IMessage *const *const messages,
+        const Address *const addresses,
+        const uint32_t count);
 
     /**
     Delivers an allocated message to a receiver or an actor in some framework within this process.
     This function is non-inlined so serves as a call-point to avoid excessive inlining.
+    \param processorContext Context of the sending thread, if any; worker
+    threads own their contexts, so cache resolved framework lookups in them.
     */
     static bool DeliverWithinLocalProcess(
         IMessage *const message,
-        const Index &index);
+        const Index &index,
+        Processor::Context *const processorContext = 0);
+
+    /**
+    Resolves the name of the local entity registered at the given index.
+    Addresses of local entities are carried as plain indices on the local
+    fast path; this lookup recovers the name of the addressed entity when
+    one is actually needed, typically when a message crosses an EndPoint.
+    \return The name of the registered entity, or a null string if the index
+    is unoccupied or the entity is anonymous.
+    */
+    static String ResolveName(const Index &index);
 };
 
 
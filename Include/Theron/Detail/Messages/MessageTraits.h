@@ -3,6 +3,14 @@
 #define THERON_DETAIL_MESSAGES_MESSAGETRAITS_H
 
 
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#if THERON_CPP11
+#include <type_traits>
+#endif // THERON_CPP11
+
+
 namespace Theron
 {
 namespace Detail
@@ -67,12 +75,58 @@ struct MessageTraits
     \brief The unique name of the type.
     */
     static const char *const TYPE_NAME;
+
+    /**
+    \brief The unique dense integer ID of the type, assigned at static initialization.
+    The reserved value zero indicates that the type hasn't been registered.
+    */
+    static const uint32_t TYPE_ID;
 };
 
 
 template <class ValueType>
 const char *const MessageTraits<ValueType>::TYPE_NAME = 0;
 
+template <class ValueType>
+const uint32_t MessageTraits<ValueType>::TYPE_ID = 0;
+
+
+/**
+\brief Compile-time selection of the small-message fast path.
+
+Message values that are trivially copyable and destructible, and no larger
+than \ref THERON_SMALL_MESSAGE_LIMIT bytes, are plain slabs of data: nothing
+in the message needs destruction beyond the envelope itself. Their envelopes
+are flagged at construction so that the type-erased destroy path can skip the
+virtual release dispatch and free the block directly.
+
+The selection requires the C++11 type traits to detect trivially-copyable
+types; in older dialects no types are selected and all messages take the
+general destroy path, which remains correct for every type.
+
+\tparam ValueType The message type for which the traits are defined.
+\see THERON_SMALL_MESSAGE_LIMIT
+*/
+template <class ValueType>
+struct MessageSmallTraits
+{
+#if THERON_CPP11
+
+    /**
+    \brief Indicates whether messages of the type take the small-message fast path.
+    */
+    static const bool IS_SMALL =
+        std::is_trivially_copyable<ValueType>::value &&
+        std::is_trivially_destructible<ValueType>::value &&
+        (sizeof(ValueType) <= THERON_SMALL_MESSAGE_LIMIT);
+
+#else
+
+    static const bool IS_SMALL = false;
+
+#endif // THERON_CPP11
+};
+
 
 } // namespace Detail
 } // namespace Theron
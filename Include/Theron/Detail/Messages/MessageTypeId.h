@@ -0,0 +1,244 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
+#define THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Process-wide registry that assigns dense 32-bit IDs to registered message types.
+
+Message types registered with \ref THERON_DECLARE_REGISTERED_MESSAGE and
+\ref THERON_DEFINE_REGISTERED_MESSAGE are each assigned a small unique integer ID,
+in addition to their string type name. The IDs are allocated from a single
+process-wide counter during static initialization, when the static TYPE_ID
+members generated by the registration macros are initialized, so by the time
+any message is sent every registered type has its ID.
+
+Because the IDs are dense small integers they are cheaper to carry and compare
+than string names: messages store the ID of their value type, and dispatch
+matches messages to handlers with a single 32-bit comparison rather than a
+pointer or string comparison per handler. The string names are retained
+alongside the IDs for network serialization, where a name that is stable
+across processes is required.
+
+The ID value zero is reserved to mean 'unregistered'; types without explicit
+registration carry ID zero and are matched by built-in C++ RTTI instead.
+*/
+class MessageTypeRegistry
+{
+public:
+
+    /**
+    Reserved ID carried by message types that haven't been explicitly registered.
+    */
+    static const uint32_t INVALID_TYPE_ID = 0;
+
+    /**
+    Number of message type IDs whose urgency can be tracked.
+    Type IDs are assigned densely from one, so this bounds the number of
+    registered message types in the application; urgency declared for types
+    with IDs beyond the bound is silently ignored.
+    */
+    static const uint32_t MAX_URGENT_TYPES = 256;
+
+    /**
+    Number of message type IDs whose conflatability can be tracked.
+    Like urgency, conflatability declared for types with IDs beyond the
+    bound is silently ignored.
+    */
+    static const uint32_t MAX_CONFLATABLE_TYPES = 256;
+
+    /**
+    Allocates the next unassigned type ID.
+    \note Called during static initialization, one call per registered message type.
+    */
+    inline static uint32_t Allocate()
+    {
+        // Static initialization is effectively single-threaded, so a plain
+        // counter suffices. Pre-incrementing reserves zero for unregistered types.
+        static uint32_t smNextTypeId = 0;
+        return ++smNextTypeId;
+    }
+
+    /**
+    Marks the message type with the given ID as urgent.
+    Messages of urgent types are delivered ahead of other messages queued in
+    the same mailbox, through a dedicated in-mailbox lane.
+    \note Called during static initialization by \ref THERON_DEFINE_URGENT_MESSAGE.
+    */
+    inline static void SetUrgent(const uint32_t typeId)
+    {
+        if (typeId < MAX_URGENT_TYPES)
+        {
+            UrgentFlags()[typeId] = 1;
+        }
+    }
+
+    /**
+    Returns true if the message type with the given ID has been marked urgent.
+    \note Called on the message push path, so kept to a bounds check and a byte load.
+    The reserved unregistered ID of zero is never urgent.
+    */
+    THERON_FORCEINLINE static bool IsUrgent(const uint32_t typeId)
+    {
+        return (typeId < MAX_URGENT_TYPES && UrgentFlags()[typeId] != 0);
+    }
+
+    /**
+    Marks the message type with the given ID as conflatable.
+    A newly arriving message of a conflatable type replaces any older message
+    of the same type from the same sender still queued in the destination
+    mailbox, rather than queuing behind it.
+    \note Called during static initialization by \ref THERON_DEFINE_CONFLATABLE_MESSAGE.
+    */
+    inline static void SetConflatable(const uint32_t typeId)
+    {
+        if (typeId < MAX_CONFLATABLE_TYPES)
+        {
+            ConflatableFlags()[typeId] = 1;
+        }
+    }
+
+    /**
+    Returns true if the message type with the given ID has been marked conflatable.
+    \note Called on the message push path, so kept to a bounds check and a byte load.
+    The reserved unregistered ID of zero is never conflatable.
+    */
+    THERON_FORCEINLINE static bool IsConflatable(const uint32_t typeId)
+    {
+        return (typeId < MAX_CONFLATABLE_TYPES && ConflatableFlags()[typeId] != 0);
+    }
+
+private:
+
+    MessageTypeRegistry();
+    MessageTypeRegistry(const MessageTypeRegistry &other);
+    MessageTypeRegistry &operator=(const MessageTypeRegistry &other);
+
+    /**
+    Per-type-ID urgency flags, written only during static initialization.
+    */
+    THERON_FORCEINLINE static uint8_t *UrgentFlags()
+    {
+        // Zero-initialized POD, so initialized before any constructors run.
+        static uint8_t smUrgentFlags[MAX_URGENT_TYPES] = { 0 };
+        return smUrgentFlags;
+    }
+
+    /**
+    Per-type-ID conflatability flags, written only during static initialization.
+    */
+    THERON_FORCEINLINE static uint8_t *ConflatableFlags()
+    {
+        // Zero-initialized POD, so initialized before any constructors run.
+        static uint8_t smConflatableFlags[MAX_CONFLATABLE_TYPES] = { 0 };
+        return smConflatableFlags;
+    }
+};
+
+
+/**
+\brief Traits template indicating whether a message type is delivered urgently.
+
+The default implementation declares no urgency, so ordinary message types pay
+nothing. Specializations generated by \ref THERON_DECLARE_URGENT_MESSAGE
+declare the type urgent, causing its messages to be delivered ahead of other
+messages queued in the same mailbox.
+
+\tparam ValueType The message type for which the traits are defined.
+\see THERON_DECLARE_URGENT_MESSAGE
+*/
+template <class ValueType>
+struct MessageUrgencyTraits
+{
+    /**
+    \brief Indicates whether the message type is delivered urgently.
+    */
+    static const bool IS_URGENT = false;
+};
+
+
+/**
+Registers the urgency of a message type during static initialization.
+An instance is generated as a static member of the urgency traits of each
+urgent message type by \ref THERON_DEFINE_URGENT_MESSAGE.
+*/
+class MessageUrgencyRegistrar
+{
+public:
+
+    /**
+    Constructor; marks the message type with the given ID as urgent.
+    */
+    inline explicit MessageUrgencyRegistrar(const uint32_t typeId)
+    {
+        MessageTypeRegistry::SetUrgent(typeId);
+    }
+
+private:
+
+    MessageUrgencyRegistrar(const MessageUrgencyRegistrar &other);
+    MessageUrgencyRegistrar &operator=(const MessageUrgencyRegistrar &other);
+};
+
+
+/**
+\brief Traits template indicating whether a message type is conflatable.
+
+The default implementation declares no conflatability, so ordinary message
+types pay nothing. Specializations generated by
+\ref THERON_DECLARE_CONFLATABLE_MESSAGE declare the type conflatable, causing
+a newly arriving message to replace an older queued message of the same type
+from the same sender, rather than queuing behind it.
+
+\tparam ValueType The message type for which the traits are defined.
+\see THERON_DECLARE_CONFLATABLE_MESSAGE
+*/
+template <class ValueType>
+struct MessageConflationTraits
+{
+    /**
+    \brief Indicates whether the message type is conflatable.
+    */
+    static const bool IS_CONFLATABLE = false;
+};
+
+
+/**
+Registers the conflatability of a message type during static initialization.
+An instance is generated as a static member of the conflation traits of each
+conflatable message type by \ref THERON_DEFINE_CONFLATABLE_MESSAGE.
+*/
+class MessageConflationRegistrar
+{
+public:
+
+    /**
+    Constructor; marks the message type with the given ID as conflatable.
+    */
+    inline explicit MessageConflationRegistrar(const uint32_t typeId)
+    {
+        MessageTypeRegistry::SetConflatable(typeId);
+    }
+
+private:
+
+    MessageConflationRegistrar(const MessageConflationRegistrar &other);
+    MessageConflationRegistrar &operator=(const MessageConflationRegistrar &other);
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_MESSAGETYPEID_H
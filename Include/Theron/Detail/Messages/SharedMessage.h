@@ -0,0 +1,217 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
+#define THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
+
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Alignment/MessageAlignment.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Message class used for broadcasting one value to many recipients.
+
+A broadcast to n recipients constructs the message value once, in a single
+memory block, followed by n lightweight envelope message objects that all
+reference it. Each envelope is queued to one recipient like an ordinary
+message, so to handlers a shared message is indistinguishable from a
+\ref Message, but an expensive value is copied once instead of once per
+recipient. The envelopes share a reference count, and the release of the
+last envelope destructs the value and unreferences the block.
+
+The value and the envelopes are laid out side by side in the shared block.
+The value is first, since it's the value that needs the alignment, and
+every envelope references the start of the block, matching the layout
+assumed by the handler-side message casts:
+
+\code
++-------+-----------+------------+-----+----------------+
+| value | refcount  | envelope 0 | ... | envelope n - 1 |
++-------+-----------+------------+-----+----------------+
+\endcode
+
+\note The value is shared by all recipients, so must not be modified by
+message handlers, which would otherwise race with handlers running in
+other worker threads. In particular broadcast messages must not be handled
+by mutable handlers, registered for non-const message references.
+*/
+template <class ValueType>
+class SharedMessage : public IMessage
+{
+public:
+
+    typedef SharedMessage<ValueType> ThisType;
+
+    /**
+    Returns the memory block size required to initialize a shared message
+    with the given number of recipient envelopes.
+    */
+    THERON_FORCEINLINE static uint32_t GetSize(const uint32_t count)
+    {
+        return GetValueSize() + static_cast<uint32_t>(sizeof(Header)) + count * static_cast<uint32_t>(sizeof(ThisType));
+    }
+
+    /**
+    Returns the memory block alignment required to initialize a message of this type.
+    */
+    THERON_FORCEINLINE static uint32_t GetAlignment()
+    {
+        return MessageAlignment<ValueType>::ALIGNMENT;
+    }
+
+    /**
+    Initializes a shared message in the provided memory block, copying the value
+    once and constructing an envelope per recipient.
+    The block is allocated by the caller and freed by the release of the last envelope.
+    \return A pointer to the first of the count constructed envelopes, which are contiguous.
+    */
+    THERON_FORCEINLINE static ThisType *Initialize(
+        void *const block,
+        const ValueType &value,
+        const Address &from,
+        const uint32_t count)
+    {
+        THERON_ASSERT(block);
+        THERON_ASSERT(count);
+
+        // Instantiate a single shared instance of the value type in aligned
+        // position at the start of the buffer, as with an unshared message.
+        ValueType *const pValue = new (block) ValueType(value);
+
+        // The reference count follows the value; one reference per envelope.
+        char *const pHeader(reinterpret_cast<char *>(pValue) + GetValueSize());
+        Header *const header = new (pHeader) Header();
+        header->mRefCount.Store(count);
+
+        // The envelopes follow the header, laid out contiguously.
+        const uint32_t blockSize(GetSize(count));
+        char *pObject(pHeader + sizeof(Header));
+
+        ThisType *const envelopes(reinterpret_cast<ThisType *>(pObject));
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            new (pObject) ThisType(pValue, blockSize, from, header);
+            pObject += sizeof(ThisType);
+        }
+
+        return envelopes;
+    }
+
+    /**
+    Returns the name of the message type.
+    This uniquely identifies the type of the message value.
+    \note Unless explicitly specified to avoid C++ RTTI, message names are null.
+    */
+    virtual const char *TypeName() const
+    {
+        return MessageTraits<ValueType>::TYPE_NAME;
+    }
+
+    /**
+    Releases this envelope's reference on the shared value.
+    The last envelope to be released destructs the value and unreferences the
+    block, allowing the caller to free it.
+    \return True, if the block is no longer referenced and can be freed.
+    */
+    virtual bool Release()
+    {
+        // The decrement returns the count held before the decrement, so the
+        // envelope releasing the last reference sees a count of one.
+        if (mHeader->mRefCount.FetchDecrement() == 1)
+        {
+            Value().~ValueType();
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+    Returns the size in bytes of the message value.
+    */
+    virtual uint32_t GetMessageSize() const
+    {
+        return GetValueSize();
+    }
+
+    /**
+    Gets the value carried by the message.
+    */
+    THERON_FORCEINLINE const ValueType &Value() const
+    {
+        // The value is stored at the start of the memory block.
+        return *reinterpret_cast<const ValueType *>(GetBlock());
+    }
+
+private:
+
+    /**
+    Bookkeeping shared by the envelopes, stored between the value and the envelopes.
+    */
+    struct Header
+    {
+        Atomic::UInt32 mRefCount;       ///< Number of envelopes still referencing the value.
+    };
+
+    /**
+    Private constructor.
+    */
+    THERON_FORCEINLINE SharedMessage(
+        void *const block,
+        const uint32_t blockSize,
+        const Address &from,
+        Header *const header) :
+      IMessage(from, block, blockSize, MessageTraits<ValueType>::TYPE_ID),
+      mHeader(header)
+    {
+        THERON_ASSERT(block);
+        THERON_ASSERT(header);
+    }
+
+    THERON_FORCEINLINE ValueType &Value()
+    {
+        // The value is stored at the start of the memory block.
+        return *reinterpret_cast<ValueType *>(GetBlock());
+    }
+
+    THERON_FORCEINLINE static uint32_t GetValueSize()
+    {
+        uint32_t valueSize(sizeof(ValueType));
+        const uint32_t minimumAllocationSize(4);
+
+        // Round small values up to four bytes so the data that follows the
+        // value stays 4-byte aligned, as with an unshared message.
+        if (valueSize < minimumAllocationSize)
+        {
+            valueSize = minimumAllocationSize;
+        }
+
+        return valueSize;
+    }
+
+    SharedMessage(const SharedMessage &other);
+    SharedMessage &operator=(const SharedMessage &other);
+
+    Header *const mHeader;              ///< Pointer to the bookkeeping shared with the other envelopes.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_MESSAGES_SHAREDMESSAGE_H
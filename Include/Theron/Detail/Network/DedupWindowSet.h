@@ -0,0 +1,130 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_DEDUPWINDOWSET_H
+#define THERON_DETAIL_NETWORK_DEDUPWINDOWSET_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Set of per-sender windows of recently received sequence numbers, used by a
+receiving endpoint to drop duplicate frames from senders that sequence their
+deliveries. Each tracked sender has a window recording the highest sequence
+number received from it and a bitmask of receipt of the 64 sequence numbers
+up to the highest, so acceptance is a constant-time check tolerating modest
+reordering. A remote sender's connection is serviced by a single network
+thread, so the set requires no synchronization.
+*/
+class DedupWindowSet
+{
+public:
+
+    /**
+    Maximum number of remote senders tracked. Frames from senders beyond the
+    limit are accepted without deduplication.
+    */
+    static const uint32_t MAX_WINDOWS = 64;
+
+    inline DedupWindowSet() : mNumWindows(0)
+    {
+    }
+
+    /**
+    Updates the sending sender's window for a received sequence number.
+    \return True if the frame is new and should be delivered; false if it's a
+    duplicate, or a late replay older than the window, and should be dropped.
+    */
+    inline bool Accept(const uint32_t senderId, const uint64_t sequence);
+
+private:
+
+    DedupWindowSet(const DedupWindowSet &other);
+    DedupWindowSet &operator=(const DedupWindowSet &other);
+
+    /**
+    Per-sender window of recently received sequence numbers.
+    */
+    struct Window
+    {
+        uint32_t mSenderId;         ///< Identifier of the remote sender.
+        uint64_t mHighestSequence;  ///< Highest sequence number received from the sender.
+        uint64_t mRecentMask;       ///< Bitmask of receipt of the 64 sequence numbers up to the highest.
+    };
+
+    Window mWindows[MAX_WINDOWS];   ///< Windows of recent sequence numbers, one per tracked sender.
+    uint32_t mNumWindows;           ///< Number of remote senders currently tracked.
+};
+
+
+inline bool DedupWindowSet::Accept(const uint32_t senderId, const uint64_t sequence)
+{
+    // Find the window tracking this sender. The set of remote senders is
+    // small and stable, so a linear scan suffices.
+    Window *window(0);
+    for (uint32_t index = 0; index < mNumWindows; ++index)
+    {
+        if (mWindows[index].mSenderId == senderId)
+        {
+            window = &mWindows[index];
+            break;
+        }
+    }
+
+    // A sender not seen before starts a fresh window at its first sequence.
+    if (window == 0)
+    {
+        if (mNumWindows == MAX_WINDOWS)
+        {
+            // No space to track the sender; deliver rather than drop.
+            return true;
+        }
+
+        window = &mWindows[mNumWindows++];
+        window->mSenderId = senderId;
+        window->mHighestSequence = sequence;
+        window->mRecentMask = 1;
+
+        return true;
+    }
+
+    // A sequence number beyond the highest seen advances the window.
+    if (sequence > window->mHighestSequence)
+    {
+        const uint64_t advance(sequence - window->mHighestSequence);
+        window->mRecentMask = (advance < 64) ? ((window->mRecentMask << advance) | 1) : 1;
+        window->mHighestSequence = sequence;
+
+        return true;
+    }
+
+    // Frames older than the window tracks are assumed to be late replays.
+    const uint64_t age(window->mHighestSequence - sequence);
+    if (age >= 64)
+    {
+        return false;
+    }
+
+    // A frame within the window is a duplicate if its bit is already set.
+    const uint64_t bit(static_cast<uint64_t>(1) << age);
+    if (window->mRecentMask & bit)
+    {
+        return false;
+    }
+
+    window->mRecentMask |= bit;
+    return true;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_NETWORK_DEDUPWINDOWSET_H
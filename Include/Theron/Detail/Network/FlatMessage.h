@@ -0,0 +1,283 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_FLATMESSAGE_H
+#define THERON_DETAIL_NETWORK_FLATMESSAGE_H
+
+
+#include <new>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/SIMD/MemoryCopy.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4996)  // function or variable may be unsafe.
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Flat wire format for messages of registered types sent on the network.
+
+Where \ref NetworkMessage carries the message type as a null-terminated name
+string, matched against the receiver's registrations by string comparison, a
+flat message carries the 32-bit hash the type name is interned with, so the
+receiving endpoint can look the type up directly without interning a string
+per message. The message value itself is copied as a single flat block, as in
+the generic format; the saving is in the per-message type identification.
+
+Flat frames are self-describing: they start with a marker word that can never
+match the leading word of a \ref NetworkMessage frame or a batch header, so a
+receiver can decode a mix of flat and generic frames on the same connection.
+The header also carries a format version, so a receiver confronted with a
+frame from a future revision of the layout detects it and skips the frame
+rather than misreading it.
+*/
+class FlatMessage
+{
+public:
+
+    /**
+    Leading word identifying a flat frame. A \ref NetworkMessage frame starts
+    with an offset field that is always at least the size of that structure,
+    and coalesced batches start with a zero marker word, so small non-zero
+    values are free to identify other formats.
+    */
+    static const uint32_t MARKER = 1;
+
+    /**
+    Version of the flat frame layout written by this build.
+    */
+    static const uint32_t VERSION = 1;
+
+    /**
+    Returns the size in bytes of the memory block required to hold a flat frame.
+    */
+    inline static uint32_t GetSize(
+        const char *const fromName,
+        const char *const toName,
+        const uint32_t messageSize);
+
+    /**
+    Constructs a flat frame in the provided memory buffer.
+    \note A null message data pointer writes no payload bytes, for payloads
+    sent out-of-frame as separate zero-copy message parts; the recorded size
+    still describes the payload.
+    */
+    inline static FlatMessage *Initialize(
+        void *const memoryBlock,
+        const char *const fromName,
+        const char *const toName,
+        const uint32_t typeHash,
+        const void *const messageData,
+        const uint32_t messageSize);
+
+    /**
+    Gets the version of the layout the frame was written with.
+    */
+    inline uint32_t GetVersion() const;
+
+    /**
+    Gets the hash of the name of the message type.
+    */
+    inline uint32_t GetTypeHash() const;
+
+    /**
+    Gets the 'from' name string.
+    */
+    inline const char *GetFromName() const;
+
+    /**
+    Gets the 'to' name string.
+    */
+    inline const char *GetToName() const;
+
+    /**
+    Gets a pointer to the message data.
+    */
+    inline const void *GetMessageData() const;
+
+    /**
+    Gets the size of the message data in bytes.
+    */
+    inline uint32_t GetMessageSize() const;
+
+private:
+
+    uint32_t mMarker;               ///< Format marker word; always \ref MARKER.
+    uint32_t mVersion;              ///< Version of the frame layout.
+    uint32_t mTypeHash;             ///< Hash of the name of the message type.
+    uint32_t mToNameOffset;         ///< Offset to the null-terminated 'to' name in bytes.
+    uint32_t mMessageDataOffset;    ///< Offset to the message data block in bytes.
+    uint32_t mMessageDataSize;      ///< Size of the message data block in bytes.
+};
+
+
+inline uint32_t FlatMessage::GetSize(
+    const char *const fromName,
+    const char *const toName,
+    const uint32_t messageSize)
+{
+    uint32_t size(0);
+
+    // String sizes including the terminating null characters.
+    // The 'from' and 'to' addresses are allowed to be null, and if so are skipped.
+    uint32_t fromNameSize(0);
+    if (fromName)
+    {
+        fromNameSize = static_cast<uint32_t>(strlen(fromName) + 1);
+    }
+
+    uint32_t toNameSize(0);
+    if (toName)
+    {
+        toNameSize = static_cast<uint32_t>(strlen(toName) + 1);
+    }
+
+    size += sizeof(FlatMessage);
+    size += fromNameSize;
+    size += toNameSize;
+    size += messageSize;
+
+    return THERON_ROUNDUP(size, 4);
+}
+
+
+inline FlatMessage *FlatMessage::Initialize(
+    void *const memoryBlock,
+    const char *const fromName,
+    const char *const toName,
+    const uint32_t typeHash,
+    const void *const messageData,
+    const uint32_t messageSize)
+{
+    FlatMessage *const instance = new (memoryBlock) FlatMessage;
+
+    // String sizes including the terminating null characters.
+    // The 'from' address is allowed to be null, and if so is skipped.
+    uint32_t fromNameSize(0);
+    if (fromName)
+    {
+        fromNameSize = static_cast<uint32_t>(strlen(fromName) + 1);
+    }
+
+    uint32_t toNameSize(0);
+    if (toName)
+    {
+        toNameSize = static_cast<uint32_t>(strlen(toName) + 1);
+    }
+
+    // Initialize the instance members.
+    // The offset to the 'from' name is implicit since it's just the size of the class.
+    const uint32_t fromNameOffset(sizeof(FlatMessage));
+    instance->mMarker = MARKER;
+    instance->mVersion = VERSION;
+    instance->mTypeHash = typeHash;
+    instance->mToNameOffset = fromNameOffset + fromNameSize;
+    instance->mMessageDataOffset = instance->mToNameOffset + toNameSize;
+    instance->mMessageDataSize = messageSize;
+
+    // Copy in the actual data.
+    uint8_t *data(reinterpret_cast<uint8_t *>(memoryBlock));
+
+    if (fromNameSize)
+    {
+        memcpy(data + fromNameOffset, fromName, fromNameSize);
+    }
+
+    if (toNameSize)
+    {
+        memcpy(data + instance->mToNameOffset, toName, toNameSize);
+    }
+
+    // The data pointer is null when the message data is sent out-of-band as a
+    // separate zero-copy message part; the recorded size still describes it.
+    // Large payloads are streamed past the cache with non-temporal stores,
+    // since the copy is read next by the transport rather than this thread.
+    if (messageData)
+    {
+        MemoryCopy(data + instance->mMessageDataOffset, messageData, messageSize);
+    }
+
+    return instance;
+}
+
+
+THERON_FORCEINLINE uint32_t FlatMessage::GetVersion() const
+{
+    return mVersion;
+}
+
+
+THERON_FORCEINLINE uint32_t FlatMessage::GetTypeHash() const
+{
+    return mTypeHash;
+}
+
+
+THERON_FORCEINLINE const char *FlatMessage::GetFromName() const
+{
+    const uint8_t *const data(reinterpret_cast<const uint8_t *>(this));
+    const uint8_t *const field(data + sizeof(FlatMessage));
+
+    // The 'from' name can be null, in which case it's skipped.
+    if (mToNameOffset != sizeof(FlatMessage))
+    {
+        return reinterpret_cast<const char *>(field);
+    }
+
+    return 0;
+}
+
+
+THERON_FORCEINLINE const char *FlatMessage::GetToName() const
+{
+    const uint8_t *const data(reinterpret_cast<const uint8_t *>(this));
+    const uint8_t *const field(data + mToNameOffset);
+
+    // The 'to' name can be null, in which case it's skipped.
+    if (mMessageDataOffset != mToNameOffset)
+    {
+        return reinterpret_cast<const char *>(field);
+    }
+
+    return 0;
+}
+
+
+THERON_FORCEINLINE const void *FlatMessage::GetMessageData() const
+{
+    const uint8_t *const data(reinterpret_cast<const uint8_t *>(this));
+    const uint8_t *const field(data + mMessageDataOffset);
+    return reinterpret_cast<const void *>(field);
+}
+
+
+THERON_FORCEINLINE uint32_t FlatMessage::GetMessageSize() const
+{
+    return mMessageDataSize;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_NETWORK_FLATMESSAGE_H
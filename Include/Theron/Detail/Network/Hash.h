@@ -32,20 +32,9 @@ public:
     {
         THERON_ASSERT(!name.IsNull());
 
-        // XOR the first n characters of the string together.
-        const char *const str(name.GetValue());
-        const char *const end(str + 64);
-
-        const char *ch(str);
-        uint8_t hash(0);
-
-        while (ch != end && *ch != '\0')
-        {
-            hash ^= static_cast<uint8_t>(*ch);
-            ++ch;
-        }
-
-        return static_cast<uint32_t>(hash);
+        // String values are interned, so the hash of the value was computed
+        // once on interning and just needs folding into the output range.
+        return (name.GetHash() & (RANGE - 1));
     }
 };
 
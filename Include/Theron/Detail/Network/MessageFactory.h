@@ -20,6 +20,7 @@
 #include <Theron/Detail/Messages/MessageCreator.h>
 #include <Theron/Detail/Network/Hash.h>
 #include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Threading/Atomic.h>
 #include <Theron/Detail/Threading/SpinLock.h>
 
 
@@ -34,8 +35,55 @@ Associates string names to mailbox indices.
 */
 class MessageFactory
 {
+private:
+
+    class IMessageBuilder;
+
 public:
 
+    /**
+    Per-receiving-thread cache of resolved message type lookups.
+
+    Once a receiving thread has resolved a message type once, the builder is
+    remembered in a small direct-mapped array indexed by the hash of the type
+    name, so steady-state deserialization costs an array index per message
+    instead of a lock acquisition and a hash map walk. Each cache is owned
+    and accessed by a single receiving thread, so needs no synchronization;
+    registration or deregistration of types bumps a version counter in the
+    factory, which each cache checks on lookup and flushes itself when stale.
+    */
+    class BuilderCache
+    {
+    public:
+
+        static const uint32_t SIZE = 64;    ///< Number of direct-mapped entries; a power of two.
+
+        inline BuilderCache() : mVersion(0)
+        {
+        }
+
+    private:
+
+        friend class MessageFactory;
+
+        /**
+        A single cached resolution of a type name hash to its builder.
+        */
+        struct Entry
+        {
+            inline Entry() : mHash(0), mName(), mBuilder(0)
+            {
+            }
+
+            uint32_t mHash;                 ///< Hash of the registered type name.
+            String mName;                   ///< Registered type name; null for entries cached by hash alone.
+            IMessageBuilder *mBuilder;      ///< The builder registered for the type.
+        };
+
+        uint32_t mVersion;                  ///< Factory version the cached entries were resolved against.
+        Entry mEntries[SIZE];               ///< Direct-mapped entries, indexed by type name hash.
+    };
+
     /**
     Constructor.
     */
@@ -78,6 +126,41 @@ public:
         const uint32_t messageSize,
         const Address &from) const;
 
+    /**
+    Builds a message of the type whose registered name has the given hash.
+    Used by the flat wire format, whose frames identify the message type by
+    the 32-bit hash its name is interned with rather than by a name string.
+    \note If no type with a matching name hash is registered then the returned pointer is null.
+    */
+    inline IMessage *BuildFromHash(
+        const uint32_t typeHash,
+        const void *const messageData,
+        const uint32_t messageSize,
+        const Address &from) const;
+
+    /**
+    Builds a message of the type registered under the given name, consulting
+    the given per-thread cache before falling back to the locked map lookup.
+    */
+    inline IMessage *Build(
+        BuilderCache &cache,
+        const String &name,
+        const void *const messageData,
+        const uint32_t messageSize,
+        const Address &from) const;
+
+    /**
+    Builds a message of the type whose registered name has the given hash,
+    consulting the given per-thread cache before falling back to the locked
+    map lookup.
+    */
+    inline IMessage *BuildFromHash(
+        BuilderCache &cache,
+        const uint32_t typeHash,
+        const void *const messageData,
+        const uint32_t messageSize,
+        const Address &from) const;
+
 private:
 
     /**
@@ -134,6 +217,24 @@ private:
 
     typedef Map<String, IMessageBuilder *, Hash> MessageBuilderMap;
 
+    /**
+    Hashes 32-bit name hashes into the bucket range of the hash-keyed map.
+    */
+    struct UIntHash
+    {
+        enum
+        {
+            RANGE = 256
+        };
+
+        THERON_FORCEINLINE static uint32_t Compute(const uint32_t value)
+        {
+            return (value & (RANGE - 1));
+        }
+    };
+
+    typedef Map<uint32_t, IMessageBuilder *, UIntHash> HashBuilderMap;
+
     MessageFactory(const MessageFactory &other);
     MessageFactory &operator=(const MessageFactory &other);
 
@@ -142,12 +243,24 @@ private:
     */
     inline bool RegisterBuilder(const String &name, IMessageBuilder *const builder);
 
+    /**
+    Looks up the builder cached under the given hash, flushing the cache first
+    if types have been registered or deregistered since it was last filled.
+    \return The cached builder, or zero on a miss.
+    */
+    inline IMessageBuilder *CachedBuilder(
+        BuilderCache &cache,
+        const uint32_t hash,
+        const String &name) const;
+
     mutable SpinLock mSpinLock;         ///< Thread-safe access.
     MessageBuilderMap mMap;             ///< Map of names to typed message creators.
+    HashBuilderMap mHashMap;            ///< Map of name hashes to the same creators, for the flat wire format.
+    Atomic::UInt32 mVersion;            ///< Bumped on registration changes, invalidating the per-thread caches.
 };
 
 
-inline MessageFactory::MessageFactory() : mSpinLock(), mMap()
+inline MessageFactory::MessageFactory() : mSpinLock(), mMap(), mHashMap(), mVersion(0)
 {
 }
 
@@ -156,6 +269,16 @@ inline MessageFactory::~MessageFactory()
 {
     IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
 
+    // Clear the hash-keyed map first; its values are shared with the name-keyed
+    // map, so only the nodes are freed here and the builders are freed below.
+    while (HashBuilderMap::Node *const node = mHashMap.Front())
+    {
+        mHashMap.Remove(node);
+
+        node->~Node();
+        allocator->Free(node, sizeof(HashBuilderMap::Node));
+    }
+
     // Clear the map on destruction.
     while (MessageBuilderMap::Node *const node = mMap.Front())
     {
@@ -208,24 +331,43 @@ inline bool MessageFactory::RegisterBuilder(const String &name, IMessageBuilder
         return false;
     }
 
+    void *const hashNodeMemory(allocator->Allocate(sizeof(HashBuilderMap::Node)));
+    if (hashNodeMemory == 0)
+    {
+        allocator->Free(nodeMemory, sizeof(MessageBuilderMap::Node));
+        return false;
+    }
+
     MessageBuilderMap::Node *node = new (nodeMemory) MessageBuilderMap::Node(name, builder);
+    HashBuilderMap::Node *hashNode = new (hashNodeMemory) HashBuilderMap::Node(name.GetHash(), builder);
 
     mSpinLock.Lock();
 
     // Check for existing pairs with the same key. At most one is allowed.
     if (!mMap.Contains(name) && mMap.Insert(node))
     {
+        // Mirror the entry into the hash-keyed map for flat-format lookups.
+        mHashMap.Insert(hashNode);
+
+        // Invalidate the per-thread builder caches, whose entries were
+        // resolved against the previous contents of the maps.
+        mVersion.Increment();
+
         node = 0;
+        hashNode = 0;
     }
 
     mSpinLock.Unlock();
 
-    // Destroy the builder and node if the insert failed.
+    // Destroy the builder and nodes if the insert failed.
     if (node == 0)
     {
         return true;
     }
 
+    hashNode->~Node();
+    allocator->Free(hashNode, sizeof(HashBuilderMap::Node));
+
     node->~Node();
     allocator->Free(node, sizeof(MessageBuilderMap::Node));
 
@@ -245,8 +387,32 @@ inline bool MessageFactory::Deregister(const String &name)
 
         if (mMap.Remove(node))
         {
+            // Remove the mirrored hash-keyed entry referencing the same builder.
+            HashBuilderMap::KeyNodeIterator hashNodes(mHashMap.GetKeyNodeIterator(name.GetHash()));
+            HashBuilderMap::Node *hashNode(0);
+
+            while (hashNodes.Next())
+            {
+                if (hashNodes.Get()->mValue == node->mValue)
+                {
+                    hashNode = hashNodes.Get();
+                    mHashMap.Remove(hashNode);
+                    break;
+                }
+            }
+
+            // Invalidate the per-thread builder caches, which may hold the
+            // removed builder.
+            mVersion.Increment();
+
             mSpinLock.Unlock();
 
+            if (hashNode)
+            {
+                hashNode->~Node();
+                allocator->Free(hashNode, sizeof(HashBuilderMap::Node));
+            }
+
             node->mValue->~IMessageBuilder();
             allocator->Free(node->mValue);
 
@@ -300,6 +466,141 @@ inline IMessage *MessageFactory::Build(
 }
 
 
+inline IMessage *MessageFactory::BuildFromHash(
+    const uint32_t typeHash,
+    const void *const messageData,
+    const uint32_t messageSize,
+    const Address &from) const
+{
+    IMessage *message(0);
+    mSpinLock.Lock();
+
+    HashBuilderMap::KeyNodeIterator nodes(mHashMap.GetKeyNodeIterator(typeHash));
+    if (nodes.Next())
+    {
+        const HashBuilderMap::Node *const node(nodes.Get());
+        IMessageBuilder *const builder(node->mValue);
+
+        message = builder->Build(messageData, messageSize, from);
+    }
+
+    mSpinLock.Unlock();
+    return message;
+}
+
+
+THERON_FORCEINLINE MessageFactory::IMessageBuilder *MessageFactory::CachedBuilder(
+    BuilderCache &cache,
+    const uint32_t hash,
+    const String &name) const
+{
+    // Registration changes invalidate the caches wholesale: a stale cache is
+    // flushed and refilled lazily, as its owning thread resolves types again.
+    const uint32_t version(mVersion.Load());
+    if (cache.mVersion != version)
+    {
+        for (uint32_t index = 0; index < BuilderCache::SIZE; ++index)
+        {
+            cache.mEntries[index] = BuilderCache::Entry();
+        }
+
+        cache.mVersion = version;
+        return 0;
+    }
+
+    // Entries cached by the name-based path carry the registered name, which
+    // hash-based lookups ignore: the flat wire format identifies types by
+    // name hash alone, so a matching hash identifies the type.
+    const BuilderCache::Entry &entry(cache.mEntries[hash & (BuilderCache::SIZE - 1)]);
+    if (entry.mBuilder && entry.mHash == hash && (name.IsNull() || entry.mName == name))
+    {
+        return entry.mBuilder;
+    }
+
+    return 0;
+}
+
+
+inline IMessage *MessageFactory::Build(
+    BuilderCache &cache,
+    const String &name,
+    const void *const messageData,
+    const uint32_t messageSize,
+    const Address &from) const
+{
+    const uint32_t hash(name.GetHash());
+
+    // In the steady state the type has been resolved before by this thread,
+    // and the builder is found with an array index instead of a locked map walk.
+    IMessageBuilder *const cached(CachedBuilder(cache, hash, name));
+    if (cached)
+    {
+        return cached->Build(messageData, messageSize, from);
+    }
+
+    IMessage *message(0);
+    mSpinLock.Lock();
+
+    MessageBuilderMap::KeyNodeIterator nodes(mMap.GetKeyNodeIterator(name));
+    if (nodes.Next())
+    {
+        const MessageBuilderMap::Node *const node(nodes.Get());
+        IMessageBuilder *const builder(node->mValue);
+
+        // Remember the resolution for subsequent messages of the type.
+        BuilderCache::Entry &entry(cache.mEntries[hash & (BuilderCache::SIZE - 1)]);
+        entry.mHash = hash;
+        entry.mName = name;
+        entry.mBuilder = builder;
+
+        message = builder->Build(messageData, messageSize, from);
+    }
+
+    mSpinLock.Unlock();
+    return message;
+}
+
+
+inline IMessage *MessageFactory::BuildFromHash(
+    BuilderCache &cache,
+    const uint32_t typeHash,
+    const void *const messageData,
+    const uint32_t messageSize,
+    const Address &from) const
+{
+    // In the steady state the type has been resolved before by this thread,
+    // and the builder is found with an array index instead of a locked map walk.
+    IMessageBuilder *const cached(CachedBuilder(cache, typeHash, String()));
+    if (cached)
+    {
+        return cached->Build(messageData, messageSize, from);
+    }
+
+    IMessage *message(0);
+    mSpinLock.Lock();
+
+    HashBuilderMap::KeyNodeIterator nodes(mHashMap.GetKeyNodeIterator(typeHash));
+    if (nodes.Next())
+    {
+        const HashBuilderMap::Node *const node(nodes.Get());
+        IMessageBuilder *const builder(node->mValue);
+
+        // Remember the resolution for subsequent messages of the type. The
+        // name is left null; name-based lookups landing on the entry refill
+        // it with the name, after which both paths match it.
+        BuilderCache::Entry &entry(cache.mEntries[typeHash & (BuilderCache::SIZE - 1)]);
+        entry.mHash = typeHash;
+        entry.mName = String();
+        entry.mBuilder = builder;
+
+        message = builder->Build(messageData, messageSize, from);
+    }
+
+    mSpinLock.Unlock();
+    return message;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
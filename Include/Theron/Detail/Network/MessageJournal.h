@@ -0,0 +1,598 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_MESSAGEJOURNAL_H
+#define THERON_DETAIL_NETWORK_MESSAGEJOURNAL_H
+
+
+#include <string.h>
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#if THERON_WINDOWS
+
+#include <windows.h>
+
+#elif defined(THERON_POSIX)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#endif
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Write-behind journal of serialized network message frames.
+
+The journal is a fixed-size ring of records in a memory-mapped file. The
+network thread appends each outgoing frame with a single copy into the
+mapped region; the operating system writes the dirty pages back to the
+file behind the scenes, so appending never blocks on disk I/O. When the
+ring fills, the oldest records are overwritten.
+
+Each record is a \ref RecordHeader followed by the serialized
+\ref NetworkMessage frame and, for zero-copy sends whose payload travels
+out-of-frame on the wire, the payload bytes. Records wrap modularly
+around the ring, so a record may be split across the ring boundary.
+
+The file starts with a header holding the ring size and two monotonically
+increasing byte offsets: the write offset, published after each record is
+complete, and the oldest offset, advanced past records before they are
+overwritten. A reader positioned at the oldest offset therefore always
+sees a sequence of intact records, up to the published write offset.
+
+\note The journal has a single writer and is not internally synchronized;
+appends are serialized by being performed only on the sending network thread.
+*/
+class MessageJournal
+{
+public:
+
+    /**
+    Fixed-size header preceding each journaled record.
+    */
+    struct RecordHeader
+    {
+        uint64_t mTimestamp;        ///< Wall-clock time of the send, in microseconds since the Unix epoch.
+        uint32_t mFrameSize;        ///< Size in bytes of the serialized network message frame.
+        uint32_t mPayloadSize;      ///< Size in bytes of the out-of-frame payload; zero for in-frame payloads.
+    };
+
+    /**
+    Default constructor. Constructs a closed journal.
+    */
+    inline MessageJournal();
+
+    /**
+    Destructor. Closes the journal if open.
+    */
+    inline ~MessageJournal();
+
+    /**
+    Creates or truncates the journal file at the given path for writing,
+    with a ring of the given size in bytes.
+    \return True, if the file was created and mapped successfully.
+    */
+    inline bool Open(const char *const path, const uint32_t ringSizeBytes);
+
+    /**
+    Opens an existing journal file at the given path for reading.
+    \return True, if the file was opened, mapped and recognized as a journal.
+    */
+    inline bool OpenForReading(const char *const path);
+
+    /**
+    Unmaps and closes the journal file, if open.
+    */
+    inline void Close();
+
+    /**
+    Returns true if the journal is currently open.
+    */
+    THERON_FORCEINLINE bool IsOpen() const
+    {
+        return (mHeader != 0);
+    }
+
+    /**
+    Returns the size in bytes of the ring of an open journal, which bounds the
+    size of any record it holds.
+    */
+    THERON_FORCEINLINE uint32_t GetRingSize() const
+    {
+        THERON_ASSERT(mHeader);
+        return mHeader->mRingSize;
+    }
+
+    /**
+    Appends a record holding the given frame and optional out-of-frame payload.
+    Overwrites the oldest records if the ring is full; drops the record if it
+    is larger than the whole ring.
+    */
+    inline void Append(
+        const void *const frame,
+        const uint32_t frameSize,
+        const void *const payload,
+        const uint32_t payloadSize);
+
+    /**
+    Positions the read cursor at the oldest intact record.
+    */
+    inline void Rewind();
+
+    /**
+    Reads the record at the cursor and advances the cursor past it.
+
+    The frame and any payload bytes are copied contiguously into the provided
+    buffer, frame first. Records larger than the buffer capacity are skipped.
+
+    \return True, if a record was read into the buffer; false at the end of the journal.
+    */
+    inline bool ReadNext(RecordHeader &header, void *const buffer, const uint32_t capacity);
+
+    /**
+    Returns the current wall-clock time in microseconds since the Unix epoch.
+    */
+    inline static uint64_t GetTimestampMicroseconds();
+
+private:
+
+    /**
+    Header at the start of the journal file, preceding the ring.
+    */
+    struct FileHeader
+    {
+        uint32_t mMagic;            ///< Identifies the file as a message journal.
+        uint32_t mRingSize;         ///< Size in bytes of the ring following the header.
+        uint64_t mWriteOffset;      ///< Monotonic byte offset one past the newest complete record.
+        uint64_t mOldestOffset;     ///< Monotonic byte offset of the oldest intact record.
+    };
+
+    static const uint32_t MAGIC = 0x4E524A54;   ///< 'TJRN', little-endian.
+
+    MessageJournal(const MessageJournal &other);
+    MessageJournal &operator=(const MessageJournal &other);
+
+    /**
+    Maps the file of the given total size, creating it if writable.
+    */
+    inline bool Map(const char *const path, const uint64_t fileSize, const bool writable);
+
+    /**
+    Copies bytes into the ring at the given monotonic offset, wrapping modularly.
+    */
+    inline void WriteBytes(const uint64_t offset, const void *const data, const uint32_t size);
+
+    /**
+    Copies bytes out of the ring at the given monotonic offset, wrapping modularly.
+    */
+    inline void ReadBytes(const uint64_t offset, void *const data, const uint32_t size) const;
+
+    FileHeader *mHeader;            ///< Pointer to the mapped file header; zero when closed.
+    uint8_t *mRing;                 ///< Pointer to the mapped ring, directly after the header.
+    uint64_t mReadOffset;           ///< Monotonic offset of the read cursor.
+    void *mMap;                     ///< Base address of the file mapping.
+    uint64_t mMapSize;              ///< Total size of the file mapping in bytes.
+
+#if THERON_WINDOWS
+    HANDLE mFile;                   ///< Handle of the open journal file.
+    HANDLE mMapping;                ///< Handle of the file mapping object.
+#elif defined(THERON_POSIX)
+    int mFile;                      ///< Descriptor of the open journal file.
+#endif
+
+};
+
+
+inline MessageJournal::MessageJournal() :
+  mHeader(0),
+  mRing(0),
+  mReadOffset(0),
+  mMap(0),
+#if THERON_WINDOWS
+  mMapSize(0),
+  mFile(INVALID_HANDLE_VALUE),
+  mMapping(0)
+#elif defined(THERON_POSIX)
+  mMapSize(0),
+  mFile(-1)
+#else
+  mMapSize(0)
+#endif
+{
+}
+
+
+inline MessageJournal::~MessageJournal()
+{
+    Close();
+}
+
+
+inline bool MessageJournal::Open(const char *const path, const uint32_t ringSizeBytes)
+{
+    THERON_ASSERT(path);
+    THERON_ASSERT(ringSizeBytes > sizeof(RecordHeader));
+    THERON_ASSERT(mHeader == 0);
+
+    if (!Map(path, sizeof(FileHeader) + ringSizeBytes, true))
+    {
+        return false;
+    }
+
+    // Initialize the file header of the freshly truncated file.
+    mHeader->mMagic = MAGIC;
+    mHeader->mRingSize = ringSizeBytes;
+    mHeader->mWriteOffset = 0;
+    mHeader->mOldestOffset = 0;
+
+    return true;
+}
+
+
+inline bool MessageJournal::OpenForReading(const char *const path)
+{
+    THERON_ASSERT(path);
+    THERON_ASSERT(mHeader == 0);
+
+    if (!Map(path, 0, false))
+    {
+        return false;
+    }
+
+    // Reject files that aren't journals or have been truncated.
+    if (mMapSize < sizeof(FileHeader) ||
+        mHeader->mMagic != MAGIC ||
+        mMapSize < sizeof(FileHeader) + mHeader->mRingSize)
+    {
+        Close();
+        return false;
+    }
+
+    Rewind();
+    return true;
+}
+
+
+inline void MessageJournal::Append(
+    const void *const frame,
+    const uint32_t frameSize,
+    const void *const payload,
+    const uint32_t payloadSize)
+{
+    THERON_ASSERT(mHeader);
+    THERON_ASSERT(frame);
+
+    const uint32_t ringSize(mHeader->mRingSize);
+    const uint64_t recordSize(sizeof(RecordHeader) + frameSize + payloadSize);
+
+    // Drop records too large to ever fit in the ring.
+    if (recordSize > ringSize)
+    {
+        return;
+    }
+
+    // Advance the oldest offset past any records the new one will overwrite,
+    // before their bytes become garbage, so readers never see a torn record.
+    uint64_t writeOffset(mHeader->mWriteOffset);
+    while (writeOffset + recordSize - mHeader->mOldestOffset > ringSize)
+    {
+        RecordHeader oldest;
+        ReadBytes(mHeader->mOldestOffset, &oldest, sizeof(oldest));
+        mHeader->mOldestOffset += sizeof(RecordHeader) + oldest.mFrameSize + oldest.mPayloadSize;
+    }
+
+    RecordHeader header;
+    header.mTimestamp = GetTimestampMicroseconds();
+    header.mFrameSize = frameSize;
+    header.mPayloadSize = payloadSize;
+
+    WriteBytes(writeOffset, &header, sizeof(header));
+    writeOffset += sizeof(header);
+
+    WriteBytes(writeOffset, frame, frameSize);
+    writeOffset += frameSize;
+
+    if (payloadSize)
+    {
+        WriteBytes(writeOffset, payload, payloadSize);
+        writeOffset += payloadSize;
+    }
+
+    // Publish the record by advancing the write offset past it.
+    mHeader->mWriteOffset = writeOffset;
+}
+
+
+inline void MessageJournal::Rewind()
+{
+    THERON_ASSERT(mHeader);
+    mReadOffset = mHeader->mOldestOffset;
+}
+
+
+inline bool MessageJournal::ReadNext(RecordHeader &header, void *const buffer, const uint32_t capacity)
+{
+    THERON_ASSERT(mHeader);
+    THERON_ASSERT(buffer);
+
+    while (mReadOffset < mHeader->mWriteOffset)
+    {
+        ReadBytes(mReadOffset, &header, sizeof(header));
+
+        const uint32_t dataSize(header.mFrameSize + header.mPayloadSize);
+        const uint64_t recordSize(sizeof(RecordHeader) + dataSize);
+
+        // Reject corrupt records rather than reading past the ring.
+        if (recordSize > mHeader->mRingSize)
+        {
+            return false;
+        }
+
+        mReadOffset += recordSize;
+
+        // Skip records larger than the caller's buffer.
+        if (dataSize <= capacity)
+        {
+            ReadBytes(mReadOffset - dataSize, buffer, dataSize);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE uint64_t MessageJournal::GetTimestampMicroseconds()
+{
+#if THERON_WINDOWS
+
+    // FILETIME is in 100-nanosecond intervals since January 1, 1601.
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+
+    ULARGE_INTEGER ticks;
+    ticks.LowPart = fileTime.dwLowDateTime;
+    ticks.HighPart = fileTime.dwHighDateTime;
+
+    return (ticks.QuadPart - 116444736000000000ULL) / 10ULL;
+
+#elif defined(THERON_POSIX)
+
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return static_cast<uint64_t>(tv.tv_sec) * 1000000ULL + static_cast<uint64_t>(tv.tv_usec);
+
+#else
+
+    return 0;
+
+#endif
+}
+
+
+inline bool MessageJournal::Map(const char *const path, const uint64_t fileSize, const bool writable)
+{
+#if THERON_WINDOWS
+
+    mFile = CreateFileA(
+        path,
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ,
+        0,
+        writable ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        0);
+
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    uint64_t mapSize(fileSize);
+    if (!writable)
+    {
+        LARGE_INTEGER existingSize;
+        if (!GetFileSizeEx(mFile, &existingSize))
+        {
+            Close();
+            return false;
+        }
+
+        mapSize = static_cast<uint64_t>(existingSize.QuadPart);
+    }
+
+    mMapping = CreateFileMappingA(
+        mFile,
+        0,
+        writable ? PAGE_READWRITE : PAGE_READONLY,
+        static_cast<DWORD>(mapSize >> 32),
+        static_cast<DWORD>(mapSize & 0xFFFFFFFFULL),
+        0);
+
+    if (mMapping == 0)
+    {
+        Close();
+        return false;
+    }
+
+    mMap = MapViewOfFile(
+        mMapping,
+        writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+        0,
+        0,
+        0);
+
+    if (mMap == 0)
+    {
+        Close();
+        return false;
+    }
+
+    mMapSize = mapSize;
+
+#elif defined(THERON_POSIX)
+
+    mFile = open(
+        path,
+        writable ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY,
+        0644);
+
+    if (mFile < 0)
+    {
+        return false;
+    }
+
+    uint64_t mapSize(fileSize);
+    if (writable)
+    {
+        if (ftruncate(mFile, static_cast<off_t>(fileSize)) != 0)
+        {
+            Close();
+            return false;
+        }
+    }
+    else
+    {
+        struct stat fileStat;
+        if (fstat(mFile, &fileStat) != 0)
+        {
+            Close();
+            return false;
+        }
+
+        mapSize = static_cast<uint64_t>(fileStat.st_size);
+    }
+
+    void *const map = mmap(
+        0,
+        static_cast<size_t>(mapSize),
+        writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+        MAP_SHARED,
+        mFile,
+        0);
+
+    if (map == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    mMap = map;
+    mMapSize = mapSize;
+
+#else
+
+    // Memory-mapped files aren't supported on this platform; the journal stays closed.
+    (void) path;
+    (void) fileSize;
+    (void) writable;
+    return false;
+
+#endif
+
+    mHeader = reinterpret_cast<FileHeader *>(mMap);
+    mRing = reinterpret_cast<uint8_t *>(mMap) + sizeof(FileHeader);
+    mReadOffset = 0;
+
+    return true;
+}
+
+
+inline void MessageJournal::Close()
+{
+#if THERON_WINDOWS
+
+    if (mMap)
+    {
+        UnmapViewOfFile(mMap);
+        mMap = 0;
+    }
+
+    if (mMapping)
+    {
+        CloseHandle(mMapping);
+        mMapping = 0;
+    }
+
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+
+#elif defined(THERON_POSIX)
+
+    if (mMap)
+    {
+        munmap(mMap, static_cast<size_t>(mMapSize));
+        mMap = 0;
+    }
+
+    if (mFile >= 0)
+    {
+        close(mFile);
+        mFile = -1;
+    }
+
+#endif
+
+    mHeader = 0;
+    mRing = 0;
+    mMapSize = 0;
+    mReadOffset = 0;
+}
+
+
+THERON_FORCEINLINE void MessageJournal::WriteBytes(const uint64_t offset, const void *const data, const uint32_t size)
+{
+    const uint32_t ringSize(mHeader->mRingSize);
+    const uint32_t start(static_cast<uint32_t>(offset % ringSize));
+    const uint32_t contiguous(ringSize - start);
+
+    if (size <= contiguous)
+    {
+        memcpy(mRing + start, data, size);
+    }
+    else
+    {
+        // The record wraps the ring boundary; split the copy.
+        memcpy(mRing + start, data, contiguous);
+        memcpy(mRing, reinterpret_cast<const uint8_t *>(data) + contiguous, size - contiguous);
+    }
+}
+
+
+THERON_FORCEINLINE void MessageJournal::ReadBytes(const uint64_t offset, void *const data, const uint32_t size) const
+{
+    const uint32_t ringSize(mHeader->mRingSize);
+    const uint32_t start(static_cast<uint32_t>(offset % ringSize));
+    const uint32_t contiguous(ringSize - start);
+
+    if (size <= contiguous)
+    {
+        memcpy(data, mRing + start, size);
+    }
+    else
+    {
+        // The record wraps the ring boundary; split the copy.
+        memcpy(data, mRing + start, contiguous);
+        memcpy(reinterpret_cast<uint8_t *>(data) + contiguous, mRing, size - contiguous);
+    }
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_NETWORK_MESSAGEJOURNAL_H
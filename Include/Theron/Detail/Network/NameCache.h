@@ -0,0 +1,113 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_NAMECACHE_H
+#define THERON_DETAIL_NETWORK_NAMECACHE_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Network/String.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A small direct-mapped cache of resolved name-to-index lookups.
+
+Sends addressed only by name resolve the name through the endpoint's
+\ref NameMap on every message, even though stable destinations resolve to the
+same record every time. Each processor context owns one of these caches, so
+steady-state sends to stable names are satisfied with a hash and a pointer
+compare, skipping the map walk entirely. Entries are validated against the
+map's version, which changes whenever any name is registered or deregistered,
+so a cached record can never outlive a disconnect or re-registration.
+
+\note Accessed only by the thread that owns the enclosing context, so the
+cache needs no synchronization. Since names intern to shared string bodies,
+cache hits and stores allocate no memory.
+*/
+class NameCache
+{
+public:
+
+    /**
+    Number of cached entries; names hashing to the same slot evict one another.
+    */
+    static const uint32_t SIZE = 16;
+
+    /**
+    Default constructor.
+    */
+    inline NameCache() : mEntries()
+    {
+    }
+
+    /**
+    Tries to resolve the given name from the cache.
+    \param name The name to be resolved.
+    \param version The current version of the name map being shadowed.
+    \param index Receives the cached index on a hit.
+    \return True, if the cache held a current record for the name.
+    */
+    THERON_FORCEINLINE bool Get(const String &name, const uint32_t version, Index &index) const
+    {
+        const Entry &entry(mEntries[name.GetHash() & (SIZE - 1)]);
+
+        // Interned strings compare by pointer, so a hit costs no character compares.
+        if (entry.mVersion == version && entry.mName == name)
+        {
+            index = entry.mIndex;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+    Caches a resolved record for the given name.
+    \param name The resolved name.
+    \param version The version of the name map when the record was resolved.
+    \param index The index the name resolved to.
+    */
+    THERON_FORCEINLINE void Store(const String &name, const uint32_t version, const Index &index)
+    {
+        Entry &entry(mEntries[name.GetHash() & (SIZE - 1)]);
+
+        entry.mName = name;
+        entry.mVersion = version;
+        entry.mIndex = index;
+    }
+
+private:
+
+    /**
+    A cached resolution of one name.
+    */
+    struct Entry
+    {
+        THERON_FORCEINLINE Entry() : mName(), mVersion(0), mIndex()
+        {
+        }
+
+        String mName;           ///< The resolved name; holds a reference to the interned body.
+        uint32_t mVersion;      ///< Version of the name map when the record was resolved.
+        Index mIndex;           ///< The index the name resolved to.
+    };
+
+    NameCache(const NameCache &other);
+    NameCache &operator=(const NameCache &other);
+
+    Entry mEntries[SIZE];       ///< Direct-mapped cache slots.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_NETWORK_NAMECACHE_H
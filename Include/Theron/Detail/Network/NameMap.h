@@ -1,205 +1,304 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_NETWORK_NAMEMAP_H
-#define THERON_DETAIL_NETWORK_NAMEMAP_H
-
-
-#include <new>
-
-#include <string.h>
-#include <stdlib.h>
-
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Containers/Map.h>
-#include <Theron/Detail/Network/Hash.h>
-#include <Theron/Detail/Network/Index.h>
-#include <Theron/Detail/Network/String.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-Associates string names to mailbox indices.
-*/
-class NameMap
-{
-public:
-
-    /**
-    Constructor.
-    */
-    inline NameMap();
-
-    /**
-    Destructor.
-    */
-    inline ~NameMap();
-
-    /**
-    Inserts a (name, index) pair into the map.
-    \note The name is assumed to not already exist in the map. At most one pair with the given name can be inserted.
-    \return True, unless an error was encountered.
-    */
-    inline bool Insert(const String &name, const Index &index);
-
-    /**
-    Removes a previously inserted (name, index) pair with the given name from the map.
-    \note At most one pair with the given name can exist in the map. Removes of non-existent pairs are ignored.
-    \return True, unless an error was encountered.
-    */
-    inline bool Remove(const String &name);
-
-    /**
-    Returns true if the map contains a (name, index) pair with the given name.
-    */
-    inline bool Contains(const String &name);
-
-    /**
-    Returns the index associated with the given name by a (name, index) pair in the map.
-    \note If the map contains no (name, index) pair with the given name then the return value is false.
-    */
-    inline bool Get(const String &name, Index &index) const;
-
-private:
-
-    typedef Map<String, Index, Hash> NameIndexMap;
-
-    NameMap(const NameMap &other);
-    NameMap &operator=(const NameMap &other);
-
-    mutable SpinLock mSpinLock;         ///< Thread-safe access.
-    NameIndexMap mMap;                  ///< Multimap of names to indices.
-};
-
-
-inline NameMap::NameMap() : mSpinLock(), mMap()
-{
-}
-
-
-inline NameMap::~NameMap()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    // Clear the map on destruction.
-    while (NameIndexMap::Node *const node = mMap.Front())
-    {
-        mMap.Remove(node);
-
-        node->~Node();
-        allocator->Free(node, sizeof(NameIndexMap::Node));
-    }
-}
-
-
-inline bool NameMap::Insert(const String &name, const Index &index)
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-    NameIndexMap::Node *node(0);
-
-    // Allocate and construct the node speculatively outside the spinlock.
-    void *const nodeMemory(allocator->Allocate(sizeof(NameIndexMap::Node)));
-    if (nodeMemory == 0)
-    {
-        return false;
-    }
-
-    node = new (nodeMemory) NameIndexMap::Node(name, index);
-
-    mSpinLock.Lock();
-
-    // Check for existing pairs with the same key. At most one is allowed.
-    THERON_ASSERT(!mMap.Contains(name));
-    if (mMap.Insert(node))
-    {
-        node = 0;
-    }
-
-    mSpinLock.Unlock();
-
-    // Destroy the node if the insert failed.
-    if (node)
-    {
-        node->~Node();
-        allocator->Free(node, sizeof(NameIndexMap::Node));
-
-        return false;
-    }
-
-    return true;
-}
-
-
-inline bool NameMap::Remove(const String &name)
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-    mSpinLock.Lock();
-
-    NameIndexMap::KeyNodeIterator nodes(mMap.GetKeyNodeIterator(name));
-    while (nodes.Next())
-    {
-        NameIndexMap::Node *const node(nodes.Get());
-
-        if (mMap.Remove(node))
-        {
-            mSpinLock.Unlock();
-
-            node->~Node();
-            allocator->Free(node, sizeof(NameIndexMap::Node));
-
-            mSpinLock.Lock();
-        }
-
-        // Restart the iterator since the deletion may have messed it up.
-        nodes = mMap.GetKeyNodeIterator(name);
-    }
-
-    mSpinLock.Unlock();
-    return true;
-}
-
-
-inline bool NameMap::Contains(const String &name)
-{
-    bool result(false);
-    mSpinLock.Lock();
-
-    result = mMap.GetKeyNodeIterator(name).Next();
-
-    mSpinLock.Unlock();
-    return result;
-}
-
-
-inline bool NameMap::Get(const String &name, Index &index) const
-{
-    bool result(false);
-    mSpinLock.Lock();
-
-    NameIndexMap::KeyNodeIterator nodes(mMap.GetKeyNodeIterator(name));
-    if (nodes.Next())
-    {
-        const NameIndexMap::Node *const node(nodes.Get());
-        index = node->mValue;
-        result = true;
-    }
-
-    mSpinLock.Unlock();
-    return result;
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_NETWORK_NAMEMAP_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_NAMEMAP_H
+#define THERON_DETAIL_NETWORK_NAMEMAP_H
+
+
+#include <new>
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Network/Hash.h>
+#include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Associates string names to mailbox indices.
+
+The map is a hash table of \ref Hash::RANGE bucket chains whose heads and links
+are atomically published pointers, so lookups are lock-free and scale with the
+number of reading threads. Writers are serialized by a set of spinlocks, each
+guarding a shard of the buckets, so registrations of unrelated names rarely
+contend either.
+
+Nodes removed from the map are retired to a free list and only reclaimed when
+the map is destroyed, since lock-free readers may still be traversing them.
+Names are registered and deregistered rarely relative to the rate at which
+they're resolved, so the retained memory is insignificant.
+*/
+class NameMap
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline NameMap();
+
+    /**
+    Destructor.
+    */
+    inline ~NameMap();
+
+    /**
+    Inserts a (name, index) pair into the map.
+    \note The name is assumed to not already exist in the map. At most one pair with the given name can be inserted.
+    \return True, unless an error was encountered.
+    */
+    inline bool Insert(const String &name, const Index &index);
+
+    /**
+    Removes a previously inserted (name, index) pair with the given name from the map.
+    \note At most one pair with the given name can exist in the map. Removes of non-existent pairs are ignored.
+    \return True, unless an error was encountered.
+    */
+    inline bool Remove(const String &name);
+
+    /**
+    Returns true if the map contains a (name, index) pair with the given name.
+    */
+    inline bool Contains(const String &name);
+
+    /**
+    Returns the index associated with the given name by a (name, index) pair in the map.
+    \note If the map contains no (name, index) pair with the given name then the return value is false.
+    \note Lock-free; a lookup racing a removal of the same name may legitimately see either outcome.
+    */
+    inline bool Get(const String &name, Index &index) const;
+
+    /**
+    Returns the version of the map, which changes whenever a pair is inserted or removed.
+    \note Allows callers to cache resolved lookups and cheaply detect staleness.
+    */
+    THERON_FORCEINLINE uint32_t GetVersion() const
+    {
+        return mVersion.Load();
+    }
+
+private:
+
+    /**
+    An entry in a bucket chain, mapping a name to an index.
+    */
+    struct Node
+    {
+        THERON_FORCEINLINE Node(const String &name, const Index &index) :
+          mName(name),
+          mIndex(index),
+          mNext(0),
+          mNextRetired(0)
+        {
+        }
+
+        String mName;               ///< Name of the entry.
+        Index mIndex;               ///< Index associated with the name.
+        Atomic::Pointer mNext;      ///< Atomically published pointer to the next node in the bucket chain.
+        Node *mNextRetired;         ///< Next node in the retired node list, once this node has been removed.
+    };
+
+    /**
+    Number of writer locks, each guarding a shard of the buckets.
+    \note Must be a power of two no greater than Hash::RANGE.
+    */
+    static const uint32_t NUM_SHARDS = 16;
+
+    NameMap(const NameMap &other);
+    NameMap &operator=(const NameMap &other);
+
+    /**
+    Maps a bucket hash to the shard lock that guards writes to the bucket.
+    */
+    THERON_FORCEINLINE static uint32_t ShardForHash(const uint32_t hash)
+    {
+        return (hash & (NUM_SHARDS - 1));
+    }
+
+    /**
+    Searches the given bucket chain for a node with the given name.
+    */
+    THERON_FORCEINLINE Node *FindInBucket(const uint32_t hash, const String &name) const
+    {
+        Node *node(reinterpret_cast<Node *>(mBuckets[hash].Load()));
+        while (node)
+        {
+            if (node->mName == name)
+            {
+                return node;
+            }
+
+            node = reinterpret_cast<Node *>(node->mNext.Load());
+        }
+
+        return 0;
+    }
+
+    Atomic::Pointer mBuckets[Hash::RANGE];      ///< Atomically published heads of the bucket chains.
+    mutable SpinLock mShardLocks[NUM_SHARDS];   ///< Serialize writers within each shard of buckets.
+    SpinLock mRetiredLock;                      ///< Protects the list of retired nodes.
+    Node *mRetiredNodes;                        ///< Removed nodes awaiting reclamation on destruction.
+    Atomic::UInt32 mVersion;                    ///< Incremented on every insert or remove, invalidating cached lookups.
+};
+
+
+inline NameMap::NameMap() :
+  mRetiredNodes(0),
+  mVersion(0)
+{
+}
+
+
+inline NameMap::~NameMap()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Free the live nodes remaining in the bucket chains.
+    for (uint32_t hash = 0; hash < Hash::RANGE; ++hash)
+    {
+        Node *node(reinterpret_cast<Node *>(mBuckets[hash].Load()));
+        while (node)
+        {
+            Node *const next(reinterpret_cast<Node *>(node->mNext.Load()));
+
+            node->~Node();
+            allocator->Free(node, sizeof(Node));
+
+            node = next;
+        }
+    }
+
+    // Free the retired nodes. Their chain pointers were left intact on removal and
+    // may dangle once the live nodes are freed, so we follow the retired links instead.
+    Node *retired(mRetiredNodes);
+    while (retired)
+    {
+        Node *const next(retired->mNextRetired);
+
+        retired->~Node();
+        allocator->Free(retired, sizeof(Node));
+
+        retired = next;
+    }
+}
+
+
+inline bool NameMap::Insert(const String &name, const Index &index)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    const uint32_t hash(Hash::Compute(name));
+
+    // Allocate and construct the node speculatively outside the spinlock.
+    void *const nodeMemory(allocator->Allocate(sizeof(Node)));
+    if (nodeMemory == 0)
+    {
+        return false;
+    }
+
+    Node *const node(new (nodeMemory) Node(name, index));
+
+    SpinLock &shardLock(mShardLocks[ShardForHash(hash)]);
+    shardLock.Lock();
+
+    // Check for existing pairs with the same key. At most one is allowed.
+    THERON_ASSERT(FindInBucket(hash, name) == 0);
+
+    // Fill in the node's chain pointer before atomically publishing it as the new
+    // head, so that lock-free readers only ever see fully constructed nodes.
+    node->mNext.Store(mBuckets[hash].Load());
+    mBuckets[hash].Store(node);
+
+    // Bump the version before unlocking, so cached lookups are invalidated.
+    mVersion.Increment();
+
+    shardLock.Unlock();
+
+    return true;
+}
+
+
+inline bool NameMap::Remove(const String &name)
+{
+    const uint32_t hash(Hash::Compute(name));
+
+    SpinLock &shardLock(mShardLocks[ShardForHash(hash)]);
+    shardLock.Lock();
+
+    // Find the node in the bucket chain, remembering the link that points at it.
+    Atomic::Pointer *link(&mBuckets[hash]);
+    Node *node(reinterpret_cast<Node *>(link->Load()));
+
+    while (node && !(node->mName == name))
+    {
+        link = &node->mNext;
+        node = reinterpret_cast<Node *>(link->Load());
+    }
+
+    if (node)
+    {
+        // Atomically unlink the node from the chain. The node's own chain pointer
+        // is deliberately left intact so that a lock-free reader paused on the node
+        // can still follow it to the remainder of the chain.
+        link->Store(node->mNext.Load());
+
+        // Bump the version before unlocking, so cached lookups are invalidated.
+        mVersion.Increment();
+    }
+
+    shardLock.Unlock();
+
+    if (node)
+    {
+        // Retire the node rather than freeing it, since readers may still hold it.
+        mRetiredLock.Lock();
+        node->mNextRetired = mRetiredNodes;
+        mRetiredNodes = node;
+        mRetiredLock.Unlock();
+    }
+
+    return true;
+}
+
+
+inline bool NameMap::Contains(const String &name)
+{
+    Index index;
+    return Get(name, index);
+}
+
+
+inline bool NameMap::Get(const String &name, Index &index) const
+{
+    // Lock-free: the bucket chain heads and links are atomically published, and
+    // removed nodes remain valid (and correctly linked) until the map is destroyed.
+    const uint32_t hash(Hash::Compute(name));
+
+    const Node *const node(FindInBucket(hash, name));
+    if (node)
+    {
+        index = node->mIndex;
+        return true;
+    }
+
+    return false;
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_NETWORK_NAMEMAP_H
@@ -0,0 +1,90 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_PROCESSNAMEREGISTRY_H
+#define THERON_DETAIL_NETWORK_PROCESSNAMEREGISTRY_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Network/NameMap.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Process-wide registry of the names published by all endpoints in the process.
+
+Each \ref EndPoint mirrors the names it publishes into this shared map, so a
+sender resolving a name registered through a different endpoint of the same
+process can discover the local mailbox index and deliver to it directly,
+instead of marshaling the message through the network transport's loopback.
+
+The registry is a reference-counted singleton in the style of
+\ref StaticDirectory: each endpoint holds a reference for its lifetime, and
+the underlying \ref NameMap is created when the first endpoint is constructed
+and destroyed when the last is destructed. Lookups are lock-free, inherited
+from the map.
+*/
+class ProcessNameRegistry
+{
+public:
+
+    /**
+    Takes a reference to the registry, creating it if no references exist.
+    \return True, unless the registry couldn't be allocated.
+    */
+    static bool Reference();
+
+    /**
+    Releases a reference to the registry, destroying it if this was the last.
+    */
+    static void Release();
+
+    /**
+    Inserts a (name, index) pair into the registry.
+    \note Call only while holding a reference.
+    \return True, unless an error was encountered.
+    */
+    static bool Insert(const String &name, const Index &index);
+
+    /**
+    Removes a previously inserted pair with the given name from the registry.
+    \note Call only while holding a reference. Removes of non-existent pairs are ignored.
+    \return True, unless an error was encountered.
+    */
+    static bool Remove(const String &name);
+
+    /**
+    Looks up the index registered for the given name by any endpoint in the process.
+    \return True, if the name was found; false otherwise, including when no registry exists.
+    */
+    static bool Get(const String &name, Index &index);
+
+    /**
+    Returns the version of the registry, which changes whenever a pair is
+    inserted or removed, allowing callers to cheaply invalidate cached lookups.
+    \note Zero when no registry exists.
+    */
+    static uint32_t GetVersion();
+
+private:
+
+    static Atomic::Pointer smNameMap;           ///< Atomically published pointer to the allocated map.
+    static SpinLock smSpinLock;                 ///< SpinLock serializing creation and destruction of the map.
+    static Atomic::UInt32 smReferenceCount;     ///< Counts the number of endpoints referencing the registry.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_NETWORK_PROCESSNAMEREGISTRY_H
@@ -0,0 +1,271 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_NETWORK_STRINGPOOL_H
+#define THERON_DETAIL_NETWORK_STRINGPOOL_H
+
+
+#include <string.h>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4996)  // function or variable may be unsafe.
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Global lock-sharded intern pool for string values.
+
+Each distinct string value is stored once, in a reference-counted pool entry,
+and all \ref String instances with that value share the entry. Interning costs
+a hash and a walk of a bucket chain under a sharded lock, but in return
+equality comparison of interned strings is a pointer compare, and the hash of
+the value is computed once and stored, so repeated hashing of the same name
+during lookups is free. Entries are removed from the pool when the last
+reference to them is released.
+*/
+class StringPool
+{
+public:
+
+    /**
+    A reference-counted pool entry holding a single distinct string value.
+    */
+    class Entry
+    {
+    public:
+
+        friend class StringPool;
+
+        THERON_FORCEINLINE explicit Entry(const char *const str) :
+          mRefCount(0),
+          mHash(0),
+          mValue(0),
+          mNext(0)
+        {
+            if (strlen(str) + 1 <= DATA_SIZE)
+            {
+                strcpy(mData, str);
+                mValue = mData;
+            }
+            else
+            {
+                mValue = CopyString(str);
+            }
+        }
+
+        THERON_FORCEINLINE ~Entry()
+        {
+            if (mValue != mData)
+            {
+                DestroyString(mValue);
+            }
+        }
+
+        THERON_FORCEINLINE const char *GetValue() const
+        {
+            return mValue;
+        }
+
+        /**
+        Gets the hash of the string value, computed once when the value was interned.
+        */
+        THERON_FORCEINLINE uint32_t GetHash() const
+        {
+            return mHash;
+        }
+
+        THERON_FORCEINLINE void Reference() const
+        {
+            mRefCount.Increment();
+        }
+
+        THERON_FORCEINLINE bool Dereference() const
+        {
+            uint32_t currentValue(mRefCount.Load());
+            uint32_t newValue(currentValue - 1);
+            uint32_t backoff(0);
+
+            THERON_ASSERT(currentValue > 0);
+
+            // Repeatedly try to atomically decrement the reference count.
+            // We do this by hand so we can atomically find out the new value.
+            while (!mRefCount.CompareExchangeAcquire(currentValue, newValue))
+            {
+                currentValue = mRefCount.Load();
+                newValue = currentValue - 1;
+                Detail::Utils::Backoff(backoff);
+            }
+
+            // Return true if the new reference count is zero.
+            return (newValue == 0);
+        }
+
+    private:
+
+        Entry(const Entry &other);
+        Entry &operator=(const Entry &other);
+
+        static const uint32_t DATA_SIZE = 40;
+
+        //
+        // The total size of this member data should fit in a cache line.
+        // We've assumed here that a cache line is 64 bytes and a pointer is 8 bytes.
+        //
+
+        mutable Atomic::UInt32 mRefCount;   ///< Counts the number of String objects referencing this entry.
+        uint32_t mHash;                     ///< Hash of the string value, computed on interning.
+        char *mValue;                       ///< Pointer to a buffer containing the value of the string.
+        Entry *mNext;                       ///< Next entry in the bucket chain of the pool.
+        char mData[DATA_SIZE];              ///< Local data buffer used to hold small string values.
+    };
+
+    /**
+    Interns the given string value, returning a referenced pool entry for it.
+    All interned strings with equal values share the same entry.
+    */
+    static Entry *Intern(const char *const str);
+
+    /**
+    Releases a reference to a pool entry previously returned by \ref Intern,
+    removing the entry from the pool and destroying it if it becomes unreferenced.
+    */
+    static void Release(Entry *const entry);
+
+    /**
+    Computes the hash a string value is interned with, without interning it.
+    Exposed so wire formats can identify a name by its hash without paying
+    for a pool entry per message.
+    */
+    THERON_FORCEINLINE static uint32_t ComputeHash(const char *const str)
+    {
+        THERON_ASSERT(str);
+
+        // Word-at-a-time multiply-xor hash in the style of xxHash/wyhash.
+        // Generated names tend to share long common prefixes, which a
+        // byte-at-a-time rolling hash both processes slowly and clusters;
+        // mixing eight bytes per step with a 64-bit multiply avalanches
+        // prefix differences across the whole word.
+        const uint64_t multiplier(0xC2B2AE3D27D4EB4FULL);
+
+        const uint32_t length(static_cast<uint32_t>(strlen(str)));
+        const uint8_t *data(reinterpret_cast<const uint8_t *>(str));
+        uint32_t remaining(length);
+
+        // Seed with the length so strings that are prefixes of each other differ.
+        uint64_t hash(0x9E3779B97F4A7C15ULL ^ (static_cast<uint64_t>(length) * multiplier));
+
+        // Unaligned loads are done with memcpy, which compilers turn into
+        // plain word loads on architectures that allow them.
+        while (remaining >= 8)
+        {
+            uint64_t word(0);
+            memcpy(&word, data, 8);
+
+            hash = (hash ^ word) * multiplier;
+            hash ^= (hash >> 29);
+
+            data += 8;
+            remaining -= 8;
+        }
+
+        if (remaining)
+        {
+            uint64_t word(0);
+            memcpy(&word, data, remaining);
+
+            hash = (hash ^ word) * multiplier;
+            hash ^= (hash >> 29);
+        }
+
+        // Final avalanche, then fold to the stored 32-bit hash.
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= (hash >> 32);
+
+        return static_cast<uint32_t>(hash);
+    }
+
+#if THERON_ENABLE_HASH_STATS
+    /**
+    Gets the number of distinct string values interned into the given bucket.
+
+    Entry removals aren't subtracted, so the counts describe the distribution
+    of every value interned over the lifetime of the process. Since name
+    lookups fold the same stored hash into the same number of buckets, the
+    spread over the intern buckets is also the spread over lookup buckets.
+
+    \note Valid bucket indices run from 0 to 255.
+    */
+    static uint32_t GetBucketCount(const uint32_t bucket);
+#endif // THERON_ENABLE_HASH_STATS
+
+private:
+
+    static const uint32_t BUCKET_COUNT = 256;   ///< Number of bucket chains in the pool (power of two!).
+    static const uint32_t LOCK_SHARDS = 16;     ///< Number of sharded bucket locks (power of two!).
+
+    StringPool(const StringPool &other);
+    StringPool &operator=(const StringPool &other);
+
+    THERON_FORCEINLINE static char *CopyString(const char *const str)
+    {
+        THERON_ASSERT(str);
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        const uint32_t stringSize(static_cast<uint32_t>(strlen(str)) + 1);
+        const uint32_t roundedStringSize(THERON_ROUNDUP(stringSize, 4));
+        void *const stringMemory(allocator->Allocate(roundedStringSize));
+        char *const newStr(reinterpret_cast<char *>(stringMemory));
+
+        if (newStr)
+        {
+            newStr[0] = '\0';
+            strcpy(newStr, str);
+        }
+
+        return newStr;
+    }
+
+    THERON_FORCEINLINE static void DestroyString(char *const str)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        THERON_ASSERT(str);
+        allocator->Free(str);
+    }
+
+    static SpinLock smShardLocks[LOCK_SHARDS];  ///< Sharded locks protecting the bucket chains.
+    static Entry *smBuckets[BUCKET_COUNT];      ///< Heads of the bucket chains of the pool.
+
+#if THERON_ENABLE_HASH_STATS
+    static Atomic::UInt32 smBucketCounts[BUCKET_COUNT];     ///< Counts of distinct values interned per bucket.
+#endif // THERON_ENABLE_HASH_STATS
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_DETAIL_NETWORK_STRINGPOOL_H
@@ -0,0 +1,116 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_PROFILING_PROFILECLOCK_H
+#define THERON_DETAIL_PROFILING_PROFILECLOCK_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#if THERON_WINDOWS
+
+#include <windows.h>
+
+#elif THERON_CPP11
+
+#include <chrono>
+
+#elif defined(THERON_POSIX)
+
+#include <time.h>
+
+#else
+
+#include <ctime>
+
+#endif
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A cheap monotonic clock used to time message handler execution when profiling.
+
+The tick period is platform-dependent, so tick counts are meaningful only
+relative to other tick counts measured in the same run on the same host.
+*/
+class ProfileClock
+{
+public:
+
+    /**
+    Returns the current value of the clock, in microseconds.
+    \note Only differences between values are meaningful; the epoch is unspecified.
+    */
+    THERON_FORCEINLINE static uint64_t GetMicroseconds()
+    {
+#if THERON_WINDOWS
+
+        LARGE_INTEGER counter;
+        LARGE_INTEGER frequency;
+        QueryPerformanceCounter(&counter);
+        QueryPerformanceFrequency(&frequency);
+        return static_cast<uint64_t>(counter.QuadPart) * 1000000ULL / static_cast<uint64_t>(frequency.QuadPart);
+
+#elif THERON_CPP11
+
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+
+#elif defined(THERON_POSIX)
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + static_cast<uint64_t>(ts.tv_nsec) / 1000ULL;
+
+#else
+
+        return static_cast<uint64_t>(clock()) * 1000000ULL / static_cast<uint64_t>(CLOCKS_PER_SEC);
+
+#endif
+    }
+
+    /**
+    Returns the current value of the clock, in platform-dependent ticks.
+    */
+    THERON_FORCEINLINE static uint64_t GetTicks()
+    {
+#if THERON_WINDOWS
+
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return static_cast<uint64_t>(counter.QuadPart);
+
+#elif THERON_CPP11
+
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+#elif defined(THERON_POSIX)
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+
+#else
+
+        return static_cast<uint64_t>(clock());
+
+#endif
+    }
+
+private:
+
+    ProfileClock();
+    ProfileClock(const ProfileClock &other);
+    ProfileClock &operator=(const ProfileClock &other);
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_PROFILING_PROFILECLOCK_H
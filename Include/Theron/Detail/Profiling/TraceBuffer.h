@@ -0,0 +1,129 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_PROFILING_TRACEBUFFER_H
+#define THERON_DETAIL_PROFILING_TRACEBUFFER_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Profiling/ProfileClock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A fixed-size ring buffer of timestamped scheduling events owned by one thread.
+
+Each worker thread (and the per-framework context, for non-worker sends) owns
+one buffer, so recording an event is a couple of unsynchronized writes with no
+atomic operations or shared cachelines. When the buffer fills it wraps,
+overwriting the oldest events, so a trace always holds the most recent window
+of activity. The buffers are read by \ref Theron::Framework::DumpTrace
+"Framework::DumpTrace" without synchronization, so a dump taken while the
+framework is busy may contain a small number of torn events at the wrap point.
+*/
+class TraceBuffer
+{
+public:
+
+    /**
+    The kinds of scheduling events recorded in a trace.
+    */
+    enum EventType
+    {
+        EVENT_MESSAGE_PUSH = 0,     ///< A message was pushed into a mailbox.
+        EVENT_MAILBOX_SCHEDULE,     ///< A non-empty mailbox was queued for processing.
+        EVENT_HANDLER_BEGIN,        ///< A thread began executing the handlers for a message.
+        EVENT_HANDLER_END,          ///< A thread finished executing the handlers for a message.
+        EVENT_THREAD_SLEEP,         ///< A worker thread found no work and blocked.
+        EVENT_THREAD_WAKE,          ///< A blocked worker thread was woken.
+        MAX_EVENT_TYPES             ///< Number of distinct event types.
+    };
+
+    /**
+    A single recorded event.
+    */
+    struct Event
+    {
+        uint64_t mTimestamp;        ///< Time of the event, in \ref ProfileClock ticks.
+        uint64_t mFlowId;           ///< Causality flow ID of the message involved; zero if untraced or not message-related.
+        uint32_t mType;             ///< The \ref EventType of the event.
+        uint32_t mData;             ///< Event payload; the mailbox index for mailbox-related events.
+    };
+
+    /**
+    Number of events held per buffer; older events are overwritten when it fills.
+    */
+    static const uint32_t CAPACITY = 65536;
+
+    /**
+    Default constructor.
+    */
+    inline TraceBuffer() : mCount(0)
+    {
+    }
+
+    /**
+    Records an event with the current timestamp.
+    \note May only be called by the thread that owns the buffer.
+    */
+    THERON_FORCEINLINE void Record(const EventType type, const uint32_t data, const uint64_t flowId = 0)
+    {
+        Event &event(mEvents[static_cast<uint32_t>(mCount) & (CAPACITY - 1)]);
+
+        event.mTimestamp = ProfileClock::GetTicks();
+        event.mFlowId = flowId;
+        event.mType = static_cast<uint32_t>(type);
+        event.mData = data;
+
+        ++mCount;
+    }
+
+    /**
+    Returns the number of events recorded since construction.
+    \note May exceed \ref CAPACITY, in which case only the latest CAPACITY events are retained.
+    */
+    THERON_FORCEINLINE uint64_t GetCount() const
+    {
+        return mCount;
+    }
+
+    /**
+    Gets a retained event, indexed from the oldest retained event upwards.
+    */
+    THERON_FORCEINLINE const Event &GetEvent(const uint64_t index) const
+    {
+        const uint64_t first(mCount > CAPACITY ? mCount - CAPACITY : 0);
+        THERON_ASSERT(first + index < mCount);
+
+        return mEvents[static_cast<uint32_t>(first + index) & (CAPACITY - 1)];
+    }
+
+    /**
+    Returns the number of events currently retained in the buffer.
+    */
+    THERON_FORCEINLINE uint32_t GetRetainedCount() const
+    {
+        return mCount > CAPACITY ? CAPACITY : static_cast<uint32_t>(mCount);
+    }
+
+private:
+
+    TraceBuffer(const TraceBuffer &other);
+    TraceBuffer &operator=(const TraceBuffer &other);
+
+    uint64_t mCount;                ///< Total number of events recorded; only the latest CAPACITY are retained.
+    Event mEvents[CAPACITY];        ///< Ring buffer of recorded events.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_PROFILING_TRACEBUFFER_H
@@ -7,6 +7,8 @@
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 
+#include <Theron/Detail/Threading/Utils.h>
+
 
 #ifdef _MSC_VER
 #pragma warning(push,0)
@@ -23,7 +25,7 @@
 #elif THERON_CPP11
 
 #if THERON_GCC
-#if __GNUC__ >= 4 && __GNUC_MINOR__ > 4
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ > 4)
 #include <atomic>
 #else
 #include <cstdatomic>
@@ -209,6 +211,92 @@ public:
         pthread_spin_unlock(&mSpinLock);
         return success;
 
+#endif
+    }
+
+    /**
+    Atomic increment, returning the value held before the increment.
+    */
+    THERON_FORCEINLINE uint32_t FetchIncrement()
+    {
+#if THERON_WINDOWS
+
+        return static_cast<uint32_t>(InterlockedIncrement(reinterpret_cast<volatile LONG *>(&mValue))) - 1;
+
+#elif THERON_BOOST
+
+        return mValue.fetch_add(1);
+
+#elif THERON_CPP11
+
+        return mValue.fetch_add(1);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint32_t previousValue(mValue);
+        ++mValue;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomic decrement, returning the value held before the decrement.
+    */
+    THERON_FORCEINLINE uint32_t FetchDecrement()
+    {
+#if THERON_WINDOWS
+
+        return static_cast<uint32_t>(InterlockedDecrement(reinterpret_cast<volatile LONG *>(&mValue))) + 1;
+
+#elif THERON_BOOST
+
+        return mValue.fetch_sub(1);
+
+#elif THERON_CPP11
+
+        return mValue.fetch_sub(1);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint32_t previousValue(mValue);
+        --mValue;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomically adds the given amount to the value, returning the value held before the addition.
+    */
+    THERON_FORCEINLINE uint32_t FetchAdd(const uint32_t amount)
+    {
+#if THERON_WINDOWS
+
+        return static_cast<uint32_t>(InterlockedExchangeAdd(
+            reinterpret_cast<volatile LONG *>(&mValue),
+            static_cast<LONG>(amount)));
+
+#elif THERON_BOOST
+
+        return mValue.fetch_add(amount);
+
+#elif THERON_CPP11
+
+        return mValue.fetch_add(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint32_t previousValue(mValue);
+        mValue += amount;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
 #endif
     }
 
@@ -261,6 +349,58 @@ public:
         --mValue;
         pthread_spin_unlock(&mSpinLock);
 
+#endif
+    }
+
+    /**
+    Atomically adds the given amount to the value.
+    */
+    THERON_FORCEINLINE void Add(const uint32_t amount)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchangeAdd(reinterpret_cast<volatile LONG *>(&mValue), static_cast<LONG>(amount));
+
+#elif THERON_BOOST
+
+        mValue.fetch_add(amount);
+
+#elif THERON_CPP11
+
+        mValue.fetch_add(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue += amount;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically subtracts the given amount from the value.
+    */
+    THERON_FORCEINLINE void Subtract(const uint32_t amount)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchangeAdd(reinterpret_cast<volatile LONG *>(&mValue), -static_cast<LONG>(amount));
+
+#elif THERON_BOOST
+
+        mValue.fetch_sub(amount);
+
+#elif THERON_CPP11
+
+        mValue.fetch_sub(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue -= amount;
+        pthread_spin_unlock(&mSpinLock);
+
 #endif
     }
 
@@ -344,6 +484,706 @@ private:
 };
 
 
+/**
+Atomic 64-bit unsigned integer synchronization primitive.
+
+Intended for counters that accumulate fast enough to wrap a 32-bit value
+during the lifetime of a long-running process, for example byte counters
+maintained by allocators.
+*/
+class UInt64
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline UInt64() : mValue(0)
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_init(&mSpinLock, 0);
+
+#endif
+    }
+
+    /**
+    Explicit constructor that initializes the value.
+    */
+    inline explicit UInt64(const uint64_t initialValue) : mValue(static_cast<int64_t>(initialValue))
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_init(&mSpinLock, 0);
+
+#endif
+    }
+
+    /**
+    Destructor.
+    */
+    inline ~UInt64()
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_destroy(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomic compare-and-exchange with 'acquire' memory ordering semantics.
+    */
+    THERON_FORCEINLINE bool CompareExchangeAcquire(uint64_t &currentValue, const uint64_t newValue)
+    {
+#if THERON_WINDOWS
+
+        const uint64_t expectedValue(currentValue);
+        currentValue = InterlockedCompareExchangeAcquire64(
+            reinterpret_cast<volatile LONGLONG *>(&mValue),
+            static_cast<LONGLONG>(newValue),
+            static_cast<LONGLONG>(currentValue));
+
+        return (currentValue == expectedValue);
+
+#elif THERON_BOOST
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            boost::memory_order_acquire);
+
+#elif THERON_CPP11
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            std::memory_order_acquire);
+
+#elif defined(THERON_POSIX)
+
+        bool success(false);
+        pthread_spin_lock(&mSpinLock);
+
+        const uint64_t actualValue(mValue);
+        if (actualValue == currentValue)
+        {
+            mValue = newValue;
+            success = true;
+        }
+
+        currentValue = actualValue;
+
+        pthread_spin_unlock(&mSpinLock);
+        return success;
+
+#endif
+    }
+
+    /**
+    Atomic compare-and-exchange with 'release' memory ordering semantics.
+    */
+    THERON_FORCEINLINE bool CompareExchangeRelease(uint64_t &currentValue, const uint64_t newValue)
+    {
+#if THERON_WINDOWS
+
+        const uint64_t expectedValue(currentValue);
+        currentValue = InterlockedCompareExchangeRelease64(
+            reinterpret_cast<volatile LONGLONG *>(&mValue),
+            static_cast<LONGLONG>(newValue),
+            static_cast<LONGLONG>(currentValue));
+
+        return (currentValue == expectedValue);
+
+#elif THERON_BOOST
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            boost::memory_order_release);
+
+#elif THERON_CPP11
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            std::memory_order_release);
+
+#elif defined(THERON_POSIX)
+
+        bool success(false);
+        pthread_spin_lock(&mSpinLock);
+
+        const uint64_t actualValue(mValue);
+        if (actualValue == currentValue)
+        {
+            mValue = newValue;
+            success = true;
+        }
+
+        currentValue = actualValue;
+
+        pthread_spin_unlock(&mSpinLock);
+        return success;
+
+#endif
+    }
+
+    /**
+    Atomically adds the given amount to the value, returning the value held before the addition.
+    */
+    THERON_FORCEINLINE uint64_t FetchAdd(const uint64_t amount)
+    {
+#if THERON_WINDOWS
+
+        return static_cast<uint64_t>(InterlockedExchangeAdd64(
+            reinterpret_cast<volatile LONGLONG *>(&mValue),
+            static_cast<LONGLONG>(amount)));
+
+#elif THERON_BOOST
+
+        return mValue.fetch_add(amount);
+
+#elif THERON_CPP11
+
+        return mValue.fetch_add(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint64_t previousValue(mValue);
+        mValue += amount;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomic increment, returning the value held before the increment.
+    */
+    THERON_FORCEINLINE uint64_t FetchIncrement()
+    {
+#if THERON_WINDOWS
+
+        return static_cast<uint64_t>(InterlockedIncrement64(reinterpret_cast<volatile LONGLONG *>(&mValue))) - 1;
+
+#elif THERON_BOOST
+
+        return mValue.fetch_add(1);
+
+#elif THERON_CPP11
+
+        return mValue.fetch_add(1);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint64_t previousValue(mValue);
+        ++mValue;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomic increment.
+    */
+    THERON_FORCEINLINE void Increment()
+    {
+#if THERON_WINDOWS
+
+        InterlockedIncrement64(reinterpret_cast<volatile LONGLONG *>(&mValue));
+
+#elif THERON_BOOST
+
+        ++mValue;
+
+#elif THERON_CPP11
+
+        ++mValue;
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        ++mValue;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomic decrement.
+    */
+    THERON_FORCEINLINE void Decrement()
+    {
+#if THERON_WINDOWS
+
+        InterlockedDecrement64(reinterpret_cast<volatile LONGLONG *>(&mValue));
+
+#elif THERON_BOOST
+
+        --mValue;
+
+#elif THERON_CPP11
+
+        --mValue;
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        --mValue;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically adds the given amount to the value.
+    */
+    THERON_FORCEINLINE void Add(const uint64_t amount)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchangeAdd64(reinterpret_cast<volatile LONGLONG *>(&mValue), static_cast<LONGLONG>(amount));
+
+#elif THERON_BOOST
+
+        mValue.fetch_add(amount);
+
+#elif THERON_CPP11
+
+        mValue.fetch_add(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue += amount;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically subtracts the given amount from the value.
+    */
+    THERON_FORCEINLINE void Subtract(const uint64_t amount)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchangeAdd64(reinterpret_cast<volatile LONGLONG *>(&mValue), -static_cast<LONGLONG>(amount));
+
+#elif THERON_BOOST
+
+        mValue.fetch_sub(amount);
+
+#elif THERON_CPP11
+
+        mValue.fetch_sub(amount);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue -= amount;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically get the current value.
+    */
+    THERON_FORCEINLINE volatile uint64_t Load() const
+    {
+#if THERON_WINDOWS
+
+        // A 64-bit read isn't guaranteed atomic on 32-bit hosts, so read via a no-op exchange-add.
+        return static_cast<uint64_t>(InterlockedExchangeAdd64(
+            reinterpret_cast<volatile LONGLONG *>(const_cast<volatile int64_t *>(&mValue)),
+            0));
+
+#elif THERON_BOOST
+
+        return mValue.load();
+
+#elif THERON_CPP11
+
+        return mValue.load();
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        const uint64_t value(mValue);
+        pthread_spin_unlock(&mSpinLock);
+        return value;
+
+#endif
+    }
+
+    /**
+    Atomically set the current value.
+    */
+    THERON_FORCEINLINE void Store(const uint64_t val)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchange64(
+            reinterpret_cast<volatile LONGLONG *>(&mValue),
+            static_cast<LONGLONG>(val));
+
+#elif THERON_BOOST
+
+        mValue.store(val);
+
+#elif THERON_CPP11
+
+        mValue.store(val);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue = val;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+private:
+
+    UInt64(const UInt64 &other);
+    UInt64 &operator=(const UInt64 &other);
+
+#if THERON_WINDOWS
+
+    volatile int64_t mValue;
+
+#elif THERON_BOOST
+
+    volatile boost::atomic_uint64_t mValue;
+
+#elif THERON_CPP11
+
+    volatile std::atomic_uint_least64_t mValue;
+
+#elif defined(THERON_POSIX)
+
+    // With POSIX threads we emulate atomics using a mutex (ie. slow but works).
+    volatile uint64_t mValue;
+    mutable pthread_spinlock_t mSpinLock;
+
+#endif
+
+};
+
+
+/**
+Atomic pointer synchronization primitive.
+*/
+class Pointer
+{
+public:
+
+    /**
+    Constructor.
+    */
+    inline Pointer() : mValue(0)
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_init(&mSpinLock, 0);
+
+#endif
+    }
+
+    /**
+    Explicit constructor that initializes the value.
+    */
+    inline explicit Pointer(void *const initialValue) : mValue(initialValue)
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_init(&mSpinLock, 0);
+
+#endif
+    }
+
+    /**
+    Destructor.
+    */
+    inline ~Pointer()
+    {
+#if THERON_WINDOWS
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_spin_destroy(&mSpinLock);
+
+#endif
+    }
+
+    /**
+    Atomically exchanges the held pointer for a new value, returning the previous value.
+    */
+    THERON_FORCEINLINE void *Exchange(void *const newValue)
+    {
+#if THERON_WINDOWS
+
+        return InterlockedExchangePointer(&mValue, newValue);
+
+#elif THERON_BOOST
+
+        return mValue.exchange(newValue);
+
+#elif THERON_CPP11
+
+        return mValue.exchange(newValue);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        void *const previousValue(mValue);
+        mValue = newValue;
+        pthread_spin_unlock(&mSpinLock);
+        return previousValue;
+
+#endif
+    }
+
+    /**
+    Atomic compare-and-exchange with 'acquire' memory ordering semantics.
+    */
+    THERON_FORCEINLINE bool CompareExchangeAcquire(void *&currentValue, void *const newValue)
+    {
+#if THERON_WINDOWS
+
+        void *const expectedValue(currentValue);
+        currentValue = InterlockedCompareExchangePointerAcquire(
+            &mValue,
+            newValue,
+            currentValue);
+
+        return (currentValue == expectedValue);
+
+#elif THERON_BOOST
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            boost::memory_order_acquire);
+
+#elif THERON_CPP11
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            std::memory_order_acquire);
+
+#elif defined(THERON_POSIX)
+
+        bool success(false);
+        pthread_spin_lock(&mSpinLock);
+
+        void *const actualValue(mValue);
+        if (actualValue == currentValue)
+        {
+            mValue = newValue;
+            success = true;
+        }
+
+        currentValue = actualValue;
+
+        pthread_spin_unlock(&mSpinLock);
+        return success;
+
+#endif
+    }
+
+    /**
+    Atomic compare-and-exchange with 'release' memory ordering semantics.
+    */
+    THERON_FORCEINLINE bool CompareExchangeRelease(void *&currentValue, void *const newValue)
+    {
+#if THERON_WINDOWS
+
+        void *const expectedValue(currentValue);
+        currentValue = InterlockedCompareExchangePointerRelease(
+            &mValue,
+            newValue,
+            currentValue);
+
+        return (currentValue == expectedValue);
+
+#elif THERON_BOOST
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            boost::memory_order_release);
+
+#elif THERON_CPP11
+
+        return mValue.compare_exchange_weak(
+            currentValue,
+            newValue,
+            std::memory_order_release);
+
+#elif defined(THERON_POSIX)
+
+        bool success(false);
+        pthread_spin_lock(&mSpinLock);
+
+        void *const actualValue(mValue);
+        if (actualValue == currentValue)
+        {
+            mValue = newValue;
+            success = true;
+        }
+
+        currentValue = actualValue;
+
+        pthread_spin_unlock(&mSpinLock);
+        return success;
+
+#endif
+    }
+
+    /**
+    Atomically gets the current value.
+    */
+    THERON_FORCEINLINE void *Load() const
+    {
+#if THERON_WINDOWS
+
+        return mValue;
+
+#elif THERON_BOOST
+
+        return mValue.load();
+
+#elif THERON_CPP11
+
+        return mValue.load();
+
+#elif defined(THERON_POSIX)
+
+        return mValue;
+
+#endif
+    }
+
+    /**
+    Atomically sets the current value.
+    */
+    THERON_FORCEINLINE void Store(void *const val)
+    {
+#if THERON_WINDOWS
+
+        InterlockedExchangePointer(&mValue, val);
+
+#elif THERON_BOOST
+
+        mValue.store(val);
+
+#elif THERON_CPP11
+
+        mValue.store(val);
+
+#elif defined(THERON_POSIX)
+
+        pthread_spin_lock(&mSpinLock);
+        mValue = val;
+        pthread_spin_unlock(&mSpinLock);
+
+#endif
+    }
+
+private:
+
+    Pointer(const Pointer &other);
+    Pointer &operator=(const Pointer &other);
+
+#if THERON_WINDOWS
+
+    void *volatile mValue;
+
+#elif THERON_BOOST
+
+    boost::atomic<void *> mValue;
+
+#elif THERON_CPP11
+
+    std::atomic<void *> mValue;
+
+#elif defined(THERON_POSIX)
+
+    // With POSIX threads we emulate atomics using a mutex (ie. slow but works).
+    void *volatile mValue;
+    mutable pthread_spinlock_t mSpinLock;
+
+#endif
+
+};
+
+
+/**
+Spins until the value is exchanged from the expected value to the new value.
+
+Retries the compare-and-exchange with progressive backoff until it succeeds,
+so callers waiting for a state transition (for example a lock-like flag held
+briefly by another thread) don't hammer the cache line while they wait.
+The exchange is performed with 'acquire' memory ordering semantics.
+
+\note Only appropriate where the value is guaranteed to eventually hold the
+expected value again; otherwise the caller spins forever.
+*/
+THERON_FORCEINLINE void SpinExchangeAcquire(UInt32 &value, const uint32_t expectedValue, const uint32_t newValue)
+{
+    uint32_t backoff(0);
+    uint32_t currentValue(expectedValue);
+
+    while (!value.CompareExchangeAcquire(currentValue, newValue))
+    {
+        currentValue = expectedValue;
+        Utils::Backoff(backoff);
+    }
+}
+
+
+/**
+Spins until the value is exchanged from the expected value to the new value.
+
+64-bit counterpart of \ref SpinExchangeAcquire(UInt32 &, const uint32_t, const uint32_t).
+*/
+THERON_FORCEINLINE void SpinExchangeAcquire(UInt64 &value, const uint64_t expectedValue, const uint64_t newValue)
+{
+    uint32_t backoff(0);
+    uint64_t currentValue(expectedValue);
+
+    while (!value.CompareExchangeAcquire(currentValue, newValue))
+    {
+        currentValue = expectedValue;
+        Utils::Backoff(backoff);
+    }
+}
+
+
 } // namespace Atomic
 } // namespace Detail
 } // namespace Theron
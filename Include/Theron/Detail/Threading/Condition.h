@@ -0,0 +1,293 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_THREADING_CONDITION_H
+#define THERON_DETAIL_THREADING_CONDITION_H
+
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push,0)
+#endif //_MSC_VER
+
+#if THERON_WINDOWS
+
+#include <windows.h>
+
+#elif THERON_BOOST
+
+#include <boost/date_time/posix_time/posix_time_duration.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#elif THERON_CPP11
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#elif defined(THERON_POSIX)
+
+#include <pthread.h>
+#include <time.h>
+
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A condition variable paired with a mutex, used to put threads to sleep and wake them again.
+
+Threads wishing to sleep lock the condition, re-check their wait predicate, and then
+call \ref Wait, which atomically releases the lock while sleeping and re-acquires it
+before returning. Threads producing work call \ref Pulse or \ref PulseAll to wake
+sleeping threads promptly. Waits are bounded by a timeout so that a missed wakeup
+delays a waiter rather than blocking it forever.
+*/
+class Condition
+{
+public:
+
+    /**
+    Default constructor.
+    */
+    inline Condition()
+    {
+#if THERON_WINDOWS
+
+#if _WIN32_WINNT >= 0x0600
+        InitializeCriticalSection(&mCriticalSection);
+        InitializeConditionVariable(&mCondition);
+#else
+        InitializeCriticalSection(&mCriticalSection);
+#endif
+
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_mutex_init(&mMutex, 0);
+        pthread_cond_init(&mCondition, 0);
+
+#endif
+    }
+
+    /**
+    Destructor.
+    */
+    inline ~Condition()
+    {
+#if THERON_WINDOWS
+
+        DeleteCriticalSection(&mCriticalSection);
+
+#elif THERON_BOOST
+#elif THERON_CPP11
+#elif defined(THERON_POSIX)
+
+        pthread_cond_destroy(&mCondition);
+        pthread_mutex_destroy(&mMutex);
+
+#endif
+    }
+
+    /**
+    Locks the mutex associated with the condition.
+    */
+    inline void Lock()
+    {
+#if THERON_WINDOWS
+
+        EnterCriticalSection(&mCriticalSection);
+
+#elif THERON_BOOST
+
+        mMutex.lock();
+
+#elif THERON_CPP11
+
+        mMutex.lock();
+
+#elif defined(THERON_POSIX)
+
+        pthread_mutex_lock(&mMutex);
+
+#endif
+    }
+
+    /**
+    Unlocks the mutex associated with the condition.
+    */
+    inline void Unlock()
+    {
+#if THERON_WINDOWS
+
+        LeaveCriticalSection(&mCriticalSection);
+
+#elif THERON_BOOST
+
+        mMutex.unlock();
+
+#elif THERON_CPP11
+
+        mMutex.unlock();
+
+#elif defined(THERON_POSIX)
+
+        pthread_mutex_unlock(&mMutex);
+
+#endif
+    }
+
+    /**
+    Sleeps until pulsed or until the given timeout expires, whichever comes first.
+    \note Must be called while the condition is locked. The lock is released while
+    sleeping and re-acquired before this method returns.
+    \param timeoutMilliseconds Upper bound on the time spent sleeping, in milliseconds.
+    */
+    inline void Wait(const uint32_t timeoutMilliseconds)
+    {
+#if THERON_WINDOWS
+
+#if _WIN32_WINNT >= 0x0600
+        SleepConditionVariableCS(&mCondition, &mCriticalSection, static_cast<DWORD>(timeoutMilliseconds));
+#else
+        // No condition variable support; sleep briefly with the lock released.
+        LeaveCriticalSection(&mCriticalSection);
+        Sleep(1);
+        EnterCriticalSection(&mCriticalSection);
+        (void) timeoutMilliseconds;
+#endif
+
+#elif THERON_BOOST
+
+        // Adopt the already-held lock and release it again on return.
+        boost::unique_lock<boost::mutex> lock(mMutex, boost::adopt_lock);
+        mCondition.timed_wait(lock, boost::posix_time::milliseconds(timeoutMilliseconds));
+        lock.release();
+
+#elif THERON_CPP11
+
+        // Adopt the already-held lock and release it again on return.
+        std::unique_lock<std::mutex> lock(mMutex, std::adopt_lock);
+        mCondition.wait_for(lock, std::chrono::milliseconds(timeoutMilliseconds));
+        lock.release();
+
+#elif defined(THERON_POSIX)
+
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+
+        timeout.tv_sec += timeoutMilliseconds / 1000;
+        timeout.tv_nsec += (timeoutMilliseconds % 1000) * 1000000L;
+        if (timeout.tv_nsec >= 1000000000L)
+        {
+            timeout.tv_sec += 1;
+            timeout.tv_nsec -= 1000000000L;
+        }
+
+        pthread_cond_timedwait(&mCondition, &mMutex, &timeout);
+
+#endif
+    }
+
+    /**
+    Wakes a single thread sleeping in a call to \ref Wait, if any.
+    */
+    inline void Pulse()
+    {
+#if THERON_WINDOWS
+
+#if _WIN32_WINNT >= 0x0600
+        WakeConditionVariable(&mCondition);
+#endif
+
+#elif THERON_BOOST
+
+        mCondition.notify_one();
+
+#elif THERON_CPP11
+
+        mCondition.notify_one();
+
+#elif defined(THERON_POSIX)
+
+        pthread_cond_signal(&mCondition);
+
+#endif
+    }
+
+    /**
+    Wakes all threads sleeping in calls to \ref Wait.
+    */
+    inline void PulseAll()
+    {
+#if THERON_WINDOWS
+
+#if _WIN32_WINNT >= 0x0600
+        WakeAllConditionVariable(&mCondition);
+#endif
+
+#elif THERON_BOOST
+
+        mCondition.notify_all();
+
+#elif THERON_CPP11
+
+        mCondition.notify_all();
+
+#elif defined(THERON_POSIX)
+
+        pthread_cond_broadcast(&mCondition);
+
+#endif
+    }
+
+private:
+
+    Condition(const Condition &other);
+    Condition &operator=(const Condition &other);
+
+#if THERON_WINDOWS
+
+    CRITICAL_SECTION mCriticalSection;      ///< Critical section protecting the condition.
+#if _WIN32_WINNT >= 0x0600
+    CONDITION_VARIABLE mCondition;          ///< Native Windows condition variable.
+#endif
+
+#elif THERON_BOOST
+
+    boost::mutex mMutex;                    ///< Mutex protecting the condition.
+    boost::condition_variable mCondition;   ///< Boost condition variable.
+
+#elif THERON_CPP11
+
+    std::mutex mMutex;                      ///< Mutex protecting the condition.
+    std::condition_variable mCondition;     ///< Standard library condition variable.
+
+#elif defined(THERON_POSIX)
+
+    pthread_mutex_t mMutex;                 ///< Mutex protecting the condition.
+    pthread_cond_t mCondition;              ///< POSIX condition variable.
+
+#endif
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_THREADING_CONDITION_H
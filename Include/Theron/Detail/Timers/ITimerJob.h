@@ -0,0 +1,85 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TIMERS_ITIMERJOB_H
+#define THERON_DETAIL_TIMERS_ITIMERJOB_H
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Baseclass that allows pending timers of various message types to be stored in a timer wheel.
+*/
+class ITimerJob
+{
+public:
+
+    /**
+    Default constructor.
+    */
+    THERON_FORCEINLINE ITimerJob() :
+      mDeadlineTicks(0),
+      mPeriodTicks(0),
+      mNext(0)
+    {
+        mCancelled.Store(0);
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~ITimerJob()
+    {
+    }
+
+    /**
+    Sends the deferred message. Called by the timer wheel when the timer expires.
+    \return True, if the message was successfully sent.
+    */
+    virtual bool Fire() = 0;
+
+    /**
+    Marks the job as cancelled. The wheel skips cancelled jobs when they
+    expire and reclaims them instead of firing or re-arming them. The job
+    itself remains owned by the wheel, which frees it at expiry or teardown.
+    \note Cancellation is asynchronous: a job whose firing is already in
+    progress on the servicing thread may still send one final message.
+    */
+    THERON_FORCEINLINE void Cancel()
+    {
+        mCancelled.Store(1);
+    }
+
+    /**
+    Returns true if the job has been cancelled.
+    */
+    THERON_FORCEINLINE bool Cancelled() const
+    {
+        return mCancelled.Load() != 0;
+    }
+
+    uint64_t mDeadlineTicks;    ///< Wheel tick at which the timer expires.
+    uint64_t mPeriodTicks;      ///< Rearm period in wheel ticks; zero for one-shot timers.
+    ITimerJob *mNext;           ///< Next job in the same wheel slot chain.
+    Atomic::UInt32 mCancelled;  ///< Set by the owner to stop further firings.
+
+private:
+
+    ITimerJob(const ITimerJob &other);
+    ITimerJob &operator=(const ITimerJob &other);
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TIMERS_ITIMERJOB_H
@@ -0,0 +1,81 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TIMERS_TIMERJOB_H
+#define THERON_DETAIL_TIMERS_TIMERJOB_H
+
+
+#include <Theron/Address.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Timers/ITimerJob.h>
+
+
+namespace Theron
+{
+
+
+class Framework;
+
+
+namespace Detail
+{
+
+
+/**
+A pending timer holding a typed message value to be sent when the timer expires.
+
+The message itself is created through the normal send path on each firing, so
+periodic timers send a fresh copy of the held value every period.
+*/
+template <class ValueType>
+class TimerJob : public ITimerJob
+{
+public:
+
+    /**
+    Constructor.
+    */
+    THERON_FORCEINLINE TimerJob(
+        Framework &framework,
+        const ValueType &value,
+        const Address &from,
+        const Address &address) :
+      ITimerJob(),
+      mFramework(framework),
+      mValue(value),
+      mFrom(from),
+      mAddress(address)
+    {
+    }
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~TimerJob()
+    {
+    }
+
+    /**
+    Sends the held message value to the target address.
+    \note Defined in Framework.h, after the Framework class definition, since
+    the body calls Framework::Send and Framework is only declared here.
+    */
+    inline virtual bool Fire();
+
+private:
+
+    TimerJob(const TimerJob &other);
+    TimerJob &operator=(const TimerJob &other);
+
+    Framework &mFramework;      ///< The framework through which the message is sent.
+    const ValueType mValue;     ///< The message value to be sent.
+    const Address mFrom;        ///< The address from which the message is sent.
+    const Address mAddress;     ///< The address to which the message is sent.
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TIMERS_TIMERJOB_H
@@ -0,0 +1,302 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TIMERS_TIMERWHEEL_H
+#define THERON_DETAIL_TIMERS_TIMERWHEEL_H
+
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Timers/ITimerJob.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+A hierarchical timing wheel holding pending delayed and periodic message sends.
+
+Timers are bucketed by expiry time into slot chains on a hierarchy of wheel
+levels, each covering a span \ref SLOTS_PER_LEVEL times longer than the one
+below it, so insertion and expiry are O(1) per timer regardless of how many
+are pending. The wheel is serviced periodically by the framework's manager
+thread, which advances the wheel to the current time and fires expired timers,
+so expiry precision is limited by the manager thread's servicing rate.
+*/
+class TimerWheel
+{
+public:
+
+    /**
+    Length of one wheel tick in microseconds, bounding the timer resolution.
+    */
+    static const uint32_t TICK_MICROSECONDS = 1000;
+
+    /**
+    Constructor.
+    */
+    inline TimerWheel();
+
+    /**
+    Destructor.
+    */
+    inline ~TimerWheel();
+
+    /**
+    Adds a timer job to the wheel, to be fired after the given delay.
+    The wheel takes ownership of the job, which must be allocated with the general allocator.
+    \note Periodic jobs fire repeatedly with the given delay as their period, including the first firing.
+    */
+    inline void Add(ITimerJob *const job, const uint64_t delayMicroseconds, const bool periodic = false);
+
+    /**
+    Returns true if no timers are currently pending.
+    \note Unsynchronized; the result is a snapshot that may be immediately stale.
+    */
+    THERON_FORCEINLINE bool Empty() const
+    {
+        return (mJobCount == 0);
+    }
+
+    /**
+    Advances the wheel to the current time, firing any timers that have expired.
+    \note Called periodically by the framework's manager thread.
+    */
+    inline void Service();
+
+    /**
+    Permanently stops the wheel, preventing any pending timers from firing.
+    Called when the owning framework begins tearing down, so that periodic
+    timers can't keep injecting messages while the work queues are drained.
+    */
+    inline void Stop();
+
+private:
+
+    static const uint32_t LEVEL_BITS = 6;                           ///< Log2 of the number of slots per level.
+    static const uint32_t SLOTS_PER_LEVEL = (1 << LEVEL_BITS);      ///< Number of slots on each wheel level.
+    static const uint32_t SLOT_MASK = (SLOTS_PER_LEVEL - 1);        ///< Mask of the slot index bits.
+    static const uint32_t NUM_LEVELS = 4;                           ///< Number of wheel levels in the hierarchy.
+
+    TimerWheel(const TimerWheel &other);
+    TimerWheel &operator=(const TimerWheel &other);
+
+    /**
+    Chains a job into the slot covering its deadline.
+    The level is chosen so that the slot resolves the deadline as finely as possible.
+    \note Callers must hold the spinlock.
+    */
+    inline void Insert(ITimerJob *const job);
+
+    /**
+    Re-inserts the jobs bucketed coarsely on higher wheel levels when a level wraps,
+    moving them down to levels that now resolve their deadlines more finely.
+    \note Callers must hold the spinlock.
+    */
+    inline void Cascade();
+
+    mutable SpinLock mSpinLock;                             ///< Protects the wheel structure.
+    ITimerJob *mSlots[NUM_LEVELS][SLOTS_PER_LEVEL];         ///< Chains of pending jobs bucketed by expiry tick.
+    uint64_t mStartMicroseconds;                            ///< Clock value at construction, defining tick zero.
+    uint64_t mCurrentTick;                                  ///< Tick up to which the wheel has been advanced.
+    uint32_t mJobCount;                                     ///< Number of pending jobs in the wheel.
+    bool mStopped;                                          ///< Set when the owning framework begins teardown.
+};
+
+
+inline TimerWheel::TimerWheel() :
+  mSpinLock(),
+  mStartMicroseconds(ProfileClock::GetMicroseconds()),
+  mCurrentTick(0),
+  mJobCount(0),
+  mStopped(false)
+{
+    for (uint32_t level = 0; level < NUM_LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < SLOTS_PER_LEVEL; ++slot)
+        {
+            mSlots[level][slot] = 0;
+        }
+    }
+}
+
+
+inline TimerWheel::~TimerWheel()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Destroy any jobs still pending; their messages are never sent.
+    for (uint32_t level = 0; level < NUM_LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < SLOTS_PER_LEVEL; ++slot)
+        {
+            ITimerJob *job(mSlots[level][slot]);
+            while (job)
+            {
+                ITimerJob *const next(job->mNext);
+
+                job->~ITimerJob();
+                allocator->Free(job);
+
+                job = next;
+            }
+        }
+    }
+}
+
+
+inline void TimerWheel::Add(ITimerJob *const job, const uint64_t delayMicroseconds, const bool periodic)
+{
+    // Round the delay up to a whole number of ticks so timers never fire early.
+    uint64_t delayTicks((delayMicroseconds + TICK_MICROSECONDS - 1) / TICK_MICROSECONDS);
+    if (delayTicks == 0)
+    {
+        delayTicks = 1;
+    }
+
+    mSpinLock.Lock();
+
+    job->mDeadlineTicks = mCurrentTick + delayTicks;
+    job->mPeriodTicks = periodic ? delayTicks : 0;
+
+    Insert(job);
+    ++mJobCount;
+
+    mSpinLock.Unlock();
+}
+
+
+inline void TimerWheel::Insert(ITimerJob *const job)
+{
+    // Find the lowest level whose span covers the remaining delay. Jobs beyond
+    // the range of the top level are parked there and re-bucketed as it wraps.
+    const uint64_t delta(job->mDeadlineTicks - mCurrentTick);
+
+    uint32_t level(0);
+    while (level < NUM_LEVELS - 1 && delta >= (1ULL << (LEVEL_BITS * (level + 1))))
+    {
+        ++level;
+    }
+
+    const uint32_t slot(static_cast<uint32_t>(job->mDeadlineTicks >> (LEVEL_BITS * level)) & SLOT_MASK);
+
+    job->mNext = mSlots[level][slot];
+    mSlots[level][slot] = job;
+}
+
+
+inline void TimerWheel::Cascade()
+{
+    // When a level wraps, the slot on the next level up covering the current time
+    // is emptied and its jobs re-inserted, landing on levels that now resolve
+    // their deadlines more finely. The wrap may ripple further up the hierarchy.
+    for (uint32_t level = 1; level < NUM_LEVELS; ++level)
+    {
+        const uint32_t slot(static_cast<uint32_t>(mCurrentTick >> (LEVEL_BITS * level)) & SLOT_MASK);
+
+        ITimerJob *job(mSlots[level][slot]);
+        mSlots[level][slot] = 0;
+
+        while (job)
+        {
+            ITimerJob *const next(job->mNext);
+            Insert(job);
+            job = next;
+        }
+
+        if (slot != 0)
+        {
+            break;
+        }
+    }
+}
+
+
+inline void TimerWheel::Service()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    const uint64_t nowTick((ProfileClock::GetMicroseconds() - mStartMicroseconds) / TICK_MICROSECONDS);
+
+    mSpinLock.Lock();
+
+    while (!mStopped && mCurrentTick < nowTick)
+    {
+        ++mCurrentTick;
+
+        const uint32_t slot(static_cast<uint32_t>(mCurrentTick) & SLOT_MASK);
+        if (slot == 0)
+        {
+            Cascade();
+        }
+
+        // Detach the chain of jobs expiring on this tick.
+        ITimerJob *expired(mSlots[0][slot]);
+        mSlots[0][slot] = 0;
+
+        // Fire the expired jobs outside the lock, since sending the deferred
+        // messages can take locks of its own. The wheel structure is safe to
+        // unlock because the detached chain is no longer reachable from it.
+        mSpinLock.Unlock();
+
+        while (expired)
+        {
+            ITimerJob *const next(expired->mNext);
+
+            THERON_ASSERT(expired->mDeadlineTicks == mCurrentTick);
+
+            // Cancelled jobs are reclaimed at expiry rather than fired.
+            if (!expired->Cancelled())
+            {
+                expired->Fire();
+            }
+
+            mSpinLock.Lock();
+
+            if (expired->mPeriodTicks != 0 && !mStopped && !expired->Cancelled())
+            {
+                // Re-arm periodic jobs for their next firing.
+                expired->mDeadlineTicks = mCurrentTick + expired->mPeriodTicks;
+                Insert(expired);
+
+                mSpinLock.Unlock();
+            }
+            else
+            {
+                --mJobCount;
+                mSpinLock.Unlock();
+
+                expired->~ITimerJob();
+                allocator->Free(expired);
+            }
+
+            expired = next;
+        }
+
+        mSpinLock.Lock();
+    }
+
+    mSpinLock.Unlock();
+}
+
+
+inline void TimerWheel::Stop()
+{
+    mSpinLock.Lock();
+    mStopped = true;
+    mSpinLock.Unlock();
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TIMERS_TIMERWHEEL_H
@@ -37,10 +37,11 @@ public:
     friend class OutputSocket;
 
     /**
-    \brief Default constructor.
+    \brief Explicit constructor.
     Constructs a network context. At most one network context is created per application.
+    \param ioThreadCount Number of internal I/O threads servicing the context's sockets.
     */
-    inline Context()
+    inline explicit Context(const uint32_t ioThreadCount = 1)
     {
 #if THERON_XS
 
@@ -51,6 +52,21 @@ public:
             THERON_FAIL_MSG("Failed to initialize XS context");
         }
 
+        // Scale the number of internal I/O threads servicing the context's
+        // sockets. Must be set before any sockets are created on the context.
+        if (ioThreadCount > 1)
+        {
+            int count(static_cast<int>(ioThreadCount));
+            if (xs_setctxopt(mContext, XS_IO_THREADS, &count, sizeof(count)) != 0)
+            {
+                THERON_FAIL_MSG("Failed to set XS context I/O thread count");
+            }
+        }
+
+#else
+
+        (void) ioThreadCount;
+
 #endif // THERON_XS
     }
 
@@ -81,6 +97,12 @@ public:
 
         return (mContext != 0);
 
+#elif THERON_SHM
+
+        // The shared memory transport needs no context state, so its
+        // availability alone enables network support.
+        return true;
+
 #else
 
         return false;
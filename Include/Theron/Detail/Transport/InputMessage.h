@@ -13,6 +13,10 @@
 #include <Theron/Assert.h>
 #include <Theron/BasicTypes.h>
 
+#if THERON_SHM && !THERON_XS
+#include <Theron/AllocatorManager.h>
+#endif // THERON_SHM && !THERON_XS
+
 #include <Theron/Detail/Transport/Context.h>
 
 
@@ -43,6 +47,13 @@ public:
     */
     inline explicit InputMessage(Context *const /*context*/)
     {
+#if THERON_SHM && !THERON_XS
+
+        mData = 0;
+        mSize = 0;
+        mCapacity = 0;
+
+#endif // THERON_SHM && !THERON_XS
     }
 
     /**
@@ -61,6 +72,12 @@ public:
             return true;
         }
 
+#elif THERON_SHM
+
+        // The shared memory transport's buffer is grown on demand as
+        // messages are received, so there is nothing to initialize.
+        return true;
+
 #endif // THERON_XS
 
         return false;
@@ -82,6 +99,18 @@ public:
             return true;
         }
 
+#elif THERON_SHM
+
+        if (mData)
+        {
+            AllocatorManager::Instance().GetAllocator()->Free(mData, mCapacity);
+            mData = 0;
+            mSize = 0;
+            mCapacity = 0;
+        }
+
+        return true;
+
 #endif // THERON_XS
 
         return false;
@@ -100,6 +129,10 @@ public:
 
         size = xs_msg_size(&mMessage);
 
+#elif THERON_SHM
+
+        size = mSize;
+
 #endif // THERON_XS
 
         return size;
@@ -117,6 +150,10 @@ public:
 
         data = xs_msg_data(&mMessage);
 
+#elif THERON_SHM
+
+        data = mData;
+
 #endif // THERON_XS
 
         return data;
@@ -124,8 +161,57 @@ public:
 
 private:
 
+#if THERON_SHM
+
+    /**
+    Prepares the message to receive a shared memory transport message of the
+    given size, returning a pointer to the buffer to copy the message data into.
+    Called by the owning InputSocket on receipt of a shared memory message.
+    */
+    inline void *PrepareShmData(const uint32_t size)
+    {
+#if THERON_XS
+
+        // Replace the held XS message with one of the required size, so the
+        // message reads back identically whichever transport filled it.
+        xs_msg_close(&mMessage);
+        if (xs_msg_init_size(&mMessage, size) != 0)
+        {
+            return 0;
+        }
+
+        return xs_msg_data(&mMessage);
+
+#else
+
+        // Grow the owned buffer on demand, keeping it across messages.
+        if (mCapacity < size)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+            if (mData)
+            {
+                allocator->Free(mData, mCapacity);
+            }
+
+            mData = allocator->Allocate(size);
+            mCapacity = mData ? size : 0;
+        }
+
+        mSize = size;
+        return mData;
+
+#endif // THERON_XS
+    }
+
+#endif // THERON_SHM
+
 #if THERON_XS
     xs_msg_t mMessage;      ///< XS message.
+#elif THERON_SHM
+    void *mData;            ///< Buffer holding the received message data.
+    uint32_t mSize;         ///< Size of the received message data in bytes.
+    uint32_t mCapacity;     ///< Allocated size of the buffer in bytes.
 #endif // THERON_XS
 
 };
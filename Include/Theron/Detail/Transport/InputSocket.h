@@ -1,142 +1,332 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
-#define THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
-
-
-#include <Theron/Defines.h>
-
-// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
-#if THERON_XS
-#include <xs/xs.h>
-#endif // THERON_XS
-
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-
-#include <Theron/Detail/Transport/Context.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-/**
-\brief Network input socket wrapper.
-
-Currently implemented with Crossroads.io (libxs).
-*/
-class InputSocket
-{
-public:
-
-    /**
-    \brief Constructs a new input socket within the given network context.
-    */
-    inline explicit InputSocket(Context *const context)
-    {
-        (void) context;
-
-#if THERON_XS
-
-        mSocket = xs_socket(context->mContext, XS_SUB);
-        if (mSocket == 0)
-        {
-            THERON_FAIL_MSG("Failed to create XS subscribe socket");
-        }
-
-        // TODO: We could be smart and only subscribe to messages we care about.
-        // Set a null subscribe filter on the subscribe socket so it receives all published messages.
-        // This must be done before the socket is connected.
-        if (xs_setsockopt(mSocket, XS_SUBSCRIBE, "", 0) != 0)
-        {
-            THERON_FAIL_MSG("Failed to set XS socket subscribe option");
-        }
-
-#endif // THERON_XS
-    }
-
-    /**
-    \brief Destructs an InputSocket.
-    */
-    inline ~InputSocket()
-    {
-#if THERON_XS
-
-        THERON_ASSERT(mSocket);
-
-        // Close the XS socket.
-        if (xs_close(mSocket) != 0)
-        {
-            THERON_FAIL_MSG("Failed to close XS subscribe socket");
-        }
-
-#endif // THERON_XS
-    }
-
-    /**
-    \brief Connects an InputSocket socket to a remote endpoint.
-    The input socket is implicitly connected to any OutputSocket instances bound locally to the remote endpoint.
-    \param location A string identifying the remote endpoint, currently in XS format.
-    \return True if the connection request was successfully created.
-    \note The return value of this function doesn't imply that the connection will actually be made, merely that it was requested.
-    */
-    inline bool Connect(const char *const location)
-    {
-        (void) location;
-
-#if THERON_XS
-
-        THERON_ASSERT(mSocket);
-
-        // Connect the subscribe socket to the remote host.
-        // The same socket can be connected to multiple remote endpoints.
-        if (xs_connect(mSocket, location) != -1)
-        {
-            return true;
-        }
-
-#endif // THERON_XS
-
-        return false;
-    }
-
-    /**
-    \brief Tries to receive a message into the given InputMessage, without blocking.
-    This method reads the first available message from the socket into the given InputMessage.
-    This method is a non-blocking call and doesn't block or what for a message to arrive.
-    \param inputMessage Pointer to an InputMessage to be filled with the read message data.
-    \return True, if a message was available and successfully read.
-    */
-    inline bool NonBlockingReceive(InputMessage *const inputMessage)
-    {
-        (void) inputMessage;
-
-#if THERON_XS
-
-        // Send the network message.
-        if (xs_recvmsg(mSocket, &inputMessage->mMessage, XS_DONTWAIT) != -1)
-        {
-            return true;
-        }
-
-#endif // THERON_XS
-
-        return false;
-    }
-
-private:
-
-#if THERON_XS
-    void *mSocket;      ///< Void pointer to an XS socket.
-#endif // THERON_XS
-
-};
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
+#define THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
+
+
+#include <Theron/Defines.h>
+
+// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
+#if THERON_XS
+#include <xs/xs.h>
+#endif // THERON_XS
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+
+#include <Theron/Detail/Threading/Utils.h>
+#include <Theron/Detail/Transport/Context.h>
+#include <Theron/Detail/Transport/InputMessage.h>
+#include <Theron/Detail/Transport/ShmRing.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Network input socket wrapper.
+
+Currently implemented with Crossroads.io (libxs).
+*/
+class InputSocket
+{
+public:
+
+    /**
+    \brief Constructs a new input socket within the given network context.
+    */
+    inline explicit InputSocket(Context *const context)
+    {
+        (void) context;
+
+#if THERON_SHM
+
+        mShmRingCount = 0;
+        mNextShmRing = 0;
+        mShmMoreParts = false;
+        mLastReceiveShm = false;
+        mNetworkConnections = 0;
+
+#endif // THERON_SHM
+
+#if THERON_XS
+
+        mSocket = xs_socket(context->mContext, XS_SUB);
+        if (mSocket == 0)
+        {
+            THERON_FAIL_MSG("Failed to create XS subscribe socket");
+        }
+
+        // TODO: We could be smart and only subscribe to messages we care about.
+        // Set a null subscribe filter on the subscribe socket so it receives all published messages.
+        // This must be done before the socket is connected.
+        if (xs_setsockopt(mSocket, XS_SUBSCRIBE, "", 0) != 0)
+        {
+            THERON_FAIL_MSG("Failed to set XS socket subscribe option");
+        }
+
+#endif // THERON_XS
+    }
+
+    /**
+    \brief Destructs an InputSocket.
+    */
+    inline ~InputSocket()
+    {
+#if THERON_XS
+
+        THERON_ASSERT(mSocket);
+
+        // Close the XS socket.
+        if (xs_close(mSocket) != 0)
+        {
+            THERON_FAIL_MSG("Failed to close XS subscribe socket");
+        }
+
+#endif // THERON_XS
+    }
+
+    /**
+    \brief Connects an InputSocket socket to a remote endpoint.
+    The input socket is implicitly connected to any OutputSocket instances bound locally to the remote endpoint.
+    \param location A string identifying the remote endpoint, currently in XS format.
+    \return True if the connection request was successfully created.
+    \note The return value of this function doesn't imply that the connection will actually be made, merely that it was requested.
+    */
+    inline bool Connect(const char *const location)
+    {
+        (void) location;
+
+#if THERON_SHM
+
+        // Explicit shm:// locations attach to the location's shared memory
+        // ring, creating it if the writer hasn't bound yet. Loopback tcp://
+        // locations are carried over shared memory too when a local writer
+        // is already serving a ring for the location; otherwise they fall
+        // through to the network transport, which a loopback binding in a
+        // build without shared memory support still serves.
+        if (mShmRingCount < MAX_SHM_RINGS)
+        {
+            if (ShmRing::IsExplicitLocation(location))
+            {
+                if (mShmRings[mShmRingCount].OpenAsReader(location, true))
+                {
+                    ++mShmRingCount;
+                    return true;
+                }
+
+                return false;
+            }
+
+            if (ShmRing::IsLoopbackLocation(location))
+            {
+                if (mShmRings[mShmRingCount].OpenAsReader(location, false))
+                {
+                    ++mShmRingCount;
+                    return true;
+                }
+            }
+        }
+
+#endif // THERON_SHM
+
+#if THERON_SHM && !THERON_XS
+
+        // With no network transport built in, connecting to a network
+        // location is a benign no-op, as it is in builds with networking
+        // disabled entirely.
+        if (!ShmRing::IsExplicitLocation(location))
+        {
+            return true;
+        }
+
+#endif // THERON_SHM && !THERON_XS
+
+#if THERON_XS
+
+        THERON_ASSERT(mSocket);
+
+        // Connect the subscribe socket to the remote host.
+        // The same socket can be connected to multiple remote endpoints.
+        if (xs_connect(mSocket, location) != -1)
+        {
+#if THERON_SHM
+            ++mNetworkConnections;
+#endif // THERON_SHM
+            return true;
+        }
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Tries to receive a message into the given InputMessage, without blocking.
+    This method reads the first available message from the socket into the given InputMessage.
+    This method is a non-blocking call and doesn't block or what for a message to arrive.
+    \param inputMessage Pointer to an InputMessage to be filled with the read message data.
+    \return True, if a message was available and successfully read.
+    */
+    inline bool NonBlockingReceive(InputMessage *const inputMessage)
+    {
+        (void) inputMessage;
+
+#if THERON_SHM
+
+        // Poll the attached shared memory rings round-robin for fairness.
+        // While a multipart message is partially read, the same ring is
+        // polled first, so the remaining parts are consumed contiguously;
+        // they are published atomically so are guaranteed to be available.
+        for (uint32_t visited = 0; visited < mShmRingCount; ++visited)
+        {
+            const uint32_t index((mNextShmRing + visited) % mShmRingCount);
+            ShmRing &ring(mShmRings[index]);
+
+            uint32_t peekedSize(0);
+            if (!ring.Peek(peekedSize))
+            {
+                continue;
+            }
+
+            void *const data(inputMessage->PrepareShmData(peekedSize));
+            if (data == 0)
+            {
+                THERON_FAIL_MSG("Failed to allocate shared memory input message buffer");
+            }
+
+            uint32_t receivedSize(0);
+            bool moreParts(false);
+
+            if (!ring.Read(data, peekedSize, receivedSize, moreParts))
+            {
+                // Overrun by the writer between the peek and the read.
+                continue;
+            }
+
+            mShmMoreParts = moreParts;
+            mLastReceiveShm = true;
+            mNextShmRing = moreParts ? index : (index + 1) % mShmRingCount;
+
+            return true;
+        }
+
+        mLastReceiveShm = false;
+
+#endif // THERON_SHM
+
+#if THERON_XS
+
+        // Send the network message.
+        if (xs_recvmsg(mSocket, &inputMessage->mMessage, XS_DONTWAIT) != -1)
+        {
+            return true;
+        }
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Returns true if the last received message has further parts still to be received.
+    The remaining parts of a partially received multipart message are guaranteed to be
+    immediately available, since the parts of a multipart message are delivered atomically.
+    */
+    inline bool MoreParts() const
+    {
+#if THERON_SHM
+
+        if (mLastReceiveShm)
+        {
+            return mShmMoreParts;
+        }
+
+#endif // THERON_SHM
+
+#if THERON_XS
+
+        int moreParts(0);
+        size_t optionSize(sizeof(moreParts));
+
+        if (xs_getsockopt(mSocket, XS_RCVMORE, &moreParts, &optionSize) == 0)
+        {
+            return (moreParts != 0);
+        }
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Blocks until input is likely available, or an interval has elapsed.
+    When the socket's only input is a single shared memory ring, this sleeps on
+    the ring's publish signal and wakes as soon as a message is published,
+    rather than at the next poll. Otherwise it simply sleeps for a millisecond,
+    matching the polling cadence of transports with no wakeup signal.
+    \param timeoutMicroseconds Maximum time to wait, in microseconds.
+    */
+    inline void WaitForMessage(const uint32_t timeoutMicroseconds)
+    {
+        (void) timeoutMicroseconds;
+
+#if THERON_SHM
+
+        bool networkInput(false);
+
+#if THERON_XS
+        networkInput = (mNetworkConnections != 0);
+#endif // THERON_XS
+
+        if (!networkInput)
+        {
+            if (mShmRingCount == 1)
+            {
+                mShmRings[0].Wait(timeoutMicroseconds);
+                return;
+            }
+
+            for (uint32_t index = 0; index < mShmRingCount; ++index)
+            {
+                if (!mShmRings[index].Empty())
+                {
+                    return;
+                }
+            }
+        }
+
+#endif // THERON_SHM
+
+        Utils::SleepThread(1);
+    }
+
+private:
+
+#if THERON_XS
+    void *mSocket;      ///< Void pointer to an XS socket.
+#endif // THERON_XS
+
+#if THERON_SHM
+
+    static const uint32_t MAX_SHM_RINGS = 8;    ///< Maximum shared memory rings attachable to one socket.
+
+    ShmRing mShmRings[MAX_SHM_RINGS];           ///< Shared memory rings this socket reads from.
+    uint32_t mShmRingCount;                     ///< Number of attached shared memory rings.
+    uint32_t mNextShmRing;                      ///< Index of the next ring to poll first, for fairness.
+    bool mShmMoreParts;                         ///< More-parts flag of the last received shared memory message.
+    bool mLastReceiveShm;                       ///< True if the last received message came from a shared memory ring.
+    uint32_t mNetworkConnections;               ///< Number of connections made over the network transport.
+
+#endif // THERON_SHM
+
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TRANSPORT_INPUTSOCKET_H
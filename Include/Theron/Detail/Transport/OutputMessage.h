@@ -1,125 +1,251 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
-#define THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
-
-
-#include <Theron/Defines.h>
-
-// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
-#if THERON_XS
-#include <xs/xs.h>
-#endif // THERON_XS
-
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-
-#include <Theron/Detail/Transport/Context.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-class OutputSocket;
-
-
-/**
-\brief Network output message wrapper.
-
-Currently implemented with Crossroads.io (libxs).
-*/
-class OutputMessage
-{
-public:
-
-    friend class OutputSocket;
-
-    /**
-    \brief Constructor.
-    Constructs an output message for use with the given network context.
-    An output message can be used to hold message data written to an OutputSocket.
-    */
-    inline explicit OutputMessage(Context *const /*context*/)
-    {
-    }
-
-    /**
-    \brief Initializes an OutputMessage.
-    An OutputMessage must be initialized before use.
-    \param size The size of the message data to be written, in bytes.
-    \return True, if the message was initialized without error.
-    \note A single OutputMessage can be reused multiple times by repeatedly calling Initialize and Release.
-    */
-    inline bool Initialize(const uint32_t size)
-    {
-        (void) size;
-
-#if THERON_XS
-
-        // Initialize the XS message.
-        if (xs_msg_init_size(&mMessage, size) == 0)
-        {
-            return true;
-        }
-
-#endif // THERON_XS
-
-        return false;
-    }
-
-    /**
-    \brief Releases data held by an OutputMessage.
-    An OutputMessage must be released after use and prior to destruction.
-    \return True, if the message was released without error.
-    \note A single OutputMessage can be reused multiple times by repeatedly calling Initialize and Release.
-    */
-    inline bool Release()
-    {
-#if THERON_XS
-
-        // Close the XS message.
-        if (xs_msg_close(&mMessage) == 0)
-        {
-            return true;
-        }
-
-#endif // THERON_XS
-
-        return false;
-    }
-
-    /**
-    \brief Returns a pointer to the message data held in an OutputMessage.
-    Call this method before writing a message to an OutputSocket using OutputSocket::Send.
-    After acquiring a pointer to the data block the caller can write the message data into it.
-    \return A void pointer to the data block owned by the message.
-    */
-    inline void *Data()
-    {
-        void *data(0);
-
-#if THERON_XS
-
-        data = xs_msg_data(&mMessage);
-
-#endif // THERON_XS
-
-        return data;
-    }
-
-private:
-
-#if THERON_XS
-    xs_msg_t mMessage;      ///< XS message.
-#endif // THERON_XS
-
-};
-
-
-} // namespace Detail
-} // namespace Theron
-
-
-#endif // THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
+#define THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
+
+
+#include <Theron/Defines.h>
+
+// NOTE: Must include xs.h before standard headers to avoid warnings in MS headers!
+#if THERON_XS
+#include <xs/xs.h>
+#endif // THERON_XS
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+
+#if THERON_SHM && !THERON_XS
+#include <Theron/AllocatorManager.h>
+#endif // THERON_SHM && !THERON_XS
+
+#include <Theron/Detail/Transport/Context.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+class OutputSocket;
+
+
+/**
+\brief Network output message wrapper.
+
+Currently implemented with Crossroads.io (libxs).
+*/
+class OutputMessage
+{
+public:
+
+    friend class OutputSocket;
+
+    /**
+    Callback function used to free the data referenced by a zero-copy message,
+    called by the transport once the data has been sent and is no longer needed.
+    \note The callback may be executed asynchronously on an internal transport thread.
+    */
+    typedef void (FreeFunction)(void *data, void *hint);
+
+    /**
+    \brief Constructor.
+    Constructs an output message for use with the given network context.
+    An output message can be used to hold message data written to an OutputSocket.
+    */
+    inline explicit OutputMessage(Context *const /*context*/)
+    {
+#if THERON_SHM && !THERON_XS
+
+        mData = 0;
+        mSize = 0;
+        mOwned = false;
+        mFreeFunction = 0;
+        mHint = 0;
+
+#endif // THERON_SHM && !THERON_XS
+    }
+
+    /**
+    \brief Initializes an OutputMessage.
+    An OutputMessage must be initialized before use.
+    \param size The size of the message data to be written, in bytes.
+    \return True, if the message was initialized without error.
+    \note A single OutputMessage can be reused multiple times by repeatedly calling Initialize and Release.
+    */
+    inline bool Initialize(const uint32_t size)
+    {
+        (void) size;
+
+#if THERON_XS
+
+        // Initialize the XS message.
+        if (xs_msg_init_size(&mMessage, size) == 0)
+        {
+            return true;
+        }
+
+#elif THERON_SHM
+
+        // Allocate an owned buffer for the caller to write the data into.
+        mData = AllocatorManager::Instance().GetAllocator()->Allocate(size);
+        if (mData)
+        {
+            mSize = size;
+            mOwned = true;
+            return true;
+        }
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Initializes an OutputMessage as a zero-copy wrapper around existing data.
+    Rather than allocating a transport-owned buffer for the caller to copy the message
+    data into, the transport references the provided data directly and calls the given
+    callback to free it once it has been sent. This avoids copying large payloads at
+    the cost of a callback, so is only worthwhile for messages of significant size.
+    \param data Pointer to the message data to be sent, which must remain valid until the callback is called.
+    \param size The size of the message data, in bytes.
+    \param freeFunction Callback called to free the data once the transport is finished with it.
+    \param hint User-defined context pointer passed to the free callback.
+    \return True, if the message was initialized without error.
+    */
+    inline bool Initialize(void *const data, const uint32_t size, FreeFunction *const freeFunction, void *const hint)
+    {
+        (void) data;
+        (void) size;
+        (void) freeFunction;
+        (void) hint;
+
+#if THERON_XS
+
+        // Initialize the XS message as a reference to the existing data.
+        if (xs_msg_init_data(&mMessage, data, size, freeFunction, hint) == 0)
+        {
+            return true;
+        }
+
+#elif THERON_SHM
+
+        // Reference the data in place; the shared memory transport copies it
+        // into the ring synchronously on send, so the free callback can be
+        // called as soon as the message is released.
+        mData = data;
+        mSize = size;
+        mOwned = false;
+        mFreeFunction = freeFunction;
+        mHint = hint;
+
+        return true;
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Releases data held by an OutputMessage.
+    An OutputMessage must be released after use and prior to destruction.
+    \return True, if the message was released without error.
+    \note A single OutputMessage can be reused multiple times by repeatedly calling Initialize and Release.
+    */
+    inline bool Release()
+    {
+#if THERON_XS
+
+        // Close the XS message.
+        if (xs_msg_close(&mMessage) == 0)
+        {
+            return true;
+        }
+
+#elif THERON_SHM
+
+        if (mOwned)
+        {
+            AllocatorManager::Instance().GetAllocator()->Free(mData, mSize);
+        }
+        else if (mFreeFunction)
+        {
+            mFreeFunction(mData, mHint);
+        }
+
+        mData = 0;
+        mSize = 0;
+        mOwned = false;
+        mFreeFunction = 0;
+        mHint = 0;
+
+        return true;
+
+#endif // THERON_XS
+
+        return false;
+    }
+
+    /**
+    \brief Returns a pointer to the message data held in an OutputMessage.
+    Call this method before writing a message to an OutputSocket using OutputSocket::Send.
+    After acquiring a pointer to the data block the caller can write the message data into it.
+    \return A void pointer to the data block owned by the message.
+    */
+    inline void *Data()
+    {
+        void *data(0);
+
+#if THERON_XS
+
+        data = xs_msg_data(&mMessage);
+
+#elif THERON_SHM
+
+        data = mData;
+
+#endif // THERON_XS
+
+        return data;
+    }
+
+    /**
+    \brief Returns the size of the message data held in an OutputMessage.
+    \return The size of the message data in bytes.
+    */
+    inline uint32_t Size()
+    {
+        uint32_t size(0);
+
+#if THERON_XS
+
+        size = xs_msg_size(&mMessage);
+
+#elif THERON_SHM
+
+        size = mSize;
+
+#endif // THERON_XS
+
+        return size;
+    }
+
+private:
+
+#if THERON_XS
+    xs_msg_t mMessage;              ///< XS message.
+#elif THERON_SHM
+    void *mData;                    ///< The message data, owned or referenced.
+    uint32_t mSize;                 ///< Size of the message data in bytes.
+    bool mOwned;                    ///< True if the data buffer is owned by this message.
+    FreeFunction *mFreeFunction;    ///< Callback freeing referenced data, or zero.
+    void *mHint;                    ///< User-defined context passed to the free callback.
+#endif // THERON_XS
+
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TRANSPORT_OUTPUTMESSAGE_H
@@ -0,0 +1,782 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_DETAIL_TRANSPORT_SHMRING_H
+#define THERON_DETAIL_TRANSPORT_SHMRING_H
+
+
+#include <Theron/Defines.h>
+
+#if THERON_SHM
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#endif // THERON_SHM
+
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+\brief Broadcast message ring in a named shared memory segment.
+
+Carries framed messages from a single writing process to any number of reading
+processes on the same host, without crossing the kernel socket stack. The ring
+lives in a POSIX shared memory segment named after the endpoint location, so a
+writer and its readers rendezvous by location string alone, in either order.
+
+The writer publishes messages by copying them into the ring and advancing a
+shared write position; multipart messages are staged and published with a
+single advance, so readers see all parts of a message or none of them. Readers
+each keep a private read position and copy messages out, so no reader state is
+shared and a stalled or dead reader never blocks the writer. Like the network
+transport's publish/subscribe model, delivery is not guaranteed: the writer
+overwrites the oldest data when the ring wraps, and a reader that has fallen
+more than a ring size behind detects the overrun and resynchronizes to the
+current write position, dropping the overwritten messages.
+
+Readers normally poll, but can also block on the ring's publish sequence word,
+which the writer bumps and signals through a futex after each publish. This
+gives waiting readers sub-millisecond wakeup on message arrival, without any
+polling cost to the writer when no reader is waiting.
+
+The segment is created by whichever side opens the location first and persists
+in the file system (typically /dev/shm) after the processes detach, so a later
+writer can reattach and continue serving readers of an earlier incarnation.
+
+\note Messages larger than the ring (including all parts of a multipart
+message, which are staged together) can't be sent and fail the write; large
+payloads should be split using the endpoint's chunked streaming support.
+*/
+class ShmRing
+{
+public:
+
+#if THERON_SHM
+
+    /**
+    Returns true if the given location string should be carried over shared
+    memory: either an explicit shm:// location, or a tcp:// location on a
+    loopback host, which by definition only same-host peers can reach.
+    */
+    inline static bool IsSharedMemoryLocation(const char *const location)
+    {
+        return IsExplicitLocation(location) || IsLoopbackLocation(location);
+    }
+
+    /**
+    Returns true if the given location explicitly names the shared memory
+    transport with the shm:// scheme, rather than being selected automatically.
+    */
+    inline static bool IsExplicitLocation(const char *const location)
+    {
+        return (strncmp(location, "shm://", 6) == 0);
+    }
+
+    /**
+    Returns true if the given location is a tcp:// location on a loopback host.
+    */
+    inline static bool IsLoopbackLocation(const char *const location)
+    {
+        return (strncmp(location, "tcp://127.", 10) == 0 ||
+                strncmp(location, "tcp://localhost:", 16) == 0);
+    }
+
+#endif // THERON_SHM
+
+    /**
+    Default constructor. Constructs a closed ring, attached to no segment.
+    */
+    inline ShmRing()
+    {
+#if THERON_SHM
+
+        mHeader = 0;
+        mRing = 0;
+        mWriter = false;
+        mReadPosition = 0;
+        mStagedPosition = 0;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Destructor. Detaches from the segment, if attached.
+    */
+    inline ~ShmRing()
+    {
+        Close();
+    }
+
+    /**
+    Returns true if the ring is attached to a shared memory segment.
+    */
+    inline bool IsOpen() const
+    {
+#if THERON_SHM
+
+        return (mHeader != 0);
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Opens the ring for the given location as its single writer, creating the
+    segment if it doesn't exist yet. Fails if another live process is already
+    writing to the same location; a claim left by a dead writer is taken over,
+    and the ring continues from its existing write position so already-attached
+    readers are preserved.
+    \return True, if the ring was opened and the writer role claimed.
+    */
+    inline bool OpenAsWriter(const char *const location)
+    {
+        (void) location;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader == 0);
+
+        if (!OpenSegment(location, true))
+        {
+            return false;
+        }
+
+        // Claim the writer role, marked by the writing process's PID. A stale
+        // claim left by a writer that died without detaching is taken over.
+        const uint32_t ownPid(static_cast<uint32_t>(getpid()));
+        uint32_t claimedPid(__sync_val_compare_and_swap(&mHeader->mWriterPid, 0, ownPid));
+
+        if (claimedPid != 0 && claimedPid != ownPid && !ProcessAlive(claimedPid))
+        {
+            claimedPid = __sync_val_compare_and_swap(&mHeader->mWriterPid, claimedPid, ownPid);
+            claimedPid = (claimedPid == ownPid) ? ownPid : claimedPid;
+        }
+
+        if (claimedPid != 0 && claimedPid != ownPid)
+        {
+            CloseSegment();
+            return false;
+        }
+
+        // Continue the stream from the published position, discarding any
+        // bytes a previous writer staged but never published.
+        mWriter = true;
+        mStagedPosition = LoadPosition(mHeader->mWritePosition);
+        StorePosition(mHeader->mReservedPosition, mStagedPosition);
+
+        return true;
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Opens the ring for the given location as a reader, starting at the current
+    write position, so only messages published after attachment are seen.
+    \param create True to create the segment if it doesn't exist, allowing a
+    reader to attach before the writer; false to attach only to an existing
+    segment with a live writer, used when probing for a local peer.
+    \return True, if the ring was opened.
+    */
+    inline bool OpenAsReader(const char *const location, const bool create)
+    {
+        (void) location;
+        (void) create;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader == 0);
+
+        if (!OpenSegment(location, create))
+        {
+            return false;
+        }
+
+        if (!create && !ProcessAlive(mHeader->mWriterPid))
+        {
+            CloseSegment();
+            return false;
+        }
+
+        mWriter = false;
+        mReadPosition = LoadPosition(mHeader->mWritePosition);
+
+        return true;
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Detaches from the segment. A writer releases its claim on the writer role;
+    the segment itself persists for later reattachment.
+    */
+    inline void Close()
+    {
+#if THERON_SHM
+
+        if (mHeader)
+        {
+            if (mWriter)
+            {
+                __sync_val_compare_and_swap(
+                    &mHeader->mWriterPid,
+                    static_cast<uint32_t>(getpid()),
+                    0);
+            }
+
+            CloseSegment();
+        }
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Writes a message into the ring, overwriting the oldest data if the ring is
+    full. Parts of a multipart message are staged and become visible to readers
+    atomically when the final part is written.
+    \param data Pointer to the message data to be written.
+    \param size Size of the message data in bytes.
+    \param moreParts True if the message is a non-final part of a multipart message.
+    \return True, if the message was written; false if the message, together
+    with any parts staged before it, is too large to ever fit in the ring.
+    */
+    inline bool Write(const void *const data, const uint32_t size, const bool moreParts)
+    {
+        (void) data;
+        (void) size;
+        (void) moreParts;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader && mWriter);
+
+        const uint64_t published(LoadPosition(mHeader->mWritePosition));
+        const uint32_t recordSize(RECORD_HEADER_SIZE + RoundUp(size));
+
+        // The group staged since the last publish has to fit in the ring in
+        // its entirety, or the newest parts would overwrite the oldest.
+        if (mStagedPosition + recordSize - published > mHeader->mRingSize)
+        {
+            mStagedPosition = published;
+            StorePosition(mHeader->mReservedPosition, published);
+            return false;
+        }
+
+        // Advance the reserved position over the record before writing it, so
+        // readers treat the bytes being overwritten as clobbered.
+        StorePosition(mHeader->mReservedPosition, mStagedPosition + recordSize);
+
+        RecordHeader record;
+        record.mSize = size;
+        record.mFlags = moreParts ? FLAG_MORE_PARTS : 0;
+
+        CopyIn(mStagedPosition, &record, RECORD_HEADER_SIZE);
+        CopyIn(mStagedPosition + RECORD_HEADER_SIZE, data, size);
+
+        mStagedPosition += recordSize;
+
+        // Publish on the final part, bumping the sequence word and waking any
+        // readers blocked on it. The futex wake is elided when no reader is
+        // registered as waiting, which is the common case under load.
+        if (!moreParts)
+        {
+            StorePosition(mHeader->mWritePosition, mStagedPosition);
+            __sync_fetch_and_add(&mHeader->mSequence, 1);
+
+            if (mHeader->mWaiters != 0)
+            {
+                syscall(SYS_futex, &mHeader->mSequence, FUTEX_WAKE, 0x7FFFFFFF, 0, 0, 0);
+            }
+        }
+
+        return true;
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Peeks at the size of the next unread message, without consuming it.
+    \param size Filled with the size of the next message data in bytes.
+    \return True, if an unread message is available.
+    */
+    inline bool Peek(uint32_t &size)
+    {
+        (void) size;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader && !mWriter);
+
+        if (mReadPosition == LoadPosition(mHeader->mWritePosition))
+        {
+            return false;
+        }
+
+        RecordHeader record;
+        CopyOut(&record, mReadPosition, RECORD_HEADER_SIZE);
+
+        if (!Intact(mReadPosition) || record.mSize > mHeader->mRingSize)
+        {
+            Resynchronize();
+            return false;
+        }
+
+        size = record.mSize;
+        return true;
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Reads the next unread message into the given buffer.
+    \param dest Buffer to copy the message data into.
+    \param capacity Size of the buffer in bytes.
+    \param size Filled with the size of the read message data in bytes.
+    \param moreParts Filled with true if the message has further parts still to be read.
+    \return True, if a message was available and successfully read. A return of
+    false with messages outstanding indicates the reader was overrun by the
+    writer and has resynchronized, dropping the overwritten messages.
+    */
+    inline bool Read(void *const dest, const uint32_t capacity, uint32_t &size, bool &moreParts)
+    {
+        (void) dest;
+        (void) capacity;
+        (void) size;
+        (void) moreParts;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader && !mWriter);
+
+        if (mReadPosition == LoadPosition(mHeader->mWritePosition))
+        {
+            return false;
+        }
+
+        RecordHeader record;
+        CopyOut(&record, mReadPosition, RECORD_HEADER_SIZE);
+
+        if (!Intact(mReadPosition) || record.mSize > capacity)
+        {
+            Resynchronize();
+            return false;
+        }
+
+        CopyOut(dest, mReadPosition + RECORD_HEADER_SIZE, record.mSize);
+
+        // The copied bytes are only valid if the writer didn't lap the reader
+        // while they were being copied.
+        if (!Intact(mReadPosition))
+        {
+            Resynchronize();
+            return false;
+        }
+
+        mReadPosition += RECORD_HEADER_SIZE + RoundUp(record.mSize);
+
+        size = record.mSize;
+        moreParts = ((record.mFlags & FLAG_MORE_PARTS) != 0);
+
+        return true;
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Returns true if no unread messages are available to this reader.
+    */
+    inline bool Empty() const
+    {
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader && !mWriter);
+        return (mReadPosition == LoadPosition(mHeader->mWritePosition));
+
+#else
+
+        return true;
+
+#endif // THERON_SHM
+    }
+
+    /**
+    Blocks the calling reader until a message is published or the timeout
+    expires, sleeping on the ring's publish sequence word.
+    \param timeoutMicroseconds Maximum time to wait, in microseconds.
+    \return True, if an unread message is available.
+    */
+    inline bool Wait(const uint32_t timeoutMicroseconds)
+    {
+        (void) timeoutMicroseconds;
+
+#if THERON_SHM
+
+        THERON_ASSERT(mHeader && !mWriter);
+
+        if (!Empty())
+        {
+            return true;
+        }
+
+        // Sample the sequence word before the final emptiness check, so a
+        // publish between the check and the wait changes the word and fails
+        // the wait immediately rather than being missed.
+        const uint32_t sequence(mHeader->mSequence);
+
+        __sync_fetch_and_add(&mHeader->mWaiters, 1);
+
+        if (Empty())
+        {
+            timespec timeout;
+            timeout.tv_sec = timeoutMicroseconds / 1000000;
+            timeout.tv_nsec = (timeoutMicroseconds % 1000000) * 1000;
+
+            syscall(SYS_futex, &mHeader->mSequence, FUTEX_WAIT, sequence, &timeout, 0, 0);
+        }
+
+        __sync_fetch_and_sub(&mHeader->mWaiters, 1);
+
+        return !Empty();
+
+#else
+
+        return false;
+
+#endif // THERON_SHM
+    }
+
+private:
+
+    ShmRing(const ShmRing &other);
+    ShmRing &operator=(const ShmRing &other);
+
+#if THERON_SHM
+
+    static const uint32_t SEGMENT_MAGIC = 0x4D485354;           ///< 'TSHM' identifying an initialized segment.
+    static const uint32_t STATE_UNINITIALIZED = 0;              ///< Freshly created, zero-filled segment.
+    static const uint32_t STATE_INITIALIZING = 1;               ///< Claimed by the process initializing the header.
+    static const uint32_t STATE_READY = 2;                      ///< Header initialized; segment usable.
+    static const uint32_t RECORD_HEADER_SIZE = 8;               ///< Size of the per-message record header.
+    static const uint32_t FLAG_MORE_PARTS = 0x1;                ///< Record flag marking a non-final multipart part.
+    static const uint32_t MAX_SEGMENT_NAME = 256;               ///< Maximum length of a generated segment name.
+
+    /**
+    Header at the start of the shared segment, followed by the ring bytes.
+    Shared between processes, so contains only plain scalar fields accessed
+    with atomic builtins and explicit fences.
+    */
+    struct SegmentHeader
+    {
+        volatile uint32_t mState;                               ///< Initialization state of the segment.
+        volatile uint32_t mMagic;                               ///< Magic word validating the segment format.
+        volatile uint32_t mRingSize;                            ///< Size of the ring in bytes (a power of two).
+        volatile uint32_t mSequence;                            ///< Publish counter, doubling as the futex word.
+        volatile uint32_t mWaiters;                             ///< Number of readers blocked on the sequence word.
+        volatile uint32_t mWriterPid;                           ///< PID of the writing process, or zero if unclaimed.
+        volatile uint64_t mWritePosition;                       ///< Free-running byte position of published data.
+        volatile uint64_t mReservedPosition;                    ///< Free-running byte position of staged data.
+        uint8_t mPadding[THERON_CACHELINE_ALIGNMENT];           ///< Pads the ring bytes onto their own cache line.
+    };
+
+    /**
+    Header framing each message record in the ring.
+    */
+    struct RecordHeader
+    {
+        uint32_t mSize;                                         ///< Size of the message data in bytes.
+        uint32_t mFlags;                                        ///< Record flags.
+    };
+
+    /**
+    Rounds a record payload size up to the record alignment.
+    */
+    THERON_FORCEINLINE static uint32_t RoundUp(const uint32_t size)
+    {
+        return (size + 7) & ~7u;
+    }
+
+    /**
+    Atomically loads a shared 64-bit position with acquire semantics.
+    */
+    THERON_FORCEINLINE static uint64_t LoadPosition(const volatile uint64_t &position)
+    {
+        const uint64_t value(position);
+        __sync_synchronize();
+        return value;
+    }
+
+    /**
+    Atomically stores a shared 64-bit position with release semantics.
+    */
+    THERON_FORCEINLINE static void StorePosition(volatile uint64_t &position, const uint64_t value)
+    {
+        __sync_synchronize();
+        position = value;
+    }
+
+    /**
+    Returns true if a process with the given PID exists.
+    */
+    inline static bool ProcessAlive(const uint32_t pid)
+    {
+        if (pid == 0)
+        {
+            return false;
+        }
+
+        return (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+    }
+
+    /**
+    Builds the shared segment name for a location string. Loopback host names
+    are normalized first, so equivalent spellings of a loopback location map
+    to the same segment, then the location is sanitized into a flat name.
+    */
+    inline static void SegmentName(const char *const location, char *const name)
+    {
+        char normalized[MAX_SEGMENT_NAME];
+
+        if (strncmp(location, "tcp://localhost:", 16) == 0)
+        {
+            snprintf(normalized, sizeof(normalized), "tcp://127.0.0.1:%s", location + 16);
+        }
+        else
+        {
+            snprintf(normalized, sizeof(normalized), "%s", location);
+        }
+
+        uint32_t length(0);
+        name[length++] = '/';
+
+        const char *const prefix("theron_");
+        for (const char *ch = prefix; *ch != '\0'; ++ch)
+        {
+            name[length++] = *ch;
+        }
+
+        for (const char *ch = normalized; *ch != '\0' && length < MAX_SEGMENT_NAME - 1; ++ch)
+        {
+            const char c(*ch);
+            const bool alnum(
+                (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') ||
+                (c >= '0' && c <= '9'));
+
+            name[length++] = alnum ? c : '_';
+        }
+
+        name[length] = '\0';
+    }
+
+    /**
+    Opens and maps the shared segment for a location, initializing the header
+    if this process created it. Exactly one opener wins the initialization
+    claim; others wait for the header to become ready.
+    */
+    inline bool OpenSegment(const char *const location, const bool create)
+    {
+        char name[MAX_SEGMENT_NAME];
+        SegmentName(location, name);
+
+        const int flags(create ? (O_RDWR | O_CREAT) : O_RDWR);
+        const int file(shm_open(name, flags, 0666));
+
+        if (file < 0)
+        {
+            return false;
+        }
+
+        const size_t segmentSize(sizeof(SegmentHeader) + THERON_SHM_RING_SIZE);
+
+        // Sizing the segment is idempotent, so creators racing to size it are
+        // harmless. A pre-existing segment of a different size is rejected as
+        // belonging to a build with a different configured ring size.
+        struct stat status;
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            return false;
+        }
+
+        if (status.st_size == 0)
+        {
+            if (!create || ftruncate(file, segmentSize) != 0)
+            {
+                close(file);
+                return false;
+            }
+        }
+        else if (status.st_size != static_cast<off_t>(segmentSize))
+        {
+            close(file);
+            return false;
+        }
+
+        void *const mapping(mmap(0, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0));
+        close(file);
+
+        if (mapping == MAP_FAILED)
+        {
+            return false;
+        }
+
+        SegmentHeader *const header(reinterpret_cast<SegmentHeader *>(mapping));
+
+        // The first opener claims the freshly zero-filled segment and
+        // initializes the header; everyone else waits for it to become ready.
+        const uint32_t state(__sync_val_compare_and_swap(
+            &header->mState,
+            STATE_UNINITIALIZED,
+            STATE_INITIALIZING));
+
+        if (state == STATE_UNINITIALIZED)
+        {
+            header->mMagic = SEGMENT_MAGIC;
+            header->mRingSize = THERON_SHM_RING_SIZE;
+            header->mSequence = 0;
+            header->mWaiters = 0;
+            header->mWriterPid = 0;
+            header->mWritePosition = 0;
+            header->mReservedPosition = 0;
+
+            __sync_synchronize();
+            header->mState = STATE_READY;
+        }
+        else
+        {
+            // Bounded wait, in case the initializing process died mid-claim.
+            uint32_t spins(0);
+            while (header->mState != STATE_READY && ++spins < 10000)
+            {
+                timespec delay;
+                delay.tv_sec = 0;
+                delay.tv_nsec = 100000;
+                nanosleep(&delay, 0);
+            }
+        }
+
+        __sync_synchronize();
+
+        if (header->mState != STATE_READY ||
+            header->mMagic != SEGMENT_MAGIC ||
+            header->mRingSize != THERON_SHM_RING_SIZE)
+        {
+            munmap(mapping, segmentSize);
+            return false;
+        }
+
+        mHeader = header;
+        mRing = reinterpret_cast<uint8_t *>(mapping) + sizeof(SegmentHeader);
+
+        return true;
+    }
+
+    /**
+    Unmaps the shared segment.
+    */
+    inline void CloseSegment()
+    {
+        munmap(mHeader, sizeof(SegmentHeader) + THERON_SHM_RING_SIZE);
+        mHeader = 0;
+        mRing = 0;
+    }
+
+    /**
+    Returns true if ring data at the given position hasn't been overwritten,
+    which holds while the writer's reserved position is within a ring size.
+    */
+    THERON_FORCEINLINE bool Intact(const uint64_t position) const
+    {
+        return (LoadPosition(mHeader->mReservedPosition) - position <= mHeader->mRingSize);
+    }
+
+    /**
+    Resynchronizes an overrun reader to the current write position.
+    */
+    THERON_FORCEINLINE void Resynchronize()
+    {
+        mReadPosition = LoadPosition(mHeader->mWritePosition);
+    }
+
+    /**
+    Copies bytes into the ring at a free-running position, wrapping as needed.
+    */
+    inline void CopyIn(const uint64_t position, const void *const data, const uint32_t size)
+    {
+        const uint32_t mask(mHeader->mRingSize - 1);
+        const uint32_t offset(static_cast<uint32_t>(position) & mask);
+        const uint32_t contiguous(mHeader->mRingSize - offset);
+        const uint32_t first(size < contiguous ? size : contiguous);
+
+        memcpy(mRing + offset, data, first);
+        memcpy(mRing, reinterpret_cast<const uint8_t *>(data) + first, size - first);
+    }
+
+    /**
+    Copies bytes out of the ring at a free-running position, wrapping as needed.
+    */
+    inline void CopyOut(void *const dest, const uint64_t position, const uint32_t size) const
+    {
+        const uint32_t mask(mHeader->mRingSize - 1);
+        const uint32_t offset(static_cast<uint32_t>(position) & mask);
+        const uint32_t contiguous(mHeader->mRingSize - offset);
+        const uint32_t first(size < contiguous ? size : contiguous);
+
+        memcpy(dest, mRing + offset, first);
+        memcpy(reinterpret_cast<uint8_t *>(dest) + first, mRing, size - first);
+    }
+
+    SegmentHeader *mHeader;         ///< Mapped segment header, or zero when closed.
+    uint8_t *mRing;                 ///< Ring bytes following the header in the mapping.
+    bool mWriter;                   ///< True if this attachment holds the writer role.
+    uint64_t mReadPosition;         ///< This reader's private read position.
+    uint64_t mStagedPosition;       ///< The writer's staging position, at or ahead of the published position.
+
+#endif // THERON_SHM
+
+};
+
+
+} // namespace Detail
+} // namespace Theron
+
+
+#endif // THERON_DETAIL_TRANSPORT_SHMRING_H
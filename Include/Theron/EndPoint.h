@@ -1,334 +1,710 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_ENDPOINT_H
-#define THERON_ENDPOINT_H
-
-
-/**
-\file EndPoint.h
-An endpoint in a connected network of processes, potentially on remote hosts.
-*/
-
-#include <string.h>
-#include <stdio.h>
-#include <stdlib.h>
-
-#include <Theron/Address.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Defines.h>
-#include <Theron/Register.h>
-
-#include <Theron/Detail/Containers/Queue.h>
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Network/MessageFactory.h>
-#include <Theron/Detail/Network/NameMap.h>
-#include <Theron/Detail/Network/String.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-#include <Theron/Detail/Threading/Thread.h>
-#include <Theron/Detail/Transport/Context.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4127)  // conditional expression is constant
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-
-
-namespace Detail
-{
-class MessageSender;
-}
-
-
-class Actor;
-class Framework;
-class Receiver;
-
-
-/**
-\brief Network communication object.
-
-Enables communication with actors in other processes and on remote hosts.
-A single instance of this class must be constructed in each application that
-is intended to be used in a collection of distributed applications in distributed
-computing.
-
-If an EndPoint is created then it must outlive any frameworks, actors and receivers
-that are tied to it.
-*/
-class EndPoint
-{
-public:
-
-    friend class Actor;
-    friend class Framework;
-    friend class Receiver;
-    friend class Detail::MessageSender;
-
-    /**
-    \brief Parameters structure that can be passed to the EndPoint constructor.
-    Currently this is empty and is here just to allow future expansion.
-    */
-    struct Parameters
-    {
-    };
-
-    /**
-    \brief Explicit constructor.
-
-    Constructs a EndPoint with the given parameters.
-
-    \param name String name for the endpoint, required to be unique.
-    \param location String defining the network location to which the endpoint is bound.
-    \param params Optional parameters object containing initialization parameters.
-
-    \note The name defined on construction should be globally unique across all connected hosts.
-    The name and location parameters are copied, so can be destroyed after the call.
-
-    \code
-    int main(int argc, char *argv[])
-    {
-        // Create a local endpoint using a local IP address provided as a command-line parameter.
-        char buffer[256];
-        sprintf(buffer, "tcp://%s:5556", argv[1]);
-        Theron::EndPoint endPoint("client", buffer);
-
-        // Connect to the remote endpoint at an IP address provided as a second command-line parameter.
-        sprintf(buffer, "tcp://%s:5555", argv[2]);
-        if (!endPoint.Connect(buffer))
-        {
-            printf("ERROR: Connection failed - check networking is enabled.\n");
-            return 1;
-        }
-
-        // Construct a framework tied to the local endpoint.
-        Theron::Framework framework(endPoint);
-    }
-    \endcode
-    */
-    EndPoint(const char *const name, const char *const location, const Parameters params = Parameters());
-
-    /**
-    Destructor.
-    */
-    ~EndPoint();
-
-    /**
-    \brief Gets the name of the EndPoint instance.
-    The name is defined on construction and should be globally unique across all connected hosts.
-    */
-    inline const char *GetName() const;
-
-    /**
-    \brief Connects this EndPoint object to another (remote) EndPoint object.
-
-    The remote EndPoint is typically on another host, connected to the local one by a
-    network connection. It is also possible to use this mechanism to connect different
-    processes on the same host.
-
-    The format of the address parameter is "tcp://192.168.10.104:5555" where "192.168.10.104" is the
-    IP address of the remote host and "5555" is the number of the network port on the remote host
-    to which the remote EndPoint is assigned.
-
-    \param address Unique network address (IP address and port) of the remote EndPoint instance.
-    \return True, if the connection succeeded.
-
-    \code
-    int main(int argc, char *argv[])
-    {
-        // Create a local endpoint using a local IP address provided as a command-line parameter.
-        char buffer[256];
-        sprintf(buffer, "tcp://%s:5556", argv[1]);
-        Theron::EndPoint endPoint("client", buffer);
-
-        // Connect to the remote endpoint at an IP address provided as a second command-line parameter.
-        sprintf(buffer, "tcp://%s:5555", argv[2]);
-        if (!endPoint.Connect(buffer))
-        {
-            printf("ERROR: Connection failed - check networking is enabled.\n");
-            return 1;
-        }
-
-        // Construct a framework tied to the local endpoint.
-        Theron::Framework framework(endPoint);
-    }
-    \endcode
-    */
-    bool Connect(const char *const address);
-
-private:
-
-    // Request structure used to represent a request to connect to a remote endpoint.
-    class ConnectRequest : public Detail::Queue<ConnectRequest>::Node
-    {
-    public:
-
-        inline explicit ConnectRequest(const char *const location) : mLocation(location)
-        {
-        }
-
-        Detail::String mLocation;        ///< The endpoint address in host::port format.
-
-    private:
-
-        ConnectRequest(const ConnectRequest &other);
-        ConnectRequest &operator=(const ConnectRequest &other);
-    };
-
-    // Request structure used to represent a request to send a message to a (remote or local) name.
-    class SendRequest : public Detail::Queue<SendRequest>::Node
-    {
-    public:
-
-        inline explicit SendRequest(Detail::IMessage *const message, const Detail::String &name) :
-          mMessage(message),
-          mName(name)
-        {
-        }
-
-        Detail::IMessage *const mMessage;       ///< The allocated message.
-        Detail::String mName;                   ///< The destination name.
-
-    private:
-
-        SendRequest(const SendRequest &other);
-        SendRequest &operator=(const SendRequest &other);
-    };
-
-    EndPoint(const EndPoint &other);
-    EndPoint &operator=(const EndPoint &other);
-
-    /**
-    \brief Acquires a pointer to the single network context within the local process.
-    All EndPoint objects created within a process share the same network context.
-    This allows them to communicate using local 'inproc' network communication.
-    \return Pointer to the single Context instance, which is created if need be.
-    */
-    static Detail::Context *InitializeContext();
-
-    /**
-    Releases a reference to the single network context within the local process.
-    */
-    static void ReleaseContext();
-
-     /**
-    \brief Associates a mailbox index with a given string name.
-    \note Mailbox names must be unique.
-    */
-    inline bool Register(const Detail::String &name, const Detail::Index &index);
-
-    /**
-    \brief Removes the association of a mailbox index with the given string name.
-    */
-    inline bool Deregister(const Detail::String &name);
-
-    /**
-    \brief Looks up the mailbox index registered with the given name, if any.
-    */
-    inline bool Lookup(const Detail::String &name, Detail::Index &index) const;
-
-    /**
-    Registers a message type for serialization on the network, so it can be sent in network messages.
-    The message type must have been registered by means of \ref THERON_REGISTER_MESSAGE.
-    */
-    template <class ValueType>
-    inline bool RegisterMessageType();
-
-    /**
-    Sends the given allocated message to the mailboxes with the given published name.
-    */
-    bool RequestSend(Detail::IMessage *const message, const Detail::String &name);
-
-    static void NetworkThreadEntryPoint(void *const context);
-    void NetworkThreadProc();
-
-    static Detail::SpinLock smContextLock;              ///< Ensures thread-safe access to the per-process network context.
-    static uint32_t smContextRefCount;                  ///< Context object reference count.
-    static Detail::Context *smContext;                  ///< Pointer the single per-process network context object.
-
-    Detail::String mName;                               ///< Name of the this endpoint, unique across all hosts.
-    Detail::String mLocation;                           ///< Unique network location (eg. IP address and port) of the endpoint.
-    Detail::Context *mContext;                          ///< Pointer to per-process network context object.
-    Detail::NameMap mNameMap;                           ///< Map of published names to addresses.
-    Detail::MessageFactory mMessageFactory;             ///< Builds messages from serialized data blocks.
-    Detail::Thread mNetworkThread;                      ///< Creates and listens to network sockets.
-    bool mRunning;                                      ///< Flag used to terminate the network thread.
-    bool mStarted;                                      ///< Flag used to signal that the network thread has started.
-    Detail::SpinLock mNetworkLock;                      ///< Thread-safe access to network state.
-    Detail::Queue<ConnectRequest> mConnectQueue;        ///< Queue of connection requests.
-    Detail::Queue<SendRequest> mSendQueue;              ///< Queue of message send requests.
-};
-
-
-THERON_FORCEINLINE const char *EndPoint::GetName() const
-{
-    return mName.GetValue();
-}
-
-
-template <class ValueType>
-inline bool EndPoint::RegisterMessageType()
-{
-    // Constant expression - may need to disable a warning ...
-    if (Detail::MessageTraits<ValueType>::HAS_TYPE_NAME)
-    {
-        const Detail::String name(Detail::MessageTraits<ValueType>::TYPE_NAME);
-        mMessageFactory.Register<ValueType>(name);
-
-        return true;
-    }
-
-    return false;
-}
-
-
-THERON_FORCEINLINE bool EndPoint::Register(const Detail::String &name, const Detail::Index &index)
-{
-    // Remove any existing entry for the name.
-    if (!mNameMap.Remove(name))
-    {
-        return false;
-    }
-
-    // Insert the new entry.
-    if (!mNameMap.Insert(name, index))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-
-THERON_FORCEINLINE bool EndPoint::Deregister(const Detail::String &name)
-{
-    // Remove any existing entry for the name.
-    if (!mNameMap.Remove(name))
-    {
-        return false;
-    }
-
-    return true;
-}
-
-
-THERON_FORCEINLINE bool EndPoint::Lookup(const Detail::String &name, Detail::Index &index) const
-{
-    return mNameMap.Get(name, index);
-}
-
-
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_ENDPOINT_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ENDPOINT_H
+#define THERON_ENDPOINT_H
+
+
+/**
+\file EndPoint.h
+An endpoint in a connected network of processes, potentially on remote hosts.
+*/
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/Register.h>
+
+#include <Theron/Detail/Containers/Queue.h>
+#include <Theron/Detail/Containers/RingQueue.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Network/DedupWindowSet.h>
+#include <Theron/Detail/Network/MessageFactory.h>
+#include <Theron/Detail/Network/MessageJournal.h>
+#include <Theron/Detail/Network/NameMap.h>
+#include <Theron/Detail/Network/ProcessNameRegistry.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Thread.h>
+#include <Theron/Detail/Transport/Context.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4127)  // conditional expression is constant
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+namespace Detail
+{
+class FlatMessage;
+class MessageSender;
+class NetworkMessage;
+}
+
+
+class Actor;
+class Framework;
+class ICompressor;
+class Receiver;
+
+
+/**
+\brief Network communication object.
+
+Enables communication with actors in other processes and on remote hosts.
+A single instance of this class must be constructed in each application that
+is intended to be used in a collection of distributed applications in distributed
+computing.
+
+If an EndPoint is created then it must outlive any frameworks, actors and receivers
+that are tied to it.
+*/
+class EndPoint
+{
+public:
+
+    friend class Actor;
+    friend class Framework;
+    friend class Receiver;
+    friend class Detail::MessageSender;
+
+    /**
+    \brief Parameters structure that can be passed to the EndPoint constructor.
+
+    Controls the coalescing of small outgoing messages into batches. Sending
+    each message individually costs a socket operation per message, which caps
+    throughput for workloads dominated by small messages. Instead the network
+    thread accumulates outgoing messages into a single framed batch, sent when
+    it reaches a size threshold or has been held back for longer than a time
+    threshold. Batching trades a small amount of added latency, bounded by the
+    time threshold, for significantly higher small-message throughput.
+
+    Also controls the number of network threads servicing the endpoint. By
+    default a single thread drives all socket traffic, which can saturate a
+    core on endpoints fanned out to many peers. When more threads are
+    configured, each remote connection is assigned to one of the threads by a
+    hash of its address, and each thread receives on its own input socket, so
+    receive throughput scales with cores like the worker pool does. The
+    transport's internal I/O threads are scaled to match.
+    */
+    struct Parameters
+    {
+        inline Parameters() :
+          mBatchSizeThreshold(65536),
+          mBatchTimeoutMilliseconds(2),
+          mNetworkThreadCount(1),
+          mDeliveryThreadCount(0),
+          mChunkSizeBytes(256 * 1024),
+          mSendWindowBytes(64 * 1024),
+          mJournalPath(0),
+          mJournalSizeBytes(16 * 1024 * 1024),
+          mFlatWireFormat(false),
+          mSequencedDelivery(false),
+          mCompressor(0)
+        {
+        }
+
+        uint32_t mBatchSizeThreshold;           ///< Maximum size in bytes of a coalesced batch of outgoing messages.
+        uint32_t mBatchTimeoutMilliseconds;     ///< Approximate maximum time an outgoing message is held back for batching.
+        uint32_t mNetworkThreadCount;           ///< Number of network threads; connections are sharded over them by address hash.
+
+        /**
+        \brief Number of delivery threads deserializing received messages.
+
+        By default the network threads themselves rebuild each received
+        message from its serialized form and deliver it to the destination
+        mailbox, so on inbound-heavy endpoints deserialization can bottleneck
+        on the receiving thread long before the worker pool saturates. When
+        delivery threads are configured, the network threads do framing only:
+        each received frame is handed to one of the delivery threads, which
+        run message construction and mailbox delivery in parallel. Frames
+        are assigned to delivery threads by a hash of the sending actor's
+        name, so the messages of any one sender are rebuilt and delivered
+        in order by a single thread, preserving per-sender message ordering.
+        Zero, the default, delivers on the network threads as before.
+        */
+        uint32_t mDeliveryThreadCount;
+
+        /**
+        \brief Chunk size in bytes for streaming of large message payloads.
+
+        Outgoing payloads larger than this are streamed through the socket as a
+        pipeline of fixed-size chunk parts instead of a single monolithic part,
+        bounding the transport's internal buffering and overlapping the
+        transmission of early chunks with the framing of later ones. The chunks
+        reference the message data in place, so are not copied on send, and are
+        reassembled transparently on the receiving endpoint. Zero disables
+        chunking, sending every payload as a single part.
+        */
+        uint32_t mChunkSizeBytes;
+
+        /**
+        \brief Maximum bytes framed from one destination's outbound lane per round.
+
+        Outgoing messages are held in per-destination lanes rather than a
+        single shared queue, and the network thread services the lanes
+        round-robin, framing at most this many bytes from each lane before
+        moving to the next. A deep backlog destined for one slow peer
+        therefore no longer delays messages queued behind it for other
+        destinations: each destination's traffic is framed at its own pace,
+        bounded per round by this window. Order is preserved per destination.
+        */
+        uint32_t mSendWindowBytes;
+
+        /**
+        \brief Path of an optional journal file recording sent network messages.
+
+        When non-null, the network thread appends every serialized message
+        frame it sends to a memory-mapped ring file at this path, for later
+        audit or replay with \ref ReplayJournal. The frames are copied once
+        into the mapped region as they are serialized; the operating system
+        writes the pages back to disk behind the scenes, so journaling never
+        blocks the network thread on I/O. When the ring fills, the oldest
+        records are overwritten. Null by default, disabling the journal.
+
+        \note The path is only read during endpoint construction, when the
+        journal file is opened, so the string can be destroyed afterwards.
+        */
+        const char *mJournalPath;
+
+        /**
+        \brief Size in bytes of the journal ring, when a journal path is set.
+
+        Bounds the journal file size and so the window of history it retains;
+        older records are overwritten once the ring fills.
+        */
+        uint32_t mJournalSizeBytes;
+
+        /**
+        \brief Enables the flat wire format for outgoing network messages.
+
+        The generic wire format identifies the type of each message by its
+        registered name string, which the receiving endpoint interns and
+        matches against its registrations by string comparison, per message.
+        With the flat format enabled, outgoing frames instead carry the 32-bit
+        hash the type name is interned with, which the receiver looks up
+        directly, so serialization of a registered message is a header write
+        and a single flat copy of the message value.
+
+        Receiving endpoints decode both formats regardless of this setting,
+        distinguishing them by a marker word at the start of each frame, so
+        the format can be enabled on one endpoint at a time. Only enable it
+        once every endpoint in the fleet runs a version of this library that
+        recognizes the flat frames; the frames carry a format version, so
+        receivers detect and skip frames from future revisions of the layout
+        rather than misreading them. Disabled by default.
+        */
+        bool mFlatWireFormat;
+
+        /**
+        \brief Enables per-connection sequence numbering of outgoing frames.
+
+        The network layer retries delivery on reconnect, so remote messages
+        can reach their destination actors more than once. With sequencing
+        enabled, every outgoing frame is prepended with a small envelope
+        carrying an identifier of this endpoint and a monotonically
+        increasing sequence number, and receiving endpoints drop frames
+        whose sequence numbers they have already seen from the same sender,
+        within a fixed-size window of recent sequence numbers per sender.
+        Duplicates arising from at-least-once redelivery are thereby dropped
+        once, centrally, in constant time, instead of by deduplication maps
+        in every receiving actor.
+
+        Receiving endpoints decode sequenced and unsequenced frames alike,
+        regardless of this setting, distinguishing them by a marker word, so
+        sequencing can be enabled on one endpoint at a time. Frames older
+        than the receiver's window of recent sequence numbers are assumed to
+        be late replays and dropped; the window comfortably covers the
+        transport's redelivery depth. Disabled by default.
+        */
+        bool mSequencedDelivery;
+
+        /**
+        \brief Optional compression codec for coalesced message batches.
+
+        When non-null, the network thread compresses each coalesced batch of
+        small outgoing messages as a whole before sending it, and falls back
+        to sending the batch raw whenever the codec fails to shrink it. On
+        bandwidth-bound links carrying compressible traffic, compressing at
+        the batch level recovers the redundancy between small messages that
+        would individually be too short to compress.
+
+        Compressed batches are self-describing, distinguished from raw frames
+        by a marker word, so endpoints with and without a codec can share a
+        network -- but an endpoint receiving a compressed batch must itself
+        have a codec configured, and every configured endpoint must use the
+        same codec. Null by default, disabling compression.
+
+        Large payloads sent zero-copy bypass the batching path and are never
+        compressed.
+
+        \note The codec is called from the endpoint's network threads and
+        must be thread-safe; see \ref ICompressor. The codec must outlive
+        the endpoint.
+        */
+        ICompressor *mCompressor;
+    };
+
+    /**
+    \brief Explicit constructor.
+
+    Constructs a EndPoint with the given parameters.
+
+    \param name String name for the endpoint, required to be unique.
+    \param location String defining the network location to which the endpoint is bound.
+    \param params Optional parameters object containing initialization parameters.
+
+    \note The name defined on construction should be globally unique across all connected hosts.
+    The name and location parameters are copied, so can be destroyed after the call.
+
+    \code
+    int main(int argc, char *argv[])
+    {
+        // Create a local endpoint using a local IP address provided as a command-line parameter.
+        char buffer[256];
+        sprintf(buffer, "tcp://%s:5556", argv[1]);
+        Theron::EndPoint endPoint("client", buffer);
+
+        // Connect to the remote endpoint at an IP address provided as a second command-line parameter.
+        sprintf(buffer, "tcp://%s:5555", argv[2]);
+        if (!endPoint.Connect(buffer))
+        {
+            printf("ERROR: Connection failed - check networking is enabled.\n");
+            return 1;
+        }
+
+        // Construct a framework tied to the local endpoint.
+        Theron::Framework framework(endPoint);
+    }
+    \endcode
+    */
+    EndPoint(const char *const name, const char *const location, const Parameters params = Parameters());
+
+    /**
+    Destructor.
+    */
+    ~EndPoint();
+
+    /**
+    \brief Gets the name of the EndPoint instance.
+    The name is defined on construction and should be globally unique across all connected hosts.
+    */
+    inline const char *GetName() const;
+
+    /**
+    \brief Connects this EndPoint object to another (remote) EndPoint object.
+
+    The remote EndPoint is typically on another host, connected to the local one by a
+    network connection. It is also possible to use this mechanism to connect different
+    processes on the same host.
+
+    The format of the address parameter is "tcp://192.168.10.104:5555" where "192.168.10.104" is the
+    IP address of the remote host and "5555" is the number of the network port on the remote host
+    to which the remote EndPoint is assigned.
+
+    \param address Unique network address (IP address and port) of the remote EndPoint instance.
+    \return True, if the connection succeeded.
+
+    \code
+    int main(int argc, char *argv[])
+    {
+        // Create a local endpoint using a local IP address provided as a command-line parameter.
+        char buffer[256];
+        sprintf(buffer, "tcp://%s:5556", argv[1]);
+        Theron::EndPoint endPoint("client", buffer);
+
+        // Connect to the remote endpoint at an IP address provided as a second command-line parameter.
+        sprintf(buffer, "tcp://%s:5555", argv[2]);
+        if (!endPoint.Connect(buffer))
+        {
+            printf("ERROR: Connection failed - check networking is enabled.\n");
+            return 1;
+        }
+
+        // Construct a framework tied to the local endpoint.
+        Theron::Framework framework(endPoint);
+    }
+    \endcode
+    */
+    bool Connect(const char *const address);
+
+    /**
+    \brief Replays journaled messages from a time window back into local frameworks.
+
+    Reads the journal file written by an endpoint constructed with
+    \ref Parameters::mJournalPath and re-delivers the recorded messages whose
+    send timestamps fall within the given window, through the same path as
+    messages received from the network: each message is rebuilt from its
+    serialized form and delivered to the mailboxes registered locally under
+    its recorded destination name.
+
+    Only message types known to this endpoint can be rebuilt: types registered
+    with \ref THERON_REGISTER_MESSAGE and handled by an actor or receiver tied
+    to the endpoint. Records of unknown types, and records addressed to names
+    not published locally, are skipped, as they are on receive. The journal
+    can be replayed into the endpoint that wrote it or into a fresh endpoint
+    in another process.
+
+    \param path Path of the journal file to read.
+    \param startMicroseconds Start of the window, in microseconds since the Unix epoch; zero replays from the oldest record.
+    \param endMicroseconds End of the window, inclusive; zero replays to the newest record.
+    \return The number of messages delivered, or zero if the journal couldn't be read.
+    */
+    uint32_t ReplayJournal(
+        const char *const path,
+        const uint64_t startMicroseconds = 0,
+        const uint64_t endMicroseconds = 0);
+
+private:
+
+    // Request structure used to represent a request to send a message to a (remote or local) name.
+    class SendRequest : public Detail::Queue<SendRequest>::Node
+    {
+    public:
+
+        inline explicit SendRequest(Detail::IMessage *const message, const Detail::String &name) :
+          mMessage(message),
+          mName(name)
+        {
+        }
+
+        Detail::IMessage *const mMessage;       ///< The allocated message.
+        Detail::String mName;                   ///< The destination name.
+
+    private:
+
+        SendRequest(const SendRequest &other);
+        SendRequest &operator=(const SendRequest &other);
+    };
+
+    // Per-thread state of one network thread. Each shard services the remote
+    // connections assigned to it by address hash, receiving on its own input
+    // socket. The first shard additionally owns the bound output socket and
+    // services outgoing send requests.
+    class NetworkShard
+    {
+    public:
+
+        inline NetworkShard() :
+          mEndPoint(0),
+          mIndex(0),
+          mThread(),
+          mStarted(false),
+          mLock(),
+          mConnectQueue(),
+          mDedupWindows(),
+          mBuilderCache()
+        {
+        }
+
+        EndPoint *mEndPoint;                            ///< The endpoint serviced by this shard.
+        uint32_t mIndex;                                ///< Index of this shard within the endpoint.
+        Detail::Thread mThread;                         ///< The network thread servicing this shard.
+        bool mStarted;                                  ///< Flag used to signal that the shard's thread has started.
+        Detail::SpinLock mLock;                         ///< Thread-safe access to the shard's queues.
+        Detail::RingQueue<Detail::String> mConnectQueue;    ///< Locations of connection requests assigned to this shard, in host::port format.
+
+        // A remote sender's connection is serviced by a single shard, so the
+        // dedup windows are accessed only by the shard's own network thread.
+        Detail::DedupWindowSet mDedupWindows;           ///< Windows of recent sequence numbers, used to drop duplicates of sequenced frames.
+
+        // Frames delivered inline are deserialized on the shard's own network
+        // thread, so the cache of resolved message types is accessed only by it.
+        Detail::MessageFactory::BuilderCache mBuilderCache; ///< Cache of resolved message type lookups.
+
+    private:
+
+        NetworkShard(const NetworkShard &other);
+        NetworkShard &operator=(const NetworkShard &other);
+    };
+
+    // A received frame queued for deserialization on a delivery thread.
+    // The frame data, and any out-of-frame payload, are copied into the same
+    // allocation directly after the item, since the transport's receive buffer
+    // is reused as soon as the network thread receives the next frame.
+    class DeliveryWorkItem : public Detail::Queue<DeliveryWorkItem>::Node
+    {
+    public:
+
+        inline DeliveryWorkItem(const uint32_t frameSize, const uint32_t payloadSize, const bool flat) :
+          mFrameSize(frameSize),
+          mPayloadSize(payloadSize),
+          mFlat(flat)
+        {
+        }
+
+        THERON_FORCEINLINE uint8_t *FrameData()
+        {
+            return reinterpret_cast<uint8_t *>(this + 1);
+        }
+
+        THERON_FORCEINLINE uint8_t *PayloadData()
+        {
+            return FrameData() + mFrameSize;
+        }
+
+        uint32_t mFrameSize;                    ///< Size in bytes of the copied frame.
+        uint32_t mPayloadSize;                  ///< Size in bytes of the copied out-of-frame payload; zero when the payload is within the frame.
+        bool mFlat;                             ///< Whether the frame is a flat-format message rather than a generic one.
+
+    private:
+
+        DeliveryWorkItem(const DeliveryWorkItem &other);
+        DeliveryWorkItem &operator=(const DeliveryWorkItem &other);
+    };
+
+    // Per-thread state of one delivery thread. Each delivery thread
+    // deserializes and delivers the frames of the senders assigned to it by
+    // name hash, so the messages of any one sender are delivered in order.
+    class DeliveryWorker
+    {
+    public:
+
+        inline DeliveryWorker() :
+          mEndPoint(0),
+          mThread(),
+          mStarted(false),
+          mStop(false),
+          mLock(),
+          mWorkQueue(),
+          mBuilderCache()
+        {
+        }
+
+        EndPoint *mEndPoint;                            ///< The endpoint serviced by this worker.
+        Detail::Thread mThread;                         ///< The delivery thread servicing this worker's queue.
+        bool mStarted;                                  ///< Flag used to signal that the worker's thread has started.
+        bool mStop;                                     ///< Flag used to terminate the worker's thread, once its queue is drained.
+        Detail::SpinLock mLock;                         ///< Thread-safe access to the work queue.
+        Detail::Queue<DeliveryWorkItem> mWorkQueue;     ///< Queue of received frames awaiting deserialization and delivery.
+        Detail::MessageFactory::BuilderCache mBuilderCache; ///< Cache of resolved message types; accessed only by the worker's thread.
+
+    private:
+
+        DeliveryWorker(const DeliveryWorker &other);
+        DeliveryWorker &operator=(const DeliveryWorker &other);
+    };
+
+    EndPoint(const EndPoint &other);
+    EndPoint &operator=(const EndPoint &other);
+
+    /**
+    \brief Acquires a pointer to the single network context within the local process.
+    All EndPoint objects created within a process share the same network context.
+    This allows them to communicate using local 'inproc' network communication.
+    \param ioThreadCount Number of internal transport I/O threads, applied only
+    when the call actually creates the context.
+    \return Pointer to the single Context instance, which is created if need be.
+    */
+    static Detail::Context *InitializeContext(const uint32_t ioThreadCount);
+
+    /**
+    Releases a reference to the single network context within the local process.
+    */
+    static void ReleaseContext();
+
+     /**
+    \brief Associates a mailbox index with a given string name.
+    \note Mailbox names must be unique.
+    */
+    inline bool Register(const Detail::String &name, const Detail::Index &index);
+
+    /**
+    \brief Removes the association of a mailbox index with the given string name.
+    */
+    inline bool Deregister(const Detail::String &name);
+
+    /**
+    \brief Looks up the mailbox index registered with the given name, if any.
+    */
+    inline bool Lookup(const Detail::String &name, Detail::Index &index) const;
+
+    /**
+    \brief Returns the version of the name registrations, which changes whenever a name is registered or deregistered.
+    \note Allows resolved lookups to be cached and cheaply validated.
+    */
+    inline uint32_t GetNameVersion() const;
+
+    /**
+    Registers a message type for serialization on the network, so it can be sent in network messages.
+    The message type must have been registered by means of \ref THERON_REGISTER_MESSAGE.
+    */
+    template <class ValueType>
+    inline bool RegisterMessageType();
+
+    /**
+    Sends the given allocated message to the mailboxes with the given published name.
+    */
+    bool RequestSend(Detail::IMessage *const message, const Detail::String &name);
+
+    /**
+    Builds a Theron message from a received network message and delivers it to
+    the mailboxes registered locally under the destination name, if any.
+    \return True, if the message was built and delivered.
+    */
+    bool DeliverReceivedMessage(
+        Detail::MessageFactory::BuilderCache &builderCache,
+        const Detail::NetworkMessage *const networkMessage,
+        const void *const messageData);
+
+    /**
+    Builds a Theron message from a received flat-format message and delivers it
+    to the mailboxes registered locally under the destination name, if any.
+    \return True, if the message was built and delivered.
+    */
+    bool DeliverReceivedFlatMessage(
+        Detail::MessageFactory::BuilderCache &builderCache,
+        const Detail::FlatMessage *const flatMessage,
+        const void *const messageData);
+
+    /**
+    Delivers a received frame, either inline on the calling network thread or,
+    when delivery threads are configured, by copying it onto the queue of the
+    delivery thread assigned to the sending actor's name.
+    */
+    void DispatchReceivedFrame(
+        Detail::MessageFactory::BuilderCache &builderCache,
+        const void *const frameData,
+        const uint32_t frameSize,
+        const bool flat,
+        const void *const messageData,
+        const uint32_t messageSize);
+
+    /**
+    Hashes a remote endpoint address to the index of the shard that services it.
+    */
+    uint32_t HashLocation(const char *const address) const;
+
+    static void NetworkThreadEntryPoint(void *const context);
+    void NetworkThreadProc(NetworkShard *const shard);
+
+    static void DeliveryThreadEntryPoint(void *const context);
+    void DeliveryThreadProc(DeliveryWorker *const worker);
+
+    static Detail::SpinLock smContextLock;              ///< Ensures thread-safe access to the per-process network context.
+    static uint32_t smContextRefCount;                  ///< Context object reference count.
+    static Detail::Context *smContext;                  ///< Pointer the single per-process network context object.
+
+    Parameters mParams;                                 ///< Parameters defined on construction.
+    Detail::String mName;                               ///< Name of the this endpoint, unique across all hosts.
+    Detail::String mLocation;                           ///< Unique network location (eg. IP address and port) of the endpoint.
+    Detail::Context *mContext;                          ///< Pointer to per-process network context object.
+    Detail::NameMap mNameMap;                           ///< Map of published names to addresses.
+    Detail::MessageFactory mMessageFactory;             ///< Builds messages from serialized data blocks.
+    Detail::MessageJournal mJournal;                    ///< Optional write-behind journal of sent message frames.
+    NetworkShard *mShards;                              ///< Per-thread shards, each servicing a subset of the connections.
+    uint32_t mNumShards;                                ///< Number of network threads servicing this endpoint.
+    DeliveryWorker *mDeliveryWorkers;                   ///< Per-thread delivery workers, each deserializing the frames of a subset of the senders.
+    uint32_t mNumDeliveryWorkers;                       ///< Number of delivery threads; zero when frames are delivered on the network threads.
+    /**
+    Number of outbound send lanes. Send requests are assigned to lanes by a
+    hash of their destination name, so each destination's requests are held
+    in FIFO order within one lane, and the lanes are serviced round-robin.
+    A power of two, so the hash can be folded with a mask.
+    */
+    static const uint32_t NUM_SEND_LANES = 16;
+
+    bool mRunning;                                      ///< Flag used to terminate the network threads.
+    uint64_t mSendSequence;                             ///< Sequence number of the last sequenced frame sent; touched only by the sending network thread.
+    Detail::SpinLock mNetworkLock;                      ///< Thread-safe access to the send lanes.
+    Detail::Queue<SendRequest> mSendLanes[NUM_SEND_LANES];  ///< Per-destination lanes of send requests, serviced round-robin by the first shard.
+};
+
+
+THERON_FORCEINLINE const char *EndPoint::GetName() const
+{
+    return mName.GetValue();
+}
+
+
+template <class ValueType>
+inline bool EndPoint::RegisterMessageType()
+{
+    // Constant expression - may need to disable a warning ...
+    if (Detail::MessageTraits<ValueType>::HAS_TYPE_NAME)
+    {
+        const Detail::String name(Detail::MessageTraits<ValueType>::TYPE_NAME);
+        mMessageFactory.Register<ValueType>(name);
+
+        return true;
+    }
+
+    return false;
+}
+
+
+THERON_FORCEINLINE bool EndPoint::Register(const Detail::String &name, const Detail::Index &index)
+{
+    // Remove any existing entry for the name.
+    if (!mNameMap.Remove(name))
+    {
+        return false;
+    }
+
+    // Insert the new entry.
+    if (!mNameMap.Insert(name, index))
+    {
+        return false;
+    }
+
+    // Mirror the entry into the process-wide registry, so senders in other
+    // frameworks of this process can resolve the name to its local mailbox
+    // and deliver directly, bypassing the network transport's loopback.
+    if (!Detail::ProcessNameRegistry::Remove(name) ||
+        !Detail::ProcessNameRegistry::Insert(name, index))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+THERON_FORCEINLINE bool EndPoint::Deregister(const Detail::String &name)
+{
+    // Remove any existing entry for the name.
+    if (!mNameMap.Remove(name))
+    {
+        return false;
+    }
+
+    // Remove the mirrored entry from the process-wide registry.
+    if (!Detail::ProcessNameRegistry::Remove(name))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+THERON_FORCEINLINE bool EndPoint::Lookup(const Detail::String &name, Detail::Index &index) const
+{
+    return mNameMap.Get(name, index);
+}
+
+
+THERON_FORCEINLINE uint32_t EndPoint::GetNameVersion() const
+{
+    return mNameMap.GetVersion();
+}
+
+
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_ENDPOINT_H
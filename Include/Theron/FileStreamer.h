@@ -0,0 +1,679 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_FILESTREAMER_H
+#define THERON_FILESTREAMER_H
+
+
+/**
+\file FileStreamer.h
+Actor that streams the contents of disk files as zero-copy chunk messages.
+*/
+
+
+#include <new>
+
+#include <Theron/Actor.h>
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/Framework.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push,0)
+#endif //_MSC_VER
+
+#if THERON_WINDOWS
+
+#include <windows.h>
+
+#elif defined(THERON_POSIX)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+/**
+\brief An actor that streams the contents of disk files as chunk messages.
+
+Actors that ingest large files typically read each chunk into a buffer and
+then copy it again into a message, paying two copies per chunk. A
+FileStreamer memory-maps the requested file once and sends \ref FileChunk
+messages whose data pointers refer directly into the shared mapping, so
+handlers read the file contents in place and no chunk is ever copied. The
+mapping is reference-counted by the chunks referring into it, and is
+unmapped when the last outstanding chunk is destructed.
+
+Chunk delivery is flow-controlled: at most \ref Parameters::mMaxChunksInFlight
+chunks are outstanding per stream, and the consumer acknowledges each chunk
+with a \ref ChunkAck to release the next one, so a slow consumer bounds the
+memory pinned by its stream instead of being buried in messages.
+
+\code
+class Consumer : public Theron::Actor
+{
+public:
+
+    explicit Consumer(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+        RegisterHandler(this, &Consumer::Handler);
+    }
+
+private:
+
+    void Handler(const Theron::FileStreamer::FileChunk &chunk, const Theron::Address from)
+    {
+        // Read chunk.mSize bytes in place at chunk.mData, then release it.
+        Send(Theron::FileStreamer::ChunkAck(chunk.mSequence), from);
+    }
+};
+
+Theron::FileStreamer streamer(framework);
+Theron::Consumer consumer(framework);
+
+// Chunks are sent to the requesting address, so request on the consumer's behalf.
+framework.Send(
+    Theron::FileStreamer::ReadRequest("data.bin"),
+    consumer.GetAddress(),
+    streamer.GetAddress());
+\endcode
+
+The streamer serves multiple concurrent streams, distinguished by the
+requesting address, but at most one stream per requester at a time; a request
+from an address whose stream is still active fails. A request that names an
+unreadable file, or a second stream for an active requester, is answered
+with a single final chunk whose \ref FileChunk::mFailed flag is set.
+
+\note The whole file is mapped for the duration of its stream, so streaming
+files larger than the available address space is not supported.
+*/
+class FileStreamer : public Actor
+{
+public:
+
+    /**
+    \brief Parameters accepted by the constructor, controlling streaming behavior.
+    */
+    struct Parameters
+    {
+        /**
+        \brief Default constructor.
+        */
+        inline Parameters() :
+          mChunkSize(65536),
+          mMaxChunksInFlight(4),
+          mReadAhead(true)
+        {
+        }
+
+        uint32_t mChunkSize;            ///< Size of the chunks sent to consumers, in bytes.
+        uint32_t mMaxChunksInFlight;    ///< Maximum number of unacknowledged chunks per stream.
+        bool mReadAhead;                ///< Whether to advise the OS to read ahead of the mapped accesses.
+    };
+
+    /**
+    \brief A reference-counted file mapping shared by the chunks of one stream.
+
+    \note An internal type; chunks manage their mapping references automatically.
+    */
+    class Mapping
+    {
+    public:
+
+        /**
+        Constructor. The initial reference is owned by the caller.
+        */
+        inline Mapping(void *const base, const uint64_t size) :
+          mBase(base),
+          mSize(size),
+          mReferenceCount(1)
+        {
+        }
+
+        /**
+        Takes a reference to the mapping.
+        */
+        THERON_FORCEINLINE void Reference()
+        {
+            mReferenceCount.Increment();
+        }
+
+        /**
+        Returns the base address of the mapped file contents.
+        */
+        THERON_FORCEINLINE const unsigned char *GetBase() const
+        {
+            return static_cast<const unsigned char *>(mBase);
+        }
+
+        /**
+        Releases a reference to the mapping, unmapping the file and destroying
+        the mapping when the last reference is released.
+        */
+        inline void Dereference()
+        {
+            if (mReferenceCount.FetchDecrement() == 1)
+            {
+
+#if THERON_WINDOWS
+
+                UnmapViewOfFile(mBase);
+
+#elif defined(THERON_POSIX)
+
+                munmap(mBase, static_cast<size_t>(mSize));
+
+#endif
+
+                IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+                this->~Mapping();
+                allocator->Free(this, sizeof(Mapping));
+            }
+        }
+
+    private:
+
+        Mapping(const Mapping &other);
+        Mapping &operator=(const Mapping &other);
+
+        void *mBase;                                ///< Base address of the mapped file contents.
+        uint64_t mSize;                             ///< Size of the mapping in bytes.
+        Detail::Atomic::UInt32 mReferenceCount;     ///< Number of chunks and streams referencing the mapping.
+    };
+
+    /**
+    \brief Message requesting that a file be streamed to the sender.
+
+    The chunks of the stream are sent to the 'from' address of the request.
+
+    \note The requester owns the name string, which is referenced rather than
+    copied, so must remain valid until the request is processed.
+    */
+    struct ReadRequest
+    {
+        /**
+        \brief Explicit constructor.
+        */
+        inline explicit ReadRequest(const char *const fileName = 0) : mFileName(fileName)
+        {
+        }
+
+        const char *mFileName;      ///< Name of the file to be streamed.
+    };
+
+    /**
+    \brief Message carrying one chunk of a streamed file.
+
+    The data pointer refers directly into the shared mapping of the file,
+    which remains mapped at least until the chunk is destructed, so handlers
+    read the chunk contents in place without copying them.
+    */
+    struct FileChunk
+    {
+        /**
+        \brief Default constructor.
+        */
+        inline FileChunk() :
+          mData(0),
+          mSize(0),
+          mOffset(0),
+          mSequence(0),
+          mFinal(false),
+          mFailed(false),
+          mMapping(0)
+        {
+        }
+
+        /**
+        \brief Copy constructor; shares the referenced mapping.
+        */
+        inline FileChunk(const FileChunk &other) :
+          mData(other.mData),
+          mSize(other.mSize),
+          mOffset(other.mOffset),
+          mSequence(other.mSequence),
+          mFinal(other.mFinal),
+          mFailed(other.mFailed),
+          mMapping(other.mMapping)
+        {
+            if (mMapping)
+            {
+                mMapping->Reference();
+            }
+        }
+
+        /**
+        \brief Assignment operator; shares the referenced mapping.
+        */
+        inline FileChunk &operator=(const FileChunk &other)
+        {
+            if (other.mMapping)
+            {
+                other.mMapping->Reference();
+            }
+
+            if (mMapping)
+            {
+                mMapping->Dereference();
+            }
+
+            mData = other.mData;
+            mSize = other.mSize;
+            mOffset = other.mOffset;
+            mSequence = other.mSequence;
+            mFinal = other.mFinal;
+            mFailed = other.mFailed;
+            mMapping = other.mMapping;
+
+            return *this;
+        }
+
+        /**
+        \brief Destructor; releases the reference to the mapping.
+        */
+        inline ~FileChunk()
+        {
+            if (mMapping)
+            {
+                mMapping->Dereference();
+            }
+        }
+
+        const unsigned char *mData;     ///< Pointer to the chunk contents within the shared mapping; zero in failed or empty chunks.
+        uint32_t mSize;                 ///< Size of the chunk in bytes.
+        uint64_t mOffset;               ///< Offset of the chunk within the file.
+        uint32_t mSequence;             ///< Zero-based sequence number of the chunk within its stream.
+        bool mFinal;                    ///< Whether this is the last chunk of the stream.
+        bool mFailed;                   ///< Whether the stream failed; only ever set in a final chunk.
+        Mapping *mMapping;              ///< The shared mapping the chunk data refers into.
+    };
+
+    /**
+    \brief Message acknowledging a received chunk, releasing the next one.
+
+    Consumers send one acknowledgement per received chunk back to the
+    streamer once they have finished reading the chunk contents.
+    */
+    struct ChunkAck
+    {
+        /**
+        \brief Explicit constructor.
+        */
+        inline explicit ChunkAck(const uint32_t sequence = 0) : mSequence(sequence)
+        {
+        }
+
+        uint32_t mSequence;     ///< Sequence number of the acknowledged chunk.
+    };
+
+    /**
+    \brief Constructs a FileStreamer within the given framework.
+    */
+    inline explicit FileStreamer(Framework &framework, const Parameters &params = Parameters()) :
+      Actor(framework),
+      mParams(params),
+      mStreams(0)
+    {
+        THERON_ASSERT(mParams.mChunkSize);
+        THERON_ASSERT(mParams.mMaxChunksInFlight);
+
+        RegisterHandler(this, &FileStreamer::HandleRead);
+        RegisterHandler(this, &FileStreamer::HandleAck);
+    }
+
+    /**
+    \brief Destructor.
+    Abandons any active streams, releasing their mappings. Chunks already
+    sent remain valid until destructed, since they hold their own references.
+    */
+    inline ~FileStreamer()
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        while (mStreams)
+        {
+            StreamState *const stream(mStreams);
+            mStreams = stream->mNext;
+
+            stream->mMapping->Dereference();
+            allocator->Free(stream, sizeof(StreamState));
+        }
+    }
+
+private:
+
+    /**
+    The state of one active stream.
+    */
+    struct StreamState
+    {
+        Address mClient;            ///< Address the chunks of the stream are sent to.
+        Mapping *mMapping;          ///< The shared mapping of the streamed file.
+        uint64_t mFileSize;         ///< Size of the streamed file in bytes.
+        uint64_t mNextOffset;       ///< Offset of the next unsent chunk.
+        uint32_t mNextSequence;     ///< Sequence number of the next unsent chunk.
+        uint32_t mChunksInFlight;   ///< Number of sent chunks not yet acknowledged.
+        StreamState *mNext;         ///< Next stream in the list of active streams.
+    };
+
+    /**
+    Handler for read requests; maps the file and starts the stream.
+    */
+    inline void HandleRead(const ReadRequest &message, const Address from)
+    {
+        // At most one stream per requester, since streams are keyed by address.
+        if (message.mFileName == 0 || FindStream(from))
+        {
+            SendFailure(from);
+            return;
+        }
+
+        uint64_t fileSize(0);
+        bool failed(false);
+        Mapping *const mapping(MapFile(message.mFileName, fileSize, failed));
+
+        if (failed)
+        {
+            SendFailure(from);
+            return;
+        }
+
+        // An empty file has no mappable contents; complete it with one empty chunk.
+        if (mapping == 0)
+        {
+            FileChunk chunk;
+            chunk.mFinal = true;
+
+            Send(chunk, from);
+            return;
+        }
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->Allocate(sizeof(StreamState)));
+
+        if (memory == 0)
+        {
+            mapping->Dereference();
+            SendFailure(from);
+            return;
+        }
+
+        StreamState *const stream(new (memory) StreamState());
+
+        stream->mClient = from;
+        stream->mMapping = mapping;
+        stream->mFileSize = fileSize;
+        stream->mNextOffset = 0;
+        stream->mNextSequence = 0;
+        stream->mChunksInFlight = 0;
+        stream->mNext = mStreams;
+        mStreams = stream;
+
+        // Fill the in-flight window; the stream may complete immediately if
+        // the whole file fits within it.
+        FillWindow(stream);
+    }
+
+    /**
+    Handler for chunk acknowledgements; releases further chunks of the stream.
+    */
+    inline void HandleAck(const ChunkAck &/*message*/, const Address from)
+    {
+        // Acknowledgements of the trailing chunks of a completed stream
+        // arrive after the stream state has been retired, and are ignored.
+        StreamState *const stream(FindStream(from));
+        if (stream)
+        {
+            THERON_ASSERT(stream->mChunksInFlight);
+            --stream->mChunksInFlight;
+
+            FillWindow(stream);
+        }
+    }
+
+    /**
+    Sends unsent chunks of the stream until the in-flight window is full,
+    retiring the stream once its final chunk has been sent.
+    */
+    inline void FillWindow(StreamState *const stream)
+    {
+        while (stream->mNextOffset < stream->mFileSize)
+        {
+            if (stream->mChunksInFlight >= mParams.mMaxChunksInFlight)
+            {
+                return;
+            }
+
+            const uint64_t remaining(stream->mFileSize - stream->mNextOffset);
+            const uint32_t chunkSize(remaining < mParams.mChunkSize ? static_cast<uint32_t>(remaining) : mParams.mChunkSize);
+
+            FileChunk chunk;
+
+            chunk.mData = stream->mMapping->GetBase() + stream->mNextOffset;
+            chunk.mSize = chunkSize;
+            chunk.mOffset = stream->mNextOffset;
+            chunk.mSequence = stream->mNextSequence;
+            chunk.mFinal = (remaining == chunkSize);
+            chunk.mMapping = stream->mMapping;
+            stream->mMapping->Reference();
+
+            stream->mNextOffset += chunkSize;
+            ++stream->mNextSequence;
+            ++stream->mChunksInFlight;
+
+            Send(chunk, stream->mClient);
+        }
+
+        // All chunks have been sent, so the stream state is no longer needed.
+        // The chunks themselves keep the mapping alive until they're destructed.
+        RemoveStream(stream);
+    }
+
+    /**
+    Sends a final, failed chunk to the given address.
+    */
+    inline void SendFailure(const Address client)
+    {
+        FileChunk chunk;
+        chunk.mFinal = true;
+        chunk.mFailed = true;
+
+        Send(chunk, client);
+    }
+
+    /**
+    Finds the active stream for the given requester, if any.
+    */
+    inline StreamState *FindStream(const Address client) const
+    {
+        for (StreamState *stream(mStreams); stream; stream = stream->mNext)
+        {
+            if (stream->mClient == client)
+            {
+                return stream;
+            }
+        }
+
+        return 0;
+    }
+
+    /**
+    Removes the given stream from the list of active streams and destroys it.
+    */
+    inline void RemoveStream(StreamState *const stream)
+    {
+        StreamState **link(&mStreams);
+        while (*link != stream)
+        {
+            link = &(*link)->mNext;
+        }
+
+        *link = stream->mNext;
+
+        stream->mMapping->Dereference();
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        allocator->Free(stream, sizeof(StreamState));
+    }
+
+    /**
+    Maps the named file read-only, returning the mapping and its size.
+    \return The reference-counted mapping; zero for an empty file, or on
+    failure, in which case the failed flag is set.
+    */
+    inline Mapping *MapFile(const char *const fileName, uint64_t &fileSize, bool &failed) const
+    {
+        void *base(0);
+        fileSize = 0;
+        failed = true;
+
+#if THERON_WINDOWS
+
+        const HANDLE file(CreateFileA(
+            fileName,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            0,
+            OPEN_EXISTING,
+            mParams.mReadAhead ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL,
+            0));
+
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return 0;
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            return 0;
+        }
+
+        fileSize = static_cast<uint64_t>(size.QuadPart);
+
+        if (fileSize)
+        {
+            const HANDLE mapping(CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0));
+            if (mapping)
+            {
+                base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+                // The view holds its own reference to the mapping object.
+                CloseHandle(mapping);
+            }
+        }
+
+        CloseHandle(file);
+
+        if (fileSize && base == 0)
+        {
+            fileSize = 0;
+            return 0;
+        }
+
+#elif defined(THERON_POSIX)
+
+        const int file(open(fileName, O_RDONLY));
+        if (file < 0)
+        {
+            return 0;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            return 0;
+        }
+
+        fileSize = static_cast<uint64_t>(status.st_size);
+
+        if (fileSize)
+        {
+            base = mmap(0, static_cast<size_t>(fileSize), PROT_READ, MAP_PRIVATE, file, 0);
+            if (base == MAP_FAILED)
+            {
+                base = 0;
+            }
+        }
+
+        // The mapping holds its own reference to the open file.
+        close(file);
+
+        if (fileSize && base == 0)
+        {
+            fileSize = 0;
+            return 0;
+        }
+
+        if (base)
+        {
+            // Readahead control: sequential access prefetches ahead of the
+            // stream, while random access disables speculative readahead.
+            posix_madvise(
+                base,
+                static_cast<size_t>(fileSize),
+                mParams.mReadAhead ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+        }
+
+#endif
+
+        failed = false;
+
+        if (fileSize == 0)
+        {
+            // An empty file maps successfully to no contents; the caller
+            // completes its stream immediately with a single empty chunk.
+            return 0;
+        }
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->Allocate(sizeof(Mapping)));
+
+        if (memory == 0)
+        {
+
+#if THERON_WINDOWS
+            UnmapViewOfFile(base);
+#elif defined(THERON_POSIX)
+            munmap(base, static_cast<size_t>(fileSize));
+#endif
+
+            fileSize = 0;
+            failed = true;
+            return 0;
+        }
+
+        return new (memory) Mapping(base, fileSize);
+    }
+
+    FileStreamer(const FileStreamer &other);
+    FileStreamer &operator=(const FileStreamer &other);
+
+    const Parameters mParams;       ///< Parameters the streamer was constructed with.
+    StreamState *mStreams;          ///< List of active streams.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_FILESTREAMER_H
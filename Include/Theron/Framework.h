@@ -1,1157 +1,4359 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_FRAMEWORK_H
-#define THERON_FRAMEWORK_H
-
-
-/**
-\file Framework.h
-Framework that hosts and executes actors.
-*/
-
-
-#include <new>
-
-#include <Theron/ActorRef.h>
-#include <Theron/Address.h>
-#include <Theron/Align.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Counters.h>
-#include <Theron/Defines.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Alignment/ActorAlignment.h>
-#include <Theron/Detail/Allocators/CachingAllocator.h>
-#include <Theron/Detail/Containers/List.h>
-#include <Theron/Detail/Debug/BuildDescriptor.h>
-#include <Theron/Detail/Directory/Directory.h>
-#include <Theron/Detail/Directory/Entry.h>
-#include <Theron/Detail/Handlers/DefaultFallbackHandler.h>
-#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
-#include <Theron/Detail/Legacy/ActorRegistry.h>
-#include <Theron/Detail/Mailboxes/Mailbox.h>
-#include <Theron/Detail/Messages/MessageCreator.h>
-#include <Theron/Detail/Messages/MessageSender.h>
-#include <Theron/Detail/MailboxProcessor/Processor.h>
-#include <Theron/Detail/MailboxProcessor/ThreadPool.h>
-#include <Theron/Detail/Network/String.h>
-#include <Theron/Detail/Threading/Atomic.h>
-#include <Theron/Detail/Threading/SpinLock.h>
-#include <Theron/Detail/Threading/Thread.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
-#pragma warning (disable:4996)  // function or variable may be unsafe
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-
-
-class Actor;
-class EndPoint;
-
-
-/**
-\brief Enumerates the available worker thread yield strategies.
-
-Each \ref Theron::Framework contains a pool of worker threads that are used to execute
-the actors hosted in the framework. The worker threads service a queue, processing actors that
-have received messages and executing their registered message handlers.
-
-When constructing a Framework, a \ref Theron::Framework::Parameters object may be provided with
-parameters that control the structure and behavior of the the framework's internal threadpool.
-This enum defines the available values of the \ref Theron::Framework::Parameters::mYieldStrategy "mYieldStrategy"
-member of the Parameters structure.
-
-The mYieldStrategy member defines the strategy that the worker threads use to avoid \em busy \em waiting
-on the work queue. The available strategies have different performance characteristics, and are best
-suited to different kinds of applications.
-
-The default strategy, \ref YIELD_STRATEGY_POLITE,
-causes the threads to go to sleep for a short period when they fail to find work on the work queue.
-Going to sleep frees up the processor during quiet periods and so gives other threads on the system
-a chance to be executed. The downside is that if a message arrives after a period of inactivity then
-it may only be processed when one or more threads awake, leading to some small latency.
-
-The more aggressive strategies cause the threads to yield to other threads, or simply spin, without going to
-sleep. These strategies typically have lower worst-case latency. However the reduced latency is at
-the expense of increased CPU usage, increased power consumption, and potentially lower throughput.
-
-When choosing a yield strategy it pays to consider how important immediate responsiveness is to your
-application: in most applications a latency of a few milliseconds is not significant, and the default
-strategy is a reasonable choice.
-*/
-enum YieldStrategy
-{
-    YIELD_STRATEGY_POLITE,              ///< Threads go to sleep when not in use.
-    YIELD_STRATEGY_STRONG,              ///< Threads yield to other threads but don't go to sleep.
-    YIELD_STRATEGY_AGGRESSIVE           ///< Threads never sleep or yield to other threads.
-};
-
-
-/**
-\brief Manager class that hosts, manages, and executes actors.
-
-Users should construct an instance of the Framework in non-actor application
-code before creating any actors. Actor objects can then be created by passing
-the framework as a parameter to the constructor of the derived actor class:
-
-\code
-class MyActor : public Theron::Actor
-{
-public:
-
-    explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-    {
-    }
-};
-
-Theron::Framework framework;
-MyActor myActor(framework);
-\endcode
-
-Internally, each framework contains a pool of worker threads which are used
-to execute the message handlers of the actors created within it. The threads
-within a framework are dedicated to executing actors within that framework,
-and are never used to execute actors in other frameworks or any other user code.
-
-The initial number of worker threads can be specified on construction of the
-framework by means of an explicit parameter to the Framework::Framework constructor.
-Additionally, the number of threads can be increased or decreased at runtime
-by calling \ref SetMinThreads or \ref SetMaxThreads. The utilization of the currently
-enabled threads is measured by performance metrics, queried by \ref GetCounterValue
-and enumerated by \ref Theron::Counter.
-
-The worker threads are created and synchronized using underlying threading
-objects. Different implementations of these threading objects are possible,
-allowing Theron to be used in environments with different threading primitives.
-Currently, implementations based on Win32 threads, Boost threads, std::thread
-and POSIX threads are provided. Users can define \ref THERON_BOOST or
-\ref THERON_CPP11 to enable or disable the use of boost::thread and std::thread,
-respectively.
-
-It's possible to construct multiple Framework objects within a single
-application. The actors created within each Framework are processed
-by separate pools of worker threads. Actor addresses are globally unique
-across all frameworks. Actors in one framework can send messages to actors
-in other frameworks.
-
-Actors created within each Framework are executed only by the worker threads
-in the threadpool of that framework, allowing the threads of a Framework to
-be effectively dedicated to particular actors. See
-\ref Theron::Framework::Parameters for more information.
-
-\note An important point about Framework objects is that they must always
-outlive the actors created within them.
-*/
-class Framework : public Detail::Entry::Entity
-{
-public:
-
-    friend class Actor;
-    friend class ActorRef;
-    friend class Detail::MessageSender;
-
-    /**
-    \brief Parameters structure that can be passed to the Framework constructor.
-    
-    When an instance of this structure is passed to the constructor of the Framework class,
-    its members can be used to configure the constructed framework.
-
-    The members are mainly concerned with configuring the pool of worker threads that is created
-    within the framework, and which is used to execute the actors that are subsequently hosted
-    within it. They allow the user to control the number of threads in the pool, their processor
-    affinities, and their yielding behavior.
-    
-    By choosing appropriate values it's possible to configure specialized frameworks tailored to
-    particular uses. For example, users writing real-time systems might choose to create a separate
-    framework for hosting actors whose execution is time-critical. Such a framework might be configured
-    with the same number of threads as the number of hosted actors, ensuring that a free thread is
-    always available to process actors with queued messages. Also, one might choose to dedicate a
-    number of processor cores entirely to the execution of those threads, using processor
-    affinity masks to limit execution of the worker threads of the framework to only the selected
-    cores (leaving the remaining cores to other frameworks). Finally, since the cores dedicated to
-    time-critical processing are never used for any other processing, one might choose to set the yield
-    strategy of the worker threads to \ref YIELD_STRATEGY_AGGRESSIVE, effectively busy-waiting for
-    the arrival of new messages.
-
-    As well as setting processor affinities, the members of the Parameters structure allow the
-    node affinities of the worker threads to be controlled. This allows users to restrict
-    the execution of a framework's worker threads to a particular \em node within a NUMA
-    (Non-Uniform Memory Architecture) system.
-
-    A NUMA system is one in which the different logical cores within the physical CPU(s) have
-    different views of memory, typically by virtue of being serviced by different physical memory
-    controllers. In such systems, memory may be partitioned into areas that are each directly
-    accessed by a single memory controller, with the cores fed by that controller enjoying faster
-    access to that area of memory. Access to other parts of memory is indirectly served by other
-    controllers, so is slower. Within the context of a NUMA system, a 'node' is a group of logical
-    cores that share the same view of memory (typically by virtue of being serviced by the same
-    memory controller).
-    
-    Windows and Linux both provide APIs by which the node topology of a system can be discovered. These
-    APIs allow the processor affinities of threads to be set on a per-node basis, limiting threads
-    to execute only on the processors of a particular nodes (or set of nodes). Finally, they provide
-    methods for allocating memory within the area of memory to which a particular node has first class
-    access.
-
-    The scalability of a multi-threaded application can be improved by restricting threads that access
-    the same memory to execute only on a limited subset of the available cores. Doing so can improve
-    cache coherency due to the same memory being repeatedly accessed via the caches of those cores.
-
-    As threads read and write memory, cached copies of the memory accumulate in the caches local
-    to the cores on which the threads are executed. When a thread writes to memory, any cached copies held
-    in the caches of other cores are invalidated and must be re-fetched from memory. If other threads
-    also write to the same piece of memory (known as \em shared \em writes), then the repeated cache
-    invalidations and refreshes can cause significant overheads. These overheads can be especially
-    severe, and can limit scalability, if the threads in question are allowed to execute on different
-    NUMA nodes.
-
-    In Theron, Frameworks serve as the mechanism by which worker threads are grouped. Accordingly,
-    Theron allows the node and processor affinities of worker threads to be set on a per-framework
-    basis. The expectation is that the actors within a single framework will mainly message
-    each other, with messages being sent between frameworks far less frequently.
-
-    \note Support for node and processor affinity masks is currently somewhat limited.
-    Supported is implemented with Windows NUMA API in windows builds, and with libnuma under linux.
-    In GCC builds, NUMA support requires libnuma-dev and must be explicitly enabled via \ref THERON_NUMA
-    (or numa=on in the makefile). The \ref mNodeMask member is supported with both version 1 and version 2
-    of the libnuma API, but the \ref mProcessorMask member is supported only with version 2. Under Windows
-    both members are supported.
-    */
-    struct Parameters
-    {
-        /**
-        \brief Constructor.
-        Constructs a parameters object with a specified initial thread count, running on a specified
-        subset of the processors of each of a specified set of NUMA processor nodes.
-
-        \param threadCount Number of worker threads to create initially within the framework.
-        \param nodeMask Bitfield mask specifying the NUMA node affinity of the created worker threads.
-        \param processorMask Bitfield mask specifying the processor affinity of the created worker threads within each enabled NUMA node.
-        \param yieldStrategy Enum value specifying how freely worker threads yield to other system threads.
-        */
-        inline explicit Parameters(
-            const uint32_t threadCount = 16,
-            const uint32_t nodeMask = 0x1,
-            const uint32_t processorMask = 0xFFFFFFFF,
-            const YieldStrategy yieldStrategy = YIELD_STRATEGY_POLITE) :
-          mThreadCount(threadCount),
-          mNodeMask(nodeMask),
-          mProcessorMask(processorMask),
-          mYieldStrategy(yieldStrategy)
-        {
-        }
-
-        uint32_t mThreadCount;          ///< The initial number of worker threads to create within the framework.
-        uint32_t mNodeMask;             ///< Specifies the NUMA processor nodes upon which the framework may execute.
-        uint32_t mProcessorMask;        ///< Specifies the subset of the processors in each NUMA processor node upon which the framework may execute.
-        YieldStrategy mYieldStrategy;   ///< Strategy that defines how freely worker threads yield to other system threads.
-    };
-
-    /**
-    \brief Constructor.
-
-    Constructs a framework with the given number of worker threads.
-
-    \note This constructor is deprecated. Use the \ref Parameters structure instead.
-
-    \code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    Theron::Framework frameworkOne(8);
-    MyActor actorOne(frameworkOne);
-
-    Theron::Framework frameworkTwo(12);
-    MyActor actorTwo(frameworkTwo);
-    \endcode
-    */
-    inline explicit Framework(const uint32_t threadCount);
-
-    /**
-    \brief Constructor.
-
-    Constructs a framework with the given parameters. The parameters
-    control the size and processor affinity of a framework's threadpool.
-
-    \code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    const Theron::Framework::Parameters params(8);
-    Theron::Framework framework(params);
-
-    MyActor actorOne(framework);
-    MyActor actorTwo(framework);
-    \endcode
-
-    \note In distributed applications, use the constructor variant that accepts an \ref EndPoint.
-    */
-    inline explicit Framework(const Parameters &params = Parameters());
-
-    /**
-    \brief Constructor.
-
-    Constructs a framework object with the given parameters, tied to the given network endpoint.
-    A framework that is tied to a network endpoint is able to send messages to, and receive
-    messages from, remote actors hosted in frameworks tied to other endpoints.
-
-    \code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    const Theron::EndPoint::Parameters params("endpoint_one", "tcp://192.168.10.104:5555");
-    Theron::EndPoint endPoint(params);
-
-    Theron::Framework framework(endPoint, "framework_one");
-    MyActor actorOne(framework);
-    \endcode
-
-    \param endPoint The endpoint to which the framework instance is tied.
-    \param name An optional user-defined name for the framework, which must be unique within the context of the endpoint.
-    \param params Optional parameters object providing construction parameters.
-
-    \note The name string parameter is copied, so can be destroyed after the call.
-    */
-    inline Framework(EndPoint &endPoint, const char *const name = 0, const Parameters &params = Parameters());
-
-    /**
-    \brief Destructor.
-
-    Destroys a Framework.
-
-    A Framework must always outlive (ie. be destructed after) any actors created within
-    it. Specifically, all actors created within a Framework must have been destructed
-    themselves before the Framework itself is allowed to be destructed.
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    main()
-    {
-        Theron::Framework framework;
-        Actor *actor = new Actor(framework);
-
-        // Must delete (ie. destruct) the actor before the Framework hosting it!
-        delete actor;
-    }
-    \endcode
-
-    \note If a Framework instance is allowed to be destructed before actors created within
-    it, the actors will not be correctly destroyed, leading to errors or memory leaks.
-    */
-    inline ~Framework();
-
-    /**
-    \brief Sends a message to the entity (typically an actor, but potentially a Receiver) at the given address.
-
-    \code
-    class Actor : public Theron::Actor
-    {
-    public:
-
-        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    Theron::Framework framework;
-    Theron::Receiver receiver;
-    Actor actor(framework);
-
-    framework.Send(std::string("Hello"), receiver.GetAddress(), actor.GetAddress());
-    \endcode
-
-    If no actor or receiver exists with the given address, the message will not be
-    delivered, and Send will return false.
-
-    This can happen if the target entity is an actor but has been destructed due to
-    going out of scope (if it was constructed as a local on the stack) or explicitly
-    deleted (if it was constructed on the heap via operator new).
-
-    If the destination address exists, but the receiving entity has no handler
-    registered for messages of the sent type, then the message will be ignored,
-    but this method will still return true. Note that a true return value doesn't
-    necessarily imply that the message was actually handled by the actor.
-
-    In either event, if the message is not actually handled by an actor, the default
-    \ref Framework::SetFallbackHandler "fallback handler" will assert to alert the
-    user about the unhandled message.
-
-    \note This method is used mainly to send messages from non-actor code, eg. main(),
-    where only a Framework instance is available. In such cases, the address of a receiver
-    is typically passed as the 'from' address. When sending messages from within an actor,
-    it is more natural to use \ref Actor::Send, where the address of the sending actor is
-    implicit.
-
-    \tparam ValueType The message type.
-    \param value The message value.
-    \param from The address of the sending entity (typically a receiver).
-    \param address The address of the target entity (an actor or a receiver).
-    \return True, if the message was delivered to an entity, otherwise false.
-    */
-    template <typename ValueType>
-    inline bool Send(const ValueType &value, const Address &from, const Address &address);
-
-    /**
-    \brief Specifies a maximum limit on the number of worker threads enabled in this framework.
-
-    This method allows an application to place an upper bound on the thread count.
-    Users can use this method, together with SetMinThreads, to implement a policy for
-    framework threadpool management.
-
-    This method will only decrease the actual number of worker threads, never increase it.
-    Calling this method is guaranteed to eventually result in the number of threads being
-    less than or equal to the specified limit, as long as messages continue to be sent and
-    unless a higher minimum limit is specified subsequently.
-
-    If two successive calls specify different maximums, the lower takes effect. If
-    conflicting minimum and maximums are specified by subsequent calls to this method
-    and SetMinThreads, then the later call wins.
-
-    The idea behind separate minimum and maximum limits, rather than a single method to
-    directly set the actual number of threads, is to allow negotiation between multiple
-    agents, each with a different interest in the thread count. One may require a certain
-    minimum number of threads for its processing, but not care if the actual number of
-    threads is higher, while another may wish to impose a maximum limit on the number of
-    threads in existence, but be satisfied if there are less.
-
-    \note If the number of threads before the call was higher than the requested maximum,
-    there may be an arbitrary delay after calling this method before the number of threads
-    drops to the requested value. The number of threads is managed over time, and is not
-    guaranteed to be less than or equal to the requested maximum immediately after the call.
-    Threads self-terminate on being woken, if they discover that the actual thread count
-    is higher than the limit. This means that until some threads are woken by the arrival
-    of new messages, the actual thread count will remain unchanged.
-
-    \param count A positive integer - behavior for zero is undefined.
-
-    \see SetMinThreads
-    */
-    void SetMaxThreads(const uint32_t count);
-
-    /**
-    \brief Specifies a minimum limit on the number of worker threads enabled in this framework.
-
-    This method allows an application to place a lower bound on the thread count.
-    Users can use this method, together with SetMaxThreads, to implement a policy for
-    framework threadpool management.
-
-    This method will only increase the actual number of worker threads, never reduce it.
-    Calling this method is guaranteed to eventually result in the number of threads being
-    greater than or equal to the specified limit, unless a lower maximum limit is specified
-    subsequently.
-
-    If two successive calls specify different minimums, the higher takes effect. If
-    conflicting minimum and maximums are specified by subsequent calls to this method
-    and SetMaxThreads, then the later call wins.
-
-    \note If the number of threads before the call was lower than the requested minimum,
-    there may be an arbitrary delay after calling this method before the number of threads rises
-    to the requested value. Threads are spawned or re-enabled by a manager thread dedicated
-    to that task, which runs asynchronously from other threads as a background task.
-    It spends most of its time asleep, only being woken by calls to SetMinThreads.
-
-    \param count A positive integer - behavior for zero is undefined.
-
-    \see SetMaxThreads
-    */
-    void SetMinThreads(const uint32_t count);
-
-    /**
-    \brief Returns the current maximum limit on the number of worker threads in this framework.
-
-    This method returns the current maximum limit on the size of the worker threadpool.
-    Setting a maximum thread limit with SetMaxThreads doesn't imply that that limit will be
-    returned by this function. The target thread count is negotiated over multiple calls,
-    and specifying a higher value than the current maximum may have no effect.
-
-    \note In the current implementation, GetMaxThreads and GetMinThreads return the same
-    value, which is the current target thread count. Note that this may be different from
-    the actual current number of threads, returned by GetNumThreads.
-
-    \see GetMinThreads
-    */
-    uint32_t GetMaxThreads() const;
-
-    /**
-    \brief Returns the current minimum limit on the number of worker threads in this framework.
-
-    This method returns the current minimum limit on the size of the worker threadpool.
-    Setting a minimum thread limit with SetMinThreads doesn't imply that that limit will be
-    returned by this function. The target thread count is negotiated over multiple calls,
-    and specifying a lower value than the current minimum may have no effect.
-
-    \see GetMaxThreads
-    */
-    uint32_t GetMinThreads() const;
-
-    /**
-    \brief Gets the actual number of worker threads currently in this framework.
-
-    The returned count reflects the actual number of enabled threads at the time of the
-    call, which is independent from any maximum or minimum limits specified with
-    SetMaxThreads or SetMinThreads. The count includes all enabled threads, including any
-    that are sleeping due to having no work to do, but not including ones which were
-    created earlier but subsequently terminated to reduce the thread count.
-
-    \note The value returned by this method is specific to this framework instance. If
-    multiple frameworks are created then each has its own threadpool with an independently
-    managed thread count.
-
-    \see GetPeakThreads
-    */
-    uint32_t GetNumThreads() const;
-
-    /**
-    \brief Gets the peak number of worker threads ever active in the framework.
-
-    This call queries the highest number of simultaneously enabled threads seen since the
-    start of the framework. Note that this measures the highest actual number of threads,
-    as measured by GetNumThreads, rather than the highest values of the maximum or minimum
-    thread count limits.
-
-    \note The value returned by this method is specific to this framework instance. If
-    multiple frameworks are created then each has its own threadpool with an independently
-    managed thread count.
-    */
-    uint32_t GetPeakThreads() const;
-
-    /**
-    \brief Resets the \ref Counter "internal event counters".
-
-    \see Counter
-    \see GetCounterValue
-    */
-    void ResetCounters() const;
-
-    /**
-    \brief Gets the current value of a specified event counter.
-
-    Each Framework maintains a set of \ref Counter "internal event counters".
-    This method gets the current value of a specific counter, aggregated over all worker threads.
-
-    \param counter One of several values of an \ref Counter "enumerated type" identifying the available counters.
-    \return Current value of the counter at the time of the call.
-
-    \see GetPerThreadCounterValues
-    \see ResetCounters
-    */
-    uint32_t GetCounterValue(const Counter counter) const;
-
-    /**
-    \brief Gets the current per-thread values of a specified event counter.
-
-    Each Framework maintains a set of \ref Counter "internal event counters".
-    This method gets the current value of the counter for each of the currently active worker threads.
-
-    \param counter One of several values of an \ref Counter "enumerated type" identifying the available counters.
-    \param perThreadCounts Pointer to an array of uint32_t to be filled with per-thread counter values.
-    \param maxCounts The size of the perThreadCounts array and hence the maximum number of values to fetch.
-    \return The actual number of per-thread values fetched, matching the number of currently active worker threads.
-
-    \see GetCounterValue
-    \see ResetCounters
-    */
-    uint32_t GetPerThreadCounterValues(const Counter counter, uint32_t *const perThreadCounts, const uint32_t maxCounts) const;
-
-    /**
-    \brief Sets the fallback message handler executed for unhandled messages.
-
-    The fallback handler registered with the framework is run:
-    - when a message is sent by an actor within this framework to an address at which no entity is currently registered.
-    - when a message is sent using the \ref Send method of this framework to an address at which no entity is currently registered.
-    - when a message is delivered to an actor within this framework in which neither a handler for that message type nor a default handler are registered, with the result that the message goes unhandled.
-
-    The main purpose of the fallback handler is for error reporting, and the default
-    fallback handler, which is used if no user-defined handler is explicitly set,
-    asserts to indicate an unhandled message, which is a common programming error.
-    The reporting of unhandled messages by the default fallback handler can be controlled
-    by the \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define, whose default value is
-    defined in \ref Defines.h.
-
-    The handler function registered by this method overload is represented by a pointer to
-    a user-defined handler object, and a member function pointer identifying a handler
-    function that is a member function of the handler object. Handlers registered using
-    this method must expose a handler method that accepts a 'from' address, as shown by
-    the following example:
-
-    \code
-    class Handler
-    {
-    public:
-
-        inline void Handle(const Theron::Address from)
-        {
-            printf("Caught undelivered or unhandled message sent from address '%d'\n", from.AsInteger());
-        }
-    };
-
-    Theron::Framework framework;
-    Handler handler;
-    framework.SetFallbackHandler(&handler, &Handler::Handle);
-    \endcode
-
-    Users can call this method to replace the default fallback handler with their own
-    implementation, for example for more sophisticated error reporting or logging.
-
-    Passing 0 to this method clears any previously set fallback handler, or the
-    default fallback handler if no user-defined handler has previously been set.
-
-    \note There are two variants of SetFallbackHandler, accepting fallback handlers
-    with different function signatures. Handlers set using this method accept only a
-    'from' address, whereas handlers set using the other method also accept the 
-    unhandled message as 'blind' data (ie. a void pointer and a size in bytes).
-    Registering either kind of fallback handler replaces any previously set handler
-    of the other kind.
-
-    \tparam ObjectType The type of the handler object which owns the handler function.
-    \param actor Pointer to the handler object on which the handler function is a member function.
-    \param handler Member function pointer identifying the fallback handler function.
-    */
-    template <typename ObjectType>
-    inline bool SetFallbackHandler(
-        ObjectType *const actor,
-        void (ObjectType::*handler)(const Address from));
-
-    /**
-    \brief Sets the fallback message handler executed for unhandled messages.
-
-    This method sets a 'blind' default handler which, when executed, is passed the
-    unknown message as blind data. The blind data consists of the memory block containing
-    the message, identified by a void pointer and a size.
-
-    The fallback handler registered with the framework is run:
-    - when a message is sent by an actor within this framework to an address at which no entity is currently registered.
-    - when a message is sent using the \ref Send method of this framework to an address at which no entity is currently registered.
-    - when a message is delivered to an actor within this framework in which neither a handler for that message type nor a default handler are registered, with the result that the message goes unhandled.
-
-    The handler function registered by this method overload is passed the unhandled message
-    as 'blind' data represented by a void pointer and a message size in bytes. Handlers
-    registered using this method must expose a handler method that accepts a void pointer
-    identifying the message contents, a size indicating the size of the message data, and a
-    'from' address.
-
-    A user-defined handler may be able to inspect the contents of the message and
-    take appropriate action, such as reporting the contents of an unexpected message to help
-    with debugging.
-
-    \code
-    class Handler
-    {
-    public:
-
-        inline void Handle(const void *const data, const Theron::uint32_t size, const Theron::Address from)
-        {
-            printf("Caught undelivered or unhandled message of size %d sent from address '%d'\n", size, from.AsInteger());
-        }
-    };
-
-    Theron::Framework framework;
-    Handler handler;
-    framework.SetFallbackHandler(&handler, &Handler::Handle);
-    \endcode
-
-    Users can call this method to replace the default fallback handler with their own
-    implementation, for example for more sophisticated error reporting or logging.
-
-    Passing 0 to this method clears any previously set fallback handler, or the
-    default fallback handler if no user-defined handler has previously been set.
-
-    \note There are two variants of SetFallbackHandler, accepting fallback handlers
-    with different function signatures. Handlers set using this method accept the 
-    unhandled message as 'blind' data (ie. a void pointer and a size in bytes),
-    whereas handlers set using the other method accept only the 'from' address.
-    Registering either kind of fallback handler replaces any previously set handler
-    of the other kind.
-
-    \tparam ObjectType The type of the handler object which owns the handler function.
-    \param actor Pointer to the handler object on which the handler function is a member function.
-    \param handler Member function pointer identifying the fallback handler function.
-    */
-    template <typename ObjectType>
-    inline bool SetFallbackHandler(
-        ObjectType *const actor,
-        void (ObjectType::*handler)(const void *const data, const uint32_t size, const Address from));
-
-    /**
-    \brief Deprecated method provided for backwards compatibility.
-
-    \note In versions of Theron from 4.0 onwards, there is no need to use this method.
-    It is provided only for backwards compatibility.
-
-    In versions of Theron prior to 4.0, actors couldn't be constructed directly
-    in user code. Instead you had to ask a Framework to create one for you, using
-    the CreateActor method template. Instead of returning the actor itself,
-    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
-    object.
-
-    \code
-    // LEGACY CODE!
-    class MyActor : public Theron::Actor
-    {
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        Theron::ActorRef actorRef(framework.CreateActor<MyActor>());
-    }
-    \endcode
-
-    In versions of Theron starting with 4.0, Actors are first-class citizens and
-    behave like vanilla C++ objects. They can be constructed directly with no
-    call to Framework::CreateActor. Once constructed they are referenced directly
-    by user code with no need for ActorRef proxy objects.
-
-    When writing new code, follow the new, simpler construction pattern where actors
-    are constructed directly and not referenced by ActorRefs:
-
-    \code
-    // New code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        MyActor actor(framework);
-    }
-    \endcode
-    */
-    template <class ActorType>
-    ActorRef CreateActor();
-
-    /**
-    \brief Deprecated method provided for backwards compatibility.
-
-    \note In versions of Theron from 4.0 onwards, there is no need to use this method.
-    It is provided only for backwards compatibility.
-
-    In versions of Theron prior to 4.0, actors couldn't be constructed directly
-    in user code. Instead you had to ask a Framework to create one for you, using
-    the CreateActor method template. Instead of returning the actor itself,
-    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
-    object.
-
-    \code
-    // LEGACY CODE!
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        struct Parameters
-        {
-            int mSomeParameter;
-        }
-
-        MyActor(const Parameters &params)
-        {
-        }
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        MyActor::Parameters params;
-        params.mSomeParameter = 0;
-        Theron::ActorRef actorRef(framework.CreateActor<MyActor>(params));
-    }
-    \endcode
-
-    When writing new code, follow the new, simpler construction pattern where actors
-    are constructed directly and not referenced by ActorRefs:
-
-    \code
-    // New code
-    class MyActor : public Theron::Actor
-    {
-    public:
-
-        MyActor(Theron::Framework &framework, const int mSomeParameter) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    int main()
-    {
-        Theron::Framework framework;
-        MyActor actor(framework, 0);
-    }
-    \endcode
-    */
-    template <class ActorType>
-    ActorRef CreateActor(const typename ActorType::Parameters &params);
-
-private:
-
-    typedef Detail::ThreadPool<Detail::Processor, Detail::Processor::Context> ThreadPool;
-    typedef Detail::List<ThreadPool::ThreadContext> ContextList;
-    typedef Detail::CachingAllocator<32, Detail::SpinLock> MessageCache;
-
-    Framework(const Framework &other);
-    Framework &operator=(const Framework &other);
-
-    /**
-    Initializes a framework object at start of day.
-    This function is called by the various constructor flavors and avoids repeating the code.
-    */
-    void Initialize();
-
-    /**
-    Tears down a framework object prior to destruction.
-    */
-    void Release();
-
-    /**
-    Gets the non-zero index of this framework, unique within the local process.
-    */
-    inline uint32_t GetIndex() const;
-
-    /**
-    Registers a new actor in the directory and allocates a mailbox.
-    */
-    void RegisterActor(Actor *const actor, const char *const name = 0);
-
-    /**
-    Deregisters a previously registered actor.
-    */
-    void DeregisterActor(Actor *const actor);
-
-    /**
-    Receives a message from another framework.
-    */
-    inline bool FrameworkReceive(
-        Detail::IMessage *const message,
-        const Address &address);
-
-    /**
-    Checks whether all work queues in the framework are empty.
-    */
-    bool QueuesEmpty() const;
-
-    /**
-    Static entry point function for the manager thread.
-    This is a static function that calls the real entry point member function.
-    */
-    static void ManagerThreadEntryPoint(void *const context);
-
-    /**
-    Entry point member function for the manager thread.
-    */
-    void ManagerThreadProc();
-
-    EndPoint *const mEndPoint;                              ///< Pointer to the network endpoint, if any, to which this framework is tied.
-    const Parameters mParams;                               ///< Copy of parameters struct provided on construction.
-    uint32_t mIndex;                                        ///< Non-zero index of this framework, unique within the local process.
-    Detail::String mName;                                   ///< Name of this framework.
-    Detail::Directory<Detail::Mailbox> mMailboxes;          ///< Per-framework mailbox array.
-    Detail::FallbackHandlerCollection mFallbackHandlers;    ///< Registered message handlers run for unhandled messages.
-    Detail::DefaultFallbackHandler mDefaultFallbackHandler; ///< Default handler for unhandled messages.
-    mutable Detail::SpinLock mSharedWorkQueueSpinLock;      ///< Protects the work queue shared by the worker threads.
-    MessageCache mMessageAllocator;                         ///< Thread-safe per-framework cache of message memory blocks.
-    Detail::Processor::Context mProcessorContext;           ///< Per-framework processor context.
-    Detail::Thread mManagerThread;                          ///< Dynamically creates and destroys the worker threads.
-    bool mRunning;                                          ///< Flag used to terminate the manager thread.
-    Detail::Atomic::UInt32 mTargetThreadCount;              ///< Desired number of worker threads.
-    Detail::Atomic::UInt32 mPeakThreadCount;                ///< Peak number of worker threads.
-    Detail::Atomic::UInt32 mThreadCount;                    ///< Actual number of worker threads.
-    ContextList mThreadContexts;                            ///< List of worker thread context objects.
-    mutable Detail::SpinLock mThreadContextLock;            ///< Protects the thread context list.
-};
-
-
-inline Framework::Framework(const uint32_t threadCount) :
-  mEndPoint(0),
-  mParams(threadCount),
-  mIndex(0),
-  mName(),
-  mMailboxes(),
-  mFallbackHandlers(),
-  mDefaultFallbackHandler(),
-  mSharedWorkQueueSpinLock(),
-  mMessageAllocator(AllocatorManager::Instance().GetAllocator()),
-  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
-  mManagerThread(),
-  mRunning(false),
-  mTargetThreadCount(0),
-  mPeakThreadCount(0),
-  mThreadCount(0),
-  mThreadContexts(),
-  mThreadContextLock()
-{
-    Detail::BuildDescriptor::Check();
-
-    Initialize();
-}
-
-
-inline Framework::Framework(const Parameters &params) :
-  mEndPoint(0),
-  mParams(params),
-  mIndex(0),
-  mName(),
-  mMailboxes(),
-  mFallbackHandlers(),
-  mDefaultFallbackHandler(),
-  mSharedWorkQueueSpinLock(),
-  mMessageAllocator(AllocatorManager::Instance().GetAllocator()),
-  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
-  mManagerThread(),
-  mRunning(false),
-  mTargetThreadCount(0),
-  mPeakThreadCount(0),
-  mThreadCount(0),
-  mThreadContexts(),
-  mThreadContextLock()
-{
-    Detail::BuildDescriptor::Check();
-
-    Initialize();
-}
-
-
-inline Framework::Framework(EndPoint &endPoint, const char *const name, const Parameters &params) :
-  mEndPoint(&endPoint),
-  mParams(params),
-  mIndex(0),
-  mName(name),
-  mMailboxes(),
-  mFallbackHandlers(),
-  mDefaultFallbackHandler(),
-  mSharedWorkQueueSpinLock(),
-  mMessageAllocator(AllocatorManager::Instance().GetAllocator()),
-  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
-  mManagerThread(),
-  mRunning(false),
-  mTargetThreadCount(0),
-  mPeakThreadCount(0),
-  mThreadCount(0),
-  mThreadContexts(),
-  mThreadContextLock()
-{
-    Detail::BuildDescriptor::Check();
-
-    Initialize();
-}
-
-
-inline Framework::~Framework()
-{
-    Release();
-}
-
-
-template <typename ValueType>
-THERON_FORCEINLINE bool Framework::Send(const ValueType &value, const Address &from, const Address &address)
-{
-    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
-    IAllocator *const messageAllocator(&mMessageAllocator);
-
-    // Allocate a message. It'll be deleted by the worker thread that handles it.
-    Detail::IMessage *const message(Detail::MessageCreator::Create(messageAllocator, value, from));
-    if (message == 0)
-    {
-        return false;
-    }
-
-    // Call the message sending implementation using the processor context of the framework.
-    // When messages are sent using Framework::Send there's no obvious worker thread.
-    return Detail::MessageSender::Send(
-        mEndPoint,
-        &mProcessorContext,
-        mIndex,
-        message,
-        address);
-}
-
-
-THERON_FORCEINLINE bool Framework::FrameworkReceive(
-    Detail::IMessage *const message,
-    const Address &address)
-{
-    // Call the generic message sending function.
-    // We use our own local context here because we're receiving the message.
-    return Detail::MessageSender::Send(
-        mEndPoint,
-        &mProcessorContext,
-        mIndex,
-        message,
-        address);
-}
-
-
-template <typename ObjectType>
-inline bool Framework::SetFallbackHandler(
-    ObjectType *const handlerObject,
-    void (ObjectType::*handler)(const Address from))
-{
-    return mFallbackHandlers.Set(handlerObject, handler);
-}
-
-
-template <typename ObjectType>
-inline bool Framework::SetFallbackHandler(
-    ObjectType *const handlerObject,
-    void (ObjectType::*handler)(const void *const data, const uint32_t size, const Address from))
-{
-    return mFallbackHandlers.Set(handlerObject, handler);
-}
-
-
-THERON_FORCEINLINE uint32_t Framework::GetIndex() const
-{
-    return mIndex;
-}
-
-
-template <class ActorType>
-inline ActorRef Framework::CreateActor()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    // The actor type may need to be allocated with non-default alignment.
-    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
-    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
-
-    void *const actorMemory(allocator->AllocateAligned(actorSize, actorAlignment));
-    if (actorMemory == 0)
-    {
-        return ActorRef();
-    }
-
-    // Get the address of the Actor baseclass using some cast trickery.
-    // Note that the Actor may not always be the first baseclass, so the address may differ!
-    // The static_cast takes the offset of the Actor baseclass within ActorType into account.
-    ActorType *const pretendActor(reinterpret_cast<ActorType *>(actorMemory));
-    Actor *const actorBase(static_cast<Actor *>(pretendActor));
-
-    // Register the actor in the registry while we construct it.
-    // This stores an entry passing the actor pointers to its memory block and owning framework.
-    void *const entryMemory(allocator->Allocate(sizeof(typename Detail::ActorRegistry::Entry)));
-    if (entryMemory == 0)
-    {
-        allocator->Free(actorMemory, actorSize);
-        return ActorRef();
-    }
-
-    typename Detail::ActorRegistry::Entry *const entry = new (entryMemory) typename Detail::ActorRegistry::Entry;
-
-    entry->mActor = actorBase;
-    entry->mFramework = this;
-    entry->mMemory = actorMemory;
-
-    Detail::ActorRegistry::Register(entry);
-    
-    // Construct the actor for real in the allocated memory.
-    // The Actor picks up the registered framework pointer in its default constructor.
-    // This relies on the user not incorrectly calling the non-default Actor constructor!
-    ActorType *const actor = new (actorMemory) ActorType();
-
-    // Deregister and free the entry.
-    Detail::ActorRegistry::Deregister(entry);
-
-    allocator->Free(entryMemory, sizeof(typename Detail::ActorRegistry::Entry));
-
-    return ActorRef(actor);
-}
-
-
-template <class ActorType>
-inline ActorRef Framework::CreateActor(const typename ActorType::Parameters &params)
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    // The actor type may need to be allocated with non-default alignment.
-    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
-    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
-
-    void *const actorMemory(allocator->AllocateAligned(actorSize, actorAlignment));
-    if (actorMemory == 0)
-    {
-        return ActorRef();
-    }
-
-    // Get the address of the Actor baseclass using some cast trickery.
-    // Note that the Actor may not always be the first baseclass, so the address may differ!
-    // The static_cast takes the offset of the Actor baseclass within ActorType into account.
-    ActorType *const pretendActor(reinterpret_cast<ActorType *>(actorMemory));
-    Actor *const actorBase(static_cast<Actor *>(pretendActor));
-
-    // Register the actor in the registry while we construct it.
-    // This stores an entry passing the actor pointers to its memory block and owning framework.
-    void *const entryMemory(allocator->Allocate(sizeof(typename Detail::ActorRegistry::Entry)));
-    if (entryMemory == 0)
-    {
-        allocator->Free(actorMemory, actorSize);
-        return ActorRef();
-    }
-
-    typename Detail::ActorRegistry::Entry *const entry = new (entryMemory) typename Detail::ActorRegistry::Entry;
-
-    entry->mActor = actorBase;
-    entry->mFramework = this;
-    entry->mMemory = actorMemory;
-
-    Detail::ActorRegistry::Register(entry);
-    
-    // Construct the actor for real in the allocated memory.
-    // The Actor picks up the registered framework pointer in its default constructor.
-    // This relies on the user not incorrectly calling the non-default Actor constructor!
-    ActorType *const actor = new (actorMemory) ActorType(params);
-
-    // Deregister and free the entry.
-    Detail::ActorRegistry::Deregister(entry);
-
-    allocator->Free(entryMemory, sizeof(typename Detail::ActorRegistry::Entry));
-
-    return ActorRef(actor);
-}
-
-
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
-
-
-#endif // THERON_FRAMEWORK_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_FRAMEWORK_H
+#define THERON_FRAMEWORK_H
+
+
+/**
+\file Framework.h
+Framework that hosts and executes actors.
+*/
+
+
+#include <new>
+
+#include <Theron/Defines.h>
+
+#if THERON_CPP11
+#include <type_traits>
+#include <utility>
+#endif // THERON_CPP11
+
+#include <Theron/ActorProfile.h>
+#include <Theron/ActorRef.h>
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/AllocatorCacheStats.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Counters.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+#include <Theron/MailboxHandle.h>
+#include <Theron/MessageBuilder.h>
+#include <Theron/MessageTypeStats.h>
+#include <Theron/MetricsSink.h>
+#include <Theron/QueueWatermarkEvent.h>
+#include <Theron/RespawnSlot.h>
+
+#include <Theron/Detail/Alignment/ActorAlignment.h>
+#include <Theron/Detail/Allocators/BudgetAllocator.h>
+#include <Theron/Detail/Allocators/CachingAllocator.h>
+#include <Theron/Detail/Allocators/NumaAllocator.h>
+#include <Theron/Detail/Containers/List.h>
+#include <Theron/Detail/Debug/BuildDescriptor.h>
+#include <Theron/Detail/Directory/Directory.h>
+#include <Theron/Detail/Directory/Entry.h>
+#include <Theron/Detail/Handlers/DefaultFallbackHandler.h>
+#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
+#include <Theron/Detail/Legacy/ActorRegistry.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/Messages/IngressThrottle.h>
+#include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Messages/MessageSender.h>
+#include <Theron/Detail/Messages/SharedMessage.h>
+#include <Theron/Detail/MailboxProcessor/Processor.h>
+#include <Theron/Detail/MailboxProcessor/ThreadPool.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Condition.h>
+#include <Theron/Detail/Threading/SpinLock.h>
+#include <Theron/Detail/Threading/Thread.h>
+#include <Theron/Detail/Timers/TimerJob.h>
+#include <Theron/Detail/Timers/TimerWheel.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4324)  // structure was padded due to __declspec(align())
+#pragma warning (disable:4996)  // function or variable may be unsafe
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+
+
+class Actor;
+class EndPoint;
+
+template <typename ValueType>
+class Batcher;
+
+
+/**
+\brief Enumerates the available worker thread yield strategies.
+
+Each \ref Theron::Framework contains a pool of worker threads that are used to execute
+the actors hosted in the framework. The worker threads service a queue, processing actors that
+have received messages and executing their registered message handlers.
+
+When constructing a Framework, a \ref Theron::Framework::Parameters object may be provided with
+parameters that control the structure and behavior of the the framework's internal threadpool.
+This enum defines the available values of the \ref Theron::Framework::Parameters::mYieldStrategy "mYieldStrategy"
+member of the Parameters structure.
+
+The mYieldStrategy member defines the strategy that the worker threads use to avoid \em busy \em waiting
+on the work queue. The available strategies have different performance characteristics, and are best
+suited to different kinds of applications.
+
+The default strategy, \ref YIELD_STRATEGY_POLITE,
+causes the threads to go to sleep for a short period when they fail to find work on the work queue.
+Going to sleep frees up the processor during quiet periods and so gives other threads on the system
+a chance to be executed. The downside is that if a message arrives after a period of inactivity then
+it may only be processed when one or more threads awake, leading to some small latency.
+
+The more aggressive strategies cause the threads to yield to other threads, or simply spin, without going to
+sleep. These strategies typically have lower worst-case latency. However the reduced latency is at
+the expense of increased CPU usage, increased power consumption, and potentially lower throughput.
+
+When choosing a yield strategy it pays to consider how important immediate responsiveness is to your
+application: in most applications a latency of a few milliseconds is not significant, and the default
+strategy is a reasonable choice.
+
+The \ref YIELD_STRATEGY_BLOCKING strategy is event-driven: after spinning briefly, idle
+worker threads block on a shared condition variable, and the message sending path wakes
+a single sleeping thread whenever a mailbox is scheduled. This combines latency close to
+that of the spinning strategies with CPU usage close to that of the default strategy,
+at the cost of a small synchronization overhead on the send path when workers are asleep.
+
+The \ref YIELD_STRATEGY_ADAPTIVE strategy tunes itself between the polite and aggressive
+extremes: each worker thread maintains its own spin budget, growing it while work keeps
+arriving and decaying it during quiet periods, so busy phases get spin-level latency and
+idle phases get sleep-level CPU usage without manual intervention. Workloads with known
+phase changes can instead switch between the fixed strategies explicitly at runtime with
+\ref Framework::SetYieldStrategy.
+*/
+enum YieldStrategy
+{
+    YIELD_STRATEGY_POLITE,              ///< Threads go to sleep when not in use.
+    YIELD_STRATEGY_STRONG,              ///< Threads yield to other threads but don't go to sleep.
+    YIELD_STRATEGY_AGGRESSIVE,          ///< Threads never sleep or yield to other threads.
+    YIELD_STRATEGY_BLOCKING,            ///< Threads block on a shared condition and are woken when work arrives.
+    YIELD_STRATEGY_ADAPTIVE             ///< Threads tune their own spin budgets to the observed work arrival rate.
+};
+
+
+/**
+\brief Enumerates the scheduling policies available to the worker threads of a framework.
+
+This enum defines the available values of the \ref Theron::Framework::Parameters::mSchedulerPolicy
+"mSchedulerPolicy" member of the Parameters structure.
+
+The scheduler policy defines the order in which the worker threads of a framework select
+queued mailboxes for processing, and the order in which they try to steal work from each
+other when their own queues are empty. The policies trade cache locality against fairness
+of processing order, so different workloads favor different policies; the policy of a
+framework can be selected at construction without any change to application code, which
+makes side-by-side comparison of the policies on a live workload straightforward.
+
+The default policy, \ref SCHEDULER_POLICY_DEFAULT, prefers work whose cache state is
+likely still warm: each worker drains its own queue before taking shared work, and steals
+from workers on its own NUMA node before ones on remote nodes. This is the policy Theron
+has always used and is a reasonable choice for most workloads.
+
+The \ref SCHEDULER_POLICY_FIFO policy processes mailboxes in an order close to the order
+in which they became ready, funnelling normal-priority work through the shared queue
+rather than the per-worker queues. It trades cache locality and queue lock traffic for
+fairness, which bounds the wait of any one mailbox when the framework is saturated.
+
+The \ref SCHEDULER_POLICY_LOCALITY policy is a stricter version of the default: workers
+exhaust their own queues and those of same-node workers before touching the shared queue
+at all. It favors throughput on workloads that partition naturally across workers, at the
+cost of higher latency for work that arrives through the shared queue.
+
+Under every policy, high-priority and deadline-carrying mailboxes are drained ahead of
+all other work; the policies differ only in the ordering of normal work.
+
+\note Messages sent to a given actor are always processed in the order they were sent,
+regardless of policy. The policies order the processing of different actors' mailboxes
+relative to each other, which no Theron API makes guarantees about.
+*/
+enum SchedulerPolicy
+{
+    SCHEDULER_POLICY_DEFAULT,           ///< Local work first, then shared work, stealing same-node victims first.
+    SCHEDULER_POLICY_FIFO,              ///< Shared work in arrival order ahead of local work.
+    SCHEDULER_POLICY_LOCALITY           ///< Local and same-node work exhausted before shared work is touched.
+};
+
+
+/**
+\brief Aggregate completion message delivered by \ref Framework::ScatterGather.
+
+Delivered to the gathering entity once every message of the scatter batch has
+been either pushed to its destination mailbox or rejected, reporting how many
+were successfully delivered.
+*/
+struct ScatterGatherComplete
+{
+    inline ScatterGatherComplete() : mDelivered(0), mCount(0)
+    {
+    }
+
+    inline ScatterGatherComplete(const uint32_t delivered, const uint32_t count) :
+      mDelivered(delivered),
+      mCount(count)
+    {
+    }
+
+    uint32_t mDelivered;                ///< Number of messages successfully delivered.
+    uint32_t mCount;                    ///< Number of messages in the scatter batch.
+};
+
+
+/**
+\brief Manager class that hosts, manages, and executes actors.
+
+Users should construct an instance of the Framework in non-actor application
+code before creating any actors. Actor objects can then be created by passing
+the framework as a parameter to the constructor of the derived actor class:
+
+\code
+class MyActor : public Theron::Actor
+{
+public:
+
+    explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+    {
+    }
+};
+
+Theron::Framework framework;
+MyActor myActor(framework);
+\endcode
+
+Internally, each framework contains a pool of worker threads which are used
+to execute the message handlers of the actors created within it. The threads
+within a framework are dedicated to executing actors within that framework,
+and are never used to execute actors in other frameworks or any other user code.
+
+The initial number of worker threads can be specified on construction of the
+framework by means of an explicit parameter to the Framework::Framework constructor.
+Additionally, the number of threads can be increased or decreased at runtime
+by calling \ref SetMinThreads or \ref SetMaxThreads. The utilization of the currently
+enabled threads is measured by performance metrics, queried by \ref GetCounterValue
+and enumerated by \ref Theron::Counter.
+
+The worker threads are created and synchronized using underlying threading
+objects. Different implementations of these threading objects are possible,
+allowing Theron to be used in environments with different threading primitives.
+Currently, implementations based on Win32 threads, Boost threads, std::thread
+and POSIX threads are provided. Users can define \ref THERON_BOOST or
+\ref THERON_CPP11 to enable or disable the use of boost::thread and std::thread,
+respectively.
+
+It's possible to construct multiple Framework objects within a single
+application. The actors created within each Framework are processed
+by separate pools of worker threads. Actor addresses are globally unique
+across all frameworks. Actors in one framework can send messages to actors
+in other frameworks.
+
+Actors created within each Framework are executed only by the worker threads
+in the threadpool of that framework, allowing the threads of a Framework to
+be effectively dedicated to particular actors. See
+\ref Theron::Framework::Parameters for more information.
+
+\note An important point about Framework objects is that they must always
+outlive the actors created within them.
+*/
+class Framework : public Detail::Entry::Entity
+{
+public:
+
+    friend class Actor;
+    friend class ActorRef;
+    friend class ActorRefView;
+    friend class Detail::MessageSender;
+
+    template <typename BatchValueType>
+    friend class Batcher;
+
+    template <class BuilderValueType>
+    friend class MessageBuilder;
+
+    /**
+    \brief Parameters structure that can be passed to the Framework constructor.
+    
+    When an instance of this structure is passed to the constructor of the Framework class,
+    its members can be used to configure the constructed framework.
+
+    The members are mainly concerned with configuring the pool of worker threads that is created
+    within the framework, and which is used to execute the actors that are subsequently hosted
+    within it. They allow the user to control the number of threads in the pool, their processor
+    affinities, and their yielding behavior.
+    
+    By choosing appropriate values it's possible to configure specialized frameworks tailored to
+    particular uses. For example, users writing real-time systems might choose to create a separate
+    framework for hosting actors whose execution is time-critical. Such a framework might be configured
+    with the same number of threads as the number of hosted actors, ensuring that a free thread is
+    always available to process actors with queued messages. Also, one might choose to dedicate a
+    number of processor cores entirely to the execution of those threads, using processor
+    affinity masks to limit execution of the worker threads of the framework to only the selected
+    cores (leaving the remaining cores to other frameworks). Finally, since the cores dedicated to
+    time-critical processing are never used for any other processing, one might choose to set the yield
+    strategy of the worker threads to \ref YIELD_STRATEGY_AGGRESSIVE, effectively busy-waiting for
+    the arrival of new messages.
+
+    As well as setting processor affinities, the members of the Parameters structure allow the
+    node affinities of the worker threads to be controlled. This allows users to restrict
+    the execution of a framework's worker threads to a particular \em node within a NUMA
+    (Non-Uniform Memory Architecture) system.
+
+    A NUMA system is one in which the different logical cores within the physical CPU(s) have
+    different views of memory, typically by virtue of being serviced by different physical memory
+    controllers. In such systems, memory may be partitioned into areas that are each directly
+    accessed by a single memory controller, with the cores fed by that controller enjoying faster
+    access to that area of memory. Access to other parts of memory is indirectly served by other
+    controllers, so is slower. Within the context of a NUMA system, a 'node' is a group of logical
+    cores that share the same view of memory (typically by virtue of being serviced by the same
+    memory controller).
+    
+    Windows and Linux both provide APIs by which the node topology of a system can be discovered. These
+    APIs allow the processor affinities of threads to be set on a per-node basis, limiting threads
+    to execute only on the processors of a particular nodes (or set of nodes). Finally, they provide
+    methods for allocating memory within the area of memory to which a particular node has first class
+    access.
+
+    The scalability of a multi-threaded application can be improved by restricting threads that access
+    the same memory to execute only on a limited subset of the available cores. Doing so can improve
+    cache coherency due to the same memory being repeatedly accessed via the caches of those cores.
+
+    As threads read and write memory, cached copies of the memory accumulate in the caches local
+    to the cores on which the threads are executed. When a thread writes to memory, any cached copies held
+    in the caches of other cores are invalidated and must be re-fetched from memory. If other threads
+    also write to the same piece of memory (known as \em shared \em writes), then the repeated cache
+    invalidations and refreshes can cause significant overheads. These overheads can be especially
+    severe, and can limit scalability, if the threads in question are allowed to execute on different
+    NUMA nodes.
+
+    In Theron, Frameworks serve as the mechanism by which worker threads are grouped. Accordingly,
+    Theron allows the node and processor affinities of worker threads to be set on a per-framework
+    basis. The expectation is that the actors within a single framework will mainly message
+    each other, with messages being sent between frameworks far less frequently.
+
+    \note Support for node and processor affinity masks is currently somewhat limited.
+    Supported is implemented with Windows NUMA API in windows builds, and with libnuma under linux.
+    In GCC builds, NUMA support requires libnuma-dev and must be explicitly enabled via \ref THERON_NUMA
+    (or numa=on in the makefile). The \ref mNodeMask member is supported with both version 1 and version 2
+    of the libnuma API, but the \ref mProcessorMask member is supported only with version 2. Under Windows
+    both members are supported.
+    */
+    struct Parameters
+    {
+        /**
+        \brief Constructor.
+        Constructs a parameters object with a specified initial thread count, running on a specified
+        subset of the processors of each of a specified set of NUMA processor nodes.
+
+        \param threadCount Number of worker threads to create initially within the framework.
+        \param nodeMask Bitfield mask specifying the NUMA node affinity of the created worker threads.
+        \param processorMask Bitfield mask specifying the processor affinity of the created worker threads within each enabled NUMA node.
+        \param yieldStrategy Enum value specifying how freely worker threads yield to other system threads.
+        */
+        inline explicit Parameters(
+            const uint32_t threadCount = 16,
+            const uint32_t nodeMask = 0x1,
+            const uint32_t processorMask = 0xFFFFFFFF,
+            const YieldStrategy yieldStrategy = YIELD_STRATEGY_POLITE) :
+          mThreadCount(threadCount),
+          mNodeMask(nodeMask),
+          mProcessorMask(processorMask),
+          mYieldStrategy(yieldStrategy),
+          mMessageBatchSize(1),
+          mHandlerBudgetMicroseconds(0),
+          mSchedulerPolicy(SCHEDULER_POLICY_DEFAULT),
+          mIngressTokensPerSecond(0),
+          mIngressBurstLimit(0),
+          mFlowSamplingRatio(0),
+          mWorkerProcessors(0),
+          mWorkerProcessorCount(0),
+          mWarmStatePath(0),
+          mExpectedActorCount(0),
+          mMemoryBudgetBytes(0)
+        {
+        }
+
+        uint32_t mThreadCount;          ///< The initial number of worker threads to create within the framework.
+        uint32_t mNodeMask;             ///< Specifies the NUMA processor nodes upon which the framework may execute.
+        uint32_t mProcessorMask;        ///< Specifies the subset of the processors in each NUMA processor node upon which the framework may execute.
+        YieldStrategy mYieldStrategy;   ///< Strategy that defines how freely worker threads yield to other system threads.
+
+        /**
+        \brief Maximum number of messages a worker thread processes from a mailbox per scheduling event.
+
+        By default each scheduling of a mailbox processes a single message, after which the
+        mailbox is re-enqueued on the work queue if it contains further messages. For actors
+        that receive messages in bursts, setting a larger batch size allows a worker to drain
+        up to that many messages in one scheduling event, amortizing the queue traffic and
+        mailbox lookups across the batch, at the cost of reduced fairness between actors.
+        */
+        uint32_t mMessageBatchSize;
+
+        /**
+        \brief Processing time budget of one scheduling event, in microseconds; zero for no budget.
+
+        A handler that runs for a long time stalls every mailbox queued behind
+        it on its worker thread. With a budget set, a worker that exceeds it
+        while draining a mailbox batch re-queues the remaining messages and
+        returns to the pool for other work, bounding the scheduling delay a
+        long batch can impose on other mailboxes. The budget is checked
+        between messages; a long-running handler can additionally poll it
+        cooperatively with \ref Actor::YieldIfOverBudget, since handlers are
+        never preempted while running.
+
+        \see Actor::YieldIfOverBudget
+        */
+        uint32_t mHandlerBudgetMicroseconds;
+
+        /**
+        \brief Scheduling policy of the worker threads.
+
+        Selects the order in which worker threads take queued mailboxes for
+        processing and steal work from each other; see \ref Theron::SchedulerPolicy
+        for the available policies and their trade-offs. The default policy
+        preserves Theron's historical behavior.
+
+        \see Theron::SchedulerPolicy
+        */
+        SchedulerPolicy mSchedulerPolicy;
+
+        /**
+        \brief Steady rate limit on sends from non-actor code, in messages per second; zero for no limit.
+
+        External producer threads calling \ref Framework::Send can outrun the
+        worker threads and fill the shared queues faster than actor-to-actor
+        traffic, starving internal pipeline progress. With a rate set, sends
+        from non-actor code acquire tokens from a token bucket and wait when
+        the bucket is empty, smoothing bursts of external ingestion to the
+        configured rate. Messages sent by actors from within message handlers
+        are never throttled.
+
+        \see mIngressBurstLimit
+        */
+        uint32_t mIngressTokensPerSecond;
+
+        /**
+        \brief Number of sends from non-actor code admitted at full speed in a burst.
+
+        Bounds the number of tokens the ingress token bucket can hold, and so
+        the number of external sends admitted back-to-back before the rate
+        limit imposes waiting. Zero, the default, allows a burst of one
+        second's worth of tokens. Ignored unless \ref mIngressTokensPerSecond
+        is non-zero.
+
+        \see mIngressTokensPerSecond
+        */
+        uint32_t mIngressBurstLimit;
+
+        /**
+        \brief Causality flow sampling ratio; one in this many sent messages starts a tagged flow. Zero, the default, disables flow tagging.
+
+        Tracing one request across a chain of actors requires correlating the
+        messages it causes, which otherwise means embedding IDs in every
+        payload by hand. With a ratio N set, one in every N messages sent from
+        outside a message handler is tagged with a unique 64-bit flow ID in
+        its envelope. Messages sent from within a handler inherit the flow ID
+        of the message being handled automatically, so the ID follows the
+        causal chain across actors without payload changes. Flow IDs are
+        recorded against the scheduling events captured when \ref
+        THERON_ENABLE_TRACING "scheduler tracing" is enabled, making
+        cross-actor latency attribution possible at a sampled fraction of
+        full-tracing cost.
+        */
+        uint32_t mFlowSamplingRatio;
+
+        /**
+        \brief Optional array of logical processor indices pinning worker threads to individual cores.
+
+        The \ref mProcessorMask member applies one affinity mask to all of the
+        framework's worker threads, leaving the OS free to migrate workers between
+        the processors of the mask. Migration invalidates the cache residency of
+        the mailboxes and queues a worker operates on, which shows up as
+        run-to-run throughput variance. Providing an array of processor indices
+        pins the i-th created worker thread to the i-th processor of the array,
+        eliminating migration. Worker threads beyond the length of the array, and
+        all worker threads when the array is null, get the mask-based affinity.
+
+        \code
+        const Theron::uint32_t workerProcessors[4] = { 0, 1, 2, 3 };
+
+        Theron::Framework::Parameters params(4);
+        params.mWorkerProcessors = workerProcessors;
+        params.mWorkerProcessorCount = 4;
+
+        Theron::Framework framework(params);
+        \endcode
+
+        \note The array is read when worker threads are created, including threads
+        created later by worker scaling, so must outlive the framework.
+        */
+        const uint32_t *mWorkerProcessors;
+
+        /**
+        \brief Number of processor indices in the worker processor array.
+        */
+        uint32_t mWorkerProcessorCount;
+
+        /**
+        \brief Optional path of a warm state file written by \ref SaveWarmState.
+
+        If non-null, the file is loaded during framework construction and the
+        message pools of pooled message types are preallocated back to the
+        depths and fill levels they had when the state was saved, removing
+        pool warmup from the critical path after a process restart. A missing
+        or stale file is silently ignored. The string is read during
+        construction only, so can be destroyed after the constructor returns.
+        */
+        const char *mWarmStatePath;
+
+        /**
+        \brief Expected number of actors to preallocate mailbox capacity for.
+
+        The framework's mailbox directory allocates its pages lazily, so actor
+        registration pays a page allocation every time the actor population
+        crosses a page boundary. If non-zero, pages covering the expected actor
+        count are preallocated during framework construction, moving those
+        allocations out of the registration path. Actor counts beyond the
+        expectation fall back to lazy allocation; page publication is atomic
+        and pages are never copied or moved, so growth past the preallocated
+        capacity never blocks concurrent sends.
+        */
+        uint32_t mExpectedActorCount;
+
+        /**
+        \brief Maximum bytes of memory the framework's allocator chain may hold at once; zero, the default, for no budget.
+
+        When many frameworks share a host, one framework backing up under
+        overload can consume all available memory and collapse every tenant.
+        With a budget set, the allocations backing the framework's message and
+        mailbox memory are admitted against the budget with a single atomic
+        add, and an allocation that would exceed it is refused: the affected
+        \ref Send fails fast, returning false, while the rest of the host is
+        unaffected. Refused allocations can additionally be observed with
+        \ref SetMemoryPressureHandler. The admission check sits below the
+        framework's caching and arena allocators, which recycle memory
+        without releasing it, so the budget bounds the high water mark of the
+        chain rather than the bytes live at any instant.
+
+        \see SetMemoryPressureHandler
+        */
+        uint64_t mMemoryBudgetBytes;
+    };
+
+    /**
+    \brief Constructor.
+
+    Constructs a framework with the given number of worker threads.
+
+    \note This constructor is deprecated. Use the \ref Parameters structure instead.
+
+    \code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    Theron::Framework frameworkOne(8);
+    MyActor actorOne(frameworkOne);
+
+    Theron::Framework frameworkTwo(12);
+    MyActor actorTwo(frameworkTwo);
+    \endcode
+    */
+    inline explicit Framework(const uint32_t threadCount);
+
+    /**
+    \brief Constructor.
+
+    Constructs a framework with the given parameters. The parameters
+    control the size and processor affinity of a framework's threadpool.
+
+    \code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    const Theron::Framework::Parameters params(8);
+    Theron::Framework framework(params);
+
+    MyActor actorOne(framework);
+    MyActor actorTwo(framework);
+    \endcode
+
+    \note In distributed applications, use the constructor variant that accepts an \ref EndPoint.
+    */
+    inline explicit Framework(const Parameters &params = Parameters());
+
+    /**
+    \brief Constructor.
+
+    Constructs a framework object with the given parameters, tied to the given network endpoint.
+    A framework that is tied to a network endpoint is able to send messages to, and receive
+    messages from, remote actors hosted in frameworks tied to other endpoints.
+
+    \code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    const Theron::EndPoint::Parameters params("endpoint_one", "tcp://192.168.10.104:5555");
+    Theron::EndPoint endPoint(params);
+
+    Theron::Framework framework(endPoint, "framework_one");
+    MyActor actorOne(framework);
+    \endcode
+
+    \param endPoint The endpoint to which the framework instance is tied.
+    \param name An optional user-defined name for the framework, which must be unique within the context of the endpoint.
+    \param params Optional parameters object providing construction parameters.
+
+    \note The name string parameter is copied, so can be destroyed after the call.
+    */
+    inline Framework(EndPoint &endPoint, const char *const name = 0, const Parameters &params = Parameters());
+
+    /**
+    \brief Destructor.
+
+    Destroys a Framework.
+
+    A Framework must always outlive (ie. be destructed after) any actors created within
+    it. Specifically, all actors created within a Framework must have been destructed
+    themselves before the Framework itself is allowed to be destructed.
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    main()
+    {
+        Theron::Framework framework;
+        Actor *actor = new Actor(framework);
+
+        // Must delete (ie. destruct) the actor before the Framework hosting it!
+        delete actor;
+    }
+    \endcode
+
+    \note If a Framework instance is allowed to be destructed before actors created within
+    it, the actors will not be correctly destroyed, leading to errors or memory leaks.
+    */
+    inline ~Framework();
+
+    /**
+    \brief Shuts the framework down quickly, leaking its memory.
+
+    Stops the worker threads and deregisters the framework, but abandons the
+    mailboxes and any messages still queued in them without destructing or
+    freeing them. Intended for process-exit paths, where the operating system
+    reclaims the memory anyway: destroying a framework hosting hundreds of
+    thousands of actors normally spends seconds running mailbox destructors
+    that do nothing of lasting value when the process is about to exit.
+
+    After the call the framework is dead: it can't send or deliver messages,
+    and destructing it does nothing further. The memory of the mailboxes, of
+    any undelivered messages, and of the internal creator actor (if one was
+    created by \ref CreateActorAsync) is deliberately leaked.
+
+    \code
+    int main()
+    {
+        Theron::Framework *framework = new Theron::Framework();
+
+        // ... create actors, run the application ...
+
+        // On exit, skip the per-mailbox teardown; the OS reclaims the memory.
+        framework->FastShutdown();
+        delete framework;
+    }
+    \endcode
+
+    \note Never use this in processes that outlive the framework, or with
+    custom allocators whose memory isn't reclaimed by process exit.
+    */
+    void FastShutdown();
+
+    /**
+    \brief Sends a message to the entity (typically an actor, but potentially a Receiver) at the given address.
+
+    \code
+    class Actor : public Theron::Actor
+    {
+    public:
+
+        explicit MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    Theron::Framework framework;
+    Theron::Receiver receiver;
+    Actor actor(framework);
+
+    framework.Send(std::string("Hello"), receiver.GetAddress(), actor.GetAddress());
+    \endcode
+
+    If no actor or receiver exists with the given address, the message will not be
+    delivered, and Send will return false.
+
+    This can happen if the target entity is an actor but has been destructed due to
+    going out of scope (if it was constructed as a local on the stack) or explicitly
+    deleted (if it was constructed on the heap via operator new).
+
+    If the destination address exists, but the receiving entity has no handler
+    registered for messages of the sent type, then the message will be ignored,
+    but this method will still return true. Note that a true return value doesn't
+    necessarily imply that the message was actually handled by the actor.
+
+    In either event, if the message is not actually handled by an actor, the default
+    \ref Framework::SetFallbackHandler "fallback handler" will assert to alert the
+    user about the unhandled message.
+
+    \note This method is used mainly to send messages from non-actor code, eg. main(),
+    where only a Framework instance is available. In such cases, the address of a receiver
+    is typically passed as the 'from' address. When sending messages from within an actor,
+    it is more natural to use \ref Actor::Send, where the address of the sending actor is
+    implicit.
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \return True, if the message was delivered to an entity, otherwise false.
+    */
+#if THERON_CPP11
+    template <typename ValueType>
+    inline bool Send(ValueType &&value, const Address &from, const Address &address);
+#else
+    template <typename ValueType>
+    inline bool Send(const ValueType &value, const Address &from, const Address &address);
+#endif // THERON_CPP11
+
+    /**
+    \brief Returns a pinned handle to the mailbox of the actor at the given address.
+
+    Every send addressed by \ref Address resolves the address to the
+    destination mailbox through the framework's mailbox directory. A loop that
+    sends millions of messages to the same destination pays that resolution
+    once per message for an answer that never changes; a \ref MailboxHandle
+    captures it once, and the Send overload taking a handle pushes messages
+    directly into the pinned mailbox:
+
+    \code
+    Theron::MailboxHandle handle(framework.GetMailboxHandle(consumer.GetAddress()));
+
+    for (int index = 0; index < count; ++index)
+    {
+        framework.Send(Record(index), receiver.GetAddress(), handle);
+    }
+    \endcode
+
+    Mailboxes live as long as their framework, so the handle remains safe to
+    send through even after the addressed actor is destroyed: messages sent
+    via the handle of a dead actor are offered to the framework's
+    \ref SetFallbackHandler "fallback handler", exactly as when sending to the
+    actor's stale address.
+
+    Only actors of this framework can be pinned: for a name-only address, an
+    address in another framework or a receiver address, an
+    \ref MailboxHandle::IsValid "invalid" handle is returned, and sends via
+    it fail. Such destinations keep using the address-based \ref Send.
+
+    \param address The address of an actor within this framework.
+    \return A handle pinning the addressed mailbox, or an invalid handle.
+
+    \see MailboxHandle
+    */
+    inline MailboxHandle GetMailboxHandle(const Address &address);
+
+    /**
+    \brief Sends a message to the mailbox pinned by the given handle.
+
+    Works like \ref Send, but the destination is a \ref MailboxHandle obtained
+    earlier from \ref GetMailboxHandle, so no per-send resolution of the
+    destination address is performed.
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param handle Handle to the pinned destination mailbox.
+    \return True, if the message was delivered to the mailbox, otherwise false.
+
+    \see GetMailboxHandle
+    */
+#if THERON_CPP11
+    template <typename ValueType>
+    inline bool Send(ValueType &&value, const Address &from, const MailboxHandle &handle);
+#else
+    template <typename ValueType>
+    inline bool Send(const ValueType &value, const Address &from, const MailboxHandle &handle);
+#endif // THERON_CPP11
+
+    /**
+    \brief Allocates a message whose value the caller constructs in place.
+
+    Works like \ref Send, split into two phases. The first phase allocates the
+    message envelope and hands its payload memory to the caller through the
+    given \ref MessageBuilder, so the value can be constructed directly in the
+    memory the message will carry it in, rather than constructed elsewhere and
+    copied in. The second phase, \ref MessageBuilder::Commit, sends the built
+    message:
+
+    \code
+    Theron::MessageBuilder<Snapshot> builder;
+
+    if (framework.AllocateMessage(builder, receiver.GetAddress(), actor.GetAddress()))
+    {
+        new (builder.Memory()) Snapshot(orderBook);
+        builder.Commit();
+    }
+    \endcode
+
+    For small values the ordinary \ref Send is just as cheap and considerably
+    more convenient; the builder earns its keep for values large enough that
+    the saved copy matters.
+
+    \tparam ValueType The message type.
+    \param builder An invalid builder, which receives the allocated message.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \return True, if the message was allocated, otherwise false.
+
+    \see MessageBuilder
+    */
+    template <class ValueType>
+    inline bool AllocateMessage(MessageBuilder<ValueType> &builder, const Address &from, const Address &address);
+
+    /**
+    \brief Sends a message value that must be processed within a deadline.
+
+    Works like \ref Send, but additionally stamps the message with a deadline,
+    given as a validity period in microseconds from the time of the call.
+    Mailboxes holding deadline-stamped messages are scheduled ahead of normal
+    work, ordered earliest deadline first, so under load the message with the
+    tightest deadline is always the next one processed.
+
+    The deadline doesn't cancel the message: a message processed late is still
+    delivered to its handler, which can check timeliness itself if stale values
+    must be dropped. Each message whose processing starts after its deadline
+    has passed is counted against \ref COUNTER_DEADLINE_MISSES, so the rate of
+    misses can be monitored with \ref GetCounterValue.
+
+    \code
+    // The order is valid for two milliseconds.
+    framework.SendWithDeadline(order, receiver.GetAddress(), trader.GetAddress(), 2000);
+    \endcode
+
+    \tparam ValueType The message type.
+    \param value The message value.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param deadlineMicroseconds Period after which the message is late, in microseconds from now.
+    \return True, if the message was delivered to an entity, otherwise false.
+
+    \see Send
+    \see GetCounterValue
+    */
+    template <typename ValueType>
+    inline bool SendWithDeadline(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint32_t deadlineMicroseconds);
+
+    /**
+    \brief Sends a batch of message values to the entity at the given address.
+
+    Each call to \ref Send resolves the destination address and schedules the
+    destination mailbox independently, which adds up when a non-actor thread --
+    a network ingest loop, say -- sends events one at a time as fast as it can
+    read them. This method sends an array of values of a single type to one
+    destination, resolving the address once and typically scheduling the
+    mailbox once for the whole batch.
+
+    \code
+    Event events[100];
+    const uint32_t numRead(ReadEvents(events, 100));
+
+    framework.SendBatch(events, numRead, receiver.GetAddress(), actor.GetAddress());
+    \endcode
+
+    Delivery stops early if the destination mailbox has a bounded capacity and
+    fills up, or if a message allocation fails, so the return value can be less
+    than \em count. The unsent tail of the array is untouched and can be
+    retried by the caller.
+
+    \note Batching pays off only on the direct path to an actor in this
+    framework. Messages addressed by name, or to receivers or actors in other
+    local frameworks, are delivered with ordinary per-message sends.
+
+    \tparam ValueType The message type.
+    \param values Array of message values, each copied into its own message.
+    \param count Number of values in the array.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \return The number of messages successfully sent, starting from the first.
+
+    \see Send
+    */
+    template <typename ValueType>
+    inline uint32_t SendBatch(
+        const ValueType *const values,
+        const uint32_t count,
+        const Address &from,
+        const Address &address);
+
+    /**
+    \brief Sends a batch of pre-built message envelopes to the entity at the given address.
+
+    Heterogeneous variant of \ref SendBatch for producers whose event streams
+    mix message types. Envelopes are built up-front with \ref CreateEnvelope,
+    then handed over in a single batch that resolves the address and schedules
+    the destination mailbox once.
+
+    \code
+    Theron::Detail::IMessage *envelopes[2];
+    envelopes[0] = framework.CreateEnvelope(Started(), receiver.GetAddress());
+    envelopes[1] = framework.CreateEnvelope(Payload(), receiver.GetAddress());
+
+    framework.SendBatch(envelopes, 2, actor.GetAddress());
+    \endcode
+
+    The framework takes ownership of the envelopes: delivered envelopes are
+    destroyed by the worker thread that processes them, and undelivered ones
+    (for example when a bounded mailbox is full) are offered to the
+    \ref SetFallbackHandler "fallback handler" and destroyed, as for \ref Send.
+
+    \param messages Array of envelopes built with \ref CreateEnvelope.
+    \param count Number of envelopes in the array.
+    \param address The address of the target entity (an actor or a receiver).
+    \return The number of envelopes successfully delivered.
+
+    \see CreateEnvelope
+    */
+    inline uint32_t SendBatch(
+        Detail::IMessage *const *const messages,
+        const uint32_t count,
+        const Address &address);
+
+    /**
+    \brief Sends a batch of pre-built message envelopes to per-envelope addresses.
+
+    Fan-out variant of \ref SendBatch for producers that distribute a batch of
+    events over many destinations -- an ingest thread partitioning a feed over
+    a pool of workers, say. Sending such a batch with individual calls to
+    \ref Send resolves a destination and schedules a mailbox per message, in
+    whatever interleaved order the events arrived. This method instead groups
+    the envelopes by destination mailbox before delivery, so each distinct
+    destination is resolved once and typically scheduled once for its whole
+    group of envelopes.
+
+    \code
+    Theron::Detail::IMessage *envelopes[2];
+    Theron::Address addresses[2];
+
+    envelopes[0] = framework.CreateEnvelope(Payload(), receiver.GetAddress());
+    addresses[0] = workerOne.GetAddress();
+    envelopes[1] = framework.CreateEnvelope(Payload(), receiver.GetAddress());
+    addresses[1] = workerTwo.GetAddress();
+
+    framework.SendBatch(envelopes, addresses, 2);
+    \endcode
+
+    The grouping is stable: envelopes that share a destination are delivered
+    in their order within the batch, so per-destination ordering is the same
+    as for individual sends. No ordering holds between envelopes sent to
+    different destinations. As for the single-destination overload, the
+    framework takes ownership of the envelopes, and envelopes addressed by
+    name or to entities outside this framework are delivered with ordinary
+    per-message sends.
+
+    \param messages Array of envelopes built with \ref CreateEnvelope.
+    \param addresses Array of destination addresses, one per envelope.
+    \param count Number of envelopes in the arrays.
+    \return The number of envelopes successfully delivered.
+
+    \see CreateEnvelope
+    */
+    inline uint32_t SendBatch(
+        Detail::IMessage *const *const messages,
+        const Address *const addresses,
+        const uint32_t count);
+
+    /**
+    \brief Allocates a message envelope for later batch sending.
+
+    Copies the value into a framework-allocated envelope carrying the sender
+    address, ready to be passed to the heterogeneous \ref SendBatch overload.
+    Every envelope created with this method must be handed to \ref SendBatch,
+    which takes ownership of it; envelopes can't be freed any other way.
+
+    \tparam ValueType The message type.
+    \param value The message value, copied into the envelope.
+    \param from The address of the sending entity (typically a receiver).
+    \return The allocated envelope, or zero if allocation failed.
+
+    \see SendBatch
+    */
+    template <typename ValueType>
+    inline Detail::IMessage *CreateEnvelope(const ValueType &value, const Address &from);
+
+    /**
+    \brief Sends one message value to multiple recipients, copying the value only once.
+
+    Broadcasting a value with repeated calls to \ref Send allocates a message and
+    copies the value once per recipient. This method instead constructs the value
+    once, in a single refcounted block, together with a lightweight envelope
+    message per recipient, so broadcasting an expensive value -- a large snapshot,
+    say -- to hundreds of subscribers costs one copy instead of hundreds. To the
+    receiving actors a broadcast message is indistinguishable from any other
+    message; the shared block is freed automatically when the last recipient has
+    processed its envelope.
+
+    \code
+    Theron::Address subscribers[2] = { actorOne.GetAddress(), actorTwo.GetAddress() };
+    framework.Broadcast(Snapshot(), receiver.GetAddress(), subscribers, 2);
+    \endcode
+
+    \note The value is shared by all recipients, so must not be modified by the
+    receiving message handlers. In particular, broadcast messages must not be
+    handled by mutable handlers, registered for non-const message references.
+    Broadcast message types must be registered with THERON_REGISTER_MESSAGE,
+    since handlers match the shared envelopes by registered type ID.
+
+    \tparam ValueType The message type.
+    \param value The message value, copied once and shared by all recipients.
+    \param from The address of the sending entity (typically a receiver).
+    \param addresses Array of addresses of the target entities.
+    \param count Number of addresses in the array.
+    \return True, if the message was delivered to all of the recipients.
+
+    \see Send
+    */
+    template <typename ValueType>
+    inline bool Broadcast(
+        const ValueType &value,
+        const Address &from,
+        const Address *const addresses,
+        const uint32_t count);
+
+    /**
+    \brief Factory callback used by \ref CreateActorAsync to construct an actor.
+
+    The callback is executed on a worker thread. It constructs an actor within
+    the given framework and returns it, or returns zero if the construction
+    failed. The context pointer passed to \ref CreateActorAsync is passed
+    through to the callback.
+    */
+    typedef Actor *(*ActorFactory)(Framework &framework, void *const context);
+
+    /**
+    \brief Requests construction of an actor on a worker thread.
+
+    Actors are normally constructed inline by the calling thread, so an actor
+    that constructs heavyweight children from within a message handler stalls
+    its own message processing until each construction completes. This method
+    instead queues the construction for execution by a worker thread: the
+    factory callback runs on the worker, and on completion an
+    \ref ActorCreatedEvent carrying the constructed actor and its address is
+    sent to the client address, leaving the requester free to process other
+    messages in the meantime.
+
+    \code
+    Theron::Actor *CreateSession(Theron::Framework &framework, void *const context)
+    {
+        return new SessionActor(framework);
+    }
+
+    framework.CreateActorAsync(&CreateSession, 0, supervisor.GetAddress());
+    \endcode
+
+    The receiver of the completion event owns the constructed actor and is
+    responsible for eventually destroying it.
+
+    \param factory Callback that constructs the actor, executed on a worker thread.
+    \param context User context passed through to the callback and echoed in the completion event.
+    \param client Address to which the completion event is sent.
+    \return True, unless the request couldn't be queued.
+
+    \see ActorCreatedEvent
+    */
+    bool CreateActorAsync(const ActorFactory factory, void *const context, const Address &client);
+
+    /**
+    \brief Requests construction of an actor of a known type on a worker thread.
+
+    Convenience overload of \ref CreateActorAsync for actor types constructible
+    from just a framework reference. The actor is constructed on a worker
+    thread with <code>new ActorType(framework)</code>, so the receiver of the
+    completion event destroys it with <code>delete</code>.
+
+    \tparam ActorType The type of actor to construct.
+    \param client Address to which the completion event is sent.
+    \param context Optional user context echoed in the completion event.
+    \return True, unless the request couldn't be queued.
+
+    \see ActorCreatedEvent
+    */
+    template <class ActorType>
+    inline bool CreateActorAsync(const Address &client, void *const context = 0);
+
+    /**
+    \brief Sends a message to the entity at the given address after a delay.
+
+    The message value is held by the framework and sent after at least the given
+    number of microseconds have elapsed. Pending timers are stored in a timing
+    wheel serviced by the framework's manager thread, so tens of thousands of
+    timers can be pending cheaply, without dedicating an actor or thread to each.
+
+    \code
+    Theron::Framework framework;
+    Theron::Receiver receiver;
+
+    // Send the actor a timeout message after roughly a tenth of a second.
+    framework.SendAfter(Timeout(), receiver.GetAddress(), actor.GetAddress(), 100 * 1000);
+    \endcode
+
+    \note The delay is a lower bound. The actual delay is rounded up to the timer
+    resolution (one millisecond) and additionally depends on how promptly the
+    manager thread services the timers, so is typically accurate to within a few
+    milliseconds. Delayed messages can't be cancelled once requested, and are
+    silently dropped if the framework is destructed before they become due.
+
+    \tparam ValueType The message type.
+    \param value The message value, copied and held until the delay expires.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param delayMicroseconds Minimum delay before the message is sent, in microseconds.
+    \return True, unless the pending timer couldn't be allocated.
+
+    \see SendEvery
+    */
+    template <typename ValueType>
+    inline bool SendAfter(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint64_t delayMicroseconds);
+
+    /**
+    \brief Sends a message to the entity at the given address repeatedly, with a fixed period.
+
+    A fresh copy of the message value is sent after every period, starting one
+    period after the call. Like \ref SendAfter, periodic sends are backed by the
+    timing wheel serviced by the framework's manager thread, replacing the
+    dedicated ticker actors traditionally used to generate periodic messages.
+
+    \note The period is subject to the same resolution and accuracy caveats as
+    \ref SendAfter. Periodic sends repeat until the framework is destructed;
+    there is currently no way to cancel them individually.
+
+    \tparam ValueType The message type.
+    \param value The message value, copied and held for the lifetime of the timer.
+    \param from The address of the sending entity (typically a receiver).
+    \param address The address of the target entity (an actor or a receiver).
+    \param periodMicroseconds Period between successive sends, in microseconds.
+    \return True, unless the pending timer couldn't be allocated.
+
+    \see SendAfter
+    */
+    template <typename ValueType>
+    inline bool SendEvery(
+        const ValueType &value,
+        const Address &from,
+        const Address &address,
+        const uint64_t periodMicroseconds);
+
+    /**
+    \brief Specifies a maximum limit on the number of worker threads enabled in this framework.
+
+    This method allows an application to place an upper bound on the thread count.
+    Users can use this method, together with SetMinThreads, to implement a policy for
+    framework threadpool management.
+
+    This method will only decrease the actual number of worker threads, never increase it.
+    Calling this method is guaranteed to eventually result in the number of threads being
+    less than or equal to the specified limit, as long as messages continue to be sent and
+    unless a higher minimum limit is specified subsequently.
+
+    If two successive calls specify different maximums, the lower takes effect. If
+    conflicting minimum and maximums are specified by subsequent calls to this method
+    and SetMinThreads, then the later call wins.
+
+    The idea behind separate minimum and maximum limits, rather than a single method to
+    directly set the actual number of threads, is to allow negotiation between multiple
+    agents, each with a different interest in the thread count. One may require a certain
+    minimum number of threads for its processing, but not care if the actual number of
+    threads is higher, while another may wish to impose a maximum limit on the number of
+    threads in existence, but be satisfied if there are less.
+
+    When the minimum and maximum limits differ, the manager thread additionally scales
+    the thread count automatically between them: it periodically samples the depth of
+    the shared work queue and the rate of message processing, adding workers when
+    messages back up faster than they are drained and retiring workers, with
+    hysteresis, when the framework stays underutilized.
+
+    \note If the number of threads before the call was higher than the requested maximum,
+    there may be an arbitrary delay after calling this method before the number of threads
+    drops to the requested value. The number of threads is managed over time, and is not
+    guaranteed to be less than or equal to the requested maximum immediately after the call.
+    Threads self-terminate on being woken, if they discover that the actual thread count
+    is higher than the limit. This means that until some threads are woken by the arrival
+    of new messages, the actual thread count will remain unchanged.
+
+    \param count A positive integer - behavior for zero is undefined.
+
+    \see SetMinThreads
+    */
+    void SetMaxThreads(const uint32_t count);
+
+    /**
+    \brief Specifies a minimum limit on the number of worker threads enabled in this framework.
+
+    This method allows an application to place a lower bound on the thread count.
+    Users can use this method, together with SetMaxThreads, to implement a policy for
+    framework threadpool management.
+
+    This method will only increase the actual number of worker threads, never reduce it.
+    Calling this method is guaranteed to eventually result in the number of threads being
+    greater than or equal to the specified limit, unless a lower maximum limit is specified
+    subsequently.
+
+    If two successive calls specify different minimums, the higher takes effect. If
+    conflicting minimum and maximums are specified by subsequent calls to this method
+    and SetMaxThreads, then the later call wins.
+
+    When the minimum and maximum limits differ, the manager thread scales the thread
+    count automatically between them, based on the depth of the shared work queue and
+    the rate of message processing. See \ref SetMaxThreads for details.
+
+    \note If the number of threads before the call was lower than the requested minimum,
+    there may be an arbitrary delay after calling this method before the number of threads rises
+    to the requested value. Threads are spawned or re-enabled by a manager thread dedicated
+    to that task, which runs asynchronously from other threads as a background task.
+    It spends most of its time asleep, only being woken by calls to SetMinThreads.
+
+    \param count A positive integer - behavior for zero is undefined.
+
+    \see SetMaxThreads
+    */
+    void SetMinThreads(const uint32_t count);
+
+    /**
+    \brief Returns the current maximum limit on the number of worker threads in this framework.
+
+    This method returns the current maximum limit on the size of the worker threadpool,
+    as set by the most recent call to SetMaxThreads, or the initial thread count if
+    SetMaxThreads has never been called. Note that this may be different from the actual
+    current number of threads, returned by GetNumThreads.
+
+    \see GetMinThreads
+    */
+    uint32_t GetMaxThreads() const;
+
+    /**
+    \brief Returns the current minimum limit on the number of worker threads in this framework.
+
+    This method returns the current minimum limit on the size of the worker threadpool,
+    as set by the most recent call to SetMinThreads, or the initial thread count if
+    SetMinThreads has never been called.
+
+    \see GetMaxThreads
+    */
+    uint32_t GetMinThreads() const;
+
+    /**
+    \brief Gets the actual number of worker threads currently in this framework.
+
+    The returned count reflects the actual number of enabled threads at the time of the
+    call, which is independent from any maximum or minimum limits specified with
+    SetMaxThreads or SetMinThreads. The count includes all enabled threads, including any
+    that are sleeping due to having no work to do, but not including ones which were
+    created earlier but subsequently terminated to reduce the thread count.
+
+    \note The value returned by this method is specific to this framework instance. If
+    multiple frameworks are created then each has its own threadpool with an independently
+    managed thread count.
+
+    \see GetPeakThreads
+    */
+    uint32_t GetNumThreads() const;
+
+    /**
+    \brief Gets the peak number of worker threads ever active in the framework.
+
+    This call queries the highest number of simultaneously enabled threads seen since the
+    start of the framework. Note that this measures the highest actual number of threads,
+    as measured by GetNumThreads, rather than the highest values of the maximum or minimum
+    thread count limits.
+
+    \note The value returned by this method is specific to this framework instance. If
+    multiple frameworks are created then each has its own threadpool with an independently
+    managed thread count.
+    */
+    uint32_t GetPeakThreads() const;
+
+    /**
+    \brief Sets the scheduling priority of the actor at the given address.
+
+    By default all actors are scheduled with normal priority, and their mailboxes
+    are processed in roughly first-come, first-served order. Actors given high
+    priority with this method have their mailboxes drained by the worker threads
+    ahead of all normal-priority mailboxes, so their messages aren't queued behind
+    bulk work. This is intended for small numbers of latency-critical control
+    actors; making many actors high-priority simply starves the rest.
+
+    \code
+    Theron::Framework framework;
+    ControlActor controller(framework);
+
+    framework.SetPriority(controller.GetAddress(), true);
+    \endcode
+
+    \note The address must identify an actor within this framework. The priority
+    should be set before messages are sent to the actor; changing the priority of
+    an actor whose mailbox is already scheduled only affects later scheduling.
+
+    \param address The address of an actor within this framework.
+    \param highPriority True to schedule the actor with high priority.
+    */
+    inline void SetPriority(const Address &address, const bool highPriority);
+
+    /**
+    \brief Bounds the mailbox of the actor at the given address.
+
+    By default mailboxes are unbounded, so the mailbox of an actor that
+    consumes messages more slowly than they arrive grows without limit. This
+    method sets a maximum number of unprocessed messages held in an actor's
+    mailbox. Once the mailbox is full, further sends to the actor fail:
+    \ref Send "Framework::Send" and \ref Actor::Send "Actor::Send" return
+    false and the rejected message is passed to the
+    \ref SetFallbackHandler "fallback handler", letting upstream senders shed
+    load or throttle instead of silently queueing.
+
+    \code
+    Theron::Framework framework;
+    WorkerActor worker(framework);
+
+    framework.SetMailboxCapacity(worker.GetAddress(), 1024);
+    \endcode
+
+    \note The capacity check is made without locking the lock-free message
+    queue, so concurrent senders can overshoot the capacity by a message or
+    two; the bound limits queue growth rather than enforcing an exact limit.
+    A capacity of zero removes the bound.
+
+    \param address The address of an actor within this framework.
+    \param capacity Maximum number of unprocessed messages held; zero for unbounded.
+
+    \see SetFallbackHandler
+    */
+    inline void SetMailboxCapacity(const Address &address, const uint32_t capacity);
+
+    /**
+    \brief Flags the actor at the given address as high-rate.
+
+    The message blocks of an actor that receives a sustained stream of small
+    messages are ordinarily allocated from the sending threads' caches and
+    freed to the caches of whichever worker threads process the mailbox, so
+    the blocks migrate between per-thread caches as the processing worker
+    varies. Actors flagged high-rate with this method serve sends from a small
+    micro-pool of message block slots embedded in their own mailbox: messages
+    that fit a slot claim one instead of allocating, and return it when
+    destroyed, so the actor's steady-state traffic circulates through a few
+    memory lines resident alongside the mailbox and never touches the
+    allocator.
+
+    \code
+    Theron::Framework framework;
+    TickerActor ticker(framework);
+
+    framework.SetHighRate(ticker.GetAddress(), true);
+    \endcode
+
+    The pool holds \ref THERON_MAILBOX_POOL_SLOTS slots of
+    \ref THERON_MAILBOX_POOL_SLOT_SIZE bytes each; messages too large for a
+    slot, and sends that find all slots claimed, allocate as usual, so the
+    flag is purely an optimization hint.
+
+    \note The address must identify an actor within this framework.
+
+    \param address The address of an actor within this framework.
+    \param highRate True to serve the actor's sends from its mailbox's micro-pool.
+    */
+    inline void SetHighRate(const Address &address, const bool highRate);
+
+    /**
+    \brief Migrates an actor from this framework to another framework.
+
+    Moves the actor registered at the given address out of this framework and
+    into the target framework, where it is processed by the target's worker
+    threads from then on. Frameworks are commonly pinned to NUMA nodes or
+    processor subsets, so migration lets long-lived actors be rebalanced onto
+    idle nodes at runtime instead of staying on their birth framework for life.
+
+    \code
+    Theron::Framework hot(hotNodeParams);
+    Theron::Framework idle(idleNodeParams);
+    WorkerActor worker(hot);
+
+    // ...
+
+    hot.MigrateActor(worker.GetAddress(), idle);
+    \endcode
+
+    The migration waits for any message handler currently executing on the
+    actor to return, then re-homes the actor to a newly allocated mailbox in
+    the target framework. The actor keeps its name, and with it its address
+    identity, but the address returned by \ref Actor::GetAddress afterwards
+    routes to the new mailbox, and replies sent by the actor carry it. The
+    old address remains valid indefinitely: messages sent to it, including
+    any still queued at the time of the migration, are forwarded to the
+    actor's new mailbox in the order they arrived, at the cost of an extra
+    hop. Senders that hold the old address can keep using it, and pick up
+    the new address from the 'from' address of the actor's replies.
+
+    \note Messages a sender addresses to the old address after the migration
+    can arrive after messages the same sender subsequently addresses directly
+    to the new address, since the former pay the forwarding hop. Per-address
+    ordering is preserved.
+
+    \param address The address of an actor within this framework.
+    \param target The framework the actor is migrated to.
+    \return True if an actor was registered at the address and was migrated.
+    */
+    bool MigrateActor(const Address &address, Framework &target);
+
+    /**
+    \brief Reserves the resources needed to later respawn an actor in constant time.
+
+    Allocates aligned storage for an actor of the given type and claims a
+    mailbox for it up front, storing both in the given slot. The mailbox
+    directory page backing the claimed mailbox is committed as part of the
+    claim, so a later \ref RespawnActor with the slot constructs the successor
+    into memory that already exists, touching no allocator.
+
+    Reservation is intended to be done outside any incident, typically at
+    startup alongside the creation of the actors being supervised. See
+    \ref RespawnSlot for a usage example.
+
+    \note The claimed mailbox is consumed even if the slot is never used;
+    mailbox slots are deliberately never recycled.
+
+    \tparam ActorType The derived actor type the slot will be respawned with.
+    \param slot An empty slot that receives the reserved resources.
+    \return True if the resources were successfully reserved.
+
+    \see RespawnActor
+    \see RespawnSlot
+    */
+    template <class ActorType>
+    inline bool ReserveRespawnSlot(RespawnSlot &slot);
+
+#if THERON_CPP11
+
+    /**
+    \brief Respawns a failed actor into a pre-reserved slot in constant time.
+
+    Constructs a successor actor of the given type into the storage and
+    mailbox reserved in the slot by an earlier \ref ReserveRespawnSlot, then
+    redirects the failed actor's address to the successor: messages still
+    queued at the failed actor's mailbox, and any sent to its address from
+    now on, are forwarded to the successor in their order of arrival, as in
+    \ref MigrateActor. If the failed actor was named, lookups of its name
+    resolve to the successor. No allocation is performed, making the respawn
+    safe to rely on under the load spikes that failures correlate with.
+
+    The failed actor is expected to have been destructed already; if an actor
+    is still registered at the failed address -- a wedged actor being forcibly
+    replaced -- it is cut off from its mailbox and receives nothing further,
+    though the redirect first waits for any message handler currently
+    executing on it to return. Destroying the cut-off actor object remains
+    the caller's responsibility. Passing \ref Address::Null as the failed
+    address skips the redirect entirely, constructing a fresh actor with no
+    predecessor.
+
+    The successor is owned by the slot and is destructed when the slot is
+    destructed or reset, which must happen before the framework is destructed.
+
+    \note Must not be called from within an actor constructor, since it
+    serializes with actor creation in the calling framework.
+
+    \tparam ActorType The derived actor type to construct; its size must not
+    exceed that of the type the slot was reserved with.
+    \param slot A slot reserved in this framework and not yet used.
+    \param failedAddress The address of the failed actor, or \ref Address::Null.
+    \param args Arguments passed to the actor constructor after the framework.
+    \return A pointer to the constructed successor actor.
+
+    \see ReserveRespawnSlot
+    \see RespawnSlot
+    */
+    template <class ActorType, typename... Args>
+    inline ActorType *RespawnActor(RespawnSlot &slot, const Address &failedAddress, Args &&... args);
+
+#else
+
+    /**
+    Respawns a failed actor into a pre-reserved slot in constant time.
+    The successor is constructed with the framework-only actor constructor.
+    \see ReserveRespawnSlot
+    */
+    template <class ActorType>
+    inline ActorType *RespawnActor(RespawnSlot &slot, const Address &failedAddress);
+
+#endif // THERON_CPP11
+
+    /**
+    \brief Samples the queue lengths of a batch of mailboxes.
+
+    Fills in, for each of the given addresses, the number of messages currently
+    queued at the mailbox with that address, awaiting processing. The counts are
+    read from relaxed atomics maintained on the message send and processing
+    paths, without taking any locks, so monitoring code can sample thousands of
+    mailboxes per second without perturbing the actors being sampled.
+
+    \code
+    Theron::Address addresses[2] = { first.GetAddress(), second.GetAddress() };
+    uint32_t lengths[2];
+
+    framework.GetQueueLengths(addresses, lengths, 2);
+    \endcode
+
+    \note Each count is an independent momentary snapshot; the batch is not a
+    consistent cross-mailbox snapshot. Like \ref Actor::GetNumQueuedMessages,
+    a count includes any message currently being processed by a handler.
+
+    \param addresses Addresses of actors within this framework.
+    \param lengths Array to receive the queue length of each addressed mailbox.
+    \param count Number of addresses (and lengths) in the arrays.
+    */
+    inline void GetQueueLengths(const Address *const addresses, uint32_t *const lengths, const uint32_t count);
+
+    /**
+    \brief Sends a message to the least loaded of a group of actors.
+
+    Routes the message to whichever of the given addresses currently has the
+    fewest messages queued at its mailbox, implementing join-shortest-queue
+    routing across a pool of replicated worker actors. Round-robin routing
+    ignores instantaneous load, so the latency of a pooled request is set by
+    the unluckiest queue; picking the shortest queue instead steers work away
+    from workers that are stalled or processing expensive messages.
+
+    \code
+    Theron::Address workers[4] =
+    {
+        workerOne.GetAddress(),
+        workerTwo.GetAddress(),
+        workerThree.GetAddress(),
+        workerFour.GetAddress()
+    };
+
+    framework.SendToLeastLoaded(WorkItem(), receiver.GetAddress(), workers, 4);
+    \endcode
+
+    The queue depths are sampled from the relaxed per-mailbox counters also
+    read by \ref GetQueueLengths, without taking any locks, so the routing
+    decision costs one atomic read per candidate.
+
+    \note The sampled depths are independent momentary snapshots, so the
+    chosen mailbox may no longer be the shortest by the time the message is
+    queued; join-shortest-queue is a heuristic, not a guarantee. Ties are
+    broken in favor of the earliest candidate in the array.
+
+    \tparam ValueType The message type.
+    \param value The message value to be sent.
+    \param from The address of the sending entity.
+    \param addresses Array of addresses of the candidate target actors.
+    \param count Number of addresses in the array.
+    \return True, if the message was delivered to the chosen candidate.
+
+    \see Send
+    \see GetQueueLengths
+    */
+    template <typename ValueType>
+    inline bool SendToLeastLoaded(
+        const ValueType &value,
+        const Address &from,
+        const Address *const addresses,
+        const uint32_t count);
+
+    /**
+    \brief Sends a batch of messages in one scatter operation.
+
+    Sends the n-th value to the n-th address, with all replies addressed to
+    the given gathering entity, and finally delivers a single aggregate
+    \ref ScatterGatherComplete message to the gathering entity reporting how
+    many of the messages were successfully delivered.
+
+    Sending the messages individually schedules each destination mailbox as
+    soon as its first message arrives. The scatter pass instead pushes the
+    whole batch first and then schedules the mailboxes that became non-empty
+    in a single pass, so a destination that appears many times in the batch
+    costs one scheduling event for its whole group, and the worker that picks
+    it up drains the group in one batch.
+
+    \code
+    Theron::Address addresses[64];
+    WorkItem workItems[64];
+
+    // ...
+
+    framework.ScatterGather(workItems, addresses, 64, gatherer.GetAddress());
+    \endcode
+
+    The gathering entity receives the replies of the addressed actors, if
+    any, and can count them against the batch size reported by the completion
+    message. Like \ref Send, delivery can fail if an address is stale or a
+    bounded destination mailbox is full; undelivered messages are passed to
+    the fallback handlers.
+
+    \param values Array of message values to send, one per address.
+    \param addresses Array of destination addresses.
+    \param count Number of values (and addresses) in the arrays.
+    \param replyTo Address of the gathering entity that replies and the completion message are sent to.
+    \return The number of messages successfully delivered.
+    */
+    template <typename ValueType>
+    uint32_t ScatterGather(
+        const ValueType *const values,
+        const Address *const addresses,
+        const uint32_t count,
+        const Address &replyTo);
+
+    /**
+    \brief Waits until the mailboxes of a group of actors have all drained.
+
+    Blocks the calling thread until every one of the given actors has an empty
+    mailbox and no handler executing, implementing the phase barrier of a
+    bulk-synchronous superstep: the caller sends each group member its work
+    for the phase, the members process it -- exchanging messages among
+    themselves as they go -- and the barrier returns once the group is
+    quiescent, at which point the next phase can begin.
+
+    \code
+    for (Theron::uint32_t phase = 0; phase < numPhases; ++phase)
+    {
+        for (Theron::uint32_t index = 0; index < numMembers; ++index)
+        {
+            framework.Send(phase, receiver.GetAddress(), members[index]);
+        }
+
+        framework.PhaseBarrier(members, numMembers);
+    }
+    \endcode
+
+    Implementing the barrier with messages to a coordinator actor costs two
+    mailbox round-trips per member per phase. The barrier instead polls the
+    relaxed per-mailbox depth counters also read by \ref GetQueueLengths,
+    so a superstep costs no coordination messages at all; the calling thread
+    spins with a progressive backoff, sleeping when the phase is long.
+
+    \note Quiescence is detected by re-checking that no messages were
+    processed anywhere in the framework while the group's mailboxes were all
+    observed empty, so members may freely message each other during a phase.
+    The caller must not send to the members while the barrier is in progress,
+    and no other thread should be sending to them either, or the barrier may
+    not return.
+
+    \param addresses Addresses of the group member actors, within this framework.
+    \param count Number of addresses in the array.
+
+    \see GetQueueLengths
+    */
+    void PhaseBarrier(const Address *const addresses, const uint32_t count);
+
+    /**
+    \brief Reports the mailboxes holding the most queued message memory.
+
+    When per-mailbox memory accounting is enabled with \ref
+    THERON_ENABLE_MEMORY_ACCOUNTING, the memory occupied by queued messages --
+    envelopes and payloads -- is tallied against the destination mailbox as
+    messages are sent and processed. This method scans the mailboxes of the
+    framework and fills in the addresses and queued byte counts of the largest
+    consumers, in descending order, identifying which actor's mailbox is
+    growing when a deployment leaks or backs up.
+
+    \code
+    Theron::Address addresses[10];
+    Theron::uint32_t bytesQueued[10];
+
+    const Theron::uint32_t numEntries(framework.GetTopMemoryUsers(addresses, bytesQueued, 10));
+    for (Theron::uint32_t index = 0; index < numEntries; ++index)
+    {
+        printf("%s: %u bytes queued\n", addresses[index].AsString(), bytesQueued[index]);
+    }
+    \endcode
+
+    \note The tallies are independent momentary snapshots read without locks,
+    so the report is approximate while actors are actively processing. Only
+    mailboxes with non-zero tallies are reported. When memory accounting is
+    disabled, the default, this method always returns zero.
+
+    \param addresses Array to receive the addresses of the largest consumers.
+    \param bytesQueued Array to receive the queued byte count of each reported mailbox.
+    \param maxEntries Capacity of the arrays, bounding the size of the report.
+    \return The number of report entries filled in.
+    */
+    uint32_t GetTopMemoryUsers(Address *const addresses, uint32_t *const bytesQueued, const uint32_t maxEntries);
+
+    /**
+    \brief Writes the accumulated scheduling event traces to a Chrome trace file.
+
+    When tracing is enabled with \ref THERON_ENABLE_TRACING, each worker thread
+    records message pushes, mailbox scheduling events, handler execution
+    begin/end pairs, and sleep/wake transitions into a per-thread ring buffer
+    holding the most recent window of activity. This method writes the retained
+    events of every thread to the given path as Chrome about:tracing JSON,
+    loadable in a Chromium-based browser at chrome://tracing, with one timeline
+    row per thread:
+
+    \code
+    Theron::Framework framework;
+
+    // ... run the workload to be diagnosed ...
+
+    framework.DumpTrace("theron_trace.json");
+    \endcode
+
+    \note The trace buffers are read without interrupting the worker threads,
+    so a dump taken while the framework is busy may contain a small number of
+    torn or missing events; for exact captures, dump when the framework is
+    idle. Handler begin/end events carry a hash identifying the mailbox, so
+    messages to the same actor can be correlated across threads. When tracing
+    is disabled, the default, this method always returns false.
+
+    \param path Path of the trace file to write.
+    \return True, if the trace file was written successfully.
+    */
+    bool DumpTrace(const char *const path);
+
+    /**
+    \brief Retrieves per-message-type counts of the messages sent and processed.
+
+    When message statistics are enabled with \ref THERON_ENABLE_MESSAGE_STATS,
+    every message submitted for delivery and every message processed by an
+    actor is counted against the dense integer ID of its registered message
+    type, accumulated in per-thread tables with no shared-state contention.
+    This method merges the per-thread tables into the caller's report:
+
+    \code
+    Theron::MessageTypeStats stats;
+    if (framework.GetMessageTypeStats(stats))
+    {
+        for (Theron::uint32_t typeId = 0; typeId < Theron::MessageTypeStats::MAX_TYPES; ++typeId)
+        {
+            const Theron::MessageTypeStats::TypeStats &entry(stats.mTypes[typeId]);
+            if (entry.mSentCount || entry.mProcessedCount)
+            {
+                printf("%s: %u sent %u processed\n",
+                    entry.mTypeName ? entry.mTypeName : "<unregistered>",
+                    static_cast<Theron::uint32_t>(entry.mSentCount),
+                    static_cast<Theron::uint32_t>(entry.mProcessedCount));
+            }
+        }
+    }
+    \endcode
+
+    \note The per-thread tables are read without interrupting the worker
+    threads, so a report taken while the framework is busy is a momentary
+    approximation. Entry zero aggregates messages of unregistered types, whose
+    names aren't known. When message statistics are disabled, the default, the
+    report is zeroed and this method always returns false.
+
+    \param stats The statistics structure to be filled in.
+    \return True, if message statistics are enabled in the build.
+    */
+    bool GetMessageTypeStats(MessageTypeStats &stats) const;
+
+    /**
+    \brief Retrieves occupancy and hit rate statistics of the message block caches.
+
+    Message memory blocks are recycled through caches of free blocks: a shared,
+    thread-safe per-framework cache, and an unsynchronized per-thread cache in
+    each worker thread, which falls back to the shared cache when it misses.
+    This method aggregates the occupancy, hit and miss counts, and fallback
+    counts of all of the framework's caches into the caller's report, per block
+    size bin, so capacity alarms can act on real data rather than guesses:
+
+    \code
+    Theron::AllocatorCacheStats stats;
+    framework.GetAllocatorCacheStats(stats);
+
+    for (Theron::uint32_t bin = 0; bin < Theron::AllocatorCacheStats::MAX_POOLS; ++bin)
+    {
+        const Theron::AllocatorCacheStats::PoolStats &entry(stats.mPools[bin]);
+        if (entry.mHits || entry.mMisses)
+        {
+            printf("%u bytes: %u cached, %u hits, %u misses\n",
+                entry.mBlockSize,
+                entry.mCachedBlocks,
+                static_cast<Theron::uint32_t>(entry.mHits),
+                static_cast<Theron::uint32_t>(entry.mMisses));
+        }
+    }
+    \endcode
+
+    The counts are cumulative since the framework was constructed, so rates can
+    be derived by querying periodically and differencing; the cost of a query
+    is a bounded walk of the cache bins, cheap enough to scrape every few
+    seconds in production.
+
+    \note The per-thread caches are read without interrupting the worker
+    threads, so a report taken while the framework is busy is a momentary
+    approximation.
+
+    \param stats The statistics structure to be filled in.
+    */
+    void GetAllocatorCacheStats(AllocatorCacheStats &stats) const;
+
+    /**
+    \brief Saves the warm state of the message pools to a compact binary file.
+
+    The file records the configuration and fill level of the dedicated block
+    pool of every pooled message type (see \ref THERON_DECLARE_POOLED_MESSAGE).
+    A restarted process loads it through \ref Parameters::mWarmStatePath,
+    restoring each pool's configured depth and preallocating it back to its
+    saved fill level, so the first messages after a restart hit warm pools
+    instead of paying for the pools to refill on demand:
+
+    \code
+    Theron::Framework::Parameters params;
+    params.mWarmStatePath = "theron_pools.warm";
+
+    Theron::Framework framework(params);
+
+    // ... run the workload ...
+
+    // Save the warmed-up state for the next restart, typically at shutdown.
+    framework.SaveWarmState("theron_pools.warm");
+    \endcode
+
+    Pools are matched across restarts by message type ID and block size, both
+    of which are stable as long as the binary is unchanged; stale records from
+    an older binary are silently skipped on load.
+
+    \note The pools are process-wide, so the saved state covers all frameworks.
+
+    \param path Path of the warm state file to write.
+    \return True, if the file was written successfully.
+
+    \see Parameters::mWarmStatePath
+    */
+    bool SaveWarmState(const char *const path);
+
+    /**
+    \brief Changes the yield strategy of the worker threads at runtime.
+
+    The yield strategy is normally fixed at construction with
+    \ref Parameters::mYieldStrategy. Workloads that alternate between busy and
+    quiet phases can instead switch strategies as the phases change, trading
+    latency for CPU usage on the fly:
+
+    \code
+    Theron::Framework framework;
+
+    // Entering a latency-critical busy phase.
+    framework.SetYieldStrategy(Theron::YIELD_STRATEGY_AGGRESSIVE);
+
+    // ... and back to a quiet phase.
+    framework.SetYieldStrategy(Theron::YIELD_STRATEGY_POLITE);
+    \endcode
+
+    Alternatively, \ref YIELD_STRATEGY_ADAPTIVE tunes each worker's spin
+    budget to the observed work arrival rate continuously, with no explicit
+    phase-change calls.
+
+    \note The switch is applied to running workers without interrupting them,
+    so each worker adopts the new strategy the next time it looks for work.
+    Workers asleep under the blocking strategy when it is switched away from
+    wake within their bounded wait timeout.
+
+    \param yieldStrategy The yield strategy to switch to.
+
+    \see Parameters::mYieldStrategy
+    */
+    void SetYieldStrategy(const YieldStrategy yieldStrategy);
+
+    /**
+    \brief Sets the number of free message memory blocks cached per size class.
+
+    The framework caches free message memory blocks for reuse, both in a
+    shared per-framework cache and in a private cache per worker thread.
+    By default a fixed number of blocks is cached per block size. Workloads
+    with a known message size histogram can tune the cache depths per size,
+    deepening the caches for hot message sizes and shallowing them for others.
+
+    \code
+    Theron::Framework framework;
+
+    framework.SetMessageCacheDepth(256, 64);
+    \endcode
+
+    \note The block size covers the whole message memory block, which includes
+    internal per-message overhead of several pointers in addition to the copied
+    message value itself. Very small blocks share a single common cache whose
+    depth is bounded internally.
+
+    \param blockSize The size in bytes of the message memory blocks to configure.
+    \param maxBlocks The maximum number of free blocks of that size cached per cache.
+
+    \see Preallocate
+    */
+    void SetMessageCacheDepth(const uint32_t blockSize, const uint32_t maxBlocks);
+
+    /**
+    \brief Warms the message block caches with preallocated free blocks.
+
+    Message memory blocks are normally allocated on demand and cached for reuse
+    when freed, so the first burst of messages of a given size pays for its
+    allocations in full. This method preallocates free blocks of the given size
+    into the shared per-framework cache and the private cache of every worker
+    thread, eliminating those first-burst allocation spikes.
+
+    \code
+    Theron::Framework framework;
+
+    framework.Preallocate(256, 32);
+    \endcode
+
+    \note Must be called before any messages are sent within the framework,
+    typically right after construction; the per-thread caches aren't safe to
+    fill externally once the worker threads are processing messages. Blocks in
+    excess of the configured cache depth are discarded, so deepen the cache
+    with \ref SetMessageCacheDepth first when preheating beyond the defaults.
+
+    \param blockSize The size in bytes of the message memory blocks to preallocate.
+    \param count The number of free blocks of that size to add to each cache.
+
+    \see SetMessageCacheDepth
+    */
+    void Preallocate(const uint32_t blockSize, const uint32_t count);
+
+    /**
+    \brief Resets the \ref Counter "internal event counters".
+
+    \see Counter
+    \see GetCounterValue
+    */
+    void ResetCounters() const;
+
+    /**
+    \brief Gets the current value of a specified event counter.
+
+    Each Framework maintains a set of \ref Counter "internal event counters".
+    This method gets the current value of a specific counter, aggregated over all worker threads.
+    Event counters are summed over the threads, whereas the peak queue depth counters are
+    high water marks and so are aggregated by taking the maximum over the threads.
+
+    \note Each worker thread accumulates its counts in its own private slots,
+    written with plain stores so that counting costs the hot path no atomic
+    operations. Values read while the workers are running are therefore a
+    momentary sample; exact totals are only guaranteed once the framework
+    has gone idle.
+
+    \param counter One of several values of an \ref Counter "enumerated type" identifying the available counters.
+    \return Current value of the counter at the time of the call.
+
+    \see GetPerThreadCounterValues
+    \see ResetCounters
+    */
+    uint32_t GetCounterValue(const Counter counter) const;
+
+    /**
+    \brief Gets the current per-thread values of a specified event counter.
+
+    Each Framework maintains a set of \ref Counter "internal event counters".
+    This method gets the current value of the counter for each of the currently active worker threads.
+
+    \param counter One of several values of an \ref Counter "enumerated type" identifying the available counters.
+    \param perThreadCounts Pointer to an array of uint32_t to be filled with per-thread counter values.
+    \param maxCounts The size of the perThreadCounts array and hence the maximum number of values to fetch.
+    \return The actual number of per-thread values fetched, matching the number of currently active worker threads.
+
+    \see GetCounterValue
+    \see ResetCounters
+    */
+    uint32_t GetPerThreadCounterValues(const Counter counter, uint32_t *const perThreadCounts, const uint32_t maxCounts) const;
+
+    /**
+    \brief Registers a sink to receive periodic scheduler metrics samples.
+
+    The registered sink is called periodically by the framework's manager
+    thread with a snapshot of the scheduling state of every running worker
+    thread: processed message counts, local queue depths, steal counts, and
+    yield and sleep counts, plus the depth of the shared work queue. Pushing
+    the samples from the manager thread means telemetry doesn't need to poll
+    the counters from an external thread, touching every worker's context
+    from outside:
+
+    \code
+    Telemetry telemetry;
+    Theron::Framework framework;
+
+    framework.SetMetricsSink(&telemetry, 100 * 1000);
+    \endcode
+
+    \note The sampling period is rounded up to the service granularity of the
+    manager thread, which is a few milliseconds. The registered sink must
+    remain valid until it is replaced, cleared by passing a null sink, or the
+    framework is destructed; a sample already in progress when the sink is
+    cleared may complete after the clearing call returns.
+
+    \param sink Pointer to the sink called with the samples, or null to stop sampling.
+    \param periodMicroseconds Requested interval between samples, in microseconds.
+
+    \see MetricsSink
+    */
+    void SetMetricsSink(MetricsSink *const sink, const uint32_t periodMicroseconds);
+
+    /**
+    \brief Callback invoked when an allocation is refused by the framework's memory budget.
+
+    The attempted size of the refused allocation is passed to the callback,
+    together with the context pointer registered alongside it.
+
+    \note The callback is executed on the allocating thread, which may be a
+    worker thread or an application thread sending a message, so it must be
+    thread-safe. It must not send messages within the budgeted framework,
+    since those would allocate through the very chain that is out of budget.
+
+    \see SetMemoryPressureHandler
+    */
+    typedef void (MemoryPressureHandler)(void *context, uint32_t attemptedBytes);
+
+    /**
+    \brief Registers a handler invoked when the framework's memory budget refuses an allocation.
+
+    When a memory budget is configured with \ref Parameters::mMemoryBudgetBytes,
+    sends that would exceed it fail fast, returning false. Registering a
+    pressure handler additionally surfaces each refusal as it happens, so an
+    application can shed load or raise an alarm before failed sends are
+    noticed downstream:
+
+    \code
+    Theron::Framework::Parameters params;
+    params.mMemoryBudgetBytes = 64 * 1024 * 1024;
+
+    Theron::Framework framework(params);
+    framework.SetMemoryPressureHandler(&OnMemoryPressure, 0);
+    \endcode
+
+    \note The handler should be registered before the budget comes under
+    pressure; registration is not synchronized with allocating threads.
+
+    \param handler Pointer to the handler function, or null to clear it.
+    \param context User-defined context pointer passed to the handler.
+
+    \see Parameters::mMemoryBudgetBytes
+    \see GetMemoryBytesInUse
+    */
+    inline void SetMemoryPressureHandler(MemoryPressureHandler *const handler, void *const context);
+
+    /**
+    \brief Returns the bytes currently held against the framework's memory budget.
+
+    Counts the memory held by the framework's allocator chain, including
+    memory recycled in its internal caches, as admitted against \ref
+    Parameters::mMemoryBudgetBytes. Always zero when no budget is configured,
+    since unbudgeted allocations aren't accounted.
+
+    \see Parameters::mMemoryBudgetBytes
+    */
+    inline uint64_t GetMemoryBytesInUse() const;
+
+    /**
+    \brief Gets a snapshot of the handler execution profile of the actor at the given address.
+
+    When profiling is enabled with \ref THERON_ENABLE_PROFILING, every message
+    processed by an actor is timed, and the measured handler execution times are
+    accumulated per actor and per message type. This method copies a snapshot of
+    the accumulated profile of the actor at the given address, allowing hot
+    actors, and the hot message types within them, to be located without
+    external tooling:
+
+    \code
+    Theron::ActorProfile profile;
+    if (framework.GetActorProfile(actor.GetAddress(), profile))
+    {
+        for (Theron::uint32_t index = 0; index < profile.mTypeCount; ++index)
+        {
+            const Theron::ActorProfile::MessageTypeProfile &entry(profile.mTypes[index]);
+            printf("%s: %u messages, %u ticks max\n",
+                entry.mTypeName ? entry.mTypeName : "<unnamed>",
+                entry.mMessageCount,
+                (Theron::uint32_t) entry.mMaxTicks);
+        }
+    }
+    \endcode
+
+    The snapshot also carries a per-sender table attributing arrivals, and the
+    delay messages spent queued in the mailbox before being processed, to the
+    addresses that sent them, so the producer responsible for a consumer's
+    queue build-up can be identified directly:
+
+    \code
+    for (Theron::uint32_t index = 0; index < profile.mSenderCount; ++index)
+    {
+        const Theron::ActorProfile::SenderProfile &entry(profile.mSenders[index]);
+        printf("sender %u: %u messages, %u ticks queued in total\n",
+            entry.mSenderAddress,
+            entry.mMessageCount,
+            (Theron::uint32_t) entry.mTotalQueueTicks);
+    }
+    \endcode
+
+    \note The snapshot is taken without interrupting the actor, so the profile of
+    an actor currently being processed may be marginally stale. When profiling is
+    disabled, the default, this method always returns false.
+
+    \param address The address of an actor within this framework.
+    \param profile Receives a snapshot of the actor's accumulated profile.
+    \return True if a profile was fetched, otherwise false.
+
+    \see ActorProfile
+    */
+    bool GetActorProfile(const Address &address, ActorProfile &profile);
+
+    /**
+    \brief Sets the fallback message handler executed for unhandled messages.
+
+    The fallback handler registered with the framework is run:
+    - when a message is sent by an actor within this framework to an address at which no entity is currently registered.
+    - when a message is sent using the \ref Send method of this framework to an address at which no entity is currently registered.
+    - when a message is delivered to an actor within this framework in which neither a handler for that message type nor a default handler are registered, with the result that the message goes unhandled.
+
+    The main purpose of the fallback handler is for error reporting, and the default
+    fallback handler, which is used if no user-defined handler is explicitly set,
+    asserts to indicate an unhandled message, which is a common programming error.
+    The reporting of unhandled messages by the default fallback handler can be controlled
+    by the \ref THERON_ENABLE_UNHANDLED_MESSAGE_CHECKS define, whose default value is
+    defined in \ref Defines.h.
+
+    The handler function registered by this method overload is represented by a pointer to
+    a user-defined handler object, and a member function pointer identifying a handler
+    function that is a member function of the handler object. Handlers registered using
+    this method must expose a handler method that accepts a 'from' address, as shown by
+    the following example:
+
+    \code
+    class Handler
+    {
+    public:
+
+        inline void Handle(const Theron::Address from)
+        {
+            printf("Caught undelivered or unhandled message sent from address '%d'\n", from.AsInteger());
+        }
+    };
+
+    Theron::Framework framework;
+    Handler handler;
+    framework.SetFallbackHandler(&handler, &Handler::Handle);
+    \endcode
+
+    Users can call this method to replace the default fallback handler with their own
+    implementation, for example for more sophisticated error reporting or logging.
+
+    Passing 0 to this method clears any previously set fallback handler, or the
+    default fallback handler if no user-defined handler has previously been set.
+
+    \note There are two variants of SetFallbackHandler, accepting fallback handlers
+    with different function signatures. Handlers set using this method accept only a
+    'from' address, whereas handlers set using the other method also accept the 
+    unhandled message as 'blind' data (ie. a void pointer and a size in bytes).
+    Registering either kind of fallback handler replaces any previously set handler
+    of the other kind.
+
+    \tparam ObjectType The type of the handler object which owns the handler function.
+    \param actor Pointer to the handler object on which the handler function is a member function.
+    \param handler Member function pointer identifying the fallback handler function.
+    */
+    template <typename ObjectType>
+    inline bool SetFallbackHandler(
+        ObjectType *const actor,
+        void (ObjectType::*handler)(const Address from));
+
+    /**
+    \brief Sets the fallback message handler executed for unhandled messages.
+
+    This method sets a 'blind' default handler which, when executed, is passed the
+    unknown message as blind data. The blind data consists of the memory block containing
+    the message, identified by a void pointer and a size.
+
+    The fallback handler registered with the framework is run:
+    - when a message is sent by an actor within this framework to an address at which no entity is currently registered.
+    - when a message is sent using the \ref Send method of this framework to an address at which no entity is currently registered.
+    - when a message is delivered to an actor within this framework in which neither a handler for that message type nor a default handler are registered, with the result that the message goes unhandled.
+
+    The handler function registered by this method overload is passed the unhandled message
+    as 'blind' data represented by a void pointer and a message size in bytes. Handlers
+    registered using this method must expose a handler method that accepts a void pointer
+    identifying the message contents, a size indicating the size of the message data, and a
+    'from' address.
+
+    A user-defined handler may be able to inspect the contents of the message and
+    take appropriate action, such as reporting the contents of an unexpected message to help
+    with debugging.
+
+    \code
+    class Handler
+    {
+    public:
+
+        inline void Handle(const void *const data, const Theron::uint32_t size, const Theron::Address from)
+        {
+            printf("Caught undelivered or unhandled message of size %d sent from address '%d'\n", size, from.AsInteger());
+        }
+    };
+
+    Theron::Framework framework;
+    Handler handler;
+    framework.SetFallbackHandler(&handler, &Handler::Handle);
+    \endcode
+
+    Users can call this method to replace the default fallback handler with their own
+    implementation, for example for more sophisticated error reporting or logging.
+
+    Passing 0 to this method clears any previously set fallback handler, or the
+    default fallback handler if no user-defined handler has previously been set.
+
+    \note There are two variants of SetFallbackHandler, accepting fallback handlers
+    with different function signatures. Handlers set using this method accept the 
+    unhandled message as 'blind' data (ie. a void pointer and a size in bytes),
+    whereas handlers set using the other method accept only the 'from' address.
+    Registering either kind of fallback handler replaces any previously set handler
+    of the other kind.
+
+    \tparam ObjectType The type of the handler object which owns the handler function.
+    \param actor Pointer to the handler object on which the handler function is a member function.
+    \param handler Member function pointer identifying the fallback handler function.
+    */
+    template <typename ObjectType>
+    inline bool SetFallbackHandler(
+        ObjectType *const actor,
+        void (ObjectType::*handler)(const void *const data, const uint32_t size, const Address from));
+
+    /**
+    \brief Sets the fallback message handler executed for unhandled messages.
+
+    This method sets a 'view' fallback handler which, when executed, is passed
+    the unknown message as a refcounted \ref MessageView. Like a blind handler,
+    a view handler sees the message payload as untyped bytes; unlike a blind
+    handler, it can retain a copy of the view beyond its own return, which
+    keeps the payload bytes valid until the last view is released. Code that
+    hands caught payloads to systems outside Theron can therefore pass the
+    viewed bytes along directly, instead of defensively copying them before
+    the handler returns.
+
+    \code
+    class Handler
+    {
+    public:
+
+        inline void Handle(const Theron::MessageView &view, const Theron::Address from)
+        {
+            // The retained view keeps the payload alive after this returns.
+            mRetained = view;
+        }
+
+        Theron::MessageView mRetained;
+    };
+
+    Theron::Framework framework;
+    Handler handler;
+    framework.SetFallbackHandler(&handler, &Handler::Handle);
+    \endcode
+
+    Passing 0 to this method clears any previously set fallback handler, or the
+    default fallback handler if no user-defined handler has previously been set.
+
+    \note As with the other variants of SetFallbackHandler, registering a
+    handler of this kind replaces any previously set handler of any kind.
+
+    \tparam ObjectType The type of the handler object which owns the handler function.
+    \param actor Pointer to the handler object on which the handler function is a member function.
+    \param handler Member function pointer identifying the fallback handler function.
+    */
+    template <typename ObjectType>
+    inline bool SetFallbackHandler(
+        ObjectType *const actor,
+        void (ObjectType::*handler)(const MessageView &view, const Address from));
+
+#if !THERON_NO_LEGACY
+
+    /**
+    \brief Deprecated method provided for backwards compatibility.
+
+    \note In versions of Theron from 4.0 onwards, there is no need to use this method.
+    It is provided only for backwards compatibility.
+
+    In versions of Theron prior to 4.0, actors couldn't be constructed directly
+    in user code. Instead you had to ask a Framework to create one for you, using
+    the CreateActor method template. Instead of returning the actor itself,
+    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
+    object.
+
+    \code
+    // LEGACY CODE!
+    class MyActor : public Theron::Actor
+    {
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        Theron::ActorRef actorRef(framework.CreateActor<MyActor>());
+    }
+    \endcode
+
+    In versions of Theron starting with 4.0, Actors are first-class citizens and
+    behave like vanilla C++ objects. They can be constructed directly with no
+    call to Framework::CreateActor. Once constructed they are referenced directly
+    by user code with no need for ActorRef proxy objects.
+
+    When writing new code, follow the new, simpler construction pattern where actors
+    are constructed directly and not referenced by ActorRefs:
+
+    \code
+    // New code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        MyActor actor(framework);
+    }
+    \endcode
+    */
+    template <class ActorType>
+    ActorRef CreateActor();
+
+    /**
+    \brief Deprecated method provided for backwards compatibility.
+
+    \note In versions of Theron from 4.0 onwards, there is no need to use this method.
+    It is provided only for backwards compatibility.
+
+    In versions of Theron prior to 4.0, actors couldn't be constructed directly
+    in user code. Instead you had to ask a Framework to create one for you, using
+    the CreateActor method template. Instead of returning the actor itself,
+    CreateActor returned a <i>reference</i> to the actor in the form of an \ref ActorRef
+    object.
+
+    \code
+    // LEGACY CODE!
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        struct Parameters
+        {
+            int mSomeParameter;
+        }
+
+        MyActor(const Parameters &params)
+        {
+        }
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        MyActor::Parameters params;
+        params.mSomeParameter = 0;
+        Theron::ActorRef actorRef(framework.CreateActor<MyActor>(params));
+    }
+    \endcode
+
+    When writing new code, follow the new, simpler construction pattern where actors
+    are constructed directly and not referenced by ActorRefs:
+
+    \code
+    // New code
+    class MyActor : public Theron::Actor
+    {
+    public:
+
+        MyActor(Theron::Framework &framework, const int mSomeParameter) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    int main()
+    {
+        Theron::Framework framework;
+        MyActor actor(framework, 0);
+    }
+    \endcode
+    */
+    template <class ActorType>
+    ActorRef CreateActor(const typename ActorType::Parameters &params);
+
+#endif // !THERON_NO_LEGACY
+
+    /**
+    \brief Creates a contiguous block of actors of the given type in one bulk operation.
+
+    Constructing actors one at a time claims a mailbox index and checks the
+    mailbox directory's page table once per instance. For applications that
+    boot large populations of actors, this method instead reserves a
+    contiguous range of mailbox indices, and the directory pages covering it,
+    in one operation, and constructs the actors into a single allocated slab,
+    cutting startup time for large populations by orders of magnitude.
+
+    The actor type must define a constructor taking a reference to the owning
+    framework, which is the argument passed to each constructed instance:
+
+    \code
+    class Worker : public Theron::Actor
+    {
+    public:
+        explicit Worker(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    Theron::Framework framework;
+    Worker *const workers(framework.CreateActors<Worker>(100000));
+
+    // ...
+
+    framework.DestroyActors(workers, 100000);
+    \endcode
+
+    The created actors are owned by the caller and must be destroyed with
+    \ref DestroyActors, passing the same count. The mailbox indices of the
+    block are consecutive, so the addresses of the actors are consecutive too.
+
+    \param count Number of actors to create.
+    \return Pointer to the first actor of the contiguous block, or zero on failure.
+
+    \see DestroyActors
+    */
+    template <class ActorType>
+    ActorType *CreateActors(const uint32_t count);
+
+    /**
+    \brief Destroys a block of actors previously created with \ref CreateActors.
+
+    Destructs the actors in reverse construction order and frees the slab
+    holding them.
+
+    \param actors Pointer to the first actor of the block, as returned by \ref CreateActors.
+    \param count Number of actors in the block, as passed to \ref CreateActors.
+
+    \see CreateActors
+    */
+    template <class ActorType>
+    void DestroyActors(ActorType *const actors, const uint32_t count);
+
+    /**
+    \brief Constructs an actor into slab storage owned by the framework.
+
+    Ordinary actor construction leaves storage management to the caller: each
+    actor is placed in caller-owned memory with its own independent lifetime,
+    which for dense populations means one heap allocation, and one heap
+    header's worth of overhead, per actor. This method instead places the
+    actor into one of a chain of large storage slabs owned by the framework
+    itself, bump-allocating consecutive constructions from the same slab, so
+    actor state is packed densely for iteration and the per-actor overhead
+    falls to a small in-slab header.
+
+    The framework is passed as the first constructor argument, followed by
+    any additional arguments given here:
+
+    \code
+    class Particle : public Theron::Actor
+    {
+    public:
+        Particle(Theron::Framework &framework, const float mass) : Theron::Actor(framework), mMass(mass)
+        {
+        }
+
+    private:
+        float mMass;
+    };
+
+    Theron::Framework framework;
+    Particle *const particle(framework.ConstructActor<Particle>(1.5f));
+    \endcode
+
+    Actors constructed this way are owned by the framework and must not be
+    destructed by the caller: they are destructed in slab order, which is
+    construction order, when the framework itself is destructed. Unlike
+    \ref CreateActors, the constructions need not be homogeneous or batched;
+    actors of different types share the slabs.
+
+    \param args Constructor arguments forwarded after the framework reference.
+    \return Pointer to the constructed actor, or zero on failure.
+
+    \note Thread-safe; concurrent constructions are serialized internally.
+
+    \see CreateActors
+    */
+#if THERON_CPP11
+    template <class ActorType, typename... Args>
+    ActorType *ConstructActor(Args &&... args);
+#else
+    template <class ActorType>
+    ActorType *ConstructActor();
+#endif // THERON_CPP11
+
+private:
+
+    typedef Detail::ThreadPool<Detail::Processor, Detail::Processor::Context> ThreadPool;
+    typedef Detail::List<ThreadPool::ThreadContext> ContextList;
+    typedef Detail::CachingAllocator<32, Detail::SpinLock> MessageCache;
+
+    Framework(const Framework &other);
+    Framework &operator=(const Framework &other);
+
+    /**
+    Initializes a framework object at start of day.
+    This function is called by the various constructor flavors and avoids repeating the code.
+    */
+    void Initialize();
+
+    /**
+    Tears down a framework object prior to destruction.
+    */
+    void Release();
+
+    /**
+    Gets the non-zero index of this framework, unique within the local process.
+    */
+    inline uint32_t GetIndex() const;
+
+    /**
+    Makes the sampling decision for a message sent from outside a message
+    handler, which starts a new causality flow if it is sampled.
+    \return A unique non-zero flow ID if the new flow is sampled; zero otherwise.
+    */
+    inline uint64_t SampleFlowId();
+
+    /**
+    Registers a new actor in the directory and allocates a mailbox.
+    */
+    void RegisterActor(Actor *const actor, const char *const name = 0);
+
+    /**
+    Deregisters a previously registered actor.
+    */
+    void DeregisterActor(Actor *const actor);
+
+#if THERON_ACTOR_STORE_SIZE
+    /**
+    Clears an actor's record of its owning memory block, marking it as
+    co-located with the store of its own mailbox, which isn't separately freed.
+    \note Defined in Framework.cpp, where Actor is complete; here Actor is
+    only forward declared, so the member can't be assigned directly.
+    */
+    static void MarkActorColocated(Actor *const actor);
+#endif // THERON_ACTOR_STORE_SIZE
+
+    /**
+    Redirects a mailbox of this framework to a successor mailbox, cutting off
+    any still-registered incumbent actor and leaving a forwarding address, as
+    MigrateActor does. Used by RespawnActor.
+    */
+    bool RedirectMailbox(const Address &address, const Address &target);
+
+    /**
+    Constructs the envelope of a message allocated with AllocateMessage, whose
+    value the caller has constructed in place, and sends it. Called by
+    MessageBuilder::Commit.
+    */
+    template <class ValueType>
+    inline bool CommitMessage(void *const block, const Address &from, const Address &address);
+
+    /**
+    Frees a message block allocated with AllocateMessage without sending it.
+    Called by MessageBuilder::Abandon. Any value constructed in the block is
+    not destructed.
+    */
+    template <class ValueType>
+    inline void AbandonMessage(void *const block);
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+    /**
+    Tries to claim a message block from the micro-pool embedded in the mailbox
+    at the given address, for a send to an actor flagged high-rate.
+    \return Pointer to a block, or zero if the destination isn't a concrete
+    mailbox of this framework or no fitting slot could be claimed.
+    */
+    inline void *ClaimPooledBlock(const Address &address, const uint32_t size, const uint32_t alignment);
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+    /**
+    Receives a message from another framework.
+    */
+    inline bool FrameworkReceive(
+        Detail::IMessage *const message,
+        const Address &address);
+
+    /**
+    Checks whether all work queues in the framework are empty.
+    */
+    bool QueuesEmpty() const;
+
+    /**
+    Static entry point function for the manager thread.
+    This is a static function that calls the real entry point member function.
+    */
+    static void ManagerThreadEntryPoint(void *const context);
+
+    /**
+    Entry point member function for the manager thread.
+    */
+    void ManagerThreadProc();
+
+    /**
+    Runs one sample of the worker count control loop, called periodically by the
+    manager thread. Samples the depth of the shared work queue and the rate of
+    message processing, and adjusts the target thread count within the bounds
+    set by SetMinThreads and SetMaxThreads.
+    */
+    void ManageThreadCount();
+
+    /**
+    Pushes a metrics snapshot of all running workers to the registered sink,
+    called periodically by the manager thread.
+    */
+    void SampleMetrics();
+
+    EndPoint *const mEndPoint;                              ///< Pointer to the network endpoint, if any, to which this framework is tied.
+    const Parameters mParams;                               ///< Copy of parameters struct provided on construction.
+    YieldStrategy mYieldStrategy;                           ///< Active yield strategy of the worker threads; changeable at runtime with SetYieldStrategy.
+    uint32_t mIndex;                                        ///< Non-zero index of this framework, unique within the local process.
+    Detail::String mName;                                   ///< Name of this framework.
+    Detail::BudgetAllocator mBudgetAllocator;               ///< Budget-enforcing adapter over the general allocator, bounding this framework's memory use.
+    Detail::NumaAllocator mNodeAllocator;                   ///< Node-local arena allocator backing this framework's allocations on NUMA systems.
+    Detail::Directory<Detail::Mailbox> mMailboxes;          ///< Per-framework mailbox array.
+    Detail::FallbackHandlerCollection mFallbackHandlers;    ///< Registered message handlers run for unhandled messages.
+    Detail::DefaultFallbackHandler mDefaultFallbackHandler; ///< Default handler for unhandled messages.
+    mutable Detail::SpinLock mSharedWorkQueueSpinLock;      ///< Protects the work queue shared by the worker threads.
+    Detail::Condition mWorkerCondition;                     ///< Condition that idle workers block on under the blocking yield strategy.
+    Detail::Atomic::UInt32 mNumSleepingWorkers;             ///< Count of workers currently blocked on the condition.
+    Detail::Atomic::Pointer mParallelTask;                  ///< Slot holding the active parallel compute task, executed by idle workers; zero if none.
+    MessageCache mMessageAllocator;                         ///< Thread-safe per-framework cache of message memory blocks.
+    Detail::Processor::Context mProcessorContext;           ///< Per-framework processor context.
+    Detail::TimerWheel mTimerWheel;                         ///< Pending delayed and periodic sends, serviced by the manager thread.
+    Detail::IngressThrottle mIngressThrottle;               ///< Token bucket pacing sends from non-actor code.
+    Detail::Atomic::UInt64 mFlowSequence;                   ///< Count of flow-root sends, used for flow sampling and ID generation.
+    Detail::Thread mManagerThread;                          ///< Dynamically creates and destroys the worker threads.
+    bool mRunning;                                          ///< Flag used to terminate the manager thread.
+    bool mReleased;                                         ///< Flag marking that the framework has already been torn down.
+    bool mFastShutdown;                                     ///< Flag selecting the leak-everything teardown; set by FastShutdown.
+    Detail::Atomic::UInt32 mTargetThreadCount;              ///< Desired number of worker threads.
+    Detail::Atomic::UInt32 mMinThreadCount;                 ///< Lower bound on the worker count, below which automatic scaling never goes.
+    Detail::Atomic::UInt32 mMaxThreadCount;                 ///< Upper bound on the worker count, above which automatic scaling never goes.
+    Detail::Atomic::UInt32 mPeakThreadCount;                ///< Peak number of worker threads.
+    Detail::Atomic::UInt32 mThreadCount;                    ///< Actual number of worker threads.
+    Detail::Atomic::UInt32 mBlockedThreadCount;             ///< Number of workers currently parked in blocking sections.
+    uint32_t mScaleUpSamples;                               ///< Consecutive control loop samples that favored adding a worker; manager thread only.
+    uint32_t mScaleDownSamples;                             ///< Consecutive control loop samples that favored retiring a worker; manager thread only.
+    uint32_t mLastProcessedCount;                           ///< Processed message counter total at the last control loop sample; manager thread only.
+    uint32_t mIdleSamples;                                  ///< Consecutive manager loop samples with no message traffic; manager thread only.
+    uint32_t mLastIdleProcessedCount;                       ///< Processed message counter total at the last idleness sample; manager thread only.
+    MetricsSink *mMetricsSink;                              ///< Registered scheduler metrics sink, if any; written under the thread context lock.
+    uint32_t mMetricsPeriod;                                ///< Requested interval between metrics samples, in microseconds.
+    uint64_t mNextMetricsTime;                              ///< Clock time at which the next metrics sample is due; manager thread only.
+    ContextList mThreadContexts;                            ///< List of worker thread context objects.
+    mutable Detail::SpinLock mThreadContextLock;            ///< Protects the thread context list.
+
+    /**
+    An in-progress bulk actor creation. The reservation is published while the
+    actors are being constructed, so that RegisterActor can recognize actors
+    constructed into the reserved slab and hand them preallocated mailbox
+    indices from the reserved range.
+    */
+    struct BulkReservation
+    {
+        const void *mSlabBegin;                             ///< First byte of the slab the actors are constructed into.
+        const void *mSlabEnd;                               ///< One past the last byte of the slab.
+        uint32_t mNextIndex;                                ///< Next unclaimed mailbox index in the reserved range.
+        uint32_t mEndIndex;                                 ///< One past the last mailbox index in the reserved range.
+    };
+
+    mutable Detail::SpinLock mBulkCreateLock;               ///< Serializes bulk actor creations; at most one reservation is active at a time.
+    Detail::Atomic::Pointer mBulkReservation;               ///< Pointer to the active bulk creation reservation, if any.
+
+    /**
+    Maximum number of worker contexts that can participate in work stealing.
+    Worker threads beyond this limit still run but aren't stolen from.
+    */
+    static const uint32_t MAX_WORKER_CONTEXTS = 128;
+
+    /**
+    Size in bytes of one slot of the contiguous worker context array, rounded
+    up to a multiple of the cache line size so that the counters and caches of
+    neighboring workers never share a cache line.
+    */
+    static const uint32_t WORKER_CONTEXT_STRIDE =
+        (sizeof(Detail::Processor::Context) + THERON_CACHELINE_ALIGNMENT - 1) & ~(THERON_CACHELINE_ALIGNMENT - 1);
+
+    Detail::Processor::Context *mWorkerContexts[MAX_WORKER_CONTEXTS];   ///< Array of pointers to worker contexts, shared with workers for steal victim selection.
+    Detail::Atomic::UInt32 mWorkerContextCount;             ///< Count of valid entries in the worker context array; only ever grows.
+    uint8_t *mWorkerContextSlab;                            ///< Cache-line-padded contiguous array holding the worker contexts, ordered by worker index.
+
+    /**
+    Default factory used by the typed \ref CreateActorAsync overload.
+    */
+    template <class ActorType>
+    inline static Actor *ConstructActor(Framework &framework, void *const context);
+
+    mutable Detail::SpinLock mActorCreatorLock;             ///< Serializes lazy creation of the internal creator actor.
+    Actor *mActorCreator;                                   ///< Internal actor that executes asynchronous construction requests; created on first use.
+
+    /**
+    Header preceding each actor constructed into the framework-owned slabs.
+    Links the owned actors in construction order and records a type-erased
+    destructor; the actor is placed immediately after its header.
+    */
+    struct OwnedActorHeader
+    {
+        OwnedActorHeader *mNext;                            ///< Header of the next owned actor, in construction order.
+        void (*mDestruct)(void *const actor);               ///< Destructs the actor placed after this header.
+    };
+
+    /**
+    One slab of framework-owned actor storage. The slab structure sits at the
+    start of its allocation, with the actor storage bump-allocated after it.
+    */
+    struct OwnedActorSlab
+    {
+        OwnedActorSlab *mNext;                              ///< Next slab in the chain.
+        uint32_t mSize;                                     ///< Total size in bytes of the slab allocation.
+        uint32_t mUsed;                                     ///< Offset in bytes of the first free byte of the slab.
+    };
+
+    /**
+    Default size in bytes of a framework-owned actor slab. Actors too large to
+    fit get a dedicated slab of their own.
+    */
+    static const uint32_t OWNED_ACTOR_SLAB_SIZE = 64 * 1024;
+
+    /**
+    Carves storage for one owned actor, and the header preceding it, from the
+    slab chain, growing the chain when the current slab is full.
+    */
+    void *AllocateOwnedActorStorage(const uint32_t size, const uint32_t alignment, OwnedActorHeader *&header);
+
+    /**
+    Destructs the actors constructed into the framework-owned slabs, in
+    construction order, and frees the slabs.
+    */
+    void DestroyOwnedActors();
+
+    /**
+    Destructor thunk of one framework-owned actor type.
+    */
+    template <class ActorType>
+    inline static void DestructOwnedActor(void *const actor);
+
+    mutable Detail::SpinLock mActorSlabLock;                ///< Protects the owned actor slab chain and list.
+    OwnedActorSlab *mActorSlabs;                            ///< Chain of framework-owned actor storage slabs.
+    OwnedActorHeader *mOwnedActorsHead;                     ///< Header of the first actor constructed into the slabs.
+    OwnedActorHeader *mOwnedActorsTail;                     ///< Header of the last actor constructed into the slabs.
+};
+
+
+inline Framework::Framework(const uint32_t threadCount) :
+  mEndPoint(0),
+  mParams(threadCount),
+  mYieldStrategy(mParams.mYieldStrategy),
+  mIndex(0),
+  mName(),
+  mBudgetAllocator(AllocatorManager::Instance().GetAllocator(), mParams.mMemoryBudgetBytes),
+  mNodeAllocator(&mBudgetAllocator, mParams.mNodeMask),
+  mMailboxes(),
+  mFallbackHandlers(),
+  mDefaultFallbackHandler(),
+  mSharedWorkQueueSpinLock(),
+  mWorkerCondition(),
+  mNumSleepingWorkers(0),
+  mMessageAllocator(&mNodeAllocator),
+  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
+  mTimerWheel(),
+  mManagerThread(),
+  mRunning(false),
+  mReleased(false),
+  mFastShutdown(false),
+  mTargetThreadCount(0),
+  mMinThreadCount(0),
+  mMaxThreadCount(0),
+  mPeakThreadCount(0),
+  mThreadCount(0),
+  mBlockedThreadCount(0),
+  mScaleUpSamples(0),
+  mScaleDownSamples(0),
+  mLastProcessedCount(0),
+  mIdleSamples(0),
+  mLastIdleProcessedCount(0),
+  mMetricsSink(0),
+  mMetricsPeriod(0),
+  mNextMetricsTime(0),
+  mThreadContexts(),
+  mThreadContextLock(),
+  mBulkCreateLock(),
+  mBulkReservation(),
+  mWorkerContextCount(0),
+  mWorkerContextSlab(0),
+  mActorCreatorLock(),
+  mActorCreator(0),
+  mActorSlabLock(),
+  mActorSlabs(0),
+  mOwnedActorsHead(0),
+  mOwnedActorsTail(0)
+{
+    Detail::BuildDescriptor::Check();
+
+    Initialize();
+}
+
+
+inline Framework::Framework(const Parameters &params) :
+  mEndPoint(0),
+  mParams(params),
+  mYieldStrategy(mParams.mYieldStrategy),
+  mIndex(0),
+  mName(),
+  mBudgetAllocator(AllocatorManager::Instance().GetAllocator(), mParams.mMemoryBudgetBytes),
+  mNodeAllocator(&mBudgetAllocator, mParams.mNodeMask),
+  mMailboxes(),
+  mFallbackHandlers(),
+  mDefaultFallbackHandler(),
+  mSharedWorkQueueSpinLock(),
+  mWorkerCondition(),
+  mNumSleepingWorkers(0),
+  mMessageAllocator(&mNodeAllocator),
+  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
+  mTimerWheel(),
+  mManagerThread(),
+  mRunning(false),
+  mReleased(false),
+  mFastShutdown(false),
+  mTargetThreadCount(0),
+  mMinThreadCount(0),
+  mMaxThreadCount(0),
+  mPeakThreadCount(0),
+  mThreadCount(0),
+  mBlockedThreadCount(0),
+  mScaleUpSamples(0),
+  mScaleDownSamples(0),
+  mLastProcessedCount(0),
+  mIdleSamples(0),
+  mLastIdleProcessedCount(0),
+  mMetricsSink(0),
+  mMetricsPeriod(0),
+  mNextMetricsTime(0),
+  mThreadContexts(),
+  mThreadContextLock(),
+  mBulkCreateLock(),
+  mBulkReservation(),
+  mWorkerContextCount(0),
+  mWorkerContextSlab(0),
+  mActorCreatorLock(),
+  mActorCreator(0),
+  mActorSlabLock(),
+  mActorSlabs(0),
+  mOwnedActorsHead(0),
+  mOwnedActorsTail(0)
+{
+    Detail::BuildDescriptor::Check();
+
+    Initialize();
+}
+
+
+inline Framework::Framework(EndPoint &endPoint, const char *const name, const Parameters &params) :
+  mEndPoint(&endPoint),
+  mParams(params),
+  mYieldStrategy(mParams.mYieldStrategy),
+  mIndex(0),
+  mName(name),
+  mBudgetAllocator(AllocatorManager::Instance().GetAllocator(), mParams.mMemoryBudgetBytes),
+  mNodeAllocator(&mBudgetAllocator, mParams.mNodeMask),
+  mMailboxes(),
+  mFallbackHandlers(),
+  mDefaultFallbackHandler(),
+  mSharedWorkQueueSpinLock(),
+  mWorkerCondition(),
+  mNumSleepingWorkers(0),
+  mMessageAllocator(&mNodeAllocator),
+  mProcessorContext(&mMailboxes, &mSharedWorkQueueSpinLock, &mFallbackHandlers, &mMessageAllocator),
+  mTimerWheel(),
+  mManagerThread(),
+  mRunning(false),
+  mReleased(false),
+  mFastShutdown(false),
+  mTargetThreadCount(0),
+  mMinThreadCount(0),
+  mMaxThreadCount(0),
+  mPeakThreadCount(0),
+  mThreadCount(0),
+  mBlockedThreadCount(0),
+  mScaleUpSamples(0),
+  mScaleDownSamples(0),
+  mLastProcessedCount(0),
+  mIdleSamples(0),
+  mLastIdleProcessedCount(0),
+  mMetricsSink(0),
+  mMetricsPeriod(0),
+  mNextMetricsTime(0),
+  mThreadContexts(),
+  mThreadContextLock(),
+  mBulkCreateLock(),
+  mBulkReservation(),
+  mWorkerContextCount(0),
+  mWorkerContextSlab(0),
+  mActorCreatorLock(),
+  mActorCreator(0),
+  mActorSlabLock(),
+  mActorSlabs(0),
+  mOwnedActorsHead(0),
+  mOwnedActorsTail(0)
+{
+    Detail::BuildDescriptor::Check();
+
+    Initialize();
+}
+
+
+inline Framework::~Framework()
+{
+    Release();
+}
+
+
+#if THERON_CPP11
+
+template <typename ValueType>
+THERON_FORCEINLINE bool Framework::Send(ValueType &&value, const Address &from, const Address &address)
+{
+    // The deduced type may be a reference or const-qualified; the message holds the plain value type.
+    // Arrays can't be sent as messages, and would otherwise silently decay to pointers here.
+    static_assert(!std::is_array<typename std::remove_reference<ValueType>::type>::value, "Arrays can't be sent as messages");
+    typedef typename std::decay<ValueType>::type MessageType;
+
+    // Pace sends from non-actor code when an ingress rate limit is configured.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    Detail::IMessage *message(0);
+
+#if THERON_MAILBOX_POOL_SLOTS
+    // Sends to actors flagged high-rate claim their blocks from the micro-pool
+    // embedded in the destination mailbox, when the message fits a slot.
+    void *const pooledBlock(ClaimPooledBlock(
+        address,
+        Detail::Message<MessageType>::GetSize(),
+        Detail::Message<MessageType>::GetAlignment()));
+
+    if (pooledBlock)
+    {
+        message = Detail::Message<MessageType>::InitializePooled(pooledBlock, std::forward<ValueType>(value), from);
+    }
+    else
+#endif // THERON_MAILBOX_POOL_SLOTS
+    {
+        // Allocate a message. It'll be deleted by the worker thread that handles it.
+        // The value is forwarded into the message, so is moved rather than copied if it's an rvalue.
+        message = Detail::MessageCreator::Create<MessageType, ValueType>(
+            messageAllocator,
+            std::forward<ValueType>(value),
+            from);
+    }
+
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Call the message sending implementation using the processor context of the framework.
+    // When messages are sent using Framework::Send there's no obvious worker thread.
+    return Detail::MessageSender::Send(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        message,
+        address);
+}
+
+#else // THERON_CPP11
+
+template <typename ValueType>
+THERON_FORCEINLINE bool Framework::Send(const ValueType &value, const Address &from, const Address &address)
+{
+    // Pace sends from non-actor code when an ingress rate limit is configured.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    Detail::IMessage *message(0);
+
+#if THERON_MAILBOX_POOL_SLOTS
+    // Sends to actors flagged high-rate claim their blocks from the micro-pool
+    // embedded in the destination mailbox, when the message fits a slot.
+    void *const pooledBlock(ClaimPooledBlock(
+        address,
+        Detail::Message<ValueType>::GetSize(),
+        Detail::Message<ValueType>::GetAlignment()));
+
+    if (pooledBlock)
+    {
+        message = Detail::Message<ValueType>::InitializePooled(pooledBlock, value, from);
+    }
+    else
+#endif // THERON_MAILBOX_POOL_SLOTS
+    {
+        // Allocate a message. It'll be deleted by the worker thread that handles it.
+        message = Detail::MessageCreator::Create(messageAllocator, value, from);
+    }
+
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Call the message sending implementation using the processor context of the framework.
+    // When messages are sent using Framework::Send there's no obvious worker thread.
+    return Detail::MessageSender::Send(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        message,
+        address);
+}
+
+#endif // THERON_CPP11
+
+
+THERON_FORCEINLINE MailboxHandle Framework::GetMailboxHandle(const Address &address)
+{
+    const Detail::Index index(address.mIndex);
+
+    // Only concrete addresses of actors within this framework can be pinned.
+    // Name-only addresses, receivers and actors in other frameworks get an
+    // invalid handle, and keep using the address-based sends.
+    if (index.mUInt32 == 0 || index.mComponents.mFramework != mIndex)
+    {
+        return MailboxHandle();
+    }
+
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(index.mComponents.mIndex));
+    return MailboxHandle(&mailbox, address);
+}
+
+
+#if THERON_CPP11
+
+template <typename ValueType>
+THERON_FORCEINLINE bool Framework::Send(ValueType &&value, const Address &from, const MailboxHandle &handle)
+{
+    // The deduced type may be a reference or const-qualified; the message holds the plain value type.
+    // Arrays can't be sent as messages, and would otherwise silently decay to pointers here.
+    static_assert(!std::is_array<typename std::remove_reference<ValueType>::type>::value, "Arrays can't be sent as messages");
+    typedef typename std::decay<ValueType>::type MessageType;
+
+    if (!handle.IsValid())
+    {
+        return false;
+    }
+
+    // Pace sends from non-actor code when an ingress rate limit is configured.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    // The value is forwarded into the message, so is moved rather than copied if it's an rvalue.
+    Detail::IMessage *const message(Detail::MessageCreator::Create<MessageType, ValueType>(
+        messageAllocator,
+        std::forward<ValueType>(value),
+        from));
+
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Push directly into the pinned mailbox, with no per-send resolution of
+    // the destination address through the directory.
+    return Detail::MessageSender::SendToMailbox(
+        &mProcessorContext,
+        handle.mMailbox,
+        handle.mAddress,
+        message);
+}
+
+#else // THERON_CPP11
+
+template <typename ValueType>
+THERON_FORCEINLINE bool Framework::Send(const ValueType &value, const Address &from, const MailboxHandle &handle)
+{
+    if (!handle.IsValid())
+    {
+        return false;
+    }
+
+    // Pace sends from non-actor code when an ingress rate limit is configured.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(messageAllocator, value, from));
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Push directly into the pinned mailbox, with no per-send resolution of
+    // the destination address through the directory.
+    return Detail::MessageSender::SendToMailbox(
+        &mProcessorContext,
+        handle.mMailbox,
+        handle.mAddress,
+        message);
+}
+
+#endif // THERON_CPP11
+
+
+template <typename ValueType>
+THERON_FORCEINLINE bool Framework::SendWithDeadline(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint32_t deadlineMicroseconds)
+{
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Allocate a message. It'll be deleted by the worker thread that handles it.
+    Detail::IMessage *const message(Detail::MessageCreator::Create(messageAllocator, value, from));
+    if (message == 0)
+    {
+        return false;
+    }
+
+    // Stamp the message with its absolute deadline, against which the mailbox
+    // is scheduled and lateness is detected at processing time.
+    message->SetDeadline(Detail::ProfileClock::GetMicroseconds() + deadlineMicroseconds);
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Call the message sending implementation using the processor context of the framework.
+    // When messages are sent using Framework::Send there's no obvious worker thread.
+    return Detail::MessageSender::Send(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        message,
+        address);
+}
+
+
+template <typename ValueType>
+inline uint32_t Framework::SendBatch(
+    const ValueType *const values,
+    const uint32_t count,
+    const Address &from,
+    const Address &address)
+{
+    // Batching pays off only on the direct path to a mailbox in this framework.
+    // Name-only addresses and addresses in other frameworks (or receivers) go
+    // through the generic per-message machinery, which handles those cases.
+    const Detail::Index index(address.mIndex);
+    if (index.mUInt32 == 0 || index.mComponents.mFramework != mIndex)
+    {
+        uint32_t numSent(0);
+        while (numSent < count && Send(values[numSent], from, address))
+        {
+            ++numSent;
+        }
+
+        return numSent;
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Resolve the destination mailbox once for the whole batch.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(index.mComponents.mIndex));
+
+    uint32_t numSent(0);
+    while (numSent < count)
+    {
+        // Each message in the batch consumes an ingress token, like a send.
+        if (mIngressThrottle.Enabled())
+        {
+            mIngressThrottle.Acquire();
+        }
+
+        // Stop early if a bounded mailbox fills up; the caller can retry the tail.
+        if (mailbox.Full())
+        {
+            break;
+        }
+
+        Detail::IMessage *const message(Detail::MessageCreator::Create(
+            messageAllocator,
+            values[numSent],
+            from));
+
+        if (message == 0)
+        {
+            break;
+        }
+
+        // The push is lock-free and tells us whether we're responsible for scheduling.
+        // Typically only the first push of the batch finds the mailbox unscheduled,
+        // so the whole batch costs a single scheduling event.
+        if (mailbox.Push(message))
+        {
+            Detail::Processor::Schedule(&mProcessorContext, &mailbox, false);
+        }
+
+        ++numSent;
+    }
+
+    // If the batch took the queue depth up through the high watermark then
+    // deliver a single watermark event for the batch, as the send path does per message.
+    if (mailbox.RoseAboveWatermark())
+    {
+        QueueWatermarkEvent event;
+        event.mDepth = mailbox.Count();
+        event.mHigh = true;
+
+        Detail::IMessage *const eventMessage(Detail::MessageCreator::Create(
+            messageAllocator,
+            event,
+            address));
+
+        if (eventMessage && mailbox.Push(eventMessage))
+        {
+            Detail::Processor::Schedule(&mProcessorContext, &mailbox, false);
+        }
+    }
+
+    return numSent;
+}
+
+
+inline uint32_t Framework::SendBatch(
+    Detail::IMessage *const *const messages,
+    const uint32_t count,
+    const Address &address)
+{
+    // Each envelope in the batch consumes an ingress token, like a send.
+    if (mIngressThrottle.Enabled())
+    {
+        for (uint32_t current = 0; current < count; ++current)
+        {
+            mIngressThrottle.Acquire();
+        }
+    }
+
+    // As for the homogeneous overload, only the direct path to a mailbox in
+    // this framework is batched; other addresses take per-message sends.
+    const Detail::Index index(address.mIndex);
+    if (index.mUInt32 == 0 || index.mComponents.mFramework != mIndex)
+    {
+        uint32_t numSent(0);
+        for (uint32_t current = 0; current < count; ++current)
+        {
+            if (Detail::MessageSender::Send(
+                mEndPoint,
+                &mProcessorContext,
+                mIndex,
+                messages[current],
+                address))
+            {
+                ++numSent;
+            }
+        }
+
+        return numSent;
+    }
+
+    // Resolve the destination mailbox once for the whole batch.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(index.mComponents.mIndex));
+
+    uint32_t numSent(0);
+    for (uint32_t current = 0; current < count; ++current)
+    {
+        Detail::IMessage *const message(messages[current]);
+
+        // We own the envelopes, so ones rejected by a full bounded mailbox are
+        // offered to the fallback handlers and destroyed, as for ordinary sends.
+        if (mailbox.Full())
+        {
+            mFallbackHandlers.Handle(message);
+            Detail::MessageCreator::Destroy(&mMessageAllocator, message);
+            continue;
+        }
+
+        if (mailbox.Push(message))
+        {
+            Detail::Processor::Schedule(&mProcessorContext, &mailbox, false);
+        }
+
+        ++numSent;
+    }
+
+    // If the batch took the queue depth up through the high watermark then
+    // deliver a single watermark event for the batch, as the send path does per message.
+    if (mailbox.RoseAboveWatermark())
+    {
+        QueueWatermarkEvent event;
+        event.mDepth = mailbox.Count();
+        event.mHigh = true;
+
+        Detail::IMessage *const eventMessage(Detail::MessageCreator::Create(
+            &mMessageAllocator,
+            event,
+            address));
+
+        if (eventMessage && mailbox.Push(eventMessage))
+        {
+            Detail::Processor::Schedule(&mProcessorContext, &mailbox, false);
+        }
+    }
+
+    return numSent;
+}
+
+
+inline uint32_t Framework::SendBatch(
+    Detail::IMessage *const *const messages,
+    const Address *const addresses,
+    const uint32_t count)
+{
+    // Each envelope in the batch consumes an ingress token, like a send.
+    if (mIngressThrottle.Enabled())
+    {
+        for (uint32_t current = 0; current < count; ++current)
+        {
+            mIngressThrottle.Acquire();
+        }
+    }
+
+    return Detail::MessageSender::SendBatch(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        messages,
+        addresses,
+        count);
+}
+
+
+template <typename ValueType>
+inline Detail::IMessage *Framework::CreateEnvelope(const ValueType &value, const Address &from)
+{
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    return Detail::MessageCreator::Create(&mMessageAllocator, value, from);
+}
+
+
+template <typename ValueType>
+inline bool Framework::Broadcast(
+    const ValueType &value,
+    const Address &from,
+    const Address *const addresses,
+    const uint32_t count)
+{
+    typedef Detail::SharedMessage<ValueType> MessageType;
+
+    // Handlers match broadcast envelopes by registered type ID. Unregistered
+    // types are matched by RTTI against the unshared message class, which a
+    // shared envelope can't satisfy.
+    THERON_ASSERT_MSG(Detail::MessageTraits<ValueType>::TYPE_ID, "Broadcast message types must be registered");
+
+    if (count == 0)
+    {
+        return true;
+    }
+
+    // A broadcast ingests a single producer event however wide its fan-out,
+    // so it consumes a single ingress token.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Allocate a single block holding one copy of the value, the shared
+    // reference count, and an envelope message per recipient. The block is
+    // freed when the last recipient releases its envelope.
+    void *const block(messageAllocator->AllocateAligned(
+        MessageType::GetSize(count),
+        MessageType::GetAlignment()));
+
+    if (block == 0)
+    {
+        return false;
+    }
+
+    Detail::SharedMessage<ValueType> *const envelopes(
+        MessageType::Initialize(block, value, from, count));
+
+    // Queue one envelope to each recipient. Envelopes of undeliverable messages
+    // are destroyed by the send, which releases their references on the block.
+    bool allDelivered(true);
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        allDelivered &= Detail::MessageSender::Send(
+            mEndPoint,
+            &mProcessorContext,
+            mIndex,
+            envelopes + index,
+            addresses[index]);
+    }
+
+    return allDelivered;
+}
+
+
+template <class ActorType>
+THERON_FORCEINLINE bool Framework::CreateActorAsync(const Address &client, void *const context)
+{
+    return CreateActorAsync(&Framework::ConstructActor<ActorType>, context, client);
+}
+
+
+template <class ActorType>
+THERON_FORCEINLINE Actor *Framework::ConstructActor(Framework &framework, void *const /*context*/)
+{
+    // The constructed actor is owned by the receiver of the completion event,
+    // which destroys it with delete.
+    return new ActorType(framework);
+}
+
+
+template <typename ValueType>
+inline bool Framework::SendAfter(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint64_t delayMicroseconds)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate a pending timer holding the message value, target and sender.
+    // The timer wheel owns the job and destroys it after the message is sent.
+    void *const memory(allocator->Allocate(sizeof(Detail::TimerJob<ValueType>)));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    Detail::TimerJob<ValueType> *const job = new (memory) Detail::TimerJob<ValueType>(*this, value, from, address);
+
+    mTimerWheel.Add(job, delayMicroseconds);
+    return true;
+}
+
+
+template <typename ValueType>
+inline bool Framework::SendEvery(
+    const ValueType &value,
+    const Address &from,
+    const Address &address,
+    const uint64_t periodMicroseconds)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate a pending timer holding the message value, target and sender.
+    // The timer wheel owns the job and re-arms it after each firing.
+    void *const memory(allocator->Allocate(sizeof(Detail::TimerJob<ValueType>)));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    Detail::TimerJob<ValueType> *const job = new (memory) Detail::TimerJob<ValueType>(*this, value, from, address);
+
+    mTimerWheel.Add(job, periodMicroseconds, true);
+    return true;
+}
+
+
+// Defined here rather than in TimerJob.h, where Framework is only forward
+// declared, so the call to Framework::Send is parsed with Framework complete.
+template <class ValueType>
+inline bool Detail::TimerJob<ValueType>::Fire()
+{
+    return mFramework.Send(mValue, mFrom, mAddress);
+}
+
+
+THERON_FORCEINLINE bool Framework::FrameworkReceive(
+    Detail::IMessage *const message,
+    const Address &address)
+{
+    // Call the generic message sending function.
+    // We use our own local context here because we're receiving the message.
+    return Detail::MessageSender::Send(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        message,
+        address);
+}
+
+
+template <typename ObjectType>
+inline bool Framework::SetFallbackHandler(
+    ObjectType *const handlerObject,
+    void (ObjectType::*handler)(const Address from))
+{
+    return mFallbackHandlers.Set(handlerObject, handler);
+}
+
+
+template <typename ObjectType>
+inline bool Framework::SetFallbackHandler(
+    ObjectType *const handlerObject,
+    void (ObjectType::*handler)(const void *const data, const uint32_t size, const Address from))
+{
+    return mFallbackHandlers.Set(handlerObject, handler);
+}
+
+
+template <typename ObjectType>
+inline bool Framework::SetFallbackHandler(
+    ObjectType *const handlerObject,
+    void (ObjectType::*handler)(const MessageView &view, const Address from))
+{
+    return mFallbackHandlers.Set(handlerObject, handler);
+}
+
+
+THERON_FORCEINLINE void Framework::SetPriority(const Address &address, const bool highPriority)
+{
+    // The address is assumed to identify an actor within this framework.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.AsInteger()));
+    mailbox.SetHighPriority(highPriority);
+}
+
+
+THERON_FORCEINLINE void Framework::SetMailboxCapacity(const Address &address, const uint32_t capacity)
+{
+    // The address is assumed to identify an actor within this framework.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.AsInteger()));
+    mailbox.SetCapacity(capacity);
+}
+
+
+#if THERON_MAILBOX_POOL_SLOTS
+
+THERON_FORCEINLINE void Framework::SetHighRate(const Address &address, const bool highRate)
+{
+    // The address is assumed to identify an actor within this framework.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.AsInteger()));
+    mailbox.SetHighRate(highRate);
+}
+
+
+THERON_FORCEINLINE void *Framework::ClaimPooledBlock(const Address &address, const uint32_t size, const uint32_t alignment)
+{
+    const Detail::Index index(address.mIndex);
+
+    // Only concrete addresses of actors within this framework name a mailbox
+    // whose pool could serve the block; everything else allocates as usual.
+    if (index.mUInt32 == 0 || index.mComponents.mFramework != mIndex)
+    {
+        return 0;
+    }
+
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(index.mComponents.mIndex));
+    return mailbox.ClaimPooledBlock(size, alignment);
+}
+
+#else // THERON_MAILBOX_POOL_SLOTS
+
+THERON_FORCEINLINE void Framework::SetHighRate(const Address &/*address*/, const bool /*highRate*/)
+{
+}
+
+#endif // THERON_MAILBOX_POOL_SLOTS
+
+
+THERON_FORCEINLINE void Framework::GetQueueLengths(
+    const Address *const addresses,
+    uint32_t *const lengths,
+    const uint32_t count)
+{
+    // The addresses are assumed to identify actors within this framework.
+    // Each count is an unsynchronized atomic read, so the sampled mailboxes
+    // aren't perturbed and the batch isn't a consistent snapshot.
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const Detail::Mailbox &mailbox(mMailboxes.GetEntry(addresses[index].AsInteger()));
+        lengths[index] = mailbox.Count();
+    }
+}
+
+
+template <typename ValueType>
+inline bool Framework::SendToLeastLoaded(
+    const ValueType &value,
+    const Address &from,
+    const Address *const addresses,
+    const uint32_t count)
+{
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // Sample the depth of each candidate mailbox with a relaxed atomic read
+    // and remember the shallowest, breaking ties in favor of earlier entries.
+    // The depths are momentary snapshots so this is join-shortest-queue as a
+    // heuristic: a racing send may beat us to the chosen mailbox.
+    uint32_t bestIndex(0);
+    uint32_t bestDepth(mMailboxes.GetEntry(addresses[0].AsInteger()).Count());
+
+    for (uint32_t index = 1; index < count && bestDepth > 0; ++index)
+    {
+        const Detail::Mailbox &mailbox(mMailboxes.GetEntry(addresses[index].AsInteger()));
+        const uint32_t depth(mailbox.Count());
+
+        if (depth < bestDepth)
+        {
+            bestIndex = index;
+            bestDepth = depth;
+        }
+    }
+
+    return Send(value, from, addresses[bestIndex]);
+}
+
+
+THERON_FORCEINLINE void Framework::SetMemoryPressureHandler(MemoryPressureHandler *const handler, void *const context)
+{
+    mBudgetAllocator.SetPressureCallback(handler, context);
+}
+
+
+THERON_FORCEINLINE uint64_t Framework::GetMemoryBytesInUse() const
+{
+    return mBudgetAllocator.GetBytesInUse();
+}
+
+
+THERON_FORCEINLINE uint32_t Framework::GetIndex() const
+{
+    return mIndex;
+}
+
+
+THERON_FORCEINLINE uint64_t Framework::SampleFlowId()
+{
+    // Sends from outside message handlers are flow roots; tag one in every N.
+    const uint32_t ratio(mParams.mFlowSamplingRatio);
+    if (ratio == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t sequence(mFlowSequence.FetchIncrement());
+    if ((sequence % ratio) != 0)
+    {
+        return 0;
+    }
+
+    // Sampled sequence numbers are unique, so the successor is a unique non-zero ID.
+    return sequence + 1;
+}
+
+
+#if !THERON_NO_LEGACY
+
+template <class ActorType>
+inline ActorRef Framework::CreateActor()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // The actor type may need to be allocated with non-default alignment.
+    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
+    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
+
+    void *actorMemory(0);
+
+#if THERON_ACTOR_STORE_SIZE
+
+    // Actors small enough to fit the in-place store embedded in a mailbox are
+    // constructed directly into the store of their own mailbox, so that a
+    // processed message reads the mailbox queue and the actor's state from one
+    // contiguous region. The mailbox index is claimed up front and handed to
+    // RegisterActor through a reservation, which recognizes the actor being
+    // constructed within the store; the mechanism is shared with bulk actor
+    // creation, so co-locations and bulk creations serialize with each other.
+    // The store is eight-byte aligned, so more strictly aligned actor types
+    // take the ordinary heap path.
+    BulkReservation reservation;
+    bool colocated(false);
+
+    // The creation lock serializes with bulk creations and is already held
+    // when an actor constructor creates another actor; in either case the new
+    // actor falls back to the ordinary heap path rather than waiting.
+    if (actorSize <= THERON_ACTOR_STORE_SIZE && actorAlignment <= 8 && mBulkCreateLock.TryLock())
+    {
+
+        reservation.mNextIndex = mMailboxes.Allocate();
+        reservation.mEndIndex = reservation.mNextIndex + 1;
+
+        void *const store(mMailboxes.GetEntry(reservation.mNextIndex).GetActorStore());
+        reservation.mSlabBegin = store;
+        reservation.mSlabEnd = reinterpret_cast<const uint8_t *>(store) + actorSize;
+
+        mBulkReservation.Store(&reservation);
+
+        actorMemory = store;
+        colocated = true;
+    }
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+    if (actorMemory == 0)
+    {
+        actorMemory = allocator->AllocateAligned(actorSize, actorAlignment);
+        if (actorMemory == 0)
+        {
+            return ActorRef();
+        }
+    }
+
+    // Get the address of the Actor baseclass using some cast trickery.
+    // Note that the Actor may not always be the first baseclass, so the address may differ!
+    // The static_cast takes the offset of the Actor baseclass within ActorType into account.
+    ActorType *const pretendActor(reinterpret_cast<ActorType *>(actorMemory));
+    Actor *const actorBase(static_cast<Actor *>(pretendActor));
+
+    // Register the actor in the registry while we construct it.
+    // This stores an entry passing the actor pointers to its memory block and owning framework.
+    void *const entryMemory(allocator->Allocate(sizeof(typename Detail::ActorRegistry::Entry)));
+    if (entryMemory == 0)
+    {
+#if THERON_ACTOR_STORE_SIZE
+        if (colocated)
+        {
+            // The claimed mailbox index goes unused; mailbox slots are never reclaimed anyway.
+            mBulkReservation.Store(0);
+            mBulkCreateLock.Unlock();
+            return ActorRef();
+        }
+#endif // THERON_ACTOR_STORE_SIZE
+
+        allocator->Free(actorMemory, actorSize);
+        return ActorRef();
+    }
+
+    typename Detail::ActorRegistry::Entry *const entry = new (entryMemory) typename Detail::ActorRegistry::Entry;
+
+    entry->mActor = actorBase;
+    entry->mFramework = this;
+    entry->mMemory = actorMemory;
+
+    Detail::ActorRegistry::Register(entry);
+
+    // Construct the actor for real in the allocated memory.
+    // The Actor picks up the registered framework pointer in its default constructor.
+    // This relies on the user not incorrectly calling the non-default Actor constructor!
+    ActorType *const actor = new (actorMemory) ActorType();
+
+#if THERON_ACTOR_STORE_SIZE
+    if (colocated)
+    {
+        // The constructor should have claimed the reserved mailbox index.
+        THERON_ASSERT(reservation.mNextIndex == reservation.mEndIndex);
+
+        mBulkReservation.Store(0);
+        mBulkCreateLock.Unlock();
+
+        // A null memory block tells ActorRef::Dereference that the actor
+        // lives in the store of its mailbox, which isn't separately freed.
+        MarkActorColocated(actorBase);
+    }
+#endif // THERON_ACTOR_STORE_SIZE
+
+    // Deregister and free the entry.
+    Detail::ActorRegistry::Deregister(entry);
+
+    allocator->Free(entryMemory, sizeof(typename Detail::ActorRegistry::Entry));
+
+    return ActorRef(actor);
+}
+
+
+template <class ActorType>
+inline ActorRef Framework::CreateActor(const typename ActorType::Parameters &params)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // The actor type may need to be allocated with non-default alignment.
+    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
+    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
+
+    void *actorMemory(0);
+
+#if THERON_ACTOR_STORE_SIZE
+
+    // Small actors are constructed directly into the in-place store embedded
+    // in their own mailbox; see the parameterless overload above for details.
+    BulkReservation reservation;
+    bool colocated(false);
+
+    // The creation lock serializes with bulk creations and is already held
+    // when an actor constructor creates another actor; in either case the new
+    // actor falls back to the ordinary heap path rather than waiting.
+    if (actorSize <= THERON_ACTOR_STORE_SIZE && actorAlignment <= 8 && mBulkCreateLock.TryLock())
+    {
+
+        reservation.mNextIndex = mMailboxes.Allocate();
+        reservation.mEndIndex = reservation.mNextIndex + 1;
+
+        void *const store(mMailboxes.GetEntry(reservation.mNextIndex).GetActorStore());
+        reservation.mSlabBegin = store;
+        reservation.mSlabEnd = reinterpret_cast<const uint8_t *>(store) + actorSize;
+
+        mBulkReservation.Store(&reservation);
+
+        actorMemory = store;
+        colocated = true;
+    }
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+    if (actorMemory == 0)
+    {
+        actorMemory = allocator->AllocateAligned(actorSize, actorAlignment);
+        if (actorMemory == 0)
+        {
+            return ActorRef();
+        }
+    }
+
+    // Get the address of the Actor baseclass using some cast trickery.
+    // Note that the Actor may not always be the first baseclass, so the address may differ!
+    // The static_cast takes the offset of the Actor baseclass within ActorType into account.
+    ActorType *const pretendActor(reinterpret_cast<ActorType *>(actorMemory));
+    Actor *const actorBase(static_cast<Actor *>(pretendActor));
+
+    // Register the actor in the registry while we construct it.
+    // This stores an entry passing the actor pointers to its memory block and owning framework.
+    void *const entryMemory(allocator->Allocate(sizeof(typename Detail::ActorRegistry::Entry)));
+    if (entryMemory == 0)
+    {
+#if THERON_ACTOR_STORE_SIZE
+        if (colocated)
+        {
+            // The claimed mailbox index goes unused; mailbox slots are never reclaimed anyway.
+            mBulkReservation.Store(0);
+            mBulkCreateLock.Unlock();
+            return ActorRef();
+        }
+#endif // THERON_ACTOR_STORE_SIZE
+
+        allocator->Free(actorMemory, actorSize);
+        return ActorRef();
+    }
+
+    typename Detail::ActorRegistry::Entry *const entry = new (entryMemory) typename Detail::ActorRegistry::Entry;
+
+    entry->mActor = actorBase;
+    entry->mFramework = this;
+    entry->mMemory = actorMemory;
+
+    Detail::ActorRegistry::Register(entry);
+
+    // Construct the actor for real in the allocated memory.
+    // The Actor picks up the registered framework pointer in its default constructor.
+    // This relies on the user not incorrectly calling the non-default Actor constructor!
+    ActorType *const actor = new (actorMemory) ActorType(params);
+
+#if THERON_ACTOR_STORE_SIZE
+    if (colocated)
+    {
+        // The constructor should have claimed the reserved mailbox index.
+        THERON_ASSERT(reservation.mNextIndex == reservation.mEndIndex);
+
+        mBulkReservation.Store(0);
+        mBulkCreateLock.Unlock();
+
+        // A null memory block tells ActorRef::Dereference that the actor
+        // lives in the store of its mailbox, which isn't separately freed.
+        MarkActorColocated(actorBase);
+    }
+#endif // THERON_ACTOR_STORE_SIZE
+
+    // Deregister and free the entry.
+    Detail::ActorRegistry::Deregister(entry);
+
+    allocator->Free(entryMemory, sizeof(typename Detail::ActorRegistry::Entry));
+
+    return ActorRef(actor);
+}
+
+#endif // !THERON_NO_LEGACY
+
+
+template <typename ValueType>
+inline uint32_t Framework::ScatterGather(
+    const ValueType *const values,
+    const Address *const addresses,
+    const uint32_t count,
+    const Address &replyTo)
+{
+    THERON_ASSERT(count > 0);
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Scratch array recording the mailboxes that became non-empty during the
+    // scatter pass, each owed a single scheduling event. A mailbox can only
+    // transition from empty once during the pass, since its messages aren't
+    // processed until it's scheduled, so the entries are naturally unique.
+    Detail::Mailbox **const pending(reinterpret_cast<Detail::Mailbox **>(
+        allocator->Allocate(count * static_cast<uint32_t>(sizeof(Detail::Mailbox *)))));
+
+    if (pending == 0)
+    {
+        return 0;
+    }
+
+    uint32_t numPending(0);
+    uint32_t delivered(0);
+
+    // Scatter pass: allocate and push all the messages, deferring the
+    // scheduling of the destination mailboxes.
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const Address &address(addresses[index]);
+
+        // Replies are addressed to the gathering entity.
+        Detail::IMessage *const message(Detail::MessageCreator::Create(
+            messageAllocator,
+            values[index],
+            replyTo));
+
+        if (message == 0)
+        {
+            continue;
+        }
+
+        // Addresses outside this framework, or resolved only by name, take
+        // the general delivery path, which schedules immediately.
+        const Detail::Index mailboxIndex(address.mIndex);
+        if (mailboxIndex.mUInt32 == 0 || mailboxIndex.mComponents.mFramework != mIndex)
+        {
+            if (Detail::MessageSender::Send(mEndPoint, &mProcessorContext, mIndex, message, address))
+            {
+                ++delivered;
+            }
+
+            continue;
+        }
+
+        Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex.mComponents.mIndex));
+
+        // Bounded mailboxes that are full reject the message, which is offered
+        // to the fallback handlers like other undelivered messages.
+        if (mailbox.Full())
+        {
+            mProcessorContext.mFallbackHandlers->Handle(message);
+            Detail::MessageCreator::Destroy(&mProcessorContext.mMessageCache, message);
+
+            continue;
+        }
+
+        if (mailbox.Push(message))
+        {
+            pending[numPending++] = &mailbox;
+        }
+
+        ++delivered;
+    }
+
+    // Scheduling pass: enqueue each mailbox that became non-empty, once.
+    for (uint32_t index = 0; index < numPending; ++index)
+    {
+        Detail::Processor::Schedule(&mProcessorContext, pending[index], false);
+    }
+
+    allocator->Free(pending, count * static_cast<uint32_t>(sizeof(Detail::Mailbox *)));
+
+    // Deliver the aggregate completion message to the gathering entity.
+    if (replyTo != Address::Null())
+    {
+        Send(ScatterGatherComplete(delivered, count), replyTo, replyTo);
+    }
+
+    return delivered;
+}
+
+
+template <class ActorType>
+inline ActorType *Framework::CreateActors(const uint32_t count)
+{
+    THERON_ASSERT(count > 0);
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate one slab to hold all the instances.
+    // The actor type may need to be allocated with non-default alignment.
+    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
+    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
+
+    void *const slabMemory(allocator->AllocateAligned(count * actorSize, actorAlignment));
+    if (slabMemory == 0)
+    {
+        return 0;
+    }
+
+    ActorType *const actors(reinterpret_cast<ActorType *>(slabMemory));
+
+    // Bulk creations are serialized; at most one reservation is active at a time.
+    mBulkCreateLock.Lock();
+
+    // Reserve a contiguous range of mailbox indices for the block, claiming
+    // the whole range and allocating the directory pages covering it in one
+    // operation rather than once per actor.
+    BulkReservation reservation;
+    reservation.mSlabBegin = slabMemory;
+    reservation.mSlabEnd = reinterpret_cast<const uint8_t *>(slabMemory) + count * actorSize;
+    reservation.mNextIndex = mMailboxes.AllocateRange(count);
+    reservation.mEndIndex = reservation.mNextIndex + count;
+
+    // Publish the reservation. RegisterActor claims indices from it for the
+    // actors constructed into the slab; actors constructed concurrently
+    // elsewhere take the ordinary allocation path.
+    mBulkReservation.Store(&reservation);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        new (actors + index) ActorType(*this);
+    }
+
+    // The constructors should have claimed the whole reserved range.
+    THERON_ASSERT(reservation.mNextIndex == reservation.mEndIndex);
+
+    mBulkReservation.Store(0);
+    mBulkCreateLock.Unlock();
+
+    return actors;
+}
+
+
+template <class ActorType>
+inline void Framework::DestroyActors(ActorType *const actors, const uint32_t count)
+{
+    THERON_ASSERT(actors);
+    THERON_ASSERT(count > 0);
+
+    // Destruct the actors in reverse construction order.
+    for (uint32_t index = count; index > 0; --index)
+    {
+        (actors + index - 1)->~ActorType();
+    }
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    allocator->Free(actors, count * static_cast<uint32_t>(sizeof(ActorType)));
+}
+
+
+template <class ActorType>
+inline bool Framework::ReserveRespawnSlot(RespawnSlot &slot)
+{
+    // The slot must be empty; slots aren't re-reserved while holding resources.
+    THERON_ASSERT(slot.mStorage == 0);
+    THERON_ASSERT(slot.mActor == 0);
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // The actor type may need to be allocated with non-default alignment.
+    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
+    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
+
+    void *const storage(allocator->AllocateAligned(actorSize, actorAlignment));
+    if (storage == 0)
+    {
+        return false;
+    }
+
+    // Claiming the mailbox index up front commits the directory page backing
+    // it, so the later respawn touches no allocator at all.
+    slot.mFramework = this;
+    slot.mStorage = storage;
+    slot.mStorageSize = actorSize;
+    slot.mMailboxIndex = mMailboxes.Allocate();
+
+    return true;
+}
+
+
+#if THERON_CPP11
+
+template <class ActorType, typename... Args>
+inline ActorType *Framework::RespawnActor(RespawnSlot &slot, const Address &failedAddress, Args &&... args)
+
+#else
+
+template <class ActorType>
+inline ActorType *Framework::RespawnActor(RespawnSlot &slot, const Address &failedAddress)
+
+#endif // THERON_CPP11
+{
+    // The slot must have been reserved in this framework and not yet used.
+    THERON_ASSERT(slot.mFramework == this);
+    THERON_ASSERT(slot.mStorage != 0);
+    THERON_ASSERT(slot.mActor == 0);
+    THERON_ASSERT(static_cast<uint32_t>(sizeof(ActorType)) <= slot.mStorageSize);
+
+    // Serialize with bulk creations and co-located constructions; the
+    // reservation hands the pre-claimed mailbox index to RegisterActor, which
+    // recognizes the actor being constructed within the reserved storage.
+    mBulkCreateLock.Lock();
+
+    BulkReservation reservation;
+    reservation.mSlabBegin = slot.mStorage;
+    reservation.mSlabEnd = reinterpret_cast<const uint8_t *>(slot.mStorage) + slot.mStorageSize;
+    reservation.mNextIndex = slot.mMailboxIndex;
+    reservation.mEndIndex = slot.mMailboxIndex + 1;
+
+    mBulkReservation.Store(&reservation);
+
+#if THERON_CPP11
+    ActorType *const actor = new (slot.mStorage) ActorType(*this, std::forward<Args>(args)...);
+#else
+    ActorType *const actor = new (slot.mStorage) ActorType(*this);
+#endif // THERON_CPP11
+
+    // The constructor should have claimed the reserved mailbox index.
+    THERON_ASSERT(reservation.mNextIndex == reservation.mEndIndex);
+
+    mBulkReservation.Store(0);
+    mBulkCreateLock.Unlock();
+
+    // The slot owns the successor; it's destructed when the slot is reset.
+    slot.mActor = static_cast<Actor *>(actor);
+
+    // Redirect the failed actor's mailbox to the successor, so messages
+    // queued at it and any sent to the old address reach the successor.
+    if (failedAddress != Address::Null())
+    {
+        RedirectMailbox(failedAddress, actor->GetAddress());
+    }
+
+    return actor;
+}
+
+
+#if THERON_CPP11
+
+template <class ActorType, typename... Args>
+inline ActorType *Framework::ConstructActor(Args &&... args)
+
+#else
+
+template <class ActorType>
+inline ActorType *Framework::ConstructActor()
+
+#endif // THERON_CPP11
+{
+    // The actor type may need to be placed with non-default alignment.
+    const uint32_t actorSize(static_cast<uint32_t>(sizeof(ActorType)));
+    const uint32_t actorAlignment(Detail::ActorAlignment<ActorType>::ALIGNMENT);
+
+    // Carve storage for the actor, and the header preceding it, from the slabs.
+    OwnedActorHeader *header(0);
+    void *const storage(AllocateOwnedActorStorage(actorSize, actorAlignment, header));
+    if (storage == 0)
+    {
+        return 0;
+    }
+
+    // Record the type-erased destructor run at framework destruction.
+    header->mDestruct = &Framework::DestructOwnedActor<ActorType>;
+
+    // Construct the actor into the slab storage. The actor registers itself
+    // with this framework as usual; only its storage is framework-owned.
+#if THERON_CPP11
+    return new (storage) ActorType(*this, std::forward<Args>(args)...);
+#else
+    return new (storage) ActorType(*this);
+#endif // THERON_CPP11
+}
+
+
+template <class ActorType>
+THERON_FORCEINLINE void Framework::DestructOwnedActor(void *const actor)
+{
+    reinterpret_cast<ActorType *>(actor)->~ActorType();
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE bool Framework::AllocateMessage(MessageBuilder<ValueType> &builder, const Address &from, const Address &address)
+{
+    THERON_ASSERT(!builder.IsValid());
+
+    // We use a thread-safe per-framework message cache to allocate messages sent from non-actor code.
+    IAllocator *const messageAllocator(&mMessageAllocator);
+
+    // Allocate the message block up front; the value is constructed into its
+    // payload by the caller, and the envelope around it by Commit.
+    void *const block(Detail::MessageCreator::AllocateBlock<ValueType>(messageAllocator));
+    if (block == 0)
+    {
+        return false;
+    }
+
+    builder.mFramework = this;
+    builder.mBlock = block;
+    builder.mFrom = from;
+    builder.mTo = address;
+
+    return true;
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE bool Framework::CommitMessage(void *const block, const Address &from, const Address &address)
+{
+    // Pace sends from non-actor code when an ingress rate limit is configured.
+    if (mIngressThrottle.Enabled())
+    {
+        mIngressThrottle.Acquire();
+    }
+
+    // Construct the envelope around the value the caller built in place.
+    Detail::IMessage *const message(Detail::MessageCreator::CreateWithConstructedValue<ValueType>(block, from));
+
+    // Sends from non-actor code start new causality flows, subject to sampling.
+    message->SetFlowId(SampleFlowId());
+
+    // Call the message sending implementation using the processor context of the framework.
+    // When messages are sent using a builder there's no obvious worker thread.
+    return Detail::MessageSender::Send(
+        mEndPoint,
+        &mProcessorContext,
+        mIndex,
+        message,
+        address);
+}
+
+
+template <class ValueType>
+THERON_FORCEINLINE void Framework::AbandonMessage(void *const block)
+{
+    Detail::MessageCreator::FreeBlock<ValueType>(&mMessageAllocator, block);
+}
+
+
+template <class ValueType>
+inline bool MessageBuilder<ValueType>::Commit()
+{
+    THERON_ASSERT(mBlock);
+
+    Framework *const framework(mFramework);
+    void *const block(mBlock);
+
+    // The builder is single-use; the framework owns the message from here on.
+    mFramework = 0;
+    mBlock = 0;
+
+    return framework->CommitMessage<ValueType>(block, mFrom, mTo);
+}
+
+
+template <class ValueType>
+inline void MessageBuilder<ValueType>::Abandon()
+{
+    if (mBlock)
+    {
+        mFramework->AbandonMessage<ValueType>(mBlock);
+
+        mFramework = 0;
+        mBlock = 0;
+    }
+}
+
+
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
+
+
+#endif // THERON_FRAMEWORK_H
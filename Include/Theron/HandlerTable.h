@@ -0,0 +1,190 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_HANDLERTABLE_H
+#define THERON_HANDLERTABLE_H
+
+
+/**
+\file HandlerTable.h
+Shared per-class handler table, registered by actor instances without copying.
+*/
+
+
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Handlers/HandlerCollection.h>
+#include <Theron/Detail/Handlers/IMessageHandler.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+
+
+/**
+\brief A shared table of message handlers, built once per actor class.
+
+Each \ref Actor::RegisterHandler call allocates a small handler object for
+the registering instance, so constructing large populations of actors of the
+same class repeats identical allocations per instance. A HandlerTable
+describes the handler set of an actor class once, and instances reference
+the shared table with \ref Actor::RegisterHandlerTable instead of building
+their own copies, making handler registration allocation-free per actor:
+
+\code
+class Worker : public Theron::Actor
+{
+public:
+
+    static void BuildHandlers(Theron::HandlerTable &table)
+    {
+        table.Add(&Worker::Process);
+        table.Add(&Worker::Flush);
+    }
+
+    explicit Worker(Theron::Framework &framework, const Theron::HandlerTable &table) :
+      Theron::Actor(framework)
+    {
+        RegisterHandlerTable(table);
+    }
+
+private:
+
+    void Process(const WorkItem &message, const Theron::Address from);
+    void Flush(const FlushRequest &message, const Theron::Address from);
+};
+
+Theron::HandlerTable workerHandlers;
+Worker::BuildHandlers(workerHandlers);
+
+// Instances share the table; construction allocates no handler objects.
+Worker workerOne(framework, workerHandlers);
+Worker workerTwo(framework, workerHandlers);
+\endcode
+
+Instances referencing a shared table can still register and deregister
+handlers individually: the first handler change an instance makes gives it a
+private copy of the handler set, and the instance diverges from the shared
+table from then on. The shared table itself is immutable once instances
+reference it.
+
+\note Populate the table completely before constructing the instances that
+reference it, and destruct it only after them. The table is not protected
+against concurrent population, so build it on one thread.
+
+\see Actor::RegisterHandlerTable
+*/
+class HandlerTable
+{
+public:
+
+    /**
+    \brief Default constructor. Constructs an empty table.
+    */
+    inline HandlerTable() : mCollection()
+    {
+    }
+
+    /**
+    \brief Destructor.
+    Frees the handlers owned by the table, which no instance may still reference.
+    */
+    inline ~HandlerTable()
+    {
+        // The shared handler objects are owned by the table rather than by
+        // the collections that referenced it, so are freed here; the
+        // building collection frees the snapshot tables themselves.
+        Detail::HandlerCollection::Table *const table(mCollection.GetTable());
+        if (table)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+            for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+            {
+                Detail::IMessageHandler *const handler(table->mHandlers[index]);
+                handler->~IMessageHandler();
+                allocator->Free(handler);
+            }
+        }
+    }
+
+    /**
+    \brief Adds a handler for a message type to the table.
+
+    The handler is a member function of the actor class the table describes,
+    as accepted by \ref Actor::RegisterHandler.
+
+    \return True, if the handler was added successfully.
+    */
+    template <class ActorType, class ValueType>
+    inline bool Add(void (ActorType::*handler)(const ValueType &message, const Address from))
+    {
+        if (!mCollection.Add(handler))
+        {
+            return false;
+        }
+
+        MarkShared();
+        return true;
+    }
+
+    /**
+    \brief Adds a mutable handler, taking the message by non-const reference, to the table.
+    \return True, if the handler was added successfully.
+    */
+    template <class ActorType, class ValueType>
+    inline bool Add(void (ActorType::*handler)(ValueType &message, const Address from))
+    {
+        if (!mCollection.Add(handler))
+        {
+            return false;
+        }
+
+        MarkShared();
+        return true;
+    }
+
+    /**
+    \brief Returns true if no handlers have been added to the table.
+
+    Allows the table to be built lazily by the first constructed instance,
+    when construction is known to be single-threaded.
+    */
+    THERON_FORCEINLINE bool Empty() const
+    {
+        return (mCollection.GetTable() == 0);
+    }
+
+private:
+
+    friend class Actor;
+
+    HandlerTable(const HandlerTable &other);
+    HandlerTable &operator=(const HandlerTable &other);
+
+    /**
+    Marks the handlers of the current snapshot as owned by the table, so the
+    collections referencing them never free them.
+    */
+    inline void MarkShared()
+    {
+        Detail::HandlerCollection::Table *const table(mCollection.GetTable());
+        for (uint32_t index = 0; index < table->mHandlers.Size(); ++index)
+        {
+            table->mHandlers[index]->MarkShared();
+        }
+    }
+
+    Detail::HandlerCollection mCollection;      ///< Collection describing and owning the shared handler set.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_HANDLERTABLE_H
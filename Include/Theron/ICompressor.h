@@ -0,0 +1,151 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_ICOMPRESSOR_H
+#define THERON_ICOMPRESSOR_H
+
+
+/**
+\file ICompressor.h
+Compression codec interface.
+*/
+
+
+#include <Theron/BasicTypes.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Interface describing a compression codec usable by the network layer.
+
+An implementation of this interface can be registered with a network
+\ref EndPoint via \ref EndPoint::Parameters::mCompressor. When one is
+registered, the network thread compresses each coalesced batch of small
+outgoing messages as a whole before sending it, and decompresses received
+compressed batches before unpacking them. Compressing at the batch level
+rather than per message lets the codec exploit the redundancy between the
+small messages in a batch, which individually are often too short to
+compress usefully.
+
+The interface is designed around fast block codecs of the LZ4 class:
+stateless, operating on a complete input block per call, with a cheap
+worst-case output bound. Wrapping such a library is a matter of forwarding
+the three methods to it:
+
+\code
+class LZ4Compressor : public Theron::ICompressor
+{
+public:
+
+    virtual Theron::uint32_t MaxCompressedSize(const Theron::uint32_t size) const
+    {
+        return LZ4_compressBound(size);
+    }
+
+    virtual Theron::uint32_t Compress(
+        const void *const source,
+        const Theron::uint32_t sourceSize,
+        void *const dest,
+        const Theron::uint32_t destCapacity)
+    {
+        return LZ4_compress_default(
+            reinterpret_cast<const char *>(source),
+            reinterpret_cast<char *>(dest),
+            sourceSize,
+            destCapacity);
+    }
+
+    virtual Theron::uint32_t Decompress(
+        const void *const source,
+        const Theron::uint32_t sourceSize,
+        void *const dest,
+        const Theron::uint32_t destCapacity)
+    {
+        const int size(LZ4_decompress_safe(
+            reinterpret_cast<const char *>(source),
+            reinterpret_cast<char *>(dest),
+            sourceSize,
+            destCapacity));
+
+        return (size < 0) ? 0 : size;
+    }
+};
+\endcode
+
+\note The methods are called from the endpoint's network threads, and on
+endpoints with several network threads may be called concurrently, so
+implementations must be thread-safe. Stateless block codecs are naturally so.
+
+\see EndPoint::Parameters
+*/
+class ICompressor
+{
+public:
+
+    /**
+    \brief Default constructor.
+    */
+    inline ICompressor()
+    {
+    }
+
+    /**
+    \brief Virtual destructor.
+    */
+    inline virtual ~ICompressor()
+    {
+    }
+
+    /**
+    \brief Returns the worst-case compressed size of an input of the given size.
+
+    Used to size the buffer into which batches are compressed, so must be an
+    upper bound on what \ref Compress can write for any input of the size.
+    */
+    virtual uint32_t MaxCompressedSize(const uint32_t size) const = 0;
+
+    /**
+    \brief Compresses a block of data.
+
+    \param source Pointer to the data to be compressed.
+    \param sourceSize Size of the data to be compressed, in bytes.
+    \param dest Buffer into which the compressed data is written.
+    \param destCapacity Size of the destination buffer, in bytes.
+    \return The number of compressed bytes written, or zero if the data
+    couldn't be compressed into the destination buffer. A zero return isn't
+    an error: the caller sends the batch uncompressed instead.
+    */
+    virtual uint32_t Compress(
+        const void *const source,
+        const uint32_t sourceSize,
+        void *const dest,
+        const uint32_t destCapacity) = 0;
+
+    /**
+    \brief Decompresses a block of data previously written by \ref Compress.
+
+    \param source Pointer to the compressed data.
+    \param sourceSize Size of the compressed data, in bytes.
+    \param dest Buffer into which the decompressed data is written.
+    \param destCapacity Size of the destination buffer, in bytes.
+    \return The number of decompressed bytes written, or zero if the data
+    is corrupt or doesn't fit the destination buffer.
+    */
+    virtual uint32_t Decompress(
+        const void *const source,
+        const uint32_t sourceSize,
+        void *const dest,
+        const uint32_t destCapacity) = 0;
+
+private:
+
+    ICompressor(const ICompressor &other);
+    ICompressor &operator=(const ICompressor &other);
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_ICOMPRESSOR_H
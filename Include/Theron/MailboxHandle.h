@@ -0,0 +1,114 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_MAILBOXHANDLE_H
+#define THERON_MAILBOXHANDLE_H
+
+
+/**
+\file MailboxHandle.h
+Pinned handle to the mailbox of an actor, for repeated sends to a fixed destination.
+*/
+
+
+#include <Theron/Address.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+namespace Detail
+{
+class Mailbox;
+class MessageSender;
+}
+
+
+class Actor;
+class Framework;
+
+
+/**
+\brief Pinned handle to the mailbox of an actor, for repeated sends to a fixed destination.
+
+Every send addressed by \ref Address resolves the address to the destination
+mailbox through the framework's mailbox directory. The cost of one resolution
+is small, but in the tightest loops -- millions of messages to the same
+destination -- it is paid once per message for an answer that never changes.
+
+A MailboxHandle, obtained from \ref Framework::GetMailboxHandle, captures the
+resolved mailbox once, so sends via the handle push messages directly with no
+per-send lookup. Handles are cheap value types and can be copied and stored
+freely, typically as members of a sending actor or alongside a sending loop.
+
+\code
+Theron::MailboxHandle handle(framework.GetMailboxHandle(consumer.GetAddress()));
+
+for (int index = 0; index < count; ++index)
+{
+    framework.Send(Record(index), from, handle);
+}
+\endcode
+
+Mailboxes live as long as their framework, so a handle remains safe to send
+through for the lifetime of the framework that issued it, even after the
+addressed actor is destroyed: messages sent via the handle of a dead actor
+are handled by the framework's \ref Framework::SetFallbackHandler "fallback
+handler", exactly as when sending to the stale \ref Address. A handle must
+not be used after the framework that issued it is destructed, and can't be
+used to send to actors in other frameworks.
+
+\see Framework::GetMailboxHandle
+*/
+class MailboxHandle
+{
+public:
+
+    friend class Actor;
+    friend class Framework;
+
+    /**
+    \brief Default constructor. Constructs an invalid handle, bound to no mailbox.
+    */
+    THERON_FORCEINLINE MailboxHandle() : mMailbox(0), mAddress()
+    {
+    }
+
+    /**
+    \brief Returns true if the handle is bound to a mailbox.
+
+    \ref Framework::GetMailboxHandle returns an invalid handle when the given
+    address can't be pinned; sends via an invalid handle fail, returning false.
+    */
+    THERON_FORCEINLINE bool IsValid() const
+    {
+        return (mMailbox != 0);
+    }
+
+    /**
+    \brief Returns the address of the mailbox the handle is bound to.
+    \return The pinned address, or \ref Address::Null for an invalid handle.
+    */
+    THERON_FORCEINLINE const Address &GetAddress() const
+    {
+        return mAddress;
+    }
+
+private:
+
+    THERON_FORCEINLINE MailboxHandle(Detail::Mailbox *const mailbox, const Address &address) :
+      mMailbox(mailbox),
+      mAddress(address)
+    {
+    }
+
+    Detail::Mailbox *mMailbox;      ///< Pointer to the pinned mailbox, or zero if invalid.
+    Address mAddress;               ///< Address of the pinned mailbox.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_MAILBOXHANDLE_H
@@ -0,0 +1,147 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_MESSAGEBUILDER_H
+#define THERON_MESSAGEBUILDER_H
+
+
+/**
+\file MessageBuilder.h
+Builder for two-phase sends that construct message values in place.
+*/
+
+
+#include <Theron/Address.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+class Framework;
+
+
+/**
+\brief Builder for a message whose value is constructed in place.
+
+The ordinary \ref Framework::Send "Send" methods take a fully constructed
+value and copy (or, in C++11 builds, move) it into the message envelope.
+For large values -- bulk snapshots, telemetry blocks and suchlike -- that
+means constructing the value once in caller-owned memory and then copying
+it wholesale into the message.
+
+A MessageBuilder eliminates the copy. \ref Framework::AllocateMessage
+allocates the message envelope up front and hands its payload memory to the
+caller through the builder, so the value can be placement-constructed (or
+filled in field by field) directly where the message will carry it.
+\ref Commit then pushes the finished message, paying no further allocation
+or copy:
+
+\code
+Theron::MessageBuilder<Snapshot> builder;
+
+if (framework.AllocateMessage(builder, receiver.GetAddress(), actor.GetAddress()))
+{
+    new (builder.Memory()) Snapshot();
+    builder.Value().Populate(orderBook);
+    builder.Commit();
+}
+\endcode
+
+A builder is single-use: once committed it becomes invalid, and a fresh one
+is allocated for the next message. An uncommitted builder frees its memory
+when destructed, or earlier via \ref Abandon.
+
+\note The builder can't know whether the caller has constructed the value
+yet, so abandoning a builder frees the payload memory without destructing
+any value constructed in it. Callers that construct a value and then decide
+not to commit must destruct the value themselves before abandoning, if the
+value type has a non-trivial destructor.
+
+\see Framework::AllocateMessage
+*/
+template <class ValueType>
+class MessageBuilder
+{
+public:
+
+    friend class Framework;
+
+    /**
+    Default constructor; constructs an invalid builder with no allocated message.
+    */
+    inline MessageBuilder() :
+      mFramework(0),
+      mBlock(0),
+      mFrom(),
+      mTo()
+    {
+    }
+
+    /**
+    Destructor; frees the allocated message memory if the builder wasn't committed.
+    */
+    inline ~MessageBuilder()
+    {
+        Abandon();
+    }
+
+    /**
+    Returns true if the builder holds an allocated message not yet committed.
+    */
+    THERON_FORCEINLINE bool IsValid() const
+    {
+        return (mBlock != 0);
+    }
+
+    /**
+    Returns the payload memory of the allocated message, sized and aligned for
+    the value type, in which the caller constructs the value.
+    */
+    THERON_FORCEINLINE void *Memory() const
+    {
+        THERON_ASSERT(mBlock);
+        return mBlock;
+    }
+
+    /**
+    Returns a reference to the value in the payload memory.
+    Valid only once the caller has constructed the value there.
+    */
+    THERON_FORCEINLINE ValueType &Value() const
+    {
+        THERON_ASSERT(mBlock);
+        return *reinterpret_cast<ValueType *>(mBlock);
+    }
+
+    /**
+    Sends the built message to the address the builder was allocated for,
+    leaving the builder invalid. The value must have been constructed in the
+    payload memory by the caller before the call.
+    \return True, if the message was delivered to an entity, otherwise false.
+    */
+    inline bool Commit();
+
+    /**
+    Frees the allocated message memory without sending, leaving the builder
+    invalid. Any value constructed in the payload memory is not destructed.
+    */
+    inline void Abandon();
+
+private:
+
+    MessageBuilder(const MessageBuilder &other);
+    MessageBuilder &operator=(const MessageBuilder &other);
+
+    Framework *mFramework;                  ///< The framework the message was allocated from.
+    void *mBlock;                           ///< The allocated message block; the value lives at its start.
+    Address mFrom;                          ///< The address of the sending entity.
+    Address mTo;                            ///< The address of the target entity.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_MESSAGEBUILDER_H
@@ -0,0 +1,79 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_MESSAGETYPESTATS_H
+#define THERON_MESSAGETYPESTATS_H
+
+
+/**
+\file MessageTypeStats.h
+Per-message-type send and processing statistics.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Per-message-type counts and byte totals of messages sent and processed.
+
+Filled in by \ref Framework::GetMessageTypeStats "Framework::GetMessageTypeStats"
+when \ref THERON_ENABLE_MESSAGE_STATS is enabled in the build. Entries are
+indexed by the dense integer IDs assigned to message types registered with
+\ref THERON_REGISTER_MESSAGE (or the DECLARE/DEFINE macro pair); entry zero
+aggregates all unregistered message types, which carry ID zero.
+
+Counts are cumulative since the framework was constructed, so rates can be
+derived by querying periodically and differencing. Byte totals count the
+message value sizes, excluding envelope overhead.
+
+\see Framework::GetMessageTypeStats
+*/
+struct MessageTypeStats
+{
+    /**
+    Number of message type IDs tracked. Type IDs are assigned densely from
+    one, so this bounds the number of registered message types whose
+    statistics are tracked individually; messages of types with IDs beyond
+    the bound are aggregated into entry zero with the unregistered types.
+    */
+    static const uint32_t MAX_TYPES = 256;
+
+    /**
+    Statistics for the messages of a single registered type.
+    */
+    struct TypeStats
+    {
+        const char *mTypeName;      ///< Registered name of the message type; zero for the entry aggregating unregistered types, and for types never seen.
+        uint64_t mSentCount;        ///< Number of messages of the type submitted for delivery.
+        uint64_t mSentBytes;        ///< Total message value bytes submitted for delivery.
+        uint64_t mProcessedCount;   ///< Number of messages of the type processed by actors.
+        uint64_t mProcessedBytes;   ///< Total message value bytes processed by actors.
+    };
+
+    /**
+    Default constructor. Zeroes all entries.
+    */
+    inline MessageTypeStats()
+    {
+        for (uint32_t index = 0; index < MAX_TYPES; ++index)
+        {
+            mTypes[index].mTypeName = 0;
+            mTypes[index].mSentCount = 0;
+            mTypes[index].mSentBytes = 0;
+            mTypes[index].mProcessedCount = 0;
+            mTypes[index].mProcessedBytes = 0;
+        }
+    }
+
+    TypeStats mTypes[MAX_TYPES];    ///< Per-type entries, indexed by registered message type ID.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_MESSAGETYPESTATS_H
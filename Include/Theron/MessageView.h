@@ -0,0 +1,212 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_MESSAGEVIEW_H
+#define THERON_MESSAGEVIEW_H
+
+
+/**
+\file MessageView.h
+Refcounted view of a message payload.
+*/
+
+
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageCreator.h>
+
+
+namespace Theron
+{
+
+
+namespace Detail
+{
+template <class ObjectType>
+class ViewFallbackHandler;
+}
+
+
+/**
+\brief A refcounted view of the payload of a received message.
+
+Handlers registered in the \ref MessageView "view" form of
+\ref Framework::SetFallbackHandler receive the caught message as a view
+rather than as copied or borrowed data. A view references the message's
+payload bytes in place, and holds a reference count on the message itself,
+so the payload stays valid for as long as any view of it exists -- including
+after the handler has returned. A handler that needs to pass the payload to
+code outside Theron can therefore retain a copy of the view instead of
+defensively copying the bytes:
+
+\code
+class Handler
+{
+public:
+
+    inline void Handle(const Theron::MessageView &view, const Theron::Address from)
+    {
+        // Retaining the view keeps the payload bytes valid; no copy is made.
+        mRetained = view;
+    }
+
+    Theron::MessageView mRetained;
+};
+\endcode
+
+The message is destroyed, and the viewed bytes invalidated, when the last
+view of it is released -- by destruction, reassignment, or an explicit call
+to \ref Release. Views are cheap to copy: a pointer copy and an atomic
+reference count update.
+
+A default-constructed view is \em null, viewing no message; \ref Valid
+distinguishes the two states.
+
+\note Views may be released on any thread, but the viewed payload must be
+treated as read-only: other views of the same message may be read
+concurrently. Messages viewed but not retained are destroyed as normal.
+
+\see Framework::SetFallbackHandler
+*/
+class MessageView
+{
+public:
+
+    template <class ObjectType>
+    friend class Detail::ViewFallbackHandler;
+
+    /**
+    \brief Default constructor.
+
+    Constructs a null view, referencing no message.
+    */
+    THERON_FORCEINLINE MessageView() : mMessage(0)
+    {
+    }
+
+    /**
+    \brief Copy constructor.
+
+    The new view references the same message, which lives at least as long
+    as the last view of it.
+    */
+    THERON_FORCEINLINE MessageView(const MessageView &other) : mMessage(other.mMessage)
+    {
+        if (mMessage)
+        {
+            mMessage->AddViewReference();
+        }
+    }
+
+    /**
+    \brief Assignment operator.
+
+    Releases the view's current reference, if any, and references the message
+    viewed by the other view instead.
+    */
+    THERON_FORCEINLINE MessageView &operator=(const MessageView &other)
+    {
+        // Reference the new message before releasing the old, making
+        // self-assignment safe.
+        if (other.mMessage)
+        {
+            other.mMessage->AddViewReference();
+        }
+
+        Release();
+        mMessage = other.mMessage;
+
+        return *this;
+    }
+
+    /**
+    \brief Destructor.
+
+    Releases the view's reference; the last release destroys the message.
+    */
+    THERON_FORCEINLINE ~MessageView()
+    {
+        Release();
+    }
+
+    /**
+    \brief Returns true if the view references a message.
+    */
+    THERON_FORCEINLINE bool Valid() const
+    {
+        return (mMessage != 0);
+    }
+
+    /**
+    \brief Returns a pointer to the viewed payload bytes.
+
+    The bytes are the message value in place, valid until the last view of
+    the message is released.
+    \return A pointer to the payload, or zero for a null view.
+    */
+    THERON_FORCEINLINE const void *Data() const
+    {
+        return mMessage ? mMessage->GetMessageData() : 0;
+    }
+
+    /**
+    \brief Returns the size of the viewed payload, in bytes.
+    */
+    THERON_FORCEINLINE uint32_t Size() const
+    {
+        return mMessage ? mMessage->GetMessageSize() : 0;
+    }
+
+    /**
+    \brief Gets the address from which the viewed message was sent.
+    */
+    THERON_FORCEINLINE Address From() const
+    {
+        return mMessage ? mMessage->From() : Address::Null();
+    }
+
+    /**
+    \brief Releases the view's reference, making the view null.
+
+    If the released reference was the last, the message is destroyed and the
+    viewed bytes are invalidated. Releasing a null view does nothing.
+    */
+    inline void Release()
+    {
+        if (mMessage && mMessage->ReleaseViewReference())
+        {
+            // The last reference has been released, so this thread owns the
+            // message exclusively; the constness of the view doesn't extend
+            // to the message's own lifetime.
+            Detail::MessageCreator::DestroyUnreferenced(
+                AllocatorManager::Instance().GetAllocator(),
+                const_cast<Detail::IMessage *>(mMessage));
+        }
+
+        mMessage = 0;
+    }
+
+private:
+
+    /**
+    Internal explicit constructor, used by the handler wrappers.
+    Takes a new reference on the viewed message.
+    */
+    THERON_FORCEINLINE explicit MessageView(const Detail::IMessage *const message) : mMessage(message)
+    {
+        if (mMessage)
+        {
+            mMessage->AddViewReference();
+        }
+    }
+
+    const Detail::IMessage *mMessage;   ///< The viewed message, or zero for a null view.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_MESSAGEVIEW_H
@@ -0,0 +1,98 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_METRICSSINK_H
+#define THERON_METRICSSINK_H
+
+
+/**
+\file MetricsSink.h
+Callback interface receiving periodic scheduler metrics samples.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Callback interface receiving periodic scheduler metrics samples.
+
+A sink registered with \ref Framework::SetMetricsSink "Framework::SetMetricsSink"
+is called periodically by the framework's manager thread with a snapshot of the
+scheduling state of every worker thread, so telemetry can be fed from inside
+the framework instead of being polled from an external thread.
+
+Derive from this class and implement \ref Sample to consume the snapshots:
+
+\code
+class Telemetry : public Theron::MetricsSink
+{
+public:
+
+    virtual void Sample(
+        const WorkerSample *const workers,
+        const Theron::uint32_t workerCount,
+        const Theron::uint32_t sharedQueueDepth)
+    {
+        for (Theron::uint32_t index = 0; index < workerCount; ++index)
+        {
+            Publish(index, workers[index].mMessagesProcessed, workers[index].mLocalQueueDepth);
+        }
+    }
+};
+\endcode
+
+\see Framework::SetMetricsSink
+*/
+class MetricsSink
+{
+public:
+
+    /**
+    \brief Scheduling metrics of one worker thread.
+
+    The counters count events since the worker started; rates and ratios, such
+    as the fraction of scheduling iterations spent sleeping, are computed by
+    differencing successive samples.
+    */
+    struct WorkerSample
+    {
+        uint32_t mMessagesProcessed;    ///< Messages processed by the worker since it started.
+        uint32_t mLocalQueueDepth;      ///< Mailboxes currently queued in the worker's local queue.
+        uint32_t mMailboxSteals;        ///< Mailboxes the worker has stolen from other workers.
+        uint32_t mYields;               ///< Scheduling iterations in which the worker found no work.
+        uint32_t mSleepTransitions;     ///< Times the worker blocked under \ref YIELD_STRATEGY_BLOCKING.
+    };
+
+    /**
+    Virtual destructor.
+    */
+    inline virtual ~MetricsSink()
+    {
+    }
+
+    /**
+    \brief Called periodically by the manager thread with a metrics snapshot.
+
+    \note Called on the framework's manager thread, which also services worker
+    scaling and timed sends; implementations should record or forward the
+    sample quickly and must not block.
+
+    \param workers Array of per-worker samples, one per running worker thread.
+    \param workerCount Number of valid entries in the worker array.
+    \param sharedQueueDepth Mailboxes currently queued in the framework's shared work queue.
+    */
+    virtual void Sample(
+        const WorkerSample *const workers,
+        const uint32_t workerCount,
+        const uint32_t sharedQueueDepth) = 0;
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_METRICSSINK_H
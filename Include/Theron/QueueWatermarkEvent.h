@@ -0,0 +1,47 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_QUEUEWATERMARKEVENT_H
+#define THERON_QUEUEWATERMARKEVENT_H
+
+
+/**
+\file QueueWatermarkEvent.h
+Message type delivered to actors on queue watermark crossings.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief Message delivered to an actor when its queue depth crosses a watermark.
+
+Actors that configure queue watermarks with
+\ref Actor::SetQueueWatermarks "SetQueueWatermarks" receive a message of this
+type through their own mailbox when the number of queued messages rises
+through the high watermark, and again when it subsequently falls back to the
+low watermark. Handle it by registering a message handler for the type, like
+any other message; the \em from address of the event is the actor's own
+address.
+
+\note The depth is sampled when the crossing is detected, so by the time the
+event is handled the queue may have grown or shrunk further; treat it as an
+indication of the crossing rather than an exact measurement.
+
+\see Actor::SetQueueWatermarks
+*/
+struct QueueWatermarkEvent
+{
+    uint32_t mDepth;        ///< Queue depth sampled when the crossing was detected.
+    bool mHigh;             ///< True if the high watermark was crossed rising, false if the queue fell back to the low watermark.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_QUEUEWATERMARKEVENT_H
@@ -17,7 +17,7 @@ Utility that can receive messages from actors.
 #include <Theron/BasicTypes.h>
 #include <Theron/Defines.h>
 
-#include <Theron/Detail/Containers/List.h>
+#include <Theron/Detail/Containers/InlineVector.h>
 #include <Theron/Detail/Directory/Entry.h>
 #include <Theron/Detail/Handlers/ReceiverHandler.h>
 #include <Theron/Detail/Handlers/IReceiverHandler.h>
@@ -26,7 +26,9 @@ Utility that can receive messages from actors.
 #include <Theron/Detail/Messages/MessageCreator.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
 #include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
 #include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Condition.h>
 #include <Theron/Detail/Threading/SpinLock.h>
 #include <Theron/Detail/Threading/Utils.h>
 
@@ -314,6 +316,48 @@ public:
     */
     inline uint32_t Wait(const uint32_t max = 1);
 
+    /**
+    \brief Waits until one or more messages arrive, or until a timeout expires.
+
+    This overload behaves like \ref Wait but bounds the time for which the calling
+    thread can block. It waits until at least one unconsumed message is available,
+    then consumes all available messages up to the given maximum, returning the
+    number consumed. If no message arrives within the given timeout then it returns
+    zero, without consuming any messages.
+
+    Unlike the untimed \ref Wait, the calling thread sleeps on a condition variable
+    rather than spinning, and is woken when a message arrives. This makes the timed
+    wait suitable for gateway or front-end threads that collect response batches
+    from many actors while remaining responsive to shutdown:
+
+    \code
+    // Collect an expected batch of responses, giving up after a second.
+    uint32_t outstandingCount(10);
+    uint64_t remaining(1000000);
+    while (outstandingCount && remaining)
+    {
+        const uint32_t consumed(receiver.Wait(outstandingCount, static_cast<Theron::uint32_t>(remaining)));
+        if (consumed == 0)
+        {
+            break;
+        }
+
+        outstandingCount -= consumed;
+    }
+    \endcode
+
+    A timeout of zero polls: the call consumes any messages already available and
+    returns immediately, like \ref Consume.
+
+    \note The accuracy of the timeout is limited by the granularity of the
+    underlying operating system scheduler, typically around a millisecond.
+
+    \param max Maximum number of arrived messages to be consumed on this call.
+    \param timeoutMicroseconds Upper bound on the time spent waiting, in microseconds.
+    \return The actual number of arrived messages consumed on this call, which is zero on timeout.
+    */
+    inline uint32_t Wait(const uint32_t max, const uint32_t timeoutMicroseconds);
+
     /**
     \brief Consumes any unconsumed messages available on the receiver, up to a specified limit.
 
@@ -350,7 +394,7 @@ public:
 
 private:
 
-    typedef Detail::List<Detail::IReceiverHandler> MessageHandlerList;
+    typedef Detail::InlineVector<Detail::IReceiverHandler *> MessageHandlerVector;
 
     Receiver(const Receiver &other);
     Receiver &operator=(const Receiver &other);
@@ -374,9 +418,11 @@ private:
     EndPoint *const mEndPoint;                          ///< Pointer to the network endpoint, if any, to which this receiver is tied.
     Detail::String mName;                               ///< Name of the receiver.
     Address mAddress;                                   ///< Unique address of this receiver.
-    MessageHandlerList mMessageHandlers;                ///< List of registered message handlers.
+    MessageHandlerVector mMessageHandlers;              ///< Registered message handlers, stored contiguously.
     mutable Detail::SpinLock mSpinLock;                 ///< Synchronizes access to the message handlers.
     mutable Detail::Atomic::UInt32 mMessagesReceived;   ///< Counts arrived messages not yet waited on.
+    mutable Detail::Condition mCondition;               ///< Condition on which timed waits sleep until messages arrive.
+    mutable Detail::Atomic::UInt32 mNumWaiters;         ///< Number of threads blocked in timed waits.
 };
 
 
@@ -444,11 +490,10 @@ inline bool Receiver::DeregisterHandler(
 
     mSpinLock.Lock();
 
-    // Find the handler in the registered handler list.
-    typename MessageHandlerList::Iterator handlers(mMessageHandlers.GetIterator());
-    while (handlers.Next())
+    // Find the handler in the registered handler collection.
+    for (uint32_t index = 0; index < mMessageHandlers.Size(); ++index)
     {
-        Detail::IReceiverHandler *const messageHandler(handlers.Get());
+        Detail::IReceiverHandler *const messageHandler(mMessageHandlers[index]);
 
         // Try to convert this handler, of unknown type, to the target type.
         const MessageHandlerType *const typedHandler = HandlerCaster:: template CastHandler<ValueType>(messageHandler);
@@ -456,7 +501,7 @@ inline bool Receiver::DeregisterHandler(
         {
             if (typedHandler->GetHandlerFunction() == handler)
             {
-                // Remove the handler from the list.
+                // Remove the handler from the collection.
                 mMessageHandlers.Remove(messageHandler);
 
                 // Free the handler object, which was allocated on registration.
@@ -516,6 +561,42 @@ THERON_FORCEINLINE uint32_t Receiver::Wait(const uint32_t max)
 }
 
 
+THERON_FORCEINLINE uint32_t Receiver::Wait(const uint32_t max, const uint32_t timeoutMicroseconds)
+{
+    THERON_ASSERT(max > 0);
+
+    const uint64_t startTime(Detail::ProfileClock::GetMicroseconds());
+
+    mCondition.Lock();
+    mNumWaiters.Increment();
+
+    // Re-check for arrived messages after advertising ourselves as waiting.
+    // A pushing thread that incremented the count and read the waiter count
+    // before we incremented it won't pulse the condition, but in that case
+    // its increment of the message count is visible to us here.
+    while (mMessagesReceived.Load() == 0)
+    {
+        const uint64_t elapsed(Detail::ProfileClock::GetMicroseconds() - startTime);
+        if (elapsed >= timeoutMicroseconds)
+        {
+            break;
+        }
+
+        // The condition wait is granular to milliseconds; round up so that
+        // sub-millisecond remainders sleep briefly rather than spinning.
+        const uint64_t remaining(timeoutMicroseconds - elapsed);
+        mCondition.Wait(static_cast<uint32_t>((remaining + 999) / 1000));
+    }
+
+    mNumWaiters.Decrement();
+    mCondition.Unlock();
+
+    // Consume up to the maximum number of arrived messages, which may be zero
+    // if the wait timed out.
+    return Consume(max);
+}
+
+
 THERON_FORCEINLINE uint32_t Receiver::Consume(const uint32_t max)
 {
     // TODO: Use atomic test-and-decrement.
@@ -542,19 +623,29 @@ THERON_FORCEINLINE void Receiver::Push(Detail::IMessage *const message)
     mSpinLock.Lock();
 
     // TODO: Use ReceiverHandlerCollection for thread-safety.
-    MessageHandlerList::Iterator handlers(mMessageHandlers.GetIterator());
-    while (handlers.Next())
+    // The handlers are stored contiguously so this walk is cache-friendly.
+    const uint32_t numHandlers(mMessageHandlers.Size());
+    for (uint32_t index = 0; index < numHandlers; ++index)
     {
         // Execute the handler.
         // It does nothing if it can't handle the message type.
-        Detail::IReceiverHandler *const handler(handlers.Get());
-        handler->Handle(message);
+        mMessageHandlers[index]->Handle(message);
     }
 
     mSpinLock.Unlock();
 
     mMessagesReceived.Increment();
 
+    // Wake any thread blocked in a timed wait. As in the worker thread yield
+    // path, we pulse the condition only when a waiter has advertised itself,
+    // keeping the common case where no thread is waiting cheap.
+    if (mNumWaiters.Load() != 0)
+    {
+        mCondition.Lock();
+        mCondition.Pulse();
+        mCondition.Unlock();
+    }
+
     // Destroy the message.
     // We use the global allocator to allocate messages sent to receivers.
     IAllocator *const messageAllocator(AllocatorManager::Instance().GetAllocator());
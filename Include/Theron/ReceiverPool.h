@@ -0,0 +1,214 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_RECEIVERPOOL_H
+#define THERON_RECEIVERPOOL_H
+
+
+/**
+\file ReceiverPool.h
+Pool of pre-registered receivers, reusable without directory traffic.
+*/
+
+
+#include <new>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+#include <Theron/Receiver.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief A reusable pool of pre-registered \ref Receiver "receivers".
+
+Constructing a Receiver registers it with a global directory and claims a
+unique address, which costs a directory lock and entry allocation. Code that
+needs a receiver per request -- a request/response gateway, for example --
+pays that cost on every request. A ReceiverPool constructs and registers a
+fixed block of receivers once, up front, and then hands them out and back
+with atomic index operations, taking registration off the per-request path
+entirely:
+
+\code
+Theron::ReceiverPool pool(64);
+
+// Per request: borrow a receiver, use its address, return it.
+Theron::Receiver *const receiver(pool.Acquire());
+if (receiver)
+{
+    framework.Send(request, receiver->GetAddress(), serverAddress);
+    receiver->Wait();
+
+    pool.Release(receiver);
+}
+\endcode
+
+Each pooled receiver keeps its address for the lifetime of the pool, so an
+address captured while a receiver is borrowed remains valid -- but messages
+arriving after the receiver is returned are counted against its next
+borrower. Consume all expected replies before returning a receiver, and
+deregister any message handlers registered while it was borrowed; the pool
+resets the count of unconsumed messages on return, but handlers persist.
+
+\note Acquire and Release are thread-safe and lock-free, so receivers can be
+borrowed and returned concurrently from many gateway threads.
+*/
+class ReceiverPool
+{
+public:
+
+    /**
+    \brief Constructs a pool of the given number of receivers.
+
+    The receivers are constructed, registered, and assigned their unique
+    addresses immediately, so construction costs what constructing the same
+    number of standalone receivers would; the saving is in the reuse.
+    */
+    inline explicit ReceiverPool(const uint32_t count);
+
+    /**
+    \brief Destructor.
+    Destructs the pooled receivers, deregistering their addresses.
+    \note All borrowed receivers must have been returned.
+    */
+    inline ~ReceiverPool();
+
+    /**
+    \brief Borrows a receiver from the pool.
+    \return A pointer to an exclusively owned receiver, or zero if all of the
+    receivers in the pool are currently borrowed.
+    */
+    inline Receiver *Acquire();
+
+    /**
+    \brief Returns a previously borrowed receiver to the pool.
+    Resets the receiver's count of unconsumed messages, then makes it
+    available to subsequent calls to \ref Acquire.
+    */
+    inline void Release(Receiver *const receiver);
+
+    /**
+    \brief Returns the number of receivers in the pool.
+    */
+    inline uint32_t GetCount() const;
+
+private:
+
+    ReceiverPool(const ReceiverPool &other);
+    ReceiverPool &operator=(const ReceiverPool &other);
+
+    Receiver *mReceivers;                   ///< Block of pooled receiver objects.
+    Detail::Atomic::UInt32 *mFlags;         ///< Per-receiver flags; one while the receiver is free.
+    uint32_t mCount;                        ///< Number of receivers in the pool.
+    Detail::Atomic::UInt32 mNextIndex;      ///< Rotating start offset for free-slot searches.
+};
+
+
+inline ReceiverPool::ReceiverPool(const uint32_t count) :
+  mReceivers(0),
+  mFlags(0),
+  mCount(count),
+  mNextIndex(0)
+{
+    THERON_ASSERT(count > 0);
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    void *const receiverMemory(allocator->AllocateAligned(count * sizeof(Receiver), THERON_CACHELINE_ALIGNMENT));
+    void *const flagMemory(allocator->Allocate(count * sizeof(Detail::Atomic::UInt32)));
+
+    THERON_ASSERT_MSG(receiverMemory && flagMemory, "Failed to allocate receiver pool");
+
+    mReceivers = reinterpret_cast<Receiver *>(receiverMemory);
+    mFlags = reinterpret_cast<Detail::Atomic::UInt32 *>(flagMemory);
+
+    // Constructing the receivers registers them and claims their addresses,
+    // paying the directory traffic for the whole pool once, up front.
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        new (mReceivers + index) Receiver();
+        new (mFlags + index) Detail::Atomic::UInt32(1);
+    }
+}
+
+
+inline ReceiverPool::~ReceiverPool()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    for (uint32_t index = 0; index < mCount; ++index)
+    {
+        THERON_ASSERT_MSG(mFlags[index].Load() == 1, "Receiver still borrowed at pool destruction");
+
+        mFlags[index].~UInt32();
+        mReceivers[index].~Receiver();
+    }
+
+    allocator->Free(mFlags, mCount * sizeof(Detail::Atomic::UInt32));
+    allocator->Free(mReceivers, mCount * sizeof(Receiver));
+}
+
+
+THERON_FORCEINLINE Receiver *ReceiverPool::Acquire()
+{
+    // Start each search at a rotating offset, spreading concurrent acquirers
+    // across the slots so they don't all contend for the same one.
+    const uint32_t start(mNextIndex.FetchIncrement());
+
+    for (uint32_t probe = 0; probe < mCount; ++probe)
+    {
+        const uint32_t index((start + probe) % mCount);
+
+        // Peek before the compare-exchange so slots borrowed by others are
+        // skipped with a plain read, without bouncing their cache lines.
+        if (mFlags[index].Load() == 1)
+        {
+            uint32_t expected(1);
+            if (mFlags[index].CompareExchangeAcquire(expected, 0))
+            {
+                return mReceivers + index;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+THERON_FORCEINLINE void ReceiverPool::Release(Receiver *const receiver)
+{
+    THERON_ASSERT(receiver);
+
+    const uint32_t index(static_cast<uint32_t>(receiver - mReceivers));
+    THERON_ASSERT_MSG(index < mCount, "Receiver wasn't borrowed from this pool");
+    THERON_ASSERT_MSG(mFlags[index].Load() == 0, "Receiver returned to the pool twice");
+
+    // Forget any unconsumed messages, so stragglers arriving for this
+    // borrower aren't counted against the next.
+    receiver->Reset();
+
+    // The release semantics publish the reset before the slot becomes
+    // claimable by another acquirer.
+    uint32_t expected(0);
+    mFlags[index].CompareExchangeRelease(expected, 1);
+}
+
+
+THERON_FORCEINLINE uint32_t ReceiverPool::GetCount() const
+{
+    return mCount;
+}
+
+
+} // namespace Theron
+
+
+#endif // THERON_RECEIVERPOOL_H
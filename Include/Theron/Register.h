@@ -3,7 +3,12 @@
 #define THERON_REGISTER_H
 
 
+#include <Theron/BasicTypes.h>
+
+#include <Theron/Detail/Allocators/MessagePool.h>
+#include <Theron/Detail/Messages/Message.h>
 #include <Theron/Detail/Messages/MessageTraits.h>
+#include <Theron/Detail/Messages/MessageTypeId.h>
 
 
 /**
@@ -96,6 +101,7 @@ struct MessageTraits<MessageType>                                           \
 {                                                                           \
     static const bool HAS_TYPE_NAME = true;                                 \
     static const char *const TYPE_NAME;                                     \
+    static const uint32_t TYPE_ID;                                          \
 };                                                                          \
 }                                                                           \
 }
@@ -124,12 +130,310 @@ namespace Theron                                                            \
 namespace Detail                                                            \
 {                                                                           \
 const char *const MessageTraits<MessageType>::TYPE_NAME = #MessageType;     \
+const uint32_t MessageTraits<MessageType>::TYPE_ID =                        \
+    MessageTypeRegistry::Allocate();                                        \
 }                                                                           \
 }
 
 #endif // THERON_DEFINE_REGISTERED_MESSAGE
 
 
+/**
+\def THERON_DECLARE_POOLED_MESSAGE
+
+\brief Declares a dedicated message block pool for a registered message type.
+
+Registration already knows the exact size and alignment of the memory block
+backing each sent message of a type, so hot message types can additionally be
+given a dedicated fixed-block pool. Messages of pooled types are allocated
+with a freelist pop from the per-type pool, bypassing the size lookup in the
+general message caches, and their blocks are returned to the pool when the
+messages are destroyed.
+
+Use this macro in the header declaring the message type, after
+\ref THERON_DECLARE_REGISTERED_MESSAGE for the same type, with the matching
+\ref THERON_DEFINE_POOLED_MESSAGE in the corresponding source file:
+
+\code
+// In the header
+THERON_DECLARE_REGISTERED_MESSAGE(MyNamespace::MyMessage);
+THERON_DECLARE_POOLED_MESSAGE(MyNamespace::MyMessage);
+
+// In the corresponding .cpp file
+THERON_DEFINE_REGISTERED_MESSAGE(MyNamespace::MyMessage);
+THERON_DEFINE_POOLED_MESSAGE(MyNamespace::MyMessage);
+\endcode
+
+Each pool retains a fixed number of free blocks, and can be pre-sized at
+runtime with \ref Theron::SetMessagePoolDepth "SetMessagePoolDepth", which
+preallocates the pool so the configured number of messages can be in flight
+without the general allocator being touched at all:
+
+\code
+Theron::SetMessagePoolDepth<MyNamespace::MyMessage>(1024);
+\endcode
+
+\note Pooling requires the message type to be registered, and the DEFINE
+macros must appear in registration-then-pool order in the same source file.
+Like the registration macros, the pool macros can only be used from within
+the global namespace.
+
+\see THERON_DEFINE_POOLED_MESSAGE
+*/
+
+
+#ifndef THERON_DECLARE_POOLED_MESSAGE
+
+#define THERON_DECLARE_POOLED_MESSAGE(MessageType)                          \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+template <>                                                                 \
+struct MessagePoolTraits<MessageType>                                       \
+{                                                                           \
+    static const bool HAS_POOL = true;                                      \
+    static const MessagePoolRegistrar REGISTRAR;                            \
+};                                                                          \
+}                                                                           \
+}
+
+#endif // THERON_DECLARE_POOLED_MESSAGE
+
+
+/**
+\def THERON_DEFINE_POOLED_MESSAGE
+
+\brief Definition macro for dedicated message block pools.
+
+Defines the pool declared for a registered message type with
+\ref THERON_DECLARE_POOLED_MESSAGE, registering the pool during static
+initialization with the exact size and alignment of the type's message blocks.
+
+\see THERON_DECLARE_POOLED_MESSAGE
+*/
+
+
+#ifndef THERON_DEFINE_POOLED_MESSAGE
+
+#define THERON_DEFINE_POOLED_MESSAGE(MessageType)                           \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+const MessagePoolRegistrar MessagePoolTraits<MessageType>::REGISTRAR(       \
+    MessageTraits<MessageType>::TYPE_ID,                                    \
+    Message<MessageType>::GetSize(),                                        \
+    Message<MessageType>::GetAlignment());                                  \
+}                                                                           \
+}
+
+#endif // THERON_DEFINE_POOLED_MESSAGE
+
+
+/**
+\def THERON_DECLARE_URGENT_MESSAGE
+
+\brief Declares priority in-mailbox delivery for a registered message type.
+
+Messages of urgent types jump ahead of other messages already queued in the
+destination mailbox: each mailbox maintains a dedicated urgent lane that the
+processing worker thread drains before any queued bulk work, in constant time.
+This complements mailbox-level priority (\ref Theron::Framework::SetPriority
+"Framework::SetPriority"), which orders whole mailboxes relative to each other but
+leaves delivery within a mailbox strictly first-in first-out. Control messages
+such as cancellations and flushes are natural urgent types, since otherwise
+they wait behind however much bulk data the destination has queued.
+
+Delivery remains first-in first-out within each class: urgent messages are
+ordered among themselves, as are ordinary ones.
+
+Use this macro in the header declaring the message type, after
+\ref THERON_DECLARE_REGISTERED_MESSAGE for the same type, with the matching
+\ref THERON_DEFINE_URGENT_MESSAGE in the corresponding source file:
+
+\code
+// In the header
+THERON_DECLARE_REGISTERED_MESSAGE(MyNamespace::Cancel);
+THERON_DECLARE_URGENT_MESSAGE(MyNamespace::Cancel);
+
+// In the corresponding .cpp file
+THERON_DEFINE_REGISTERED_MESSAGE(MyNamespace::Cancel);
+THERON_DEFINE_URGENT_MESSAGE(MyNamespace::Cancel);
+\endcode
+
+\note Urgency requires the message type to be registered, and the DEFINE
+macros must appear in registration-then-urgency order in the same source file.
+Like the registration macros, the urgency macros can only be used from within
+the global namespace.
+
+\see THERON_DEFINE_URGENT_MESSAGE
+*/
+
+
+#ifndef THERON_DECLARE_URGENT_MESSAGE
+
+#define THERON_DECLARE_URGENT_MESSAGE(MessageType)                          \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+template <>                                                                 \
+struct MessageUrgencyTraits<MessageType>                                    \
+{                                                                           \
+    static const bool IS_URGENT = true;                                     \
+    static const MessageUrgencyRegistrar REGISTRAR;                         \
+};                                                                          \
+}                                                                           \
+}
+
+#endif // THERON_DECLARE_URGENT_MESSAGE
+
+
+/**
+\def THERON_DEFINE_URGENT_MESSAGE
+
+\brief Definition macro for urgent message types.
+
+Defines the urgency declared for a registered message type with
+\ref THERON_DECLARE_URGENT_MESSAGE, registering the type as urgent during
+static initialization.
+
+\see THERON_DECLARE_URGENT_MESSAGE
+*/
+
+
+#ifndef THERON_DEFINE_URGENT_MESSAGE
+
+#define THERON_DEFINE_URGENT_MESSAGE(MessageType)                           \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+const MessageUrgencyRegistrar MessageUrgencyTraits<MessageType>::REGISTRAR( \
+    MessageTraits<MessageType>::TYPE_ID);                                   \
+}                                                                           \
+}
+
+#endif // THERON_DEFINE_URGENT_MESSAGE
+
+
+/**
+\def THERON_DECLARE_CONFLATABLE_MESSAGE
+
+\brief Declares arrival coalescing for a registered message type.
+
+Messages of conflatable types are idempotent state updates where only the
+newest version matters: position snapshots, configuration refreshes, and the
+like. When a message of a conflatable type arrives at a mailbox that still
+holds an older unprocessed message of the same type from the same sender, the
+new message replaces the old one in place rather than queuing behind it, so
+the queue holds at most one pending update per sender however fast the sender
+produces them. The replaced older message is destroyed without being delivered.
+
+Conflated updates are delivered ahead of ordinary queued messages, like urgent
+ones, since by declaration only their latest version carries information.
+Because replacement collapses history, conflatable types forgo the usual
+guarantee that every sent message is delivered; senders must not use them for
+messages whose individual delivery matters.
+
+Use this macro in the header declaring the message type, after
+\ref THERON_DECLARE_REGISTERED_MESSAGE for the same type, with the matching
+\ref THERON_DEFINE_CONFLATABLE_MESSAGE in the corresponding source file:
+
+\code
+// In the header
+THERON_DECLARE_REGISTERED_MESSAGE(MyNamespace::PositionUpdate);
+THERON_DECLARE_CONFLATABLE_MESSAGE(MyNamespace::PositionUpdate);
+
+// In the corresponding .cpp file
+THERON_DEFINE_REGISTERED_MESSAGE(MyNamespace::PositionUpdate);
+THERON_DEFINE_CONFLATABLE_MESSAGE(MyNamespace::PositionUpdate);
+\endcode
+
+\note Conflation requires the message type to be registered, and the DEFINE
+macros must appear in registration-then-conflation order in the same source
+file. Like the registration macros, the conflation macros can only be used
+from within the global namespace.
+
+\see THERON_DEFINE_CONFLATABLE_MESSAGE
+*/
+
+
+#ifndef THERON_DECLARE_CONFLATABLE_MESSAGE
+
+#define THERON_DECLARE_CONFLATABLE_MESSAGE(MessageType)                     \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+template <>                                                                 \
+struct MessageConflationTraits<MessageType>                                 \
+{                                                                           \
+    static const bool IS_CONFLATABLE = true;                                \
+    static const MessageConflationRegistrar REGISTRAR;                      \
+};                                                                          \
+}                                                                           \
+}
+
+#endif // THERON_DECLARE_CONFLATABLE_MESSAGE
+
+
+/**
+\def THERON_DEFINE_CONFLATABLE_MESSAGE
+
+\brief Definition macro for conflatable message types.
+
+Defines the conflatability declared for a registered message type with
+\ref THERON_DECLARE_CONFLATABLE_MESSAGE, registering the type as conflatable
+during static initialization.
+
+\see THERON_DECLARE_CONFLATABLE_MESSAGE
+*/
+
+
+#ifndef THERON_DEFINE_CONFLATABLE_MESSAGE
+
+#define THERON_DEFINE_CONFLATABLE_MESSAGE(MessageType)                      \
+namespace Theron                                                            \
+{                                                                           \
+namespace Detail                                                            \
+{                                                                           \
+const MessageConflationRegistrar                                            \
+    MessageConflationTraits<MessageType>::REGISTRAR(                        \
+        MessageTraits<MessageType>::TYPE_ID);                               \
+}                                                                           \
+}
+
+#endif // THERON_DEFINE_CONFLATABLE_MESSAGE
+
+
+namespace Theron
+{
+
+
+/**
+\brief Sets the number of free message blocks retained by the pool of a pooled message type.
+
+The pool is preallocated to the given depth, so that the configured number of
+messages of the type can be allocated without touching the general allocator.
+
+\note The message type must have a pool declared with
+\ref THERON_DECLARE_POOLED_MESSAGE.
+
+\tparam MessageType The pooled message type whose pool is sized.
+\param maxBlocks The number of free message blocks retained by the pool.
+*/
+template <class MessageType>
+inline void SetMessagePoolDepth(const uint32_t maxBlocks)
+{
+    Detail::MessagePool::SetDepth(Detail::MessageTraits<MessageType>::TYPE_ID, maxBlocks);
+}
+
+
+} // namespace Theron
+
+
 /**
 \def THERON_REGISTER_MESSAGE
 
@@ -154,9 +458,12 @@ struct MessageTraits<MessageType>                                           \
 {                                                                           \
     static const bool HAS_TYPE_NAME = true;                                 \
     static const char *const TYPE_NAME;                                     \
+    static const uint32_t TYPE_ID;                                          \
 };                                                                          \
                                                                             \
 const char *const MessageTraits<MessageType>::TYPE_NAME = #MessageType;     \
+const uint32_t MessageTraits<MessageType>::TYPE_ID =                        \
+    MessageTypeRegistry::Allocate();                                        \
 }                                                                           \
 }
 
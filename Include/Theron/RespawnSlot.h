@@ -0,0 +1,136 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_RESPAWNSLOT_H
+#define THERON_RESPAWNSLOT_H
+
+
+/**
+\file RespawnSlot.h
+Pre-reserved mailbox slot and actor storage, for constant-time actor respawns.
+*/
+
+
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+
+namespace Theron
+{
+
+
+class Actor;
+class Framework;
+
+
+/**
+\brief Pre-reserved resources for respawning a failed actor in constant time.
+
+Supervision code that detects failed actors and restarts them ordinarily pays
+the full cost of actor construction at restart time: allocating storage for
+the actor object and claiming a mailbox in the framework's mailbox directory,
+potentially page-backing a fresh directory page. Failures tend to correlate
+with load spikes, so restart is the worst possible moment to pay for
+allocation.
+
+A RespawnSlot moves those costs to reservation time. Reserving a slot with
+\ref Framework::ReserveRespawnSlot allocates aligned storage for the successor
+actor and claims (and page-backs) its mailbox up front, typically at startup
+or otherwise outside any incident. When a failure is later detected,
+\ref Framework::RespawnActor constructs the successor into the reserved
+storage and mailbox, touching no allocator, and redirects the failed actor's
+address to it so queued and future messages reach the successor.
+
+\code
+Theron::Framework framework;
+Theron::RespawnSlot slot;
+
+framework.ReserveRespawnSlot<WorkerActor>(slot);
+
+WorkerActor *worker(new WorkerActor(framework));
+
+// ... the supervisor detects that the worker has failed ...
+
+const Theron::Address failedAddress(worker->GetAddress());
+delete worker;
+
+WorkerActor *const successor(framework.RespawnActor<WorkerActor>(slot, failedAddress));
+\endcode
+
+The slot owns the storage of the actor respawned into it: the successor is
+destructed, and the storage freed, when the slot is destructed or \ref Reset
+is called, which must happen before the framework is destructed. Each slot
+supports a single respawn; mailbox slots are deliberately never recycled, so
+a supervisor that restarts the same actor repeatedly reserves a fresh slot
+after each use, again outside the incident.
+
+\note Detection of dead or wedged actors remains the supervisor's business;
+the framework provides only the constant-time replacement primitive.
+
+\see Framework::ReserveRespawnSlot
+\see Framework::RespawnActor
+*/
+class RespawnSlot
+{
+public:
+
+    friend class Framework;
+
+    /**
+    Default constructor; constructs an empty slot with no reserved resources.
+    */
+    inline RespawnSlot() :
+      mFramework(0),
+      mStorage(0),
+      mStorageSize(0),
+      mMailboxIndex(0),
+      mActor(0)
+    {
+    }
+
+    /**
+    Destructor; destructs any actor respawned into the slot and frees the
+    reserved storage.
+    */
+    ~RespawnSlot();
+
+    /**
+    Returns true if the slot holds reserved resources not yet consumed by a
+    respawn.
+    */
+    THERON_FORCEINLINE bool IsReserved() const
+    {
+        return (mStorage != 0) && (mActor == 0);
+    }
+
+    /**
+    Returns a pointer to the actor respawned into the slot, or zero if the
+    slot hasn't been used yet.
+    */
+    THERON_FORCEINLINE Actor *GetActor() const
+    {
+        return mActor;
+    }
+
+    /**
+    Destructs any actor respawned into the slot, frees the reserved storage,
+    and returns the slot to its empty default-constructed state, ready to be
+    reserved again.
+    */
+    void Reset();
+
+private:
+
+    RespawnSlot(const RespawnSlot &other);
+    RespawnSlot &operator=(const RespawnSlot &other);
+
+    Framework *mFramework;                  ///< The framework the reservation was made in.
+    void *mStorage;                         ///< Pre-allocated aligned storage for the successor actor.
+    uint32_t mStorageSize;                  ///< Size of the pre-allocated storage in bytes.
+    uint32_t mMailboxIndex;                 ///< Pre-claimed mailbox index for the successor.
+    Actor *mActor;                          ///< The actor respawned into the slot, once used.
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_RESPAWNSLOT_H
@@ -0,0 +1,292 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_RINGCATCHER_H
+#define THERON_RINGCATCHER_H
+
+
+/**
+\file RingCatcher.h
+Fixed-capacity utility that catches messages received by a Receiver.
+*/
+
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+
+
+/**
+\brief A fixed-capacity variant of \ref Catcher backed by preallocated ring storage.
+
+Like \ref Catcher, this class template catches messages received by a \ref Receiver:
+its \ref Push method has the signature of a message handler, so it can be registered
+as a handler with \ref Receiver::RegisterHandler and acts as a thread-safe FIFO
+buffer of received messages.
+
+Unlike \ref Catcher, which allocates a queue node for every caught message, the
+RingCatcher stores caught messages in a ring buffer embedded in the catcher object
+itself. The capacity is fixed at compile time and required to be a power of two, so
+that ring positions can be computed from monotonically increasing indices with a
+simple mask. Push and Pop perform no allocations at all, making this the preferred
+catcher for high-throughput code that pops large numbers of results.
+
+The price of preallocation is that the ring can become full. If a message arrives
+while the ring is full then it is counted but not stored, and is lost; choose a
+capacity no smaller than the largest number of messages that can be caught between
+pops, and check \ref Dropped if in doubt.
+
+\code
+Theron::Receiver receiver;
+Theron::RingCatcher<int, 1024> catcher;
+
+receiver.RegisterHandler(&catcher, &Theron::RingCatcher<int, 1024>::Push);
+\endcode
+
+\tparam MessageType The type of message caught by the catcher.
+\tparam capacity The number of messages the ring can hold; must be a power of two.
+
+\see Catcher
+*/
+template <class MessageType, uint32_t capacity = 1024>
+class RingCatcher
+{
+public:
+
+#if THERON_CPP11
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "RingCatcher capacity must be a power of two");
+#endif // THERON_CPP11
+
+    /**
+    \brief Default constructor.
+    */
+    inline RingCatcher();
+
+    /**
+    \brief Destructor.
+    */
+    inline ~RingCatcher();
+
+    /**
+    Returns true if the catcher contains no caught messages.
+    */
+    inline bool Empty() const;
+
+    /**
+    Returns the number of messages that arrived while the ring was full, and were lost.
+    */
+    inline uint32_t Dropped() const;
+
+    /**
+    \brief Pushes a caught message into the ring.
+
+    This function has the signature of a message handler and so can be
+    registered as a message handler with a \ref Receiver.
+
+    If the ring is full then the message is dropped, and accounted for in \ref Dropped.
+
+    \param message A message instance to be pushed onto the ring.
+    \param from The address of the actor (or entity) that sent the message.
+
+    \see Receiver::RegisterHandler
+    */
+    inline void Push(const MessageType &message, const Address from);
+
+    /**
+    Gets the next caught message without removing it from the ring.
+
+    \param message A message instance into which the caught message is copied.
+    \param from An address into which the sender's address is copied.
+
+    \return True, if a caught message was available.
+    */
+    inline bool Front(MessageType &message, Address &from);
+
+    /**
+    Gets the next caught message, removing it from the ring.
+
+    \param message A message instance into which the caught message is copied.
+    \param from An address into which the sender's address is copied.
+
+    \return True, if a caught message was available.
+    */
+    inline bool Pop(MessageType &message, Address &from);
+
+private:
+
+    /**
+    \brief Wrapper struct that pairs a caught message with its sender's address.
+    */
+    struct Entry
+    {
+        inline Entry(const MessageType &message, const Address from) : mMessage(message), mFrom(from)
+        {
+        }
+
+        MessageType mMessage;               ///< The caught message.
+        Address mFrom;                      ///< The address of the sender.
+    };
+
+    static const uint32_t MASK = capacity - 1;
+
+    RingCatcher(const RingCatcher &other);
+    RingCatcher &operator=(const RingCatcher &other);
+
+    /**
+    Returns a pointer to the entry slot at the given monotonic index.
+    */
+    THERON_FORCEINLINE Entry *Slot(const uint32_t index)
+    {
+        return reinterpret_cast<Entry *>(mBuffer) + (index & MASK);
+    }
+
+    mutable Detail::SpinLock mSpinLock;     ///< Thread synchronization primitive.
+    uint32_t mWriteIndex;                   ///< Monotonically increasing index of the next free slot.
+    uint32_t mReadIndex;                    ///< Monotonically increasing index of the oldest occupied slot.
+    uint32_t mDropped;                      ///< Number of messages dropped because the ring was full.
+
+    /**
+    Raw storage for the entry slots, constructed in place as messages are caught.
+    */
+    THERON_PREALIGN(THERON_ALIGNOF(Entry))
+    uint8_t mBuffer[capacity * sizeof(Entry)] THERON_POSTALIGN(THERON_ALIGNOF(Entry));
+};
+
+
+template <class MessageType, uint32_t capacity>
+inline RingCatcher<MessageType, capacity>::RingCatcher() :
+  mSpinLock(),
+  mWriteIndex(0),
+  mReadIndex(0),
+  mDropped(0)
+{
+    // The power-of-two requirement allows ring positions to be masked from
+    // monotonic indices, and full/empty to be distinguished by their difference.
+    THERON_ASSERT((capacity & (capacity - 1)) == 0);
+}
+
+
+template <class MessageType, uint32_t capacity>
+inline RingCatcher<MessageType, capacity>::~RingCatcher()
+{
+    mSpinLock.Lock();
+
+    // Destruct any left-over entries in the ring.
+    while (mReadIndex != mWriteIndex)
+    {
+        Slot(mReadIndex)->~Entry();
+        ++mReadIndex;
+    }
+
+    mSpinLock.Unlock();
+}
+
+
+template <class MessageType, uint32_t capacity>
+THERON_FORCEINLINE bool RingCatcher<MessageType, capacity>::Empty() const
+{
+    bool empty(false);
+
+    mSpinLock.Lock();
+    empty = (mReadIndex == mWriteIndex);
+    mSpinLock.Unlock();
+
+    return empty;
+}
+
+
+template <class MessageType, uint32_t capacity>
+THERON_FORCEINLINE uint32_t RingCatcher<MessageType, capacity>::Dropped() const
+{
+    uint32_t dropped(0);
+
+    mSpinLock.Lock();
+    dropped = mDropped;
+    mSpinLock.Unlock();
+
+    return dropped;
+}
+
+
+template <class MessageType, uint32_t capacity>
+inline void RingCatcher<MessageType, capacity>::Push(const MessageType &message, const Address from)
+{
+    mSpinLock.Lock();
+
+    if (mWriteIndex - mReadIndex == capacity)
+    {
+        // The ring is full; drop the message rather than grow.
+        ++mDropped;
+        mSpinLock.Unlock();
+        return;
+    }
+
+    // Construct the entry in place in the next free slot.
+    new (Slot(mWriteIndex)) Entry(message, from);
+    ++mWriteIndex;
+
+    mSpinLock.Unlock();
+}
+
+
+template <class MessageType, uint32_t capacity>
+inline bool RingCatcher<MessageType, capacity>::Front(MessageType &message, Address &from)
+{
+    bool available(false);
+
+    mSpinLock.Lock();
+
+    if (mReadIndex != mWriteIndex)
+    {
+        // Copy the data from the oldest occupied slot, leaving it in place.
+        const Entry *const entry(Slot(mReadIndex));
+        message = entry->mMessage;
+        from = entry->mFrom;
+
+        available = true;
+    }
+
+    mSpinLock.Unlock();
+
+    return available;
+}
+
+
+template <class MessageType, uint32_t capacity>
+inline bool RingCatcher<MessageType, capacity>::Pop(MessageType &message, Address &from)
+{
+    bool available(false);
+
+    mSpinLock.Lock();
+
+    if (mReadIndex != mWriteIndex)
+    {
+        // Copy the data from the oldest occupied slot, then destruct it.
+        Entry *const entry(Slot(mReadIndex));
+        message = entry->mMessage;
+        from = entry->mFrom;
+
+        entry->~Entry();
+        ++mReadIndex;
+
+        available = true;
+    }
+
+    mSpinLock.Unlock();
+
+    return available;
+}
+
+
+} // namespace Theron
+
+
+#endif // THERON_RINGCATCHER_H
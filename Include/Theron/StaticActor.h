@@ -0,0 +1,171 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_STATICACTOR_H
+#define THERON_STATICACTOR_H
+
+
+/**
+\file StaticActor.h
+Actor baseclass template with compile-time message dispatch.
+*/
+
+
+#include <Theron/Actor.h>
+#include <Theron/Address.h>
+#include <Theron/Defines.h>
+#include <Theron/Framework.h>
+
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/Message.h>
+#include <Theron/Detail/Messages/MessageCast.h>
+#include <Theron/Detail/Messages/MessageTraits.h>
+
+
+#if THERON_CPP11
+
+
+namespace Theron
+{
+
+
+/**
+\brief Actor baseclass template that dispatches a fixed set of message types at compile time.
+
+Whereas \ref Actor dispatches received messages through handlers registered dynamically
+with \ref Actor::RegisterHandler "RegisterHandler", paying a virtual call and a type
+check per registered handler, StaticActor generates the dispatch for a fixed list of
+message types at compile time. The derived class lists its message types as template
+arguments and defines an overloaded \em Handle member function for each listed type.
+Received messages of listed types are dispatched with a chain of inlinable type checks
+directly to the matching overload, with no handler list traversal and no per-handler
+virtual call.
+
+\code
+class Counter : public Theron::StaticActor<Counter, int, float>
+{
+public:
+
+    explicit Counter(Theron::Framework &framework) : StaticActor(framework)
+    {
+    }
+
+    inline void Handle(const int &message, const Theron::Address from)
+    {
+        // Handles messages of type int.
+    }
+
+    inline void Handle(const float &message, const Theron::Address from)
+    {
+        // Handles messages of type float.
+    }
+};
+\endcode
+
+Messages of types not listed fall back to the dynamic dispatch path, so handlers for
+additional types can still be registered with \ref Actor::RegisterHandler as usual.
+The dynamic machinery of \ref Actor is still available and unchanged; StaticActor is
+an optimization for actors whose message set is known at compile time, typically
+small actors executed in performance-critical inner loops.
+
+\note Unlike dynamically registered handlers, the statically listed handlers can't be
+deregistered, and are always executed in preference to any dynamically registered
+handlers for the same message type.
+
+\tparam Derived The derived actor class, which defines a \em Handle overload per listed type.
+\tparam MessageTypes List of message types dispatched at compile time.
+*/
+template <class Derived, class... MessageTypes>
+class StaticActor : public Actor
+{
+public:
+
+    static_assert(sizeof...(MessageTypes) > 0, "StaticActor requires at least one message type");
+
+    /**
+    \brief Constructor.
+
+    Like \ref Actor::Actor, constructs the actor within the given framework,
+    with an optional unique name. Additionally registers all the statically
+    listed message types with the network endpoint (if any) tied to the
+    framework, as dynamic handler registration would.
+    */
+    inline explicit StaticActor(Framework &framework, const char *const name = 0) :
+      Actor(framework, name)
+    {
+        RegisterListedTypes();
+    }
+
+protected:
+
+    /**
+    \brief Dispatches a received message, resolving listed message types at compile time.
+
+    Messages of types not in the static list are passed to the dynamically
+    registered handlers, if any.
+    */
+    inline virtual bool DispatchMessage(const Detail::IMessage *const message)
+    {
+        if (TryDispatch<MessageTypes...>(message))
+        {
+            return true;
+        }
+
+        // The message type isn't statically listed; fall back to the dynamic handlers.
+        return Actor::DispatchMessage(message);
+    }
+
+private:
+
+    /**
+    Registers the listed message types with the framework's network endpoint, if any.
+    */
+    inline void RegisterListedTypes()
+    {
+        // Expand the pack into a dummy array, registering each listed type in turn.
+        const int dummy[] = { (RegisterMessageType<MessageTypes>(), 0)... };
+        (void) dummy;
+    }
+
+    /**
+    Offers the message to the handler for each listed type in turn.
+    Each check compiles down to a type identity test and an inlinable direct call.
+    */
+    template <class ValueType, class SecondType, class... OtherTypes>
+    THERON_FORCEINLINE bool TryDispatch(const Detail::IMessage *const message)
+    {
+        if (TryDispatch<ValueType>(message))
+        {
+            return true;
+        }
+
+        return TryDispatch<SecondType, OtherTypes...>(message);
+    }
+
+    /**
+    Offers the message to the handler for a single listed type.
+    */
+    template <class ValueType>
+    THERON_FORCEINLINE bool TryDispatch(const Detail::IMessage *const message)
+    {
+        typedef Detail::MessageCast<Detail::MessageTraits<ValueType>::HAS_TYPE_NAME> MessageCaster;
+
+        // Try to convert the message, of unknown type, to a message of the listed type.
+        const Detail::Message<ValueType> *const typedMessage(MessageCaster::template CastMessage<ValueType>(message));
+        if (typedMessage)
+        {
+            // The overload taking the listed type is resolved at compile time.
+            static_cast<Derived *>(this)->Handle(typedMessage->Value(), typedMessage->From());
+            return true;
+        }
+
+        return false;
+    }
+};
+
+
+} // namespace Theron
+
+
+#endif // THERON_CPP11
+
+
+#endif // THERON_STATICACTOR_H
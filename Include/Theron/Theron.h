@@ -1,30 +1,46 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_THERON_H
-#define THERON_THERON_H
-
-
-/**
-\file Theron.h
-All-inclusive wrapper header that includes all public headers.
-*/
-
-
-#include <Theron/Actor.h>
-#include <Theron/ActorRef.h>
-#include <Theron/Address.h>
-#include <Theron/Align.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/BasicTypes.h>
-#include <Theron/Catcher.h>
-#include <Theron/Counters.h>
-#include <Theron/DefaultAllocator.h>
-#include <Theron/Defines.h>
-#include <Theron/EndPoint.h>
-#include <Theron/Framework.h>
-#include <Theron/IAllocator.h>
-#include <Theron/Receiver.h>
-#include <Theron/Register.h>
-
-
-#endif // THERON_THERON_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_THERON_H
+#define THERON_THERON_H
+
+
+/**
+\file Theron.h
+All-inclusive wrapper header that includes all public headers.
+*/
+
+
+#include <Theron/Actor.h>
+#include <Theron/ActorCreatedEvent.h>
+#include <Theron/ActorProfile.h>
+#include <Theron/ActorRef.h>
+#include <Theron/Address.h>
+#include <Theron/Align.h>
+#include <Theron/AllocatorCacheStats.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Batcher.h>
+#include <Theron/Catcher.h>
+#include <Theron/Counters.h>
+#include <Theron/DefaultAllocator.h>
+#include <Theron/Defines.h>
+#include <Theron/EndPoint.h>
+#include <Theron/FileStreamer.h>
+#include <Theron/Framework.h>
+#include <Theron/HandlerTable.h>
+#include <Theron/IAllocator.h>
+#include <Theron/ICompressor.h>
+#include <Theron/MailboxHandle.h>
+#include <Theron/MessageBuilder.h>
+#include <Theron/MessageTypeStats.h>
+#include <Theron/MessageView.h>
+#include <Theron/QueueWatermarkEvent.h>
+#include <Theron/Receiver.h>
+#include <Theron/ReceiverPool.h>
+#include <Theron/RespawnSlot.h>
+#include <Theron/RingCatcher.h>
+#include <Theron/StaticActor.h>
+#include <Theron/Register.h>
+
+
+#endif // THERON_THERON_H
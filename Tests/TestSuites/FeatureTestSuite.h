@@ -1,2188 +1,6198 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-#ifndef THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
-#define THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
-
-
-#include <string.h>
-#include <vector>
-#include <string>
-#include <queue>
-
-#include <Theron/Theron.h>
-
-#include <Theron/Detail/Threading/Utils.h>
-
-#include "TestFramework/TestSuite.h"
-
-
-namespace Tests
-{
-
-
-class FeatureTestSuite : public TestFramework::TestSuite
-{
-public:
-
-    inline FeatureTestSuite()
-    {
-        TESTFRAMEWORK_REGISTER_TESTSUITE(FeatureTestSuite);
-
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFramework);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkThreadCount);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkDefaultParams);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsThreadCount);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsThreadCountNode);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructActor);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructMultipleActors);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructAddress);
-        TESTFRAMEWORK_REGISTER_TEST(CopyAddress);
-        TESTFRAMEWORK_REGISTER_TEST(AssignAddress);
-        TESTFRAMEWORK_REGISTER_TEST(GetActorFramework);
-        TESTFRAMEWORK_REGISTER_TEST(GetActorAddress);
-        TESTFRAMEWORK_REGISTER_TEST(RegisterHandler);
-        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessage);
-        TESTFRAMEWORK_REGISTER_TEST(CreateActorInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToReceiverInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageFromNullAddressInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToActorFromNullAddressInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToActorFromReceiverInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromNullAddressInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromReceiverInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(ReceiveReplyInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(CatchReplyInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendNonPODMessageInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendPointerMessageInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(SendConstPointerMessageInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(CreateDerivedActor);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToDerivedActor);
-        TESTFRAMEWORK_REGISTER_TEST(IncrementCounter);
-        TESTFRAMEWORK_REGISTER_TEST(ActorTemplate);
-        TESTFRAMEWORK_REGISTER_TEST(OneHandlerAtATime);
-        TESTFRAMEWORK_REGISTER_TEST(MultipleHandlersForMessageType);
-        TESTFRAMEWORK_REGISTER_TEST(MessageArrivalOrder);
-        TESTFRAMEWORK_REGISTER_TEST(SendAddressAsMessage);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToDefaultHandlerInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(RegisterHandlerFromHandler);
-        TESTFRAMEWORK_REGISTER_TEST(CreateActorInConstructor);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageInConstructor);
-        TESTFRAMEWORK_REGISTER_TEST(DeregisterHandlerInConstructor);
-        TESTFRAMEWORK_REGISTER_TEST(CreateActorInDestructor);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageInDestructor);
-        TESTFRAMEWORK_REGISTER_TEST(DeregisterHandlerInDestructor);
-        TESTFRAMEWORK_REGISTER_TEST(CreateActorInHandler);
-        TESTFRAMEWORK_REGISTER_TEST(GetNumQueuedMessagesInHandler);
-        TESTFRAMEWORK_REGISTER_TEST(GetNumQueuedMessagesInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(UseBlindDefaultHandler);
-        TESTFRAMEWORK_REGISTER_TEST(IsHandlerRegisteredInHandler);
-        TESTFRAMEWORK_REGISTER_TEST(SetFallbackHandler);
-        TESTFRAMEWORK_REGISTER_TEST(HandleUndeliveredMessageSentInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(HandleUnhandledMessageSentInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(HandleUndeliveredBlindMessageSentInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(HandleMessageSentToStaleFrameworkInFunction);
-        TESTFRAMEWORK_REGISTER_TEST(HandleMessageSentToStaleFrameworkInHandler);
-        TESTFRAMEWORK_REGISTER_TEST(SendRegisteredMessage);
-        TESTFRAMEWORK_REGISTER_TEST(DeriveFromActorFirst);
-        TESTFRAMEWORK_REGISTER_TEST(DeriveFromActorLast);
-        TESTFRAMEWORK_REGISTER_TEST(SendEmptyMessage);
-        TESTFRAMEWORK_REGISTER_TEST(MultipleFrameworks);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkWithParameters);
-        TESTFRAMEWORK_REGISTER_TEST(UseActorRefs);
-        TESTFRAMEWORK_REGISTER_TEST(ThreadCountApi);
-        TESTFRAMEWORK_REGISTER_TEST(EventCounterApi);
-        TESTFRAMEWORK_REGISTER_TEST(ConstructEndPoint);
-        TESTFRAMEWORK_REGISTER_TEST(TieFrameworkToEndPoint);
-        TESTFRAMEWORK_REGISTER_TEST(TieActorsToEndPoint);
-        TESTFRAMEWORK_REGISTER_TEST(TieReceiverstoEndPoint);
-        TESTFRAMEWORK_REGISTER_TEST(NameFrameworkOnConstruction);
-        TESTFRAMEWORK_REGISTER_TEST(NameActorOnConstruction);
-        TESTFRAMEWORK_REGISTER_TEST(NameReceiverOnConstruction);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessageToLocalActorByName);
-        TESTFRAMEWORK_REGISTER_TEST(SendMessagesBetweenLocalFrameworksByName);
-    }
-
-    inline static void ConstructFramework()
-    {
-        Theron::Framework framework;
-    }
-
-    inline static void ConstructFrameworkThreadCount()
-    {
-        Theron::Framework framework(16);
-    }
-
-    inline static void ConstructFrameworkDefaultParams()
-    {
-        Theron::Framework::Parameters params;
-        Theron::Framework framework(params);
-    }
-
-    inline static void ConstructFrameworkParamsThreadCount()
-    {
-        Theron::Framework::Parameters params(16);
-        Theron::Framework framework(params);
-    }
-
-    inline static void ConstructFrameworkParamsThreadCountNode()
-    {
-        Theron::Framework::Parameters params(16, 0);
-        Theron::Framework framework(params);
-    }
-
-    inline static void ConstructActor()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-    }
-
-    inline static void ConstructMultipleActors()
-    {
-        Theron::Framework framework;
-        TrivialActor actor0(framework);
-        TrivialActor actor1(framework);
-    }
-
-    inline static void ConstructAddress()
-    {
-        Theron::Address address;
-        Check(address == Theron::Address::Null(), "Default-constructed address should be null");
-    }
-
-    inline static void CopyAddress()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        const Theron::Address address(actor.GetAddress());
-        const Theron::Address copied(address);
-
-        Check(address != Theron::Address::Null(), "Actor address should be null");
-        Check(copied != Theron::Address::Null(), "Copied actor address should be null");
-        Check(copied == address, "Address not copied correctly");
-    }
-
-    inline static void AssignAddress()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        const Theron::Address address(actor.GetAddress());
-        Theron::Address assigned;
-
-        Check(address != Theron::Address::Null(), "Actor address should be null");
-
-        assigned = address;
-        Check(assigned != Theron::Address::Null(), "Copied actor address should be null");
-        Check(assigned == address, "Address not copied correctly");
-    }
-
-    inline static void GetActorFramework()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        Theron::Framework &actorFramework(actor.GetFramework());
-        Check(&actorFramework == &framework, "Actor framework incorrect");
-    }
-
-    inline static void GetActorAddress()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-        const Theron::Address address(actor.GetAddress());
-        Check(address != Theron::Address::Null(), "Actor address should not be null");
-    }
-
-    inline static void RegisterHandler()
-    {
-        Theron::Framework framework;
-        Registrar<int> actor(framework);
-    }
-
-    inline static void SendHandledMessage()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Replier<int> actor(framework);
-
-        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-    }
-
-    inline static void CreateActorInFunction()
-    {
-        Theron::Framework framework;
-        TrivialActor actor(framework);
-    }
-
-    inline static void SendMessageToReceiverInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        framework.Send(0.0f, receiver.GetAddress(), receiver.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void SendMessageFromNullAddressInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        framework.Send(0, Theron::Address::Null(), receiver.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void SendMessageToActorFromNullAddressInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Signaller signaller(framework);
-
-        framework.Send(receiver.GetAddress(), Theron::Address::Null(), signaller.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void SendMessageToActorFromReceiverInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Signaller signaller(framework);
-
-        framework.Send(receiver.GetAddress(), receiver.GetAddress(), signaller.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void PushMessageToActorFromNullAddressInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Signaller signaler(framework);
-
-        signaler.Push(receiver.GetAddress(), Theron::Address::Null());
-        receiver.Wait();
-    }
-
-    inline static void PushMessageToActorFromReceiverInFunction()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Signaller signaler(framework);
-
-        signaler.Push(receiver.GetAddress(), receiver.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void ReceiveReplyInFunction()
-    {
-        typedef Replier<float> FloatReplier;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        FloatReplier actor(framework);
-
-        framework.Send(5.0f, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-    }
-
-    inline static void CatchReplyInFunction()
-    {
-        typedef Replier<float> FloatReplier;
-        typedef Catcher<float> FloatCatcher;
-
-        Theron::Framework framework;
-        FloatReplier actor(framework);
-
-        Theron::Receiver receiver;
-        FloatCatcher catcher;
-        receiver.RegisterHandler(&catcher, &FloatCatcher::Catch);
-
-        framework.Send(5.0f, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == 5.0f, "Caught message value wrong");
-        Check(catcher.mFrom == actor.GetAddress(), "Caught from address wrong");
-    }
-
-    inline static void SendNonPODMessageInFunction()
-    {
-        typedef std::vector<int> VectorMessage;
-        typedef Replier<VectorMessage> VectorReplier;
-        typedef Catcher<VectorMessage> VectorCatcher;
-
-        Theron::Framework framework;
-        VectorReplier actor(framework);
-
-        Theron::Receiver receiver;
-        VectorCatcher catcher;
-        receiver.RegisterHandler(&catcher, &VectorCatcher::Catch);
-
-        VectorMessage vectorMessage;
-        vectorMessage.push_back(0);
-        vectorMessage.push_back(1);
-        vectorMessage.push_back(2);
-        framework.Send(vectorMessage, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == vectorMessage, "Reply message is wrong");
-    }
-
-    inline static void SendPointerMessageInFunction()
-    {
-        typedef float * PointerMessage;
-        typedef Replier<PointerMessage> PointerReplier;
-        typedef Catcher<PointerMessage> PointerCatcher;
-
-        Theron::Framework framework;
-        PointerReplier actor(framework);
-
-        Theron::Receiver receiver;
-        PointerCatcher catcher;
-        receiver.RegisterHandler(&catcher, &PointerCatcher::Catch);
-
-        float a(0.0f);
-        PointerMessage pointerMessage(&a);
-        framework.Send(pointerMessage, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == &a, "Reply message is wrong");
-    }
-
-    inline static void SendConstPointerMessageInFunction()
-    {
-        typedef const float * PointerMessage;
-        typedef Replier<PointerMessage> PointerReplier;
-        typedef Catcher<PointerMessage> PointerCatcher;
-
-        Theron::Framework framework;
-        PointerReplier actor(framework);
-
-        Theron::Receiver receiver;
-        PointerCatcher catcher;
-        receiver.RegisterHandler(&catcher, &PointerCatcher::Catch);
-
-        float a(0.0f);
-        PointerMessage pointerMessage(&a);
-        framework.Send(pointerMessage, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == &a, "Reply message is wrong");
-    }
-
-    inline static void CreateDerivedActor()
-    {
-        Theron::Framework framework;
-        StringReplier actor(framework);
-    }
-
-    inline static void SendMessageToDerivedActor()
-    {
-        typedef const char * StringMessage;
-        typedef Catcher<StringMessage> StringCatcher;
-
-        Theron::Framework framework;
-        StringReplier actor(framework);
-    
-        Theron::Receiver receiver;
-        StringCatcher catcher;
-        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
-    
-        const char *testString = "hello";
-        StringMessage stringMessage(testString);
-        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == stringMessage, "Reply message is wrong");
-    }
-
-    inline static void IncrementCounter()
-    {
-        typedef Catcher<int> CountCatcher;
-
-        Theron::Framework framework;
-        Counter actor(framework);
-
-        Theron::Receiver receiver;
-        CountCatcher catcher;
-        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
-
-        framework.Send(1, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(3, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(4, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(6, receiver.GetAddress(), actor.GetAddress());
-
-        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == 21, "Count is wrong");
-    }
-
-    inline static void ActorTemplate()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::Framework framework;
-        IntReplier actor(framework);
-
-        Theron::Receiver receiver;
-        framework.Send(10, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-    }
-
-    inline static void OneHandlerAtATime()
-    {
-        typedef Catcher<int> CountCatcher;
-
-        Theron::Framework framework;
-        TwoHandlerCounter actor(framework);
-
-        Theron::Receiver receiver;
-        CountCatcher catcher;
-        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
-
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
-
-        // Get the counter value.
-        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == 9, "Count is wrong");
-    }
-
-    inline static void MultipleHandlersForMessageType()
-    {
-        typedef Catcher<int> CountCatcher;
-
-        Theron::Framework framework;
-        MultipleHandlerCounter actor(framework);
-
-        Theron::Receiver receiver;
-        CountCatcher catcher;
-        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
-
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-
-        // Get the counter value.
-        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == 9, "Count is wrong");
-    }
-
-    inline static void MessageArrivalOrder()
-    {
-        typedef Catcher<const char *> StringCatcher;
-        typedef Sequencer<int> IntSequencer;
-
-        Theron::Framework framework;
-        IntSequencer actor(framework);
-
-        Theron::Receiver receiver;
-        StringCatcher catcher;
-        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
-
-        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(1, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(3, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(4, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(6, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(7, receiver.GetAddress(), actor.GetAddress());
-
-        // Get the validity value.
-        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-        Check(catcher.mMessage == IntSequencer::GOOD, "Sequencer status is wrong");
-
-        framework.Send(9, receiver.GetAddress(), actor.GetAddress());
-
-        // Get the validity value.
-        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-        Check(catcher.mMessage == IntSequencer::BAD, "Sequencer status is wrong");
-    }
-
-    inline static void SendAddressAsMessage()
-    {
-        typedef Catcher<Theron::Address> AddressCatcher;
-
-        Theron::Framework framework;
-        Signaller actorA(framework);
-        Signaller actorB(framework);
-
-        Theron::Receiver receiver;
-        AddressCatcher catcher;
-        receiver.RegisterHandler(&catcher, &AddressCatcher::Catch);
-
-        // Send A a message telling it to signal B.
-        // A sends the receiver address to B as the signal,
-        // causing B to send A's address to the receiver in turn.
-        framework.Send(actorB.GetAddress(), receiver.GetAddress(), actorA.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == actorA.GetAddress(), "Wrong address");
-    }
-
-    inline static void SendMessageToDefaultHandlerInFunction()
-    {
-        typedef DefaultReplier<float> FloatReplier;
-        typedef Catcher<std::string> StringCatcher;
-
-        Theron::Framework framework;
-        FloatReplier actor(framework);
-
-        StringCatcher catcher;
-        Theron::Receiver receiver;
-        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
-
-        // Send an int to the replier, which expects floats but has a default handler.
-        framework.Send(52, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-
-        Check(catcher.mMessage == "hello", "Default handler not executed");
-    }
-
-    inline static void RegisterHandlerFromHandler()
-    {
-        typedef Catcher<std::string> StringCatcher;
-
-        Theron::Framework framework;
-        Switcher actor(framework);
-
-        StringCatcher catcher;
-        Theron::Receiver receiver;
-        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
-
-        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-        Check(catcher.mMessage == "hello", "Handler not executed");
-
-        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-        Check(catcher.mMessage == "goodbye", "Handler not executed");
-
-        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-        Check(catcher.mMessage == "hello", "Handler not executed");
-
-        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-        Check(catcher.mMessage == "goodbye", "Handler not executed");
-    }
-
-    inline static void CreateActorInConstructor()
-    {
-        Theron::Framework framework;
-
-        Recursor::Parameters params;
-        params.mCount = 10;
-        Recursor actor(framework, params);
-    }
-
-    inline static void SendMessageInConstructor()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        // Pass the address of the receiver to the actor constructor.
-        AutoSender::Parameters params(receiver.GetAddress());
-        AutoSender actor(framework, params);
-
-        // Wait for the messages sent by the actor on construction.
-        receiver.Wait();
-        receiver.Wait();
-    }
-
-    inline static void DeregisterHandlerInConstructor()
-    {
-        typedef Catcher<int> IntCatcher;
-
-        Theron::Framework framework;
-
-        Theron::Receiver receiver;
-        IntCatcher catcher;
-        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
-
-        AutoDeregistrar actor(framework);
-
-        // Send the actor a message and check that the first handler doesn't send us a reply.
-        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-        Check(catcher.mMessage == 2, "Received wrong message");
-        Check(receiver.Count() == 0, "Received too many messages");
-    }
-
-    inline static void CreateActorInDestructor()
-    {
-        Theron::Framework framework;
-
-        TailRecursor::Parameters params;
-        params.mCount = 10;
-        TailRecursor actor(framework, params);
-    }
-
-    inline static void SendMessageInDestructor()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        {
-            // Pass the address of the receiver ton the actor constructor.
-            TailSender::Parameters params(receiver.GetAddress());
-            TailSender actor(framework, params);
-        }
-
-        // Wait for the messages sent by the actor on destruction.
-        receiver.Wait();
-        receiver.Wait();
-    }
-
-    inline static void DeregisterHandlerInDestructor()
-    {
-        // We check that it's safe to deregister a handler in an actor destructor,
-        // but since it can't handle messages after destruction, there's little effect.
-        Theron::Framework framework;
-        TailDeregistrar actor(framework);
-    }
-
-    inline static void CreateActorInHandler()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-        Nestor actor(framework);
-
-        framework.Send(Nestor::CreateMessage(), receiver.GetAddress(), actor.GetAddress());
-        framework.Send(Nestor::DestroyMessage(), receiver.GetAddress(), actor.GetAddress());
-
-        receiver.Wait();
-    }
-
-    inline static void GetNumQueuedMessagesInHandler()
-    {
-        typedef Catcher<Theron::uint32_t> CountCatcher;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        CountCatcher catcher;
-        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
-        
-        MessageQueueCounter actor(framework);
-
-        // Send the actor two messages.
-        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
-
-        // Wait for and check both replies.
-        // Race condition decides whether the second message has already arrived.
-        // In Theron 4 the count includes the message currently being processed.
-        receiver.Wait();
-        Check(catcher.mMessage == 1 || catcher.mMessage == 2, "GetNumQueuedMessages failed");
-
-        receiver.Wait();
-        Check(catcher.mMessage == 1, "GetNumQueuedMessages failed");
-    }
-
-    inline static void GetNumQueuedMessagesInFunction()
-    {
-        typedef const char * StringMessage;
-        typedef Catcher<Theron::uint32_t> CountCatcher;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        StringReplier actor(framework);
-
-        // Send the actor two messages.
-        StringMessage stringMessage("hello");
-        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
-        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
-
-        // Race conditions decide how many messages are in the queue when we ask.
-        // In Theron 4 the count includes the message currently being processed.
-        Theron::uint32_t numMessages(actor.GetNumQueuedMessages());
-        Check(numMessages < 3, "GetNumQueuedMessages failed, expected less than 3 messages");
-
-        receiver.Wait();
-
-        // There's no guarantee that the message handler will finish before the Wait() call returns.
-        numMessages = actor.GetNumQueuedMessages();
-        Check(numMessages < 3, "GetNumQueuedMessages failed, expected less than 3 messages");
-
-        receiver.Wait();
-
-        numMessages = actor.GetNumQueuedMessages();
-        Check(numMessages < 2, "GetNumQueuedMessages failed, expected less than 2 messages");
-    }
-
-    inline static void UseBlindDefaultHandler()
-    {
-        typedef Accumulator<Theron::uint32_t> UIntAccumulator;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        UIntAccumulator accumulator;
-        receiver.RegisterHandler(&accumulator, &UIntAccumulator::Catch);
-        
-        BlindActor actor(framework);
-
-        // Send the actor a uint32_t message, which is the type it secretly expects.
-        framework.Send(Theron::uint32_t(75), receiver.GetAddress(), actor.GetAddress());
-
-        // The actor sends back the value of the message data and the size.
-        receiver.Wait();
-        receiver.Wait();
-
-        Check(accumulator.Pop() == 75, "Bad blind data");
-        Check(accumulator.Pop() == 4, "Bad blind data size");
-    }
-
-    inline static void IsHandlerRegisteredInHandler()
-    {
-        typedef Accumulator<bool> BoolAccumulator;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        BoolAccumulator accumulator;
-        receiver.RegisterHandler(&accumulator, &BoolAccumulator::Catch);
-        
-        HandlerChecker actor(framework);
-        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
-
-        Theron::uint32_t count(21);
-        while (count)
-        {
-            count -= receiver.Wait(count);
-        }
-
-        Check(accumulator.Pop() == true, "Bad registration check result 0");
-        Check(accumulator.Pop() == false, "Bad registration check result 1");
-        Check(accumulator.Pop() == false, "Bad registration check result 2");
-
-        //RegisterHandler(this, &HandlerChecker::Dummy);
-        Check(accumulator.Pop() == true, "Bad registration check result 3");
-        Check(accumulator.Pop() == true, "Bad registration check result 4");
-        Check(accumulator.Pop() == false, "Bad registration check result 5");
-
-        // DeregisterHandler(this, &HandlerChecker::Dummy);
-        Check(accumulator.Pop() == true, "Bad registration check result 6");
-        Check(accumulator.Pop() == false, "Bad registration check result 7");
-        Check(accumulator.Pop() == false, "Bad registration check result 8");
-
-        // DeregisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == false, "Bad registration check result 9");
-        Check(accumulator.Pop() == false, "Bad registration check result 10");
-        Check(accumulator.Pop() == false, "Bad registration check result 11");
-
-        // RegisterHandler(this, &HandlerChecker::Dummy);
-        // RegisterHandler(this, &HandlerChecker::Check);
-        // RegisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == true, "Bad registration check result 12");
-        Check(accumulator.Pop() == true, "Bad registration check result 13");
-        Check(accumulator.Pop() == false, "Bad registration check result 14");
-
-        // DeregisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == true, "Bad registration check result 15");
-        Check(accumulator.Pop() == true, "Bad registration check result 16");
-        Check(accumulator.Pop() == false, "Bad registration check result 17");
-
-        // DeregisterHandler(this, &HandlerChecker::Check);
-        Check(accumulator.Pop() == false, "Bad registration check result 18");
-        Check(accumulator.Pop() == true, "Bad registration check result 19");
-        Check(accumulator.Pop() == false, "Bad registration check result 20");
-    }
-
-    inline static void SetFallbackHandler()
-    {
-        Theron::Framework framework;
-        FallbackHandler fallbackHandler;
-
-        Check(framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle), "Register failed");
-    }
-
-    inline static void HandleUndeliveredMessageSentInFunction()
-    {
-        typedef Replier<float> FloatReplier;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        FallbackHandler fallbackHandler;
-        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
-
-        // Create an actor and let it die but remember its address.
-        Theron::Address staleAddress;
-
-        {
-            FloatReplier actor(framework);
-            staleAddress = actor.GetAddress();
-        }
-
-        // Send a message to the stale address.
-        framework.Send(0, receiver.GetAddress(), staleAddress);
-
-        // Wait for the undelivered message to be caught by the registered fallback handler.
-        uint32_t backoff(0);
-        while (fallbackHandler.mAddress != receiver.GetAddress())
-        {
-            Theron::Detail::Utils::Backoff(backoff);
-        }
-    }
-
-    inline static void HandleUnhandledMessageSentInFunction()
-    {
-        typedef Replier<Theron::uint32_t> UIntReplier;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        FallbackHandler fallbackHandler;
-        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
-
-        // Create a replier that handles only ints, then send it a float.
-        UIntReplier replier(framework);
-        framework.Send(5.0f, receiver.GetAddress(), replier.GetAddress());
-
-        // Wait for the unhandled message to be caught by the registered fallback handler.
-        uint32_t backoff(0);
-        while (fallbackHandler.mAddress != receiver.GetAddress())
-        {
-            Theron::Detail::Utils::Backoff(backoff);
-        }
-    }
-
-    inline static void HandleUndeliveredBlindMessageSentInFunction()
-    {
-        typedef Replier<float> FloatReplier;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        BlindFallbackHandler fallbackHandler;
-        fallbackHandler.mData = 0;
-        framework.SetFallbackHandler(&fallbackHandler, &BlindFallbackHandler::Handle);
-
-        // Create an actor and let it die but remember its address.
-        Theron::Address staleAddress;
-
-        {
-            FloatReplier actor(framework);
-            staleAddress = actor.GetAddress();
-        }
-
-        // Send a message to the stale address.
-        framework.Send(Theron::uint32_t(42), receiver.GetAddress(), staleAddress);
-
-        // Wait for the undelivered message to be caught by the registered fallback handler.
-        uint32_t backoff(0);
-        while (fallbackHandler.mData == 0)
-        {
-            Theron::Detail::Utils::Backoff(backoff);
-        }
-
-        // Check that the undelivered message was handled by the registered fallback handler.
-        Check(fallbackHandler.mValue == 42, "Blind fallback handler failed");
-        Check(fallbackHandler.mSize == sizeof(Theron::uint32_t), "Blind fallback handler failed");
-        Check(fallbackHandler.mAddress == receiver.GetAddress(), "Blind fallback handler failed");
-    }
-
-    inline static void HandleMessageSentToStaleFrameworkInFunction()
-    {
-        typedef Replier<float> FloatReplier;
-
-        Theron::Framework framework0;
-        Theron::Receiver receiver;
-
-        // Register a safe fallback handler in the first framework.
-        FallbackHandler fallbackHandler;
-        framework0.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
-
-        // Create an actor in the first framework.
-        FloatReplier replier0(framework0);
-
-        // Create an actor in a second framework, then let the framework die but remember the address.
-        Theron::Address staleAddress;
-
-        {
-            Theron::Framework framework1;
-            FloatReplier replier1(framework1);
-            staleAddress = replier1.GetAddress();
-        }
-
-        // Send a message from the first framework to the stale address in the second framework.
-        framework0.Send(0.0f, receiver.GetAddress(), staleAddress);
-
-        // Wait for the undelivered message to be caught by the registered fallback handler.
-        uint32_t backoff(0);
-        while (fallbackHandler.mAddress != receiver.GetAddress())
-        {
-            Theron::Detail::Utils::Backoff(backoff);
-        }
-    }
-
-    inline static void HandleMessageSentToStaleFrameworkInHandler()
-    {
-        typedef Replier<float> FloatReplier;
-
-        Theron::Framework framework0;
-        Theron::Receiver receiver;
-
-        // Register a safe fallback handler in the first framework.
-        FallbackHandler fallbackHandler;
-        framework0.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
-
-        // Create an actor in the first framework to send a message to an actor in the second.
-        // The signaller sends a message to the address it is sent.
-        Signaller signaller(framework0);
-
-        // Create an actor in a second framework, then let the framework die but remember the address.
-        Theron::Address staleAddress;
-
-        {
-            Theron::Framework framework1;
-            FloatReplier replier(framework1);
-            staleAddress = replier.GetAddress();
-        }
-
-        // Send a message to the signaller telling it to send a message to the stale address.
-        framework0.Send(staleAddress, receiver.GetAddress(), signaller.GetAddress());
-
-        // Wait for the undelivered message to be caught by the registered fallback handler.
-        // The undelivered message was sent by the signaller.
-        uint32_t backoff(0);
-        while (fallbackHandler.mAddress != signaller.GetAddress())
-        {
-            Theron::Detail::Utils::Backoff(backoff);
-        }
-    }
-
-    inline static void SendRegisteredMessage()
-    {
-        typedef Replier<IntVectorMessage> IntVectorReplier;
-        typedef Catcher<IntVectorMessage> IntVectorCatcher;
-
-        Theron::Framework framework;
-
-        Theron::Receiver receiver;
-        IntVectorCatcher catcher;
-        receiver.RegisterHandler(&catcher, &IntVectorCatcher::Catch);
-
-        IntVectorReplier replier(framework);
-
-        IntVectorMessage message;
-        message.push_back(0);
-        message.push_back(1);
-        message.push_back(2);
-
-        framework.Send(message, receiver.GetAddress(), replier.GetAddress());
-        receiver.Wait();
-
-        Check(catcher.mMessage.size() == 3, "Bad reply message");
-        Check(catcher.mMessage[0] == 0, "Bad reply message");
-        Check(catcher.mMessage[1] == 1, "Bad reply message");
-        Check(catcher.mMessage[2] == 2, "Bad reply message");
-    }
-
-    inline static void DeriveFromActorFirst()
-    {
-        typedef Catcher<int> IntCatcher;
-
-        Theron::Framework framework;
-
-        Theron::Receiver receiver;
-        IntCatcher catcher;
-        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
-
-        ActorFirst actor(framework);
-
-        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-
-        Check(catcher.mMessage == 5, "Bad reply message");
-    }
-
-    inline static void DeriveFromActorLast()
-    {
-        typedef Catcher<int> IntCatcher;
-
-        Theron::Framework framework;
-
-        Theron::Receiver receiver;
-        IntCatcher catcher;
-        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
-
-        ActorLast actor(framework);
-
-        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
-        receiver.Wait();
-
-        Check(catcher.mMessage == 5, "Bad reply message");
-    }
-
-    inline static void SendEmptyMessage()
-    {
-        typedef Replier<EmptyMessage> EmptyReplier;
-        typedef Catcher<EmptyMessage> EmptyCatcher;
-
-        Theron::Framework framework;
-
-        Theron::Receiver receiver;
-        EmptyCatcher catcher;
-        receiver.RegisterHandler(&catcher, &EmptyCatcher::Catch);
-
-        EmptyReplier replier(framework);
-
-        framework.Send(EmptyMessage(), receiver.GetAddress(), replier.GetAddress());
-        receiver.Wait();
-
-        Check(&catcher.mMessage != 0, "No reply message");
-    }
-
-    inline static void MultipleFrameworks()
-    {
-        typedef Catcher<int> IntCatcher;
-
-        Theron::Receiver receiver;
-        IntCatcher catcher;
-        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
-
-        Theron::Framework framework0;
-        Theron::Framework framework1;
-        Theron::Framework framework2;
-        Theron::Framework framework3;
-        Theron::Framework framework4;
-
-        Forwarder actor0(framework0, receiver.GetAddress());
-        Forwarder actor1(framework1, actor0.GetAddress());
-        Forwarder actor2(framework2, actor1.GetAddress());
-        Forwarder actor3(framework3, actor2.GetAddress());
-        Forwarder actor4(framework4, actor3.GetAddress());
-
-        framework0.Send(int(5), receiver.GetAddress(), actor4.GetAddress());
-
-        receiver.Wait();
-        Check(catcher.mMessage == 0, "Received wrong message");
-        Check(receiver.Count() == 0, "Received too many messages");
-    }
-
-    inline static void ConstructFrameworkWithParameters()
-    {
-        typedef Replier<int> IntReplier;
-
-        const Theron::Framework::Parameters params0;
-        Theron::Framework framework0(params0);
-        Theron::Framework framework1(Theron::Framework::Parameters(8));
-        Theron::Framework framework2(Theron::Framework::Parameters(12, 0));
-
-        IntReplier replier0(framework0);
-        IntReplier replier1(framework1);
-        IntReplier replier2(framework2);
-
-        Theron::Receiver receiver;
-        framework0.Send(int(2), receiver.GetAddress(), replier0.GetAddress());
-        framework1.Send(int(2), receiver.GetAddress(), replier1.GetAddress());
-        framework2.Send(int(2), receiver.GetAddress(), replier2.GetAddress());
-
-        receiver.Wait();
-        receiver.Wait();
-        receiver.Wait();
-    }
-
-    inline static void UseActorRefs()
-    {
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        Theron::ActorRef copyOne;
-        Theron::ActorRef copyTwo;
-
-        {
-            // Test parameterized and parameterless construction.
-            Version3Replier::Parameters params;
-            const Theron::ActorRef actorOne(framework.CreateActor<Version3Replier>());
-            Theron::ActorRef actorTwo(framework.CreateActor<Version3Replier>(params));
-
-            // Test transferral of ownership to copy-constructed ActorRefs.
-            const Theron::ActorRef tempOne(actorOne);
-            Theron::ActorRef tempTwo(actorTwo);
-
-            // Test transferral of ownership to assigned ActorRefs.
-            copyOne = tempOne;
-            copyTwo = tempTwo;
-        }
-
-        // Check ActorRef::operator== and ActorRef::operator!=
-        Check(copyOne == copyOne, "ActorRef::operator== failed");
-        Check(copyTwo == copyTwo, "ActorRef::operator== failed");
-        Check(copyOne != copyTwo, "ActorRef::operator!= failed");
-
-        // Test ActorRef::Null().
-        Check(copyOne != Theron::ActorRef::Null(), "ActorRef is null");
-        Check(copyTwo != Theron::ActorRef::Null(), "ActorRef is null");
-
-        framework.Send(int(35), receiver.GetAddress(), copyOne.GetAddress());
-        framework.Send(int(36), receiver.GetAddress(), copyTwo.GetAddress());
-
-        receiver.Wait();
-        receiver.Wait();
-    }
-
-    inline static void ThreadCountApi()
-    {
-        Theron::Framework framework;
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        // Create more worker threads.
-        framework.SetMinThreads(32);
-        Check(framework.GetMinThreads() >= 32, "GetMinThreads failed");
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        // Stop most of the threads.
-        framework.SetMaxThreads(8);
-        Check(framework.GetMaxThreads() <= 8, "GetMaxThreads failed");
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        // Re-start all of the threads and create some more.
-        framework.SetMinThreads(64);
-        Check(framework.GetMinThreads() >= 64, "GetMinThreads failed");
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        // Stop all threads but one.
-        framework.SetMaxThreads(1);
-        Check(framework.GetMaxThreads() <= 1, "GetMaxThreads failed");
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        Check(framework.GetPeakThreads() >= 1, "GetPeakThreads failed");
-        Check(framework.GetNumThreads() >= 1, "GetNumThreads failed");
-        Check(framework.GetPeakThreads() >= framework.GetNumThreads(), "GetPeakThreads failed");
-    }
-
-    inline static void EventCounterApi()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::Framework framework;
-        Theron::Receiver receiver;
-
-        Theron::Detail::Utils::SleepThread(10);
-
-        // Check initial values.
-        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) == 0, "GetCounterValue failed");
-
-        uint32_t counterValues[32];
-        uint32_t valueCount(framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32));
-
-        uint32_t messagesProcessed(0);
-        for (uint32_t index = 0; index < valueCount; ++index)
-        {
-            messagesProcessed += counterValues[index];
-        }
-
-        Check(messagesProcessed == 0, "GetPerThreadCounterValues failed");
-
-        IntReplier replier(framework);
-        framework.Send(int(0), receiver.GetAddress(), replier.GetAddress());
-        receiver.Wait();
-
-        // Check values after some work.
-        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) > 0, "GetCounterValue failed");
-
-        valueCount = framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32);
-
-        messagesProcessed = 0;
-        for (uint32_t index = 0; index < valueCount; ++index)
-        {
-            messagesProcessed += counterValues[index];
-        }
-
-        Check(messagesProcessed == 1, "GetPerThreadCounterValues failed");
-
-        // Check values after reset.
-        framework.ResetCounters();
-
-        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) == 0, "GetCounterValue failed");
-
-        valueCount = framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32);
-
-        messagesProcessed = 0;
-        for (uint32_t index = 0; index < valueCount; ++index)
-        {
-            messagesProcessed += counterValues[index];
-        }
-
-        Check(messagesProcessed == 0, "GetPerThreadCounterValues failed");
-    }
-
-    inline static void ConstructEndPoint()
-    {
-        // Should be able to use endpoints even if networking is disabled.
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-    }
-
-    inline static void TieFrameworkToEndPoint()
-    {
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework framework(endPoint);
-    }
-
-    inline static void TieActorsToEndPoint()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework framework(endPoint);
-
-        // Create two actors and let them register and deregister themselves with the endPoint.
-        {
-            IntReplier replierOne(framework);
-            IntReplier replierTwo(framework);
-        }
-
-        // And again.
-        {
-            IntReplier replierOne(framework);
-            IntReplier replierTwo(framework);
-        }
-    }
-
-    inline static void TieReceiverstoEndPoint()
-    {
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-
-        // Create two receivers and let them register and deregister themselves with the endPoint.
-        {
-            Theron::Receiver receiverOne(endPoint);
-            Theron::Receiver receiverTwo(endPoint);
-        }
-
-        // And again.
-        {
-            Theron::Receiver receiverOne(endPoint);
-            Theron::Receiver receiverTwo(endPoint);
-        }
-    }
-
-    inline static void NameFrameworkOnConstruction()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-
-        Theron::Framework::Parameters frameworkParams;
-        Theron::Framework framework(endPoint, "framework", frameworkParams);
-
-        // Register an actor and a receiver to test the name can be used.
-        IntReplier replier(framework);
-        Theron::Receiver receiver(endPoint);
-
-        framework.Send(int(0), receiver.GetAddress(), replier.GetAddress());
-        receiver.Wait();
-    }
-
-    inline static void NameActorOnConstruction()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework framework(endPoint);
-
-        // Register a named actor and a receiver to test the name can be used.
-        IntReplier replier(framework, "replier");
-        Theron::Receiver receiver(endPoint);
-
-        framework.Send(int(0), receiver.GetAddress(), Theron::Address("replier"));
-        receiver.Wait();
-    }
-
-    inline static void NameReceiverOnConstruction()
-    {
-        typedef Replier<int> IntReplier;
-
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework framework(endPoint);
-
-        // Register a named actor and a named receiver.
-        IntReplier replier(framework, "replier");
-        Theron::Receiver receiver(endPoint, "receiver");
-
-        framework.Send(int(0), Theron::Address("receiver"), Theron::Address("replier"));
-        receiver.Wait();
-    }
-
-    inline static void SendMessageToLocalActorByName()
-    {
-        typedef Replier<std::string> StringReplier;
-
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework framework(endPoint);
-
-        StringReplier replier(framework, "replier");
-        Theron::Receiver receiver(endPoint, "receiver");
-
-        // This tests we can send any copyable message to actors on the same endpoint
-        // by name, even if the message type hasn't been registered.
-        const std::string message("hello world");
-
-        // Send the replier a message by name, and pass the receiver address by name.
-        framework.Send(message, Theron::Address("receiver"), Theron::Address("replier"));
-
-        // Wait for the reply.
-        receiver.Wait();
-    }
-
-    inline static void SendMessagesBetweenLocalFrameworksByName()
-    {
-        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
-        Theron::Framework frameworkOne(endPoint);
-        Theron::Framework frameworkTwo(endPoint);
-
-        Signaller signallerOne(frameworkOne, "signaller_one");
-        Signaller signallerTwo(frameworkTwo, "signaller_two");
-        Theron::Receiver receiver(endPoint, "receiver");
-
-        // Send one a message telling it to signal two.
-        // One sends the receiver address to two as the signal,
-        // causing two to send one's address to the receiver.
-        Check(frameworkTwo.Send(
-            Theron::Address("signaller_two"),
-            Theron::Address("receiver"),
-            Theron::Address("signaller_one")), "Failed to send message");
-
-        receiver.Wait();
-    }
-
-private:
-
-    class TrivialActor : public Theron::Actor
-    {
-    public:
-
-        TrivialActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-        }
-    };
-
-    template <class MessageType>
-    class Registrar : public Theron::Actor
-    {
-    public:
-
-        Registrar(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Registrar::Handler);
-            IsHandlerRegistered(this, &Registrar::Handler);
-            DeregisterHandler(this, &Registrar::Handler);
-            IsHandlerRegistered(this, &Registrar::Handler);
-        }
-
-    private:
-
-        inline void Handler(const MessageType &/*message*/, const Theron::Address /*from*/)
-        {
-        }
-    };
-
-    template <class MessageType>
-    class Replier : public Theron::Actor
-    {
-    public:
-
-        inline explicit Replier(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
-        {
-            RegisterHandler(this, &Replier::Handler);
-        }
-
-    private:
-
-        inline void Handler(const MessageType &message, const Theron::Address from)
-        {
-            Send(message, from);
-        }
-    };
-
-    template <class MessageType>
-    class DefaultReplier : public Theron::Actor
-    {
-    public:
-
-        inline DefaultReplier(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &DefaultReplier::Handler);
-            SetDefaultHandler(this, &DefaultReplier::DefaultHandler);
-        }
-
-    private:
-
-        inline void Handler(const MessageType &message, const Theron::Address from)
-        {
-            Send(message, from);
-        }
-
-        inline void DefaultHandler(const Theron::Address from)
-        {
-            std::string hello("hello");
-            Send(hello, from);
-        }
-    };
-
-    class StringReplier : public Replier<const char *>
-    {
-    public:
-
-        typedef Replier<const char *> Base;
-
-        inline StringReplier(Theron::Framework &framework) : Base(framework)
-        {
-        }
-    };
-
-    class Signaller : public Theron::Actor
-    {
-    public:
-
-        inline Signaller(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
-        {
-            RegisterHandler(this, &Signaller::Signal);
-        }
-
-    private:
-
-        inline void Signal(const Theron::Address &address, const Theron::Address from)
-        {
-            // Send the 'from' address to the address received in the message.
-            Send(from, address);
-        }
-    };
-
-    class Switcher : public Theron::Actor
-    {
-    public:
-
-        inline Switcher(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Switcher::SayHello);
-        }
-
-    private:
-
-        inline void SayHello(const std::string &/*message*/, const Theron::Address from)
-        {
-            DeregisterHandler(this, &Switcher::SayHello);
-            RegisterHandler(this, &Switcher::SayGoodbye);
-            Send(std::string("hello"), from);
-        }
-
-        inline void SayGoodbye(const std::string &/*message*/, const Theron::Address from)
-        {
-            DeregisterHandler(this, &Switcher::SayGoodbye);
-            RegisterHandler(this, &Switcher::SayHello);
-            Send(std::string("goodbye"), from);
-        }
-    };
-
-    template <class MessageType>
-    class Catcher
-    {
-    public:
-
-        inline Catcher() : mMessage(), mFrom(Theron::Address::Null())
-        {
-        }
-
-        inline void Catch(const MessageType &message, const Theron::Address from)
-        {
-            mMessage = message;
-            mFrom = from;
-        }
-
-        MessageType mMessage;
-        Theron::Address mFrom;
-    };
-
-    class Counter : public Theron::Actor
-    {
-    public:
-
-        inline Counter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
-        {
-            RegisterHandler(this, &Counter::Increment);
-            RegisterHandler(this, &Counter::GetValue);
-        }
-
-    private:
-
-        inline void Increment(const int &message, const Theron::Address /*from*/)
-        {
-            mCount += message;
-        }
-
-        inline void GetValue(const bool &/*message*/, const Theron::Address from)
-        {
-            Send(mCount, from);
-        }
-
-        int mCount;
-    };
-
-    class TwoHandlerCounter : public Theron::Actor
-    {
-    public:
-
-        inline TwoHandlerCounter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
-        {
-            RegisterHandler(this, &TwoHandlerCounter::IncrementOne);
-            RegisterHandler(this, &TwoHandlerCounter::IncrementTwo);
-            RegisterHandler(this, &TwoHandlerCounter::GetValue);
-        }
-
-    private:
-
-        inline void IncrementOne(const int &message, const Theron::Address /*from*/)
-        {
-            mCount += message;
-        }
-
-        inline void IncrementTwo(const float &/*message*/, const Theron::Address /*from*/)
-        {
-            ++mCount;
-        }
-
-        inline void GetValue(const bool &/*message*/, const Theron::Address from)
-        {
-            Send(mCount, from);
-        }
-
-        int mCount;
-    };
-
-    class MultipleHandlerCounter : public Theron::Actor
-    {
-    public:
-
-        inline MultipleHandlerCounter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
-        {
-            RegisterHandler(this, &MultipleHandlerCounter::IncrementOne);
-            RegisterHandler(this, &MultipleHandlerCounter::IncrementTwo);
-            RegisterHandler(this, &MultipleHandlerCounter::GetValue);
-        }
-
-    private:
-
-        inline void IncrementOne(const int &message, const Theron::Address /*from*/)
-        {
-            mCount += message;
-        }
-
-        inline void IncrementTwo(const int &/*message*/, const Theron::Address /*from*/)
-        {
-            ++mCount;
-        }
-
-        inline void GetValue(const bool &/*message*/, const Theron::Address from)
-        {
-            Send(mCount, from);
-        }
-
-        int mCount;
-    };
-
-    template <class CountType>
-    class Sequencer : public Theron::Actor
-    {
-    public:
-
-        static const char *GOOD;
-        static const char *BAD;
-
-        inline Sequencer(Theron::Framework &framework) : Theron::Actor(framework), mNextValue(0), mStatus(GOOD)
-        {
-            RegisterHandler(this, &Sequencer::Receive);
-            RegisterHandler(this, &Sequencer::GetValue);
-        }
-
-    private:
-
-        inline void Receive(const CountType &message, const Theron::Address /*from*/)
-        {
-            if (message != mNextValue++)
-            {
-                mStatus = BAD;
-            }
-        }
-
-        inline void GetValue(const bool &/*message*/, const Theron::Address from)
-        {
-            Send(mStatus, from);
-        }
-
-        CountType mNextValue;
-        const char *mStatus;
-    };
-
-    class Recursor : public Theron::Actor
-    {
-    public:
-
-        struct Parameters
-        {
-            int mCount;
-        };
-
-        inline Recursor(Theron::Framework &framework, const Parameters &params) : Theron::Actor(framework)
-        {
-            // Recursively create a child actor within the constructor.
-            if (params.mCount > 0)
-            {
-                Parameters childParams;
-                childParams.mCount = params.mCount - 1;
-
-                Theron::Framework &framework(GetFramework());
-                Recursor child(framework, childParams);
-            }
-        }
-    };
-
-    class TailRecursor : public Theron::Actor
-    {
-    public:
-
-        struct Parameters
-        {
-            int mCount;
-        };
-
-        inline TailRecursor(Theron::Framework &framework, const Parameters &params) : Theron::Actor(framework), mCount(params.mCount)
-        {
-        }
-
-        inline ~TailRecursor()
-        {
-            // Recursively create a child actor within the destructor.
-            if (mCount > 0)
-            {
-                Parameters childParams;
-                childParams.mCount = mCount - 1;
-
-                Theron::Framework &framework(GetFramework());
-                TailRecursor child(framework, childParams);
-            }
-        }
-
-    private:
-
-        int mCount;
-    };
-
-    class AutoSender : public Theron::Actor
-    {
-    public:
-
-        typedef Theron::Address Parameters;
-
-        inline AutoSender(Theron::Framework &framework, const Parameters &address) : Theron::Actor(framework)
-        {
-            // Send a message in the actor constructor.
-            Send(0, address);
-
-            // Send using TailSend to check that works too.
-            TailSend(1, address);
-        }
-    };
-
-    class TailSender : public Theron::Actor
-    {
-    public:
-
-        typedef Theron::Address Parameters;
-
-        inline TailSender(Theron::Framework &framework, const Parameters &address) : Theron::Actor(framework), mStoredAddress(address)
-        {
-        }
-
-        inline ~TailSender()
-        {
-            // Send a message in the actor destructor.
-            Send(0, mStoredAddress);
-
-            // Send using TailSend to check that works too.
-            TailSend(1, mStoredAddress);
-        }
-
-        Theron::Address mStoredAddress;
-    };
-
-    class AutoDeregistrar : public Theron::Actor
-    {
-    public:
-
-        inline AutoDeregistrar(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &AutoDeregistrar::HandlerOne);
-            RegisterHandler(this, &AutoDeregistrar::HandlerTwo);
-            DeregisterHandler(this, &AutoDeregistrar::HandlerOne);
-        }
-
-        inline void HandlerOne(const int &/*message*/, const Theron::Address from)
-        {
-            Send(1, from);
-        }
-
-        inline void HandlerTwo(const int &/*message*/, const Theron::Address from)
-        {
-            Send(2, from);
-        }
-    };
-
-    class TailDeregistrar : public Theron::Actor
-    {
-    public:
-
-        inline TailDeregistrar(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &TailDeregistrar::Handler);
-        }
-
-        inline ~TailDeregistrar()
-        {
-            DeregisterHandler(this, &TailDeregistrar::Handler);
-        }
-
-        inline void Handler(const int &/*message*/, const Theron::Address from)
-        {
-            Send(0, from);
-        }
-    };
-
-    class MessageQueueCounter : public Theron::Actor
-    {
-    public:
-
-        inline explicit MessageQueueCounter(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &MessageQueueCounter::Handler);
-        }
-
-        inline void Handler(const int &/*message*/, const Theron::Address from)
-        {
-            Send(GetNumQueuedMessages(), from);
-        }
-    };
-
-    class BlindActor : public Theron::Actor
-    {
-    public:
-
-        inline BlindActor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            SetDefaultHandler(this, &BlindActor::BlindDefaultHandler);
-        }
-
-    private:
-
-        inline void BlindDefaultHandler(const void *const data, const Theron::uint32_t size, const Theron::Address from)
-        {
-            // We know the message is a uint32_t.
-            const Theron::uint32_t *const p(reinterpret_cast<const Theron::uint32_t *>(data));
-            const Theron::uint32_t value(*p);
-
-            Send(value, from);
-            Send(size, from);
-        }
-    };
-
-    template <class MessageType>
-    class Accumulator
-    {
-    public:
-
-        inline Accumulator() : mMessages()
-        {
-        }
-
-        inline void Catch(const MessageType &message, const Theron::Address /*from*/)
-        {
-            mMessages.push(message);
-        }
-
-        int Size()
-        {
-            return mMessages.size();
-        }
-
-        MessageType Pop()
-        {
-            THERON_ASSERT(mMessages.empty() == false);
-            MessageType message(mMessages.front());
-            mMessages.pop();
-            return message;
-        }
-
-    private:
-
-        std::queue<MessageType> mMessages;
-    };
-
-    class HandlerChecker : public Theron::Actor
-    {
-    public:
-
-        inline HandlerChecker(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &HandlerChecker::Check);
-        }
-
-    private:
-
-        inline void Check(const int & /*message*/, const Theron::Address from)
-        {
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-
-            RegisterHandler(this, &HandlerChecker::Dummy);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-
-            DeregisterHandler(this, &HandlerChecker::Dummy);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-
-            DeregisterHandler(this, &HandlerChecker::Check);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-
-            RegisterHandler(this, &HandlerChecker::Dummy);
-            RegisterHandler(this, &HandlerChecker::Check);
-            RegisterHandler(this, &HandlerChecker::Check);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-        
-            DeregisterHandler(this, &HandlerChecker::Check);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-
-            DeregisterHandler(this, &HandlerChecker::Check);
-
-            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
-            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
-        }
-
-        inline void Dummy(const int & message, const Theron::Address from)
-        {
-            // We do this just so that Dummy and Unregistered differ, so the compiler won't merge them!
-            Send(message, from);
-        }
-
-        inline void Unregistered(const int & /*message*/, const Theron::Address /*from*/)
-        {
-        }
-    };
-
-    class Nestor : public Theron::Actor
-    {
-    public:
-
-        struct CreateMessage { };
-        struct DestroyMessage { };
-
-        inline Nestor(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &Nestor::Create);
-            RegisterHandler(this, &Nestor::Destroy);
-            RegisterHandler(this, &Nestor::Receive);
-        }
-
-    private:
-
-        typedef Replier<int> ChildActor;
-
-        inline void Create(const CreateMessage & /*message*/, const Theron::Address /*from*/)
-        {
-            mChildren.push_back(new ChildActor(GetFramework()));
-            mChildren.push_back(new ChildActor(GetFramework()));
-            mChildren.push_back(new ChildActor(GetFramework()));
-
-            mReplies.push_back(false);
-            mReplies.push_back(false);
-            mReplies.push_back(false);
-
-            Send(0, mChildren[0]->GetAddress());
-            Send(1, mChildren[1]->GetAddress());
-            Send(2, mChildren[2]->GetAddress());
-        }
-
-        inline void Destroy(const DestroyMessage & /*message*/, const Theron::Address from)
-        {
-            mCaller = from;
-            if (mReplies[0] && mReplies[1] && mReplies[2])
-            {
-                delete mChildren[0];
-                delete mChildren[1];
-                delete mChildren[2];
-
-                mChildren.clear();
-                Send(true, mCaller);
-            }
-        }
-
-        inline void Receive(const int & message, const Theron::Address /*from*/)
-        {
-            mReplies[message] = true;
-
-            if (mCaller != Theron::Address::Null() && mReplies[0] && mReplies[1] && mReplies[2])
-            {
-                delete mChildren[0];
-                delete mChildren[1];
-                delete mChildren[2];
-
-                mChildren.clear();
-                Send(true, mCaller);
-            }
-        }
-
-        std::vector<Theron::Actor *> mChildren;
-        std::vector<bool> mReplies;
-        Theron::Address mCaller;
-    };
-
-    class FallbackHandler
-    {
-    public:
-
-        inline void Handle(const Theron::Address from)
-        {
-            mAddress = from;
-        }
-
-        Theron::Address mAddress;
-    };
-
-    class BlindFallbackHandler
-    {
-    public:
-
-        BlindFallbackHandler() : mData(0), mValue(0), mSize(0)
-        {
-        }
-
-        inline void Handle(const void *const data, const Theron::uint32_t size, const Theron::Address from)
-        {
-            mData = data;
-            mValue = *reinterpret_cast<const Theron::uint32_t *>(data);
-            mSize = size;
-            mAddress = from;
-        }
-
-        const void *mData;
-        Theron::uint32_t mValue;
-        Theron::uint32_t mSize;
-        Theron::Address mAddress;
-    };
-
-    typedef std::vector<Theron::uint32_t> IntVectorMessage;
-
-    class SomeOtherBaseclass
-    {
-    public:
-
-        inline SomeOtherBaseclass()
-        {
-        }
-
-        // The virtual destructor is required because this is a baseclass with virtual functions.
-        inline virtual ~SomeOtherBaseclass()
-        {
-        }
-
-        inline virtual void DoNothing()
-        {
-        }
-    };
-
-    class ActorFirst : public Theron::Actor, public SomeOtherBaseclass
-    {
-    public:
-
-        inline ActorFirst(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &ActorFirst::Handler);
-        }
-
-        // The virtual destructor is required because we derived from baseclasses with virtual functions.
-        inline virtual ~ActorFirst()
-        {
-        }
-
-    private:
-
-        inline virtual void DoNothing()
-        {
-        }
-
-        inline void Handler(const int &message, const Theron::Address from)
-        {
-            Send(message, from);
-        }
-    };
-
-    class ActorLast : public SomeOtherBaseclass, public Theron::Actor
-    {
-    public:
-
-        inline ActorLast(Theron::Framework &framework) : Theron::Actor(framework)
-        {
-            RegisterHandler(this, &ActorLast::Handler);
-        }
-
-        // The virtual destructor is required because we derived from baseclasses with virtual functions.
-        inline virtual ~ActorLast()
-        {
-        }
-
-    private:
-
-        inline virtual void DoNothing()
-        {
-        }
-        
-        inline void Handler(const int &message, const Theron::Address from)
-        {
-            Send(message, from);
-        }
-    };
-
-    struct EmptyMessage
-    {
-    };
-
-    class Forwarder : public Theron::Actor
-    {
-    public:
-
-        inline Forwarder(Theron::Framework &framework, const Theron::Address next) : Theron::Actor(framework), mNext(next)
-        {
-            RegisterHandler(this, &Forwarder::Forward);
-        }
-
-    private:
-
-        inline void Forward(const int &message, const Theron::Address /*from*/)
-        {
-            Send(message - 1, mNext);
-        }
-
-        const Theron::Address mNext;
-    };
-
-    // Derive from a different baseclass first to check we cope with the non-zero offset.
-    class Version3Replier : public SomeOtherBaseclass, public Theron::Actor
-    {
-    public:
-
-        struct Parameters
-        {
-        };
-
-        Version3Replier()
-        {
-            RegisterHandler(this, &Version3Replier::Handler);
-
-            // Allocate memory in the constructor to check the destructor is called.
-            mMemory = Theron::AllocatorManager::Instance().GetAllocator()->Allocate(64);
-
-            // Check the alignment of the final actor type.
-            THERON_ASSERT(THERON_ALIGNED(this, 128));
-        }
-
-        Version3Replier(const Parameters &/*params*/)
-        {
-            RegisterHandler(this, &Version3Replier::Handler);
-
-            // Allocate memory in the constructor to check the destructor is called.
-            mMemory = Theron::AllocatorManager::Instance().GetAllocator()->Allocate(64);
-
-            // Check the alignment of the final actor type.
-            THERON_ASSERT(THERON_ALIGNED(this, 128));
-        }
-
-        ~Version3Replier()
-        {
-            DeregisterHandler(this, &Version3Replier::Handler);
-
-            // Free the memory in the destructor to check the destructor is called.
-            // The DefaultAllocator memory allocation checking will fail if we leak.
-            Theron::AllocatorManager::Instance().GetAllocator()->Free(mMemory);
-        }
-
-    private:
-
-        // Implementation of virtual method in SomeOtherBaseclass.
-        inline virtual void DoNothing()
-        {
-        }
-
-        void Handler(const int &message, const Theron::Address from)
-        {
-            Send(message, from);
-        }
-
-        void *mMemory;
-    };
-};
-
-
-template <class CountType>
-const char *FeatureTestSuite::Sequencer<CountType>::GOOD = "good";
-
-template <class CountType>
-const char *FeatureTestSuite::Sequencer<CountType>::BAD = "good";
-
-
-} // namespace Tests
-
-
-THERON_REGISTER_MESSAGE(Tests::FeatureTestSuite::IntVectorMessage);
-
-THERON_ALIGN_ACTOR(Tests::FeatureTestSuite::Version3Replier, 128);
-
-
-#endif // THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
+#define THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
+
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <queue>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+#include "TestFramework/TestSuite.h"
+
+
+namespace Tests
+{
+
+
+// A registered message type with a dedicated block pool, used by the
+// PooledMessages test. The definition macros live in Tests.cpp since this
+// header is included only once.
+struct PooledMessage
+{
+    int mValue;
+};
+
+
+// A registered message type declared urgent, used by the UrgentMessages
+// test. Urgent messages jump queued bulk work in the destination mailbox.
+struct CancelMessage
+{
+    int mValue;
+};
+
+
+// A registered message type declared conflatable, used by the
+// ConflatableMessages test. A new update replaces an older queued one from
+// the same sender in place instead of queuing behind it.
+struct SnapshotMessage
+{
+    int mValue;
+};
+
+
+} // namespace Tests
+
+
+THERON_DECLARE_REGISTERED_MESSAGE(Tests::PooledMessage);
+THERON_DECLARE_POOLED_MESSAGE(Tests::PooledMessage);
+
+THERON_DECLARE_REGISTERED_MESSAGE(Tests::CancelMessage);
+THERON_DECLARE_URGENT_MESSAGE(Tests::CancelMessage);
+
+THERON_DECLARE_REGISTERED_MESSAGE(Tests::SnapshotMessage);
+THERON_DECLARE_CONFLATABLE_MESSAGE(Tests::SnapshotMessage);
+
+
+namespace Tests
+{
+
+
+class FeatureTestSuite : public TestFramework::TestSuite
+{
+public:
+
+    inline FeatureTestSuite()
+    {
+        TESTFRAMEWORK_REGISTER_TESTSUITE(FeatureTestSuite);
+
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFramework);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkThreadCount);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkDefaultParams);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsThreadCount);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkParamsThreadCountNode);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructActor);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructMultipleActors);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructAddress);
+        TESTFRAMEWORK_REGISTER_TEST(CopyAddress);
+        TESTFRAMEWORK_REGISTER_TEST(AssignAddress);
+        TESTFRAMEWORK_REGISTER_TEST(GetActorFramework);
+        TESTFRAMEWORK_REGISTER_TEST(GetActorAddress);
+        TESTFRAMEWORK_REGISTER_TEST(RegisterHandler);
+        TESTFRAMEWORK_REGISTER_TEST(SendHandledMessage);
+        TESTFRAMEWORK_REGISTER_TEST(CreateActorInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToReceiverInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageFromNullAddressInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToActorFromNullAddressInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToActorFromReceiverInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromNullAddressInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromReceiverInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(ReceiveReplyInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(CatchReplyInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendNonPODMessageInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendPointerMessageInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(SendConstPointerMessageInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(CreateDerivedActor);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToDerivedActor);
+        TESTFRAMEWORK_REGISTER_TEST(IncrementCounter);
+        TESTFRAMEWORK_REGISTER_TEST(ActorTemplate);
+        TESTFRAMEWORK_REGISTER_TEST(OneHandlerAtATime);
+        TESTFRAMEWORK_REGISTER_TEST(MultipleHandlersForMessageType);
+        TESTFRAMEWORK_REGISTER_TEST(MessageArrivalOrder);
+        TESTFRAMEWORK_REGISTER_TEST(SendAddressAsMessage);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToDefaultHandlerInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(RegisterHandlerFromHandler);
+        TESTFRAMEWORK_REGISTER_TEST(CreateActorInConstructor);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageInConstructor);
+        TESTFRAMEWORK_REGISTER_TEST(DeregisterHandlerInConstructor);
+        TESTFRAMEWORK_REGISTER_TEST(CreateActorInDestructor);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageInDestructor);
+        TESTFRAMEWORK_REGISTER_TEST(DeregisterHandlerInDestructor);
+        TESTFRAMEWORK_REGISTER_TEST(CreateActorInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(GetNumQueuedMessagesInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(GetNumQueuedMessagesInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(UseBlindDefaultHandler);
+        TESTFRAMEWORK_REGISTER_TEST(IsHandlerRegisteredInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(MailboxHandleSend);
+        TESTFRAMEWORK_REGISTER_TEST(SetFallbackHandler);
+        TESTFRAMEWORK_REGISTER_TEST(HandleUndeliveredMessageSentInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(HandleUnhandledMessageSentInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(HandleUndeliveredBlindMessageSentInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(RetainMessageViewBeyondFallbackHandler);
+        TESTFRAMEWORK_REGISTER_TEST(HandleMessageSentToStaleFrameworkInFunction);
+        TESTFRAMEWORK_REGISTER_TEST(HandleMessageSentToStaleFrameworkInHandler);
+        TESTFRAMEWORK_REGISTER_TEST(SendRegisteredMessage);
+        TESTFRAMEWORK_REGISTER_TEST(DeriveFromActorFirst);
+        TESTFRAMEWORK_REGISTER_TEST(DeriveFromActorLast);
+        TESTFRAMEWORK_REGISTER_TEST(SendEmptyMessage);
+        TESTFRAMEWORK_REGISTER_TEST(MultipleFrameworks);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructFrameworkWithParameters);
+        TESTFRAMEWORK_REGISTER_TEST(UseActorRefs);
+        TESTFRAMEWORK_REGISTER_TEST(ThreadCountApi);
+        TESTFRAMEWORK_REGISTER_TEST(BlockingSectionReplacesWorker);
+        TESTFRAMEWORK_REGISTER_TEST(SetMessageBatchSize);
+        TESTFRAMEWORK_REGISTER_TEST(BlockingYieldStrategy);
+        TESTFRAMEWORK_REGISTER_TEST(HighPriorityActors);
+        TESTFRAMEWORK_REGISTER_TEST(PriorityInheritanceAcrossActors);
+        TESTFRAMEWORK_REGISTER_TEST(PreallocateMessageBlocks);
+        TESTFRAMEWORK_REGISTER_TEST(ActorProfileApi);
+        TESTFRAMEWORK_REGISTER_TEST(BoundedMailbox);
+        TESTFRAMEWORK_REGISTER_TEST(TailSendPipeline);
+        TESTFRAMEWORK_REGISTER_TEST(DelayedAndPeriodicSends);
+        TESTFRAMEWORK_REGISTER_TEST(QueueLengthSampling);
+        TESTFRAMEWORK_REGISTER_TEST(SendToLeastLoadedRouting);
+        TESTFRAMEWORK_REGISTER_TEST(ScratchAllocations);
+        TESTFRAMEWORK_REGISTER_TEST(ParallelForCompute);
+        TESTFRAMEWORK_REGISTER_TEST(ChannelizedSends);
+        TESTFRAMEWORK_REGISTER_TEST(LargeBlittableMessages);
+        TESTFRAMEWORK_REGISTER_TEST(MemoryAccountingReport);
+        TESTFRAMEWORK_REGISTER_TEST(MemoryBudgetEnforcement);
+        TESTFRAMEWORK_REGISTER_TEST(FairnessUnderFlood);
+        TESTFRAMEWORK_REGISTER_TEST(TimedBatchedWait);
+        TESTFRAMEWORK_REGISTER_TEST(RingCatcherMessages);
+        TESTFRAMEWORK_REGISTER_TEST(ThreadPoolAutoScaling);
+        TESTFRAMEWORK_REGISTER_TEST(BulkActorCreation);
+        TESTFRAMEWORK_REGISTER_TEST(ScatterGatherBatch);
+        TESTFRAMEWORK_REGISTER_TEST(PhaseBarrierSupersteps);
+        TESTFRAMEWORK_REGISTER_TEST(InternedStrings);
+        TESTFRAMEWORK_REGISTER_TEST(ActorMigration);
+        TESTFRAMEWORK_REGISTER_TEST(RespawnSlotSwap);
+        TESTFRAMEWORK_REGISTER_TEST(MessageBuilderSend);
+        TESTFRAMEWORK_REGISTER_TEST(HighRateMailboxPool);
+        TESTFRAMEWORK_REGISTER_TEST(FrameworkOwnedActorConstruction);
+        TESTFRAMEWORK_REGISTER_TEST(ContinuationReply);
+        TESTFRAMEWORK_REGISTER_TEST(PooledMessages);
+        TESTFRAMEWORK_REGISTER_TEST(CachedNameLookups);
+        TESTFRAMEWORK_REGISTER_TEST(MetricsSampling);
+        TESTFRAMEWORK_REGISTER_TEST(BroadcastSharedPayload);
+        TESTFRAMEWORK_REGISTER_TEST(WorkerProcessorPinning);
+        TESTFRAMEWORK_REGISTER_TEST(QueueWatermarkEvents);
+        TESTFRAMEWORK_REGISTER_TEST(PooledReceivers);
+        TESTFRAMEWORK_REGISTER_TEST(PoolWarmState);
+        TESTFRAMEWORK_REGISTER_TEST(CacheTrimming);
+        TESTFRAMEWORK_REGISTER_TEST(MessageTypeStatsQuery);
+        TESTFRAMEWORK_REGISTER_TEST(AllocatorCacheStatsQuery);
+        TESTFRAMEWORK_REGISTER_TEST(YieldStrategyHotSwap);
+        TESTFRAMEWORK_REGISTER_TEST(DeadlineSendAndMissCounting);
+        TESTFRAMEWORK_REGISTER_TEST(CrossFrameworkSendsAfterFrameworkRecreation);
+        TESTFRAMEWORK_REGISTER_TEST(FileStreamerZeroCopyChunks);
+        TESTFRAMEWORK_REGISTER_TEST(StaticHandlerTableSharedByInstances);
+        TESTFRAMEWORK_REGISTER_TEST(HandlerBudgetPreemption);
+        TESTFRAMEWORK_REGISTER_TEST(CrossNodeStealCounter);
+        TESTFRAMEWORK_REGISTER_TEST(SchedulerPolicySelection);
+
+#if THERON_ACTOR_STORE_SIZE
+        TESTFRAMEWORK_REGISTER_TEST(ColocatedActorCreation);
+#endif // THERON_ACTOR_STORE_SIZE
+        TESTFRAMEWORK_REGISTER_TEST(AnonymousActorAddresses);
+        TESTFRAMEWORK_REGISTER_TEST(BatcherFlushThresholds);
+        TESTFRAMEWORK_REGISTER_TEST(IngressThrottleSmoothing);
+        TESTFRAMEWORK_REGISTER_TEST(MessageFlowSampling);
+        TESTFRAMEWORK_REGISTER_TEST(MessageStashing);
+        TESTFRAMEWORK_REGISTER_TEST(ParallelMailboxTeardown);
+        TESTFRAMEWORK_REGISTER_TEST(CatcherRingGrowth);
+        TESTFRAMEWORK_REGISTER_TEST(ConflatableMessages);
+        TESTFRAMEWORK_REGISTER_TEST(BurstPush);
+        TESTFRAMEWORK_REGISTER_TEST(FrameworkSendBatch);
+        TESTFRAMEWORK_REGISTER_TEST(SendBatchFanOut);
+        TESTFRAMEWORK_REGISTER_TEST(UrgentMessages);
+        TESTFRAMEWORK_REGISTER_TEST(AsyncActorCreation);
+#if THERON_CPP11
+        TESTFRAMEWORK_REGISTER_TEST(MoveSemanticsSend);
+        TESTFRAMEWORK_REGISTER_TEST(StaticDispatch);
+        TESTFRAMEWORK_REGISTER_TEST(LambdaHandlers);
+#endif // THERON_CPP11
+        TESTFRAMEWORK_REGISTER_TEST(EventCounterApi);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructEndPoint);
+        TESTFRAMEWORK_REGISTER_TEST(ConstructEndPointMultipleNetworkThreads);
+        TESTFRAMEWORK_REGISTER_TEST(TieFrameworkToEndPoint);
+        TESTFRAMEWORK_REGISTER_TEST(TieActorsToEndPoint);
+        TESTFRAMEWORK_REGISTER_TEST(TieReceiverstoEndPoint);
+        TESTFRAMEWORK_REGISTER_TEST(CrossEndPointDirectSend);
+        TESTFRAMEWORK_REGISTER_TEST(NameFrameworkOnConstruction);
+        TESTFRAMEWORK_REGISTER_TEST(NameActorOnConstruction);
+        TESTFRAMEWORK_REGISTER_TEST(NameReceiverOnConstruction);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageToLocalActorByName);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessagesBetweenLocalFrameworksByName);
+    }
+
+    inline static void ConstructFramework()
+    {
+        Theron::Framework framework;
+    }
+
+    inline static void ConstructFrameworkThreadCount()
+    {
+        Theron::Framework framework(16);
+    }
+
+    inline static void ConstructFrameworkDefaultParams()
+    {
+        Theron::Framework::Parameters params;
+        Theron::Framework framework(params);
+    }
+
+    inline static void ConstructFrameworkParamsThreadCount()
+    {
+        Theron::Framework::Parameters params(16);
+        Theron::Framework framework(params);
+    }
+
+    inline static void ConstructFrameworkParamsThreadCountNode()
+    {
+        Theron::Framework::Parameters params(16, 0);
+        Theron::Framework framework(params);
+    }
+
+    inline static void ConstructActor()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+    }
+
+    inline static void ConstructMultipleActors()
+    {
+        Theron::Framework framework;
+        TrivialActor actor0(framework);
+        TrivialActor actor1(framework);
+    }
+
+    inline static void ConstructAddress()
+    {
+        Theron::Address address;
+        Check(address == Theron::Address::Null(), "Default-constructed address should be null");
+    }
+
+    inline static void CopyAddress()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        const Theron::Address address(actor.GetAddress());
+        const Theron::Address copied(address);
+
+        Check(address != Theron::Address::Null(), "Actor address should be null");
+        Check(copied != Theron::Address::Null(), "Copied actor address should be null");
+        Check(copied == address, "Address not copied correctly");
+    }
+
+    inline static void AssignAddress()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        const Theron::Address address(actor.GetAddress());
+        Theron::Address assigned;
+
+        Check(address != Theron::Address::Null(), "Actor address should be null");
+
+        assigned = address;
+        Check(assigned != Theron::Address::Null(), "Copied actor address should be null");
+        Check(assigned == address, "Address not copied correctly");
+    }
+
+    inline static void GetActorFramework()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        Theron::Framework &actorFramework(actor.GetFramework());
+        Check(&actorFramework == &framework, "Actor framework incorrect");
+    }
+
+    inline static void GetActorAddress()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+        const Theron::Address address(actor.GetAddress());
+        Check(address != Theron::Address::Null(), "Actor address should not be null");
+    }
+
+    inline static void RegisterHandler()
+    {
+        Theron::Framework framework;
+        Registrar<int> actor(framework);
+    }
+
+    inline static void SendHandledMessage()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Replier<int> actor(framework);
+
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+    }
+
+    inline static void CreateActorInFunction()
+    {
+        Theron::Framework framework;
+        TrivialActor actor(framework);
+    }
+
+    inline static void SendMessageToReceiverInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        framework.Send(0.0f, receiver.GetAddress(), receiver.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void SendMessageFromNullAddressInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        framework.Send(0, Theron::Address::Null(), receiver.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void SendMessageToActorFromNullAddressInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Signaller signaller(framework);
+
+        framework.Send(receiver.GetAddress(), Theron::Address::Null(), signaller.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void SendMessageToActorFromReceiverInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Signaller signaller(framework);
+
+        framework.Send(receiver.GetAddress(), receiver.GetAddress(), signaller.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void PushMessageToActorFromNullAddressInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Signaller signaler(framework);
+
+        signaler.Push(receiver.GetAddress(), Theron::Address::Null());
+        receiver.Wait();
+    }
+
+    inline static void PushMessageToActorFromReceiverInFunction()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Signaller signaler(framework);
+
+        signaler.Push(receiver.GetAddress(), receiver.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void ReceiveReplyInFunction()
+    {
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        FloatReplier actor(framework);
+
+        framework.Send(5.0f, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+    }
+
+    inline static void CatchReplyInFunction()
+    {
+        typedef Replier<float> FloatReplier;
+        typedef Catcher<float> FloatCatcher;
+
+        Theron::Framework framework;
+        FloatReplier actor(framework);
+
+        Theron::Receiver receiver;
+        FloatCatcher catcher;
+        receiver.RegisterHandler(&catcher, &FloatCatcher::Catch);
+
+        framework.Send(5.0f, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == 5.0f, "Caught message value wrong");
+        Check(catcher.mFrom == actor.GetAddress(), "Caught from address wrong");
+    }
+
+    inline static void SendNonPODMessageInFunction()
+    {
+        typedef std::vector<int> VectorMessage;
+        typedef Replier<VectorMessage> VectorReplier;
+        typedef Catcher<VectorMessage> VectorCatcher;
+
+        Theron::Framework framework;
+        VectorReplier actor(framework);
+
+        Theron::Receiver receiver;
+        VectorCatcher catcher;
+        receiver.RegisterHandler(&catcher, &VectorCatcher::Catch);
+
+        VectorMessage vectorMessage;
+        vectorMessage.push_back(0);
+        vectorMessage.push_back(1);
+        vectorMessage.push_back(2);
+        framework.Send(vectorMessage, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == vectorMessage, "Reply message is wrong");
+    }
+
+    inline static void SendPointerMessageInFunction()
+    {
+        typedef float * PointerMessage;
+        typedef Replier<PointerMessage> PointerReplier;
+        typedef Catcher<PointerMessage> PointerCatcher;
+
+        Theron::Framework framework;
+        PointerReplier actor(framework);
+
+        Theron::Receiver receiver;
+        PointerCatcher catcher;
+        receiver.RegisterHandler(&catcher, &PointerCatcher::Catch);
+
+        float a(0.0f);
+        PointerMessage pointerMessage(&a);
+        framework.Send(pointerMessage, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == &a, "Reply message is wrong");
+    }
+
+    inline static void SendConstPointerMessageInFunction()
+    {
+        typedef const float * PointerMessage;
+        typedef Replier<PointerMessage> PointerReplier;
+        typedef Catcher<PointerMessage> PointerCatcher;
+
+        Theron::Framework framework;
+        PointerReplier actor(framework);
+
+        Theron::Receiver receiver;
+        PointerCatcher catcher;
+        receiver.RegisterHandler(&catcher, &PointerCatcher::Catch);
+
+        float a(0.0f);
+        PointerMessage pointerMessage(&a);
+        framework.Send(pointerMessage, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == &a, "Reply message is wrong");
+    }
+
+    inline static void CreateDerivedActor()
+    {
+        Theron::Framework framework;
+        StringReplier actor(framework);
+    }
+
+    inline static void SendMessageToDerivedActor()
+    {
+        typedef const char * StringMessage;
+        typedef Catcher<StringMessage> StringCatcher;
+
+        Theron::Framework framework;
+        StringReplier actor(framework);
+    
+        Theron::Receiver receiver;
+        StringCatcher catcher;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+    
+        const char *testString = "hello";
+        StringMessage stringMessage(testString);
+        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == stringMessage, "Reply message is wrong");
+    }
+
+    inline static void IncrementCounter()
+    {
+        typedef Catcher<int> CountCatcher;
+
+        Theron::Framework framework;
+        Counter actor(framework);
+
+        Theron::Receiver receiver;
+        CountCatcher catcher;
+        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
+
+        framework.Send(1, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(3, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(4, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(6, receiver.GetAddress(), actor.GetAddress());
+
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == 21, "Count is wrong");
+    }
+
+    inline static void ActorTemplate()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        IntReplier actor(framework);
+
+        Theron::Receiver receiver;
+        framework.Send(10, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+    }
+
+    inline static void OneHandlerAtATime()
+    {
+        typedef Catcher<int> CountCatcher;
+
+        Theron::Framework framework;
+        TwoHandlerCounter actor(framework);
+
+        Theron::Receiver receiver;
+        CountCatcher catcher;
+        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
+
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(0.0f, receiver.GetAddress(), actor.GetAddress());
+
+        // Get the counter value.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == 9, "Count is wrong");
+    }
+
+    inline static void MultipleHandlersForMessageType()
+    {
+        typedef Catcher<int> CountCatcher;
+
+        Theron::Framework framework;
+        MultipleHandlerCounter actor(framework);
+
+        Theron::Receiver receiver;
+        CountCatcher catcher;
+        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
+
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+
+        // Get the counter value.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == 9, "Count is wrong");
+    }
+
+    inline static void MessageArrivalOrder()
+    {
+        typedef Catcher<const char *> StringCatcher;
+        typedef Sequencer<int> IntSequencer;
+
+        Theron::Framework framework;
+        IntSequencer actor(framework);
+
+        Theron::Receiver receiver;
+        StringCatcher catcher;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+
+        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(1, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(2, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(3, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(4, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(6, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(7, receiver.GetAddress(), actor.GetAddress());
+
+        // Get the validity value.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage == IntSequencer::GOOD, "Sequencer status is wrong");
+
+        framework.Send(9, receiver.GetAddress(), actor.GetAddress());
+
+        // Get the validity value.
+        framework.Send(true, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage == IntSequencer::BAD, "Sequencer status is wrong");
+    }
+
+    inline static void SendAddressAsMessage()
+    {
+        typedef Catcher<Theron::Address> AddressCatcher;
+
+        Theron::Framework framework;
+        Signaller actorA(framework);
+        Signaller actorB(framework);
+
+        Theron::Receiver receiver;
+        AddressCatcher catcher;
+        receiver.RegisterHandler(&catcher, &AddressCatcher::Catch);
+
+        // Send A a message telling it to signal B.
+        // A sends the receiver address to B as the signal,
+        // causing B to send A's address to the receiver in turn.
+        framework.Send(actorB.GetAddress(), receiver.GetAddress(), actorA.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == actorA.GetAddress(), "Wrong address");
+    }
+
+    inline static void SendMessageToDefaultHandlerInFunction()
+    {
+        typedef DefaultReplier<float> FloatReplier;
+        typedef Catcher<std::string> StringCatcher;
+
+        Theron::Framework framework;
+        FloatReplier actor(framework);
+
+        StringCatcher catcher;
+        Theron::Receiver receiver;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+
+        // Send an int to the replier, which expects floats but has a default handler.
+        framework.Send(52, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == "hello", "Default handler not executed");
+    }
+
+    inline static void RegisterHandlerFromHandler()
+    {
+        typedef Catcher<std::string> StringCatcher;
+
+        Theron::Framework framework;
+        Switcher actor(framework);
+
+        StringCatcher catcher;
+        Theron::Receiver receiver;
+        receiver.RegisterHandler(&catcher, &StringCatcher::Catch);
+
+        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == "hello", "Handler not executed");
+
+        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == "goodbye", "Handler not executed");
+
+        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == "hello", "Handler not executed");
+
+        framework.Send(std::string("hello"), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == "goodbye", "Handler not executed");
+    }
+
+    inline static void CreateActorInConstructor()
+    {
+        Theron::Framework framework;
+
+        Recursor::Parameters params;
+        params.mCount = 10;
+        Recursor actor(framework, params);
+    }
+
+    inline static void SendMessageInConstructor()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // Pass the address of the receiver to the actor constructor.
+        AutoSender::Parameters params(receiver.GetAddress());
+        AutoSender actor(framework, params);
+
+        // Wait for the messages sent by the actor on construction.
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void DeregisterHandlerInConstructor()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        AutoDeregistrar actor(framework);
+
+        // Send the actor a message and check that the first handler doesn't send us a reply.
+        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage == 2, "Received wrong message");
+        Check(receiver.Count() == 0, "Received too many messages");
+    }
+
+    inline static void CreateActorInDestructor()
+    {
+        Theron::Framework framework;
+
+        TailRecursor::Parameters params;
+        params.mCount = 10;
+        TailRecursor actor(framework, params);
+    }
+
+    inline static void SendMessageInDestructor()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        {
+            // Pass the address of the receiver ton the actor constructor.
+            TailSender::Parameters params(receiver.GetAddress());
+            TailSender actor(framework, params);
+        }
+
+        // Wait for the messages sent by the actor on destruction.
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void DeregisterHandlerInDestructor()
+    {
+        // We check that it's safe to deregister a handler in an actor destructor,
+        // but since it can't handle messages after destruction, there's little effect.
+        Theron::Framework framework;
+        TailDeregistrar actor(framework);
+    }
+
+    inline static void CreateActorInHandler()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Nestor actor(framework);
+
+        framework.Send(Nestor::CreateMessage(), receiver.GetAddress(), actor.GetAddress());
+        framework.Send(Nestor::DestroyMessage(), receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+    }
+
+    inline static void GetNumQueuedMessagesInHandler()
+    {
+        typedef Catcher<Theron::uint32_t> CountCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        CountCatcher catcher;
+        receiver.RegisterHandler(&catcher, &CountCatcher::Catch);
+        
+        MessageQueueCounter actor(framework);
+
+        // Send the actor two messages.
+        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(0, receiver.GetAddress(), actor.GetAddress());
+
+        // Wait for and check both replies.
+        // Race condition decides whether the second message has already arrived.
+        // In Theron 4 the count includes the message currently being processed.
+        receiver.Wait();
+        Check(catcher.mMessage == 1 || catcher.mMessage == 2, "GetNumQueuedMessages failed");
+
+        receiver.Wait();
+        Check(catcher.mMessage == 1, "GetNumQueuedMessages failed");
+    }
+
+    inline static void GetNumQueuedMessagesInFunction()
+    {
+        typedef const char * StringMessage;
+        typedef Catcher<Theron::uint32_t> CountCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        StringReplier actor(framework);
+
+        // Send the actor two messages.
+        StringMessage stringMessage("hello");
+        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
+        framework.Send(stringMessage, receiver.GetAddress(), actor.GetAddress());
+
+        // Race conditions decide how many messages are in the queue when we ask.
+        // In Theron 4 the count includes the message currently being processed.
+        Theron::uint32_t numMessages(actor.GetNumQueuedMessages());
+        Check(numMessages < 3, "GetNumQueuedMessages failed, expected less than 3 messages");
+
+        receiver.Wait();
+
+        // There's no guarantee that the message handler will finish before the Wait() call returns.
+        numMessages = actor.GetNumQueuedMessages();
+        Check(numMessages < 3, "GetNumQueuedMessages failed, expected less than 3 messages");
+
+        receiver.Wait();
+
+        numMessages = actor.GetNumQueuedMessages();
+        Check(numMessages < 2, "GetNumQueuedMessages failed, expected less than 2 messages");
+    }
+
+    inline static void UseBlindDefaultHandler()
+    {
+        typedef Accumulator<Theron::uint32_t> UIntAccumulator;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        UIntAccumulator accumulator;
+        receiver.RegisterHandler(&accumulator, &UIntAccumulator::Catch);
+        
+        BlindActor actor(framework);
+
+        // Send the actor a uint32_t message, which is the type it secretly expects.
+        framework.Send(Theron::uint32_t(75), receiver.GetAddress(), actor.GetAddress());
+
+        // The actor sends back the value of the message data and the size.
+        receiver.Wait();
+        receiver.Wait();
+
+        Check(accumulator.Pop() == 75, "Bad blind data");
+        Check(accumulator.Pop() == 4, "Bad blind data size");
+    }
+
+    inline static void IsHandlerRegisteredInHandler()
+    {
+        typedef Accumulator<bool> BoolAccumulator;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        BoolAccumulator accumulator;
+        receiver.RegisterHandler(&accumulator, &BoolAccumulator::Catch);
+        
+        HandlerChecker actor(framework);
+        framework.Send(int(0), receiver.GetAddress(), actor.GetAddress());
+
+        Theron::uint32_t count(21);
+        while (count)
+        {
+            count -= receiver.Wait(count);
+        }
+
+        Check(accumulator.Pop() == true, "Bad registration check result 0");
+        Check(accumulator.Pop() == false, "Bad registration check result 1");
+        Check(accumulator.Pop() == false, "Bad registration check result 2");
+
+        //RegisterHandler(this, &HandlerChecker::Dummy);
+        Check(accumulator.Pop() == true, "Bad registration check result 3");
+        Check(accumulator.Pop() == true, "Bad registration check result 4");
+        Check(accumulator.Pop() == false, "Bad registration check result 5");
+
+        // DeregisterHandler(this, &HandlerChecker::Dummy);
+        Check(accumulator.Pop() == true, "Bad registration check result 6");
+        Check(accumulator.Pop() == false, "Bad registration check result 7");
+        Check(accumulator.Pop() == false, "Bad registration check result 8");
+
+        // DeregisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == false, "Bad registration check result 9");
+        Check(accumulator.Pop() == false, "Bad registration check result 10");
+        Check(accumulator.Pop() == false, "Bad registration check result 11");
+
+        // RegisterHandler(this, &HandlerChecker::Dummy);
+        // RegisterHandler(this, &HandlerChecker::Check);
+        // RegisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == true, "Bad registration check result 12");
+        Check(accumulator.Pop() == true, "Bad registration check result 13");
+        Check(accumulator.Pop() == false, "Bad registration check result 14");
+
+        // DeregisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == true, "Bad registration check result 15");
+        Check(accumulator.Pop() == true, "Bad registration check result 16");
+        Check(accumulator.Pop() == false, "Bad registration check result 17");
+
+        // DeregisterHandler(this, &HandlerChecker::Check);
+        Check(accumulator.Pop() == false, "Bad registration check result 18");
+        Check(accumulator.Pop() == true, "Bad registration check result 19");
+        Check(accumulator.Pop() == false, "Bad registration check result 20");
+    }
+
+    inline static void MailboxHandleSend()
+    {
+        typedef Replier<int> IntReplier;
+        typedef Theron::Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        FallbackHandler fallbackHandler;
+        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        IntReplier *replier = new IntReplier(framework);
+
+        // Pin the replier's mailbox once; sends via the handle skip the
+        // per-send address resolution.
+        Theron::MailboxHandle handle(framework.GetMailboxHandle(replier->GetAddress()));
+        Check(handle.IsValid(), "Failed to pin the mailbox of a local actor");
+        Check(handle.GetAddress() == replier->GetAddress(), "Pinned handle has the wrong address");
+
+        // Destinations that can't be pinned yield invalid handles.
+        Check(!framework.GetMailboxHandle(Theron::Address()).IsValid(), "Pinned the null address");
+        Check(!framework.GetMailboxHandle(receiver.GetAddress()).IsValid(), "Pinned a receiver address");
+
+        // Sends via an invalid handle fail.
+        const Theron::MailboxHandle invalidHandle;
+        Check(!framework.Send(int(0), receiver.GetAddress(), invalidHandle), "Send via an invalid handle succeeded");
+
+        // Send a stream of messages to the pinned mailbox and collect the replies.
+        const int messageCount(100);
+        for (int index = 0; index < messageCount; ++index)
+        {
+            Check(framework.Send(index, receiver.GetAddress(), handle), "Send via pinned handle failed");
+        }
+
+        int outstandingCount(messageCount);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        int reply(0);
+        Theron::Address from;
+        int poppedCount(0);
+        while (catcher.Pop(reply, from))
+        {
+            ++poppedCount;
+        }
+
+        Check(poppedCount == messageCount, "Wrong number of replies to sends via pinned handle");
+
+        // Mailboxes outlive their actors, so the handle of a dead actor stays
+        // safe to send through; the message goes to the fallback handler.
+        delete replier;
+        framework.Send(int(0), receiver.GetAddress(), handle);
+
+        uint32_t backoff(0);
+        while (fallbackHandler.mAddress != receiver.GetAddress())
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+    }
+
+    inline static void SetFallbackHandler()
+    {
+        Theron::Framework framework;
+        FallbackHandler fallbackHandler;
+
+        Check(framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle), "Register failed");
+    }
+
+    inline static void HandleUndeliveredMessageSentInFunction()
+    {
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        FallbackHandler fallbackHandler;
+        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        // Create an actor and let it die but remember its address.
+        Theron::Address staleAddress;
+
+        {
+            FloatReplier actor(framework);
+            staleAddress = actor.GetAddress();
+        }
+
+        // Send a message to the stale address.
+        framework.Send(0, receiver.GetAddress(), staleAddress);
+
+        // Wait for the undelivered message to be caught by the registered fallback handler.
+        uint32_t backoff(0);
+        while (fallbackHandler.mAddress != receiver.GetAddress())
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+    }
+
+    inline static void HandleUnhandledMessageSentInFunction()
+    {
+        typedef Replier<Theron::uint32_t> UIntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        FallbackHandler fallbackHandler;
+        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        // Create a replier that handles only ints, then send it a float.
+        UIntReplier replier(framework);
+        framework.Send(5.0f, receiver.GetAddress(), replier.GetAddress());
+
+        // Wait for the unhandled message to be caught by the registered fallback handler.
+        uint32_t backoff(0);
+        while (fallbackHandler.mAddress != receiver.GetAddress())
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+    }
+
+    inline static void HandleUndeliveredBlindMessageSentInFunction()
+    {
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        BlindFallbackHandler fallbackHandler;
+        fallbackHandler.mData = 0;
+        framework.SetFallbackHandler(&fallbackHandler, &BlindFallbackHandler::Handle);
+
+        // Create an actor and let it die but remember its address.
+        Theron::Address staleAddress;
+
+        {
+            FloatReplier actor(framework);
+            staleAddress = actor.GetAddress();
+        }
+
+        // Send a message to the stale address.
+        framework.Send(Theron::uint32_t(42), receiver.GetAddress(), staleAddress);
+
+        // Wait for the undelivered message to be caught by the registered fallback handler.
+        uint32_t backoff(0);
+        while (fallbackHandler.mData == 0)
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+
+        // Check that the undelivered message was handled by the registered fallback handler.
+        Check(fallbackHandler.mValue == 42, "Blind fallback handler failed");
+        Check(fallbackHandler.mSize == sizeof(Theron::uint32_t), "Blind fallback handler failed");
+        Check(fallbackHandler.mAddress == receiver.GetAddress(), "Blind fallback handler failed");
+    }
+
+    inline static void RetainMessageViewBeyondFallbackHandler()
+    {
+        typedef Replier<float> FloatReplier;
+
+        ViewFallbackHandler fallbackHandler;
+
+        {
+            Theron::Framework framework;
+            Theron::Receiver receiver;
+
+            framework.SetFallbackHandler(&fallbackHandler, &ViewFallbackHandler::Handle);
+
+            // Create an actor and let it die but remember its address.
+            Theron::Address staleAddress;
+
+            {
+                FloatReplier actor(framework);
+                staleAddress = actor.GetAddress();
+            }
+
+            // Send a message to the stale address.
+            framework.Send(Theron::uint32_t(42), receiver.GetAddress(), staleAddress);
+
+            // Wait for the undelivered message to be caught by the registered
+            // fallback handler. The from address is written after the view.
+            uint32_t backoff(0);
+            while (fallbackHandler.mAddress != receiver.GetAddress())
+            {
+                Theron::Detail::Utils::Backoff(backoff);
+            }
+        }
+
+        // The handler returned long ago and the framework is gone, but the
+        // retained view still keeps the message payload valid.
+        Check(fallbackHandler.mRetained.Valid(), "Retained message view isn't valid");
+        Check(fallbackHandler.mRetained.Size() == sizeof(Theron::uint32_t), "Retained message view has wrong size");
+        Check(fallbackHandler.mRetained.Data() != 0, "Retained message view has no data");
+        Check(*reinterpret_cast<const Theron::uint32_t *>(fallbackHandler.mRetained.Data()) == 42, "Retained message view has wrong payload");
+
+        // Releasing the last view destroys the message.
+        fallbackHandler.mRetained.Release();
+        Check(!fallbackHandler.mRetained.Valid(), "Released message view is still valid");
+    }
+
+    inline static void HandleMessageSentToStaleFrameworkInFunction()
+    {
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework0;
+        Theron::Receiver receiver;
+
+        // Register a safe fallback handler in the first framework.
+        FallbackHandler fallbackHandler;
+        framework0.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        // Create an actor in the first framework.
+        FloatReplier replier0(framework0);
+
+        // Create an actor in a second framework, then let the framework die but remember the address.
+        Theron::Address staleAddress;
+
+        {
+            Theron::Framework framework1;
+            FloatReplier replier1(framework1);
+            staleAddress = replier1.GetAddress();
+        }
+
+        // Send a message from the first framework to the stale address in the second framework.
+        framework0.Send(0.0f, receiver.GetAddress(), staleAddress);
+
+        // Wait for the undelivered message to be caught by the registered fallback handler.
+        uint32_t backoff(0);
+        while (fallbackHandler.mAddress != receiver.GetAddress())
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+    }
+
+    inline static void HandleMessageSentToStaleFrameworkInHandler()
+    {
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework0;
+        Theron::Receiver receiver;
+
+        // Register a safe fallback handler in the first framework.
+        FallbackHandler fallbackHandler;
+        framework0.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        // Create an actor in the first framework to send a message to an actor in the second.
+        // The signaller sends a message to the address it is sent.
+        Signaller signaller(framework0);
+
+        // Create an actor in a second framework, then let the framework die but remember the address.
+        Theron::Address staleAddress;
+
+        {
+            Theron::Framework framework1;
+            FloatReplier replier(framework1);
+            staleAddress = replier.GetAddress();
+        }
+
+        // Send a message to the signaller telling it to send a message to the stale address.
+        framework0.Send(staleAddress, receiver.GetAddress(), signaller.GetAddress());
+
+        // Wait for the undelivered message to be caught by the registered fallback handler.
+        // The undelivered message was sent by the signaller.
+        uint32_t backoff(0);
+        while (fallbackHandler.mAddress != signaller.GetAddress())
+        {
+            Theron::Detail::Utils::Backoff(backoff);
+        }
+    }
+
+    inline static void SendRegisteredMessage()
+    {
+        typedef Replier<IntVectorMessage> IntVectorReplier;
+        typedef Catcher<IntVectorMessage> IntVectorCatcher;
+
+        Theron::Framework framework;
+
+        Theron::Receiver receiver;
+        IntVectorCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntVectorCatcher::Catch);
+
+        IntVectorReplier replier(framework);
+
+        IntVectorMessage message;
+        message.push_back(0);
+        message.push_back(1);
+        message.push_back(2);
+
+        framework.Send(message, receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage.size() == 3, "Bad reply message");
+        Check(catcher.mMessage[0] == 0, "Bad reply message");
+        Check(catcher.mMessage[1] == 1, "Bad reply message");
+        Check(catcher.mMessage[2] == 2, "Bad reply message");
+    }
+
+    inline static void DeriveFromActorFirst()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        ActorFirst actor(framework);
+
+        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage == 5, "Bad reply message");
+    }
+
+    inline static void DeriveFromActorLast()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        ActorLast actor(framework);
+
+        framework.Send(5, receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.mMessage == 5, "Bad reply message");
+    }
+
+    inline static void SendEmptyMessage()
+    {
+        typedef Replier<EmptyMessage> EmptyReplier;
+        typedef Catcher<EmptyMessage> EmptyCatcher;
+
+        Theron::Framework framework;
+
+        Theron::Receiver receiver;
+        EmptyCatcher catcher;
+        receiver.RegisterHandler(&catcher, &EmptyCatcher::Catch);
+
+        EmptyReplier replier(framework);
+
+        framework.Send(EmptyMessage(), receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+
+        Check(&catcher.mMessage != 0, "No reply message");
+    }
+
+    inline static void MultipleFrameworks()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        Theron::Framework framework0;
+        Theron::Framework framework1;
+        Theron::Framework framework2;
+        Theron::Framework framework3;
+        Theron::Framework framework4;
+
+        Forwarder actor0(framework0, receiver.GetAddress());
+        Forwarder actor1(framework1, actor0.GetAddress());
+        Forwarder actor2(framework2, actor1.GetAddress());
+        Forwarder actor3(framework3, actor2.GetAddress());
+        Forwarder actor4(framework4, actor3.GetAddress());
+
+        framework0.Send(int(5), receiver.GetAddress(), actor4.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.mMessage == 0, "Received wrong message");
+        Check(receiver.Count() == 0, "Received too many messages");
+    }
+
+    inline static void ConstructFrameworkWithParameters()
+    {
+        typedef Replier<int> IntReplier;
+
+        const Theron::Framework::Parameters params0;
+        Theron::Framework framework0(params0);
+        Theron::Framework framework1(Theron::Framework::Parameters(8));
+        Theron::Framework framework2(Theron::Framework::Parameters(12, 0));
+
+        IntReplier replier0(framework0);
+        IntReplier replier1(framework1);
+        IntReplier replier2(framework2);
+
+        Theron::Receiver receiver;
+        framework0.Send(int(2), receiver.GetAddress(), replier0.GetAddress());
+        framework1.Send(int(2), receiver.GetAddress(), replier1.GetAddress());
+        framework2.Send(int(2), receiver.GetAddress(), replier2.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void UseActorRefs()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::ActorRef copyOne;
+        Theron::ActorRef copyTwo;
+
+        {
+            // Test parameterized and parameterless construction.
+            Version3Replier::Parameters params;
+            const Theron::ActorRef actorOne(framework.CreateActor<Version3Replier>());
+            Theron::ActorRef actorTwo(framework.CreateActor<Version3Replier>(params));
+
+            // Test transferral of ownership to copy-constructed ActorRefs.
+            const Theron::ActorRef tempOne(actorOne);
+            Theron::ActorRef tempTwo(actorTwo);
+
+            // Test transferral of ownership to assigned ActorRefs.
+            copyOne = tempOne;
+            copyTwo = tempTwo;
+        }
+
+        // Check ActorRef::operator== and ActorRef::operator!=
+        Check(copyOne == copyOne, "ActorRef::operator== failed");
+        Check(copyTwo == copyTwo, "ActorRef::operator== failed");
+        Check(copyOne != copyTwo, "ActorRef::operator!= failed");
+
+        // Test ActorRef::Null().
+        Check(copyOne != Theron::ActorRef::Null(), "ActorRef is null");
+        Check(copyTwo != Theron::ActorRef::Null(), "ActorRef is null");
+
+        framework.Send(int(35), receiver.GetAddress(), copyOne.GetAddress());
+        framework.Send(int(36), receiver.GetAddress(), copyTwo.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void SetMessageBatchSize()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework::Parameters params;
+        params.mMessageBatchSize = 16;
+
+        Theron::Framework framework(params);
+        IntReplier actor(framework);
+
+        Theron::Receiver receiver;
+
+        // Send a burst of messages so the worker drains them in batches.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void HighPriorityActors()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+
+        IntReplier control(framework);
+        IntReplier bulk(framework);
+
+        // Mark the control actor high-priority so its mailbox jumps the queue.
+        framework.SetPriority(control.GetAddress(), true);
+
+        Theron::Receiver receiver;
+
+        // Interleave sends to both actors; all messages should still be delivered.
+        for (int count = 0; count < 50; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), bulk.GetAddress());
+            framework.Send(count, receiver.GetAddress(), control.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void PriorityInheritanceAcrossActors()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // The front actor is high-priority; the helper it forwards to is not.
+        Forwarder helper(framework, receiver.GetAddress());
+        Forwarder front(framework, helper.GetAddress());
+        framework.SetPriority(front.GetAddress(), true);
+
+        // Requests hop through the normal-priority helper; the forwarded
+        // messages inherit the front actor's priority, keeping the chain
+        // expedited end-to-end. All messages should be delivered either way.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), front.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void PreallocateMessageBlocks()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        IntReplier actor(framework);
+
+        // Deepen the caches for small message blocks and warm them before sending.
+        framework.SetMessageCacheDepth(64, 128);
+        framework.Preallocate(64, 128);
+
+        Theron::Receiver receiver;
+
+        // The first burst of messages should be served from the warmed caches.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void ActorProfileApi()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        IntReplier actor(framework);
+
+        Theron::Receiver receiver;
+
+        for (int count = 0; count < 10; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+            receiver.Wait();
+        }
+
+        Theron::ActorProfile profile;
+        const bool fetched(framework.GetActorProfile(actor.GetAddress(), profile));
+
+#if THERON_ENABLE_PROFILING
+
+        Check(fetched, "GetActorProfile failed");
+        Check(profile.mTypeCount >= 1, "actor profile has no entries");
+
+        uint32_t messageCount(0);
+        for (uint32_t index = 0; index < profile.mTypeCount; ++index)
+        {
+            messageCount += profile.mTypes[index].mMessageCount;
+        }
+
+        Check(messageCount == 10, "actor profile message count wrong");
+
+        // All the messages came from this thread, so the sender table should
+        // attribute all ten arrivals to a single sending address.
+        Check(profile.mSenderCount == 1, "actor profile sender count wrong");
+        Check(profile.mSenders[0].mMessageCount == 10, "sender profile message count wrong");
+
+#else
+
+        // Profiling is disabled by default so no profile data exists.
+        Check(fetched == false, "GetActorProfile should fail when profiling is disabled");
+
+#endif // THERON_ENABLE_PROFILING
+    }
+
+    inline static void BoundedMailbox()
+    {
+        Theron::Framework framework;
+        BlockingReplier actor(framework);
+
+        // Rejected messages go to the fallback handler, like other undelivered messages.
+        FallbackHandler fallbackHandler;
+        framework.SetFallbackHandler(&fallbackHandler, &FallbackHandler::Handle);
+
+        framework.SetMailboxCapacity(actor.GetAddress(), 4);
+
+        Theron::Receiver receiver;
+
+        // The zero message stalls the actor, so the mailbox isn't drained.
+        Check(framework.Send(int(0), receiver.GetAddress(), actor.GetAddress()), "Send failed");
+
+        // Flood the stalled mailbox; sends beyond the capacity should be rejected.
+        Theron::uint32_t accepted(1);
+        Theron::uint32_t rejected(0);
+
+        for (int count = 1; count <= 20; ++count)
+        {
+            if (framework.Send(count, receiver.GetAddress(), actor.GetAddress()))
+            {
+                ++accepted;
+            }
+            else
+            {
+                ++rejected;
+            }
+        }
+
+        Check(rejected > 0, "bounded mailbox failed to reject sends");
+
+        // All accepted messages are still delivered once the actor unblocks.
+        for (Theron::uint32_t count = 0; count < accepted; ++count)
+        {
+            receiver.Wait();
+        }
+
+        // Removing the bound makes sends succeed again.
+        framework.SetMailboxCapacity(actor.GetAddress(), 0);
+
+        for (int count = 1; count <= 20; ++count)
+        {
+            Check(framework.Send(count, receiver.GetAddress(), actor.GetAddress()), "Send failed");
+        }
+
+        for (Theron::uint32_t count = 0; count < 20; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void QueueLengthSampling()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Replier<int> idle(framework);
+        BlockingReplier busy(framework);
+
+        // Stall the busy actor's handler and queue further messages behind it.
+        framework.Send(0, receiver.GetAddress(), busy.GetAddress());
+        for (int count = 0; count < 5; ++count)
+        {
+            framework.Send(1, receiver.GetAddress(), busy.GetAddress());
+        }
+
+        Theron::Address addresses[2] = { idle.GetAddress(), busy.GetAddress() };
+        uint32_t lengths[2] = { 0, 0 };
+
+        framework.GetQueueLengths(addresses, lengths, 2);
+
+        Check(lengths[0] == 0, "Idle actor reported a non-empty queue");
+        Check(lengths[1] >= 1, "Stalled actor reported an empty queue");
+
+        // Drain the replies before the actors are destructed.
+        for (int count = 0; count < 6; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void SendToLeastLoadedRouting()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Theron::Receiver routed;
+        Theron::Catcher<int> catcher;
+        routed.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // A pool of replicated workers, with the first member stalled.
+        BlockingReplier stalled(framework);
+        Replier<int> workerOne(framework);
+        Replier<int> workerTwo(framework);
+
+        // Stall the first worker's handler and queue further messages behind it.
+        framework.Send(0, receiver.GetAddress(), stalled.GetAddress());
+        for (int count = 0; count < 5; ++count)
+        {
+            framework.Send(1, receiver.GetAddress(), stalled.GetAddress());
+        }
+
+        Theron::Address pool[3] = { stalled.GetAddress(), workerOne.GetAddress(), workerTwo.GetAddress() };
+
+        for (int count = 0; count < 10; ++count)
+        {
+            // Sample the stalled worker's depth just before routing; while its
+            // backlog persists, join-shortest-queue must pick an idle worker.
+            uint32_t stalledDepth(0);
+            framework.GetQueueLengths(&pool[0], &stalledDepth, 1);
+
+            Check(framework.SendToLeastLoaded(count, routed.GetAddress(), pool, 3), "Routed send failed");
+            routed.Wait();
+
+            int reply(0);
+            Theron::Address from;
+            Check(catcher.Pop(reply, from), "No routed reply received");
+            Check(reply == count, "Routed reply carried the wrong value");
+
+            // An idle worker can transiently report one in-flight message, so
+            // only assert avoidance while the stalled queue is clearly deeper.
+            if (stalledDepth > 1)
+            {
+                Check(from != stalled.GetAddress(), "Routing picked the stalled worker");
+            }
+        }
+
+        // Drain the stall traffic replies before the actors are destructed.
+        for (int count = 0; count < 6; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void ScratchAllocations()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        ScratchUser actor(framework);
+
+        // No handler is executing in the constructor, so no arena is available.
+        Check(actor.ScratchAvailableOutsideHandler() == false, "Scratch allocator available outside a handler");
+
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void ParallelForCompute()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Theron::Catcher<Theron::uint32_t> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<Theron::uint32_t>::Push);
+
+        ParallelSquarer actor(framework);
+
+        // Repeated requests exercise repeated publication and retirement of
+        // the shared parallel task, with idle workers free to participate.
+        const Theron::uint32_t elementCount(10000);
+        const Theron::uint32_t runCount(10);
+
+        for (Theron::uint32_t run = 0; run < runCount; ++run)
+        {
+            framework.Send(elementCount, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        for (Theron::uint32_t run = 0; run < runCount; ++run)
+        {
+            receiver.Wait();
+
+            Theron::uint32_t verified(0);
+            Theron::Address from;
+
+            Check(catcher.Pop(verified, from), "No result message received");
+            Check(verified == elementCount, "ParallelFor missed range indices");
+        }
+    }
+
+    inline static void ChannelizedSends()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // A stable producer/consumer actor pair: the streamer sends a long run
+        // of messages to the checker from a single worker thread, triggering
+        // installation of a dedicated channel between the pair partway through.
+        const int messageCount(10000);
+
+        SequenceChecker checker(framework, receiver.GetAddress(), messageCount);
+        Streamer streamer(framework, checker.GetAddress());
+
+        framework.Send(messageCount, receiver.GetAddress(), streamer.GetAddress());
+        receiver.Wait();
+
+        // The checker reports the number of messages received out of order.
+        int outOfOrder(0);
+        Theron::Address from;
+        catcher.Pop(outOfOrder, from);
+
+        Check(outOfOrder == 0, "Channelized messages processed out of order");
+    }
+
+    inline static void LargeBlittableMessages()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Theron::Catcher<TelemetryFrame> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<TelemetryFrame>::Push);
+
+        Replier<TelemetryFrame> replier(framework);
+
+        // A bulk POD payload large enough to take the streaming copy path.
+        TelemetryFrame frame;
+        for (Theron::uint32_t index = 0; index < TelemetryFrame::SIZE; ++index)
+        {
+            frame.mBytes[index] = static_cast<Theron::uint8_t>(index * 31 + 7);
+        }
+
+        framework.Send(frame, receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+
+        TelemetryFrame echoed;
+        Theron::Address from;
+        catcher.Pop(echoed, from);
+
+        bool intact(true);
+        for (Theron::uint32_t index = 0; index < TelemetryFrame::SIZE; ++index)
+        {
+            if (echoed.mBytes[index] != static_cast<Theron::uint8_t>(index * 31 + 7))
+            {
+                intact = false;
+                break;
+            }
+        }
+
+        Check(intact, "Large blittable message corrupted in transit");
+    }
+
+    inline static void MemoryAccountingReport()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        BlockingReplier busy(framework);
+
+        // Stall the actor's handler and queue further messages behind it.
+        framework.Send(0, receiver.GetAddress(), busy.GetAddress());
+        for (int count = 0; count < 5; ++count)
+        {
+            framework.Send(1, receiver.GetAddress(), busy.GetAddress());
+        }
+
+        Theron::Address addresses[4];
+        uint32_t bytesQueued[4];
+        const uint32_t numEntries(framework.GetTopMemoryUsers(addresses, bytesQueued, 4));
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+
+        Check(numEntries >= 1, "Memory report missing the stalled mailbox");
+        Check(addresses[0] == busy.GetAddress(), "Memory report attributed to the wrong mailbox");
+        Check(bytesQueued[0] > 0, "Memory report has a zero tally");
+
+#else
+
+        // Memory accounting is disabled by default so no tallies exist.
+        Check(numEntries == 0, "GetTopMemoryUsers should report nothing when accounting is disabled");
+
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+        // Drain the replies before the actors are destructed.
+        for (int count = 0; count < 6; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void MemoryBudgetEnforcement()
+    {
+        // A budget comfortably above the framework's construction overheads
+        // but well below the memory of the payload flood sent below.
+        Theron::Framework::Parameters params;
+        params.mMemoryBudgetBytes = 2 * 1024 * 1024;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        Theron::Detail::Atomic::UInt32 pressureCount(0);
+        framework.SetMemoryPressureHandler(&NotePressure, &pressureCount);
+
+        Theron::Detail::Atomic::UInt32 tally(0);
+        PayloadSink sink(framework, &tally);
+
+        // Flood the sink with large payloads while its handler stalls, so the
+        // queued messages hold their memory and the budget is exceeded.
+        Theron::uint32_t numSent(0);
+        Theron::uint32_t numFailed(0);
+
+        BigPayload payload;
+        for (int count = 0; count < 100; ++count)
+        {
+            if (framework.Send(payload, receiver.GetAddress(), sink.GetAddress()))
+            {
+                ++numSent;
+            }
+            else
+            {
+                ++numFailed;
+            }
+        }
+
+        // Sends within the budget succeed and sends beyond it fail fast,
+        // with each refusal reported through the pressure handler.
+        Check(numSent > 0, "All sends failed under the memory budget");
+        Check(numFailed > 0, "No sends failed despite exceeding the memory budget");
+        Check(pressureCount.Load() >= numFailed, "Pressure handler missed budget refusals");
+        Check(framework.GetMemoryBytesInUse() > 0, "No memory accounted against the budget");
+
+        // Wait for the sink to drain; every payload admitted by the budget
+        // must have been delivered and processed.
+        const Theron::Address sinkAddress(sink.GetAddress());
+        framework.PhaseBarrier(&sinkAddress, 1);
+
+        Check(tally.Load() == numSent, "Admitted payloads lost under the memory budget");
+    }
+
+    inline static void FairnessUnderFlood()
+    {
+        // A single worker thread, so the flooded and idle mailboxes compete
+        // for the same worker.
+        Theron::Framework framework(1);
+        Theron::Receiver receiver;
+
+        BlockingReplier flooded(framework);
+        Replier<int> other(framework);
+
+        // Stall the worker in the flooded actor's handler, then queue a burst
+        // behind it along with messages for the other actor.
+        framework.Send(0, receiver.GetAddress(), flooded.GetAddress());
+        for (int count = 0; count < 50; ++count)
+        {
+            framework.Send(1, receiver.GetAddress(), flooded.GetAddress());
+        }
+        for (int count = 0; count < 5; ++count)
+        {
+            framework.Send(2, receiver.GetAddress(), other.GetAddress());
+        }
+
+        for (Theron::uint32_t count = 0; count < 56; ++count)
+        {
+            receiver.Wait();
+        }
+
+        // With both mailboxes runnable, the flooded mailbox is requeued behind
+        // the other's work each round rather than monopolizing the worker.
+        Check(framework.GetCounterValue(Theron::COUNTER_FAIRNESS_YIELDS) > 0, "Expected fairness yields under flood");
+    }
+
+    inline static void TimedBatchedWait()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Replier<int> replier(framework);
+
+        // With no messages in flight, a timed wait should time out and consume nothing.
+        Check(receiver.Wait(10, 1000) == 0, "Timed wait consumed messages that were never sent");
+
+        // Collect a batch of expected replies in timed waits, consuming
+        // multiple messages per wakeup where they have accumulated.
+        for (int count = 0; count < 10; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+        }
+
+        Theron::uint32_t outstandingCount(10);
+        while (outstandingCount)
+        {
+            const Theron::uint32_t consumed(receiver.Wait(outstandingCount, 1000000));
+            Check(consumed > 0, "Timed wait timed out with replies still expected");
+            Check(consumed <= outstandingCount, "Timed wait consumed more messages than requested");
+
+            outstandingCount -= consumed;
+        }
+
+        // A zero timeout polls, returning immediately with nothing available.
+        Check(receiver.Wait(1, 0) == 0, "Zero-timeout wait consumed an unexpected message");
+    }
+
+    inline static void RingCatcherMessages()
+    {
+        typedef Theron::RingCatcher<int, 256> IntCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+        Check(catcher.Empty(), "RingCatcher should initially be empty");
+
+        Replier<int> replier(framework);
+
+        // Pop echoed values back out in send order; the ring wraps several
+        // times over the course of the run.
+        int expected(0);
+        for (int batch = 0; batch < 10; ++batch)
+        {
+            for (int count = 0; count < 100; ++count)
+            {
+                framework.Send(batch * 100 + count, receiver.GetAddress(), replier.GetAddress());
+            }
+
+            Theron::uint32_t outstandingCount(100);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+            int value(0);
+            Theron::Address from;
+
+            // Peek at the front before popping it.
+            Check(catcher.Front(value, from), "RingCatcher::Front failed with messages caught");
+            Check(value == expected, "RingCatcher::Front returned the wrong message");
+
+            while (catcher.Pop(value, from))
+            {
+                Check(value == expected, "RingCatcher returned messages out of order");
+                Check(from == replier.GetAddress(), "RingCatcher recorded the wrong sender address");
+                ++expected;
+            }
+        }
+
+        Check(expected == 1000, "RingCatcher lost messages");
+        Check(catcher.Empty(), "RingCatcher should be empty after popping all messages");
+        Check(catcher.Dropped() == 0, "RingCatcher dropped messages despite ample capacity");
+    }
+
+    inline static void ThreadPoolAutoScaling()
+    {
+        const Theron::Framework::Parameters params(1);
+        Theron::Framework framework(params);
+
+        // By default both bounds match the initial thread count and the
+        // manager thread leaves the thread count alone.
+        Check(framework.GetMinThreads() == 1, "Min thread bound should default to the initial thread count");
+        Check(framework.GetMaxThreads() == 1, "Max thread bound should default to the initial thread count");
+
+        // Widening the bounds enables automatic scaling between them.
+        framework.SetMaxThreads(4);
+        Check(framework.GetMaxThreads() == 4, "SetMaxThreads didn't update the max thread bound");
+        Check(framework.GetMinThreads() == 1, "SetMaxThreads shouldn't affect the min thread bound");
+
+        Theron::Receiver receiver;
+        BlockingReplier *actors[8];
+        for (Theron::uint32_t index = 0; index < 8; ++index)
+        {
+            actors[index] = new BlockingReplier(framework);
+        }
+
+        // Stall every actor at once; the single worker can only service them
+        // one at a time, so the rest back up on the shared queue and the
+        // manager thread should add workers in response.
+        for (Theron::uint32_t index = 0; index < 8; ++index)
+        {
+            framework.Send(0, receiver.GetAddress(), actors[index]->GetAddress());
+        }
+
+        Theron::uint32_t outstandingCount(8);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Check(framework.GetPeakThreads() > 1, "Worker count failed to scale up under sustained queue backlog");
+        Check(framework.GetPeakThreads() <= 4, "Worker count scaled beyond the max thread bound");
+
+        for (Theron::uint32_t index = 0; index < 8; ++index)
+        {
+            delete actors[index];
+        }
+    }
+
+    inline static void BulkActorCreation()
+    {
+        Theron::Framework framework;
+
+        const Theron::uint32_t count(100);
+        Replier<int> *const actors(framework.CreateActors<Replier<int> >(count));
+        Check(actors != 0, "CreateActors failed");
+
+        // The mailbox indices of a bulk-created block are consecutive.
+        const Theron::uint32_t firstIndex(actors[0].GetAddress().AsInteger());
+        for (Theron::uint32_t index = 0; index < count; ++index)
+        {
+            Check(actors[index].GetAddress().AsInteger() == firstIndex + index, "Bulk-created actors should have consecutive addresses");
+        }
+
+        // Every actor in the block is live and addressable.
+        Theron::Receiver receiver;
+        for (Theron::uint32_t index = 0; index < count; ++index)
+        {
+            framework.Send(static_cast<int>(index), receiver.GetAddress(), actors[index].GetAddress());
+        }
+
+        Theron::uint32_t outstandingCount(count);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        framework.DestroyActors(actors, count);
+    }
+
+    inline static void ScatterGatherBatch()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> replyCatcher;
+        Theron::Catcher<Theron::ScatterGatherComplete> completionCatcher;
+
+        receiver.RegisterHandler(&replyCatcher, &Theron::Catcher<int>::Push);
+        receiver.RegisterHandler(&completionCatcher, &Theron::Catcher<Theron::ScatterGatherComplete>::Push);
+
+        Replier<int> replierOne(framework);
+        Replier<int> replierTwo(framework);
+        Replier<int> replierThree(framework);
+        Replier<int> replierFour(framework);
+
+        const Theron::Address replierAddresses[4] =
+        {
+            replierOne.GetAddress(),
+            replierTwo.GetAddress(),
+            replierThree.GetAddress(),
+            replierFour.GetAddress()
+        };
+
+        // Scatter a batch over the actors, with repeated destinations so the
+        // grouped scheduling path is exercised.
+        const Theron::uint32_t count(64);
+        int values[count];
+        Theron::Address addresses[count];
+
+        for (Theron::uint32_t index = 0; index < count; ++index)
+        {
+            values[index] = static_cast<int>(index);
+            addresses[index] = replierAddresses[index % 4];
+        }
+
+        const Theron::uint32_t delivered(framework.ScatterGather(values, addresses, count, receiver.GetAddress()));
+        Check(delivered == count, "ScatterGather failed to deliver the whole batch");
+
+        // Expect one echoed reply per message plus the aggregate completion.
+        Theron::uint32_t outstandingCount(count + 1);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Theron::ScatterGatherComplete completion;
+        Theron::Address from;
+        Check(completionCatcher.Pop(completion, from), "ScatterGather completion message not delivered");
+        Check(completion.mDelivered == count, "ScatterGather completion reported the wrong delivered count");
+        Check(completion.mCount == count, "ScatterGather completion reported the wrong batch size");
+
+        // Every value of the batch should have been echoed back exactly once.
+        int replySum(0);
+        int reply(0);
+        Theron::uint32_t numReplies(0);
+
+        while (replyCatcher.Pop(reply, from))
+        {
+            replySum += reply;
+            ++numReplies;
+        }
+
+        Check(numReplies == count, "ScatterGather lost replies");
+        Check(replySum == static_cast<int>(count * (count - 1) / 2), "ScatterGather replies have unexpected values");
+    }
+
+    inline static void PhaseBarrierSupersteps()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // A ring of workers that fan sub-messages out to their neighbours
+        // during each phase, tallying the sub-messages they receive.
+        const Theron::uint32_t numWorkers(8);
+        const Theron::uint32_t subSendsPerWorker(3);
+
+        Theron::Detail::Atomic::UInt32 tally(0);
+
+        PhaseWorker *workers[numWorkers];
+        for (Theron::uint32_t index = 0; index < numWorkers; ++index)
+        {
+            workers[index] = new PhaseWorker(framework, &tally);
+        }
+
+        Theron::Address members[numWorkers];
+        for (Theron::uint32_t index = 0; index < numWorkers; ++index)
+        {
+            members[index] = workers[index]->GetAddress();
+        }
+
+        // Introduce each worker to its ring neighbour, and barrier so the
+        // introductions have all been processed before the first phase.
+        for (Theron::uint32_t index = 0; index < numWorkers; ++index)
+        {
+            framework.Send(members[(index + 1) % numWorkers], receiver.GetAddress(), members[index]);
+        }
+
+        framework.PhaseBarrier(members, numWorkers);
+
+        // Each superstep fans work out to the whole group and barriers; on
+        // return from the barrier every sub-message of the phase, including
+        // those the workers sent each other, must have been processed.
+        const Theron::uint32_t numPhases(10);
+        for (Theron::uint32_t phase = 0; phase < numPhases; ++phase)
+        {
+            for (Theron::uint32_t index = 0; index < numWorkers; ++index)
+            {
+                framework.Send(static_cast<int>(subSendsPerWorker), receiver.GetAddress(), members[index]);
+            }
+
+            framework.PhaseBarrier(members, numWorkers);
+
+            const Theron::uint32_t expected(numWorkers * subSendsPerWorker * (phase + 1));
+            Check(tally.Load() == expected, "Superstep incomplete on return from PhaseBarrier");
+        }
+
+        for (Theron::uint32_t index = 0; index < numWorkers; ++index)
+        {
+            delete workers[index];
+        }
+    }
+
+    inline static void InternedStrings()
+    {
+        // Strings with equal values share an interned body, so building a
+        // string from the same characters twice yields the same value pointer.
+        const Theron::Detail::String first("interned string test name");
+        const Theron::Detail::String second("interned string test name");
+        const Theron::Detail::String different("a different test name");
+
+        Check(first == second, "Strings with equal values compare unequal");
+        Check(first.GetValue() == second.GetValue(), "Strings with equal values weren't interned");
+        Check(first != different, "Strings with different values compare equal");
+        Check(first.GetHash() == second.GetHash(), "Strings with equal values have different hashes");
+        Check(strcmp(first.GetValue(), "interned string test name") == 0, "Interned string has the wrong value");
+
+        // Copies share the body of the original.
+        const Theron::Detail::String copy(first);
+        Check(copy.GetValue() == first.GetValue(), "String copy doesn't share the interned body");
+
+        // Values longer than the local data buffer of a pool entry still intern.
+        const char *const longValue(
+            "a string value deliberately made long enough to overflow the local "
+            "data buffer of a string pool entry and exercise the heap path");
+        const Theron::Detail::String firstLong(longValue);
+        const Theron::Detail::String secondLong(longValue);
+
+        Check(firstLong == secondLong, "Long strings with equal values compare unequal");
+        Check(strcmp(firstLong.GetValue(), longValue) == 0, "Long interned string has the wrong value");
+    }
+
+    inline static void ActorMigration()
+    {
+        Theron::Framework first;
+        Theron::Framework second;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        Replier<int> replier(first);
+        const Theron::Address oldAddress(replier.GetAddress());
+
+        // The actor works normally in its birth framework.
+        first.Send(1, receiver.GetAddress(), oldAddress);
+        receiver.Wait();
+
+        Check(first.MigrateActor(oldAddress, second), "Migration failed");
+
+        // The actor's name, and so its address identity, is preserved, but the
+        // address now routes to a mailbox in the target framework.
+        const Theron::Address newAddress(replier.GetAddress());
+        Check(newAddress.GetFramework() != oldAddress.GetFramework(), "Migrated actor's address still routes to the old framework");
+        Check(&replier.GetFramework() == &second, "Migrated actor isn't in the target framework");
+
+        // Messages sent to the old address are forwarded to the new mailbox,
+        // and the actor's replies carry the new address.
+        first.Send(2, receiver.GetAddress(), oldAddress);
+        receiver.Wait();
+
+        int reply(0);
+        Theron::Address from;
+
+        while (catcher.Pop(reply, from))
+        {
+        }
+
+        Check(reply == 2, "Message to old address wasn't forwarded to migrated actor");
+        Check(from.GetFramework() == newAddress.GetFramework(), "Migrated actor's reply doesn't carry its new address");
+        Check(from.AsInteger() == newAddress.AsInteger(), "Migrated actor's reply doesn't carry its new mailbox");
+
+        // Messages sent to the new address are delivered directly.
+        second.Send(3, receiver.GetAddress(), newAddress);
+        receiver.Wait();
+
+        // A second migration attempt finds no actor at the old address.
+        Check(first.MigrateActor(oldAddress, second) == false, "Migration of empty mailbox didn't fail");
+    }
+
+    inline static void RespawnSlotSwap()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // Reserve the successor's storage and mailbox up front, outside any
+        // 'incident'; the reserved resources make the later respawn a
+        // constant-time swap with no allocation.
+        Theron::RespawnSlot slot;
+        Check(framework.ReserveRespawnSlot<Replier<int> >(slot), "Failed to reserve respawn slot");
+        Check(slot.IsReserved(), "Reserved slot doesn't report as reserved");
+        Check(slot.GetActor() == 0, "Unused slot reports a respawned actor");
+
+        Replier<int> *replier = new Replier<int>(framework);
+        const Theron::Address oldAddress(replier->GetAddress());
+
+        // The original actor works normally.
+        framework.Send(1, receiver.GetAddress(), oldAddress);
+        receiver.Wait();
+
+        // The actor 'fails' and is destructed by its supervisor.
+        delete replier;
+
+        // Respawn a successor into the reserved slot, redirecting the failed
+        // actor's address to it.
+        Replier<int> *const successor(framework.RespawnActor<Replier<int> >(slot, oldAddress));
+        Check(successor != 0, "Respawn failed");
+        Check(slot.IsReserved() == false, "Used slot still reports as reserved");
+        Check(slot.GetActor() == successor, "Used slot doesn't report the respawned actor");
+
+        const Theron::Address newAddress(successor->GetAddress());
+        Check(newAddress != oldAddress, "Successor reuses the failed actor's mailbox");
+
+        // Messages sent to the failed actor's address are forwarded to the
+        // successor, and the successor's replies carry its own address.
+        framework.Send(2, receiver.GetAddress(), oldAddress);
+        receiver.Wait();
+
+        int reply(0);
+        Theron::Address from;
+
+        while (catcher.Pop(reply, from))
+        {
+        }
+
+        Check(reply == 2, "Message to failed actor's address wasn't forwarded to the successor");
+        Check(from.AsInteger() == newAddress.AsInteger(), "Successor's reply doesn't carry its own mailbox");
+
+        // Messages sent to the successor's own address are delivered directly.
+        framework.Send(3, receiver.GetAddress(), newAddress);
+        receiver.Wait();
+
+        // The slot owns the successor; resetting it destructs the actor and
+        // frees the reserved storage, after which the slot can be re-reserved.
+        slot.Reset();
+        Check(slot.GetActor() == 0, "Reset slot still reports a respawned actor");
+        Check(framework.ReserveRespawnSlot<Replier<int> >(slot), "Failed to re-reserve reset slot");
+    }
+
+    inline static void MessageBuilderSend()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<std::string> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<std::string>::Push);
+
+        Replier<std::string> replier(framework);
+
+        // A default-constructed builder holds no message.
+        Theron::MessageBuilder<std::string> builder;
+        Check(!builder.IsValid(), "Default-constructed builder reports as valid");
+
+        // Allocate the message up front and construct the value directly in
+        // its payload memory, instead of constructing it elsewhere and
+        // copying it in.
+        Check(
+            framework.AllocateMessage(builder, receiver.GetAddress(), replier.GetAddress()),
+            "Failed to allocate a builder message");
+        Check(builder.IsValid(), "Allocated builder doesn't report as valid");
+
+        new (builder.Memory()) std::string("in-place");
+        Check(builder.Value() == "in-place", "Builder value wasn't constructed in place");
+
+        // Committing sends the built message and invalidates the builder.
+        Check(builder.Commit(), "Failed to commit a built message");
+        Check(!builder.IsValid(), "Committed builder still reports as valid");
+
+        receiver.Wait();
+
+        std::string reply;
+        Theron::Address from;
+        Check(catcher.Pop(reply, from), "Reply to committed message not received");
+        Check(reply == "in-place", "Reply to committed message has the wrong value");
+        Check(from == replier.GetAddress(), "Reply to committed message has the wrong sender");
+
+        // An abandoned builder frees its memory without sending; values with
+        // non-trivial destructors must be destructed by the caller first.
+        Check(
+            framework.AllocateMessage(builder, receiver.GetAddress(), replier.GetAddress()),
+            "Failed to allocate a second builder message");
+
+        typedef std::string StringMessage;
+        new (builder.Memory()) StringMessage("abandoned");
+        builder.Value().~StringMessage();
+        builder.Abandon();
+        Check(!builder.IsValid(), "Abandoned builder still reports as valid");
+
+        // A builder destructed while still valid frees its memory too; the
+        // value here is never constructed, which is also legal.
+        {
+            Theron::MessageBuilder<std::string> unused;
+            Check(
+                framework.AllocateMessage(unused, receiver.GetAddress(), replier.GetAddress()),
+                "Failed to allocate an unused builder message");
+        }
+    }
+
+    inline static void HighRateMailboxPool()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // Flag the replier high-rate, so sends to it claim message blocks from
+        // the micro-pool embedded in its mailbox when they fit a slot.
+        Replier<int> replier(framework);
+        framework.SetHighRate(replier.GetAddress(), true);
+
+        // Send more messages than the pool has slots, so the stream exercises
+        // both pooled blocks, their reuse as processed messages return them,
+        // and the allocator fallback while all slots are claimed.
+        const int messageCount(100);
+        for (int index = 0; index < messageCount; ++index)
+        {
+            Check(framework.Send(index, receiver.GetAddress(), replier.GetAddress()), "Send to high-rate actor failed");
+        }
+
+        int outstandingCount(messageCount);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        int reply(0);
+        Theron::Address from;
+        int poppedCount(0);
+        while (catcher.Pop(reply, from))
+        {
+            ++poppedCount;
+        }
+
+        Check(poppedCount == messageCount, "Wrong number of replies from high-rate actor");
+
+        // Messages too large for a pool slot take the ordinary allocator path.
+        Theron::Catcher<TelemetryFrame> frameCatcher;
+        receiver.RegisterHandler(&frameCatcher, &Theron::Catcher<TelemetryFrame>::Push);
+
+        Replier<TelemetryFrame> bulkReplier(framework);
+        framework.SetHighRate(bulkReplier.GetAddress(), true);
+
+        TelemetryFrame frame;
+        frame.mBytes[0] = 0xAB;
+        frame.mBytes[TelemetryFrame::SIZE - 1] = 0xCD;
+
+        Check(framework.Send(frame, receiver.GetAddress(), bulkReplier.GetAddress()), "Send of oversized message failed");
+        receiver.Wait();
+
+        TelemetryFrame echoed;
+        Check(frameCatcher.Pop(echoed, from), "Oversized reply not received");
+        Check(echoed.mBytes[0] == 0xAB && echoed.mBytes[TelemetryFrame::SIZE - 1] == 0xCD, "Oversized reply corrupted");
+
+        // Unflagging reverts the actor to ordinary allocation.
+        framework.SetHighRate(replier.GetAddress(), false);
+        framework.Send(0, receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void FrameworkOwnedActorConstruction()
+    {
+        int destructCount(0);
+
+        {
+            Theron::Framework framework;
+            Theron::Receiver receiver;
+
+            Theron::Catcher<int> catcher;
+            receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+            // Construct a population of actors into framework-owned slab
+            // storage, with constructor arguments forwarded after the
+            // framework reference.
+            const Theron::uint32_t count(50);
+            SlabTracked *actors[count];
+
+            for (Theron::uint32_t index = 0; index < count; ++index)
+            {
+                actors[index] = framework.ConstructActor<SlabTracked>(&destructCount);
+                Check(actors[index] != 0, "ConstructActor failed");
+            }
+
+            // Actors of different types share the slabs.
+            Replier<int> *const replier(framework.ConstructActor<Replier<int> >());
+            Check(replier != 0, "ConstructActor failed");
+
+            // Every owned actor is live and addressable.
+            for (Theron::uint32_t index = 0; index < count; ++index)
+            {
+                framework.Send(static_cast<int>(index), receiver.GetAddress(), actors[index]->GetAddress());
+            }
+
+            framework.Send(0, receiver.GetAddress(), replier->GetAddress());
+
+            Theron::uint32_t outstandingCount(count + 1);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+
+            // The framework owns the actors; they are destructed, in
+            // construction order, when it is destructed.
+            Check(destructCount == 0, "Owned actors destructed before the framework");
+        }
+
+        Check(destructCount == 50, "Owned actors not destructed with the framework");
+    }
+
+    inline static void ContinuationReply()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // The requester forwards requests from the receiver to the replier
+        // with SendWithContinuation, so the reply should fire the registered
+        // continuation rather than the actor's ordinary int handler.
+        Replier<int> replier(framework);
+        ContinuationRequester requester(framework, receiver.GetAddress(), replier.GetAddress());
+
+        int reply(0);
+        Theron::Address from;
+
+        framework.Send(1, receiver.GetAddress(), requester.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.Pop(reply, from), "Continuation reply not delivered");
+        Check(reply == 101, "Reply didn't fire the registered continuation");
+
+        // Continuations are one-shot, so a second round trip requires, and
+        // consumes, a fresh registration.
+        framework.Send(2, receiver.GetAddress(), requester.GetAddress());
+        receiver.Wait();
+
+        Check(catcher.Pop(reply, from), "Second continuation reply not delivered");
+        Check(reply == 102, "Second reply didn't fire a fresh continuation");
+    }
+
+    inline static void PooledMessages()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<PooledMessage> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<PooledMessage>::Push);
+
+        // Pre-size the pool so the whole burst allocates from the freelist.
+        Theron::SetMessagePoolDepth<PooledMessage>(128);
+
+        Replier<PooledMessage> replier(framework);
+
+        // Cycle a burst of pooled messages through an actor several times, so
+        // blocks are repeatedly popped from and returned to the per-type pool.
+        for (int round = 0; round < 10; ++round)
+        {
+            for (int index = 0; index < 100; ++index)
+            {
+                PooledMessage message;
+                message.mValue = round * 100 + index;
+
+                framework.Send(message, receiver.GetAddress(), replier.GetAddress());
+            }
+
+            for (int index = 0; index < 100; ++index)
+            {
+                receiver.Wait();
+            }
+        }
+
+        // The replies should arrive intact, with the last value preserved.
+        PooledMessage reply;
+        Theron::Address from;
+        int numReplies(0);
+
+        while (catcher.Pop(reply, from))
+        {
+            ++numReplies;
+        }
+
+        Check(numReplies == 1000, "Pooled messages lost");
+        Check(reply.mValue == 999, "Pooled message value corrupted");
+
+        // Shrinking the pool releases the retained blocks back to the general allocator.
+        Theron::SetMessagePoolDepth<PooledMessage>(0);
+    }
+
+    inline static void CachedNameLookups()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+        Theron::Receiver receiver(endPoint);
+
+        // The forwarder sends to the target by name from a worker thread, so
+        // repeated sends to the stable name hit the per-thread lookup cache.
+        NameForwarder forwarder(
+            framework,
+            receiver.GetAddress(),
+            Theron::Address("cached_name_target"));
+
+        {
+            IntReplier first(framework, "cached_name_target");
+
+            for (int count = 0; count < 50; ++count)
+            {
+                framework.Send(count, receiver.GetAddress(), forwarder.GetAddress());
+                receiver.Wait();
+            }
+        }
+
+        // The first target deregistered its name on destruction, invalidating
+        // cached resolutions; a new actor under the same name must be found.
+        {
+            IntReplier second(framework, "cached_name_target");
+
+            for (int count = 0; count < 50; ++count)
+            {
+                framework.Send(count, receiver.GetAddress(), forwarder.GetAddress());
+                receiver.Wait();
+            }
+        }
+    }
+
+    inline static void MetricsSampling()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        CountingMetricsSink sink;
+        framework.SetMetricsSink(&sink, 1000);
+
+        IntReplier replier(framework);
+
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+            receiver.Wait();
+        }
+
+        // The manager thread pushes samples periodically; wait for a sample
+        // taken after all the messages were processed.
+        Theron::uint32_t attempts(0);
+        while (sink.mProcessed.Load() < 100 && ++attempts < 500)
+        {
+            Theron::Detail::Utils::SleepThread(10);
+        }
+
+        Check(sink.mSampleCount.Load() > 0, "Metrics sink received no samples");
+        Check(sink.mProcessed.Load() >= 100, "Metrics samples missed processed messages");
+
+        // Clearing the sink stops the sampling.
+        framework.SetMetricsSink(0, 0);
+    }
+
+    inline static void BroadcastSharedPayload()
+    {
+        typedef Replier<PooledMessage> MessageReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<PooledMessage> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<PooledMessage>::Push);
+
+        const Theron::uint32_t subscriberCount(8);
+
+        MessageReplier *subscribers[subscriberCount];
+        Theron::Address addresses[subscriberCount];
+
+        for (Theron::uint32_t index = 0; index < subscriberCount; ++index)
+        {
+            subscribers[index] = new MessageReplier(framework);
+            addresses[index] = subscribers[index]->GetAddress();
+        }
+
+        // Broadcast several values to all of the subscribers; each broadcast
+        // copies the value once into a shared block referenced by the envelopes.
+        for (int round = 0; round < 10; ++round)
+        {
+            PooledMessage message;
+            message.mValue = round;
+
+            Check(
+                framework.Broadcast(message, receiver.GetAddress(), addresses, subscriberCount),
+                "Broadcast failed to deliver to all subscribers");
+
+            for (Theron::uint32_t index = 0; index < subscriberCount; ++index)
+            {
+                receiver.Wait();
+            }
+        }
+
+        // Every subscriber should have echoed every broadcast value back.
+        PooledMessage reply;
+        Theron::Address from;
+        int replySum(0);
+        Theron::uint32_t numReplies(0);
+
+        while (catcher.Pop(reply, from))
+        {
+            replySum += reply.mValue;
+            ++numReplies;
+        }
+
+        Check(numReplies == 10 * subscriberCount, "Broadcast replies lost");
+        Check(replySum == static_cast<int>(subscriberCount * 45), "Broadcast replies have unexpected values");
+
+        for (Theron::uint32_t index = 0; index < subscriberCount; ++index)
+        {
+            delete subscribers[index];
+        }
+    }
+
+    inline static void WorkerProcessorPinning()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Pin each of the workers to an explicit processor. Processor zero
+        // always exists, so the pinning is valid whatever the host machine;
+        // on unsupported platforms the pin fails silently and the workers
+        // just keep the mask-based affinity.
+        const Theron::uint32_t workerProcessors[2] = { 0, 0 };
+
+        Theron::Framework::Parameters params(2);
+        params.mWorkerProcessors = workerProcessors;
+        params.mWorkerProcessorCount = 2;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        IntReplier replier(framework);
+
+        // Messages flow normally through the pinned workers.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+            receiver.Wait();
+        }
+    }
+
+    inline static void QueueWatermarkEvents()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<Theron::QueueWatermarkEvent> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<Theron::QueueWatermarkEvent>::Push);
+
+        WatermarkedActor actor(framework, receiver.GetAddress());
+
+        // The burst floods the actor's own queue from inside a handler, so the
+        // depth rises deterministically past the high watermark while the
+        // mailbox is busy, then falls back through the low watermark as the
+        // flood drains; one event is expected for each crossing.
+        framework.Send(20, receiver.GetAddress(), actor.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+
+        Theron::QueueWatermarkEvent event;
+        Theron::Address from;
+
+        Check(catcher.Pop(event, from), "Expected a high watermark event");
+        Check(event.mHigh, "Expected the high watermark to be crossed first");
+        Check(event.mDepth >= 8, "High watermark event reports depth below the mark");
+
+        Check(catcher.Pop(event, from), "Expected a low watermark event");
+        Check(!event.mHigh, "Expected a low watermark event after the queue drained");
+        Check(event.mDepth <= 1, "Low watermark event reports depth above the mark");
+
+        Check(!catcher.Pop(event, from), "Expected exactly one event per crossing");
+    }
+
+    inline static void PooledReceivers()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        IntReplier replier(framework);
+
+        const Theron::uint32_t poolSize(4);
+        Theron::ReceiverPool pool(poolSize);
+
+        Check(pool.GetCount() == poolSize, "Receiver pool has unexpected size");
+
+        // The pool is exhaustible: once every receiver is borrowed, further
+        // acquires fail until one is returned.
+        Theron::Receiver *borrowed[poolSize];
+        for (Theron::uint32_t index = 0; index < poolSize; ++index)
+        {
+            borrowed[index] = pool.Acquire();
+            Check(borrowed[index] != 0, "Failed to acquire a pooled receiver");
+        }
+
+        Check(pool.Acquire() == 0, "Acquire from an exhausted pool should fail");
+
+        pool.Release(borrowed[0]);
+        borrowed[0] = pool.Acquire();
+        Check(borrowed[0] != 0, "Failed to re-acquire a returned receiver");
+
+        // Borrowed receivers work like standalone ones, and keep working
+        // across repeated borrow/return cycles of the same slots.
+        for (int round = 0; round < 100; ++round)
+        {
+            Theron::Receiver *const receiver(borrowed[round % poolSize]);
+
+            framework.Send(round, receiver->GetAddress(), replier.GetAddress());
+            receiver->Wait();
+
+            pool.Release(receiver);
+            borrowed[round % poolSize] = pool.Acquire();
+            Check(borrowed[round % poolSize] != 0, "Failed to re-acquire a returned receiver");
+        }
+
+        for (Theron::uint32_t index = 0; index < poolSize; ++index)
+        {
+            pool.Release(borrowed[index]);
+        }
+    }
+
+    inline static void PoolWarmState()
+    {
+        const char *const warmStatePath("feature_test_pools.warm");
+
+        // Warm up the pool of the pooled message type, then save its state.
+        {
+            Theron::Framework framework;
+            Theron::Receiver receiver;
+
+            Theron::SetMessagePoolDepth<PooledMessage>(32);
+
+            Replier<PooledMessage> replier(framework);
+
+            for (int index = 0; index < 100; ++index)
+            {
+                PooledMessage message;
+                message.mValue = index;
+
+                framework.Send(message, receiver.GetAddress(), replier.GetAddress());
+                receiver.Wait();
+            }
+
+            Check(framework.SaveWarmState(warmStatePath), "Failed to save pool warm state");
+        }
+
+        // A framework constructed with the warm state path preheats the pools;
+        // message flow through the preheated pool works as normal.
+        {
+            Theron::Framework::Parameters params;
+            params.mWarmStatePath = warmStatePath;
+
+            Theron::Framework framework(params);
+            Theron::Receiver receiver;
+
+            Replier<PooledMessage> replier(framework);
+
+            for (int index = 0; index < 100; ++index)
+            {
+                PooledMessage message;
+                message.mValue = index;
+
+                framework.Send(message, receiver.GetAddress(), replier.GetAddress());
+                receiver.Wait();
+            }
+        }
+
+        // A missing warm state file is silently ignored.
+        {
+            Theron::Framework::Parameters params;
+            params.mWarmStatePath = "feature_test_missing.warm";
+
+            Theron::Framework framework(params);
+        }
+
+        remove(warmStatePath);
+        Theron::SetMessagePoolDepth<PooledMessage>(0);
+    }
+
+    inline static void CacheTrimming()
+    {
+        // A standalone cache, as wrapped around the low-level allocator by
+        // frameworks for message blocks.
+        Theron::Detail::CachingAllocator<32> cache;
+
+        // Populate one size-binned pool with freed blocks, marking it hot.
+        const Theron::uint32_t blockSize(160);
+        const Theron::uint32_t numBlocks(8);
+        void *blocks[numBlocks];
+
+        for (Theron::uint32_t index = 0; index < numBlocks; ++index)
+        {
+            blocks[index] = cache.Allocate(blockSize);
+            Check(blocks[index] != 0, "Cache allocation failed");
+        }
+
+        for (Theron::uint32_t index = 0; index < numBlocks; ++index)
+        {
+            cache.Free(blocks[index], blockSize);
+        }
+
+        // The first maintenance pass finds the pool hot and leaves it alone,
+        // clearing the flag to arm it for the next pass.
+        Check(cache.Trim(100) == 0, "Trimmed blocks from a hot pool");
+
+        // The pool wasn't used in between, so the second pass releases its
+        // blocks, bounded by the per-pass budget, resuming across calls.
+        Check(cache.Trim(3) == 3, "Trim released an unexpected number of blocks");
+        Check(cache.Trim(3) == 3, "Trim released an unexpected number of blocks");
+        Check(cache.Trim(100) == 2, "Trim released an unexpected number of blocks");
+        Check(cache.Trim(100) == 0, "Trim released blocks from an empty cache");
+
+        // Blocks freed into the uniform small-allocation slot stack are
+        // trimmed the same way: skipped while hot, released once cold.
+        void *const slot(cache.Allocate(16));
+        Check(slot != 0, "Cache allocation failed");
+        cache.Free(slot, 16);
+
+        Check(cache.Trim(100) == 0, "Trimmed blocks from a hot slot stack");
+        Check(cache.Trim(100) == 1, "Trim failed to release the cold slot");
+    }
+
+    inline static void DeadlineSendAndMissCounting()
+    {
+        typedef SlowReplier<int> SlowIntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // The replier sleeps for five milliseconds per message, so a message
+        // queued behind another can't be processed within a 1ms deadline.
+        SlowIntReplier replier(framework, 5);
+
+        // The first message occupies the actor; the second, sent with a 1ms
+        // deadline, waits out the handler sleep and so misses it.
+        Check(framework.Send(1, receiver.GetAddress(), replier.GetAddress()), "Send failed");
+        Check(framework.SendWithDeadline(2, receiver.GetAddress(), replier.GetAddress(), 1000), "Deadline send failed");
+
+        // A message with a generous deadline is processed well within it.
+        Check(framework.SendWithDeadline(3, receiver.GetAddress(), replier.GetAddress(), 60 * 1000 * 1000), "Deadline send failed");
+
+        receiver.Wait();
+        receiver.Wait();
+        receiver.Wait();
+
+        // Late messages are still delivered; lateness only shows in the counter.
+        Check(framework.GetCounterValue(Theron::COUNTER_DEADLINE_MISSES) == 1, "Wrong deadline miss count");
+    }
+
+    inline static void CrossFrameworkSendsAfterFrameworkRecreation()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // A single worker thread, so all sends from handlers share one
+        // per-thread cache of resolved framework lookups.
+        Theron::Framework sender(Theron::Framework::Parameters(1));
+
+        Theron::Framework *target(new Theron::Framework());
+        Forwarder *remote(new Forwarder(*target, receiver.GetAddress()));
+
+        {
+            Forwarder local(sender, remote->GetAddress());
+
+            // Repeated cross-framework sends from the worker thread populate
+            // and then reuse its cached resolution of the target framework.
+            for (uint32_t count = 0; count < 10; ++count)
+            {
+                sender.Send(int(2), receiver.GetAddress(), local.GetAddress());
+
+                receiver.Wait();
+                Check(catcher.mMessage == 0, "Received wrong message");
+            }
+        }
+
+        // Destroy the target framework and create a replacement, which may
+        // reuse its directory index; cached resolutions must not outlive it.
+        delete remote;
+        delete target;
+
+        target = new Theron::Framework();
+        remote = new Forwarder(*target, receiver.GetAddress());
+
+        {
+            Forwarder local(sender, remote->GetAddress());
+
+            sender.Send(int(2), receiver.GetAddress(), local.GetAddress());
+
+            receiver.Wait();
+            Check(catcher.mMessage == 0, "Received wrong message after recreation");
+        }
+
+        delete remote;
+        delete target;
+    }
+
+    inline static void FileStreamerZeroCopyChunks()
+    {
+        typedef Theron::Catcher<Theron::uint32_t> UIntCatcher;
+
+        const char *const fileName("filestreamer_test.dat");
+        const Theron::uint32_t fileSize(100000);
+
+        // Write a file of known contents for the streamer to read back.
+        FILE *const handle(fopen(fileName, "wb"));
+        Check(handle != 0, "Failed to create test file");
+
+        for (Theron::uint32_t index = 0; index < fileSize; ++index)
+        {
+            fputc(static_cast<int>(index & 0xFF), handle);
+        }
+
+        fclose(handle);
+
+        Theron::Receiver receiver;
+        UIntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &UIntCatcher::Push);
+
+        Theron::Framework framework;
+
+        // Stream in small chunks through a small in-flight window, so most of
+        // the stream is gated on the consumer's acknowledgements.
+        Theron::FileStreamer::Parameters params;
+        params.mChunkSize = 4096;
+        params.mMaxChunksInFlight = 2;
+
+        Theron::FileStreamer streamer(framework, params);
+        ChunkConsumer consumer(framework, receiver.GetAddress());
+
+        // Chunks are sent to the requester, so request on the consumer's behalf.
+        framework.Send(
+            Theron::FileStreamer::ReadRequest(fileName),
+            consumer.GetAddress(),
+            streamer.GetAddress());
+
+        receiver.Wait();
+
+        Theron::uint32_t received(0);
+        Theron::Address from;
+        Check(catcher.Pop(received, from), "No consumer report");
+        Check(received == fileSize, "Streamed contents didn't match the file");
+
+        // A request naming a missing file fails with a single failed chunk.
+        framework.Send(
+            Theron::FileStreamer::ReadRequest("filestreamer_missing.dat"),
+            consumer.GetAddress(),
+            streamer.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.Pop(received, from), "No failure report");
+        Check(received == 0xFFFFFFFF, "Missing file wasn't reported as failed");
+
+        remove(fileName);
+    }
+
+    inline static void StaticHandlerTableSharedByInstances()
+    {
+        typedef Theron::Catcher<int> IntCatcher;
+
+        Theron::HandlerTable table;
+        Check(table.Empty(), "New handler table isn't empty");
+
+        TableWorker::BuildHandlers(table);
+        Check(!table.Empty(), "Populated handler table reports empty");
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        // Both instances register their handlers by referencing the shared
+        // table, without building private handler sets.
+        TableWorker workerOne(framework, table);
+        TableWorker workerTwo(framework, table);
+
+        framework.Send(1, receiver.GetAddress(), workerOne.GetAddress());
+        framework.Send(10, receiver.GetAddress(), workerTwo.GetAddress());
+        receiver.Wait();
+        receiver.Wait();
+
+        int reply(0);
+        Theron::Address from;
+        int sum(0);
+
+        while (catcher.Pop(reply, from))
+        {
+            sum += reply;
+        }
+
+        Check(sum == 13, "Shared-table handlers produced wrong replies");
+
+        // Asking workerOne to swap its integer handler diverges it from the
+        // shared table; workerTwo stays on the shared handler set.
+        framework.Send(1.0f, receiver.GetAddress(), workerOne.GetAddress());
+        receiver.Wait();
+
+        framework.Send(5, receiver.GetAddress(), workerOne.GetAddress());
+        framework.Send(20, receiver.GetAddress(), workerTwo.GetAddress());
+        receiver.Wait();
+        receiver.Wait();
+
+        sum = 0;
+        while (catcher.Pop(reply, from))
+        {
+            sum += reply;
+        }
+
+        Check(sum == 31, "Diverged instance affected the shared handler set");
+    }
+
+    inline static void HandlerBudgetPreemption()
+    {
+        typedef SlowReplier<int> SlowIntReplier;
+        typedef Theron::Catcher<int> IntCatcher;
+
+        Theron::Framework::Parameters params(2);
+        params.mMessageBatchSize = 16;
+        params.mHandlerBudgetMicroseconds = 1000;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        // Each handler invocation overruns the budget, so every batch is cut
+        // short and the mailbox re-queued; no messages may be lost by that.
+        {
+            SlowIntReplier replier(framework, 2);
+
+            for (int index = 0; index < 5; ++index)
+            {
+                framework.Send(index, receiver.GetAddress(), replier.GetAddress());
+            }
+
+            for (int index = 0; index < 5; ++index)
+            {
+                receiver.Wait();
+            }
+        }
+
+        int received(0);
+        Theron::Address from;
+        while (catcher.Pop(received, from))
+        {
+        }
+
+        // A cooperative handler checkpoints whenever it sees the budget
+        // exceeded; each 2ms work unit overruns the 1ms budget, so the
+        // worker yields between every pair of consecutive units.
+        BudgetedWorker worker(framework, receiver.GetAddress());
+        framework.Send(5, Theron::Address::Null(), worker.GetAddress());
+
+        receiver.Wait();
+        Check(catcher.Pop(received, from), "No completion report received");
+        Check(received == 4, "Worker didn't checkpoint between work units");
+    }
+
+    inline static void CrossNodeStealCounter()
+    {
+        typedef Replier<int> IntReplier;
+
+        // The default node mask binds all the workers to node zero, so any
+        // steals between them are same-node and the cross-node counter must
+        // stay zero however the work gets distributed.
+        Theron::Framework framework(Theron::Framework::Parameters(4));
+        Theron::Receiver receiver;
+        IntReplier replier(framework);
+
+        for (int index = 0; index < 200; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), replier.GetAddress());
+        }
+
+        for (int index = 0; index < 200; ++index)
+        {
+            receiver.Wait();
+        }
+
+        Check(framework.GetCounterValue(Theron::COUNTER_CROSS_NODE_STEALS) == 0, "Cross-node steal counted on a single node");
+    }
+
+    inline static void SchedulerPolicySelection()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Each policy must deliver and process every message; the policies
+        // only reorder the processing of different mailboxes relative to
+        // each other, which this test makes no assumptions about.
+        const Theron::SchedulerPolicy policies[3] =
+        {
+            Theron::SCHEDULER_POLICY_DEFAULT,
+            Theron::SCHEDULER_POLICY_FIFO,
+            Theron::SCHEDULER_POLICY_LOCALITY
+        };
+
+        for (int policy = 0; policy < 3; ++policy)
+        {
+            Theron::Framework::Parameters params(4);
+            params.mSchedulerPolicy = policies[policy];
+
+            Theron::Framework framework(params);
+            Theron::Receiver receiver;
+            IntReplier replierOne(framework);
+            IntReplier replierTwo(framework);
+
+            for (int index = 0; index < 100; ++index)
+            {
+                framework.Send(index, receiver.GetAddress(), replierOne.GetAddress());
+                framework.Send(index, receiver.GetAddress(), replierTwo.GetAddress());
+            }
+
+            for (int index = 0; index < 200; ++index)
+            {
+                receiver.Wait();
+            }
+        }
+    }
+
+#if THERON_ACTOR_STORE_SIZE
+
+    inline static void ColocatedActorCreation()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // Legacy-style creation is the framework-constructed path, so an
+        // actor that fits the mailbox store is placed in the store of its
+        // own mailbox. The placement is transparent; this checks the actor
+        // works and is destroyed cleanly through the ActorRef.
+        {
+            Theron::ActorRef echo(framework.CreateActor<LegacyEcho>());
+
+            for (int index = 0; index < 10; ++index)
+            {
+                framework.Send(index, receiver.GetAddress(), echo.GetAddress());
+                receiver.Wait();
+            }
+        }
+
+        // An actor too large for the store takes the ordinary heap path.
+        {
+            Theron::ActorRef bulky(framework.CreateActor<BulkyLegacyEcho>());
+
+            framework.Send(0, receiver.GetAddress(), bulky.GetAddress());
+            receiver.Wait();
+        }
+    }
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+    inline static void AnonymousActorAddresses()
+    {
+        typedef Replier<int> IntReplier;
+        typedef Theron::Catcher<int> IntCatcher;
+
+        // In a framework with no network endpoint, unnamed actors are
+        // anonymous: no name is generated for them and their addresses
+        // carry a null string, yet they remain distinct and reachable.
+        Theron::Framework framework;
+
+        IntReplier replierOne(framework);
+        IntReplier replierTwo(framework);
+        IntReplier named(framework, "anonymous_test_named_replier");
+
+        Check(replierOne.GetAddress().AsString() == 0, "Anonymous actor has a generated name");
+        Check(replierTwo.GetAddress().AsString() == 0, "Anonymous actor has a generated name");
+        Check(named.GetAddress().AsString() != 0, "Named actor lost its name");
+
+        // Nameless addresses compare by index, so distinct anonymous actors
+        // have unequal addresses and none of them equals the null address.
+        Check(replierOne.GetAddress() != replierTwo.GetAddress(), "Anonymous addresses compare equal");
+        Check(replierOne.GetAddress() != Theron::Address::Null(), "Anonymous address equals the null address");
+        Check(replierOne.GetAddress() != named.GetAddress(), "Anonymous address equals a named address");
+        Check(replierOne.GetAddress() == replierOne.GetAddress(), "Anonymous address not equal to itself");
+
+        // Anonymous addresses are usable as both 'to' and 'from' addresses,
+        // and round-trip through messages intact.
+        IntCatcher catcher;
+        Theron::Receiver receiver;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        framework.Send(5, receiver.GetAddress(), replierOne.GetAddress());
+        framework.Send(6, receiver.GetAddress(), replierTwo.GetAddress());
+        receiver.Wait();
+        receiver.Wait();
+
+        int message(0);
+        Theron::Address from;
+
+        while (catcher.Pop(message, from))
+        {
+            if (message == 5)
+            {
+                Check(from == replierOne.GetAddress(), "Reply from wrong anonymous actor");
+            }
+            else
+            {
+                Check(message == 6, "Received unexpected message value");
+                Check(from == replierTwo.GetAddress(), "Reply from wrong anonymous actor");
+            }
+        }
+    }
+
+    inline static void BatcherFlushThresholds()
+    {
+        typedef Theron::Batcher<int> IntBatcher;
+        typedef Theron::Catcher<IntBatcher::Batch> BatchCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        BatchCatcher catcher;
+
+        receiver.RegisterHandler(&catcher, &BatchCatcher::Push);
+
+        IntBatcher::Batch batch;
+        Theron::Address from;
+
+        // Size-driven flush: a period of a minute can't elapse during the
+        // test, so the flush must be triggered by the batch filling.
+        {
+            IntBatcher batcher(framework, receiver.GetAddress(), 4, 60 * 1000 * 1000);
+
+            for (int index = 0; index < 4; ++index)
+            {
+                framework.Send(index, receiver.GetAddress(), batcher.GetAddress());
+            }
+
+            receiver.Wait();
+
+            Check(catcher.Pop(batch, from), "No batch received from full batcher");
+            Check(from == batcher.GetAddress(), "Batch received from wrong address");
+            Check(batch.GetCount() == 4, "Size-driven batch has wrong size");
+
+            for (int index = 0; index < 4; ++index)
+            {
+                Check(batch.GetValues()[index] == index, "Batch values out of order");
+            }
+        }
+
+        // Timer-driven flush: the batch size can't be reached, so the flush
+        // must be triggered by the flush period elapsing.
+        {
+            IntBatcher batcher(framework, receiver.GetAddress(), 100, 50 * 1000);
+
+            framework.Send(7, receiver.GetAddress(), batcher.GetAddress());
+            framework.Send(8, receiver.GetAddress(), batcher.GetAddress());
+
+            receiver.Wait();
+
+            Check(catcher.Pop(batch, from), "No batch received from timed batcher");
+            Check(batch.GetCount() == 2, "Timer-driven batch has wrong size");
+            Check(batch.GetValues()[0] == 7 && batch.GetValues()[1] == 8, "Batch values out of order");
+        }
+
+        // Release the shared buffer before the allocator checks for leaks.
+        batch = IntBatcher::Batch();
+    }
+
+    inline static void IngressThrottleSmoothing()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Rate-limit external sends to 1000 per second with a burst of 10.
+        Theron::Framework::Parameters params(2);
+        params.mIngressTokensPerSecond = 1000;
+        params.mIngressBurstLimit = 10;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+        IntReplier replier(framework);
+
+        const Theron::uint64_t startTime(Theron::Detail::ProfileClock::GetMicroseconds());
+
+        // The first 10 sends are admitted as a burst; the remaining 20 are
+        // paced at the steady rate of one per millisecond, so the loop can't
+        // complete faster than the pacing allows.
+        for (int index = 0; index < 30; ++index)
+        {
+            framework.Send(index, receiver.GetAddress(), replier.GetAddress());
+        }
+
+        const Theron::uint64_t elapsed(Theron::Detail::ProfileClock::GetMicroseconds() - startTime);
+        Check(elapsed >= 10 * 1000, "Throttled sends completed faster than the rate allows");
+
+        for (int index = 0; index < 30; ++index)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void MessageFlowSampling()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Tag every send from non-actor code with a new causality flow ID.
+        // The IDs ride in the message envelopes whether or not scheduler
+        // tracing is compiled in, so this exercises tagging at the flow roots
+        // and inheritance through the repliers' handler sends.
+        Theron::Framework::Parameters params(2);
+        params.mFlowSamplingRatio = 1;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        IntReplier first(framework);
+        IntReplier second(framework);
+
+        for (int index = 0; index < 100; ++index)
+        {
+            Check(framework.Send(index, receiver.GetAddress(), first.GetAddress()), "Send failed");
+            Check(framework.Send(index, receiver.GetAddress(), second.GetAddress()), "Send failed");
+        }
+
+        for (int index = 0; index < 200; ++index)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void MessageStashing()
+    {
+        typedef Theron::Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        Stasher stasher(framework, receiver.GetAddress());
+
+        // All sent from this one thread to one mailbox, so delivered in order.
+        // The value sent before the lock passes straight through; the two sent
+        // while locked are stashed, and released by the unlock ahead of the
+        // value sent after it.
+        framework.Send(9, receiver.GetAddress(), stasher.GetAddress());
+        framework.Send(Stasher::Lock(), receiver.GetAddress(), stasher.GetAddress());
+        framework.Send(0, receiver.GetAddress(), stasher.GetAddress());
+        framework.Send(1, receiver.GetAddress(), stasher.GetAddress());
+        framework.Send(Stasher::Unlock(), receiver.GetAddress(), stasher.GetAddress());
+        framework.Send(2, receiver.GetAddress(), stasher.GetAddress());
+
+        for (int index = 0; index < 4; ++index)
+        {
+            receiver.Wait();
+        }
+
+        int message(0);
+        Theron::Address from;
+
+        Check(catcher.Pop(message, from) && message == 9, "Pre-lock value wasn't forwarded first");
+        Check(catcher.Pop(message, from) && message == 0, "First stashed value wasn't replayed in order");
+        Check(catcher.Pop(message, from) && message == 1, "Second stashed value wasn't replayed in order");
+        Check(catcher.Pop(message, from) && message == 2, "Post-unlock value overtook the replayed stash");
+    }
+
+    inline static void ParallelMailboxTeardown()
+    {
+        // Populate enough mailbox pages that framework destruction tears the
+        // directory down on helper threads, then check a populated framework
+        // still shuts down cleanly. The actor count spans several times the
+        // per-thread page minimum, so the parallel path is actually taken.
+        const Theron::uint32_t count(20000);
+
+        Theron::Framework::Parameters params;
+        params.mThreadCount = 2;
+        params.mExpectedActorCount = count;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        Replier<int> **const actors = new Replier<int> *[count];
+        for (Theron::uint32_t index = 0; index < count; ++index)
+        {
+            actors[index] = new Replier<int>(framework);
+        }
+
+        // Prove the framework is live with the population registered.
+        framework.Send(0, receiver.GetAddress(), actors[count - 1]->GetAddress());
+        receiver.Wait();
+
+        for (Theron::uint32_t index = 0; index < count; ++index)
+        {
+            delete actors[index];
+        }
+
+        delete [] actors;
+    }
+
+    inline static void CatcherRingGrowth()
+    {
+        typedef Theron::Catcher<int> IntCatcher;
+
+        IntCatcher catcher;
+        int message(0);
+        Theron::Address from;
+
+        Check(catcher.Empty(), "Catcher not empty initially");
+        Check(!catcher.Pop(message, from), "Pop succeeded on an empty catcher");
+
+        // Interleave pushes and pops so the ring buffer wraps, then push far
+        // past its inline capacity so the contiguous storage has to grow.
+        for (int index = 0; index < 10; ++index)
+        {
+            catcher.Push(index, Theron::Address::Null());
+        }
+
+        for (int index = 0; index < 5; ++index)
+        {
+            Check(catcher.Pop(message, from), "Catcher lost a message");
+            Check(message == index, "Catcher returned messages out of order");
+        }
+
+        for (int index = 10; index < 100; ++index)
+        {
+            catcher.Push(index, Theron::Address::Null());
+        }
+
+        Check(catcher.Front(message, from), "Front failed on a non-empty catcher");
+        Check(message == 5, "Front returned the wrong message");
+
+        for (int index = 5; index < 100; ++index)
+        {
+            Check(catcher.Pop(message, from), "Catcher lost a message");
+            Check(message == index, "Catcher returned messages out of order");
+        }
+
+        Check(catcher.Empty(), "Catcher not empty after draining");
+    }
+
+    inline static void ConflatableMessages()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        SnapshotConsumer consumer(framework, receiver.GetAddress());
+
+        // The actor queues a burst of snapshots to itself, all of which arrive
+        // while the mailbox is backed up, so they conflate down to the newest.
+        const int burstCount(25);
+        framework.Send(burstCount, receiver.GetAddress(), consumer.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+
+        int snapshotsSeen(0);
+        int lastValue(0);
+        Theron::Address from;
+
+        Check(catcher.Pop(snapshotsSeen, from), "No snapshot count received");
+        Check(catcher.Pop(lastValue, from), "No snapshot value received");
+
+        Check(snapshotsSeen == 1, "Burst of conflatable snapshots wasn't conflated to one");
+        Check(lastValue == burstCount - 1, "Conflation delivered a stale snapshot");
+    }
+
+    inline static void MessageTypeStatsQuery()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        IntReplier replier(framework);
+
+        for (int count = 0; count < 8; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+        }
+
+        for (int count = 0; count < 8; ++count)
+        {
+            receiver.Wait();
+        }
+
+        Theron::MessageTypeStats stats;
+        const bool enabled(framework.GetMessageTypeStats(stats));
+
+#if THERON_ENABLE_MESSAGE_STATS
+
+        Check(enabled, "Statistics query failed with statistics enabled");
+
+        Theron::uint64_t totalSent(0);
+        Theron::uint64_t totalProcessed(0);
+
+        for (Theron::uint32_t typeId = 0; typeId < Theron::MessageTypeStats::MAX_TYPES; ++typeId)
+        {
+            totalSent += stats.mTypes[typeId].mSentCount;
+            totalProcessed += stats.mTypes[typeId].mProcessedCount;
+        }
+
+        // The framework saw the eight requests and the eight replies.
+        Check(totalSent >= 16, "Statistics report missing sent messages");
+        Check(totalProcessed >= 8, "Statistics report missing processed messages");
+
+#else
+
+        // Message statistics are disabled by default so no tallies exist.
+        Check(!enabled, "GetMessageTypeStats should return false when statistics are disabled");
+        Check(stats.mTypes[0].mSentCount == 0, "Statistics report should be zeroed when disabled");
+
+#endif // THERON_ENABLE_MESSAGE_STATS
+    }
+
+    inline static void AllocatorCacheStatsQuery()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        IntReplier replier(framework);
+
+        for (int count = 0; count < 8; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+        }
+
+        for (int count = 0; count < 8; ++count)
+        {
+            receiver.Wait();
+        }
+
+        Theron::AllocatorCacheStats stats;
+        framework.GetAllocatorCacheStats(stats);
+
+        // The caches serve small allocations from uniform slots, so the report
+        // describes the slot stacks and their configured depth.
+        Check(stats.mSlotSize != 0, "Statistics report missing the slot size");
+        Check(stats.mMaxSlots != 0, "Statistics report missing the slot stack depth");
+
+        // The message traffic allocated small blocks, so the slot stacks saw
+        // activity, and the cold caches fell back to the wrapped allocator for
+        // at least the first block of each size.
+        Check(stats.mSlotHits + stats.mSlotMisses != 0, "Statistics report missing slot stack activity");
+        Check(stats.mFallbackAllocations != 0, "Statistics report missing fallback allocations");
+    }
+
+    inline static void YieldStrategyHotSwap()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Start under the adaptive strategy, then swap through the fixed
+        // strategies while traffic flows, checking delivery stays intact.
+        Theron::Framework::Parameters params;
+        params.mYieldStrategy = Theron::YIELD_STRATEGY_ADAPTIVE;
+
+        Theron::Framework framework(params);
+        Theron::Receiver receiver;
+
+        IntReplier replier(framework);
+
+        const Theron::YieldStrategy strategies[] =
+        {
+            Theron::YIELD_STRATEGY_ADAPTIVE,
+            Theron::YIELD_STRATEGY_AGGRESSIVE,
+            Theron::YIELD_STRATEGY_BLOCKING,
+            Theron::YIELD_STRATEGY_POLITE
+        };
+
+        for (Theron::uint32_t phase = 0; phase < 4; ++phase)
+        {
+            framework.SetYieldStrategy(strategies[phase]);
+
+            for (int count = 0; count < 50; ++count)
+            {
+                framework.Send(count, receiver.GetAddress(), replier.GetAddress());
+            }
+
+            Theron::uint32_t outstandingCount(50);
+            while (outstandingCount)
+            {
+                outstandingCount -= receiver.Wait(outstandingCount);
+            }
+        }
+    }
+
+    inline static void BurstPush()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        IntReplier replier(framework);
+
+        // Reinject a recorded burst through the array overload; the replies
+        // confirm every value of the burst was delivered.
+        const Theron::uint32_t burstSize(256);
+        int values[burstSize];
+
+        for (Theron::uint32_t index = 0; index < burstSize; ++index)
+        {
+            values[index] = static_cast<int>(index);
+        }
+
+        Check(
+            replier.Push(values, burstSize, receiver.GetAddress()) == burstSize,
+            "Burst push accepted fewer values than expected");
+
+        Theron::uint32_t outstandingCount(burstSize);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // The iterator-pair overload pushes the same burst from a range.
+        std::vector<int> recorded(values, values + burstSize);
+
+        Check(
+            replier.Push(recorded.begin(), recorded.end(), receiver.GetAddress()) == burstSize,
+            "Range burst push accepted fewer values than expected");
+
+        outstandingCount = burstSize;
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // Both bursts should have arrived in full, with their values intact.
+        int reply(0);
+        Theron::Address from;
+        Theron::uint32_t numReplies(0);
+        int replySum(0);
+
+        while (catcher.Pop(reply, from))
+        {
+            ++numReplies;
+            replySum += reply;
+        }
+
+        Check(numReplies == 2 * burstSize, "Burst push replies lost");
+        Check(replySum == 2 * (255 * 256 / 2), "Burst push replies have unexpected values");
+    }
+
+    inline static void FrameworkSendBatch()
+    {
+        typedef Replier<int> IntReplier;
+        typedef Replier<float> FloatReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        IntReplier replier(framework);
+
+        // Send a chunk of events through the homogeneous batch overload.
+        const Theron::uint32_t batchSize(100);
+        int values[batchSize];
+
+        for (Theron::uint32_t index = 0; index < batchSize; ++index)
+        {
+            values[index] = static_cast<int>(index);
+        }
+
+        Check(
+            framework.SendBatch(values, batchSize, receiver.GetAddress(), replier.GetAddress()) == batchSize,
+            "Batch send accepted fewer values than expected");
+
+        Theron::uint32_t outstandingCount(batchSize);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        int reply(0);
+        Theron::Address from;
+        Theron::uint32_t numReplies(0);
+        int replySum(0);
+
+        while (catcher.Pop(reply, from))
+        {
+            ++numReplies;
+            replySum += reply;
+        }
+
+        Check(numReplies == batchSize, "Batch send replies lost");
+        Check(replySum == (99 * 100 / 2), "Batch send replies have unexpected values");
+
+        // The heterogeneous overload delivers pre-built envelopes of mixed types.
+        Theron::Catcher<float> floatCatcher;
+        receiver.RegisterHandler(&floatCatcher, &Theron::Catcher<float>::Push);
+
+        FloatReplier floatReplier(framework);
+
+        Theron::Detail::IMessage *envelopes[2];
+        envelopes[0] = framework.CreateEnvelope(5.0f, receiver.GetAddress());
+        envelopes[1] = framework.CreateEnvelope(6.0f, receiver.GetAddress());
+
+        Check(envelopes[0] != 0 && envelopes[1] != 0, "Envelope allocation failed");
+
+        Check(
+            framework.SendBatch(envelopes, 2, floatReplier.GetAddress()) == 2,
+            "Envelope batch send delivered fewer envelopes than expected");
+
+        outstandingCount = 2;
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        float floatReply(0.0f);
+        float floatSum(0.0f);
+
+        while (floatCatcher.Pop(floatReply, from))
+        {
+            floatSum += floatReply;
+        }
+
+        Check(floatSum == 11.0f, "Envelope batch replies have unexpected values");
+
+        // An envelope batch of mixed types addressed to a receiver takes the
+        // generic per-message path, since receivers live outside the framework.
+        Theron::Detail::IMessage *mixedEnvelopes[2];
+        mixedEnvelopes[0] = framework.CreateEnvelope(7, receiver.GetAddress());
+        mixedEnvelopes[1] = framework.CreateEnvelope(8.0f, receiver.GetAddress());
+
+        Check(
+            framework.SendBatch(mixedEnvelopes, 2, receiver.GetAddress()) == 2,
+            "Mixed envelope batch send delivered fewer envelopes than expected");
+
+        outstandingCount = 2;
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        Check(catcher.Pop(reply, from) && reply == 7, "Mixed envelope batch lost the int");
+        Check(floatCatcher.Pop(floatReply, from) && floatReply == 8.0f, "Mixed envelope batch lost the float");
+
+        receiver.DeregisterHandler(&floatCatcher, &Theron::Catcher<float>::Push);
+    }
+
+    inline static void SendBatchFanOut()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // Fan a batch of interleaved envelopes out over several destinations.
+        const Theron::uint32_t numRepliers(3);
+        const Theron::uint32_t batchSize(30);
+
+        IntReplier replierOne(framework);
+        IntReplier replierTwo(framework);
+        IntReplier replierThree(framework);
+        IntReplier *const repliers[numRepliers] = { &replierOne, &replierTwo, &replierThree };
+
+        Theron::Detail::IMessage *envelopes[batchSize];
+        Theron::Address addresses[batchSize];
+
+        for (Theron::uint32_t index = 0; index < batchSize; ++index)
+        {
+            envelopes[index] = framework.CreateEnvelope(static_cast<int>(index), receiver.GetAddress());
+            addresses[index] = repliers[index % numRepliers]->GetAddress();
+
+            Check(envelopes[index] != 0, "Envelope allocation failed");
+        }
+
+        Check(
+            framework.SendBatch(envelopes, addresses, batchSize) == batchSize,
+            "Fan-out batch send delivered fewer envelopes than expected");
+
+        Theron::uint32_t outstandingCount(batchSize);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // The grouping is stable, so each destination processes its envelopes
+        // in batch order: the replies from any one replier arrive ascending.
+        int lastValues[numRepliers] = { -1, -1, -1 };
+        Theron::uint32_t numReplies(0);
+
+        int reply(0);
+        Theron::Address from;
+
+        while (catcher.Pop(reply, from))
+        {
+            Theron::uint32_t replierIndex(0);
+            while (replierIndex < numRepliers && repliers[replierIndex]->GetAddress() != from)
+            {
+                ++replierIndex;
+            }
+
+            Check(replierIndex < numRepliers, "Fan-out batch reply from unknown address");
+            Check(static_cast<Theron::uint32_t>(reply) % numRepliers == replierIndex, "Fan-out batch reply misrouted");
+            Check(reply > lastValues[replierIndex], "Fan-out batch replies out of order per destination");
+
+            lastValues[replierIndex] = reply;
+            ++numReplies;
+        }
+
+        Check(numReplies == batchSize, "Fan-out batch replies lost");
+    }
+
+    inline static void UrgentMessages()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        UrgentSignaller signaller(framework, receiver.GetAddress());
+
+        // The actor queues bulk work to itself, then a cancellation last.
+        const int bulkCount(10);
+        framework.Send(bulkCount, receiver.GetAddress(), signaller.GetAddress());
+
+        Theron::uint32_t outstandingCount(static_cast<Theron::uint32_t>(bulkCount) + 1);
+        while (outstandingCount)
+        {
+            outstandingCount -= receiver.Wait(outstandingCount);
+        }
+
+        // The cancellation was queued behind the bulk work but its type is
+        // registered urgent, so it must be the first message delivered.
+        int marker(-1);
+        Theron::Address from;
+
+        Check(catcher.Pop(marker, from), "No markers received");
+        Check(marker == 1, "Urgent message didn't jump the queued bulk work");
+
+        Theron::uint32_t numBulkMarkers(0);
+        while (catcher.Pop(marker, from))
+        {
+            Check(marker == 0, "Unexpected marker value");
+            ++numBulkMarkers;
+        }
+
+        Check(numBulkMarkers == static_cast<Theron::uint32_t>(bulkCount), "Bulk markers lost");
+    }
+
+    inline static void AsyncActorCreation()
+    {
+        Theron::Framework framework;
+        Theron::Receiver client;
+
+        Theron::Catcher<Theron::ActorCreatedEvent> catcher;
+        client.RegisterHandler(&catcher, &Theron::Catcher<Theron::ActorCreatedEvent>::Push);
+
+        // Request construction of a replier on a worker thread, with a context
+        // value echoed in the completion event for correlation.
+        int sessionId(42);
+        Check(framework.CreateActorAsync<Replier<int> >(client.GetAddress(), &sessionId), "CreateActorAsync failed");
+        client.Wait();
+
+        Theron::ActorCreatedEvent event;
+        Theron::Address from;
+        Check(catcher.Pop(event, from), "No completion event received");
+        Check(event.mActor != 0, "Completion event carries no actor");
+        Check(event.mAddress != Theron::Address::Null(), "Completion event carries no address");
+        Check(event.mContext == &sessionId, "Completion event context not echoed");
+
+        // The constructed actor should be fully operational.
+        Theron::Receiver replyReceiver;
+        Theron::Catcher<int> replyCatcher;
+        replyReceiver.RegisterHandler(&replyCatcher, &Theron::Catcher<int>::Push);
+
+        framework.Send(5, replyReceiver.GetAddress(), event.mAddress);
+        replyReceiver.Wait();
+
+        int reply(0);
+        Check(replyCatcher.Pop(reply, from), "No reply from created actor");
+        Check(reply == 5, "Wrong reply from created actor");
+
+        // The receiver of the completion event owns the constructed actor.
+        delete event.mActor;
+    }
+
+    inline static void DelayedAndPeriodicSends()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // Send a delayed message directly to the receiver; one millisecond delay.
+        Check(framework.SendAfter(1, receiver.GetAddress(), receiver.GetAddress(), 1000), "SendAfter failed");
+        receiver.Wait();
+
+        // A delayed message should also pass through an actor like any other.
+        Replier<int> replier(framework);
+        Check(framework.SendAfter(2, receiver.GetAddress(), replier.GetAddress(), 1000), "SendAfter to actor failed");
+        receiver.Wait();
+
+        // A periodic send should keep delivering fresh copies of the message.
+        Check(framework.SendEvery(3, receiver.GetAddress(), receiver.GetAddress(), 1000), "SendEvery failed");
+        receiver.Wait();
+        receiver.Wait();
+        receiver.Wait();
+    }
+
+    inline static void TailSendPipeline()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        // Build a pipeline of actors, each forwarding to the next with TailSend.
+        TailForwarder last(framework, receiver.GetAddress());
+        TailForwarder third(framework, last.GetAddress());
+        TailForwarder second(framework, third.GetAddress());
+        TailForwarder first(framework, second.GetAddress());
+
+        // Every message should pass down the whole pipeline to the receiver.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), first.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+    inline static void BlockingYieldStrategy()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework::Parameters params;
+        params.mYieldStrategy = Theron::YIELD_STRATEGY_BLOCKING;
+
+        Theron::Framework framework(params);
+        IntReplier actor(framework);
+
+        Theron::Receiver receiver;
+
+        // Space the sends out so workers block between them and are woken on demand.
+        for (int count = 0; count < 10; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+            receiver.Wait();
+        }
+
+        // Also send a burst to wake multiple sleeping workers.
+        for (int count = 0; count < 100; ++count)
+        {
+            framework.Send(count, receiver.GetAddress(), actor.GetAddress());
+        }
+
+        for (int count = 0; count < 100; ++count)
+        {
+            receiver.Wait();
+        }
+    }
+
+#if THERON_CPP11
+    inline static void MoveSemanticsSend()
+    {
+        typedef std::vector<int> VectorMessage;
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+        VectorMover mover(framework);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        // The vector is passed as an rvalue so is moved into the message rather than copied.
+        VectorMessage vectorMessage(100, 5);
+        framework.Send(std::move(vectorMessage), receiver.GetAddress(), mover.GetAddress());
+
+        receiver.Wait();
+
+        Check(catcher.mMessage == 100, "Moved message contents lost");
+        Check(catcher.mFrom == mover.GetAddress(), "Caught from address wrong");
+    }
+    inline static void StaticDispatch()
+    {
+        typedef Catcher<int> IntCatcher;
+        typedef Catcher<float> FloatCatcher;
+        typedef Catcher<double> DoubleCatcher;
+
+        Theron::Framework framework;
+        StaticReplier actor(framework);
+
+        Theron::Receiver receiver;
+        IntCatcher intCatcher;
+        FloatCatcher floatCatcher;
+        DoubleCatcher doubleCatcher;
+        receiver.RegisterHandler(&intCatcher, &IntCatcher::Catch);
+        receiver.RegisterHandler(&floatCatcher, &FloatCatcher::Catch);
+        receiver.RegisterHandler(&doubleCatcher, &DoubleCatcher::Catch);
+
+        // Messages of statically listed types are dispatched at compile time.
+        framework.Send(int(5), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(intCatcher.mMessage == 5, "Static int dispatch failed");
+
+        framework.Send(float(7.0f), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(floatCatcher.mMessage == 7.0f, "Static float dispatch failed");
+
+        // Messages of unlisted types fall back to the dynamically registered handlers.
+        framework.Send(double(9.0), receiver.GetAddress(), actor.GetAddress());
+        receiver.Wait();
+        Check(doubleCatcher.mMessage == 9.0, "Dynamic fallback dispatch failed");
+    }
+
+    inline static void LambdaHandlers()
+    {
+        typedef Catcher<int> IntCatcher;
+
+        Theron::Framework framework;
+
+        // Two instances of the same class, each with its own captured state.
+        LambdaAccumulator plainAccumulator(framework, 0);
+        LambdaAccumulator biasedAccumulator(framework, 10);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Catch);
+
+        framework.Send(int(1), receiver.GetAddress(), plainAccumulator.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == 1, "Lambda handler didn't run");
+
+        framework.Send(int(2), receiver.GetAddress(), plainAccumulator.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == 3, "Mutable lambda didn't accumulate captured state");
+
+        // The second instance's handler captured its own state and bias.
+        framework.Send(int(1), receiver.GetAddress(), biasedAccumulator.GetAddress());
+        receiver.Wait();
+        Check(catcher.mMessage == 11, "Per-instance captured state wasn't independent");
+    }
+#endif // THERON_CPP11
+
+    inline static void ThreadCountApi()
+    {
+        Theron::Framework framework;
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        // Create more worker threads.
+        framework.SetMinThreads(32);
+        Check(framework.GetMinThreads() >= 32, "GetMinThreads failed");
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        // Stop most of the threads.
+        framework.SetMaxThreads(8);
+        Check(framework.GetMaxThreads() <= 8, "GetMaxThreads failed");
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        // Re-start all of the threads and create some more.
+        framework.SetMinThreads(64);
+        Check(framework.GetMinThreads() >= 64, "GetMinThreads failed");
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        // Stop all threads but one.
+        framework.SetMaxThreads(1);
+        Check(framework.GetMaxThreads() <= 1, "GetMaxThreads failed");
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        Check(framework.GetPeakThreads() >= 1, "GetPeakThreads failed");
+        Check(framework.GetNumThreads() >= 1, "GetNumThreads failed");
+        Check(framework.GetPeakThreads() >= framework.GetNumThreads(), "GetPeakThreads failed");
+    }
+
+    inline static void BlockingSectionReplacesWorker()
+    {
+        typedef Theron::Catcher<int> IntCatcher;
+
+        // One worker thread, with headroom for one replacement.
+        Theron::Framework framework(1);
+        framework.SetMaxThreads(2);
+
+        Theron::Receiver receiver;
+        IntCatcher catcher;
+        receiver.RegisterHandler(&catcher, &IntCatcher::Push);
+
+        Theron::Detail::Atomic::UInt32 entered(0);
+        Theron::Detail::Atomic::UInt32 flag(0);
+
+        SectionBlocker blocker(framework, &entered, &flag);
+        FlagSetter setter(framework, &flag);
+
+        // Park the single worker inside a blocking section.
+        framework.Send(int(0), receiver.GetAddress(), blocker.GetAddress());
+        while (entered.Load() == 0)
+        {
+            Theron::Detail::Utils::SleepThread(1);
+        }
+
+        // With the worker parked, only a replacement worker can run the
+        // setter, whose handler releases the blocker by setting the flag.
+        framework.Send(int(0), receiver.GetAddress(), setter.GetAddress());
+
+        receiver.Wait();
+        receiver.Wait();
+
+        int result(0);
+        Theron::Address from;
+        while (catcher.Pop(result, from))
+        {
+            if (from == blocker.GetAddress())
+            {
+                Check(result == 1, "Message wasn't processed while the worker was parked in a blocking section");
+            }
+        }
+
+        // With the blocking section over, the replacement worker is retired.
+        Theron::uint32_t waited(0);
+        while (framework.GetNumThreads() > 1 && waited < 1000)
+        {
+            Theron::Detail::Utils::SleepThread(1);
+            ++waited;
+        }
+
+        Check(framework.GetNumThreads() <= 1, "Replacement worker wasn't retired after the blocking section");
+    }
+
+    inline static void EventCounterApi()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::Detail::Utils::SleepThread(10);
+
+        // Check initial values.
+        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) == 0, "GetCounterValue failed");
+
+        uint32_t counterValues[32];
+        uint32_t valueCount(framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32));
+
+        uint32_t messagesProcessed(0);
+        for (uint32_t index = 0; index < valueCount; ++index)
+        {
+            messagesProcessed += counterValues[index];
+        }
+
+        Check(messagesProcessed == 0, "GetPerThreadCounterValues failed");
+
+        IntReplier replier(framework);
+        framework.Send(int(0), receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+
+        // Check values after some work.
+        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) > 0, "GetCounterValue failed");
+
+        valueCount = framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32);
+
+        messagesProcessed = 0;
+        for (uint32_t index = 0; index < valueCount; ++index)
+        {
+            messagesProcessed += counterValues[index];
+        }
+
+        Check(messagesProcessed == 1, "GetPerThreadCounterValues failed");
+
+        // Scheduling the request pushed the replier's mailbox onto a work queue.
+        // The request was sent from a non-worker thread, so went via the shared queue.
+        Check(framework.GetCounterValue(Theron::COUNTER_SHARED_PUSHES) >= 1, "shared push counter failed");
+        Check(framework.GetCounterValue(Theron::COUNTER_PEAK_SHARED_QUEUE_DEPTH) >= 1, "peak queue depth counter failed");
+
+        // Check values after reset.
+        framework.ResetCounters();
+
+        Check(framework.GetCounterValue(Theron::COUNTER_SHARED_PUSHES) == 0, "GetCounterValue failed");
+        Check(framework.GetCounterValue(Theron::COUNTER_PEAK_SHARED_QUEUE_DEPTH) == 0, "GetCounterValue failed");
+
+        Check(framework.GetCounterValue(Theron::COUNTER_MESSAGES_PROCESSED) == 0, "GetCounterValue failed");
+
+        valueCount = framework.GetPerThreadCounterValues(Theron::COUNTER_MESSAGES_PROCESSED, counterValues, 32);
+
+        messagesProcessed = 0;
+        for (uint32_t index = 0; index < valueCount; ++index)
+        {
+            messagesProcessed += counterValues[index];
+        }
+
+        Check(messagesProcessed == 0, "GetPerThreadCounterValues failed");
+    }
+
+    inline static void ConstructEndPoint()
+    {
+        // Should be able to use endpoints even if networking is disabled.
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+    }
+
+    inline static void ConstructEndPointMultipleNetworkThreads()
+    {
+        // Endpoints can be serviced by multiple network threads, over which
+        // remote connections are sharded by address hash.
+        Theron::EndPoint::Parameters params;
+        params.mNetworkThreadCount = 4;
+
+        Theron::EndPoint endPoint("sharded_endpoint", "inproc://sharded_endpoint", params);
+    }
+
+    inline static void TieFrameworkToEndPoint()
+    {
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+    }
+
+    inline static void TieActorsToEndPoint()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+
+        // Create two actors and let them register and deregister themselves with the endPoint.
+        {
+            IntReplier replierOne(framework);
+            IntReplier replierTwo(framework);
+        }
+
+        // And again.
+        {
+            IntReplier replierOne(framework);
+            IntReplier replierTwo(framework);
+        }
+    }
+
+    inline static void TieReceiverstoEndPoint()
+    {
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+
+        // Create two receivers and let them register and deregister themselves with the endPoint.
+        {
+            Theron::Receiver receiverOne(endPoint);
+            Theron::Receiver receiverTwo(endPoint);
+        }
+
+        // And again.
+        {
+            Theron::Receiver receiverOne(endPoint);
+            Theron::Receiver receiverTwo(endPoint);
+        }
+    }
+
+    inline static void CrossEndPointDirectSend()
+    {
+        typedef Replier<int> IntReplier;
+
+        // Two endpoints in the same process, each with its own framework.
+        // Networking is disabled in this build, so the send below can only
+        // succeed by resolving the name through the process-wide registry
+        // and delivering directly, without touching the network transport.
+        Theron::EndPoint endPointOne("direct_endpoint_one", "inproc://direct_endpoint_one");
+        Theron::EndPoint endPointTwo("direct_endpoint_two", "inproc://direct_endpoint_two");
+
+        Theron::Framework frameworkOne(endPointOne);
+        Theron::Framework frameworkTwo(endPointTwo);
+
+        Theron::Receiver receiver(endPointOne, "direct_receiver");
+        Theron::Catcher<int> catcher;
+        receiver.RegisterHandler(&catcher, &Theron::Catcher<int>::Push);
+
+        // The replier's name is published through the other endpoint.
+        IntReplier replier(frameworkTwo, "direct_replier");
+
+        Check(
+            frameworkOne.Send(42, receiver.GetAddress(), Theron::Address("direct_replier")),
+            "Cross-endpoint send failed to resolve the name in-process");
+
+        receiver.Wait();
+
+        int reply(0);
+        Theron::Address from;
+        Check(catcher.Pop(reply, from), "Reply not caught");
+        Check(reply == 42, "Reply has the wrong value");
+        Check(from == replier.GetAddress(), "Reply came from the wrong address");
+    }
+
+    inline static void NameFrameworkOnConstruction()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+
+        Theron::Framework::Parameters frameworkParams;
+        Theron::Framework framework(endPoint, "framework", frameworkParams);
+
+        // Register an actor and a receiver to test the name can be used.
+        IntReplier replier(framework);
+        Theron::Receiver receiver(endPoint);
+
+        framework.Send(int(0), receiver.GetAddress(), replier.GetAddress());
+        receiver.Wait();
+    }
+
+    inline static void NameActorOnConstruction()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+
+        // Register a named actor and a receiver to test the name can be used.
+        IntReplier replier(framework, "replier");
+        Theron::Receiver receiver(endPoint);
+
+        framework.Send(int(0), receiver.GetAddress(), Theron::Address("replier"));
+        receiver.Wait();
+    }
+
+    inline static void NameReceiverOnConstruction()
+    {
+        typedef Replier<int> IntReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+
+        // Register a named actor and a named receiver.
+        IntReplier replier(framework, "replier");
+        Theron::Receiver receiver(endPoint, "receiver");
+
+        framework.Send(int(0), Theron::Address("receiver"), Theron::Address("replier"));
+        receiver.Wait();
+    }
+
+    inline static void SendMessageToLocalActorByName()
+    {
+        typedef Replier<std::string> StringReplier;
+
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework framework(endPoint);
+
+        StringReplier replier(framework, "replier");
+        Theron::Receiver receiver(endPoint, "receiver");
+
+        // This tests we can send any copyable message to actors on the same endpoint
+        // by name, even if the message type hasn't been registered.
+        const std::string message("hello world");
+
+        // Send the replier a message by name, and pass the receiver address by name.
+        framework.Send(message, Theron::Address("receiver"), Theron::Address("replier"));
+
+        // Wait for the reply.
+        receiver.Wait();
+    }
+
+    inline static void SendMessagesBetweenLocalFrameworksByName()
+    {
+        Theron::EndPoint endPoint("endpoint", "inproc://endpoint");
+        Theron::Framework frameworkOne(endPoint);
+        Theron::Framework frameworkTwo(endPoint);
+
+        Signaller signallerOne(frameworkOne, "signaller_one");
+        Signaller signallerTwo(frameworkTwo, "signaller_two");
+        Theron::Receiver receiver(endPoint, "receiver");
+
+        // Send one a message telling it to signal two.
+        // One sends the receiver address to two as the signal,
+        // causing two to send one's address to the receiver.
+        Check(frameworkTwo.Send(
+            Theron::Address("signaller_two"),
+            Theron::Address("receiver"),
+            Theron::Address("signaller_one")), "Failed to send message");
+
+        receiver.Wait();
+    }
+
+private:
+
+    class TrivialActor : public Theron::Actor
+    {
+    public:
+
+        TrivialActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+        }
+    };
+
+    template <class MessageType>
+    class Registrar : public Theron::Actor
+    {
+    public:
+
+        Registrar(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Registrar::Handler);
+            IsHandlerRegistered(this, &Registrar::Handler);
+            DeregisterHandler(this, &Registrar::Handler);
+            IsHandlerRegistered(this, &Registrar::Handler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &/*message*/, const Theron::Address /*from*/)
+        {
+        }
+    };
+
+    template <class MessageType>
+    class Replier : public Theron::Actor
+    {
+    public:
+
+        inline explicit Replier(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
+        {
+            RegisterHandler(this, &Replier::Handler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+
+    class SlabTracked : public Theron::Actor
+    {
+    public:
+
+        inline SlabTracked(Theron::Framework &framework, int *const destructCount) :
+          Theron::Actor(framework),
+          mDestructCount(destructCount)
+        {
+            RegisterHandler(this, &SlabTracked::Handler);
+        }
+
+        inline virtual ~SlabTracked()
+        {
+            ++(*mDestructCount);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+
+        int *const mDestructCount;
+    };
+
+    // Squares a range of indices into a caller-owned array with ParallelFor,
+    // then verifies the whole range and reports the verified element count.
+    class ParallelSquarer : public Theron::Actor
+    {
+    public:
+
+        inline ParallelSquarer(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &ParallelSquarer::Compute);
+        }
+
+    private:
+
+        struct Square
+        {
+            inline void operator()(const Theron::uint32_t index) const
+            {
+                mOutput[index] = static_cast<Theron::uint64_t>(index) * index;
+            }
+
+            Theron::uint64_t *mOutput;
+        };
+
+        inline void Compute(const Theron::uint32_t &count, const Theron::Address from)
+        {
+            Theron::uint64_t *const output(new Theron::uint64_t[count]);
+
+            Square square = { output };
+            ParallelFor(count, square);
+
+            // Every index should have been executed exactly once by the time
+            // the call returns, whichever threads ran the chunks.
+            Theron::uint32_t verified(0);
+            for (Theron::uint32_t index = 0; index < count; ++index)
+            {
+                if (output[index] == static_cast<Theron::uint64_t>(index) * index)
+                {
+                    ++verified;
+                }
+            }
+
+            delete [] output;
+            Send(verified, from);
+        }
+    };
+
+    class PhaseWorker : public Theron::Actor
+    {
+    public:
+
+        inline PhaseWorker(Theron::Framework &framework, Theron::Detail::Atomic::UInt32 *const tally) :
+          Theron::Actor(framework),
+          mTally(tally)
+        {
+            RegisterHandler(this, &PhaseWorker::SetNeighbour);
+            RegisterHandler(this, &PhaseWorker::Work);
+        }
+
+    private:
+
+        inline void SetNeighbour(const Theron::Address &neighbour, const Theron::Address /*from*/)
+        {
+            mNeighbour = neighbour;
+        }
+
+        inline void Work(const int &message, const Theron::Address /*from*/)
+        {
+            // A positive message starts the worker's part of a phase, fanning
+            // sub-messages out to the neighbour; a zero is a sub-message.
+            if (message > 0)
+            {
+                for (int count = 0; count < message; ++count)
+                {
+                    Send(0, mNeighbour);
+                }
+            }
+            else
+            {
+                mTally->Increment();
+            }
+        }
+
+        Theron::Detail::Atomic::UInt32 *const mTally;
+        Theron::Address mNeighbour;
+    };
+
+    struct BigPayload
+    {
+        Theron::uint8_t mBytes[100 * 1024];
+    };
+
+    // Counts the payloads it receives, stalling on the first so that queued
+    // payloads pile up behind it holding their message memory.
+    class PayloadSink : public Theron::Actor
+    {
+    public:
+
+        inline PayloadSink(Theron::Framework &framework, Theron::Detail::Atomic::UInt32 *const tally) :
+          Theron::Actor(framework),
+          mTally(tally),
+          mStalled(false)
+        {
+            RegisterHandler(this, &PayloadSink::Consume);
+        }
+
+    private:
+
+        inline void Consume(const BigPayload &/*message*/, const Theron::Address /*from*/)
+        {
+            if (!mStalled)
+            {
+                mStalled = true;
+                Theron::Detail::Utils::SleepThread(200);
+            }
+
+            mTally->Increment();
+        }
+
+        Theron::Detail::Atomic::UInt32 *const mTally;
+        bool mStalled;
+    };
+
+    // Pressure handler counting the allocations refused by a memory budget.
+    inline static void NotePressure(void *const context, Theron::uint32_t /*attemptedBytes*/)
+    {
+        reinterpret_cast<Theron::Detail::Atomic::UInt32 *>(context)->Increment();
+    }
+
+    template <class MessageType>
+    class SlowReplier : public Theron::Actor
+    {
+    public:
+
+        inline SlowReplier(Theron::Framework &framework, const uint32_t sleepMilliseconds) :
+          Theron::Actor(framework),
+          mSleepMilliseconds(sleepMilliseconds)
+        {
+            RegisterHandler(this, &SlowReplier::Handler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &message, const Theron::Address from)
+        {
+            // Simulates a slow handler, delaying messages queued behind this one.
+            Theron::Detail::Utils::SleepThread(mSleepMilliseconds);
+            Send(message, from);
+        }
+
+        uint32_t mSleepMilliseconds;
+    };
+
+    // Forwards values to a target, stashing any that arrive while locked and
+    // releasing them for re-delivery on unlock.
+    class Stasher : public Theron::Actor
+    {
+    public:
+
+        struct Lock { };
+        struct Unlock { };
+
+        inline Stasher(Theron::Framework &framework, const Theron::Address target) :
+          Theron::Actor(framework),
+          mTarget(target),
+          mLocked(false)
+        {
+            RegisterHandler(this, &Stasher::OnLock);
+            RegisterHandler(this, &Stasher::OnUnlock);
+            RegisterHandler(this, &Stasher::OnValue);
+        }
+
+    private:
+
+        inline void OnLock(const Lock &message, const Theron::Address from)
+        {
+            mLocked = true;
+        }
+
+        inline void OnUnlock(const Unlock &message, const Theron::Address from)
+        {
+            mLocked = false;
+            UnstashAll();
+        }
+
+        inline void OnValue(const int &message, const Theron::Address from)
+        {
+            if (mLocked)
+            {
+                Stash();
+                return;
+            }
+
+            Send(message, mTarget);
+        }
+
+        const Theron::Address mTarget;
+        bool mLocked;
+    };
+
+    // Works through a count of slow work units, checkpointing between units
+    // whenever the processing budget of the current scheduling event runs out.
+    class BudgetedWorker : public Theron::Actor
+    {
+    public:
+
+        inline BudgetedWorker(Theron::Framework &framework, const Theron::Address report) :
+          Theron::Actor(framework),
+          mReport(report),
+          mYields(0)
+        {
+            RegisterHandler(this, &BudgetedWorker::Work);
+        }
+
+    private:
+
+        inline void Work(const int &message, const Theron::Address /*from*/)
+        {
+            int remaining(message);
+
+            while (remaining)
+            {
+                // One work unit, slow enough to exhaust the budget by itself.
+                Theron::Detail::Utils::SleepThread(2);
+                --remaining;
+
+                if (remaining && YieldIfOverBudget())
+                {
+                    // Checkpoint the remaining work and resume in a later event.
+                    ++mYields;
+                    Send(remaining, GetAddress());
+                    return;
+                }
+            }
+
+            Send(mYields, mReport);
+        }
+
+        const Theron::Address mReport;
+        int mYields;
+    };
+
+    class WatermarkedActor : public Theron::Actor
+    {
+    public:
+
+        inline WatermarkedActor(Theron::Framework &framework, const Theron::Address monitor) :
+          Theron::Actor(framework),
+          mMonitor(monitor)
+        {
+            RegisterHandler(this, &WatermarkedActor::Burst);
+            RegisterHandler(this, &WatermarkedActor::Drain);
+            RegisterHandler(this, &WatermarkedActor::OnWatermark);
+
+            SetQueueWatermarks(8, 1);
+        }
+
+    private:
+
+        inline void Burst(const int &count, const Theron::Address /*from*/)
+        {
+            // Flood our own queue from inside a handler, so the queue depth
+            // rises deterministically while the mailbox is being processed.
+            for (int index = 0; index < count; ++index)
+            {
+                Send(0.0f, GetAddress());
+            }
+        }
+
+        inline void Drain(const float &/*message*/, const Theron::Address /*from*/)
+        {
+        }
+
+        inline void OnWatermark(const Theron::QueueWatermarkEvent &event, const Theron::Address /*from*/)
+        {
+            // Forward the event to the monitoring receiver.
+            Send(event, mMonitor);
+        }
+
+        const Theron::Address mMonitor;
+    };
+
+#if THERON_ACTOR_STORE_SIZE
+
+    // Legacy-style echo actor with a default constructor, so it can be
+    // created with Framework::CreateActor and co-located with its mailbox.
+    class LegacyEcho : public Theron::Actor
+    {
+    public:
+
+        inline LegacyEcho()
+        {
+            RegisterHandler(this, &LegacyEcho::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+
+    // Echo actor guaranteed not to fit the mailbox store, forcing the heap path.
+    class BulkyLegacyEcho : public LegacyEcho
+    {
+    private:
+
+        Theron::uint8_t mBallast[THERON_ACTOR_STORE_SIZE + 64];
+    };
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+    // Queues a burst of conflatable snapshots behind itself, so each newer
+    // snapshot deterministically finds an older one still queued to replace.
+    class SnapshotConsumer : public Theron::Actor
+    {
+    public:
+
+        inline SnapshotConsumer(Theron::Framework &framework, const Theron::Address monitor) :
+          Theron::Actor(framework),
+          mMonitor(monitor),
+          mSnapshotsSeen(0),
+          mLastValue(-1)
+        {
+            RegisterHandler(this, &SnapshotConsumer::Kick);
+            RegisterHandler(this, &SnapshotConsumer::Snapshot);
+            RegisterHandler(this, &SnapshotConsumer::Flush);
+        }
+
+    private:
+
+        inline void Kick(const int &count, const Theron::Address /*from*/)
+        {
+            // Queue a burst of snapshots behind ourselves, then a flush last.
+            // The snapshots all arrive while the mailbox is backed up behind
+            // this handler, so each replaces the previous one in place.
+            for (int index = 0; index < count; ++index)
+            {
+                SnapshotMessage snapshot;
+                snapshot.mValue = index;
+                Send(snapshot, GetAddress());
+            }
+
+            Send(0.0f, GetAddress());
+        }
+
+        inline void Snapshot(const SnapshotMessage &message, const Theron::Address /*from*/)
+        {
+            ++mSnapshotsSeen;
+            mLastValue = message.mValue;
+        }
+
+        inline void Flush(const float &/*message*/, const Theron::Address /*from*/)
+        {
+            Send(mSnapshotsSeen, mMonitor);
+            Send(mLastValue, mMonitor);
+        }
+
+        const Theron::Address mMonitor;
+        int mSnapshotsSeen;
+        int mLastValue;
+    };
+
+    class UrgentSignaller : public Theron::Actor
+    {
+    public:
+
+        inline UrgentSignaller(Theron::Framework &framework, const Theron::Address monitor) :
+          Theron::Actor(framework),
+          mMonitor(monitor)
+        {
+            RegisterHandler(this, &UrgentSignaller::Kick);
+            RegisterHandler(this, &UrgentSignaller::Bulk);
+            RegisterHandler(this, &UrgentSignaller::Cancel);
+        }
+
+    private:
+
+        inline void Kick(const int &count, const Theron::Address /*from*/)
+        {
+            // Queue bulk work behind ourselves, then a cancellation last, so
+            // the cancellation deterministically finds a backed-up mailbox.
+            for (int index = 0; index < count; ++index)
+            {
+                Send(0.0f, GetAddress());
+            }
+
+            CancelMessage cancel;
+            cancel.mValue = 1;
+            Send(cancel, GetAddress());
+        }
+
+        inline void Bulk(const float &/*message*/, const Theron::Address /*from*/)
+        {
+            Send(0, mMonitor);
+        }
+
+        inline void Cancel(const CancelMessage &message, const Theron::Address /*from*/)
+        {
+            Send(message.mValue, mMonitor);
+        }
+
+        const Theron::Address mMonitor;
+    };
+
+    class TailForwarder : public Theron::Actor
+    {
+    public:
+
+        inline TailForwarder(Theron::Framework &framework, const Theron::Address next) :
+          Theron::Actor(framework),
+          mNext(next)
+        {
+            RegisterHandler(this, &TailForwarder::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address /*from*/)
+        {
+            // The send is the handler's last action, so the next stage of the
+            // pipeline can be processed inline on the same worker thread.
+            TailSend(message, mNext);
+        }
+
+        const Theron::Address mNext;
+    };
+
+    class CountingMetricsSink : public Theron::MetricsSink
+    {
+    public:
+
+        inline CountingMetricsSink() : mSampleCount(0), mProcessed(0)
+        {
+        }
+
+        inline virtual void Sample(
+            const WorkerSample *const workers,
+            const Theron::uint32_t workerCount,
+            const Theron::uint32_t /*sharedQueueDepth*/)
+        {
+            Theron::uint32_t processed(0);
+            for (Theron::uint32_t index = 0; index < workerCount; ++index)
+            {
+                processed += workers[index].mMessagesProcessed;
+            }
+
+            mProcessed.Store(processed);
+            mSampleCount.Increment();
+        }
+
+        Theron::Detail::Atomic::UInt32 mSampleCount;    ///< Number of samples received.
+        Theron::Detail::Atomic::UInt32 mProcessed;      ///< Total processed count seen in the last sample.
+    };
+
+    class NameForwarder : public Theron::Actor
+    {
+    public:
+
+        inline NameForwarder(
+            Theron::Framework &framework,
+            const Theron::Address client,
+            const Theron::Address target) :
+          Theron::Actor(framework),
+          mClient(client),
+          mTarget(target)
+        {
+            RegisterHandler(this, &NameForwarder::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            if (from == mClient)
+            {
+                // A request from the client; forward it to the named target.
+                // Sends from a worker thread, so the name resolution is cached.
+                Send(message, mTarget);
+            }
+            else
+            {
+                // A reply from the target; report it back to the client.
+                Send(message, mClient);
+            }
+        }
+
+        const Theron::Address mClient;
+        const Theron::Address mTarget;
+    };
+
+    class ContinuationRequester : public Theron::Actor
+    {
+    public:
+
+        inline ContinuationRequester(
+            Theron::Framework &framework,
+            const Theron::Address client,
+            const Theron::Address server) :
+          Theron::Actor(framework),
+          mClient(client),
+          mServer(server)
+        {
+            // The registered handler forwards int messages unchanged, so the
+            // test can tell whether a reply fired the continuation instead.
+            RegisterHandler(this, &ContinuationRequester::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            if (from == mClient)
+            {
+                // A request from the client; ask the server, expecting the
+                // reply to fire the continuation rather than this handler.
+                SendWithContinuation(message, mServer, &ContinuationRequester::Continuation);
+                return;
+            }
+
+            // Any reply that falls through to the ordinary handler is
+            // reported unmodified, which the test treats as a failure.
+            Send(message, mClient);
+        }
+
+        inline void Continuation(const int &message, const Theron::Address /*from*/)
+        {
+            // Mark the reply so the test can see the continuation ran.
+            Send(message + 100, mClient);
+        }
+
+        const Theron::Address mClient;
+        const Theron::Address mServer;
+    };
+
+    class BlockingReplier : public Theron::Actor
+    {
+    public:
+
+        inline explicit BlockingReplier(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &BlockingReplier::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            // Block briefly on a zero message, stalling the mailbox's consumer.
+            if (message == 0)
+            {
+                Theron::Detail::Utils::SleepThread(200);
+            }
+
+            Send(message, from);
+        }
+    };
+
+    struct TelemetryFrame
+    {
+        static const Theron::uint32_t SIZE = 32 * 1024;
+        Theron::uint8_t mBytes[SIZE];
+    };
+
+    class Streamer : public Theron::Actor
+    {
+    public:
+
+        inline Streamer(Theron::Framework &framework, const Theron::Address target) :
+          Theron::Actor(framework),
+          mTarget(target)
+        {
+            RegisterHandler(this, &Streamer::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address /*from*/)
+        {
+            // Send an ascending run of messages to the same target, from the
+            // single worker thread executing this handler.
+            for (int value = 0; value < message; ++value)
+            {
+                Send(value, mTarget);
+            }
+        }
+
+        const Theron::Address mTarget;
+    };
+
+    class SequenceChecker : public Theron::Actor
+    {
+    public:
+
+        inline SequenceChecker(Theron::Framework &framework, const Theron::Address report, const int count) :
+          Theron::Actor(framework),
+          mReport(report),
+          mCount(count),
+          mNextExpected(0),
+          mOutOfOrder(0)
+        {
+            RegisterHandler(this, &SequenceChecker::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address /*from*/)
+        {
+            if (message != mNextExpected)
+            {
+                ++mOutOfOrder;
+            }
+
+            mNextExpected = message + 1;
+
+            if (mNextExpected == mCount)
+            {
+                Send(mOutOfOrder, mReport);
+            }
+        }
+
+        const Theron::Address mReport;
+        const int mCount;
+        int mNextExpected;
+        int mOutOfOrder;
+    };
+
+    class ScratchUser : public Theron::Actor
+    {
+    public:
+
+        inline explicit ScratchUser(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &ScratchUser::Handler);
+        }
+
+        inline bool ScratchAvailableOutsideHandler() const
+        {
+            return (GetScratchAllocator() != 0);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            Theron::IAllocator *const scratch(GetScratchAllocator());
+            Check(scratch != 0, "Scratch allocator unavailable in a handler");
+
+            // Build a temporary workspace in the arena; all of this memory is
+            // released automatically when the handler returns.
+            const Theron::uint32_t count(64);
+            int *const workspace(static_cast<int *>(scratch->Allocate(count * sizeof(int))));
+            Check(workspace != 0, "Scratch allocation failed");
+
+            for (Theron::uint32_t index = 0; index < count; ++index)
+            {
+                workspace[index] = message + static_cast<int>(index);
+            }
+
+            // An aligned allocation from the arena honors the requested alignment.
+            void *const aligned(scratch->AllocateAligned(128, 64));
+            Check(THERON_ALIGNED(aligned, 64), "Scratch allocation misaligned");
+
+            int sum(0);
+            for (Theron::uint32_t index = 0; index < count; ++index)
+            {
+                sum += workspace[index];
+            }
+
+            Send(sum, from);
+        }
+    };
+
+#if THERON_CPP11
+    class VectorMover : public Theron::Actor
+    {
+    public:
+
+        inline explicit VectorMover(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &VectorMover::Handler);
+        }
+
+    private:
+
+        inline void Handler(std::vector<int> &message, const Theron::Address from)
+        {
+            // The mutable handler has exclusive access to the message value,
+            // so can take ownership of its contents by moving them out.
+            const std::vector<int> owned(std::move(message));
+            Send(static_cast<int>(owned.size()), from);
+        }
+    };
+
+    class StaticReplier : public Theron::StaticActor<StaticReplier, int, float>
+    {
+    public:
+
+        inline explicit StaticReplier(Theron::Framework &framework) : StaticActor(framework)
+        {
+            RegisterHandler(this, &StaticReplier::DynamicHandler);
+        }
+
+        inline void Handle(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+
+        inline void Handle(const float &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+
+    private:
+
+        inline void DynamicHandler(const double &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+
+    class LambdaAccumulator : public Theron::Actor
+    {
+    public:
+
+        inline LambdaAccumulator(Theron::Framework &framework, const int bias) : Theron::Actor(framework)
+        {
+            // The handler is a mutable lambda capturing per-instance state, so
+            // each instance accumulates its own running total with its own bias,
+            // without any trampoline method on the class.
+            int sum(0);
+            RegisterHandler<int>([this, sum, bias](const int &message, const Theron::Address from) mutable
+            {
+                sum += message + bias;
+                Send(sum, from);
+            });
+        }
+    };
+#endif // THERON_CPP11
+
+    template <class MessageType>
+    class DefaultReplier : public Theron::Actor
+    {
+    public:
+
+        inline DefaultReplier(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &DefaultReplier::Handler);
+            SetDefaultHandler(this, &DefaultReplier::DefaultHandler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+
+        inline void DefaultHandler(const Theron::Address from)
+        {
+            std::string hello("hello");
+            Send(hello, from);
+        }
+    };
+
+    class StringReplier : public Replier<const char *>
+    {
+    public:
+
+        typedef Replier<const char *> Base;
+
+        inline StringReplier(Theron::Framework &framework) : Base(framework)
+        {
+        }
+    };
+
+    class Signaller : public Theron::Actor
+    {
+    public:
+
+        inline Signaller(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
+        {
+            RegisterHandler(this, &Signaller::Signal);
+        }
+
+    private:
+
+        inline void Signal(const Theron::Address &address, const Theron::Address from)
+        {
+            // Send the 'from' address to the address received in the message.
+            Send(from, address);
+        }
+    };
+
+    class Switcher : public Theron::Actor
+    {
+    public:
+
+        inline Switcher(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Switcher::SayHello);
+        }
+
+    private:
+
+        inline void SayHello(const std::string &/*message*/, const Theron::Address from)
+        {
+            DeregisterHandler(this, &Switcher::SayHello);
+            RegisterHandler(this, &Switcher::SayGoodbye);
+            Send(std::string("hello"), from);
+        }
+
+        inline void SayGoodbye(const std::string &/*message*/, const Theron::Address from)
+        {
+            DeregisterHandler(this, &Switcher::SayGoodbye);
+            RegisterHandler(this, &Switcher::SayHello);
+            Send(std::string("goodbye"), from);
+        }
+    };
+
+    template <class MessageType>
+    class Catcher
+    {
+    public:
+
+        inline Catcher() : mMessage(), mFrom(Theron::Address::Null())
+        {
+        }
+
+        inline void Catch(const MessageType &message, const Theron::Address from)
+        {
+            mMessage = message;
+            mFrom = from;
+        }
+
+        MessageType mMessage;
+        Theron::Address mFrom;
+    };
+
+    class Counter : public Theron::Actor
+    {
+    public:
+
+        inline Counter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
+        {
+            RegisterHandler(this, &Counter::Increment);
+            RegisterHandler(this, &Counter::GetValue);
+        }
+
+    private:
+
+        inline void Increment(const int &message, const Theron::Address /*from*/)
+        {
+            mCount += message;
+        }
+
+        inline void GetValue(const bool &/*message*/, const Theron::Address from)
+        {
+            Send(mCount, from);
+        }
+
+        int mCount;
+    };
+
+    class TwoHandlerCounter : public Theron::Actor
+    {
+    public:
+
+        inline TwoHandlerCounter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
+        {
+            RegisterHandler(this, &TwoHandlerCounter::IncrementOne);
+            RegisterHandler(this, &TwoHandlerCounter::IncrementTwo);
+            RegisterHandler(this, &TwoHandlerCounter::GetValue);
+        }
+
+    private:
+
+        inline void IncrementOne(const int &message, const Theron::Address /*from*/)
+        {
+            mCount += message;
+        }
+
+        inline void IncrementTwo(const float &/*message*/, const Theron::Address /*from*/)
+        {
+            ++mCount;
+        }
+
+        inline void GetValue(const bool &/*message*/, const Theron::Address from)
+        {
+            Send(mCount, from);
+        }
+
+        int mCount;
+    };
+
+    class MultipleHandlerCounter : public Theron::Actor
+    {
+    public:
+
+        inline MultipleHandlerCounter(Theron::Framework &framework) : Theron::Actor(framework), mCount(0)
+        {
+            RegisterHandler(this, &MultipleHandlerCounter::IncrementOne);
+            RegisterHandler(this, &MultipleHandlerCounter::IncrementTwo);
+            RegisterHandler(this, &MultipleHandlerCounter::GetValue);
+        }
+
+    private:
+
+        inline void IncrementOne(const int &message, const Theron::Address /*from*/)
+        {
+            mCount += message;
+        }
+
+        inline void IncrementTwo(const int &/*message*/, const Theron::Address /*from*/)
+        {
+            ++mCount;
+        }
+
+        inline void GetValue(const bool &/*message*/, const Theron::Address from)
+        {
+            Send(mCount, from);
+        }
+
+        int mCount;
+    };
+
+    template <class CountType>
+    class Sequencer : public Theron::Actor
+    {
+    public:
+
+        static const char *GOOD;
+        static const char *BAD;
+
+        inline Sequencer(Theron::Framework &framework) : Theron::Actor(framework), mNextValue(0), mStatus(GOOD)
+        {
+            RegisterHandler(this, &Sequencer::Receive);
+            RegisterHandler(this, &Sequencer::GetValue);
+        }
+
+    private:
+
+        inline void Receive(const CountType &message, const Theron::Address /*from*/)
+        {
+            if (message != mNextValue++)
+            {
+                mStatus = BAD;
+            }
+        }
+
+        inline void GetValue(const bool &/*message*/, const Theron::Address from)
+        {
+            Send(mStatus, from);
+        }
+
+        CountType mNextValue;
+        const char *mStatus;
+    };
+
+    class Recursor : public Theron::Actor
+    {
+    public:
+
+        struct Parameters
+        {
+            int mCount;
+        };
+
+        inline Recursor(Theron::Framework &framework, const Parameters &params) : Theron::Actor(framework)
+        {
+            // Recursively create a child actor within the constructor.
+            if (params.mCount > 0)
+            {
+                Parameters childParams;
+                childParams.mCount = params.mCount - 1;
+
+                Theron::Framework &framework(GetFramework());
+                Recursor child(framework, childParams);
+            }
+        }
+    };
+
+    class TailRecursor : public Theron::Actor
+    {
+    public:
+
+        struct Parameters
+        {
+            int mCount;
+        };
+
+        inline TailRecursor(Theron::Framework &framework, const Parameters &params) : Theron::Actor(framework), mCount(params.mCount)
+        {
+        }
+
+        inline ~TailRecursor()
+        {
+            // Recursively create a child actor within the destructor.
+            if (mCount > 0)
+            {
+                Parameters childParams;
+                childParams.mCount = mCount - 1;
+
+                Theron::Framework &framework(GetFramework());
+                TailRecursor child(framework, childParams);
+            }
+        }
+
+    private:
+
+        int mCount;
+    };
+
+    class AutoSender : public Theron::Actor
+    {
+    public:
+
+        typedef Theron::Address Parameters;
+
+        inline AutoSender(Theron::Framework &framework, const Parameters &address) : Theron::Actor(framework)
+        {
+            // Send a message in the actor constructor.
+            Send(0, address);
+
+            // Send using TailSend to check that works too.
+            TailSend(1, address);
+        }
+    };
+
+    class TailSender : public Theron::Actor
+    {
+    public:
+
+        typedef Theron::Address Parameters;
+
+        inline TailSender(Theron::Framework &framework, const Parameters &address) : Theron::Actor(framework), mStoredAddress(address)
+        {
+        }
+
+        inline ~TailSender()
+        {
+            // Send a message in the actor destructor.
+            Send(0, mStoredAddress);
+
+            // Send using TailSend to check that works too.
+            TailSend(1, mStoredAddress);
+        }
+
+        Theron::Address mStoredAddress;
+    };
+
+    class AutoDeregistrar : public Theron::Actor
+    {
+    public:
+
+        inline AutoDeregistrar(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &AutoDeregistrar::HandlerOne);
+            RegisterHandler(this, &AutoDeregistrar::HandlerTwo);
+            DeregisterHandler(this, &AutoDeregistrar::HandlerOne);
+        }
+
+        inline void HandlerOne(const int &/*message*/, const Theron::Address from)
+        {
+            Send(1, from);
+        }
+
+        inline void HandlerTwo(const int &/*message*/, const Theron::Address from)
+        {
+            Send(2, from);
+        }
+    };
+
+    class TailDeregistrar : public Theron::Actor
+    {
+    public:
+
+        inline TailDeregistrar(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &TailDeregistrar::Handler);
+        }
+
+        inline ~TailDeregistrar()
+        {
+            DeregisterHandler(this, &TailDeregistrar::Handler);
+        }
+
+        inline void Handler(const int &/*message*/, const Theron::Address from)
+        {
+            Send(0, from);
+        }
+    };
+
+    class MessageQueueCounter : public Theron::Actor
+    {
+    public:
+
+        inline explicit MessageQueueCounter(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &MessageQueueCounter::Handler);
+        }
+
+        inline void Handler(const int &/*message*/, const Theron::Address from)
+        {
+            Send(GetNumQueuedMessages(), from);
+        }
+    };
+
+    class BlindActor : public Theron::Actor
+    {
+    public:
+
+        inline BlindActor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            SetDefaultHandler(this, &BlindActor::BlindDefaultHandler);
+        }
+
+    private:
+
+        inline void BlindDefaultHandler(const void *const data, const Theron::uint32_t size, const Theron::Address from)
+        {
+            // We know the message is a uint32_t.
+            const Theron::uint32_t *const p(reinterpret_cast<const Theron::uint32_t *>(data));
+            const Theron::uint32_t value(*p);
+
+            Send(value, from);
+            Send(size, from);
+        }
+    };
+
+    template <class MessageType>
+    class Accumulator
+    {
+    public:
+
+        inline Accumulator() : mMessages()
+        {
+        }
+
+        inline void Catch(const MessageType &message, const Theron::Address /*from*/)
+        {
+            mMessages.push(message);
+        }
+
+        int Size()
+        {
+            return mMessages.size();
+        }
+
+        MessageType Pop()
+        {
+            THERON_ASSERT(mMessages.empty() == false);
+            MessageType message(mMessages.front());
+            mMessages.pop();
+            return message;
+        }
+
+    private:
+
+        std::queue<MessageType> mMessages;
+    };
+
+    class HandlerChecker : public Theron::Actor
+    {
+    public:
+
+        inline HandlerChecker(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &HandlerChecker::Check);
+        }
+
+    private:
+
+        inline void Check(const int & /*message*/, const Theron::Address from)
+        {
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+
+            RegisterHandler(this, &HandlerChecker::Dummy);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+
+            DeregisterHandler(this, &HandlerChecker::Dummy);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+
+            DeregisterHandler(this, &HandlerChecker::Check);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+
+            RegisterHandler(this, &HandlerChecker::Dummy);
+            RegisterHandler(this, &HandlerChecker::Check);
+            RegisterHandler(this, &HandlerChecker::Check);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+        
+            DeregisterHandler(this, &HandlerChecker::Check);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+
+            DeregisterHandler(this, &HandlerChecker::Check);
+
+            Send(IsHandlerRegistered(this, &HandlerChecker::Check), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Dummy), from);
+            Send(IsHandlerRegistered(this, &HandlerChecker::Unregistered), from);
+        }
+
+        inline void Dummy(const int & message, const Theron::Address from)
+        {
+            // We do this just so that Dummy and Unregistered differ, so the compiler won't merge them!
+            Send(message, from);
+        }
+
+        inline void Unregistered(const int & /*message*/, const Theron::Address /*from*/)
+        {
+        }
+    };
+
+    class Nestor : public Theron::Actor
+    {
+    public:
+
+        struct CreateMessage { };
+        struct DestroyMessage { };
+
+        inline Nestor(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &Nestor::Create);
+            RegisterHandler(this, &Nestor::Destroy);
+            RegisterHandler(this, &Nestor::Receive);
+        }
+
+    private:
+
+        typedef Replier<int> ChildActor;
+
+        inline void Create(const CreateMessage & /*message*/, const Theron::Address /*from*/)
+        {
+            mChildren.push_back(new ChildActor(GetFramework()));
+            mChildren.push_back(new ChildActor(GetFramework()));
+            mChildren.push_back(new ChildActor(GetFramework()));
+
+            mReplies.push_back(false);
+            mReplies.push_back(false);
+            mReplies.push_back(false);
+
+            Send(0, mChildren[0]->GetAddress());
+            Send(1, mChildren[1]->GetAddress());
+            Send(2, mChildren[2]->GetAddress());
+        }
+
+        inline void Destroy(const DestroyMessage & /*message*/, const Theron::Address from)
+        {
+            mCaller = from;
+            if (mReplies[0] && mReplies[1] && mReplies[2])
+            {
+                delete mChildren[0];
+                delete mChildren[1];
+                delete mChildren[2];
+
+                mChildren.clear();
+                Send(true, mCaller);
+            }
+        }
+
+        inline void Receive(const int & message, const Theron::Address /*from*/)
+        {
+            mReplies[message] = true;
+
+            if (mCaller != Theron::Address::Null() && mReplies[0] && mReplies[1] && mReplies[2])
+            {
+                delete mChildren[0];
+                delete mChildren[1];
+                delete mChildren[2];
+
+                mChildren.clear();
+                Send(true, mCaller);
+            }
+        }
+
+        std::vector<Theron::Actor *> mChildren;
+        std::vector<bool> mReplies;
+        Theron::Address mCaller;
+    };
+
+    class FallbackHandler
+    {
+    public:
+
+        inline void Handle(const Theron::Address from)
+        {
+            mAddress = from;
+        }
+
+        Theron::Address mAddress;
+    };
+
+    class BlindFallbackHandler
+    {
+    public:
+
+        BlindFallbackHandler() : mData(0), mValue(0), mSize(0)
+        {
+        }
+
+        inline void Handle(const void *const data, const Theron::uint32_t size, const Theron::Address from)
+        {
+            mData = data;
+            mValue = *reinterpret_cast<const Theron::uint32_t *>(data);
+            mSize = size;
+            mAddress = from;
+        }
+
+        const void *mData;
+        Theron::uint32_t mValue;
+        Theron::uint32_t mSize;
+        Theron::Address mAddress;
+    };
+
+    class ViewFallbackHandler
+    {
+    public:
+
+        inline void Handle(const Theron::MessageView &view, const Theron::Address from)
+        {
+            // Retain a copy of the view, keeping the payload bytes valid
+            // after this handler returns, then signal the waiting test.
+            mRetained = view;
+            mAddress = from;
+        }
+
+        Theron::MessageView mRetained;
+        Theron::Address mAddress;
+    };
+
+public:
+
+    typedef std::vector<Theron::uint32_t> IntVectorMessage;
+
+private:
+
+    class SomeOtherBaseclass
+    {
+    public:
+
+        inline SomeOtherBaseclass()
+        {
+        }
+
+        // The virtual destructor is required because this is a baseclass with virtual functions.
+        inline virtual ~SomeOtherBaseclass()
+        {
+        }
+
+        inline virtual void DoNothing()
+        {
+        }
+    };
+
+    class ActorFirst : public Theron::Actor, public SomeOtherBaseclass
+    {
+    public:
+
+        inline ActorFirst(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &ActorFirst::Handler);
+        }
+
+        // The virtual destructor is required because we derived from baseclasses with virtual functions.
+        inline virtual ~ActorFirst()
+        {
+        }
+
+    private:
+
+        inline virtual void DoNothing()
+        {
+        }
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+
+    class ActorLast : public SomeOtherBaseclass, public Theron::Actor
+    {
+    public:
+
+        inline ActorLast(Theron::Framework &framework) : Theron::Actor(framework)
+        {
+            RegisterHandler(this, &ActorLast::Handler);
+        }
+
+        // The virtual destructor is required because we derived from baseclasses with virtual functions.
+        inline virtual ~ActorLast()
+        {
+        }
+
+    private:
+
+        inline virtual void DoNothing()
+        {
+        }
+        
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+
+    struct EmptyMessage
+    {
+    };
+
+    class Forwarder : public Theron::Actor
+    {
+    public:
+
+        inline Forwarder(Theron::Framework &framework, const Theron::Address next) : Theron::Actor(framework), mNext(next)
+        {
+            RegisterHandler(this, &Forwarder::Forward);
+        }
+
+    private:
+
+        inline void Forward(const int &message, const Theron::Address /*from*/)
+        {
+            Send(message - 1, mNext);
+        }
+
+        const Theron::Address mNext;
+    };
+
+    // Consumes streamed file chunks in place, verifying their contents
+    // against the pattern the test wrote, and reports the verified byte
+    // count -- or a failure marker -- when the stream completes.
+    class ChunkConsumer : public Theron::Actor
+    {
+    public:
+
+        inline ChunkConsumer(Theron::Framework &framework, const Theron::Address report) :
+          Theron::Actor(framework),
+          mReport(report),
+          mVerified(0)
+        {
+            RegisterHandler(this, &ChunkConsumer::Handler);
+        }
+
+    private:
+
+        inline void Handler(const Theron::FileStreamer::FileChunk &chunk, const Theron::Address from)
+        {
+            // Read the chunk contents in place from the shared mapping.
+            for (Theron::uint32_t index = 0; index < chunk.mSize; ++index)
+            {
+                if (chunk.mData[index] == static_cast<unsigned char>((chunk.mOffset + index) & 0xFF))
+                {
+                    ++mVerified;
+                }
+            }
+
+            Send(Theron::FileStreamer::ChunkAck(chunk.mSequence), from);
+
+            if (chunk.mFinal)
+            {
+                Send(chunk.mFailed ? Theron::uint32_t(0xFFFFFFFF) : mVerified, mReport);
+                mVerified = 0;
+            }
+        }
+
+        const Theron::Address mReport;
+        Theron::uint32_t mVerified;
+    };
+
+    // Registers its handlers from a shared per-class handler table, and
+    // diverges from it on request by swapping its integer handler.
+    class TableWorker : public Theron::Actor
+    {
+    public:
+
+        inline static void BuildHandlers(Theron::HandlerTable &table)
+        {
+            table.Add(&TableWorker::HandleInt);
+            table.Add(&TableWorker::HandleFloat);
+        }
+
+        inline TableWorker(Theron::Framework &framework, const Theron::HandlerTable &table) :
+          Theron::Actor(framework)
+        {
+            RegisterHandlerTable(table);
+        }
+
+    private:
+
+        inline void HandleInt(const int &message, const Theron::Address from)
+        {
+            Send(message + 1, from);
+        }
+
+        inline void HandleIntDoubled(const int &message, const Theron::Address from)
+        {
+            Send(message * 2, from);
+        }
+
+        inline void HandleFloat(const float &message, const Theron::Address from)
+        {
+            // Diverge from the shared table: swap this instance's integer
+            // handler, leaving other instances on the shared handler set.
+            DeregisterHandler(this, &TableWorker::HandleInt);
+            RegisterHandler(this, &TableWorker::HandleIntDoubled);
+
+            Send(message, from);
+        }
+    };
+
+    // Parks its worker thread in a blocking section until released, simulating
+    // a handler stuck in a blocking call.
+    class SectionBlocker : public Theron::Actor
+    {
+    public:
+
+        inline SectionBlocker(
+            Theron::Framework &framework,
+            Theron::Detail::Atomic::UInt32 *const entered,
+            Theron::Detail::Atomic::UInt32 *const flag) :
+          Theron::Actor(framework),
+          mEntered(entered),
+          mFlag(flag)
+        {
+            RegisterHandler(this, &SectionBlocker::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &/*message*/, const Theron::Address from)
+        {
+            EnterBlockingSection();
+            mEntered->Store(1);
+
+            // Bounded wait for the release flag, so a missing replacement
+            // worker fails the test rather than deadlocking it.
+            Theron::uint32_t waited(0);
+            while (mFlag->Load() == 0 && waited < 5000)
+            {
+                Theron::Detail::Utils::SleepThread(1);
+                ++waited;
+            }
+
+            LeaveBlockingSection();
+            Send(static_cast<int>(mFlag->Load()), from);
+        }
+
+        Theron::Detail::Atomic::UInt32 *mEntered;
+        Theron::Detail::Atomic::UInt32 *mFlag;
+    };
+
+    // Releases a SectionBlocker by setting its flag.
+    class FlagSetter : public Theron::Actor
+    {
+    public:
+
+        inline FlagSetter(Theron::Framework &framework, Theron::Detail::Atomic::UInt32 *const flag) :
+          Theron::Actor(framework),
+          mFlag(flag)
+        {
+            RegisterHandler(this, &FlagSetter::Handler);
+        }
+
+    private:
+
+        inline void Handler(const int &message, const Theron::Address from)
+        {
+            mFlag->Store(1);
+            Send(message, from);
+        }
+
+        Theron::Detail::Atomic::UInt32 *mFlag;
+    };
+
+    // Derive from a different baseclass first to check we cope with the non-zero offset.
+    class Version3Replier : public SomeOtherBaseclass, public Theron::Actor
+    {
+    public:
+
+        struct Parameters
+        {
+        };
+
+        Version3Replier()
+        {
+            RegisterHandler(this, &Version3Replier::Handler);
+
+            // Allocate memory in the constructor to check the destructor is called.
+            mMemory = Theron::AllocatorManager::Instance().GetAllocator()->Allocate(64);
+
+            // Check the alignment of the final actor type.
+            THERON_ASSERT(THERON_ALIGNED(this, 128));
+        }
+
+        Version3Replier(const Parameters &/*params*/)
+        {
+            RegisterHandler(this, &Version3Replier::Handler);
+
+            // Allocate memory in the constructor to check the destructor is called.
+            mMemory = Theron::AllocatorManager::Instance().GetAllocator()->Allocate(64);
+
+            // Check the alignment of the final actor type.
+            THERON_ASSERT(THERON_ALIGNED(this, 128));
+        }
+
+        ~Version3Replier()
+        {
+            DeregisterHandler(this, &Version3Replier::Handler);
+
+            // Free the memory in the destructor to check the destructor is called.
+            // The DefaultAllocator memory allocation checking will fail if we leak.
+            Theron::AllocatorManager::Instance().GetAllocator()->Free(mMemory);
+        }
+
+    private:
+
+        // Implementation of virtual method in SomeOtherBaseclass.
+        inline virtual void DoNothing()
+        {
+        }
+
+        void Handler(const int &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+
+        void *mMemory;
+    };
+};
+
+
+template <class CountType>
+const char *FeatureTestSuite::Sequencer<CountType>::GOOD = "good";
+
+template <class CountType>
+const char *FeatureTestSuite::Sequencer<CountType>::BAD = "good";
+
+
+} // namespace Tests
+
+
+THERON_REGISTER_MESSAGE(Tests::FeatureTestSuite::IntVectorMessage);
+
+THERON_ALIGN_ACTOR(Tests::FeatureTestSuite::Version3Replier, 128);
+
+
+#endif // THERON_TESTS_TESTSUITES_FEATURETESTSUITE_H
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <queue>
+#include <utility>
 
 #include <Theron/Theron.h>
 
@@ -773,6 +774,10 @@ public:
         TESTFRAMEWORK_REGISTER_TEST(SendMessageToActorFromReceiverInFunction);
         TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromNullAddressInFunction);
         TESTFRAMEWORK_REGISTER_TEST(PushMessageToActorFromReceiverInFunction);
+#if THERON_CPP11
+        TESTFRAMEWORK_REGISTER_TEST(MoveActorReference);
+#endif // THERON_CPP11
+        TESTFRAMEWORK_REGISTER_TEST(ViewActorReference);
         TESTFRAMEWORK_REGISTER_TEST(CatchReplyInFunction);
         TESTFRAMEWORK_REGISTER_TEST(StoreActorRefAsMemberInFunction);
         TESTFRAMEWORK_REGISTER_TEST(SendNonPODMessageInFunction);
@@ -890,6 +895,55 @@ public:
         receiver.Wait();
     }
 
+#if THERON_CPP11
+
+    inline static void MoveActorReference()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::ActorRef signaler(framework.CreateActor<Signaler>());
+        const Theron::Address address(signaler.GetAddress());
+
+        // Moving transfers the held reference rather than sharing it, so the
+        // actor's reference count is untouched and the source is left null.
+        Theron::ActorRef moved(std::move(signaler));
+        Check(signaler == Theron::ActorRef::Null(), "Moved-from reference isn't null");
+        Check(moved.GetAddress() == address, "Moved reference changed identity");
+
+        Theron::ActorRef assigned;
+        assigned = std::move(moved);
+        Check(moved == Theron::ActorRef::Null(), "Moved-from reference isn't null");
+
+        assigned.Push(receiver.GetAddress(), receiver.GetAddress());
+        receiver.Wait();
+    }
+
+#endif // THERON_CPP11
+
+    inline static void ViewActorReference()
+    {
+        Theron::Framework framework;
+        Theron::Receiver receiver;
+
+        Theron::ActorRef signaler(framework.CreateActor<Signaler>());
+
+        // A view borrows the reference without owning one of its own, so
+        // copying it around doesn't drive reference count operations.
+        Theron::ActorRefView view(signaler);
+        Check(view != Theron::ActorRefView::Null(), "View of a valid reference is null");
+        Check(view.GetAddress() == signaler.GetAddress(), "View address differs from the reference");
+
+        // The view pushes messages through the same path as the reference.
+        view.Push(receiver.GetAddress(), receiver.GetAddress());
+        receiver.Wait();
+
+        // Promoting the view to an owning reference pays the only reference
+        // count operation in the chain.
+        Theron::ActorRef owned(view.Ref());
+        Check(owned == signaler, "Promoted view references a different actor");
+    }
+
     inline static void ReceiveReplyInFunction()
     {
         typedef Replier<float> FloatReplier;
@@ -3,9 +3,11 @@
 #define THERON_TESTS_TESTSUITES_NETWORKTESTSUITE_H
 
 
+#include <stdio.h>
 #include <string.h>
 
 #include <Theron/Theron.h>
+#include <Theron/Detail/Network/DedupWindowSet.h>
 #include <Theron/Detail/Threading/Utils.h>
 
 #include "TestFramework/TestSuite.h"
@@ -30,6 +32,11 @@ public:
 
         TESTFRAMEWORK_REGISTER_TEST(SendMessageToRemoteActorByName);
         TESTFRAMEWORK_REGISTER_TEST(SendMessageToRemoteActorFromNullAddress);
+        TESTFRAMEWORK_REGISTER_TEST(JournalReplayWindow);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageWithFlatWireFormat);
+        TESTFRAMEWORK_REGISTER_TEST(SequencedDeliveryDedupWindow);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageWithSequencedDelivery);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageWithDeliveryThreads);
     }
 
     inline static void SendMessageToRemoteActorByName()
@@ -148,6 +155,300 @@ public:
         Check(from == notifier.GetAddress(), "Remote message from address is wrong");
     }
 
+    inline static void SendMessageWithFlatWireFormat()
+    {
+        typedef Replier<RemoteMessage> RemoteMessageReplier;
+        typedef Theron::Catcher<RemoteMessage> RemoteMessageCatcher;
+
+        // Enable the flat wire format on only one of the endpoints, so the
+        // exchange exercises both the flat frames it sends and the generic
+        // frames it receives back from the other endpoint.
+        Theron::EndPoint::Parameters params;
+        params.mFlatWireFormat = true;
+
+        // Create two local network endpoints.
+        Theron::EndPoint endPointOne("flat_one", "inproc://flat_endpoint_one", params);
+        Theron::EndPoint endPointTwo("flat_two", "inproc://flat_endpoint_two");
+
+        // Connect the endpoints.
+        endPointOne.Connect("inproc://flat_endpoint_two");
+        endPointTwo.Connect("inproc://flat_endpoint_one");
+
+        // Create a framework and receiver at endpoint one.
+        Theron::Framework frameworkOne(endPointOne);
+        Theron::Receiver receiver(endPointOne, "flat_receiver");
+
+        // Create a replier in a framework at endpoint two.
+        Theron::Framework frameworkTwo(endPointTwo);
+        RemoteMessageReplier replier(frameworkTwo, "flat_replier");
+
+        // Register a catcher with the receiver.
+        RemoteMessageCatcher catcher;
+        receiver.RegisterHandler(&catcher, &RemoteMessageCatcher::Push);
+
+        RemoteMessage message;
+        message.mData[0] = 'H';
+        message.mData[1] = 'e';
+        message.mData[2] = 'l';
+        message.mData[3] = 'l';
+        message.mData[4] = 'o';
+        message.mData[5] = '\0';
+
+        // We have to resend until the Connect actually connects.
+        // Send the message and wait for the reply.
+        while (receiver.Count() == 0)
+        {
+            // We send the replier a message by name, and pass the receiver address by name.
+            frameworkOne.Send(
+                message,
+                Theron::Address("flat_receiver"),
+                Theron::Address("flat_replier"));
+
+            Theron::Detail::Utils::SleepThread(100);
+        }
+
+        receiver.Wait();
+
+        RemoteMessage caught;
+        Theron::Address from;
+        Check(!catcher.Empty(), "Failed to catch remote message");
+        Check(catcher.Pop(caught, from), "Failed to pop caught remote message");
+
+        Check(strcmp(caught.mData, "Hello") == 0, "Remote message has bad value");
+        Check(from == Theron::Address("flat_replier"), "Remote message from address is wrong");
+        Check(from == replier.GetAddress(), "Remote message from address is wrong");
+    }
+
+    inline static void JournalReplayWindow()
+    {
+        typedef Replier<RemoteMessage> RemoteMessageReplier;
+        typedef Theron::Catcher<RemoteMessage> RemoteMessageCatcher;
+
+        const char *const journalPath("network_test_journal.dat");
+
+        // Journal a cross-endpoint send by enabling the journal on the
+        // sending endpoint.
+        {
+            Theron::EndPoint::Parameters params;
+            params.mJournalPath = journalPath;
+            params.mJournalSizeBytes = 64 * 1024;
+
+            Theron::EndPoint endPointOne("journal_one", "inproc://journal_endpoint_one", params);
+            Theron::EndPoint endPointTwo("journal_two", "inproc://journal_endpoint_two");
+
+            // Connect the endpoints.
+            endPointOne.Connect("inproc://journal_endpoint_two");
+            endPointTwo.Connect("inproc://journal_endpoint_one");
+
+            // Create a framework and receiver at endpoint one.
+            Theron::Framework frameworkOne(endPointOne);
+            Theron::Receiver receiver(endPointOne, "journal_sender");
+
+            // Create a replier in a framework at endpoint two.
+            Theron::Framework frameworkTwo(endPointTwo);
+            RemoteMessageReplier replier(frameworkTwo, "journal_replier");
+
+            RemoteMessage message;
+            message.mData[0] = 'H';
+            message.mData[1] = 'e';
+            message.mData[2] = 'l';
+            message.mData[3] = 'l';
+            message.mData[4] = 'o';
+            message.mData[5] = '\0';
+
+            // We have to resend until the Connect actually connects.
+            // Send the message and wait for the reply.
+            while (receiver.Count() == 0)
+            {
+                frameworkOne.Send(
+                    message,
+                    Theron::Address("journal_sender"),
+                    Theron::Address("journal_replier"));
+
+                Theron::Detail::Utils::SleepThread(100);
+            }
+
+            receiver.Wait();
+        }
+
+        // Replay the journal into a fresh endpoint publishing the recorded
+        // destination name locally, catching the re-delivered messages.
+        {
+            Theron::EndPoint endPoint("journal_replay", "inproc://journal_endpoint_replay");
+
+            Theron::Receiver receiver(endPoint, "journal_replier");
+            RemoteMessageCatcher catcher;
+            receiver.RegisterHandler(&catcher, &RemoteMessageCatcher::Push);
+
+            // A window ending before any recorded timestamp replays nothing.
+            Check(endPoint.ReplayJournal(journalPath, 0, 1) == 0, "Replayed messages outside the time window");
+            Check(catcher.Empty(), "Caught a message replayed outside the time window");
+
+            // An unbounded window replays every journaled send, including any
+            // resent while the endpoints were connecting.
+            Check(endPoint.ReplayJournal(journalPath) > 0, "Failed to replay journaled messages");
+
+            RemoteMessage caught;
+            Theron::Address from;
+            Check(!catcher.Empty(), "Failed to catch replayed message");
+            Check(catcher.Pop(caught, from), "Failed to pop caught replayed message");
+
+            Check(strcmp(caught.mData, "Hello") == 0, "Replayed message has bad value");
+            Check(from == Theron::Address("journal_sender"), "Replayed message from address is wrong");
+        }
+
+        remove(journalPath);
+    }
+
+    inline static void SequencedDeliveryDedupWindow()
+    {
+        Theron::Detail::DedupWindowSet windows;
+
+        // First receipt from a sender is always accepted; repeats are not.
+        Check(windows.Accept(1, 1), "First sequence from sender rejected");
+        Check(!windows.Accept(1, 1), "Duplicate sequence accepted");
+
+        // In-order sequences are accepted once each.
+        Check(windows.Accept(1, 2), "In-order sequence rejected");
+        Check(windows.Accept(1, 3), "In-order sequence rejected");
+        Check(!windows.Accept(1, 2), "Duplicate sequence accepted");
+        Check(!windows.Accept(1, 3), "Duplicate sequence accepted");
+
+        // Modest reordering within the window is tolerated.
+        Check(windows.Accept(1, 10), "Out-of-order sequence rejected");
+        Check(windows.Accept(1, 5), "Reordered sequence within the window rejected");
+        Check(!windows.Accept(1, 5), "Duplicate reordered sequence accepted");
+        Check(!windows.Accept(1, 10), "Duplicate sequence accepted");
+
+        // Senders are tracked independently.
+        Check(windows.Accept(2, 1), "First sequence from second sender rejected");
+        Check(!windows.Accept(2, 1), "Duplicate from second sender accepted");
+        Check(windows.Accept(1, 4), "Sequence from first sender rejected with a second sender tracked");
+
+        // Sequences older than the 64-entry window are dropped as late replays.
+        Check(windows.Accept(1, 1000), "Large sequence advance rejected");
+        Check(!windows.Accept(1, 900), "Sequence older than the window accepted");
+        Check(windows.Accept(1, 990), "Unseen sequence within the advanced window rejected");
+    }
+
+    inline static void SendMessageWithSequencedDelivery()
+    {
+        typedef Replier<RemoteMessage> RemoteMessageReplier;
+        typedef Theron::Catcher<RemoteMessage> RemoteMessageCatcher;
+
+        // Enable sequenced delivery on the sending endpoint; the receiving
+        // endpoint decodes sequenced and unsequenced frames alike.
+        Theron::EndPoint::Parameters params;
+        params.mSequencedDelivery = true;
+
+        Theron::EndPoint endPointOne("sequenced_one", "inproc://sequenced_endpoint_one", params);
+        Theron::EndPoint endPointTwo("sequenced_two", "inproc://sequenced_endpoint_two");
+
+        // Connect the endpoints.
+        endPointOne.Connect("inproc://sequenced_endpoint_two");
+        endPointTwo.Connect("inproc://sequenced_endpoint_one");
+
+        // Create a framework and receiver at endpoint one.
+        Theron::Framework frameworkOne(endPointOne);
+        Theron::Receiver receiver(endPointOne, "sequenced_receiver");
+
+        RemoteMessageCatcher catcher;
+        receiver.RegisterHandler(&catcher, &RemoteMessageCatcher::Push);
+
+        // Create a replier in a framework at endpoint two.
+        Theron::Framework frameworkTwo(endPointTwo);
+        RemoteMessageReplier replier(frameworkTwo, "sequenced_replier");
+
+        RemoteMessage message;
+        message.mData[0] = 'H';
+        message.mData[1] = 'e';
+        message.mData[2] = 'l';
+        message.mData[3] = 'l';
+        message.mData[4] = 'o';
+        message.mData[5] = '\0';
+
+        // We have to resend until the Connect actually connects.
+        // Send the message and wait for the reply.
+        while (receiver.Count() == 0)
+        {
+            frameworkOne.Send(
+                message,
+                Theron::Address("sequenced_receiver"),
+                Theron::Address("sequenced_replier"));
+
+            Theron::Detail::Utils::SleepThread(100);
+        }
+
+        receiver.Wait();
+
+        RemoteMessage caught;
+        Theron::Address from;
+        Check(!catcher.Empty(), "Failed to catch remote message");
+        Check(catcher.Pop(caught, from), "Failed to pop caught remote message");
+
+        Check(strcmp(caught.mData, "Hello") == 0, "Remote message has bad value");
+        Check(from == replier.GetAddress(), "Remote message from address is wrong");
+    }
+
+    inline static void SendMessageWithDeliveryThreads()
+    {
+        typedef Replier<RemoteMessage> RemoteMessageReplier;
+        typedef Theron::Catcher<RemoteMessage> RemoteMessageCatcher;
+
+        // Enable a pool of delivery threads on both endpoints, so received
+        // frames are deserialized and delivered off the network threads.
+        Theron::EndPoint::Parameters params;
+        params.mDeliveryThreadCount = 2;
+
+        Theron::EndPoint endPointOne("delivery_one", "inproc://delivery_endpoint_one", params);
+        Theron::EndPoint endPointTwo("delivery_two", "inproc://delivery_endpoint_two", params);
+
+        // Connect the endpoints.
+        endPointOne.Connect("inproc://delivery_endpoint_two");
+        endPointTwo.Connect("inproc://delivery_endpoint_one");
+
+        // Create a framework and receiver at endpoint one.
+        Theron::Framework frameworkOne(endPointOne);
+        Theron::Receiver receiver(endPointOne, "delivery_receiver");
+
+        RemoteMessageCatcher catcher;
+        receiver.RegisterHandler(&catcher, &RemoteMessageCatcher::Push);
+
+        // Create a replier in a framework at endpoint two.
+        Theron::Framework frameworkTwo(endPointTwo);
+        RemoteMessageReplier replier(frameworkTwo, "delivery_replier");
+
+        RemoteMessage message;
+        message.mData[0] = 'H';
+        message.mData[1] = 'e';
+        message.mData[2] = 'l';
+        message.mData[3] = 'l';
+        message.mData[4] = 'o';
+        message.mData[5] = '\0';
+
+        // We have to resend until the Connect actually connects.
+        // Send the message and wait for the reply.
+        while (receiver.Count() == 0)
+        {
+            frameworkOne.Send(
+                message,
+                Theron::Address("delivery_receiver"),
+                Theron::Address("delivery_replier"));
+
+            Theron::Detail::Utils::SleepThread(100);
+        }
+
+        receiver.Wait();
+
+        RemoteMessage caught;
+        Theron::Address from;
+        Check(!catcher.Empty(), "Failed to catch remote message");
+        Check(catcher.Pop(caught, from), "Failed to pop caught remote message");
+
+        Check(strcmp(caught.mData, "Hello") == 0, "Remote message has bad value");
+        Check(from == replier.GetAddress(), "Remote message from address is wrong");
+    }
+
 private:
 
     template <class MessageType>
@@ -190,6 +491,9 @@ private:
         Theron::Address mNotify;
     };
 
+public:
+
+    // Public so it can be registered with THERON_REGISTER_MESSAGE below.
     struct RemoteMessage
     {
         char mData[8];
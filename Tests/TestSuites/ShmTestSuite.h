@@ -0,0 +1,233 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+#ifndef THERON_TESTS_TESTSUITES_SHMTESTSUITE_H
+#define THERON_TESTS_TESTSUITES_SHMTESTSUITE_H
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+#include <Theron/Detail/Threading/Utils.h>
+#include <Theron/Detail/Transport/ShmRing.h>
+
+#include "TestFramework/TestSuite.h"
+
+
+#if !THERON_SHM
+#error This test suite requires shared memory transport support!
+#endif
+
+
+namespace Tests
+{
+
+
+class ShmTestSuite : public TestFramework::TestSuite
+{
+public:
+
+    inline ShmTestSuite()
+    {
+        TESTFRAMEWORK_REGISTER_TESTSUITE(ShmTestSuite);
+
+        TESTFRAMEWORK_REGISTER_TEST(RingRoundTrip);
+        TESTFRAMEWORK_REGISTER_TEST(RingOverrunResynchronizes);
+        TESTFRAMEWORK_REGISTER_TEST(LoopbackLocationProbe);
+        TESTFRAMEWORK_REGISTER_TEST(SendMessageBetweenShmEndPoints);
+    }
+
+    struct ShmMessage
+    {
+        char mData[8];
+    };
+
+    inline static void RingRoundTrip()
+    {
+        Theron::Detail::ShmRing writer;
+        Theron::Detail::ShmRing reader;
+
+        Check(writer.OpenAsWriter("shm://theron_test_ring"), "Failed to open ring as writer");
+        Check(reader.OpenAsReader("shm://theron_test_ring", true), "Failed to open ring as reader");
+
+        // The reader attaches at the current write position, so sees nothing yet.
+        uint32_t size(0);
+        Check(!reader.Peek(size), "Fresh reader saw a message");
+
+        // A single-part message round trip, via the blocking wait.
+        const char data[] = "0123456789";
+        Check(writer.Write(data, sizeof(data), false), "Failed to write message");
+        Check(reader.Wait(1000000), "Wait failed to report the published message");
+        Check(reader.Peek(size), "Failed to peek written message");
+        Check(size == sizeof(data), "Peeked message has wrong size");
+
+        char buffer[64];
+        bool moreParts(true);
+        Check(reader.Read(buffer, sizeof(buffer), size, moreParts), "Failed to read message");
+        Check(size == sizeof(data), "Read message has wrong size");
+        Check(!moreParts, "Single-part message reported more parts");
+        Check(memcmp(buffer, data, sizeof(data)) == 0, "Read message has wrong contents");
+
+        // The parts of a multipart message become visible atomically: nothing
+        // is readable until the final part is written.
+        Check(writer.Write(data, 5, true), "Failed to write first part");
+        Check(!reader.Peek(size), "Staged part visible before the final part");
+        Check(writer.Write(data, sizeof(data), false), "Failed to write final part");
+
+        Check(reader.Read(buffer, sizeof(buffer), size, moreParts), "Failed to read first part");
+        Check(size == 5 && moreParts, "First part has wrong size or flags");
+        Check(reader.Read(buffer, sizeof(buffer), size, moreParts), "Failed to read final part");
+        Check(size == sizeof(data) && !moreParts, "Final part has wrong size or flags");
+
+        Check(!reader.Peek(size), "Drained ring still has messages");
+    }
+
+    inline static void RingOverrunResynchronizes()
+    {
+        Theron::Detail::ShmRing writer;
+        Theron::Detail::ShmRing reader;
+
+        Check(writer.OpenAsWriter("shm://theron_test_overrun"), "Failed to open ring as writer");
+        Check(reader.OpenAsReader("shm://theron_test_overrun", true), "Failed to open ring as reader");
+
+        // Write more than a ring size without the reader keeping up, lapping it.
+        const uint32_t messageSize(64 * 1024);
+        char *const message(new char[messageSize]);
+        memset(message, 'x', messageSize);
+
+        const uint32_t count((THERON_SHM_RING_SIZE / messageSize) + 2);
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            Check(writer.Write(message, messageSize, false), "Failed to write message");
+        }
+
+        // The lapped reader detects the overrun, resynchronizes to the current
+        // write position, and reads subsequent messages normally.
+        char *const buffer(new char[messageSize]);
+        uint32_t size(0);
+        bool moreParts(false);
+
+        Check(!reader.Read(buffer, messageSize, size, moreParts), "Lapped reader read clobbered data");
+        Check(!reader.Peek(size), "Resynchronized reader saw stale messages");
+
+        Check(writer.Write(message, messageSize, false), "Failed to write message after overrun");
+        Check(reader.Read(buffer, messageSize, size, moreParts), "Failed to read after resynchronization");
+        Check(size == messageSize, "Message read after resynchronization has wrong size");
+
+        delete [] buffer;
+        delete [] message;
+    }
+
+    inline static void LoopbackLocationProbe()
+    {
+        // Loopback tcp locations are shared memory capable, and a probing
+        // reader attaches only when a live writer is serving the location.
+        Theron::Detail::ShmRing writer;
+        Check(
+            Theron::Detail::ShmRing::IsSharedMemoryLocation("tcp://127.0.0.1:15553"),
+            "Loopback location not recognized as shared memory capable");
+        Check(
+            !Theron::Detail::ShmRing::IsSharedMemoryLocation("tcp://192.168.0.1:15553"),
+            "Remote location wrongly recognized as shared memory capable");
+
+        Check(writer.OpenAsWriter("tcp://127.0.0.1:15553"), "Failed to open loopback ring as writer");
+
+        Theron::Detail::ShmRing reader;
+        Check(reader.OpenAsReader("tcp://127.0.0.1:15553", false), "Failed to probe live loopback ring");
+
+        // Equivalent spellings of the loopback host map to the same segment.
+        Theron::Detail::ShmRing alias;
+        Check(alias.OpenAsReader("tcp://localhost:15553", false), "Loopback alias failed to find the ring");
+
+        // Probing a location nobody is serving finds no ring.
+        Theron::Detail::ShmRing probe;
+        Check(!probe.OpenAsReader("tcp://127.0.0.1:15599", false), "Probe attached to a ring nobody serves");
+    }
+
+    inline static void SendMessageBetweenShmEndPoints()
+    {
+        typedef Replier<ShmMessage> ShmMessageReplier;
+        typedef Theron::Catcher<ShmMessage> ShmMessageCatcher;
+
+        // Create two local endpoints with explicit shared memory locations.
+        Theron::EndPoint endPointOne("shm_one", "shm://theron_test_endpoint_one");
+        Theron::EndPoint endPointTwo("shm_two", "shm://theron_test_endpoint_two");
+
+        // Connect the endpoints.
+        endPointOne.Connect("shm://theron_test_endpoint_two");
+        endPointTwo.Connect("shm://theron_test_endpoint_one");
+
+        // Create a framework and receiver at endpoint one.
+        Theron::Framework frameworkOne(endPointOne);
+        Theron::Receiver receiver(endPointOne, "shm_receiver");
+
+        // Create a replier in a framework at endpoint two.
+        Theron::Framework frameworkTwo(endPointTwo);
+        ShmMessageReplier replier(frameworkTwo, "shm_replier");
+
+        // Register a catcher with the receiver.
+        ShmMessageCatcher catcher;
+        receiver.RegisterHandler(&catcher, &ShmMessageCatcher::Push);
+
+        ShmMessage message;
+        message.mData[0] = 'H';
+        message.mData[1] = 'e';
+        message.mData[2] = 'l';
+        message.mData[3] = 'l';
+        message.mData[4] = 'o';
+        message.mData[5] = '\0';
+
+        // We have to resend until the name resolution catches up.
+        // Send the message and wait for the reply.
+        while (receiver.Count() == 0)
+        {
+            // We send the replier a message by name, and pass the receiver address by name.
+            frameworkOne.Send(
+                message,
+                Theron::Address("shm_receiver"),
+                Theron::Address("shm_replier"));
+
+            Theron::Detail::Utils::SleepThread(100);
+        }
+
+        receiver.Wait();
+
+        ShmMessage caught;
+        Theron::Address from;
+        Check(!catcher.Empty(), "Failed to catch shared memory message");
+        Check(catcher.Pop(caught, from), "Failed to pop caught shared memory message");
+
+        // Names shared between in-process endpoints resolve directly, so the
+        // reply carries the replier's own address rather than a name-only one.
+        Check(strcmp(caught.mData, "Hello") == 0, "Shared memory message has bad value");
+        Check(from == replier.GetAddress(), "Shared memory message from address is wrong");
+    }
+
+private:
+
+    template <class MessageType>
+    class Replier : public Theron::Actor
+    {
+    public:
+
+        inline explicit Replier(Theron::Framework &framework, const char *const name = 0) : Theron::Actor(framework, name)
+        {
+            RegisterHandler(this, &Replier::Handler);
+        }
+
+    private:
+
+        inline void Handler(const MessageType &message, const Theron::Address from)
+        {
+            Send(message, from);
+        }
+    };
+};
+
+
+} // namespace Tests
+
+
+THERON_REGISTER_MESSAGE(Tests::ShmTestSuite::ShmMessage);
+
+
+#endif // THERON_TESTS_TESTSUITES_SHMTESTSUITE_H
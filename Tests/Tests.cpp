@@ -16,6 +16,20 @@
 #include "TestSuites/NetworkTestSuite.h"
 #endif // THERON_XS
 
+#if THERON_SHM
+#include "TestSuites/ShmTestSuite.h"
+#endif // THERON_SHM
+
+
+THERON_DEFINE_REGISTERED_MESSAGE(Tests::PooledMessage);
+THERON_DEFINE_POOLED_MESSAGE(Tests::PooledMessage);
+
+THERON_DEFINE_REGISTERED_MESSAGE(Tests::CancelMessage);
+THERON_DEFINE_URGENT_MESSAGE(Tests::CancelMessage);
+
+THERON_DEFINE_REGISTERED_MESSAGE(Tests::SnapshotMessage);
+THERON_DEFINE_CONFLATABLE_MESSAGE(Tests::SnapshotMessage);
+
 
 /// Static instantiations of the test suites.
 Tests::FeatureTestSuite featureTestSuite;
@@ -25,6 +39,10 @@ Tests::LegacyTestSuite legacyTestSuite;
 Tests::NetworkTestSuite networkTestSuite;
 #endif // THERON_XS
 
+#if THERON_SHM
+Tests::ShmTestSuite shmTestSuite;
+#endif // THERON_SHM
+
 
 int main(int argc, char *argv[])
 {
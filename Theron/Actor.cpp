@@ -1,98 +1,169 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-#include <Theron/Actor.h>
-#include <Theron/Assert.h>
-#include <Theron/Framework.h>
-
-#include <Theron/Detail/Legacy/ActorRegistry.h>
-
-
-namespace Theron
-{
-
-
-Actor::Actor() :
-  mAddress(),
-  mFramework(0),
-  mMessageHandlers(),
-  mDefaultHandlers(),
-  mProcessorContext(0),
-  mRefCount(0),
-  mMemory(0)
-{
-    // This is the legacy way of constructing actors, from versions prior to 4.0.
-    // Lookup the register entry for this actor in the ActorRegistry.
-    // The entry should have been created by the owning Framework in CreateActor.
-    // The entry passes us a pointer to the owning Framework.
-    // We can't pass it through the default constructor so need this nasty kludge.
-    Detail::ActorRegistry::Entry *const entry(Detail::ActorRegistry::Lookup(this));
-
-    // If this assert fires that probably means the user is trying to use the default
-    // constructor of the Theron::Actor baseclass, which isn't allowed. Instead,
-    // use the explicit constructor and pass it a Framework object in the initializer
-    // list of the derived actor constructor:
-    //
-    // class MyActor : public Theron::Actor
-    // {
-    // public:
-    //     MyActor(Theron::Framework &framework) : Theron::Actor(framework)
-    //     {
-    //     }
-    // };
-
-    THERON_ASSERT_MSG(entry, "Actor baseclass not initialized. Use Theron::Actor::Actor(TheronFramework &framework).");
-
-    // Check that the entry is valid.
-    THERON_ASSERT(entry->mActor == this);
-    THERON_ASSERT(entry->mFramework != 0);
-    THERON_ASSERT(entry->mMemory != 0);
-
-    // Load the framework pointer from the entry.
-    mFramework = entry->mFramework;
-    mMemory = entry->mMemory;
-
-    // Claim an available directory index and mailbox for this actor.
-    mFramework->RegisterActor(this);
-}
-
-
-Actor::Actor(Framework &framework, const char *const name) :
-  mAddress(),
-  mFramework(&framework),
-  mMessageHandlers(),
-  mDefaultHandlers(),
-  mProcessorContext(0),
-  mRefCount(0),
-  mMemory(0)
-{
-    // Check that the actor isn't being constructed by Framework::CreateActor.
-    THERON_ASSERT_MSG(Detail::ActorRegistry::Lookup(this) == 0, "Use default Theron::Actor::Actor() baseclass constructor with CreateActor().");
-
-    // Claim an available directory index and mailbox for this actor.
-    mFramework->RegisterActor(this, name);
-}
-
-
-Actor::~Actor()
-{
-    mFramework->DeregisterActor(this);
-}
-
-
-void Actor::Fallback(
-    Detail::FallbackHandlerCollection *const fallbackHandlers,
-    const Detail::IMessage *const message)
-{
-    // If default handlers are registered with this actor, execute those.
-    if (mDefaultHandlers.Handle(this, message))
-    {
-        return;
-    }
-
-    // Let the framework's fallback handlers handle the message.
-    fallbackHandlers->Handle(message);
-}
-
-
-} // namespace Theron
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Actor.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/Framework.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Legacy/ActorRegistry.h>
+
+
+namespace Theron
+{
+
+
+#if !THERON_NO_LEGACY
+
+Actor::Actor() :
+  mAddress(),
+  mFramework(0),
+  mMessageHandlers(),
+  mDefaultHandlers(),
+  mContinuations(0),
+  mProcessorContext(0),
+  mCurrentFlowId(0),
+  mCurrentHighPriority(false),
+  mCurrentMessage(0),
+  mCurrentMessageStashed(false),
+  mRefCount(0),
+  mMemory(0)
+{
+    // This is the legacy way of constructing actors, from versions prior to 4.0.
+    // Lookup the register entry for this actor in the ActorRegistry.
+    // The entry should have been created by the owning Framework in CreateActor.
+    // The entry passes us a pointer to the owning Framework.
+    // We can't pass it through the default constructor so need this nasty kludge.
+    Detail::ActorRegistry::Entry *const entry(Detail::ActorRegistry::Lookup(this));
+
+    // If this assert fires that probably means the user is trying to use the default
+    // constructor of the Theron::Actor baseclass, which isn't allowed. Instead,
+    // use the explicit constructor and pass it a Framework object in the initializer
+    // list of the derived actor constructor:
+    //
+    // class MyActor : public Theron::Actor
+    // {
+    // public:
+    //     MyActor(Theron::Framework &framework) : Theron::Actor(framework)
+    //     {
+    //     }
+    // };
+
+    THERON_ASSERT_MSG(entry, "Actor baseclass not initialized. Use Theron::Actor::Actor(TheronFramework &framework).");
+
+    // Check that the entry is valid.
+    THERON_ASSERT(entry->mActor == this);
+    THERON_ASSERT(entry->mFramework != 0);
+    THERON_ASSERT(entry->mMemory != 0);
+
+    // Load the framework pointer from the entry.
+    mFramework = entry->mFramework;
+    mMemory = entry->mMemory;
+
+    // Claim an available directory index and mailbox for this actor.
+    mFramework->RegisterActor(this);
+}
+
+#endif // !THERON_NO_LEGACY
+
+
+Actor::Actor(Framework &framework, const char *const name) :
+  mAddress(),
+  mFramework(&framework),
+  mMessageHandlers(),
+  mDefaultHandlers(),
+  mContinuations(0),
+  mProcessorContext(0),
+  mCurrentFlowId(0),
+  mCurrentHighPriority(false),
+  mCurrentMessage(0),
+  mCurrentMessageStashed(false),
+  mRefCount(0),
+  mMemory(0)
+{
+#if !THERON_NO_LEGACY
+    // Check that the actor isn't being constructed by Framework::CreateActor.
+    // The registry probe takes the registry lock, so the legacy profile strips it.
+    THERON_ASSERT_MSG(Detail::ActorRegistry::Lookup(this) == 0, "Use default Theron::Actor::Actor() baseclass constructor with CreateActor().");
+#endif // !THERON_NO_LEGACY
+
+    // Claim an available directory index and mailbox for this actor.
+    mFramework->RegisterActor(this, name);
+}
+
+
+Actor::~Actor()
+{
+    // Free any continuations still pending replies that never arrived.
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    Detail::IContinuation *pending(mContinuations);
+    while (pending)
+    {
+        Detail::IContinuation *const next(pending->GetNext());
+
+        pending->~IContinuation();
+        allocator->Free(pending);
+
+        pending = next;
+    }
+
+    mFramework->DeregisterActor(this);
+}
+
+
+bool Actor::HandleContinuation(const Detail::IMessage *const message)
+{
+    // Walk the pending continuations oldest-first so that replies to
+    // identical outstanding requests consume their continuations in the
+    // order the requests were sent.
+    Detail::IContinuation *previous(0);
+    Detail::IContinuation *pending(mContinuations);
+
+    while (pending)
+    {
+        // Match first on the sender, then let the continuation itself probe the
+        // message type. Handle has no effect if the type doesn't match.
+        if (pending->GetFrom() == message->From() && pending->Handle(this, message))
+        {
+            // Continuations are one-shot; unlink and free the consumed entry.
+            if (previous)
+            {
+                previous->SetNext(pending->GetNext());
+            }
+            else
+            {
+                mContinuations = pending->GetNext();
+            }
+
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+            pending->~IContinuation();
+            allocator->Free(pending);
+
+            return true;
+        }
+
+        previous = pending;
+        pending = pending->GetNext();
+    }
+
+    return false;
+}
+
+
+void Actor::Fallback(
+    Detail::FallbackHandlerCollection *const fallbackHandlers,
+    const Detail::IMessage *const message)
+{
+    // If default handlers are registered with this actor, execute those.
+    if (mDefaultHandlers.Handle(this, message))
+    {
+        return;
+    }
+
+    // Let the framework's fallback handlers handle the message.
+    fallbackHandlers->Handle(message);
+}
+
+
+} // namespace Theron
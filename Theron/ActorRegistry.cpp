@@ -4,6 +4,9 @@
 #include <Theron/Detail/Legacy/ActorRegistry.h>
 
 
+#if !THERON_NO_LEGACY
+
+
 namespace Theron
 {
 namespace Detail
@@ -79,3 +82,6 @@ ActorRegistry::Entry *ActorRegistry::Lookup(Actor *const actor)
 } // namespace Detail
 } // namespace Theron
 
+
+#endif // !THERON_NO_LEGACY
+
@@ -0,0 +1,25 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Address.h>
+#include <Theron/EndPoint.h>
+
+#include <Theron/Detail/Messages/MessageSender.h>
+#include <Theron/Detail/Network/String.h>
+
+
+namespace Theron
+{
+
+
+const char *Address::ResolveName() const
+{
+    // The name of a local entity is recovered from its registration. The
+    // returned pointer is to the interned name value, which remains valid
+    // while the entity holds its reference, i.e. while it stays registered.
+    const Detail::String name(Detail::MessageSender::ResolveName(mIndex));
+    return name.GetValue();
+}
+
+
+} // namespace Theron
@@ -1,457 +1,1663 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-#include <Theron/Defines.h>
-
-// Must include xs.h before standard headers to avoid warnings in MS headers!
-#if THERON_XS
-#include <xs/xs.h>
-#endif // THERON_XS
-
-#include <new>
-
-#include <Theron/Address.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/Assert.h>
-#include <Theron/EndPoint.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Messages/MessageCreator.h>
-#include <Theron/Detail/Messages/MessageSender.h>
-#include <Theron/Detail/Network/MessageFactory.h>
-#include <Theron/Detail/Network/NetworkMessage.h>
-#include <Theron/Detail/Threading/Utils.h>
-#include <Theron/Detail/Transport/InputMessage.h>
-#include <Theron/Detail/Transport/InputSocket.h>
-#include <Theron/Detail/Transport/OutputMessage.h>
-#include <Theron/Detail/Transport/OutputSocket.h>
-
-
-namespace Theron
-{
-
-
-Detail::SpinLock EndPoint::smContextLock;
-uint32_t EndPoint::smContextRefCount(0);
-Detail::Context *EndPoint::smContext(0);
-
-
-Detail::Context *EndPoint::InitializeContext()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    smContextLock.Lock();
-
-    if (smContext == 0)
-    {
-        // Allocate and construct a context structure.
-        void *const contextMemory(allocator->Allocate(sizeof(Detail::Context)));
-
-        THERON_ASSERT_MSG(contextMemory, "Failed to allocate endPoint context object");
-        smContext = new (contextMemory) Detail::Context();
-        
-        smContextRefCount = 0;
-    }
-
-    ++smContextRefCount;
-
-    smContextLock.Unlock();
-
-    THERON_ASSERT(smContext);
-    return smContext;
-}
-
-
-void EndPoint::ReleaseContext()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    THERON_ASSERT(smContext);
-    THERON_ASSERT(smContextRefCount);
-
-    smContextLock.Lock();
-
-    if (--smContextRefCount == 0)
-    {
-        smContext->~Context();
-        allocator->Free(smContext, sizeof(Detail::Context));
-        smContext = 0;
-    }
-
-    smContextLock.Unlock();
-}
-
-
-EndPoint::EndPoint(const char *const name, const char *const location, const Parameters /*params*/) :
-  mName(name),
-  mLocation(location),
-  mContext(0),
-  mNameMap(),
-  mMessageFactory(),
-  mNetworkThread(),
-  mRunning(false),
-  mStarted(false),
-  mNetworkLock(),
-  mConnectQueue(),
-  mSendQueue()
-{
-    THERON_ASSERT_MSG(!mName.IsNull(), "Must supply a unique, non-null name for each endpoint");
-    THERON_ASSERT_MSG(!mLocation.IsNull(), "Must supply a valid port address for each endpoint");
-
-    // Initialize the per-process context.
-    mContext = InitializeContext();
-
-    // Don't start the network thread if networking isn't enabled.
-    if (mContext->Enabled())
-    {
-        // Start the network thread.
-        mRunning = true;
-        mNetworkThread.Start(NetworkThreadEntryPoint, this);
-
-        // Wait for the network thread to start.
-        uint32_t backoff(0);
-        while (!mStarted)
-        {
-            Detail::Utils::Backoff(backoff);
-        }
-    }
-}
-
-
-EndPoint::~EndPoint()
-{
-    // No network thread if networking isn't enabled.
-    if (mContext->Enabled())
-    {
-        // Kill the network thread and wait for it to terminate.
-        mRunning = false;
-        mNetworkThread.Join();
-    }
-
-    // Release the per-process context.
-    ReleaseContext();
-}
-
-
-bool EndPoint::Connect(const char *const address)
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    if (address == 0)
-    {
-        return false;
-    }
-
-    // Fail if networking isn't enabled.
-    if (!mContext->Enabled())
-    {
-        return false;
-    }
-
-    // Allocate and construct a request structure.
-    void *const requestMemory(allocator->Allocate(sizeof(ConnectRequest)));
-    if (requestMemory == 0)
-    {
-        return false;
-    }
-
-    ConnectRequest *const request = new (requestMemory) ConnectRequest(address);
-
-    // Push it onto the queue to be serviced by the network thread.
-    mNetworkLock.Lock();
-    mConnectQueue.Push(request);
-    mNetworkLock.Unlock();
-
-    return true;
-}
-
-
-bool EndPoint::RequestSend(Detail::IMessage *const message, const Detail::String &name)
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    if (message == 0 || name.IsNull())
-    {
-        return false;
-    }
-
-    // Allocate and construct a request structure.
-    void *const requestMemory(allocator->Allocate(sizeof(SendRequest)));
-    if (requestMemory == 0)
-    {
-        return false;
-    }
-
-    SendRequest *const request = new (requestMemory) SendRequest(message, name);
-
-    // Push it onto the queue to be serviced by the network thread.
-    mNetworkLock.Lock();
-    mSendQueue.Push(request);
-    mNetworkLock.Unlock();
-
-    return true;
-}
-
-
-void EndPoint::NetworkThreadEntryPoint(void *const context)
-{
-    // The static entry point function is passed the object pointer as context.
-    EndPoint *const endPoint(reinterpret_cast<EndPoint *>(context));
-    endPoint->NetworkThreadProc();
-}
-
-
-void EndPoint::NetworkThreadProc()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    THERON_ASSERT(mContext);
-    THERON_ASSERT(!mLocation.IsNull());
-
-    // Create the output socket.
-    // This is the socket we use to publish messages sent by local actors.
-    // EndPoint objects in other processors or on other hosts create SUB sockets
-    // and connect them to the same endpoint.
-    void *const outputSocketMemory(allocator->Allocate(sizeof(Detail::OutputSocket)));
-    if (outputSocketMemory == 0)
-    {
-        THERON_FAIL_MSG("Failed to allocate output socket");
-    }
-
-    Detail::OutputSocket *const outputSocket = new (outputSocketMemory) Detail::OutputSocket(mContext);
-
-    // Create the input socket.
-    // This is the socket we use to subscribe to messages published by other actors.
-    // We connect to the endpoints of the publish sockets of the remote processes.
-    void *const inputSocketMemory(allocator->Allocate(sizeof(Detail::InputSocket)));
-    if (inputSocketMemory == 0)
-    {
-        THERON_FAIL_MSG("Failed to allocate input socket");
-    }
-
-    Detail::InputSocket *const inputSocket = new (inputSocketMemory) Detail::InputSocket(mContext);
-
-    // Bind the output socket to the local endpoint that is this EndPoint's address.
-    if (!outputSocket->Bind(mLocation.GetValue()))
-    {
-        THERON_FAIL_MSG("Failed to bind output socket to endpoint - check network support is enabled");
-    }
-
-    // Create a network output message, which we reuse to send network messages within the loop.
-    void *const outputMessageMemory(allocator->Allocate(sizeof(Detail::OutputMessage)));
-    if (outputMessageMemory == 0)
-    {
-        THERON_FAIL_MSG("Failed to allocate output message");
-    }
-
-    Detail::OutputMessage *const outputMessage = new (outputMessageMemory) Detail::OutputMessage(mContext);
-
-    // Create a network input message, which we reuse to receive network messages within the loop.
-    void *const inputMessageMemory(allocator->Allocate(sizeof(Detail::InputMessage)));
-    if (inputMessageMemory == 0)
-    {
-        THERON_FAIL_MSG("Failed to allocate input message");
-    }
-
-    Detail::InputMessage *const inputMessage = new (inputMessageMemory) Detail::InputMessage(mContext);
-
-    // Initialize the input message once outside the loop.
-    if (!inputMessage->Initialize())
-    {
-        THERON_FAIL_MSG("Failed to initialize network input message");
-    }
-
-    // Signal the main thread that we've started.
-    mStarted = true;
-
-    while (mRunning)
-    {
-        mNetworkLock.Lock();
-
-        // Service connection requests.
-        while (!mConnectQueue.Empty())
-        {
-            ConnectRequest *const request(mConnectQueue.Pop());
-            const char *const address(request->mLocation.GetValue());
-
-            mNetworkLock.Unlock();
-
-            // Connect the input socket to the remote host.
-            // The same socket can be connected to multiple remote endpoints.
-            if (!inputSocket->Connect(address))
-            {
-                THERON_FAIL_MSG("Failed to connect input socket to remote endpoint");
-            }
-
-            mNetworkLock.Lock();
-
-            request->~ConnectRequest();
-            allocator->Free(request, sizeof(ConnectRequest));
-        }
-
-        // Service send requests.
-        while (!mSendQueue.Empty())
-        {
-            SendRequest *const request(mSendQueue.Pop());
-
-            mNetworkLock.Unlock();
-
-            THERON_ASSERT_MSG(outputSocket, "No output socket found");
-
-            Detail::IMessage *const message(request->mMessage);
-            const char *const fromName(message->From().AsString());
-            const char *const toName(request->mName.GetValue());
-            const char *const messageName(message->TypeName());
-            const void *const messageData(message->GetMessageData());
-            const uint32_t messageSize(message->GetMessageSize());
-
-            THERON_ASSERT_MSG(messageName, "Can't send unregistered messages to actors addressed by name!");
-
-            // Calculate the size of the network message.
-            const uint32_t networkMessageSize = Detail::NetworkMessage::GetSize(
-                fromName,
-                toName,
-                messageName,
-                messageData,
-                messageSize);
-
-            // Initialize the output message.
-            if (!outputMessage->Initialize(networkMessageSize))
-            {
-                THERON_FAIL_MSG("Failed to initialize network output message");
-            }
-
-            // Initialize the XS message block as a network message.
-            // This copies the message data into the memory block.
-            void *const memoryBlock(outputMessage->Data());
-            Detail::NetworkMessage::Initialize(
-                memoryBlock,
-                fromName,
-                toName,
-                messageName,
-                messageData,
-                messageSize);
-
-            // Send the network message.
-            if (!outputSocket->Send(outputMessage))
-            {
-                THERON_FAIL_MSG("Failed to send network output message");
-            }
-
-            // Release the output message.
-            if (!outputMessage->Release())
-            {
-                THERON_FAIL_MSG("Failed to release network output message");
-            }
-
-            // Destroy the local message.
-            // We return the message memory block to the global allocator.
-            Detail::MessageCreator::Destroy(allocator, message);
-
-            // Destroy the request structure.
-            request->~SendRequest();
-            allocator->Free(request, sizeof(SendRequest));
-
-            mNetworkLock.Lock();
-        }
-
-        mNetworkLock.Unlock();
-
-        // Read messages from the input socket without blocking.
-        while (inputSocket->NonBlockingReceive(inputMessage))
-        {
-            // Read the data from the received network message.
-            const uint32_t networkMessageSize(inputMessage->Size());
-            if (networkMessageSize < sizeof(Detail::NetworkMessage))
-            {
-                THERON_FAIL_MSG("Invalid XS message data size");
-            }
-
-            const Detail::NetworkMessage *const networkMessage(reinterpret_cast<Detail::NetworkMessage *>(inputMessage->Data()));
-            if (networkMessage == 0)
-            {
-                THERON_FAIL_MSG("Invalid XS message data pointer");
-            }
-
-            const char *const fromName(networkMessage->GetFromName());
-            const Detail::String toName(networkMessage->GetToName());
-            const Detail::String messageName(networkMessage->GetMessageName());
-            const void *const messageData(networkMessage->GetMessageData());
-            const uint32_t messageSize(networkMessage->GetMessageSize());
-
-            // Look up the to address index using the received name.
-            // If the name isn't known to us we just discard the message.
-            Detail::Index toIndex;
-            if (Lookup(toName, toIndex))
-            {
-                // Construct the name-only 'from' address.
-                const Address fromAddress(fromName);
-
-                // Try to build a message from the data based on the message name.
-                Detail::IMessage *const message = mMessageFactory.Build(
-                    messageName,
-                    messageData,
-                    messageSize,
-                    fromAddress);
-
-                if (message)
-                {
-                    // Try to deliver the allocated message to an actor in a local framework.
-                    if (!Detail::MessageSender::DeliverWithinLocalProcess(message, toIndex))
-                    {
-                        // Destroy the undelivered message using the global allocator.
-                        Detail::MessageCreator::Destroy(allocator, message);
-                    }
-                }
-            }
-        }
-
-        // The network thread spends most of its time asleep.
-        Detail::Utils::SleepThread(1);
-    }
-
-    mNetworkLock.Lock();
-
-    // Drain the connection request queue.
-    while (!mConnectQueue.Empty())
-    {
-        ConnectRequest *const request(mConnectQueue.Pop());
-        request->~ConnectRequest();
-        allocator->Free(request, sizeof(ConnectRequest));
-    }
-
-    // Drain the send request queue.
-    while (!mSendQueue.Empty())
-    {
-        SendRequest *const request(mSendQueue.Pop());
-        request->~SendRequest();
-        allocator->Free(request, sizeof(SendRequest));
-    }
-
-    mNetworkLock.Unlock();
-
-    // Release the input message used repeatedly within the loop.
-    if (!inputMessage->Release())
-    {
-        THERON_FAIL_MSG("Failed to release network input message");
-    }
-
-    // Destroy the output and input messages.
-    outputMessage->~OutputMessage();
-    allocator->Free(outputMessage, sizeof(Detail::OutputMessage));
-
-    inputMessage->~InputMessage();
-    allocator->Free(inputMessage, sizeof(Detail::InputMessage));
-
-    // Destroy the output and input sockets.
-    outputSocket->~OutputSocket();
-    allocator->Free(outputSocket, sizeof(Detail::OutputSocket));
-
-    inputSocket->~InputSocket();
-    allocator->Free(inputSocket, sizeof(Detail::InputSocket));
-}
-
-
-} // namespace Theron
-
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Defines.h>
+
+// Must include xs.h before standard headers to avoid warnings in MS headers!
+#if THERON_XS
+#include <xs/xs.h>
+#endif // THERON_XS
+
+#include <new>
+
+#include <Theron/Address.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/EndPoint.h>
+#include <Theron/IAllocator.h>
+#include <Theron/ICompressor.h>
+
+#include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Messages/MessageSender.h>
+#include <Theron/Detail/Network/FlatMessage.h>
+#include <Theron/Detail/Network/MessageFactory.h>
+#include <Theron/Detail/Network/MessageJournal.h>
+#include <Theron/Detail/Network/NetworkMessage.h>
+#include <Theron/Detail/Network/StringPool.h>
+#include <Theron/Detail/SIMD/MemoryCopy.h>
+#include <Theron/Detail/Threading/Atomic.h>
+#include <Theron/Detail/Threading/Utils.h>
+#include <Theron/Detail/Transport/InputMessage.h>
+#include <Theron/Detail/Transport/InputSocket.h>
+#include <Theron/Detail/Transport/OutputMessage.h>
+#include <Theron/Detail/Transport/OutputSocket.h>
+
+
+namespace Theron
+{
+
+
+namespace
+{
+
+
+// Payloads at least this large are sent zero-copy, referenced directly by the
+// transport rather than copied into a transport-owned buffer. Small payloads
+// are cheaper to copy than to track through the transport's free callback, so
+// are coalesced into batches instead; a small payload that doesn't fit a
+// batch is nevertheless sent zero-copy, so no send path concatenates the
+// payload into a transport frame.
+const uint32_t ZERO_COPY_THRESHOLD = 1024;
+
+
+// Batches of coalesced messages are distinguished from single messages by a
+// leading marker word. A single NetworkMessage starts with an offset field
+// that is always at least the size of the structure, so can never be zero.
+const uint32_t BATCH_MARKER = 0;
+const uint32_t BATCH_HEADER_SIZE = 8;   // Marker word plus message count.
+
+
+// Compressed batches carry their own marker word, distinct from the batch
+// marker, the flat message marker, and any possible NetworkMessage offset,
+// followed by the uncompressed size of the batch within.
+const uint32_t COMPRESSED_MARKER = 2;
+const uint32_t COMPRESSED_HEADER_SIZE = 8;  // Marker word plus uncompressed size.
+
+
+// Writes a sequencing envelope at the start of an outgoing frame buffer.
+void WriteSequencedHeader(void *const buffer, const uint32_t senderId, const uint64_t sequence)
+{
+    Detail::SequencedHeader header;
+    header.mMarker = Detail::SequencedHeader::MARKER;
+    header.mSenderId = senderId;
+    header.mSequence = sequence;
+
+    memcpy(buffer, &header, sizeof(header));
+}
+
+
+// Sends the accumulated batch of coalesced messages, if any, and resets the batch.
+void FlushBatch(
+    Detail::OutputSocket *const outputSocket,
+    Detail::OutputMessage *const outputMessage,
+    uint8_t *const batchBuffer,
+    uint32_t &batchOffset,
+    uint32_t &batchCount,
+    uint32_t &batchAge,
+    ICompressor *const compressor,
+    uint8_t *const compressBuffer,
+    const uint32_t compressCapacity)
+{
+    if (batchCount == 0)
+    {
+        return;
+    }
+
+    // Write the batch header at the start of the buffer.
+    uint32_t count(batchCount);
+    memcpy(batchBuffer, &BATCH_MARKER, sizeof(uint32_t));
+    memcpy(batchBuffer + sizeof(uint32_t), &count, sizeof(uint32_t));
+
+    const uint8_t *sendData(batchBuffer);
+    uint32_t sendSize(batchOffset);
+
+    // Compress the whole batch as one block, if a codec is configured, so the
+    // codec sees the redundancy between the small messages coalesced into it.
+    // A batch the codec fails to shrink is sent raw; the formats are
+    // distinguished on receive by their marker words.
+    if (compressor)
+    {
+        const uint32_t compressedSize(compressor->Compress(
+            batchBuffer,
+            batchOffset,
+            compressBuffer + COMPRESSED_HEADER_SIZE,
+            compressCapacity - COMPRESSED_HEADER_SIZE));
+
+        if (compressedSize != 0 && COMPRESSED_HEADER_SIZE + compressedSize < batchOffset)
+        {
+            uint32_t uncompressedSize(batchOffset);
+            memcpy(compressBuffer, &COMPRESSED_MARKER, sizeof(uint32_t));
+            memcpy(compressBuffer + sizeof(uint32_t), &uncompressedSize, sizeof(uint32_t));
+
+            sendData = compressBuffer;
+            sendSize = COMPRESSED_HEADER_SIZE + compressedSize;
+        }
+    }
+
+    // Send the whole batch as a single framed network message.
+    if (!outputMessage->Initialize(sendSize))
+    {
+        THERON_FAIL_MSG("Failed to initialize network batch message");
+    }
+
+    // Large batches are streamed past the cache with non-temporal stores; the
+    // buffer is read next by the transport rather than this thread.
+    Detail::MemoryCopy(outputMessage->Data(), sendData, sendSize);
+
+    if (!outputSocket->Send(outputMessage))
+    {
+        THERON_FAIL_MSG("Failed to send network batch message");
+    }
+
+    if (!outputMessage->Release())
+    {
+        THERON_FAIL_MSG("Failed to release network batch message");
+    }
+
+    batchOffset = BATCH_HEADER_SIZE;
+    batchCount = 0;
+    batchAge = 0;
+}
+
+
+// Free callback executed by the transport once a zero-copy payload has been sent.
+// The hint is the sent Theron message, which owns the referenced payload data.
+void FreeZeroCopyMessage(void *const /*data*/, void *const hint)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    Detail::IMessage *const message(reinterpret_cast<Detail::IMessage *>(hint));
+
+    // Destroy the local message, returning its memory block to the global allocator.
+    // The callback can be executed on an internal transport thread, but the
+    // global allocator is thread-safe.
+    Detail::MessageCreator::Destroy(allocator, message);
+}
+
+
+// Bookkeeping for a payload streamed as a pipeline of chunk parts, each of
+// which references a slice of the data of a single sent Theron message.
+struct ChunkSendState
+{
+    inline ChunkSendState(Detail::IMessage *const message, const uint32_t chunkCount) :
+      mMessage(message)
+    {
+        mRemaining.Store(chunkCount);
+    }
+
+    Detail::Atomic::UInt32 mRemaining;      ///< Number of chunk parts not yet sent by the transport.
+    Detail::IMessage *mMessage;             ///< The sent Theron message owning the referenced data.
+};
+
+
+// Free callback executed by the transport once a chunk part has been sent.
+// The chunks of a payload are sent independently, so the sent message is only
+// destroyed once the transport is finished with the last of them.
+void FreeChunkPart(void *const /*data*/, void *const hint)
+{
+    ChunkSendState *const state(reinterpret_cast<ChunkSendState *>(hint));
+
+    // The decrement returns the count held before the decrement.
+    if (state->mRemaining.FetchDecrement() == 1)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        Detail::MessageCreator::Destroy(allocator, state->mMessage);
+
+        state->~ChunkSendState();
+        allocator->Free(state, sizeof(ChunkSendState));
+    }
+}
+
+
+} // namespace
+
+
+Detail::SpinLock EndPoint::smContextLock;
+uint32_t EndPoint::smContextRefCount(0);
+Detail::Context *EndPoint::smContext(0);
+
+
+Detail::Context *EndPoint::InitializeContext(const uint32_t ioThreadCount)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    smContextLock.Lock();
+
+    if (smContext == 0)
+    {
+        // Allocate and construct a context structure.
+        // The transport's internal I/O thread count can only be set at context
+        // creation, so it is scaled by the first endpoint created in the process.
+        void *const contextMemory(allocator->Allocate(sizeof(Detail::Context)));
+
+        THERON_ASSERT_MSG(contextMemory, "Failed to allocate endPoint context object");
+        smContext = new (contextMemory) Detail::Context(ioThreadCount);
+
+        smContextRefCount = 0;
+    }
+
+    ++smContextRefCount;
+
+    smContextLock.Unlock();
+
+    THERON_ASSERT(smContext);
+    return smContext;
+}
+
+
+void EndPoint::ReleaseContext()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    THERON_ASSERT(smContext);
+    THERON_ASSERT(smContextRefCount);
+
+    smContextLock.Lock();
+
+    if (--smContextRefCount == 0)
+    {
+        smContext->~Context();
+        allocator->Free(smContext, sizeof(Detail::Context));
+        smContext = 0;
+    }
+
+    smContextLock.Unlock();
+}
+
+
+EndPoint::EndPoint(const char *const name, const char *const location, const Parameters params) :
+  mParams(params),
+  mName(name),
+  mLocation(location),
+  mContext(0),
+  mNameMap(),
+  mMessageFactory(),
+  mJournal(),
+  mShards(0),
+  mNumShards(params.mNetworkThreadCount > 0 ? params.mNetworkThreadCount : 1),
+  mDeliveryWorkers(0),
+  mNumDeliveryWorkers(0),
+  mRunning(false),
+  mSendSequence(0),
+  mNetworkLock()
+{
+    THERON_ASSERT_MSG(!mName.IsNull(), "Must supply a unique, non-null name for each endpoint");
+    THERON_ASSERT_MSG(!mLocation.IsNull(), "Must supply a valid port address for each endpoint");
+
+    // Take a reference to the process-wide name registry, which endpoints
+    // share so in-process names resolve without a network round-trip.
+    if (!Detail::ProcessNameRegistry::Reference())
+    {
+        THERON_FAIL_MSG("Failed to allocate the process-wide name registry");
+    }
+
+    // Initialize the per-process context, scaling the transport's internal
+    // I/O threads to match the pump threads if this call creates it.
+    mContext = InitializeContext(mNumShards);
+
+    // Don't start the network threads if networking isn't enabled.
+    if (mContext->Enabled())
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        // Open the optional send journal before the network threads start,
+        // since the sending thread appends to it without synchronization.
+        if (mParams.mJournalPath)
+        {
+            mJournal.Open(mParams.mJournalPath, mParams.mJournalSizeBytes);
+        }
+
+        // Allocate and construct the per-thread delivery workers, and start
+        // their threads, before the network threads start handing them frames.
+        if (mParams.mDeliveryThreadCount > 0)
+        {
+            mNumDeliveryWorkers = mParams.mDeliveryThreadCount;
+
+            void *const workerMemory(allocator->Allocate(mNumDeliveryWorkers * sizeof(DeliveryWorker)));
+            THERON_ASSERT_MSG(workerMemory, "Failed to allocate delivery workers");
+
+            mDeliveryWorkers = reinterpret_cast<DeliveryWorker *>(workerMemory);
+
+            for (uint32_t index = 0; index < mNumDeliveryWorkers; ++index)
+            {
+                DeliveryWorker *const worker = new (mDeliveryWorkers + index) DeliveryWorker();
+                worker->mEndPoint = this;
+                worker->mThread.Start(DeliveryThreadEntryPoint, worker);
+            }
+
+            // Wait for the delivery threads to start.
+            for (uint32_t index = 0; index < mNumDeliveryWorkers; ++index)
+            {
+                uint32_t backoff(0);
+                while (!mDeliveryWorkers[index].mStarted)
+                {
+                    Detail::Utils::Backoff(backoff);
+                }
+            }
+        }
+
+        // Allocate and construct the per-thread shards.
+        void *const shardMemory(allocator->Allocate(mNumShards * sizeof(NetworkShard)));
+        THERON_ASSERT_MSG(shardMemory, "Failed to allocate network shards");
+
+        mShards = reinterpret_cast<NetworkShard *>(shardMemory);
+        mRunning = true;
+
+        // Start a network thread per shard.
+        for (uint32_t index = 0; index < mNumShards; ++index)
+        {
+            NetworkShard *const shard = new (mShards + index) NetworkShard();
+            shard->mEndPoint = this;
+            shard->mIndex = index;
+            shard->mThread.Start(NetworkThreadEntryPoint, shard);
+        }
+
+        // Wait for the network threads to start.
+        for (uint32_t index = 0; index < mNumShards; ++index)
+        {
+            uint32_t backoff(0);
+            while (!mShards[index].mStarted)
+            {
+                Detail::Utils::Backoff(backoff);
+            }
+        }
+    }
+}
+
+
+EndPoint::~EndPoint()
+{
+    // No network threads if networking isn't enabled.
+    if (mContext->Enabled())
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+        // Kill the network threads and wait for them to terminate.
+        mRunning = false;
+
+        for (uint32_t index = 0; index < mNumShards; ++index)
+        {
+            mShards[index].mThread.Join();
+            mShards[index].~NetworkShard();
+        }
+
+        allocator->Free(mShards, mNumShards * sizeof(NetworkShard));
+        mShards = 0;
+
+        // Stop the delivery threads, now that the network threads feeding them
+        // have terminated. Each thread drains its remaining queue before exiting.
+        if (mDeliveryWorkers)
+        {
+            for (uint32_t index = 0; index < mNumDeliveryWorkers; ++index)
+            {
+                mDeliveryWorkers[index].mStop = true;
+                mDeliveryWorkers[index].mThread.Join();
+                mDeliveryWorkers[index].~DeliveryWorker();
+            }
+
+            allocator->Free(mDeliveryWorkers, mNumDeliveryWorkers * sizeof(DeliveryWorker));
+            mDeliveryWorkers = 0;
+        }
+
+        // Close the send journal, now that the writing thread has terminated.
+        mJournal.Close();
+    }
+
+    // Release the per-process context.
+    ReleaseContext();
+
+    // Release the reference to the process-wide name registry.
+    Detail::ProcessNameRegistry::Release();
+}
+
+
+uint32_t EndPoint::HashLocation(const char *const address) const
+{
+    // Simple multiplicative string hash, reduced modulo the shard count.
+    uint32_t hash(5381);
+    for (const char *ch = address; *ch != '\0'; ++ch)
+    {
+        hash = hash * 33 + static_cast<uint32_t>(*ch);
+    }
+
+    return hash % mNumShards;
+}
+
+
+bool EndPoint::Connect(const char *const address)
+{
+    if (address == 0)
+    {
+        return false;
+    }
+
+    // Fail if networking isn't enabled.
+    if (!mContext->Enabled())
+    {
+        return false;
+    }
+
+    // Assign the connection to a shard by address hash, fanning the
+    // connections out over the network threads.
+    NetworkShard &shard(mShards[HashLocation(address)]);
+
+    // Push the location onto the queue to be serviced by the shard's network
+    // thread. The queue copies it into its own contiguous storage.
+    shard.mLock.Lock();
+    const bool pushed(shard.mConnectQueue.Push(Detail::String(address)));
+    shard.mLock.Unlock();
+
+    return pushed;
+}
+
+
+bool EndPoint::RequestSend(Detail::IMessage *const message, const Detail::String &name)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    if (message == 0 || name.IsNull())
+    {
+        return false;
+    }
+
+    // Allocate and construct a request structure.
+    void *const requestMemory(allocator->Allocate(sizeof(SendRequest)));
+    if (requestMemory == 0)
+    {
+        return false;
+    }
+
+    SendRequest *const request = new (requestMemory) SendRequest(message, name);
+
+    // Push it onto the lane for its destination, to be serviced by the network
+    // thread. Hashing the destination name keeps each destination's requests
+    // in a single lane, preserving per-destination ordering.
+    const uint32_t lane(name.GetHash() & (NUM_SEND_LANES - 1));
+
+    mNetworkLock.Lock();
+    mSendLanes[lane].Push(request);
+    mNetworkLock.Unlock();
+
+    return true;
+}
+
+
+void EndPoint::NetworkThreadEntryPoint(void *const context)
+{
+    // The static entry point function is passed the shard pointer as context.
+    NetworkShard *const shard(reinterpret_cast<NetworkShard *>(context));
+    shard->mEndPoint->NetworkThreadProc(shard);
+}
+
+
+void EndPoint::NetworkThreadProc(NetworkShard *const shard)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    THERON_ASSERT(mContext);
+    THERON_ASSERT(!mLocation.IsNull());
+
+    // Only one socket can be bound to the endpoint's address, so the first
+    // shard owns the output socket and services all outgoing sends. The other
+    // shards are input-only, each receiving from the connections assigned to it.
+    const bool sender(shard->mIndex == 0);
+
+    Detail::OutputSocket *outputSocket(0);
+    Detail::OutputMessage *outputMessage(0);
+    Detail::OutputMessage *payloadMessage(0);
+    uint8_t *batchBuffer(0);
+
+    // Optional batch compression codec, with a scratch buffer sized to the
+    // codec's worst case for a full batch, and a lazily grown buffer into
+    // which received compressed batches are decompressed.
+    ICompressor *const compressor(mParams.mCompressor);
+    uint8_t *compressBuffer(0);
+    uint32_t compressCapacity(0);
+    uint8_t *decompressBuffer(0);
+    uint32_t decompressCapacity(0);
+
+    const uint32_t minimumCapacity(BATCH_HEADER_SIZE + sizeof(uint32_t) + sizeof(Detail::NetworkMessage));
+    const uint32_t batchCapacity(mParams.mBatchSizeThreshold > minimumCapacity ? mParams.mBatchSizeThreshold : minimumCapacity);
+    const uint32_t batchTimeout(mParams.mBatchTimeoutMilliseconds > 0 ? mParams.mBatchTimeoutMilliseconds : 1);
+
+    uint32_t batchOffset(BATCH_HEADER_SIZE);
+    uint32_t batchCount(0);
+    uint32_t batchAge(0);
+
+    // Round-robin state of the outbound send lanes, persisting across passes
+    // of the service loop so fairness carries over between them.
+    const uint32_t sendWindow(mParams.mSendWindowBytes > 0 ? mParams.mSendWindowBytes : 1);
+    uint32_t currentLane(0);
+    uint32_t laneBytes(0);
+
+    // With sequenced delivery enabled, every outgoing frame is prepended
+    // with an envelope carrying this endpoint's id and the next per-sender
+    // sequence number, letting receiving endpoints drop duplicate frames
+    // redelivered by the transport centrally.
+    const uint32_t envelopeSize(mParams.mSequencedDelivery ? static_cast<uint32_t>(sizeof(Detail::SequencedHeader)) : 0);
+    const uint32_t senderId(mName.GetHash());
+
+    if (sender)
+    {
+        // Create the output socket.
+        // This is the socket we use to publish messages sent by local actors.
+        // EndPoint objects in other processors or on other hosts create SUB sockets
+        // and connect them to the same endpoint.
+        void *const outputSocketMemory(allocator->Allocate(sizeof(Detail::OutputSocket)));
+        if (outputSocketMemory == 0)
+        {
+            THERON_FAIL_MSG("Failed to allocate output socket");
+        }
+
+        outputSocket = new (outputSocketMemory) Detail::OutputSocket(mContext);
+
+        // Bind the output socket to the local endpoint that is this EndPoint's address.
+        if (!outputSocket->Bind(mLocation.GetValue()))
+        {
+            THERON_FAIL_MSG("Failed to bind output socket to endpoint - check network support is enabled");
+        }
+
+        // Create a network output message, which we reuse to send network messages within the loop.
+        void *const outputMessageMemory(allocator->Allocate(sizeof(Detail::OutputMessage)));
+        if (outputMessageMemory == 0)
+        {
+            THERON_FAIL_MSG("Failed to allocate output message");
+        }
+
+        outputMessage = new (outputMessageMemory) Detail::OutputMessage(mContext);
+
+        // Create a second output message used to send large payloads zero-copy as a separate message part.
+        void *const payloadMessageMemory(allocator->Allocate(sizeof(Detail::OutputMessage)));
+        if (payloadMessageMemory == 0)
+        {
+            THERON_FAIL_MSG("Failed to allocate output payload message");
+        }
+
+        payloadMessage = new (payloadMessageMemory) Detail::OutputMessage(mContext);
+
+        // Allocate the buffer in which small outgoing messages are coalesced into batches.
+        batchBuffer = reinterpret_cast<uint8_t *>(allocator->Allocate(batchCapacity));
+        if (batchBuffer == 0)
+        {
+            THERON_FAIL_MSG("Failed to allocate network batch buffer");
+        }
+
+        // Allocate the scratch buffer into which batches are compressed,
+        // sized to the codec's worst case so compression can never overrun.
+        if (compressor)
+        {
+            compressCapacity = COMPRESSED_HEADER_SIZE + compressor->MaxCompressedSize(batchCapacity);
+            compressBuffer = reinterpret_cast<uint8_t *>(allocator->Allocate(compressCapacity));
+            if (compressBuffer == 0)
+            {
+                THERON_FAIL_MSG("Failed to allocate network compression buffer");
+            }
+        }
+    }
+
+    // Create the input socket.
+    // This is the socket we use to subscribe to messages published by other actors.
+    // We connect to the endpoints of the publish sockets of the remote processes
+    // whose connections are assigned to this shard.
+    void *const inputSocketMemory(allocator->Allocate(sizeof(Detail::InputSocket)));
+    if (inputSocketMemory == 0)
+    {
+        THERON_FAIL_MSG("Failed to allocate input socket");
+    }
+
+    Detail::InputSocket *const inputSocket = new (inputSocketMemory) Detail::InputSocket(mContext);
+
+    // Create a network input message, which we reuse to receive network messages within the loop.
+    void *const inputMessageMemory(allocator->Allocate(sizeof(Detail::InputMessage)));
+    if (inputMessageMemory == 0)
+    {
+        THERON_FAIL_MSG("Failed to allocate input message");
+    }
+
+    Detail::InputMessage *const inputMessage = new (inputMessageMemory) Detail::InputMessage(mContext);
+
+    // Create a second input message used to receive zero-copy payload parts.
+    void *const payloadInputMemory(allocator->Allocate(sizeof(Detail::InputMessage)));
+    if (payloadInputMemory == 0)
+    {
+        THERON_FAIL_MSG("Failed to allocate input payload message");
+    }
+
+    Detail::InputMessage *const payloadInput = new (payloadInputMemory) Detail::InputMessage(mContext);
+
+    // Initialize the input messages once outside the loop.
+    if (!inputMessage->Initialize())
+    {
+        THERON_FAIL_MSG("Failed to initialize network input message");
+    }
+
+    if (!payloadInput->Initialize())
+    {
+        THERON_FAIL_MSG("Failed to initialize network input payload message");
+    }
+
+    // Signal the main thread that we've started.
+    shard->mStarted = true;
+
+    while (mRunning)
+    {
+        // Service connection requests assigned to this shard.
+        shard->mLock.Lock();
+
+        while (!shard->mConnectQueue.Empty())
+        {
+            // Copy the location out so the lock isn't held while connecting.
+            const Detail::String location(*shard->mConnectQueue.Front());
+            shard->mConnectQueue.Pop();
+
+            shard->mLock.Unlock();
+
+            // Connect the input socket to the remote host.
+            // The same socket can be connected to multiple remote endpoints.
+            if (!inputSocket->Connect(location.GetValue()))
+            {
+                THERON_FAIL_MSG("Failed to connect input socket to remote endpoint");
+            }
+
+            shard->mLock.Lock();
+        }
+
+        shard->mLock.Unlock();
+
+        mNetworkLock.Lock();
+
+        // Service send requests. Only the first shard owns the output socket.
+        // The per-destination lanes are serviced round-robin, framing at most
+        // the configured window of bytes from one lane before rotating to the
+        // next, so a deep backlog destined for one slow peer doesn't hold up
+        // messages queued for other destinations.
+        while (sender)
+        {
+            SendRequest *request(0);
+
+            for (uint32_t visited = 0; request == 0 && visited <= NUM_SEND_LANES; ++visited)
+            {
+                if (laneBytes < sendWindow && !mSendLanes[currentLane].Empty())
+                {
+                    request = mSendLanes[currentLane].Pop();
+                    break;
+                }
+
+                // Rotate to the next lane, opening a fresh window for it.
+                currentLane = (currentLane + 1) & (NUM_SEND_LANES - 1);
+                laneBytes = 0;
+            }
+
+            // All lanes drained.
+            if (request == 0)
+            {
+                break;
+            }
+
+            mNetworkLock.Unlock();
+
+            THERON_ASSERT_MSG(outputSocket, "No output socket found");
+
+            Detail::IMessage *const message(request->mMessage);
+            const char *const fromName(message->From().AsString());
+            const char *const toName(request->mName.GetValue());
+            const char *const messageName(message->TypeName());
+            const void *const messageData(message->GetMessageData());
+            const uint32_t messageSize(message->GetMessageSize());
+
+            THERON_ASSERT_MSG(messageName, "Can't send unregistered messages to actors addressed by name!");
+
+            // With the flat wire format enabled, frames identify the message type
+            // by the hash its name is interned with, rather than the name string.
+            const bool flatFormat(mParams.mFlatWireFormat);
+            const uint32_t typeHash(flatFormat ? Detail::StringPool::ComputeHash(messageName) : 0);
+
+            // Calculate the size of the network message with the payload serialized in-frame.
+            const uint32_t inlineMessageSize = flatFormat ?
+                Detail::FlatMessage::GetSize(
+                    fromName,
+                    toName,
+                    messageSize) :
+                Detail::NetworkMessage::GetSize(
+                    fromName,
+                    toName,
+                    messageName,
+                    messageData,
+                    messageSize);
+
+            // Large payloads are sent zero-copy: the header part carries the names
+            // and the payload size, and the payload itself is sent as a second
+            // message part referencing the Theron message data directly, with a
+            // callback that destroys the message once the transport is done with it.
+            // Messages too large to coalesce into a batch go out the same way
+            // whatever their size, so the header, names and payload of a standalone
+            // frame are the parts of one vectored multipart send and the payload is
+            // never concatenated into a transport frame.
+            const bool zeroCopy(
+                messageSize >= ZERO_COPY_THRESHOLD ||
+                BATCH_HEADER_SIZE + sizeof(uint32_t) + envelopeSize + inlineMessageSize > batchCapacity);
+
+            // Size of the network message, excluding any zero-copy payload.
+            const uint32_t networkMessageSize = zeroCopy ?
+                (flatFormat ?
+                    Detail::FlatMessage::GetSize(
+                        fromName,
+                        toName,
+                        0) :
+                    Detail::NetworkMessage::GetSize(
+                        fromName,
+                        toName,
+                        messageName,
+                        messageData,
+                        0)) :
+                inlineMessageSize;
+
+            // Size of the frame on the wire, including the sequencing
+            // envelope when sequenced delivery is enabled.
+            const uint32_t frameSize(envelopeSize + networkMessageSize);
+
+            // Charge the message against the current lane's window, counting
+            // zero-copy payloads at their full size.
+            laneBytes += frameSize + (zeroCopy ? messageSize : 0);
+
+            if (zeroCopy)
+            {
+                // Flush any batched messages first to preserve ordering.
+                FlushBatch(outputSocket, outputMessage, batchBuffer, batchOffset, batchCount, batchAge, compressor, compressBuffer, compressCapacity);
+
+                // Initialize the header part, which carries the names and the payload size.
+                if (!outputMessage->Initialize(frameSize))
+                {
+                    THERON_FAIL_MSG("Failed to initialize network output message");
+                }
+
+                uint8_t *const headerData(reinterpret_cast<uint8_t *>(outputMessage->Data()));
+
+                if (envelopeSize)
+                {
+                    WriteSequencedHeader(headerData, senderId, ++mSendSequence);
+                }
+
+                if (flatFormat)
+                {
+                    Detail::FlatMessage::Initialize(
+                        headerData + envelopeSize,
+                        fromName,
+                        toName,
+                        typeHash,
+                        0,
+                        messageSize);
+                }
+                else
+                {
+                    Detail::NetworkMessage::Initialize(
+                        headerData + envelopeSize,
+                        fromName,
+                        toName,
+                        messageName,
+                        0,
+                        messageSize);
+                }
+
+                // Journal the header frame together with the out-of-frame payload.
+                // The sequencing envelope isn't journaled, so replayed frames
+                // aren't mistaken for duplicates of the frames they replay.
+                if (mJournal.IsOpen())
+                {
+                    mJournal.Append(headerData + envelopeSize, networkMessageSize, messageData, messageSize);
+                }
+
+                // Send the header part, flagging the zero-copy payload part to follow.
+                if (!outputSocket->Send(outputMessage, true))
+                {
+                    THERON_FAIL_MSG("Failed to send network output message");
+                }
+
+                if (!outputMessage->Release())
+                {
+                    THERON_FAIL_MSG("Failed to release network output message");
+                }
+
+                const uint32_t chunkSize(mParams.mChunkSizeBytes);
+                if (chunkSize > 0 && messageSize > chunkSize)
+                {
+                    // Payloads larger than the chunk size are streamed as a pipeline
+                    // of fixed-size chunk parts rather than one monolithic part,
+                    // bounding the transport's internal buffering and letting early
+                    // chunks be transmitted while later ones are still being framed.
+                    // Each chunk references a slice of the message data in place;
+                    // the message is destroyed once the last chunk has been sent.
+                    const uint32_t chunkCount((messageSize + chunkSize - 1) / chunkSize);
+
+                    void *const stateMemory(allocator->Allocate(sizeof(ChunkSendState)));
+                    if (stateMemory == 0)
+                    {
+                        THERON_FAIL_MSG("Failed to allocate chunk send state");
+                    }
+
+                    ChunkSendState *const state = new (stateMemory) ChunkSendState(message, chunkCount);
+                    uint8_t *const payloadData(reinterpret_cast<uint8_t *>(const_cast<void *>(messageData)));
+
+                    uint32_t chunkOffset(0);
+                    for (uint32_t chunk = 0; chunk < chunkCount; ++chunk)
+                    {
+                        const uint32_t remaining(messageSize - chunkOffset);
+                        const uint32_t thisChunkSize(remaining < chunkSize ? remaining : chunkSize);
+
+                        if (!payloadMessage->Initialize(
+                            payloadData + chunkOffset,
+                            thisChunkSize,
+                            &FreeChunkPart,
+                            state))
+                        {
+                            THERON_FAIL_MSG("Failed to initialize chunk payload message");
+                        }
+
+                        // All chunks but the last flag a further part to follow, keeping
+                        // the whole transfer a single multipart message on the wire.
+                        if (!outputSocket->Send(payloadMessage, chunk + 1 < chunkCount))
+                        {
+                            THERON_FAIL_MSG("Failed to send chunk payload message");
+                        }
+
+                        if (!payloadMessage->Release())
+                        {
+                            THERON_FAIL_MSG("Failed to release chunk payload message");
+                        }
+
+                        chunkOffset += thisChunkSize;
+                    }
+                }
+                else
+                {
+                    // Wrap the message payload directly as a second message part, avoiding the copy.
+                    // Ownership of the local message passes to the transport, which destroys it
+                    // via the free callback once the data has been sent.
+                    if (!payloadMessage->Initialize(
+                        const_cast<void *>(messageData),
+                        messageSize,
+                        &FreeZeroCopyMessage,
+                        message))
+                    {
+                        THERON_FAIL_MSG("Failed to initialize zero-copy payload message");
+                    }
+
+                    if (!outputSocket->Send(payloadMessage))
+                    {
+                        THERON_FAIL_MSG("Failed to send zero-copy payload message");
+                    }
+
+                    if (!payloadMessage->Release())
+                    {
+                        THERON_FAIL_MSG("Failed to release zero-copy payload message");
+                    }
+                }
+            }
+            else
+            {
+                // Messages that don't fit the current batch go multipart above,
+                // so the message is coalesceable; flush first if it wouldn't fit.
+                if (batchOffset + sizeof(uint32_t) + frameSize > batchCapacity)
+                {
+                    FlushBatch(outputSocket, outputMessage, batchBuffer, batchOffset, batchCount, batchAge, compressor, compressBuffer, compressCapacity);
+                }
+
+                // Frame the message with its size, then build it in place in the batch buffer.
+                memcpy(batchBuffer + batchOffset, &frameSize, sizeof(uint32_t));
+                batchOffset += sizeof(uint32_t);
+
+                if (envelopeSize)
+                {
+                    WriteSequencedHeader(batchBuffer + batchOffset, senderId, ++mSendSequence);
+                    batchOffset += envelopeSize;
+                }
+
+                if (flatFormat)
+                {
+                    Detail::FlatMessage::Initialize(
+                        batchBuffer + batchOffset,
+                        fromName,
+                        toName,
+                        typeHash,
+                        messageData,
+                        messageSize);
+                }
+                else
+                {
+                    Detail::NetworkMessage::Initialize(
+                        batchBuffer + batchOffset,
+                        fromName,
+                        toName,
+                        messageName,
+                        messageData,
+                        messageSize);
+                }
+
+                // Journal the frame just serialized into the batch.
+                if (mJournal.IsOpen())
+                {
+                    mJournal.Append(batchBuffer + batchOffset, networkMessageSize, 0, 0);
+                }
+
+                batchOffset += networkMessageSize;
+                ++batchCount;
+
+                // Destroy the local message.
+                // We return the message memory block to the global allocator.
+                Detail::MessageCreator::Destroy(allocator, message);
+            }
+
+            // Destroy the request structure.
+            request->~SendRequest();
+            allocator->Free(request, sizeof(SendRequest));
+
+            mNetworkLock.Lock();
+        }
+
+        mNetworkLock.Unlock();
+
+        // Flush any batched messages held back for longer than the configured
+        // timeout. The loop runs roughly once per millisecond, so the age is
+        // approximately the time in milliseconds since the batch was started.
+        if (batchCount > 0 && ++batchAge >= batchTimeout)
+        {
+            FlushBatch(outputSocket, outputMessage, batchBuffer, batchOffset, batchCount, batchAge, compressor, compressBuffer, compressCapacity);
+        }
+
+        // Read messages from the input socket without blocking.
+        while (inputSocket->NonBlockingReceive(inputMessage))
+        {
+            // Read the data from the received network message.
+            uint32_t receivedSize(inputMessage->Size());
+            const uint8_t *receivedData(reinterpret_cast<const uint8_t *>(inputMessage->Data()));
+
+            if (receivedData == 0)
+            {
+                THERON_FAIL_MSG("Invalid XS message data pointer");
+            }
+
+            if (receivedSize < sizeof(uint32_t))
+            {
+                THERON_FAIL_MSG("Invalid XS message data size");
+            }
+
+            // Coalesced batches are identified by a leading marker word, which can
+            // never match the first offset field of a single network message.
+            uint32_t marker(0);
+            memcpy(&marker, receivedData, sizeof(uint32_t));
+
+            // Compressed batches are decompressed up front, then unpacked
+            // below exactly as if the raw batch had arrived on the wire.
+            if (marker == COMPRESSED_MARKER)
+            {
+                if (compressor == 0)
+                {
+                    THERON_FAIL_MSG("Received compressed network batch but no compression codec is configured");
+                }
+
+                if (receivedSize < COMPRESSED_HEADER_SIZE)
+                {
+                    THERON_FAIL_MSG("Invalid compressed network batch size");
+                }
+
+                uint32_t uncompressedSize(0);
+                memcpy(&uncompressedSize, receivedData + sizeof(uint32_t), sizeof(uint32_t));
+
+                if (uncompressedSize < BATCH_HEADER_SIZE)
+                {
+                    THERON_FAIL_MSG("Malformed compressed network batch");
+                }
+
+                // Grow the scratch buffer to the declared uncompressed size.
+                if (decompressCapacity < uncompressedSize)
+                {
+                    if (decompressBuffer)
+                    {
+                        allocator->Free(decompressBuffer, decompressCapacity);
+                    }
+
+                    decompressBuffer = reinterpret_cast<uint8_t *>(allocator->Allocate(uncompressedSize));
+                    if (decompressBuffer == 0)
+                    {
+                        THERON_FAIL_MSG("Failed to allocate network decompression buffer");
+                    }
+
+                    decompressCapacity = uncompressedSize;
+                }
+
+                const uint32_t decompressedSize(compressor->Decompress(
+                    receivedData + COMPRESSED_HEADER_SIZE,
+                    receivedSize - COMPRESSED_HEADER_SIZE,
+                    decompressBuffer,
+                    decompressCapacity));
+
+                if (decompressedSize != uncompressedSize)
+                {
+                    THERON_FAIL_MSG("Failed to decompress network batch message");
+                }
+
+                receivedData = decompressBuffer;
+                receivedSize = uncompressedSize;
+                memcpy(&marker, receivedData, sizeof(uint32_t));
+            }
+
+            // Sequenced frames carry a leading envelope with the sending
+            // endpoint's id and a per-sender sequence number. Duplicates
+            // redelivered by the transport are dropped here, once, rather
+            // than by deduplication maps in every receiving actor.
+            bool duplicate(false);
+            if (marker == Detail::SequencedHeader::MARKER)
+            {
+                if (receivedSize < sizeof(Detail::SequencedHeader) + sizeof(uint32_t))
+                {
+                    THERON_FAIL_MSG("Invalid sequenced network message size");
+                }
+
+                Detail::SequencedHeader header;
+                memcpy(&header, receivedData, sizeof(header));
+
+                duplicate = !shard->mDedupWindows.Accept(header.mSenderId, header.mSequence);
+
+                receivedData += sizeof(Detail::SequencedHeader);
+                receivedSize -= sizeof(Detail::SequencedHeader);
+                memcpy(&marker, receivedData, sizeof(uint32_t));
+            }
+
+            if (duplicate)
+            {
+                // Drain any zero-copy payload parts of the dropped frame, so
+                // the stream stays aligned on its message part boundaries.
+                while (inputSocket->MoreParts())
+                {
+                    if (!inputSocket->NonBlockingReceive(payloadInput))
+                    {
+                        THERON_FAIL_MSG("Failed to receive payload part of duplicate message");
+                    }
+                }
+            }
+            else if (marker == BATCH_MARKER)
+            {
+                if (receivedSize < BATCH_HEADER_SIZE)
+                {
+                    THERON_FAIL_MSG("Invalid network batch message size");
+                }
+
+                uint32_t messageCount(0);
+                memcpy(&messageCount, receivedData + sizeof(uint32_t), sizeof(uint32_t));
+
+                // Unpack and deliver each framed message in the batch in turn.
+                uint32_t offset(BATCH_HEADER_SIZE);
+                for (uint32_t index = 0; index < messageCount; ++index)
+                {
+                    uint32_t frameSize(0);
+                    if (offset + sizeof(uint32_t) > receivedSize)
+                    {
+                        THERON_FAIL_MSG("Malformed network batch message");
+                    }
+
+                    memcpy(&frameSize, receivedData + offset, sizeof(uint32_t));
+                    offset += sizeof(uint32_t);
+
+                    if (frameSize < sizeof(uint32_t) || offset + frameSize > receivedSize)
+                    {
+                        THERON_FAIL_MSG("Malformed network batch message");
+                    }
+
+                    // Each frame in the batch is either a flat-format message,
+                    // identified by its leading marker word, or a generic one,
+                    // optionally preceded by a sequencing envelope.
+                    uint32_t frameMarker(0);
+                    memcpy(&frameMarker, receivedData + offset, sizeof(uint32_t));
+
+                    if (frameMarker == Detail::SequencedHeader::MARKER)
+                    {
+                        if (frameSize < sizeof(Detail::SequencedHeader) + sizeof(uint32_t))
+                        {
+                            THERON_FAIL_MSG("Malformed network batch message");
+                        }
+
+                        Detail::SequencedHeader header;
+                        memcpy(&header, receivedData + offset, sizeof(header));
+
+                        offset += sizeof(Detail::SequencedHeader);
+                        frameSize -= sizeof(Detail::SequencedHeader);
+
+                        // Skip the remainder of a duplicate frame.
+                        if (!shard->mDedupWindows.Accept(header.mSenderId, header.mSequence))
+                        {
+                            offset += frameSize;
+                            continue;
+                        }
+
+                        memcpy(&frameMarker, receivedData + offset, sizeof(uint32_t));
+                    }
+
+                    if (frameMarker == Detail::FlatMessage::MARKER)
+                    {
+                        if (frameSize < sizeof(Detail::FlatMessage))
+                        {
+                            THERON_FAIL_MSG("Malformed network batch message");
+                        }
+
+                        const Detail::FlatMessage *const flatMessage(
+                            reinterpret_cast<const Detail::FlatMessage *>(receivedData + offset));
+
+                        DispatchReceivedFrame(
+                            shard->mBuilderCache,
+                            flatMessage,
+                            frameSize,
+                            true,
+                            flatMessage->GetMessageData(),
+                            flatMessage->GetMessageSize());
+                    }
+                    else
+                    {
+                        if (frameSize < sizeof(Detail::NetworkMessage))
+                        {
+                            THERON_FAIL_MSG("Malformed network batch message");
+                        }
+
+                        const Detail::NetworkMessage *const networkMessage(
+                            reinterpret_cast<const Detail::NetworkMessage *>(receivedData + offset));
+
+                        DispatchReceivedFrame(
+                            shard->mBuilderCache,
+                            networkMessage,
+                            frameSize,
+                            false,
+                            networkMessage->GetMessageData(),
+                            networkMessage->GetMessageSize());
+                    }
+
+                    offset += frameSize;
+                }
+            }
+            else
+            {
+                // Flat-format frames are identified by their marker word; any other
+                // single frame is a generic network message.
+                const bool flat(marker == Detail::FlatMessage::MARKER);
+
+                if (receivedSize < (flat ? sizeof(Detail::FlatMessage) : sizeof(Detail::NetworkMessage)))
+                {
+                    THERON_FAIL_MSG("Invalid XS message data size");
+                }
+
+                const Detail::NetworkMessage *const networkMessage(
+                    flat ? 0 : reinterpret_cast<const Detail::NetworkMessage *>(receivedData));
+                const Detail::FlatMessage *const flatMessage(
+                    flat ? reinterpret_cast<const Detail::FlatMessage *>(receivedData) : 0);
+
+                const uint32_t messageSize(flat ? flatMessage->GetMessageSize() : networkMessage->GetMessageSize());
+                const void *messageData(flat ? flatMessage->GetMessageData() : networkMessage->GetMessageData());
+                uint8_t *reassemblyBuffer(0);
+
+                // Payloads sent zero-copy arrive as one or more further message parts.
+                // The parts of a multipart message are delivered atomically, so the
+                // payload parts are guaranteed to be immediately available.
+                if (inputSocket->MoreParts())
+                {
+                    if (!inputSocket->NonBlockingReceive(payloadInput))
+                    {
+                        THERON_FAIL_MSG("Failed to receive zero-copy payload message part");
+                    }
+
+                    if (payloadInput->Size() == messageSize)
+                    {
+                        // The whole payload arrived as a single part.
+                        messageData = payloadInput->Data();
+                    }
+                    else
+                    {
+                        // The payload was streamed as a pipeline of fixed-size chunk
+                        // parts, which are reassembled into a buffer of the payload
+                        // size recorded in the header part.
+                        reassemblyBuffer = reinterpret_cast<uint8_t *>(allocator->Allocate(messageSize));
+                        if (reassemblyBuffer == 0)
+                        {
+                            THERON_FAIL_MSG("Failed to allocate payload reassembly buffer");
+                        }
+
+                        uint32_t receivedBytes(0);
+                        for (;;)
+                        {
+                            const uint32_t partSize(payloadInput->Size());
+                            if (receivedBytes + partSize > messageSize)
+                            {
+                                THERON_FAIL_MSG("Received chunked payload larger than its header declared");
+                            }
+
+                            Detail::MemoryCopy(reassemblyBuffer + receivedBytes, payloadInput->Data(), partSize);
+                            receivedBytes += partSize;
+
+                            if (receivedBytes == messageSize)
+                            {
+                                break;
+                            }
+
+                            if (!inputSocket->MoreParts())
+                            {
+                                THERON_FAIL_MSG("Received chunked payload smaller than its header declared");
+                            }
+
+                            if (!inputSocket->NonBlockingReceive(payloadInput))
+                            {
+                                THERON_FAIL_MSG("Failed to receive chunk payload message part");
+                            }
+                        }
+
+                        messageData = reassemblyBuffer;
+                    }
+                }
+
+                DispatchReceivedFrame(shard->mBuilderCache, receivedData, receivedSize, flat, messageData, messageSize);
+
+                if (reassemblyBuffer)
+                {
+                    allocator->Free(reassemblyBuffer, messageSize);
+                }
+            }
+        }
+
+        // The network thread spends most of its time asleep. Shared memory
+        // inputs signal arrival, so the wait ends early when a local peer
+        // publishes rather than at the next poll.
+        inputSocket->WaitForMessage(1000);
+    }
+
+    // Drain this shard's connection request queue.
+    shard->mLock.Lock();
+
+    while (!shard->mConnectQueue.Empty())
+    {
+        shard->mConnectQueue.Pop();
+    }
+
+    shard->mLock.Unlock();
+
+    if (sender)
+    {
+        // Drain the send lanes.
+        mNetworkLock.Lock();
+
+        for (uint32_t lane = 0; lane < NUM_SEND_LANES; ++lane)
+        {
+            while (!mSendLanes[lane].Empty())
+            {
+                SendRequest *const request(mSendLanes[lane].Pop());
+                request->~SendRequest();
+                allocator->Free(request, sizeof(SendRequest));
+            }
+        }
+
+        mNetworkLock.Unlock();
+
+        // Flush any remaining batched messages before shutting down.
+        FlushBatch(outputSocket, outputMessage, batchBuffer, batchOffset, batchCount, batchAge, compressor, compressBuffer, compressCapacity);
+
+        // Free the batch buffer.
+        allocator->Free(batchBuffer, batchCapacity);
+
+        // Free the compression scratch buffer, if a codec was configured.
+        if (compressBuffer)
+        {
+            allocator->Free(compressBuffer, compressCapacity);
+        }
+    }
+
+    // Free the decompression buffer, if any compressed batches were received.
+    if (decompressBuffer)
+    {
+        allocator->Free(decompressBuffer, decompressCapacity);
+    }
+
+    // Release the input messages used repeatedly within the loop.
+    if (!inputMessage->Release())
+    {
+        THERON_FAIL_MSG("Failed to release network input message");
+    }
+
+    if (!payloadInput->Release())
+    {
+        THERON_FAIL_MSG("Failed to release network input payload message");
+    }
+
+    // Destroy the output messages and socket, owned by the first shard only.
+    if (sender)
+    {
+        outputMessage->~OutputMessage();
+        allocator->Free(outputMessage, sizeof(Detail::OutputMessage));
+
+        payloadMessage->~OutputMessage();
+        allocator->Free(payloadMessage, sizeof(Detail::OutputMessage));
+
+        outputSocket->~OutputSocket();
+        allocator->Free(outputSocket, sizeof(Detail::OutputSocket));
+    }
+
+    // Destroy the input messages and socket.
+    inputMessage->~InputMessage();
+    allocator->Free(inputMessage, sizeof(Detail::InputMessage));
+
+    payloadInput->~InputMessage();
+    allocator->Free(payloadInput, sizeof(Detail::InputMessage));
+
+    inputSocket->~InputSocket();
+    allocator->Free(inputSocket, sizeof(Detail::InputSocket));
+}
+
+
+void EndPoint::DispatchReceivedFrame(
+    Detail::MessageFactory::BuilderCache &builderCache,
+    const void *const frameData,
+    const uint32_t frameSize,
+    const bool flat,
+    const void *const messageData,
+    const uint32_t messageSize)
+{
+    // Without delivery threads, the calling network thread deserializes and
+    // delivers the frame itself, as it always did.
+    if (mNumDeliveryWorkers == 0)
+    {
+        if (flat)
+        {
+            DeliverReceivedFlatMessage(builderCache, reinterpret_cast<const Detail::FlatMessage *>(frameData), messageData);
+        }
+        else
+        {
+            DeliverReceivedMessage(builderCache, reinterpret_cast<const Detail::NetworkMessage *>(frameData), messageData);
+        }
+
+        return;
+    }
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Payloads received zero-copy live outside the frame, in a transport
+    // buffer or reassembly buffer the network thread reuses, so they are
+    // copied into the work item after the frame. In-frame payloads travel
+    // with the frame copy and are located afresh by the delivery thread.
+    const uint8_t *const frameBytes(reinterpret_cast<const uint8_t *>(frameData));
+    const uint8_t *const payloadBytes(reinterpret_cast<const uint8_t *>(messageData));
+    const bool payloadInFrame(payloadBytes >= frameBytes && payloadBytes < frameBytes + frameSize);
+    const uint32_t payloadCopySize(payloadInFrame ? 0 : messageSize);
+
+    void *const itemMemory(allocator->Allocate(sizeof(DeliveryWorkItem) + frameSize + payloadCopySize));
+    if (itemMemory == 0)
+    {
+        THERON_FAIL_MSG("Failed to allocate delivery work item");
+    }
+
+    DeliveryWorkItem *const item = new (itemMemory) DeliveryWorkItem(frameSize, payloadCopySize, flat);
+
+    Detail::MemoryCopy(item->FrameData(), frameData, frameSize);
+    if (payloadCopySize)
+    {
+        Detail::MemoryCopy(item->PayloadData(), messageData, payloadCopySize);
+    }
+
+    // Assign the frame to a delivery thread by the hash of the sending actor's
+    // name, so the frames of any one sender are delivered in order by a single
+    // thread, preserving per-sender message ordering.
+    const char *const fromName(flat ?
+        reinterpret_cast<const Detail::FlatMessage *>(frameData)->GetFromName() :
+        reinterpret_cast<const Detail::NetworkMessage *>(frameData)->GetFromName());
+
+    DeliveryWorker &worker(mDeliveryWorkers[Detail::StringPool::ComputeHash(fromName) % mNumDeliveryWorkers]);
+
+    worker.mLock.Lock();
+    worker.mWorkQueue.Push(item);
+    worker.mLock.Unlock();
+}
+
+
+void EndPoint::DeliveryThreadEntryPoint(void *const context)
+{
+    // The static entry point function is passed the worker pointer as context.
+    DeliveryWorker *const worker(reinterpret_cast<DeliveryWorker *>(context));
+    worker->mEndPoint->DeliveryThreadProc(worker);
+}
+
+
+void EndPoint::DeliveryThreadProc(DeliveryWorker *const worker)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Signal the main thread that we've started.
+    worker->mStarted = true;
+
+    uint32_t backoff(0);
+    for (;;)
+    {
+        worker->mLock.Lock();
+        DeliveryWorkItem *const item(worker->mWorkQueue.Empty() ? 0 : worker->mWorkQueue.Pop());
+        worker->mLock.Unlock();
+
+        if (item == 0)
+        {
+            // The stop flag is only checked once the queue is empty, and is only
+            // set after the network threads pushing to it have terminated, so
+            // queued frames are always delivered before the thread exits.
+            if (worker->mStop)
+            {
+                break;
+            }
+
+            Detail::Utils::Backoff(backoff);
+            continue;
+        }
+
+        backoff = 0;
+
+        // Rebuild the message from the copied frame and deliver it. Out-of-frame
+        // payloads were copied directly after the frame; otherwise the payload
+        // is located within the frame copy itself.
+        if (item->mFlat)
+        {
+            const Detail::FlatMessage *const flatMessage(
+                reinterpret_cast<const Detail::FlatMessage *>(item->FrameData()));
+
+            DeliverReceivedFlatMessage(
+                worker->mBuilderCache,
+                flatMessage,
+                item->mPayloadSize ? item->PayloadData() : flatMessage->GetMessageData());
+        }
+        else
+        {
+            const Detail::NetworkMessage *const networkMessage(
+                reinterpret_cast<const Detail::NetworkMessage *>(item->FrameData()));
+
+            DeliverReceivedMessage(
+                worker->mBuilderCache,
+                networkMessage,
+                item->mPayloadSize ? item->PayloadData() : networkMessage->GetMessageData());
+        }
+
+        const uint32_t itemSize(sizeof(DeliveryWorkItem) + item->mFrameSize + item->mPayloadSize);
+        item->~DeliveryWorkItem();
+        allocator->Free(item, itemSize);
+    }
+}
+
+
+bool EndPoint::DeliverReceivedMessage(
+    Detail::MessageFactory::BuilderCache &builderCache,
+    const Detail::NetworkMessage *const networkMessage,
+    const void *const messageData)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    const char *const fromName(networkMessage->GetFromName());
+    const Detail::String toName(networkMessage->GetToName());
+    const Detail::String messageName(networkMessage->GetMessageName());
+    const uint32_t messageSize(networkMessage->GetMessageSize());
+
+    // Look up the to address index using the received name.
+    // If the name isn't known to us we just discard the message.
+    Detail::Index toIndex;
+    if (Lookup(toName, toIndex))
+    {
+        // Construct the name-only 'from' address.
+        const Address fromAddress(fromName);
+
+        // Try to build a message from the data based on the message name. The
+        // caller's per-thread cache resolves repeat types without a map lookup.
+        Detail::IMessage *const message = mMessageFactory.Build(
+            builderCache,
+            messageName,
+            messageData,
+            messageSize,
+            fromAddress);
+
+        if (message)
+        {
+            // Try to deliver the allocated message to an actor in a local framework.
+            if (Detail::MessageSender::DeliverWithinLocalProcess(message, toIndex))
+            {
+                return true;
+            }
+
+            // Destroy the undelivered message using the global allocator.
+            Detail::MessageCreator::Destroy(allocator, message);
+        }
+    }
+
+    return false;
+}
+
+
+bool EndPoint::DeliverReceivedFlatMessage(
+    Detail::MessageFactory::BuilderCache &builderCache,
+    const Detail::FlatMessage *const flatMessage,
+    const void *const messageData)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Frames written with a future revision of the layout are skipped rather
+    // than misread; the version word makes them detectable.
+    if (flatMessage->GetVersion() != Detail::FlatMessage::VERSION)
+    {
+        return false;
+    }
+
+    const char *const fromName(flatMessage->GetFromName());
+    const Detail::String toName(flatMessage->GetToName());
+    const uint32_t messageSize(flatMessage->GetMessageSize());
+
+    // Look up the to address index using the received name.
+    // If the name isn't known to us we just discard the message.
+    Detail::Index toIndex;
+    if (Lookup(toName, toIndex))
+    {
+        // Construct the name-only 'from' address.
+        const Address fromAddress(fromName);
+
+        // Try to build a message from the data based on the hash of the message
+        // type name, avoiding the per-message string interning and comparison
+        // that name-based lookup costs. The caller's per-thread cache resolves
+        // repeat types without a map lookup.
+        Detail::IMessage *const message = mMessageFactory.BuildFromHash(
+            builderCache,
+            flatMessage->GetTypeHash(),
+            messageData,
+            messageSize,
+            fromAddress);
+
+        if (message)
+        {
+            // Try to deliver the allocated message to an actor in a local framework.
+            if (Detail::MessageSender::DeliverWithinLocalProcess(message, toIndex))
+            {
+                return true;
+            }
+
+            // Destroy the undelivered message using the global allocator.
+            Detail::MessageCreator::Destroy(allocator, message);
+        }
+    }
+
+    return false;
+}
+
+
+uint32_t EndPoint::ReplayJournal(
+    const char *const path,
+    const uint64_t startMicroseconds,
+    const uint64_t endMicroseconds)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    Detail::MessageJournal journal;
+    if (!journal.OpenForReading(path))
+    {
+        return 0;
+    }
+
+    // No record can be larger than the whole ring.
+    const uint32_t capacity(journal.GetRingSize());
+    uint8_t *const buffer = reinterpret_cast<uint8_t *>(allocator->Allocate(capacity));
+    if (buffer == 0)
+    {
+        return 0;
+    }
+
+    uint32_t delivered(0);
+    Detail::MessageJournal::RecordHeader header;
+
+    // Replay happens on the calling thread, which resolves the replayed
+    // message types through a cache of its own, like the receiving threads.
+    Detail::MessageFactory::BuilderCache builderCache;
+
+    while (journal.ReadNext(header, buffer, capacity))
+    {
+        // Records are read oldest first and timestamped in send order, so skip
+        // forward to the start of the window and stop once past its end.
+        if (header.mTimestamp < startMicroseconds)
+        {
+            continue;
+        }
+
+        if (endMicroseconds && header.mTimestamp > endMicroseconds)
+        {
+            break;
+        }
+
+        // Journaled frames are either flat-format messages, identified by their
+        // leading marker word, or generic network messages, as on the wire.
+        uint32_t marker(0);
+        memcpy(&marker, buffer, sizeof(uint32_t));
+
+        if (marker == Detail::FlatMessage::MARKER)
+        {
+            const Detail::FlatMessage *const flatMessage(
+                reinterpret_cast<const Detail::FlatMessage *>(buffer));
+
+            // Zero-copy sends journal their payloads out-of-frame, directly after
+            // the frame in the record; otherwise the payload is within the frame.
+            const void *const messageData(header.mPayloadSize ?
+                buffer + header.mFrameSize :
+                flatMessage->GetMessageData());
+
+            // Re-deliver through the same path as messages received from the network.
+            if (DeliverReceivedFlatMessage(builderCache, flatMessage, messageData))
+            {
+                ++delivered;
+            }
+        }
+        else
+        {
+            const Detail::NetworkMessage *const networkMessage(
+                reinterpret_cast<const Detail::NetworkMessage *>(buffer));
+
+            // Zero-copy sends journal their payloads out-of-frame, directly after
+            // the frame in the record; otherwise the payload is within the frame.
+            const void *const messageData(header.mPayloadSize ?
+                buffer + header.mFrameSize :
+                networkMessage->GetMessageData());
+
+            // Re-deliver through the same path as messages received from the network.
+            if (DeliverReceivedMessage(builderCache, networkMessage, messageData))
+            {
+                ++delivered;
+            }
+        }
+    }
+
+    allocator->Free(buffer, capacity);
+    return delivered;
+}
+
+
+} // namespace Theron
+
+
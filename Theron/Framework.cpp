@@ -1,505 +1,1805 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-#include <new>
-
-#include <Theron/Actor.h>
-#include <Theron/Assert.h>
-#include <Theron/AllocatorManager.h>
-#include <Theron/Defines.h>
-#include <Theron/EndPoint.h>
-#include <Theron/Framework.h>
-#include <Theron/IAllocator.h>
-
-#include <Theron/Detail/Directory/StaticDirectory.h>
-#include <Theron/Detail/MailboxProcessor/Processor.h>
-#include <Theron/Detail/Network/Index.h>
-#include <Theron/Detail/Network/NameGenerator.h>
-#include <Theron/Detail/Network/String.h>
-#include <Theron/Detail/Threading/Utils.h>
-
-
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning (disable:4996)  // function or variable may be unsafe
-#endif //_MSC_VER
-
-
-namespace Theron
-{
-
-
-void Framework::Initialize()
-{
-    // Set up the work queue pointers in the shared, per-framework context.
-    // The per-framework context has no local queue, it's owned queue is the shared queue.
-    mProcessorContext.mSharedWorkQueue = &mProcessorContext.mWorkQueue;
-    mProcessorContext.mLocalWorkQueue = 0;
-
-    // Set up the yield strategy in the per-framework context.
-    switch (mParams.mYieldStrategy)
-    {
-        case YIELD_STRATEGY_POLITE:     mProcessorContext.mYield.SetYieldFunction(&Detail::Processor::YieldPolite);     break;
-        case YIELD_STRATEGY_STRONG:     mProcessorContext.mYield.SetYieldFunction(&Detail::Processor::YieldStrong);     break;
-        case YIELD_STRATEGY_AGGRESSIVE: mProcessorContext.mYield.SetYieldFunction(&Detail::Processor::YieldAggressive); break;
-        default:                        mProcessorContext.mYield.SetYieldFunction(&Detail::Processor::YieldPolite);     break;
-    }
-
-    // Set the initial thread count and affinity masks.
-    mThreadCount.Store(0);
-    mTargetThreadCount.Store(mParams.mThreadCount);
-
-    // Set up the default fallback handler, which catches and reports undelivered messages.
-    SetFallbackHandler(&mDefaultFallbackHandler, &Detail::DefaultFallbackHandler::Handle);
-
-    // Start the manager thread.
-    mRunning = true;
-    mManagerThread.Start(ManagerThreadEntryPoint, this);
-
-    // Wait for the manager thread to start all the worker threads.
-    uint32_t backoff(0);
-    while (mThreadCount.Load() < mTargetThreadCount.Load())
-    {
-        Detail::Utils::Backoff(backoff);
-    }
-
-    // Register the framework and get a non-zero index for it, unique within the local process.
-    mIndex = Detail::StaticDirectory<Framework>::Register(this);
-    THERON_ASSERT(mIndex);
-
-    // If the framework name wasn't set explicitly then generate a default name.
-    if (mName.IsNull())
-    {
-        char buffer[16];
-        Detail::NameGenerator::Generate(buffer, mIndex);
-        mName = Detail::String(buffer);
-    }
-}
-
-
-void Framework::Release()
-{
-    // Deregister the framework.
-    Detail::StaticDirectory<Framework>::Deregister(mIndex);
-
-    // Wait for the work queue to drain, to avoid memory leaks.
-    uint32_t backoff(0);
-    while (!QueuesEmpty())
-    {
-        Detail::Utils::Backoff(backoff);
-    }
-
-    // Reset the target thread count so the manager thread will kill all the threads.
-    mTargetThreadCount.Store(0);
-
-    // Wait for all the running threads to be stopped.
-    backoff = 0;
-    while (mThreadCount.Load() > 0)
-    {
-        Detail::Utils::Backoff(backoff);
-    }
-
-    // Kill the manager thread and wait for it to terminate.
-    mRunning = false;
-    mManagerThread.Join();
-}
-  
-
-void Framework::RegisterActor(Actor *const actor, const char *const name)
-{
-    // Allocate an unused mailbox.
-    const uint32_t mailboxIndex(mMailboxes.Allocate());
-    Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex));
-
-    // Use the provided name for the actor if one was provided.
-    Detail::String mailboxName(name);
-    if (name == 0)
-    {
-        char rawName[16];
-        Detail::NameGenerator::Generate(rawName, mailboxIndex);
-
-        const char *endPointName(0);
-        if (mEndPoint)
-        {
-            endPointName = mEndPoint->GetName();        
-        }
-
-        char scopedName[256];
-        Detail::NameGenerator::Combine(
-            scopedName,
-            256,
-            rawName,
-            mName.GetValue(),
-            endPointName);
-
-        mailboxName = Detail::String(scopedName);
-    }
-
-    // Name the mailbox and register the actor.
-    mailbox.Lock();
-    mailbox.SetName(mailboxName);
-    mailbox.RegisterActor(actor);
-    mailbox.Unlock();
-
-    // Create the unique address of the mailbox.
-    // Its a pair comprising the framework index and the mailbox index within the framework.
-    const Detail::Index index(mIndex, mailboxIndex);
-    const Address mailboxAddress(mailboxName, index);
-
-    // Set the actor's mailbox address.
-    // The address contains the index of the framework and the index of the mailbox within the framework.
-    actor->mAddress = mailboxAddress;
-
-    if (mEndPoint)
-    {
-        // Check that no mailbox with this name already exists.
-        Detail::Index dummy;
-        if (mEndPoint->Lookup(mailboxName, dummy))
-        {
-            THERON_FAIL_MSG("Can't create two actors or receivers with the same name");
-        }
-        
-        // Register the mailbox with the endPoint so it can be found using its name.
-        if (!mEndPoint->Register(mailboxName, index))
-        {
-            THERON_FAIL_MSG("Failed to register actor with the network endpoint");
-        }
-    }
-}
-
-
-void Framework::DeregisterActor(Actor *const actor)
-{
-    const Address address(actor->GetAddress());
-    const Detail::String &mailboxName(address.GetName());
-
-    // Deregister the mailbox with the endPoint so it can't be found anymore.
-    if (mEndPoint)
-    {
-        mEndPoint->Deregister(mailboxName);
-    }
-
-    // Deregister the actor, so that the worker threads will leave it alone.
-    const uint32_t mailboxIndex(address.AsInteger());
-    Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex));
-
-    // If the entry is pinned then we have to wait for it to be unpinned.
-    bool deregistered(false);
-    uint32_t backoff(0);
-
-    while (!deregistered)
-    {
-        mailbox.Lock();
-
-        if (!mailbox.IsPinned())
-        {
-            mailbox.DeregisterActor();
-            deregistered = true;
-        }
-
-        mailbox.Unlock();
-
-        Detail::Utils::Backoff(backoff);
-    }
-}
-
-
-void Framework::SetMaxThreads(const uint32_t count)
-{
-    if (mTargetThreadCount.Load() > count)
-    {
-        mTargetThreadCount.Store(count);
-    }
-}
-
-
-void Framework::SetMinThreads(const uint32_t count)
-{
-    if (mTargetThreadCount.Load() < count)
-    {
-        mTargetThreadCount.Store(count);
-    }
-}
-
-
-uint32_t Framework::GetMaxThreads() const
-{
-    return mTargetThreadCount.Load();
-}
-
-
-uint32_t Framework::GetMinThreads() const
-{
-    return mTargetThreadCount.Load();
-}
-
-
-uint32_t Framework::GetNumThreads() const
-{
-    return mThreadCount.Load();
-}
-
-
-uint32_t Framework::GetPeakThreads() const
-{
-    return mPeakThreadCount.Load();
-}
-
-
-bool Framework::QueuesEmpty() const
-{
-    bool empty(true);
-
-    mSharedWorkQueueSpinLock.Lock();
-
-    if (!mProcessorContext.mWorkQueue.Empty())
-    {
-        empty = false;
-    }
-
-    mSharedWorkQueueSpinLock.Unlock();
-
-    if (!empty)
-    {
-        return false;
-    }
-
-    mThreadContextLock.Lock();
-    
-    // Check the queues in all worker contexts.
-    ContextList::Iterator contexts(mThreadContexts.GetIterator());
-    while (contexts.Next())
-    {
-        ThreadPool::ThreadContext *const threadContext(contexts.Get());
-
-        if (!threadContext->mWorkerContext->mWorkQueue.Empty())
-        {
-            empty = false;
-            break;
-        }
-    }
-
-    mThreadContextLock.Unlock();
-
-    return empty;
-}
-
-
-void Framework::ResetCounters() const
-{
-    mThreadContextLock.Lock();
-
-    // Reset the counters in all thread contexts.
-    ContextList::Iterator contexts(mThreadContexts.GetIterator());
-    while (contexts.Next())
-    {
-        ThreadPool::ThreadContext *const threadContext(contexts.Get());
-
-        for (uint32_t index = 0; index < (uint32_t) MAX_COUNTERS; ++index)
-        {
-            threadContext->mWorkerContext->mCounters[index].Store(0);
-        }
-    }
-
-    mThreadContextLock.Unlock();
-}
-
-
-uint32_t Framework::GetCounterValue(const Counter counter) const
-{
-    uint32_t total(0);
-
-    mThreadContextLock.Lock();
-
-    // Accumulate the counter values from all thread contexts.
-    ContextList::Iterator contexts(mThreadContexts.GetIterator());
-    while (contexts.Next())
-    {
-        ThreadPool::ThreadContext *const threadContext(contexts.Get());
-
-        total += threadContext->mWorkerContext->mCounters[counter].Load();
-    }
-
-    mThreadContextLock.Unlock();
-
-    return total;
-}
-
-
-uint32_t Framework::GetPerThreadCounterValues(
-    const Counter counter,
-    uint32_t *const perThreadCounts,
-    const uint32_t maxCounts) const
-{
-    uint32_t itemCount(0);
-
-    mThreadContextLock.Lock();
-
-    // Read the per-thread counter values into the provided array, skipping non-running contexts.
-    ContextList::Iterator contexts(mThreadContexts.GetIterator());
-    while (itemCount < maxCounts && contexts.Next())
-    {
-        ThreadPool::ThreadContext *const threadContext(contexts.Get());
-
-        if (ThreadPool::IsRunning(threadContext))
-        {
-            perThreadCounts[itemCount++] = threadContext->mWorkerContext->mCounters[counter].Load();
-        }
-    }
-
-    mThreadContextLock.Unlock();
-
-    return itemCount;
-}
-
-
-void Framework::ManagerThreadEntryPoint(void *const context)
-{
-    // The static entry point function is passed the object pointer as context.
-    Framework *const framework(reinterpret_cast<Framework *>(context));
-    framework->ManagerThreadProc();
-}
-
-
-void Framework::ManagerThreadProc()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    while (mRunning)
-    {
-        mThreadContextLock.Lock();
-
-        // Re-start stopped worker threads while the thread count is too low.
-        ContextList::Iterator contexts(mThreadContexts.GetIterator());
-        while (mThreadCount.Load() < mTargetThreadCount.Load() && contexts.Next())
-        {
-            ThreadPool::ThreadContext *const threadContext(contexts.Get());
-
-            if (!ThreadPool::IsRunning(threadContext))
-            {
-                if (!ThreadPool::StartThread(
-                    threadContext,
-                    mParams.mNodeMask,
-                    mParams.mProcessorMask))
-                {
-                    break;
-                }
-
-                mThreadCount.Increment();
-            }
-        }
-
-        // Create new worker threads while the thread count is still too low.
-        while (mThreadCount.Load() < mTargetThreadCount.Load())
-        {
-            // Create a worker context for this thread.
-            void *const storeMemory = allocator->AllocateAligned(sizeof(Detail::Processor::Context), THERON_CACHELINE_ALIGNMENT);
-            if (storeMemory == 0)
-            {
-                continue;
-            }
-
-            Detail::Processor::Context *const store = new (storeMemory) Detail::Processor::Context(
-                &mMailboxes,
-                &mSharedWorkQueueSpinLock,
-                &mFallbackHandlers,
-                &mMessageAllocator);
-
-            // Set up the work queue pointers in this per-thread context.
-            // The per-thread contexts have pointers to the single shared queue and their own owned queues.
-            store->mSharedWorkQueue = &mProcessorContext.mWorkQueue;
-            store->mLocalWorkQueue = &store->mWorkQueue;
-
-            // Set up the yield strategy in the per-thread context.
-            switch (mParams.mYieldStrategy)
-            {
-                case YIELD_STRATEGY_POLITE:     store->mYield.SetYieldFunction(&Detail::Processor::YieldPolite);        break;
-                case YIELD_STRATEGY_STRONG:     store->mYield.SetYieldFunction(&Detail::Processor::YieldStrong);        break;
-                case YIELD_STRATEGY_AGGRESSIVE: store->mYield.SetYieldFunction(&Detail::Processor::YieldAggressive);    break;
-                default:                        store->mYield.SetYieldFunction(&Detail::Processor::YieldPolite);        break;
-            }
-
-            // Create a thread context structure wrapping the worker context.
-            void *const contextMemory = allocator->AllocateAligned(sizeof(ThreadPool::ThreadContext), THERON_CACHELINE_ALIGNMENT);
-            if (contextMemory == 0)
-            {
-                allocator->Free(storeMemory);
-                break;
-            }
-
-            ThreadPool::ThreadContext *const threadContext = new (contextMemory) ThreadPool::ThreadContext(store);
-
-            // Create a worker thread with the created context.
-            if (!ThreadPool::CreateThread(threadContext))
-            {
-                allocator->Free(storeMemory);
-                allocator->Free(threadContext);
-                break;
-            }
-
-            // Start the thread on the given node and processors.
-            if (!ThreadPool::StartThread(
-                threadContext,
-                mParams.mNodeMask,
-                mParams.mProcessorMask))
-            {
-                allocator->Free(storeMemory);
-                allocator->Free(threadContext);
-                break;
-            }
-
-            // Remember the context so we can reuse it and eventually destroy it.
-            mThreadContexts.Insert(threadContext);
-
-            // Track the peak thread count.
-            mThreadCount.Increment();
-            if (mThreadCount.Load() > mPeakThreadCount.Load())
-            {
-                mPeakThreadCount.Store(mThreadCount.Load());
-            }
-        }
-
-        // Stop some running worker threads while the thread count is too high.
-        contexts = mThreadContexts.GetIterator();
-        while (mThreadCount.Load() > mTargetThreadCount.Load() && contexts.Next())
-        {
-            ThreadPool::ThreadContext *const threadContext(contexts.Get());
-            if (ThreadPool::IsRunning(threadContext))
-            {
-                ThreadPool::StopThread(threadContext);
-                mThreadCount.Decrement();
-            }
-        }
-
-        mThreadContextLock.Unlock();
-
-        // The manager thread spends most of its time asleep.
-        Detail::Utils::SleepThread(10);
-    }
-
-    // Free all the allocated thread context objects.
-    while (!mThreadContexts.Empty())
-    {
-        ThreadPool::ThreadContext *const threadContext(mThreadContexts.Front());
-        mThreadContexts.Remove(threadContext);
-
-        // Wait for the thread to stop and then destroy it.
-        ThreadPool::DestroyThread(threadContext);
-
-        // Destruct and free the per-worker-thread storage.
-        threadContext->mWorkerContext->~Context();
-        allocator->Free(threadContext->mWorkerContext, sizeof(Detail::Processor::Context));
-
-        // Destruct and free the per-thread context.
-        threadContext->~ThreadContext();
-        allocator->Free(threadContext, sizeof(ThreadPool::ThreadContext));
-    }
-}
-
-
-} // namespace Theron
-
-
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif //_MSC_VER
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+#include <stdio.h>
+
+#include <Theron/Actor.h>
+#include <Theron/ActorCreatedEvent.h>
+#include <Theron/Assert.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Defines.h>
+#include <Theron/EndPoint.h>
+#include <Theron/Framework.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Allocators/MessagePool.h>
+#include <Theron/Detail/Directory/StaticDirectory.h>
+#include <Theron/Detail/MailboxProcessor/Processor.h>
+#include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Network/NameGenerator.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Network/String.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning (disable:4996)  // function or variable may be unsafe
+#endif //_MSC_VER
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+/**
+Request message handled by the internal creator actor.
+*/
+struct CreateActorRequest
+{
+    Framework::ActorFactory mFactory;   ///< Factory callback that constructs the actor.
+    void *mContext;                     ///< User context passed through to the callback.
+    Address mClient;                    ///< Address to which the completion event is sent.
+};
+
+
+/**
+Internal actor that executes asynchronous actor construction requests.
+The construction runs in the message handler, on a worker thread, so the
+requester stays responsive while heavyweight actors are constructed.
+*/
+class ActorCreator : public Actor
+{
+public:
+
+    inline explicit ActorCreator(Framework &framework) : Actor(framework)
+    {
+        RegisterHandler(this, &ActorCreator::Handle);
+    }
+
+private:
+
+    inline void Handle(const CreateActorRequest &request, const Address /*from*/)
+    {
+        // Construct the actor on this worker thread.
+        Actor *const actor(request.mFactory(GetFramework(), request.mContext));
+
+        ActorCreatedEvent event;
+        event.mActor = actor;
+        event.mAddress = actor ? actor->GetAddress() : Address::Null();
+        event.mContext = request.mContext;
+
+        Send(event, request.mClient);
+    }
+};
+
+
+} // namespace Detail
+
+
+namespace
+{
+
+// Maps a yield strategy enum value to the yield function implementing it.
+Detail::Processor::YieldFunction YieldFunctionForStrategy(const YieldStrategy yieldStrategy)
+{
+    switch (yieldStrategy)
+    {
+        case YIELD_STRATEGY_POLITE:     return &Detail::Processor::YieldPolite;
+        case YIELD_STRATEGY_STRONG:     return &Detail::Processor::YieldStrong;
+        case YIELD_STRATEGY_AGGRESSIVE: return &Detail::Processor::YieldAggressive;
+        case YIELD_STRATEGY_BLOCKING:   return &Detail::Processor::YieldBlocking;
+        case YIELD_STRATEGY_ADAPTIVE:   return &Detail::Processor::YieldAdaptive;
+        default:                        return &Detail::Processor::YieldPolite;
+    }
+}
+
+// Maps a public scheduler policy enum value to the internal scheduler identifier.
+Theron::uint32_t SchedulerIdForPolicy(const SchedulerPolicy schedulerPolicy)
+{
+    switch (schedulerPolicy)
+    {
+        case SCHEDULER_POLICY_FIFO:     return Detail::SCHEDULER_ID_FIFO;
+        case SCHEDULER_POLICY_LOCALITY: return Detail::SCHEDULER_ID_LOCALITY;
+        case SCHEDULER_POLICY_DEFAULT:
+        default:                        return Detail::SCHEDULER_ID_DEFAULT;
+    }
+}
+
+
+// Selects the NUMA node of the worker with the given index by round-robin
+// distribution of the workers over the nodes enabled in the node mask.
+uint32_t WorkerNodeFromMask(const uint32_t nodeMask, const uint32_t workerIndex)
+{
+    // Count the nodes enabled in the mask.
+    uint32_t nodeCount(0);
+    for (uint32_t bit = 0; bit < 32; ++bit)
+    {
+        if (nodeMask & (1u << bit))
+        {
+            ++nodeCount;
+        }
+    }
+
+    if (nodeCount == 0)
+    {
+        return 0;
+    }
+
+    // Find the index of the n-th set bit.
+    uint32_t remaining(workerIndex % nodeCount);
+    for (uint32_t bit = 0; bit < 32; ++bit)
+    {
+        if (nodeMask & (1u << bit))
+        {
+            if (remaining == 0)
+            {
+                return bit;
+            }
+
+            --remaining;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+
+void Framework::Initialize()
+{
+    // Preheat the message pools from a saved warm state file, if one was
+    // given, so the first messages sent after a process restart don't pay
+    // for the pools to refill on demand. Missing or stale files are ignored.
+    if (mParams.mWarmStatePath)
+    {
+        Detail::MessagePool::Load(mParams.mWarmStatePath);
+    }
+
+    // Allocate the mailbox pages node-locally on NUMA systems, so the mailboxes
+    // are serviced by the memory controller local to the worker threads.
+    mMailboxes.SetAllocator(&mNodeAllocator);
+
+    // Preallocate the mailbox pages covering the expected actor count, if one
+    // was given, so registration doesn't pay for page allocations as the actor
+    // population grows to its expected size.
+    if (mParams.mExpectedActorCount)
+    {
+        mMailboxes.Reserve(mParams.mExpectedActorCount);
+    }
+
+    // Set up the work queue pointers in the shared, per-framework context.
+    // The per-framework context has no local queue, it's owned queue is the shared queue.
+    mProcessorContext.mSharedWorkQueue = &mProcessorContext.mWorkQueue;
+    mProcessorContext.mSharedHighPriorityWorkQueue = &mProcessorContext.mHighPriorityQueue;
+    mProcessorContext.mSharedDeadlineWorkQueue = &mProcessorContext.mDeadlineQueue;
+    mProcessorContext.mLocalWorkQueue = 0;
+    mProcessorContext.mSharedParallelTask = &mParallelTask;
+
+    // Set up the message batching quantum, guarding against a zero batch size.
+    mProcessorContext.mMessageBatchSize = (mParams.mMessageBatchSize > 0) ? mParams.mMessageBatchSize : 1;
+    mProcessorContext.mHandlerBudgetMicroseconds = mParams.mHandlerBudgetMicroseconds;
+    mProcessorContext.mSchedulerId = SchedulerIdForPolicy(mParams.mSchedulerPolicy);
+
+    // Configure the pacing of sends from non-actor code, if a rate was given.
+    mIngressThrottle.Initialize(mParams.mIngressTokensPerSecond, mParams.mIngressBurstLimit);
+
+    // Set up the yield strategy in the per-framework context.
+    mProcessorContext.mYield.SetYieldFunction(YieldFunctionForStrategy(mYieldStrategy));
+
+    // Under the blocking strategy, the scheduling path wakes sleeping workers
+    // via the shared condition, so all contexts need pointers to it.
+    if (mYieldStrategy == YIELD_STRATEGY_BLOCKING)
+    {
+        mProcessorContext.mWorkerCondition = &mWorkerCondition;
+        mProcessorContext.mNumSleepingWorkers = &mNumSleepingWorkers;
+    }
+
+    // Set the initial thread count and affinity masks. The scaling bounds both
+    // start at the initial thread count, so the thread count stays fixed until
+    // SetMinThreads or SetMaxThreads widens the range between them.
+    mThreadCount.Store(0);
+    mBlockedThreadCount.Store(0);
+    mTargetThreadCount.Store(mParams.mThreadCount);
+    mMinThreadCount.Store(mParams.mThreadCount);
+    mMaxThreadCount.Store(mParams.mThreadCount);
+
+    // Set up the default fallback handler, which catches and reports undelivered messages.
+    SetFallbackHandler(&mDefaultFallbackHandler, &Detail::DefaultFallbackHandler::Handle);
+
+    // Start the manager thread.
+    mRunning = true;
+    mManagerThread.Start(ManagerThreadEntryPoint, this);
+
+    // Wait for the manager thread to start all the worker threads.
+    uint32_t backoff(0);
+    while (mThreadCount.Load() < mTargetThreadCount.Load())
+    {
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // Register the framework and get a non-zero index for it, unique within the local process.
+    mIndex = Detail::StaticDirectory<Framework>::Register(this);
+    THERON_ASSERT(mIndex);
+
+    // If the framework name wasn't set explicitly then generate a default name.
+    if (mName.IsNull())
+    {
+        char buffer[16];
+        Detail::NameGenerator::Generate(buffer, mIndex);
+        mName = Detail::String(buffer);
+    }
+}
+
+
+void Framework::Release()
+{
+    // Release runs at most once, so an explicit FastShutdown leaves nothing
+    // for the destructor to do.
+    if (mReleased)
+    {
+        return;
+    }
+
+    mReleased = true;
+
+    // Destruct the internal creator actor, if one was created, while the
+    // framework can still deregister it. As with any actor, any construction
+    // requests still in flight at this point are undeliverable. Under a fast
+    // shutdown the creator actor is leaked with everything else: destructing
+    // it would touch mailboxes the teardown below abandons.
+    if (mActorCreator && !mFastShutdown)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        mActorCreator->~Actor();
+        allocator->Free(mActorCreator);
+        mActorCreator = 0;
+    }
+
+    // Destruct any actors constructed into framework-owned slab storage, in
+    // slab order, while the framework can still deregister them. Under a fast
+    // shutdown the actors and their slabs are leaked with everything else.
+    if (!mFastShutdown)
+    {
+        DestroyOwnedActors();
+    }
+
+    // Stop the timer wheel so that pending delayed and periodic sends can't
+    // keep injecting messages while the work queues are drained below.
+    mTimerWheel.Stop();
+
+    // Deregister the framework.
+    Detail::StaticDirectory<Framework>::Deregister(mIndex);
+
+    // Wait for the work queue to drain, to avoid memory leaks. A fast
+    // shutdown skips the drain: undelivered messages are leaked by contract.
+    uint32_t backoff(0);
+    while (!mFastShutdown && !QueuesEmpty())
+    {
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // Reset the target thread count so the manager thread will kill all the threads.
+    mTargetThreadCount.Store(0);
+
+    // Wait for all the running threads to be stopped.
+    backoff = 0;
+    while (mThreadCount.Load() > 0)
+    {
+        // Wake any workers blocked on the shared condition so they can be stopped.
+        if (mNumSleepingWorkers.Load() > 0)
+        {
+            mWorkerCondition.Lock();
+            mWorkerCondition.PulseAll();
+            mWorkerCondition.Unlock();
+        }
+
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // Kill the manager thread and wait for it to terminate.
+    mRunning = false;
+    mManagerThread.Join();
+
+    // Tear down the mailboxes, now that no thread touches them any more.
+    // Destructing a large directory page by page takes seconds, so the
+    // teardown runs in index ranges on short-lived helper threads, sized to
+    // the worker count the framework ran with; fast shutdowns just abandon
+    // the pages to the operating system.
+    if (mFastShutdown)
+    {
+        mMailboxes.Leak();
+    }
+    else
+    {
+        mMailboxes.Teardown(mPeakThreadCount.Load());
+    }
+}
+
+
+void *Framework::AllocateOwnedActorStorage(const uint32_t size, const uint32_t alignment, OwnedActorHeader *&header)
+{
+    const uint32_t headerSize(static_cast<uint32_t>(sizeof(OwnedActorHeader)));
+
+    mActorSlabLock.Lock();
+
+    // Carve the actor, and the header immediately preceding it, from the
+    // newest slab; the actor's placement satisfies its alignment, and the
+    // header's own alignment follows since actors are at least pointer-aligned.
+    uint8_t *actorBytes(0);
+
+    OwnedActorSlab *const slab(mActorSlabs);
+    if (slab)
+    {
+        const uintptr_t slabBase(reinterpret_cast<uintptr_t>(slab));
+        const uintptr_t unaligned(slabBase + slab->mUsed + headerSize);
+        const uintptr_t actorBase(THERON_ROUNDUP(unaligned, alignment));
+        const uintptr_t actorEnd(actorBase + size);
+
+        if (actorEnd <= slabBase + slab->mSize)
+        {
+            actorBytes = reinterpret_cast<uint8_t *>(actorBase);
+            slab->mUsed = static_cast<uint32_t>(actorEnd - slabBase);
+        }
+    }
+
+    if (actorBytes == 0)
+    {
+        // Grow the chain with a fresh slab, oversized if need be so the actor
+        // is guaranteed to fit whatever its size and alignment.
+        const uint32_t slabStructSize(static_cast<uint32_t>(sizeof(OwnedActorSlab)));
+        const uint32_t minimumSize(slabStructSize + headerSize + alignment + size);
+        const uint32_t slabSize(minimumSize > OWNED_ACTOR_SLAB_SIZE ? minimumSize : OWNED_ACTOR_SLAB_SIZE);
+
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const slabMemory(allocator->AllocateAligned(slabSize, THERON_CACHELINE_ALIGNMENT));
+        if (slabMemory == 0)
+        {
+            mActorSlabLock.Unlock();
+            return 0;
+        }
+
+        OwnedActorSlab *const newSlab = new (slabMemory) OwnedActorSlab();
+        newSlab->mNext = mActorSlabs;
+        newSlab->mSize = slabSize;
+        newSlab->mUsed = slabStructSize;
+        mActorSlabs = newSlab;
+
+        const uintptr_t slabBase(reinterpret_cast<uintptr_t>(newSlab));
+        const uintptr_t unaligned(slabBase + newSlab->mUsed + headerSize);
+        const uintptr_t actorBase(THERON_ROUNDUP(unaligned, alignment));
+
+        actorBytes = reinterpret_cast<uint8_t *>(actorBase);
+        newSlab->mUsed = static_cast<uint32_t>(actorBase + size - slabBase);
+    }
+
+    // Link the header onto the tail of the owned actor list, so the actors
+    // are destructed in construction order at framework destruction.
+    header = reinterpret_cast<OwnedActorHeader *>(actorBytes - headerSize);
+    header->mNext = 0;
+    header->mDestruct = 0;
+
+    if (mOwnedActorsTail)
+    {
+        mOwnedActorsTail->mNext = header;
+    }
+    else
+    {
+        mOwnedActorsHead = header;
+    }
+
+    mOwnedActorsTail = header;
+
+    mActorSlabLock.Unlock();
+
+    return actorBytes;
+}
+
+
+void Framework::DestroyOwnedActors()
+{
+    // Destruct the owned actors in construction order. Each actor is placed
+    // immediately after its header.
+    OwnedActorHeader *header(mOwnedActorsHead);
+    while (header)
+    {
+        header->mDestruct(header + 1);
+        header = header->mNext;
+    }
+
+    mOwnedActorsHead = 0;
+    mOwnedActorsTail = 0;
+
+    // Free the slabs the actors were constructed into.
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    OwnedActorSlab *slab(mActorSlabs);
+    while (slab)
+    {
+        OwnedActorSlab *const next(slab->mNext);
+        allocator->Free(slab, slab->mSize);
+        slab = next;
+    }
+
+    mActorSlabs = 0;
+}
+
+
+void Framework::FastShutdown()
+{
+    // The same teardown as the destructor's, minus the queue drain and with
+    // the mailboxes abandoned rather than destructed; see Release.
+    mFastShutdown = true;
+    Release();
+}
+
+
+bool Framework::CreateActorAsync(const ActorFactory factory, void *const context, const Address &client)
+{
+    THERON_ASSERT(factory);
+
+    // Create the internal creator actor on first use, under the lock since
+    // requests can be issued by handlers running on several worker threads.
+    mActorCreatorLock.Lock();
+
+    if (mActorCreator == 0)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->Allocate(sizeof(Detail::ActorCreator)));
+
+        if (memory)
+        {
+            mActorCreator = new (memory) Detail::ActorCreator(*this);
+        }
+    }
+
+    Actor *const creator(mActorCreator);
+    mActorCreatorLock.Unlock();
+
+    if (creator == 0)
+    {
+        return false;
+    }
+
+    // Queue the request to the creator actor, which executes the factory on
+    // the worker thread that processes its mailbox.
+    Detail::CreateActorRequest request;
+    request.mFactory = factory;
+    request.mContext = context;
+    request.mClient = client;
+
+    return Send(request, client, creator->GetAddress());
+}
+
+
+void Framework::RegisterActor(Actor *const actor, const char *const name)
+{
+    // If a bulk creation is in progress and this actor is being constructed
+    // into its slab, claim the next mailbox index from the reserved range,
+    // which was claimed and page-backed in one operation up front. Actors
+    // constructed concurrently elsewhere aren't in the slab and allocate an
+    // unused mailbox in the ordinary way.
+    uint32_t mailboxIndex(0);
+
+    BulkReservation *const reservation(reinterpret_cast<BulkReservation *>(mBulkReservation.Load()));
+    const void *const actorAddress(actor);
+
+    if (reservation && actorAddress >= reservation->mSlabBegin && actorAddress < reservation->mSlabEnd)
+    {
+        // Only constructors running in the bulk-creating thread get here, so
+        // the claim needs no synchronization.
+        THERON_ASSERT(reservation->mNextIndex < reservation->mEndIndex);
+        mailboxIndex = reservation->mNextIndex++;
+    }
+    else
+    {
+        mailboxIndex = mMailboxes.Allocate();
+    }
+
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex));
+
+    // Use the provided name for the actor if one was provided.
+    // Unnamed actors in frameworks without a network endpoint are never
+    // addressable by name, so skip name generation and interning entirely
+    // and leave the mailbox anonymous. Anonymous addresses are identified
+    // by their framework and mailbox indices instead.
+    Detail::String mailboxName(name);
+    if (name == 0 && mEndPoint)
+    {
+        char rawName[16];
+        Detail::NameGenerator::Generate(rawName, mailboxIndex);
+
+        const char *endPointName(0);
+        if (mEndPoint)
+        {
+            endPointName = mEndPoint->GetName();        
+        }
+
+        char scopedName[256];
+        Detail::NameGenerator::Combine(
+            scopedName,
+            256,
+            rawName,
+            mName.GetValue(),
+            endPointName);
+
+        mailboxName = Detail::String(scopedName);
+    }
+
+    // Name the mailbox and register the actor.
+    mailbox.Lock();
+    mailbox.SetName(mailboxName);
+    mailbox.RegisterActor(actor);
+    mailbox.Unlock();
+
+    // Create the unique address of the mailbox.
+    // Its a pair comprising the framework index and the mailbox index within the framework.
+    const Detail::Index index(mIndex, mailboxIndex);
+    const Address mailboxAddress(mailboxName, index);
+
+    // Set the actor's mailbox address.
+    // The address contains the index of the framework and the index of the mailbox within the framework.
+    actor->mAddress = mailboxAddress;
+
+    if (mEndPoint)
+    {
+        // Check that no mailbox with this name already exists.
+        Detail::Index dummy;
+        if (mEndPoint->Lookup(mailboxName, dummy))
+        {
+            THERON_FAIL_MSG("Can't create two actors or receivers with the same name");
+        }
+        
+        // Register the mailbox with the endPoint so it can be found using its name.
+        if (!mEndPoint->Register(mailboxName, index))
+        {
+            THERON_FAIL_MSG("Failed to register actor with the network endpoint");
+        }
+    }
+}
+
+
+void Framework::DeregisterActor(Actor *const actor)
+{
+    const Address address(actor->GetAddress());
+    const Detail::String &mailboxName(address.GetName());
+
+    // Deregister the mailbox with the endPoint so it can't be found anymore.
+    if (mEndPoint)
+    {
+        mEndPoint->Deregister(mailboxName);
+    }
+
+    // Deregister the actor, so that the worker threads will leave it alone.
+    const uint32_t mailboxIndex(address.AsInteger());
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(mailboxIndex));
+
+    // If the entry is pinned then we have to wait for it to be unpinned.
+    bool deregistered(false);
+    uint32_t backoff(0);
+
+    while (!deregistered)
+    {
+        mailbox.Lock();
+
+        if (!mailbox.IsPinned())
+        {
+            mailbox.DeregisterActor();
+            deregistered = true;
+        }
+
+        mailbox.Unlock();
+
+        Detail::Utils::Backoff(backoff);
+    }
+}
+
+
+#if THERON_ACTOR_STORE_SIZE
+
+void Framework::MarkActorColocated(Actor *const actor)
+{
+    // Defined here rather than in Framework.h, where Actor is only forward
+    // declared, so the member access is parsed with Actor complete.
+    actor->mMemory = 0;
+}
+
+#endif // THERON_ACTOR_STORE_SIZE
+
+
+bool Framework::MigrateActor(const Address &address, Framework &target)
+{
+    // Only actors homed in this framework can be migrated from it.
+    if (address.mIndex.mComponents.mFramework != mIndex)
+    {
+        return false;
+    }
+
+    // Migrating to the framework the actor is already in is a no-op.
+    if (&target == this)
+    {
+        return true;
+    }
+
+    const uint32_t oldMailboxIndex(address.AsInteger());
+    Detail::Mailbox &oldMailbox(mMailboxes.GetEntry(oldMailboxIndex));
+
+    // Quiesce the mailbox: if it's pinned then a worker thread is processing
+    // the actor, so wait for the handler to return, as actor deregistration does.
+    uint32_t backoff(0);
+    for (;;)
+    {
+        oldMailbox.Lock();
+
+        if (!oldMailbox.IsPinned())
+        {
+            break;
+        }
+
+        oldMailbox.Unlock();
+        Detail::Utils::Backoff(backoff);
+    }
+
+    Actor *const actor(oldMailbox.GetActor());
+    if (actor == 0)
+    {
+        oldMailbox.Unlock();
+        return false;
+    }
+
+    // Re-home the actor to a newly allocated mailbox in the target framework,
+    // keeping its name. The new mailbox is unknown to any other thread until
+    // the forward is published, so registering it can't race.
+    const uint32_t newMailboxIndex(target.mMailboxes.Allocate());
+    Detail::Mailbox &newMailbox(target.mMailboxes.GetEntry(newMailboxIndex));
+
+    const Detail::String mailboxName(oldMailbox.GetName());
+    const Detail::Index newIndex(target.mIndex, newMailboxIndex);
+    const Address newAddress(mailboxName, newIndex);
+
+    newMailbox.Lock();
+    newMailbox.SetName(mailboxName);
+    newMailbox.RegisterActor(actor);
+    newMailbox.Unlock();
+
+    actor->mAddress = newAddress;
+    actor->mFramework = &target;
+
+    // Deregister the actor from the old mailbox and leave a forwarding
+    // address in its place. Messages queued at the old mailbox, and any sent
+    // to the old address from now on, are re-routed to the new mailbox when
+    // the old mailbox is processed, preserving their order of arrival.
+    oldMailbox.DeregisterActor();
+    oldMailbox.SetForward(newIndex.mUInt32);
+    oldMailbox.Unlock();
+
+    // Re-point the name mapping at the new mailbox, so lookups by name
+    // resolve directly to it without paying the forwarding hop.
+    if (mEndPoint)
+    {
+        mEndPoint->Deregister(mailboxName);
+        mEndPoint->Register(mailboxName, newIndex);
+    }
+
+    return true;
+}
+
+
+bool Framework::RedirectMailbox(const Address &address, const Address &target)
+{
+    // Only mailboxes of this framework can be redirected.
+    if (address.mIndex.mComponents.mFramework != mIndex)
+    {
+        return false;
+    }
+
+    const uint32_t oldMailboxIndex(address.AsInteger());
+    Detail::Mailbox &oldMailbox(mMailboxes.GetEntry(oldMailboxIndex));
+
+    // Quiesce the mailbox: if it's pinned then a worker thread is executing a
+    // handler on a still-registered incumbent, so wait for it to return.
+    uint32_t backoff(0);
+    for (;;)
+    {
+        oldMailbox.Lock();
+
+        if (!oldMailbox.IsPinned())
+        {
+            break;
+        }
+
+        oldMailbox.Unlock();
+        Detail::Utils::Backoff(backoff);
+    }
+
+    // A failed actor has typically been destructed and deregistered already;
+    // if an incumbent is still registered -- a wedged actor being forcibly
+    // replaced -- cut it off from the mailbox so it receives nothing further.
+    // The cut-off actor object itself remains owned by the caller.
+    if (oldMailbox.GetActor() != 0)
+    {
+        oldMailbox.DeregisterActor();
+    }
+
+    // Leave a forwarding address in place of the incumbent. Messages queued
+    // at the old mailbox, and any sent to the old address from now on, are
+    // re-routed to the successor when the old mailbox is processed,
+    // preserving their order of arrival.
+    oldMailbox.SetForward(target.mIndex.mUInt32);
+
+    const Detail::String mailboxName(oldMailbox.GetName());
+    oldMailbox.Unlock();
+
+    // Re-point the name mapping at the successor's mailbox, so lookups by
+    // name resolve directly to it without paying the forwarding hop.
+    if (mEndPoint && !mailboxName.IsNull())
+    {
+        mEndPoint->Deregister(mailboxName);
+        mEndPoint->Register(mailboxName, target.mIndex);
+    }
+
+    return true;
+}
+
+
+void Framework::SetMaxThreads(const uint32_t count)
+{
+    // Remember the bound; the manager thread scales within the bounds.
+    mMaxThreadCount.Store(count);
+
+    if (mTargetThreadCount.Load() > count)
+    {
+        mTargetThreadCount.Store(count);
+    }
+}
+
+
+void Framework::SetMinThreads(const uint32_t count)
+{
+    // Remember the bound; the manager thread scales within the bounds.
+    mMinThreadCount.Store(count);
+
+    if (mTargetThreadCount.Load() < count)
+    {
+        mTargetThreadCount.Store(count);
+    }
+}
+
+
+uint32_t Framework::GetMaxThreads() const
+{
+    return mMaxThreadCount.Load();
+}
+
+
+uint32_t Framework::GetMinThreads() const
+{
+    return mMinThreadCount.Load();
+}
+
+
+uint32_t Framework::GetNumThreads() const
+{
+    return mThreadCount.Load();
+}
+
+
+uint32_t Framework::GetPeakThreads() const
+{
+    return mPeakThreadCount.Load();
+}
+
+
+bool Framework::QueuesEmpty() const
+{
+    bool empty(true);
+
+    mSharedWorkQueueSpinLock.Lock();
+
+    if (!mProcessorContext.mWorkQueue.Empty() ||
+        !mProcessorContext.mHighPriorityQueue.Empty() ||
+        !mProcessorContext.mDeadlineQueue.Empty())
+    {
+        empty = false;
+    }
+
+    mSharedWorkQueueSpinLock.Unlock();
+
+    if (!empty)
+    {
+        return false;
+    }
+
+    mThreadContextLock.Lock();
+    
+    // Check the queues in all worker contexts.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+
+        if (!threadContext->mWorkerContext->mLocalQueue.Empty())
+        {
+            empty = false;
+            break;
+        }
+    }
+
+    mThreadContextLock.Unlock();
+
+    return empty;
+}
+
+
+void Framework::ResetCounters() const
+{
+    // Reset the counters in the shared, per-framework context, which counts
+    // scheduling events on non-worker threads.
+    for (uint32_t index = 0; index < (uint32_t) MAX_COUNTERS; ++index)
+    {
+        mProcessorContext.mCounters[index].Store(0);
+    }
+
+    mThreadContextLock.Lock();
+
+    // Reset the counters in all thread contexts.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+
+        for (uint32_t index = 0; index < (uint32_t) MAX_COUNTERS; ++index)
+        {
+            threadContext->mWorkerContext->mCounters[index].Store(0);
+        }
+    }
+
+    mThreadContextLock.Unlock();
+}
+
+
+uint32_t Framework::GetCounterValue(const Counter counter) const
+{
+    // The peak counters record per-context high water marks, so are aggregated
+    // by maximum; all other counters accumulate event counts and are summed.
+    const bool peak(counter == COUNTER_PEAK_LOCAL_QUEUE_DEPTH || counter == COUNTER_PEAK_SHARED_QUEUE_DEPTH);
+
+    // Start with the shared, per-framework context, which counts scheduling
+    // events on non-worker threads.
+    uint32_t total(mProcessorContext.mCounters[counter].Load());
+
+    mThreadContextLock.Lock();
+
+    // Aggregate the counter values from all thread contexts.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+        const uint32_t value(threadContext->mWorkerContext->mCounters[counter].Load());
+
+        if (peak)
+        {
+            total = (value > total) ? value : total;
+        }
+        else
+        {
+            total += value;
+        }
+    }
+
+    mThreadContextLock.Unlock();
+
+    return total;
+}
+
+
+uint32_t Framework::GetPerThreadCounterValues(
+    const Counter counter,
+    uint32_t *const perThreadCounts,
+    const uint32_t maxCounts) const
+{
+    uint32_t itemCount(0);
+
+    mThreadContextLock.Lock();
+
+    // Read the per-thread counter values into the provided array, skipping non-running contexts.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (itemCount < maxCounts && contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+
+        if (ThreadPool::IsRunning(threadContext))
+        {
+            perThreadCounts[itemCount++] = threadContext->mWorkerContext->mCounters[counter].Load();
+        }
+    }
+
+    mThreadContextLock.Unlock();
+
+    return itemCount;
+}
+
+
+void Framework::SetMetricsSink(MetricsSink *const sink, const uint32_t periodMicroseconds)
+{
+    // The sink pointer is read by the manager thread under the same lock.
+    mThreadContextLock.Lock();
+
+    mMetricsSink = sink;
+    mMetricsPeriod = periodMicroseconds;
+
+    mThreadContextLock.Unlock();
+}
+
+
+void Framework::SampleMetrics()
+{
+    MetricsSink::WorkerSample samples[MAX_WORKER_CONTEXTS];
+    uint32_t workerCount(0);
+
+    mThreadContextLock.Lock();
+
+    MetricsSink *const sink(mMetricsSink);
+    if (sink == 0)
+    {
+        mThreadContextLock.Unlock();
+        return;
+    }
+
+    // Snapshot the counters and queue depths of every running worker. The
+    // counters are independent atomic reads, so the snapshot is approximate
+    // while the workers are busy, like the counter query methods.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (workerCount < MAX_WORKER_CONTEXTS && contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+
+        if (ThreadPool::IsRunning(threadContext))
+        {
+            const Detail::Processor::Context *const workerContext(threadContext->mWorkerContext);
+            MetricsSink::WorkerSample &sample(samples[workerCount++]);
+
+            sample.mMessagesProcessed = workerContext->mCounters[COUNTER_MESSAGES_PROCESSED].Load();
+            sample.mLocalQueueDepth = workerContext->mLocalQueue.Size();
+            sample.mMailboxSteals = workerContext->mCounters[COUNTER_MAILBOX_STEALS].Load();
+            sample.mYields = workerContext->mCounters[COUNTER_YIELDS].Load();
+            sample.mSleepTransitions = workerContext->mCounters[COUNTER_SLEEP_TRANSITIONS].Load();
+        }
+    }
+
+    const uint32_t sharedQueueDepth(mProcessorContext.mWorkQueue.Count());
+
+    mThreadContextLock.Unlock();
+
+    // Push the snapshot to the sink outside the lock, so a slow sink delays
+    // only the manager thread's own housekeeping.
+    sink->Sample(samples, workerCount, sharedQueueDepth);
+}
+
+
+bool Framework::GetActorProfile(const Address &address, ActorProfile &profile)
+{
+#if THERON_ENABLE_PROFILING
+
+    bool result(false);
+
+    // The address is assumed to identify an actor within this framework.
+    Detail::Mailbox &mailbox(mMailboxes.GetEntry(address.AsInteger()));
+
+    // Lock the mailbox so the registered actor can't be deregistered while we read its profile.
+    mailbox.Lock();
+
+    Actor *const actor(mailbox.GetActor());
+    if (actor)
+    {
+        result = actor->GetProfile(profile);
+    }
+
+    mailbox.Unlock();
+
+    return result;
+
+#else
+
+    // Profiling is disabled so no profile data exists.
+    (void) address;
+    (void) profile;
+
+    return false;
+
+#endif // THERON_ENABLE_PROFILING
+}
+
+
+void Framework::PhaseBarrier(const Address *const addresses, const uint32_t count)
+{
+    uint32_t backoff(0);
+
+    for (;;)
+    {
+        // Count of messages processed framework-wide before the scan.
+        const uint32_t processedBefore(GetCounterValue(COUNTER_MESSAGES_PROCESSED));
+
+        // Scan the group's mailboxes with relaxed atomic reads, abandoning
+        // the pass at the first mailbox found non-empty. A count of zero
+        // means no messages are queued and none is being processed, since
+        // counts aren't decremented until a message's handlers have run.
+        bool allEmpty(true);
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            const Detail::Mailbox &mailbox(mMailboxes.GetEntry(addresses[index].AsInteger()));
+            if (mailbox.Count() != 0)
+            {
+                allEmpty = false;
+                break;
+            }
+        }
+
+        // The counts are independent snapshots: a member observed empty early
+        // in the scan could have been re-filled by a member scanned later. If
+        // no handler ran anywhere in the framework during the scan then no
+        // member can have sent anything, so the observations held together
+        // and the group is quiescent.
+        if (allEmpty && GetCounterValue(COUNTER_MESSAGES_PROCESSED) == processedBefore)
+        {
+            return;
+        }
+
+        Detail::Utils::Backoff(backoff);
+    }
+}
+
+
+uint32_t Framework::GetTopMemoryUsers(Address *const addresses, uint32_t *const bytesQueued, const uint32_t maxEntries)
+{
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+
+    if (maxEntries == 0)
+    {
+        return 0;
+    }
+
+    uint32_t numEntries(0);
+
+    // Scan the allocated mailboxes, maintaining a descending top-N selection.
+    // Mailbox names and tallies are read without locks, so the report is a
+    // best-effort snapshot rather than a consistent cut.
+    const uint32_t indexLimit(mMailboxes.GetIndexLimit());
+    for (uint32_t mailboxIndex = 1; mailboxIndex <= indexLimit; ++mailboxIndex)
+    {
+        Detail::Mailbox *const mailbox(mMailboxes.TryGetEntry(mailboxIndex));
+        if (mailbox == 0)
+        {
+            continue;
+        }
+
+        const uint32_t bytes(mailbox->GetQueuedBytes());
+        if (bytes == 0 || (numEntries == maxEntries && bytes <= bytesQueued[numEntries - 1]))
+        {
+            continue;
+        }
+
+        // Find the insertion position within the sorted report.
+        uint32_t position(numEntries < maxEntries ? numEntries : maxEntries - 1);
+        while (position > 0 && bytesQueued[position - 1] < bytes)
+        {
+            addresses[position] = addresses[position - 1];
+            bytesQueued[position] = bytesQueued[position - 1];
+            --position;
+        }
+
+        addresses[position] = Address(mailbox->GetName(), Detail::Index(mIndex, mailboxIndex));
+        bytesQueued[position] = bytes;
+
+        if (numEntries < maxEntries)
+        {
+            ++numEntries;
+        }
+    }
+
+    return numEntries;
+
+#else
+
+    // Memory accounting is disabled so no tallies exist.
+    (void) addresses;
+    (void) bytesQueued;
+    (void) maxEntries;
+
+    return 0;
+
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+}
+
+
+#if THERON_ENABLE_TRACING
+
+namespace
+{
+
+// Writes the retained events of one thread's trace buffer as Chrome trace JSON.
+// Handler execution and sleeps are written as duration begin/end pairs, and
+// pushes and scheduling events as instants. Timestamps are converted from
+// clock ticks to the microseconds expected by the trace format, assuming
+// nanosecond ticks as provided by the POSIX and C++11 clocks.
+void WriteTraceEvents(
+    FILE *const file,
+    const Detail::TraceBuffer &buffer,
+    const uint32_t pid,
+    const uint32_t tid,
+    bool &first)
+{
+    const uint32_t eventCount(buffer.GetRetainedCount());
+    for (uint32_t index = 0; index < eventCount; ++index)
+    {
+        const Detail::TraceBuffer::Event &event(buffer.GetEvent(index));
+        const double microseconds(static_cast<double>(event.mTimestamp) / 1000.0);
+
+        const char *name(0);
+        const char *phase(0);
+
+        switch (event.mType)
+        {
+            case Detail::TraceBuffer::EVENT_MESSAGE_PUSH:       name = "push";      phase = "i";    break;
+            case Detail::TraceBuffer::EVENT_MAILBOX_SCHEDULE:   name = "schedule";  phase = "i";    break;
+            case Detail::TraceBuffer::EVENT_HANDLER_BEGIN:      name = "handler";   phase = "B";    break;
+            case Detail::TraceBuffer::EVENT_HANDLER_END:        name = "handler";   phase = "E";    break;
+            case Detail::TraceBuffer::EVENT_THREAD_SLEEP:       name = "sleep";     phase = "B";    break;
+            case Detail::TraceBuffer::EVENT_THREAD_WAKE:        name = "sleep";     phase = "E";    break;
+            default:                                            continue;
+        }
+
+        // Events carrying a sampled causality flow ID get it as an extra
+        // argument, so viewers and scripts can correlate the events of one
+        // flow across mailboxes and threads.
+        if (event.mFlowId != 0)
+        {
+            fprintf(
+                file,
+                "%s\n{\"name\":\"%s\",\"cat\":\"theron\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"mailbox\":%u,\"flow\":%llu}}",
+                first ? "" : ",",
+                name,
+                phase,
+                microseconds,
+                pid,
+                tid,
+                event.mData,
+                static_cast<unsigned long long>(event.mFlowId));
+        }
+        else
+        {
+            fprintf(
+                file,
+                "%s\n{\"name\":\"%s\",\"cat\":\"theron\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"mailbox\":%u}}",
+                first ? "" : ",",
+                name,
+                phase,
+                microseconds,
+                pid,
+                tid,
+                event.mData);
+        }
+
+        first = false;
+    }
+}
+
+} // anonymous namespace
+
+#endif // THERON_ENABLE_TRACING
+
+
+bool Framework::DumpTrace(const char *const path)
+{
+#if THERON_ENABLE_TRACING
+
+    THERON_ASSERT(path);
+
+    FILE *const file(fopen(path, "w"));
+    if (file == 0)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[");
+
+    bool first(true);
+
+    // The per-framework context is written as thread zero; it accumulates the
+    // events of non-worker threads sending into the framework.
+    WriteTraceEvents(file, mProcessorContext.mTraceBuffer, mIndex, 0, first);
+
+    // Worker contexts are registered in the array as the workers start, and
+    // the count only ever grows, so this snapshot covers all started workers.
+    const uint32_t workerCount(mWorkerContextCount.Load());
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+    {
+        WriteTraceEvents(file, mWorkerContexts[workerIndex]->mTraceBuffer, mIndex, workerIndex + 1, first);
+    }
+
+    fprintf(file, "\n]}\n");
+
+    const bool result(fclose(file) == 0);
+    return result;
+
+#else
+
+    // Tracing is disabled so no trace data exists.
+    (void) path;
+
+    return false;
+
+#endif // THERON_ENABLE_TRACING
+}
+
+
+#if THERON_ENABLE_MESSAGE_STATS
+
+namespace
+{
+
+// Adds one thread's per-type tallies into a merged report.
+void MergeMessageTypeStats(MessageTypeStats &target, const MessageTypeStats &source)
+{
+    for (uint32_t typeId = 0; typeId < MessageTypeStats::MAX_TYPES; ++typeId)
+    {
+        const MessageTypeStats::TypeStats &entry(source.mTypes[typeId]);
+        MessageTypeStats::TypeStats &merged(target.mTypes[typeId]);
+
+        if (merged.mTypeName == 0)
+        {
+            merged.mTypeName = entry.mTypeName;
+        }
+
+        merged.mSentCount += entry.mSentCount;
+        merged.mSentBytes += entry.mSentBytes;
+        merged.mProcessedCount += entry.mProcessedCount;
+        merged.mProcessedBytes += entry.mProcessedBytes;
+    }
+}
+
+} // namespace
+
+#endif // THERON_ENABLE_MESSAGE_STATS
+
+
+bool Framework::GetMessageTypeStats(MessageTypeStats &stats) const
+{
+    stats = MessageTypeStats();
+
+#if THERON_ENABLE_MESSAGE_STATS
+
+    // The per-framework context accumulates the sends of non-worker threads.
+    MergeMessageTypeStats(stats, mProcessorContext.mMessageStats);
+
+    // Worker contexts are registered in the array as the workers start, and
+    // the count only ever grows, so this snapshot covers all started workers.
+    const uint32_t workerCount(mWorkerContextCount.Load());
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+    {
+        MergeMessageTypeStats(stats, mWorkerContexts[workerIndex]->mMessageStats);
+    }
+
+    return true;
+
+#else
+
+    // Statistics are disabled so no tallies exist.
+    return false;
+
+#endif // THERON_ENABLE_MESSAGE_STATS
+}
+
+
+void Framework::GetAllocatorCacheStats(AllocatorCacheStats &stats) const
+{
+    stats = AllocatorCacheStats();
+
+    // The shared cache serves non-worker threads directly and backs the
+    // per-thread caches, so its misses are the framework's global fallbacks.
+    mMessageAllocator.GetStats(stats);
+
+    // The per-framework context owns a cache of its own, like the worker contexts.
+    mProcessorContext.mMessageCache.GetStats(stats);
+
+    // Worker contexts are registered in the array as the workers start, and
+    // the count only ever grows, so this snapshot covers all started workers.
+    const uint32_t workerCount(mWorkerContextCount.Load());
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; ++workerIndex)
+    {
+        mWorkerContexts[workerIndex]->mMessageCache.GetStats(stats);
+    }
+}
+
+
+bool Framework::SaveWarmState(const char *const path)
+{
+    THERON_ASSERT(path);
+
+    // The pools are process-wide, so the saved state covers all frameworks.
+    return Detail::MessagePool::Save(path);
+}
+
+
+void Framework::SetYieldStrategy(const YieldStrategy yieldStrategy)
+{
+    // Remember the strategy so workers created later also adopt it.
+    mYieldStrategy = yieldStrategy;
+
+    // Under the blocking strategy the scheduling path wakes sleeping workers
+    // via the shared condition, so all contexts need pointers to it. The
+    // pointers are set before the yield functions are swapped, and are benign
+    // under the other strategies since no worker then sleeps on the condition,
+    // so they're left in place when switching away.
+    if (yieldStrategy == YIELD_STRATEGY_BLOCKING)
+    {
+        mProcessorContext.mWorkerCondition = &mWorkerCondition;
+        mProcessorContext.mNumSleepingWorkers = &mNumSleepingWorkers;
+    }
+
+    // Swap the yield function in the shared, per-framework context.
+    mProcessorContext.mYield.SetYieldFunction(YieldFunctionForStrategy(yieldStrategy));
+
+    mThreadContextLock.Lock();
+
+    // Swap the yield functions in the per-thread contexts of the running
+    // workers. The swap is a single pointer write that each worker picks up
+    // the next time it looks for work; workers asleep under the blocking
+    // strategy wake within their bounded wait timeout.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+        Detail::Processor::Context *const workerContext(threadContext->mWorkerContext);
+
+        if (yieldStrategy == YIELD_STRATEGY_BLOCKING)
+        {
+            workerContext->mWorkerCondition = &mWorkerCondition;
+            workerContext->mNumSleepingWorkers = &mNumSleepingWorkers;
+        }
+
+        workerContext->mYield.SetYieldFunction(YieldFunctionForStrategy(yieldStrategy));
+    }
+
+    mThreadContextLock.Unlock();
+}
+
+
+void Framework::SetMessageCacheDepth(const uint32_t blockSize, const uint32_t maxBlocks)
+{
+    // Configure the shared, per-framework message cache.
+    mMessageAllocator.SetPoolDepth(blockSize, maxBlocks);
+
+    mThreadContextLock.Lock();
+
+    // Configure the per-thread caches in all worker contexts.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+        threadContext->mWorkerContext->mMessageCache.SetPoolDepth(blockSize, maxBlocks);
+    }
+
+    mThreadContextLock.Unlock();
+}
+
+
+void Framework::Preallocate(const uint32_t blockSize, const uint32_t count)
+{
+    // Warm the shared, per-framework message cache.
+    mMessageAllocator.Preallocate(blockSize, count);
+
+    mThreadContextLock.Lock();
+
+    // Warm the per-thread caches in all worker contexts. The per-thread caches
+    // aren't synchronized, so this relies on the caller not yet having sent any
+    // messages, leaving the worker threads with no message work to do.
+    ContextList::Iterator contexts(mThreadContexts.GetIterator());
+    while (contexts.Next())
+    {
+        ThreadPool::ThreadContext *const threadContext(contexts.Get());
+        threadContext->mWorkerContext->mMessageCache.Preallocate(blockSize, count);
+    }
+
+    mThreadContextLock.Unlock();
+}
+
+
+void Framework::ManagerThreadEntryPoint(void *const context)
+{
+    // The static entry point function is passed the object pointer as context.
+    Framework *const framework(reinterpret_cast<Framework *>(context));
+    framework->ManagerThreadProc();
+}
+
+
+void Framework::ManagerThreadProc()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    while (mRunning)
+    {
+        // Each worker parked in a blocking section is compensated with a
+        // replacement worker for the duration, within the SetMaxThreads bound,
+        // so blocking calls in handlers don't reduce the framework's effective
+        // parallelism. When the framework is terminating the target is zero
+        // and any workers still parked in blocking sections aren't replaced.
+        uint32_t desiredThreadCount(mTargetThreadCount.Load());
+        if (desiredThreadCount > 0)
+        {
+            desiredThreadCount += mBlockedThreadCount.Load();
+
+            const uint32_t maxThreadCount(mMaxThreadCount.Load());
+            if (desiredThreadCount > maxThreadCount)
+            {
+                desiredThreadCount = maxThreadCount;
+            }
+        }
+
+        mThreadContextLock.Lock();
+
+        // Re-start stopped worker threads while the thread count is too low.
+        ContextList::Iterator contexts(mThreadContexts.GetIterator());
+        while (mThreadCount.Load() < desiredThreadCount && contexts.Next())
+        {
+            ThreadPool::ThreadContext *const threadContext(contexts.Get());
+
+            if (!ThreadPool::IsRunning(threadContext))
+            {
+                // Restarted threads keep the NUMA node and dedicated processor
+                // they were originally assigned, preserving their cache residency.
+                if (!ThreadPool::StartThread(
+                    threadContext,
+                    threadContext->mNodeMask,
+                    mParams.mProcessorMask,
+                    threadContext->mWorkerProcessor))
+                {
+                    break;
+                }
+
+                mThreadCount.Increment();
+            }
+        }
+
+        // Create new worker threads while the thread count is still too low.
+        while (mThreadCount.Load() < desiredThreadCount)
+        {
+            // Worker contexts live in a cache-line-padded contiguous array,
+            // ordered by worker index, so the manager thread's counter
+            // sampling scans sequentially and the counters and caches of
+            // neighboring workers never share a cache line. The array covers
+            // the work-stealing limit; contexts beyond it, which aren't
+            // stolen from or sampled, fall back to individual allocations.
+            void *storeMemory(0);
+            bool slabResident(false);
+
+            const uint32_t workerContextIndex(mWorkerContextCount.Load());
+            if (workerContextIndex < MAX_WORKER_CONTEXTS)
+            {
+                if (mWorkerContextSlab == 0)
+                {
+                    mWorkerContextSlab = reinterpret_cast<uint8_t *>(
+                        allocator->AllocateAligned(MAX_WORKER_CONTEXTS * WORKER_CONTEXT_STRIDE, THERON_CACHELINE_ALIGNMENT));
+                }
+
+                if (mWorkerContextSlab)
+                {
+                    storeMemory = mWorkerContextSlab + workerContextIndex * WORKER_CONTEXT_STRIDE;
+                    slabResident = true;
+                }
+            }
+
+            if (storeMemory == 0)
+            {
+                storeMemory = allocator->AllocateAligned(sizeof(Detail::Processor::Context), THERON_CACHELINE_ALIGNMENT);
+            }
+
+            if (storeMemory == 0)
+            {
+                continue;
+            }
+
+            Detail::Processor::Context *const store = new (storeMemory) Detail::Processor::Context(
+                &mMailboxes,
+                &mSharedWorkQueueSpinLock,
+                &mFallbackHandlers,
+                &mMessageAllocator);
+
+            // Set up the work queue pointers in this per-thread context.
+            // The per-thread contexts have pointers to the single shared queue and their own owned queues.
+            store->mSharedWorkQueue = &mProcessorContext.mWorkQueue;
+            store->mSharedHighPriorityWorkQueue = &mProcessorContext.mHighPriorityQueue;
+            store->mSharedDeadlineWorkQueue = &mProcessorContext.mDeadlineQueue;
+            store->mLocalWorkQueue = &store->mLocalQueue;
+            store->mSharedParallelTask = &mParallelTask;
+
+            // Set up the message batching quantum, guarding against a zero batch size.
+            store->mMessageBatchSize = (mParams.mMessageBatchSize > 0) ? mParams.mMessageBatchSize : 1;
+            store->mHandlerBudgetMicroseconds = mParams.mHandlerBudgetMicroseconds;
+            store->mSchedulerId = SchedulerIdForPolicy(mParams.mSchedulerPolicy);
+
+            // Distribute the workers round-robin across the NUMA nodes enabled in
+            // the node mask, recording each worker's node so the steal loop can
+            // prefer same-node victims over ones whose caches are remote.
+            const uint32_t workerNode(WorkerNodeFromMask(mParams.mNodeMask, mThreadContexts.Size()));
+            const uint32_t workerNodeMask(mParams.mNodeMask ? (1u << workerNode) : 0);
+            store->mNumaNode = workerNode;
+
+            // Publish the worker context so other workers can steal from its local queue.
+            // Contexts are reused when threads are restarted and are only destroyed at
+            // shutdown, after all the workers have stopped, so the array only ever grows.
+            store->mWorkerContexts = mWorkerContexts;
+            store->mWorkerContextCount = &mWorkerContextCount;
+
+            const uint32_t workerContextCount(mWorkerContextCount.Load());
+            if (workerContextCount < MAX_WORKER_CONTEXTS)
+            {
+                mWorkerContexts[workerContextCount] = store;
+                mWorkerContextCount.Increment();
+            }
+
+            // Set up the yield strategy in the per-thread context.
+            store->mYield.SetYieldFunction(YieldFunctionForStrategy(mYieldStrategy));
+
+            // Under the blocking strategy, workers sleep on the framework's shared condition.
+            store->mWorkerCondition = mProcessorContext.mWorkerCondition;
+            store->mNumSleepingWorkers = mProcessorContext.mNumSleepingWorkers;
+
+            // Create a thread context structure wrapping the worker context.
+            void *const contextMemory = allocator->AllocateAligned(sizeof(ThreadPool::ThreadContext), THERON_CACHELINE_ALIGNMENT);
+            if (contextMemory == 0)
+            {
+                if (!slabResident)
+                {
+                    allocator->Free(storeMemory);
+                }
+
+                break;
+            }
+
+            ThreadPool::ThreadContext *const threadContext = new (contextMemory) ThreadPool::ThreadContext(store);
+
+            // Create a worker thread with the created context.
+            if (!ThreadPool::CreateThread(threadContext))
+            {
+                if (!slabResident)
+                {
+                    allocator->Free(storeMemory);
+                }
+
+                allocator->Free(threadContext);
+                break;
+            }
+
+            // If the application provided per-worker processor indices then the
+            // i-th created worker is pinned to the i-th processor of the array;
+            // workers beyond the array get the mask-based affinity instead.
+            const uint32_t workerIndex(mThreadContexts.Size());
+            uint32_t workerProcessor(ThreadPool::NO_PROCESSOR);
+
+            if (mParams.mWorkerProcessors && workerIndex < mParams.mWorkerProcessorCount)
+            {
+                workerProcessor = mParams.mWorkerProcessors[workerIndex];
+            }
+
+            // Start the thread on its assigned node, so the OS schedules it on
+            // the node the steal loop treats as local to it.
+            if (!ThreadPool::StartThread(
+                threadContext,
+                workerNodeMask,
+                mParams.mProcessorMask,
+                workerProcessor))
+            {
+                if (!slabResident)
+                {
+                    allocator->Free(storeMemory);
+                }
+
+                allocator->Free(threadContext);
+                break;
+            }
+
+            // Remember the context so we can reuse it and eventually destroy it.
+            mThreadContexts.Insert(threadContext);
+
+            // Track the peak thread count.
+            mThreadCount.Increment();
+            if (mThreadCount.Load() > mPeakThreadCount.Load())
+            {
+                mPeakThreadCount.Store(mThreadCount.Load());
+            }
+        }
+
+        // Stop some running worker threads while the thread count is too high.
+        contexts = mThreadContexts.GetIterator();
+        while (mThreadCount.Load() > desiredThreadCount && contexts.Next())
+        {
+            ThreadPool::ThreadContext *const threadContext(contexts.Get());
+            if (ThreadPool::IsRunning(threadContext))
+            {
+                ThreadPool::StopThread(threadContext);
+                mThreadCount.Decrement();
+            }
+        }
+
+        mThreadContextLock.Unlock();
+
+        // Adjust the target thread count in response to load, within the bounds
+        // set by SetMinThreads and SetMaxThreads. When the bounds coincide, as
+        // they do by default, the control loop leaves the thread count alone.
+        if (mMinThreadCount.Load() < mMaxThreadCount.Load())
+        {
+            ManageThreadCount();
+        }
+
+        // Fire any delayed or periodic sends that have become due.
+        mTimerWheel.Service();
+
+        // Push a metrics snapshot to the registered sink when one is due.
+        if (mMetricsSink)
+        {
+            const uint64_t now(Detail::ProfileClock::GetMicroseconds());
+            if (now >= mNextMetricsTime)
+            {
+                mNextMetricsTime = now + mMetricsPeriod;
+                SampleMetrics();
+            }
+        }
+
+        // When the workers have been idle for a stretch, run one bounded
+        // maintenance pass over the shared message cache, releasing cached
+        // blocks of sizes no longer in use back to the low-level allocator.
+        // Without this the cache pins the high-water mark of every block size
+        // ever allocated for the life of the framework. The pass is
+        // rate-limited twice over: it runs only after sustained idleness, and
+        // each pass releases at most a fixed number of blocks, so resumed
+        // traffic never contends with more than a brief, bounded trim.
+        {
+            // Number of consecutive idle samples before a maintenance pass runs.
+            const uint32_t maintenanceIdleSamples(50);
+
+            // Maximum number of cached blocks released per maintenance pass.
+            const uint32_t maintenanceTrimBlocks(64);
+
+            const uint32_t processedCount(GetCounterValue(COUNTER_MESSAGES_PROCESSED));
+            const bool idle(
+                processedCount == mLastIdleProcessedCount &&
+                mProcessorContext.mWorkQueue.Count() == 0 &&
+                mProcessorContext.mHighPriorityQueue.Count() == 0 &&
+                mProcessorContext.mDeadlineQueue.Count() == 0);
+
+            mLastIdleProcessedCount = processedCount;
+
+            if (!idle)
+            {
+                mIdleSamples = 0;
+            }
+            else if (++mIdleSamples >= maintenanceIdleSamples)
+            {
+                mIdleSamples = 0;
+                mMessageAllocator.Trim(maintenanceTrimBlocks);
+            }
+        }
+
+        // The manager thread spends most of its time asleep. When timers are
+        // pending, or a metrics sink wants sub-granularity sampling, it sleeps
+        // more briefly so that due events are noticed promptly.
+        const bool fastService(!mTimerWheel.Empty() || (mMetricsSink && mMetricsPeriod < 10000));
+        Detail::Utils::SleepThread(fastService ? 1 : 10);
+    }
+
+    // Free all the allocated thread context objects.
+    while (!mThreadContexts.Empty())
+    {
+        ThreadPool::ThreadContext *const threadContext(mThreadContexts.Front());
+        mThreadContexts.Remove(threadContext);
+
+        // Wait for the thread to stop and then destroy it.
+        ThreadPool::DestroyThread(threadContext);
+
+        // Destruct the per-worker-thread storage. Contexts resident in the
+        // contiguous context array are freed with it below; contexts beyond
+        // the work-stealing limit were individually allocated.
+        Detail::Processor::Context *const workerContext(threadContext->mWorkerContext);
+        const uint8_t *const contextBytes(reinterpret_cast<const uint8_t *>(workerContext));
+
+        workerContext->~Context();
+
+        if (mWorkerContextSlab == 0 ||
+            contextBytes < mWorkerContextSlab ||
+            contextBytes >= mWorkerContextSlab + MAX_WORKER_CONTEXTS * WORKER_CONTEXT_STRIDE)
+        {
+            allocator->Free(workerContext, sizeof(Detail::Processor::Context));
+        }
+
+        // Destruct and free the per-thread context.
+        threadContext->~ThreadContext();
+        allocator->Free(threadContext, sizeof(ThreadPool::ThreadContext));
+    }
+
+    // Free the contiguous worker context array.
+    if (mWorkerContextSlab)
+    {
+        allocator->Free(mWorkerContextSlab, MAX_WORKER_CONTEXTS * WORKER_CONTEXT_STRIDE);
+        mWorkerContextSlab = 0;
+    }
+}
+
+
+void Framework::ManageThreadCount()
+{
+    // Number of consecutive samples showing a backlog before a worker is added.
+    const uint32_t scaleUpSamples(5);
+
+    // Number of consecutive idle samples before a worker is retired. Retiring
+    // is much slower than adding, so brief lulls don't shed threads that an
+    // imminent burst would need again.
+    const uint32_t scaleDownSamples(100);
+
+    // Messages processed per worker per sample below which the framework is
+    // considered underutilized.
+    const uint32_t lowUtilizationRate(10);
+
+    // Sample the depth of the shared work queues. The read is unsynchronized
+    // but only feeds a heuristic, so an occasional stale value is harmless.
+    const uint32_t queueDepth(
+        mProcessorContext.mWorkQueue.Count() +
+        mProcessorContext.mHighPriorityQueue.Count() +
+        mProcessorContext.mDeadlineQueue.Count());
+
+    // Sample the rate of message processing since the last sample.
+    // The counter totals wrap; unsigned subtraction keeps the delta correct.
+    const uint32_t processedCount(GetCounterValue(COUNTER_MESSAGES_PROCESSED));
+    const uint32_t processedDelta(processedCount - mLastProcessedCount);
+    mLastProcessedCount = processedCount;
+
+    const uint32_t targetThreadCount(mTargetThreadCount.Load());
+
+    if (queueDepth > targetThreadCount)
+    {
+        // Mailboxes are backing up on the shared queue faster than the workers
+        // drain them. Add a worker once the backlog has persisted across
+        // enough samples to rule out a transient spike.
+        mScaleDownSamples = 0;
+        if (++mScaleUpSamples >= scaleUpSamples)
+        {
+            mScaleUpSamples = 0;
+            if (targetThreadCount < mMaxThreadCount.Load())
+            {
+                mTargetThreadCount.Store(targetThreadCount + 1);
+            }
+        }
+    }
+    else if (queueDepth == 0 && processedDelta < targetThreadCount * lowUtilizationRate)
+    {
+        // The shared queue is empty and the workers are processing few
+        // messages. Retire a worker once the lull has persisted long enough.
+        mScaleUpSamples = 0;
+        if (++mScaleDownSamples >= scaleDownSamples)
+        {
+            mScaleDownSamples = 0;
+            if (targetThreadCount > mMinThreadCount.Load())
+            {
+                mTargetThreadCount.Store(targetThreadCount - 1);
+            }
+        }
+    }
+    else
+    {
+        // Load is in balance; reset the hysteresis in both directions.
+        mScaleUpSamples = 0;
+        mScaleDownSamples = 0;
+    }
+}
+
+
+} // namespace Theron
+
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif //_MSC_VER
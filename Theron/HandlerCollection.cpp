@@ -1,68 +1,132 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-#include <Theron/Detail/Handlers/HandlerCollection.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-HandlerCollection::HandlerCollection() :
-  mHandlers(),
-  mNewHandlers(),
-  mHandlersDirty(false)
-{
-}
-
-
-HandlerCollection::~HandlerCollection()
-{
-    Clear();
-}
-
-
-void HandlerCollection::UpdateHandlers()
-{
-    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
-
-    mHandlersDirty = false;
-
-    // Add any new handlers. We do this first in case any are already marked for deletion.
-    // The handler class contains the next pointer, so handlers can only be in one list at a time.
-    while (IMessageHandler *const handler = mNewHandlers.Front())
-    {
-        mNewHandlers.Remove(handler);
-        mHandlers.Insert(handler);
-    }
-
-    // Transfer all handlers to the new handler list, omitting any which are marked for deletion.    
-    while (IMessageHandler *const handler = mHandlers.Front())
-    {
-        mHandlers.Remove(handler);
-        if (handler->IsMarked())
-        {
-            handler->~IMessageHandler();
-            allocator->Free(handler);
-        }
-        else
-        {
-            mNewHandlers.Insert(handler);
-        }
-    }
-
-    // Finally transfer the filtered handlers back in the actual list.
-    while (IMessageHandler *const handler = mNewHandlers.Front())
-    {
-        mNewHandlers.Remove(handler);
-        mHandlers.Insert(handler);
-    }
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Detail/Handlers/HandlerCollection.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+HandlerCollection::HandlerCollection() :
+  mTable(),
+  mTableShared(false),
+  mRetiredTables(0),
+  mRetiredHandlers(),
+  mLastHandler(0),
+  mLastTypeId(0)
+{
+}
+
+
+HandlerCollection::~HandlerCollection()
+{
+    // No dispatch can be in flight during destruction, so everything the
+    // clear retires can be reclaimed immediately.
+    Clear();
+    ReclaimRetired();
+}
+
+
+bool HandlerCollection::PublishTable(IMessageHandler *const added, IMessageHandler *const removed)
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Allocate and construct the new snapshot table.
+    void *const memory(allocator->Allocate(sizeof(Table)));
+    if (memory == 0)
+    {
+        return false;
+    }
+
+    Table *const newTable = new (memory) Table();
+    Table *const oldTable(reinterpret_cast<Table *>(mTable.Load()));
+
+    // Fill the table group by group, so the handlers end up contiguous and
+    // grouped by dispatch bucket, with the RTTI-matched group last. The
+    // surviving handlers keep their registration order within each group.
+    // Handler counts are small, so the repeated passes are cheap.
+    for (uint32_t group = 0; group <= DISPATCH_BUCKETS; ++group)
+    {
+        if (oldTable)
+        {
+            for (uint32_t index = 0; index < oldTable->mHandlers.Size(); ++index)
+            {
+                IMessageHandler *const handler(oldTable->mHandlers[index]);
+                if (handler != removed && GroupOf(handler) == group)
+                {
+                    newTable->mHandlers.Insert(handler);
+                }
+            }
+        }
+
+        if (added && GroupOf(added) == group)
+        {
+            newTable->mHandlers.Insert(added);
+        }
+
+        newTable->mGroupEnds[group] = newTable->mHandlers.Size();
+    }
+
+    // Publish the new snapshot with a single atomic store, and retire the
+    // replaced table, which an in-flight dispatch may still be reading. A
+    // replaced table owned by a shared handler table outlives this
+    // collection, so is simply dropped; the new copy-on-write snapshot is
+    // owned by the collection, which diverges from the shared table here.
+    mTable.Store(newTable);
+
+    if (oldTable)
+    {
+        if (mTableShared)
+        {
+            mTableShared = false;
+        }
+        else
+        {
+            oldTable->mNextRetired = mRetiredTables;
+            mRetiredTables = oldTable;
+        }
+    }
+
+    // Any change to the registered handlers can invalidate the cached
+    // last-matched handler, so empty the inline cache and let the next
+    // dispatch re-prime it.
+    mLastHandler = 0;
+    mLastTypeId = 0;
+
+    return true;
+}
+
+
+void HandlerCollection::ReclaimRetired()
+{
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    // Destruct and free the retired tables.
+    Table *table(mRetiredTables);
+    while (table)
+    {
+        Table *const next(table->mNextRetired);
+        table->~Table();
+        allocator->Free(table);
+        table = next;
+    }
+
+    mRetiredTables = 0;
+
+    // Destruct and free the removed handler objects.
+    for (uint32_t index = 0; index < mRetiredHandlers.Size(); ++index)
+    {
+        IMessageHandler *const handler(mRetiredHandlers[index]);
+        handler->~IMessageHandler();
+        allocator->Free(handler);
+    }
+
+    mRetiredHandlers.Clear();
+}
+
+
+} // namespace Detail
+} // namespace Theron
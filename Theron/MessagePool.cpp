@@ -0,0 +1,246 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <stdio.h>
+
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Allocators/MessagePool.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+MessagePool::Entry MessagePool::smEntries[MessagePool::MAX_POOLED_TYPES];
+
+
+void MessagePool::Register(const uint32_t typeId, const uint32_t blockSize, const uint32_t blockAlignment)
+{
+    THERON_ASSERT(blockSize >= sizeof(void *));
+
+    // Types with IDs beyond the table are silently left unpooled; allocation
+    // for them falls through to the general message caches.
+    if (typeId >= MAX_POOLED_TYPES)
+    {
+        return;
+    }
+
+    Entry &entry(smEntries[typeId]);
+
+    entry.mLock.Lock();
+
+    THERON_ASSERT_MSG(entry.mBlockSize == 0 || entry.mBlockSize == blockSize, "Message type pool registered twice with different sizes");
+
+    entry.mBlockSize = blockSize;
+    entry.mBlockAlignment = blockAlignment;
+    entry.mMaxBlocks = DEFAULT_MAX_BLOCKS;
+
+    entry.mLock.Unlock();
+}
+
+
+void MessagePool::SetDepth(const uint32_t typeId, const uint32_t maxBlocks)
+{
+    if (typeId >= MAX_POOLED_TYPES)
+    {
+        return;
+    }
+
+    Entry &entry(smEntries[typeId]);
+
+    THERON_ASSERT_MSG(entry.mBlockSize, "Message type has no registered pool");
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+    entry.mLock.Lock();
+
+    entry.mMaxBlocks = maxBlocks;
+
+    // Release any surplus blocks above the new depth.
+    while (entry.mBlockCount > maxBlocks)
+    {
+        void *const block(entry.mHead);
+
+        entry.mHead = *reinterpret_cast<void **>(block);
+        --entry.mBlockCount;
+
+        allocator->Free(block, entry.mBlockSize);
+    }
+
+    // Preallocate the pool to the new depth, so the configured number of
+    // messages can be allocated without touching the general allocator.
+    while (entry.mBlockCount < maxBlocks)
+    {
+        void *const block(allocator->AllocateAligned(entry.mBlockSize, entry.mBlockAlignment));
+        if (block == 0)
+        {
+            break;
+        }
+
+        *reinterpret_cast<void **>(block) = entry.mHead;
+        entry.mHead = block;
+        ++entry.mBlockCount;
+    }
+
+    entry.mLock.Unlock();
+}
+
+
+namespace
+{
+
+
+/**
+Magic word identifying a pool warm-state file, bumped on format changes.
+*/
+const uint32_t WARM_STATE_MAGIC = 0x54575331;   // 'TWS1'
+
+
+/**
+On-disk record describing the configuration and fill level of one pool.
+*/
+struct WarmStateRecord
+{
+    uint32_t mTypeId;           ///< Dense ID of the pooled message type.
+    uint32_t mBlockSize;        ///< Size of the pooled blocks, validating the match.
+    uint32_t mBlockAlignment;   ///< Alignment of the pooled blocks.
+    uint32_t mMaxBlocks;        ///< Configured maximum number of retained blocks.
+    uint32_t mBlockCount;       ///< Number of free blocks held when the state was saved.
+};
+
+
+} // namespace
+
+
+bool MessagePool::Save(const char *const path)
+{
+    THERON_ASSERT(path);
+
+    FILE *const file(fopen(path, "wb"));
+    if (file == 0)
+    {
+        return false;
+    }
+
+    bool success(fwrite(&WARM_STATE_MAGIC, sizeof(WARM_STATE_MAGIC), 1, file) == 1);
+
+    // Count the registered pools first, so the record count leads the records.
+    uint32_t count(0);
+    for (uint32_t typeId = 0; typeId < MAX_POOLED_TYPES; ++typeId)
+    {
+        if (smEntries[typeId].mBlockSize != 0)
+        {
+            ++count;
+        }
+    }
+
+    success = success && (fwrite(&count, sizeof(count), 1, file) == 1);
+
+    for (uint32_t typeId = 0; success && typeId < MAX_POOLED_TYPES; ++typeId)
+    {
+        Entry &entry(smEntries[typeId]);
+        if (entry.mBlockSize == 0)
+        {
+            continue;
+        }
+
+        WarmStateRecord record;
+
+        // Snapshot the entry under its lock, so the record is consistent.
+        entry.mLock.Lock();
+        record.mTypeId = typeId;
+        record.mBlockSize = entry.mBlockSize;
+        record.mBlockAlignment = entry.mBlockAlignment;
+        record.mMaxBlocks = entry.mMaxBlocks;
+        record.mBlockCount = entry.mBlockCount;
+        entry.mLock.Unlock();
+
+        success = (fwrite(&record, sizeof(record), 1, file) == 1);
+    }
+
+    fclose(file);
+    return success;
+}
+
+
+bool MessagePool::Load(const char *const path)
+{
+    THERON_ASSERT(path);
+
+    FILE *const file(fopen(path, "rb"));
+    if (file == 0)
+    {
+        return false;
+    }
+
+    uint32_t magic(0);
+    uint32_t count(0);
+
+    if (fread(&magic, sizeof(magic), 1, file) != 1 ||
+        magic != WARM_STATE_MAGIC ||
+        fread(&count, sizeof(count), 1, file) != 1)
+    {
+        fclose(file);
+        return false;
+    }
+
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    bool success(true);
+
+    for (uint32_t index = 0; success && index < count; ++index)
+    {
+        WarmStateRecord record;
+        success = (fread(&record, sizeof(record), 1, file) == 1);
+        if (!success)
+        {
+            break;
+        }
+
+        // Skip records that don't match a registered pool; the binary changed
+        // since the state was saved, so its type IDs can't be trusted.
+        if (record.mTypeId >= MAX_POOLED_TYPES)
+        {
+            continue;
+        }
+
+        Entry &entry(smEntries[record.mTypeId]);
+        if (entry.mBlockSize != record.mBlockSize)
+        {
+            continue;
+        }
+
+        entry.mLock.Lock();
+
+        // Restore the configured depth, then preallocate the pool back to its
+        // saved fill level, so the first messages after restart hit warm pools.
+        entry.mMaxBlocks = record.mMaxBlocks;
+
+        const uint32_t targetCount(record.mBlockCount < record.mMaxBlocks ? record.mBlockCount : record.mMaxBlocks);
+        while (entry.mBlockCount < targetCount)
+        {
+            void *const block(allocator->AllocateAligned(entry.mBlockSize, entry.mBlockAlignment));
+            if (block == 0)
+            {
+                break;
+            }
+
+            *reinterpret_cast<void **>(block) = entry.mHead;
+            entry.mHead = block;
+            ++entry.mBlockCount;
+        }
+
+        entry.mLock.Unlock();
+    }
+
+    fclose(file);
+    return success;
+}
+
+
+} // namespace Detail
+} // namespace Theron
@@ -10,11 +10,14 @@
 
 #include <Theron/EndPoint.h>
 #include <Theron/Framework.h>
+#include <Theron/QueueWatermarkEvent.h>
 
+#include <Theron/Detail/Directory/FrameworkCache.h>
 #include <Theron/Detail/Directory/StaticDirectory.h>
 #include <Theron/Detail/Messages/MessageCreator.h>
 #include <Theron/Detail/Messages/MessageSender.h>
 #include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Network/ProcessNameRegistry.h>
 #include <Theron/Detail/Network/String.h>
 
 
@@ -30,10 +33,46 @@ bool MessageSender::Send(
     const uint32_t localFrameworkIndex,
     IMessage *const message,
     const Address &address,
-    const bool localQueue)
+    const bool localQueue,
+    const bool tailCall)
 {
     Index index(address.mIndex);
 
+#if THERON_ENABLE_MESSAGE_STATS
+    // Count the message against its registered type in the sending thread's
+    // table. Worker threads own their contexts; the shared per-framework
+    // context is used by many application threads, so its tallies are best-effort.
+    {
+        const uint32_t typeId(message->GetTypeId());
+        const uint32_t slot(typeId < MessageTypeStats::MAX_TYPES ? typeId : 0);
+        MessageTypeStats::TypeStats &stats(processorContext->mMessageStats.mTypes[slot]);
+
+        if (slot)
+        {
+            stats.mTypeName = message->TypeName();
+        }
+
+        ++stats.mSentCount;
+        stats.mSentBytes += message->GetMessageSize();
+    }
+#endif // THERON_ENABLE_MESSAGE_STATS
+
+#if THERON_NO_NETWORK
+
+    // The name resolution branch is compiled out of the send path in this
+    // profile: all messages must be sent to concrete local addresses.
+    if (index.mUInt32 == 0)
+    {
+        THERON_ASSERT_MSG(false, "Sends to name-only addresses are compiled out by THERON_NO_NETWORK");
+
+        processorContext->mFallbackHandlers->Handle(message);
+        Detail::MessageCreator::Destroy(&processorContext->mMessageCache, message);
+
+        return false;
+    }
+
+#else // THERON_NO_NETWORK
+
     // Index of zero implies the actor is addressed only by name and may be remote.
     if (index.mUInt32 == 0)
     {
@@ -42,16 +81,41 @@ bool MessageSender::Send(
         THERON_ASSERT(!name.IsNull());
         THERON_ASSERT_MSG(endPoint, "Sending messages addressed by name requires a Theron::EndPoint");
 
-        // Search the local endPoint for a mailbox with the given name.
-        // If there is a local match we fall through using the retrieved index, and we don't
-        // bother to push the message out onto the network, since names are globally unique.
-        if (!endPoint->Lookup(name, index))
+        // Worker threads own their contexts, so can cache resolved lookups for
+        // stable destinations without synchronization. The shared per-framework
+        // context is used by many application threads at once, so gets no cache.
+        NameCache *const nameCache(processorContext->mLocalWorkQueue ? &processorContext->mNameCache : 0);
+
+        // The combined version covers both maps consulted below; both only
+        // ever grow, so a change in either invalidates cached resolutions.
+        const uint32_t nameVersion(endPoint->GetNameVersion() + ProcessNameRegistry::GetVersion());
+
+        if (nameCache == 0 || !nameCache->Get(name, nameVersion, index))
         {
-            // If there isn't a local match we send the message out onto the network.
-            return endPoint->RequestSend(message, name);
+            // Search the local endPoint for a mailbox with the given name.
+            // If there is a local match we fall through using the retrieved index, and we don't
+            // bother to push the message out onto the network, since names are globally unique.
+            if (!endPoint->Lookup(name, index))
+            {
+                // The name may be published through another endpoint of this
+                // process; the process-wide registry resolves it to its local
+                // mailbox so delivery is direct, with no serialization.
+                if (!ProcessNameRegistry::Get(name, index))
+                {
+                    // If there isn't a local match we send the message out onto the network.
+                    return endPoint->RequestSend(message, name);
+                }
+            }
+
+            if (nameCache)
+            {
+                nameCache->Store(name, nameVersion, index);
+            }
         }
     }
 
+#endif // THERON_NO_NETWORK
+
     // Which framework is the addressed entity in?
     const uint32_t targetFrameworkIndex(index.mComponents.mFramework);
     if (targetFrameworkIndex == localFrameworkIndex)
@@ -60,55 +124,285 @@ bool MessageSender::Send(
         // Get a reference to the destination mailbox.
         Mailbox &mailbox(processorContext->mMailboxes->GetEntry(index.mComponents.mIndex));
 
-        // Push the message into the mailbox and schedule the mailbox for processing
-        // if it was previously empty, so won't already be scheduled.
-        // The message will be destroyed by the worker thread that does the processing,
-        // even if it turns out that no actor is registered with the mailbox.
-        mailbox.Lock();
+        return SendToMailbox(processorContext, &mailbox, address, message, localQueue, tailCall);
+    }
+
+    // Message is addressed to a mailbox in the local process but not in the
+    // sending Framework. In this less common case we pay the hit of an extra call.
+    if (DeliverWithinLocalProcess(message, index, processorContext))
+    {
+        return true;
+    }
+
+    // Destroy the undelivered message.
+    processorContext->mFallbackHandlers->Handle(message);
+    Detail::MessageCreator::Destroy(&processorContext->mMessageCache, message);
+
+    return false;
+}
 
-        const bool schedule(mailbox.Empty());
-        mailbox.Push(message);
 
-        if (schedule)
+bool MessageSender::SendToMailbox(
+    Processor::Context *const processorContext,
+    Mailbox *const mailboxPointer,
+    const Address &address,
+    IMessage *const message,
+    const bool localQueue,
+    const bool tailCall)
+{
+    Mailbox &mailbox(*mailboxPointer);
+
+    // If the mailbox has a bounded capacity and is currently full, reject the
+    // message so that the sender can shed load or throttle, instead of letting
+    // a slow consumer's queue grow without limit. Rejected messages are offered
+    // to the fallback handlers like other undelivered messages.
+    if (mailbox.Full())
+    {
+        processorContext->mFallbackHandlers->Handle(message);
+        Detail::MessageCreator::Destroy(&processorContext->mMessageCache, message);
+
+        return false;
+    }
+
+    // Worker threads have stable per-thread contexts, so identify them as
+    // producers to the mailbox, which detects repeat sender/receiver pairs
+    // and routes their traffic through a dedicated channel ring. The shared
+    // per-framework context is used by many application threads at once, so
+    // provides no stable producer identity.
+    void *const producer(processorContext->mLocalWorkQueue ? processorContext : 0);
+
+#if THERON_ENABLE_TRACING
+    processorContext->mTraceBuffer.Record(
+        TraceBuffer::EVENT_MESSAGE_PUSH,
+        address.GetName().GetHash(),
+        message->GetFlowId());
+#endif // THERON_ENABLE_TRACING
+
+    // Push the message into the mailbox and schedule the mailbox for processing
+    // if it was previously empty, so won't already be scheduled.
+    // The push is lock-free and tells us whether we're responsible for scheduling.
+    // The message will be destroyed by the worker thread that does the processing,
+    // even if it turns out that no actor is registered with the mailbox.
+    if (mailbox.Push(message, producer))
+    {
+        // For tail sends, the mailbox was idle and the push made us responsible
+        // for its scheduling, so we're free to process it inline on this thread,
+        // collapsing the queue round-trip that pipelined actors otherwise pay per hop.
+        if (tailCall)
+        {
+            Processor::TailSchedule(processorContext, &mailbox, localQueue);
+        }
+        else
         {
-            // Push the receiving mailbox onto either the shared or local work queue.
+            // Push the receiving mailbox onto either the local or shared work queue.
             // If the current context isn't a per-thread context then it may not have a local queue.
-            if (localQueue && processorContext->mLocalWorkQueue)
-            {
-                // The local queue in a per-thread context is only accessed by that thread
-                // so we don't need to protect access to it.
-                processorContext->mLocalWorkQueue->Push(&mailbox);
-            }
-            else
+            Processor::Schedule(processorContext, &mailbox, localQueue);
+        }
+    }
+
+    // If the push took the queue depth up through the high watermark then
+    // deliver a watermark event to the actor through its own mailbox, so
+    // backpressure decisions are event-driven rather than polled.
+    if (mailbox.RoseAboveWatermark())
+    {
+        QueueWatermarkEvent event;
+        event.mDepth = mailbox.Count();
+        event.mHigh = true;
+
+        IMessage *const eventMessage(MessageCreator::Create(
+            &processorContext->mMessageCache,
+            event,
+            address));
+
+        if (eventMessage && mailbox.Push(eventMessage))
+        {
+            Processor::Schedule(processorContext, &mailbox, localQueue);
+        }
+    }
+
+    return true;
+}
+
+
+uint32_t MessageSender::SendBatch(
+    EndPoint *const endPoint,
+    Processor::Context *const processorContext,
+    const uint32_t localFrameworkIndex,
+    IMessage *const *const messages,
+    const Address *const addresses,
+    const uint32_t count)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Scratch space for the sorted delivery order: two arrays of message
+    // indices, ping-ponged between by the merge passes.
+    IAllocator *const allocator(&processorContext->mMessageCache);
+    const uint32_t scratchSize(2 * count * sizeof(uint32_t));
+
+    uint32_t *order(reinterpret_cast<uint32_t *>(allocator->Allocate(scratchSize)));
+    if (order == 0)
+    {
+        // Degrade to ungrouped per-message sends rather than failing the batch.
+        uint32_t numSent(0);
+        for (uint32_t current = 0; current < count; ++current)
+        {
+            if (Send(endPoint, processorContext, localFrameworkIndex, messages[current], addresses[current]))
             {
-                // Because the shared work queue is accessed by multiple threads we have to protect it.
-                processorContext->mSharedWorkQueueSpinLock->Lock();
-                processorContext->mSharedWorkQueue->Push(&mailbox);
-                processorContext->mSharedWorkQueueSpinLock->Unlock();
+                ++numSent;
             }
         }
 
-        mailbox.Unlock();
+        return numSent;
+    }
 
-        return true;
+    void *const scratchMemory(order);
+    uint32_t *scratch(order + count);
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        order[index] = index;
     }
 
-    // Message is addressed to a mailbox in the local process but not in the
-    // sending Framework. In this less common case we pay the hit of an extra call.
-    if (DeliverWithinLocalProcess(message, index))
+    // Bottom-up merge sort of the delivery order by destination mailbox index.
+    // The sort is stable, preserving the batch order of messages that share a
+    // destination, which is what guarantees per-destination FIFO delivery.
+    for (uint32_t width = 1; width < count; width += width)
     {
-        return true;
+        for (uint32_t left = 0; left < count; left += width + width)
+        {
+            const uint32_t middle(left + width < count ? left + width : count);
+            const uint32_t right(left + width + width < count ? left + width + width : count);
+
+            uint32_t readLow(left);
+            uint32_t readHigh(middle);
+            uint32_t write(left);
+
+            while (readLow < middle && readHigh < right)
+            {
+                if (addresses[order[readHigh]].mIndex.mUInt32 < addresses[order[readLow]].mIndex.mUInt32)
+                {
+                    scratch[write++] = order[readHigh++];
+                }
+                else
+                {
+                    scratch[write++] = order[readLow++];
+                }
+            }
+
+            while (readLow < middle)
+            {
+                scratch[write++] = order[readLow++];
+            }
+
+            while (readHigh < right)
+            {
+                scratch[write++] = order[readHigh++];
+            }
+        }
+
+        uint32_t *const swap(order);
+        order = scratch;
+        scratch = swap;
     }
 
-    // Destroy the undelivered message.
-    processorContext->mFallbackHandlers->Handle(message);
-    Detail::MessageCreator::Destroy(&processorContext->mMessageCache, message);
+    // Deliver the batch one destination group at a time.
+    uint32_t numSent(0);
+    uint32_t groupStart(0);
 
-    return false;
+    while (groupStart < count)
+    {
+        // Find the end of the group of messages sharing this destination.
+        const uint32_t key(addresses[order[groupStart]].mIndex.mUInt32);
+
+        uint32_t groupEnd(groupStart + 1);
+        while (groupEnd < count && addresses[order[groupEnd]].mIndex.mUInt32 == key)
+        {
+            ++groupEnd;
+        }
+
+        Index index;
+        index.mUInt32 = key;
+
+        if (key != 0 && index.mComponents.mFramework == localFrameworkIndex)
+        {
+            // Direct path to a mailbox in the sending framework: resolve the
+            // mailbox once for the whole group. Typically only the first push
+            // finds it unscheduled, so the group costs one scheduling event.
+            Mailbox &mailbox(processorContext->mMailboxes->GetEntry(index.mComponents.mIndex));
+
+            // Worker threads have stable per-thread contexts, so identify them
+            // as producers to the mailbox, as the per-message send path does.
+            void *const producer(processorContext->mLocalWorkQueue ? processorContext : 0);
+
+            for (uint32_t current = groupStart; current < groupEnd; ++current)
+            {
+                IMessage *const message(messages[order[current]]);
+
+                // Messages rejected by a full bounded mailbox are offered to
+                // the fallback handlers and destroyed, as for ordinary sends.
+                if (mailbox.Full())
+                {
+                    processorContext->mFallbackHandlers->Handle(message);
+                    MessageCreator::Destroy(&processorContext->mMessageCache, message);
+                    continue;
+                }
+
+                if (mailbox.Push(message, producer))
+                {
+                    Processor::Schedule(processorContext, &mailbox, false);
+                }
+
+                ++numSent;
+            }
+
+            // If the group took the queue depth up through the high watermark
+            // then deliver a single watermark event for the group, as the send
+            // path does per message.
+            if (mailbox.RoseAboveWatermark())
+            {
+                QueueWatermarkEvent event;
+                event.mDepth = mailbox.Count();
+                event.mHigh = true;
+
+                IMessage *const eventMessage(MessageCreator::Create(
+                    &processorContext->mMessageCache,
+                    event,
+                    addresses[order[groupStart]]));
+
+                if (eventMessage && mailbox.Push(eventMessage))
+                {
+                    Processor::Schedule(processorContext, &mailbox, false);
+                }
+            }
+        }
+        else
+        {
+            // Name-only addresses, receivers and mailboxes in other local
+            // frameworks take the generic per-message machinery.
+            for (uint32_t current = groupStart; current < groupEnd; ++current)
+            {
+                if (Send(endPoint, processorContext, localFrameworkIndex, messages[order[current]], addresses[order[current]]))
+                {
+                    ++numSent;
+                }
+            }
+        }
+
+        groupStart = groupEnd;
+    }
+
+    allocator->Free(scratchMemory, scratchSize);
+    return numSent;
 }
 
 
-bool MessageSender::DeliverWithinLocalProcess(IMessage *const message, const Index &index)
+bool MessageSender::DeliverWithinLocalProcess(
+    IMessage *const message,
+    const Index &index,
+    Processor::Context *const processorContext)
 {
     const uint32_t targetFrameworkIndex(index.mComponents.mFramework);
 
@@ -142,6 +436,44 @@ bool MessageSender::DeliverWithinLocalProcess(IMessage *const message, const Ind
 
     bool delivered(false);
 
+    // Worker threads own their contexts, so can cache resolved framework
+    // lookups without synchronization, as the name-resolution path does. The
+    // shared per-framework context is used by many application threads at
+    // once, so gets no cache.
+    FrameworkCache *const cache(
+        processorContext && processorContext->mLocalWorkQueue ? &processorContext->mFrameworkCache : 0);
+
+    if (cache)
+    {
+        // Fast path: deliver through a cached framework pointer, skipping the
+        // directory entry locks. A read guard taken against the directory
+        // blocks deregistrations from completing, and the generation check
+        // made inside the guard proves no framework has deregistered since
+        // the pointer was cached, so the pointer is safe to call through
+        // until the guard is released.
+        StaticDirectory<Framework>::BeginRead();
+
+        const uint32_t generation(StaticDirectory<Framework>::GetGeneration());
+        Framework *const cached(cache->Get(targetFrameworkIndex, generation));
+
+        if (cached)
+        {
+            // The address is just an index with no name.
+            const Address address(String(), index);
+            delivered = cached->FrameworkReceive(message, address);
+
+            StaticDirectory<Framework>::EndRead();
+            return delivered;
+        }
+
+        StaticDirectory<Framework>::EndRead();
+    }
+
+    // Read the generation before resolving, so the cached record is stamped
+    // conservatively: if the generation is unchanged at some later read, no
+    // framework can have deregistered since this resolution.
+    const uint32_t generation(StaticDirectory<Framework>::GetGeneration());
+
     // TODO: Return a pointer so we can handle missing pages gracefully.
     // Get the entry for the addressed framework.
     Entry &entry(StaticDirectory<Framework>::GetEntry(index.mComponents.mFramework));
@@ -158,6 +490,11 @@ bool MessageSender::DeliverWithinLocalProcess(IMessage *const message, const Ind
         // The address is just an index with no name.
         const Address address(String(), index);
         delivered = framework->FrameworkReceive(message, address);
+
+        if (cache)
+        {
+            cache->Store(targetFrameworkIndex, generation, framework);
+        }
     }
 
     // Unpin the entry, allowing it to be changed by other threads.
@@ -169,6 +506,46 @@ bool MessageSender::DeliverWithinLocalProcess(IMessage *const message, const Ind
 }
 
 
+String MessageSender::ResolveName(const Index &index)
+{
+    THERON_ASSERT(index.mUInt32 != 0);
+
+    String name;
+
+    // Receiver addresses have zero framework indices.
+    if (index.mComponents.mFramework == 0)
+    {
+        // Pin the receiver directory entry while reading the name, so the
+        // receiver can't be destructed under the read.
+        Entry &entry(StaticDirectory<Receiver>::GetEntry(index.mComponents.mIndex));
+
+        entry.Lock();
+        Receiver *const receiver(static_cast<Receiver *>(entry.GetEntity()));
+        if (receiver)
+        {
+            name = receiver->GetAddress().GetName();
+        }
+        entry.Unlock();
+
+        return name;
+    }
+
+    // Pin the framework directory entry while reading the mailbox name, so
+    // the framework can't be destructed under the read.
+    Entry &entry(StaticDirectory<Framework>::GetEntry(index.mComponents.mFramework));
+
+    entry.Lock();
+    Framework *const framework(static_cast<Framework *>(entry.GetEntity()));
+    if (framework)
+    {
+        name = framework->mMailboxes.GetEntry(index.mComponents.mIndex).GetName();
+    }
+    entry.Unlock();
+
+    return name;
+}
+
+
 } // namespace Detail
 } // namespace Theron
 
@@ -0,0 +1,140 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Network/ProcessNameRegistry.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+Atomic::Pointer ProcessNameRegistry::smNameMap;
+SpinLock ProcessNameRegistry::smSpinLock;
+Atomic::UInt32 ProcessNameRegistry::smReferenceCount;
+
+
+bool ProcessNameRegistry::Reference()
+{
+    // Fast path: while references exist the registry can't be destroyed, so
+    // raising a non-zero count with a compare-and-swap safely pins it alive
+    // without taking the lock.
+    uint32_t currentCount(smReferenceCount.Load());
+    while (currentCount != 0)
+    {
+        if (smReferenceCount.CompareExchangeAcquire(currentCount, currentCount + 1))
+        {
+            return true;
+        }
+    }
+
+    // Slow path: no references existed, so the registry may need to be
+    // created -- or may be being destroyed by the releaser of the last
+    // reference. The lock serializes us against both.
+    smSpinLock.Lock();
+
+    if (smNameMap.Load() == 0)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        void *const memory(allocator->AllocateAligned(sizeof(NameMap), THERON_CACHELINE_ALIGNMENT));
+
+        if (memory == 0)
+        {
+            smSpinLock.Unlock();
+            return false;
+        }
+
+        smNameMap.Store(new (memory) NameMap());
+    }
+
+    // The increment is made under the lock so a concurrent releaser of the
+    // last reference can't see a zero count once we've committed.
+    smReferenceCount.Increment();
+
+    smSpinLock.Unlock();
+
+    return true;
+}
+
+
+void ProcessNameRegistry::Release()
+{
+    // Destroy the map if this was the last reference. The re-check under the
+    // lock closes the race with a referencing thread that took the slow path
+    // and re-referenced the map after our decrement.
+    if (smReferenceCount.FetchDecrement() == 1)
+    {
+        smSpinLock.Lock();
+
+        if (smReferenceCount.Load() == 0 && smNameMap.Load() != 0)
+        {
+            IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+
+            NameMap *const nameMap(reinterpret_cast<NameMap *>(smNameMap.Load()));
+            smNameMap.Store(0);
+
+            nameMap->~NameMap();
+            allocator->Free(nameMap, sizeof(NameMap));
+        }
+
+        smSpinLock.Unlock();
+    }
+}
+
+
+bool ProcessNameRegistry::Insert(const String &name, const Index &index)
+{
+    NameMap *const nameMap(reinterpret_cast<NameMap *>(smNameMap.Load()));
+
+    THERON_ASSERT_MSG(nameMap, "Process name registry used without a reference");
+    return nameMap->Insert(name, index);
+}
+
+
+bool ProcessNameRegistry::Remove(const String &name)
+{
+    NameMap *const nameMap(reinterpret_cast<NameMap *>(smNameMap.Load()));
+
+    THERON_ASSERT_MSG(nameMap, "Process name registry used without a reference");
+    return nameMap->Remove(name);
+}
+
+
+bool ProcessNameRegistry::Get(const String &name, Index &index)
+{
+    NameMap *const nameMap(reinterpret_cast<NameMap *>(smNameMap.Load()));
+
+    if (nameMap == 0)
+    {
+        return false;
+    }
+
+    return nameMap->Get(name, index);
+}
+
+
+uint32_t ProcessNameRegistry::GetVersion()
+{
+    NameMap *const nameMap(reinterpret_cast<NameMap *>(smNameMap.Load()));
+
+    if (nameMap == 0)
+    {
+        return 0;
+    }
+
+    return nameMap->GetVersion();
+}
+
+
+} // namespace Detail
+} // namespace Theron
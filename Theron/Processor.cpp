@@ -1,188 +1,479 @@
-// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
-
-
-#include <Theron/Actor.h>
-#include <Theron/Assert.h>
-#include <Theron/Counters.h>
-#include <Theron/Defines.h>
-
-#include <Theron/Detail/Directory/Directory.h>
-#include <Theron/Detail/Directory/Entry.h>
-#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
-#include <Theron/Detail/Mailboxes/Mailbox.h>
-#include <Theron/Detail/MailboxProcessor/Processor.h>
-#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
-#include <Theron/Detail/Messages/IMessage.h>
-#include <Theron/Detail/Messages/MessageCreator.h>
-#include <Theron/Detail/Threading/Utils.h>
-
-
-namespace Theron
-{
-namespace Detail
-{
-
-
-void Processor::ProcessMailbox(Context *const context, Mailbox *const mailbox)
-{
-    // Load the context data from the worker thread's processor context.
-    // Actors that need more processing are always pushed onto the worker thread's local queue.
-    WorkQueue *const workQueue(context->mLocalWorkQueue);
-    FallbackHandlerCollection *const fallbackHandlers(context->mFallbackHandlers);
-    IAllocator *const messageAllocator(&context->mMessageCache);
-
-    THERON_ASSERT(workQueue);
-    THERON_ASSERT(fallbackHandlers);
-    THERON_ASSERT(messageAllocator);
-
-    // Increment the context's message processing event counter.
-    context->mCounters[Theron::COUNTER_MESSAGES_PROCESSED].Increment();
-
-    // Pin the mailbox and get the registered actor and the first queued message.
-    // At this point the mailbox shouldn't be enqueued in any other work items,
-    // even if it contains more than one unprocessed message. This ensures that
-    // each mailbox is only processed by one worker thread at a time.
-    mailbox->Lock();
-    mailbox->Pin();
-    Actor *const actor(mailbox->GetActor());
-    IMessage *const message(mailbox->Front());
-    mailbox->Unlock();
-
-    // If an entity is registered at the mailbox then process it.
-    if (actor)
-    {
-        // Store a pointer to the context data for this thread in the actor.
-        // We'll need it to send messages if any of the registered handlers
-        // call Actor::Send, but we can't pass it through from here because
-        // the handlers are user code.
-        THERON_ASSERT(actor->mProcessorContext == 0);
-        actor->mProcessorContext = context;
-
-        actor->ProcessMessage(fallbackHandlers, message);
-
-        // Zero the context pointer, in case it's next accessed by a non-worker thread.
-        THERON_ASSERT(actor->mProcessorContext == context);
-        actor->mProcessorContext = 0;
-    }
-
-    // Unpin the mailbox, allowing the registered actor to be changed by other threads.
-    mailbox->Lock();
-    mailbox->Unpin();
-    mailbox->Unlock();
-
-    if (actor == 0 && fallbackHandlers)
-    {
-        fallbackHandlers->Handle(message);
-    }
-
-    // Pop the message we just processed from the mailbox, then check whether the
-    // mailbox is now empty, and reschedule the mailbox if it's not.
-    // The locking of the mailbox here and in the main scheduling ensures that
-    // mailboxes are always enqueued if they unprocessed messages, but at most once
-    // at any time.
-    mailbox->Lock();
-
-    mailbox->Pop();
-    if (!mailbox->Empty())
-    {
-        workQueue->Push(mailbox);
-    }
-
-    mailbox->Unlock();
-
-    // Destroy the message, but only after we've popped it from the queue.
-    MessageCreator::Destroy(messageAllocator, message);
-}
-
-
-void Processor::YieldPolite(uint32_t &counter)
-{
-    // This yield strategy scales from a simple 'nop' to putting the calling thread to sleep.
-    // This implementation is based roughly on http://www.1024cores.net/home/lock-free-algorithms/tricks/spinning
-    if (++counter < 10)
-    {
-        Utils::YieldToHyperthread();
-    }
-    else if (counter < 20)
-    {
-        for (uint32_t i = 0; i < 50; ++i)
-        {
-            Utils::YieldToHyperthread();
-        }
-    }
-    else if (counter < 22)
-    {
-        Utils::YieldToLocalThread();
-    }
-    else if (counter < 24)
-    {
-        Utils::YieldToAnyThread();
-    }
-    else
-    {
-        Utils::SleepThread(1UL);
-    }
-}
-
-
-void Processor::YieldStrong(uint32_t &counter)
-{
-    // This 'strong' implementation yields after spinning for a while, but never sleeps.
-    if (++counter < 10)
-    {
-        Utils::YieldToHyperthread();
-    }
-    else if (counter < 20)
-    {
-        for (uint32_t i = 0; i < 50; ++i)
-        {
-            Utils::YieldToHyperthread();
-        }
-    }
-    else if (counter < 22)
-    {
-        Utils::YieldToLocalThread();
-    }
-    else
-    {
-        Utils::YieldToAnyThread();
-    }
-}
-
-
-void Processor::YieldAggressive(uint32_t &counter)
-{
-    // This 'aggressive' implementation never yields or sleeps.
-    // It does however pause to allow another thread running on the same hyperthreaded core to proceed.
-    if (++counter < 10)
-    {
-        Utils::YieldToHyperthread();
-    }
-    else if (counter < 20)
-    {
-        for (uint32_t i = 0; i < 50; ++i)
-        {
-            Utils::YieldToHyperthread();
-        }
-    }
-    else if (counter < 22)
-    {
-        for (uint32_t i = 0; i < 100; ++i)
-        {
-            Utils::YieldToHyperthread();
-        }
-    }
-    else
-    {
-        for (uint32_t i = 0; i < 200; ++i)
-        {
-            Utils::YieldToHyperthread();
-        }
-    }
-}
-
-
-} // namespace Detail
-} // namespace Theron
-
-
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Actor.h>
+#include <Theron/Assert.h>
+#include <Theron/Counters.h>
+#include <Theron/Defines.h>
+#include <Theron/QueueWatermarkEvent.h>
+
+#include <Theron/Detail/Directory/Directory.h>
+#include <Theron/Detail/Directory/Entry.h>
+#include <Theron/Detail/Handlers/FallbackHandlerCollection.h>
+#include <Theron/Detail/Mailboxes/Mailbox.h>
+#include <Theron/Detail/MailboxProcessor/Processor.h>
+#include <Theron/Detail/MailboxProcessor/WorkQueue.h>
+#include <Theron/Detail/Messages/IMessage.h>
+#include <Theron/Detail/Messages/MessageCreator.h>
+#include <Theron/Detail/Messages/MessageSender.h>
+#include <Theron/Detail/Network/Index.h>
+#include <Theron/Detail/Profiling/ProfileClock.h>
+#include <Theron/Detail/Threading/Utils.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+void Processor::ProcessMailbox(Context *const context, Mailbox *const mailbox)
+{
+    // Load the context data from the worker thread's processor context.
+    FallbackHandlerCollection *const fallbackHandlers(context->mFallbackHandlers);
+
+    // Processed message blocks are freed through the deferred free list, which
+    // accumulates them and returns them to the message cache in batches,
+    // amortizing the cache bookkeeping over the batch. The message value is
+    // still destructed promptly; only the return of the memory is deferred.
+    IAllocator *const messageAllocator(&context->mDeferredFrees);
+
+    THERON_ASSERT(fallbackHandlers);
+    THERON_ASSERT(messageAllocator);
+
+    // Pin the mailbox and get the registered actor.
+    // At this point the mailbox shouldn't be enqueued in any other work items,
+    // even if it contains more than one unprocessed message. This ensures that
+    // each mailbox is only processed by one worker thread at a time.
+    mailbox->Lock();
+    mailbox->Pin();
+    Actor *const actor(mailbox->GetActor());
+    mailbox->Unlock();
+
+    if (actor)
+    {
+        // Store a pointer to the context data for this thread in the actor.
+        // We'll need it to send messages if any of the registered handlers
+        // call Actor::Send, but we can't pass it through from here because
+        // the handlers are user code.
+        THERON_ASSERT(actor->mProcessorContext == 0);
+        actor->mProcessorContext = context;
+    }
+
+    // Drain up to a batch of messages from the mailbox in this one scheduling
+    // event, amortizing the work queue traffic and mailbox lookups across the
+    // batch. The batch size is configured per-framework and defaults to one.
+    uint32_t batchRemaining(context->mMessageBatchSize);
+    bool moreMessages(false);
+
+    THERON_ASSERT(batchRemaining > 0);
+
+    // With a processing budget configured, stamp the deadline of this
+    // scheduling event into the context, where handlers can poll it through
+    // Actor::YieldIfOverBudget and the batch loop checks it between messages.
+    const uint32_t budget(context->mHandlerBudgetMicroseconds);
+    context->mBudgetDeadline = budget ? ProfileClock::GetMicroseconds() + budget : 0;
+
+#if THERON_ENABLE_TRACING
+    // Mailboxes are identified in traces by the hash of their name, matching
+    // the identification used when the message was pushed and scheduled.
+    const uint32_t traceMailbox(mailbox->GetName().GetHash());
+#endif // THERON_ENABLE_TRACING
+
+    do
+    {
+        // Pop the next queued message. The scheduling contract guarantees that a
+        // message was pushed, but the producer that pushed it may not have finished
+        // linking it into the lock-free queue yet, so we may have to wait briefly.
+        IMessage *message(mailbox->Pop());
+
+        uint32_t backoff(0);
+        while (message == 0)
+        {
+            Utils::Backoff(backoff);
+            message = mailbox->Pop();
+        }
+
+        // Increment the context's message processing event counter.
+        context->mCounters[Theron::COUNTER_MESSAGES_PROCESSED].Increment();
+
+        // Count messages reaching processing only after their deadline passed.
+        const uint64_t deadline(message->GetDeadline());
+        if (deadline != 0 && ProfileClock::GetMicroseconds() > deadline)
+        {
+            context->mCounters[Theron::COUNTER_DEADLINE_MISSES].Increment();
+        }
+
+#if THERON_ENABLE_MESSAGE_STATS
+        // Count the message against its registered type in this worker's table.
+        {
+            const uint32_t typeId(message->GetTypeId());
+            const uint32_t slot(typeId < MessageTypeStats::MAX_TYPES ? typeId : 0);
+            MessageTypeStats::TypeStats &stats(context->mMessageStats.mTypes[slot]);
+
+            if (slot)
+            {
+                stats.mTypeName = message->TypeName();
+            }
+
+            ++stats.mProcessedCount;
+            stats.mProcessedBytes += message->GetMessageSize();
+        }
+#endif // THERON_ENABLE_MESSAGE_STATS
+
+#if THERON_ENABLE_MEMORY_ACCOUNTING
+        // Remove the message from the mailbox's queued-memory tally up front;
+        // a forwarded message is owned by its new mailbox once handed off, so
+        // its block size can't safely be read afterwards.
+        mailbox->SubtractQueuedBytes(message->GetBlockSize());
+#endif // THERON_ENABLE_MEMORY_ACCOUNTING
+
+        bool forwarded(false);
+        bool stashed(false);
+
+        if (actor)
+        {
+#if THERON_ENABLE_TRACING
+            // Read the flow ID up front; the message isn't safely readable
+            // once its handlers have run.
+            const uint64_t traceFlow(message->GetFlowId());
+            context->mTraceBuffer.Record(TraceBuffer::EVENT_HANDLER_BEGIN, traceMailbox, traceFlow);
+#endif // THERON_ENABLE_TRACING
+
+            actor->ProcessMessage(fallbackHandlers, message);
+
+            // A handler may have stashed the message for deferred re-delivery,
+            // in which case it now lives on the mailbox's stash list.
+            stashed = actor->mCurrentMessageStashed;
+
+#if THERON_ENABLE_TRACING
+            context->mTraceBuffer.Record(TraceBuffer::EVENT_HANDLER_END, traceMailbox, traceFlow);
+#endif // THERON_ENABLE_TRACING
+
+            // Release any scratch memory the handlers allocated while
+            // processing the message; its lifetime ends with the handler.
+            context->mScratchAllocator.Reset();
+        }
+        else
+        {
+            // If the registered actor migrated away it left a forwarding
+            // address, so re-route the message to its new mailbox.
+            const uint32_t forwardIndex(mailbox->GetForward());
+            if (forwardIndex)
+            {
+                Index index;
+                index.mUInt32 = forwardIndex;
+                forwarded = MessageSender::DeliverWithinLocalProcess(message, index, context);
+            }
+
+            if (!forwarded && fallbackHandlers)
+            {
+                fallbackHandlers->Handle(message);
+            }
+        }
+
+        // Release the message we just processed, remembering whether the
+        // mailbox still contains unprocessed messages.
+        moreMessages = mailbox->ReleaseMessage();
+
+        // Destroy the message, but only after we've released it, unless it
+        // was forwarded and is now owned by the mailbox it was delivered to,
+        // or stashed and is now held on the mailbox's stash list.
+        if (!forwarded && !stashed)
+        {
+            MessageCreator::Destroy(messageAllocator, message);
+        }
+
+        // If the budget for this scheduling event has been exceeded, cut the
+        // batch short; the remaining messages stay queued and the mailbox is
+        // re-queued below, so the worker returns to the pool for other work.
+        if (context->mBudgetDeadline != 0 && ProfileClock::GetMicroseconds() > context->mBudgetDeadline)
+        {
+            break;
+        }
+
+    } while (moreMessages && --batchRemaining);
+
+    // Destroy any queued conflatable messages that were displaced in place by
+    // newer versions from the same sender since the last processing event.
+    mailbox->DestroyStaleMessages(messageAllocator);
+
+    if (actor)
+    {
+        // Zero the context pointer, in case it's next accessed by a non-worker thread.
+        THERON_ASSERT(actor->mProcessorContext == context);
+        actor->mProcessorContext = 0;
+    }
+
+    // Unpin the mailbox, allowing the registered actor to be changed by other threads.
+    mailbox->Lock();
+    mailbox->Unpin();
+    mailbox->Unlock();
+
+    // If the drain took the queue depth back down to the low watermark then
+    // deliver a watermark event to the actor through its own mailbox, telling
+    // it the congestion reported by the matching high event has cleared.
+    if (actor && mailbox->FellBelowWatermark())
+    {
+        QueueWatermarkEvent event;
+        event.mDepth = mailbox->Count();
+        event.mHigh = false;
+
+        IMessage *const eventMessage(MessageCreator::Create(
+            &context->mMessageCache,
+            event,
+            actor->GetAddress()));
+
+        if (eventMessage && mailbox->Push(eventMessage))
+        {
+            Schedule(context, mailbox, true);
+        }
+    }
+
+    // If the batch limit cut the drain short then reschedule the mailbox.
+    // The atomic message count ensures that mailboxes are always enqueued if
+    // they contain unprocessed messages, but at most once at any time.
+    if (moreMessages)
+    {
+        // The mailbox has consumed its processing credit for this scheduling
+        // round but still holds messages. If other work is waiting, requeue it
+        // at the back of the shared FIFO queue instead of this worker's LIFO
+        // local queue, where it would be popped again immediately: a flooding
+        // mailbox takes its place behind the other waiting mailboxes each
+        // round, so a burst into one actor can't starve the others.
+        if (context->mLocalQueue.Empty() && context->mSharedWorkQueue->Empty())
+        {
+            // Nothing else is waiting, so fairness doesn't arise; keep the
+            // mailbox local for scheduling throughput and cache locality.
+            Schedule(context, mailbox, true);
+        }
+        else
+        {
+            context->mCounters[Theron::COUNTER_FAIRNESS_YIELDS].Increment();
+            Schedule(context, mailbox, false);
+        }
+    }
+}
+
+
+void Processor::YieldBlocking(Context *const context, uint32_t &counter)
+{
+    // Spin briefly first, like the other strategies, giving near-spin latency
+    // when more work arrives promptly.
+    if (++counter < 10)
+    {
+        Utils::YieldToHyperthread();
+        return;
+    }
+
+    if (counter < 20)
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+
+        return;
+    }
+
+    if (counter < 22)
+    {
+        Utils::YieldToLocalThread();
+        return;
+    }
+
+    // Block on the shared condition until a producer schedules a mailbox and wakes us.
+    Condition *const condition(context->mWorkerCondition);
+    Atomic::UInt32 *const numSleepingWorkers(context->mNumSleepingWorkers);
+
+    // During a runtime strategy switch the yield function can be swapped
+    // before the condition pointers become visible to this thread; sleep
+    // briefly instead until they do.
+    if (condition == 0 || numSleepingWorkers == 0)
+    {
+        Utils::SleepThread(1UL);
+        return;
+    }
+
+    condition->Lock();
+    numSleepingWorkers->Increment();
+
+    // Re-check for work after advertising ourselves as sleeping. A producer that
+    // pushed work and read the sleeper count before we incremented it won't pulse
+    // the condition, but in that case the pushed work is visible to us here.
+    if (context->mLocalQueue.Empty() &&
+        context->mSharedWorkQueue->Empty() &&
+        context->mSharedHighPriorityWorkQueue->Empty() &&
+        context->mSharedDeadlineWorkQueue->Empty())
+    {
+        // The wait is bounded so that a missed shutdown pulse delays a worker
+        // briefly rather than blocking it forever.
+        context->mCounters[Theron::COUNTER_SLEEP_TRANSITIONS].Increment();
+
+#if THERON_ENABLE_TRACING
+        context->mTraceBuffer.Record(TraceBuffer::EVENT_THREAD_SLEEP, 0);
+#endif // THERON_ENABLE_TRACING
+
+        condition->Wait(WAIT_TIMEOUT_MILLISECONDS);
+
+#if THERON_ENABLE_TRACING
+        context->mTraceBuffer.Record(TraceBuffer::EVENT_THREAD_WAKE, 0);
+#endif // THERON_ENABLE_TRACING
+    }
+
+    numSleepingWorkers->Decrement();
+    condition->Unlock();
+}
+
+
+void Processor::YieldPolite(Context *const /*context*/, uint32_t &counter)
+{
+    // This yield strategy scales from a simple 'nop' to putting the calling thread to sleep.
+    // This implementation is based roughly on http://www.1024cores.net/home/lock-free-algorithms/tricks/spinning
+    if (++counter < 10)
+    {
+        Utils::YieldToHyperthread();
+    }
+    else if (counter < 20)
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+    else if (counter < 22)
+    {
+        Utils::YieldToLocalThread();
+    }
+    else if (counter < 24)
+    {
+        Utils::YieldToAnyThread();
+    }
+    else
+    {
+        Utils::SleepThread(1UL);
+    }
+}
+
+
+void Processor::YieldStrong(Context *const /*context*/, uint32_t &counter)
+{
+    // This 'strong' implementation yields after spinning for a while, but never sleeps.
+    if (++counter < 10)
+    {
+        Utils::YieldToHyperthread();
+    }
+    else if (counter < 20)
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+    else if (counter < 22)
+    {
+        Utils::YieldToLocalThread();
+    }
+    else
+    {
+        Utils::YieldToAnyThread();
+    }
+}
+
+
+void Processor::YieldAggressive(Context *const /*context*/, uint32_t &counter)
+{
+    // This 'aggressive' implementation never yields or sleeps.
+    // It does however pause to allow another thread running on the same hyperthreaded core to proceed.
+    if (++counter < 10)
+    {
+        Utils::YieldToHyperthread();
+    }
+    else if (counter < 20)
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+    else if (counter < 22)
+    {
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < 200; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+}
+
+
+void Processor::YieldAdaptive(Context *const context, uint32_t &counter)
+{
+    // Self-tuning variant of the polite strategy: the length of the spin phase
+    // before the thread starts yielding and sleeping is a per-thread budget,
+    // tuned continuously to the work arrival rate the thread observes.
+    ++counter;
+
+    // On entering a new idle episode, retune the budget from what happened
+    // since the last one. If this thread processed messages in between, work
+    // is arriving and a longer spin phase avoids the wake-up latency of
+    // sleeping; if not, the thread is in a quiet phase and the budget decays
+    // so it reaches sleep sooner.
+    if (counter == 1)
+    {
+        const uint32_t processedCount(context->mCounters[Theron::COUNTER_MESSAGES_PROCESSED].Load());
+        const uint32_t spinLimit(context->mYieldSpinLimit);
+
+        if (processedCount != context->mYieldLastProcessedCount)
+        {
+            context->mYieldLastProcessedCount = processedCount;
+
+            if (spinLimit * 2 <= ADAPTIVE_SPIN_LIMIT_MAX)
+            {
+                context->mYieldSpinLimit = spinLimit * 2;
+            }
+        }
+        else if (spinLimit / 2 >= ADAPTIVE_SPIN_LIMIT_MIN)
+        {
+            context->mYieldSpinLimit = spinLimit / 2;
+        }
+    }
+
+    const uint32_t spinLimit(context->mYieldSpinLimit);
+
+    if (counter < spinLimit)
+    {
+        Utils::YieldToHyperthread();
+    }
+    else if (counter < spinLimit * 2)
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            Utils::YieldToHyperthread();
+        }
+    }
+    else if (counter < spinLimit * 2 + 2)
+    {
+        Utils::YieldToLocalThread();
+    }
+    else if (counter < spinLimit * 2 + 4)
+    {
+        Utils::YieldToAnyThread();
+    }
+    else
+    {
+        Utils::SleepThread(1UL);
+    }
+}
+
+
+} // namespace Detail
+} // namespace Theron
+
+
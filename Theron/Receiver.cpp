@@ -27,7 +27,9 @@ Receiver::Receiver() :
   mAddress(),
   mMessageHandlers(),
   mSpinLock(),
-  mMessagesReceived(0)
+  mMessagesReceived(0),
+  mCondition(),
+  mNumWaiters(0)
 {
     Initialize();
 }
@@ -39,7 +41,9 @@ Receiver::Receiver(EndPoint &endPoint, const char *const name) :
   mAddress(),
   mMessageHandlers(),
   mSpinLock(),
-  mMessagesReceived(0)
+  mMessagesReceived(0),
+  mCondition(),
+  mNumWaiters(0)
 {
     Initialize();
 }
@@ -124,12 +128,13 @@ void Receiver::Release()
     mSpinLock.Lock();
 
     // Free all currently allocated handler objects.
-    while (Detail::IReceiverHandler *const handler = mMessageHandlers.Front())
+    for (uint32_t index = 0; index < mMessageHandlers.Size(); ++index)
     {
-        mMessageHandlers.Remove(handler);
-        AllocatorManager::Instance().GetAllocator()->Free(handler);
+        AllocatorManager::Instance().GetAllocator()->Free(mMessageHandlers[index]);
     }
 
+    mMessageHandlers.Clear();
+
     mSpinLock.Unlock();
 }
 
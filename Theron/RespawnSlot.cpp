@@ -0,0 +1,46 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Actor.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/IAllocator.h>
+#include <Theron/RespawnSlot.h>
+
+
+namespace Theron
+{
+
+
+RespawnSlot::~RespawnSlot()
+{
+    Reset();
+}
+
+
+void RespawnSlot::Reset()
+{
+    // Destruct the respawned actor, if any; the virtual destructor destructs
+    // the derived actor type constructed into the storage.
+    if (mActor)
+    {
+        mActor->~Actor();
+        mActor = 0;
+    }
+
+    if (mStorage)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        allocator->Free(mStorage, mStorageSize);
+
+        mStorage = 0;
+        mStorageSize = 0;
+    }
+
+    // The pre-claimed mailbox index of an unused slot goes unused; mailbox
+    // slots are never reclaimed anyway.
+    mFramework = 0;
+    mMailboxIndex = 0;
+}
+
+
+} // namespace Theron
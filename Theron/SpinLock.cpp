@@ -0,0 +1,24 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <Theron/Defines.h>
+
+#include <Theron/Detail/Threading/SpinLock.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+#if THERON_WINDOWS || THERON_BOOST || THERON_CPP11
+
+Atomic::UInt32 SpinLock::smContentionCount;
+Atomic::UInt32 TicketSpinLock::smContentionCount;
+
+#endif
+
+
+} // namespace Detail
+} // namespace Theron
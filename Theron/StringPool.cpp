@@ -0,0 +1,143 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+#include <new>
+#include <string.h>
+
+#include <Theron/Align.h>
+#include <Theron/AllocatorManager.h>
+#include <Theron/Assert.h>
+#include <Theron/BasicTypes.h>
+#include <Theron/Defines.h>
+#include <Theron/IAllocator.h>
+
+#include <Theron/Detail/Network/StringPool.h>
+
+
+namespace Theron
+{
+namespace Detail
+{
+
+
+SpinLock StringPool::smShardLocks[StringPool::LOCK_SHARDS];
+StringPool::Entry *StringPool::smBuckets[StringPool::BUCKET_COUNT] = { 0 };
+
+#if THERON_ENABLE_HASH_STATS
+Atomic::UInt32 StringPool::smBucketCounts[StringPool::BUCKET_COUNT];
+
+
+uint32_t StringPool::GetBucketCount(const uint32_t bucket)
+{
+    THERON_ASSERT(bucket < BUCKET_COUNT);
+    return smBucketCounts[bucket].Load();
+}
+#endif // THERON_ENABLE_HASH_STATS
+
+
+StringPool::Entry *StringPool::Intern(const char *const str)
+{
+    THERON_ASSERT(str);
+
+    const uint32_t hash(ComputeHash(str));
+    const uint32_t bucket(hash & (BUCKET_COUNT - 1));
+    SpinLock &shardLock(smShardLocks[bucket & (LOCK_SHARDS - 1)]);
+
+    shardLock.Lock();
+
+    // Search the bucket chain for an existing entry with this value.
+    // The stored hash filters out most mismatches without a string compare.
+    for (Entry *entry(smBuckets[bucket]); entry; entry = entry->mNext)
+    {
+        if (entry->mHash == hash && strcmp(entry->mValue, str) == 0)
+        {
+            // Referencing under the lock forestalls concurrent removal of the
+            // entry by a releaser that saw its reference count reach zero.
+            entry->Reference();
+            shardLock.Unlock();
+
+            return entry;
+        }
+    }
+
+    // Create a new entry for the value and link it at the head of the chain.
+    IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+    void *const entryMemory(allocator->AllocateAligned(sizeof(Entry), THERON_CACHELINE_ALIGNMENT));
+    if (entryMemory == 0)
+    {
+        shardLock.Unlock();
+        return 0;
+    }
+
+    Entry *const entry(new (entryMemory) Entry(str));
+    entry->mHash = hash;
+    entry->Reference();
+
+#if THERON_ENABLE_HASH_STATS
+    smBucketCounts[bucket].Increment();
+#endif // THERON_ENABLE_HASH_STATS
+
+    entry->mNext = smBuckets[bucket];
+    smBuckets[bucket] = entry;
+
+    shardLock.Unlock();
+
+    return entry;
+}
+
+
+void StringPool::Release(Entry *const entry)
+{
+    THERON_ASSERT(entry);
+
+    // Decrement the reference count without taking the lock; only the
+    // releaser that drops the count to zero pays for removal.
+    if (!entry->Dereference())
+    {
+        return;
+    }
+
+    const uint32_t bucket(entry->mHash & (BUCKET_COUNT - 1));
+    SpinLock &shardLock(smShardLocks[bucket & (LOCK_SHARDS - 1)]);
+
+    shardLock.Lock();
+
+    // Re-check under the lock: the entry may have been re-interned since the
+    // count reached zero, or already removed by another releaser that also
+    // saw a zero count. Only remove it if it's still chained and unreferenced.
+    Entry *previous(0);
+    Entry *current(smBuckets[bucket]);
+
+    while (current && current != entry)
+    {
+        previous = current;
+        current = current->mNext;
+    }
+
+    const bool remove(current != 0 && current->mRefCount.Load() == 0);
+    if (remove)
+    {
+        if (previous)
+        {
+            previous->mNext = current->mNext;
+        }
+        else
+        {
+            smBuckets[bucket] = current->mNext;
+        }
+    }
+
+    shardLock.Unlock();
+
+    // Once unlinked the entry is unreachable so can be destroyed outside the lock.
+    if (remove)
+    {
+        IAllocator *const allocator(AllocatorManager::Instance().GetAllocator());
+        entry->~Entry();
+        allocator->Free(entry, sizeof(Entry));
+    }
+}
+
+
+} // namespace Detail
+} // namespace Theron
@@ -136,6 +136,13 @@ if(CMAKE_SYSTEM_NAME STREQUAL "Linux")
 
 endif()
 
+########################################################################
+# Shared memory transport (64-bit Linux GCC only)
+########################################################################
+if(CMAKE_SYSTEM_NAME STREQUAL "Linux" AND CMAKE_COMPILER_IS_GNUCXX AND ${SIZEOF_CPU} EQUAL 64)
+    list(APPEND THERON_DEFINES -DTHERON_SHM=1)
+endif()
+
 ########################################################################
 # Setup Crossroads IO (optional)
 ########################################################################
@@ -0,0 +1,172 @@
+// Copyright (C) by Ashton Mason. See LICENSE.txt for licensing information.
+
+
+//
+// This tool reads a message journal written by an endpoint constructed with
+// EndPoint::Parameters::mJournalPath and prints an audit listing of the
+// recorded messages: the wall-clock send time of each message, its source and
+// destination names, its registered type name, and its serialized sizes.
+// An optional time window, in microseconds since the Unix epoch, restricts
+// the listing to a slice of the recorded history.
+//
+// With the --replay option the tool additionally constructs an endpoint and
+// replays the selected window back into it with EndPoint::ReplayJournal.
+// Replayed messages are rebuilt from their serialized forms and delivered to
+// the mailboxes published locally under their recorded destination names, so
+// in this standalone tool, which publishes no names and registers only basic
+// message types, replay mostly serves to verify that the journal decodes.
+// Applications wanting to re-process journaled traffic should instead call
+// EndPoint::ReplayJournal from a process that registers their message types
+// and hosts the destination actors.
+//
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Theron/Theron.h>
+
+#include <Theron/Detail/Network/FlatMessage.h>
+#include <Theron/Detail/Network/MessageJournal.h>
+#include <Theron/Detail/Network/NetworkMessage.h>
+
+
+// Register some basic message types so journals of simple messages can be
+// rebuilt during replay without linking application code into the tool.
+THERON_REGISTER_MESSAGE(int);
+THERON_REGISTER_MESSAGE(float);
+THERON_REGISTER_MESSAGE(double);
+
+
+int main(int argc, char *argv[])
+{
+    const char *journalPath(0);
+    const char *replayName(0);
+    const char *replayLocation(0);
+    Theron::uint64_t startMicroseconds(0);
+    Theron::uint64_t endMicroseconds(0);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--start") == 0 && i + 1 < argc)
+        {
+            startMicroseconds = strtoull(argv[++i], 0, 10);
+        }
+        else if (strcmp(argv[i], "--end") == 0 && i + 1 < argc)
+        {
+            endMicroseconds = strtoull(argv[++i], 0, 10);
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 2 < argc)
+        {
+            replayName = argv[++i];
+            replayLocation = argv[++i];
+        }
+        else
+        {
+            journalPath = argv[i];
+        }
+    }
+
+    if (journalPath == 0)
+    {
+        printf("Usage: journalreplay <journalfile> [--start <microseconds>] [--end <microseconds>] [--replay <endpointname> <location>]\n");
+        printf("Lists the messages recorded in a journal written via EndPoint::Parameters::mJournalPath,\n");
+        printf("optionally restricted to a time window, and optionally replays them into an endpoint.\n");
+        return 1;
+    }
+
+    Theron::Detail::MessageJournal journal;
+    if (!journal.OpenForReading(journalPath))
+    {
+        printf("ERROR: Failed to open journal file '%s'\n", journalPath);
+        return 1;
+    }
+
+    // No record can be larger than the whole ring.
+    const Theron::uint32_t capacity(journal.GetRingSize());
+    unsigned char *const buffer = static_cast<unsigned char *>(malloc(capacity));
+    if (buffer == 0)
+    {
+        printf("ERROR: Failed to allocate record buffer of %u bytes\n", capacity);
+        return 1;
+    }
+
+    printf("%-20s %-24s %-24s %-32s %10s %10s\n",
+        "timestamp_us", "from", "to", "message", "frame", "payload");
+
+    Theron::uint32_t listed(0);
+    Theron::Detail::MessageJournal::RecordHeader header;
+
+    while (journal.ReadNext(header, buffer, capacity))
+    {
+        // Records are read oldest first, so skip forward to the start of the
+        // window and stop once past its end.
+        if (header.mTimestamp < startMicroseconds)
+        {
+            continue;
+        }
+
+        if (endMicroseconds && header.mTimestamp > endMicroseconds)
+        {
+            break;
+        }
+
+        // Journals written with EndPoint::Parameters::mFlatWireFormat enabled
+        // contain flat frames, identified by their leading marker word, which
+        // record the hash of the message type name rather than the name itself.
+        Theron::uint32_t marker(0);
+        memcpy(&marker, buffer, sizeof(Theron::uint32_t));
+
+        if (marker == Theron::Detail::FlatMessage::MARKER)
+        {
+            const Theron::Detail::FlatMessage *const flatMessage(
+                reinterpret_cast<const Theron::Detail::FlatMessage *>(buffer));
+
+            char typeHash[32];
+            sprintf(typeHash, "hash:0x%08x", flatMessage->GetTypeHash());
+
+            printf("%-20llu %-24s %-24s %-32s %10u %10u\n",
+                static_cast<unsigned long long>(header.mTimestamp),
+                flatMessage->GetFromName(),
+                flatMessage->GetToName(),
+                typeHash,
+                header.mFrameSize,
+                header.mPayloadSize);
+        }
+        else
+        {
+            const Theron::Detail::NetworkMessage *const networkMessage(
+                reinterpret_cast<const Theron::Detail::NetworkMessage *>(buffer));
+
+            printf("%-20llu %-24s %-24s %-32s %10u %10u\n",
+                static_cast<unsigned long long>(header.mTimestamp),
+                networkMessage->GetFromName(),
+                networkMessage->GetToName(),
+                networkMessage->GetMessageName(),
+                header.mFrameSize,
+                header.mPayloadSize);
+        }
+
+        ++listed;
+    }
+
+    free(buffer);
+    journal.Close();
+
+    printf("%u messages listed\n", listed);
+
+    if (replayName && replayLocation)
+    {
+        Theron::EndPoint endPoint(replayName, replayLocation);
+
+        const Theron::uint32_t delivered(endPoint.ReplayJournal(
+            journalPath,
+            startMicroseconds,
+            endMicroseconds));
+
+        printf("%u messages replayed to locally published names\n", delivered);
+    }
+
+    return 0;
+}